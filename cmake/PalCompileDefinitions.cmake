@@ -168,6 +168,12 @@ function(pal_compile_definitions TARGET)
 
             target_compile_definitions(${TARGET} PRIVATE PAL_HAVE_WAYLAND_PLATFORM=1)
         endif()
+
+        if (PAL_BUILD_FAKE_DRM)
+            message_verbose("PAL build with fake libdrm enabled")
+
+            target_compile_definitions(${TARGET} PRIVATE PAL_HAVE_FAKE_DRM=1)
+        endif()
     endif()
 
     if (PAL_BUILD_OSS)
@@ -86,6 +86,9 @@ macro(pal_options)
 
     option(PAL_BUILD_DRI3 "Build PAL with DRI3 support?" ON)
     option(PAL_BUILD_WAYLAND "Build PAL with WAYLAND support?" OFF)
+    option(PAL_BUILD_FAKE_DRM "Build PAL against an in-process fake libdrm instead of the system libraries?" OFF)
+
+    option(PAL_BUILD_TESTS "Build PAL tests and benchmarks?" OFF)
 
     # Paths to PAL's dependencies
     set(PAL_METROHASH_PATH ${PROJECT_SOURCE_DIR}/src/util/imported/metrohash CACHE PATH "Specify the path to the MetroHash project.")
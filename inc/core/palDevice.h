@@ -40,6 +40,8 @@
 #include "palFence.h"
 #include "palCmdAllocator.h"
 
+namespace Util { class Event; }
+
 namespace Pal
 {
 
@@ -2055,6 +2057,35 @@ enum GpuMemoryRefFlags : uint32
     GpuMemoryRefMustSucceed = 0x2, ///< Hint to the OS that we can't process a failure here, this may result in a TDR.
 };
 
+/// Describes the GPU virtual address range of a GPU memory object.  Returned by IDevice::FindGpuMemoryByVa() and
+/// IDevice::FindGpuMemoryInVaRange().
+struct GpuMemoryVaRange
+{
+    const IGpuMemory* pGpuMemory;  ///< GPU memory object which owns the range.  This is null for allocations which the
+                                   ///  caller didn't create, such as PAL's internal allocations.
+    gpusize           gpuVirtAddr; ///< First GPU virtual address of the range.
+    gpusize           size;        ///< Size of the range in bytes.
+};
+
+/// Reports how much GPU memory PAL saves by sharing one code upload between pipelines whose uploaded code and data are
+/// identical after relocation.  Returned by IDevice::GetPipelineCodeSharingStats().
+struct PipelineCodeSharingStats
+{
+    gpusize bytesSaved;      ///< GPU memory which would have been spent on duplicate pipeline code uploads.
+    uint32  codeObjectCount; ///< Number of distinct pipeline code uploads tracked for sharing.
+    uint32  pipelineCount;   ///< Number of live pipelines which reference one of those code uploads.
+};
+
+/// Reports how effectively PAL shares identical color blend, depth stencil and MSAA state objects.  Returned by
+/// IDevice::GetStateObjectInterningStats().  The hit rate is hits divided by lookups.
+struct StateObjectInterningStats
+{
+    uint64 lookups;     ///< Number of state object creations which searched for an identical interned state.
+    uint64 hits;        ///< Number of those creations which found one and copied it instead of building a new state.
+    uint32 stateCount;  ///< Number of distinct interned states currently alive.
+    uint32 objectCount; ///< Number of live state objects which reference one of those interned states.
+};
+
 /// Specifies input arguments for IDevice::GetPrimaryInfo(). Client must specify a display ID and properties of the
 /// primary surface that will drive that display in order to query capabilities.
 struct GetPrimaryInfoInput
@@ -2643,6 +2674,71 @@ public:
     virtual void GetReferencedMemoryTotals(
         gpusize  referencedGpuMemTotal[GpuHeapCount]) const = 0;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    /// Looks up the GPU memory object whose virtual address range contains a GPU virtual address.  This is a debugging
+    /// aid for tools such as page-fault analysis which need to map an arbitrary address back to its allocation.  Every
+    /// GPU memory object with a GPU virtual address is tracked, including PAL's internal allocations.
+    ///
+    /// If several objects contain the address (e.g., a virtual allocation and an allocation placed in its reserved
+    /// range), the one with the smallest range is returned.
+    ///
+    /// @param [in]  gpuVirtAddr GPU virtual address to look up.
+    /// @param [out] pRange      Describes the GPU memory object containing gpuVirtAddr.  Must not be null.
+    ///
+    /// @returns Success if a GPU memory object contains gpuVirtAddr, NotFound if none does, or ErrorInvalidPointer if
+    ///          pRange is null.
+    virtual Result FindGpuMemoryByVa(
+        gpusize           gpuVirtAddr,
+        GpuMemoryVaRange* pRange) const = 0;
+
+    /// Reports every GPU memory object whose virtual address range overlaps [gpuVirtAddr, gpuVirtAddr + size).  The
+    /// ranges are reported in order of increasing start address.
+    ///
+    /// @param [in]     gpuVirtAddr First GPU virtual address of the range to query.
+    /// @param [in]     size        Size of the range to query in bytes.  Must not be zero.
+    /// @param [in,out] pRangeCount If pRanges is null, outputs the number of overlapping GPU memory objects.
+    ///                             Otherwise, inputs the capacity of pRanges and outputs the number of entries
+    ///                             written.  Must not be null.
+    /// @param [out]    pRanges     Optional array which receives the overlapping ranges.
+    ///
+    /// @returns Success if the query completed, or one of the following codes:
+    ///          + ErrorIncompleteResults if pRanges couldn't hold every overlapping range.  The first *pRangeCount
+    ///            entries are valid.
+    ///          + ErrorInvalidPointer if pRangeCount is null.
+    ///          + ErrorInvalidValue if size is zero.
+    virtual Result FindGpuMemoryInVaRange(
+        gpusize           gpuVirtAddr,
+        gpusize           size,
+        uint32*           pRangeCount,
+        GpuMemoryVaRange* pRanges) const = 0;
+#endif
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    /// Reports how much GPU memory is saved by sharing pipeline code uploads.  PAL keys each pipeline's uploaded code
+    /// and data by a hash of its content and relocations; pipelines with a matching key reference the same GPU memory
+    /// instead of uploading another copy.  Only complete uploads are shared; pipelines which merely have some shader
+    /// stages in common each upload their own copy.  The statistics describe the pipelines which are alive at the time
+    /// of the call.  Sharing can be disabled with the PipelineCodeSharing setting, in which case every statistic is
+    /// zero.
+    ///
+    /// @param [out] pStats Receives the current statistics.  Must not be null.
+    virtual void GetPipelineCodeSharingStats(
+        PipelineCodeSharingStats* pStats) const = 0;
+#endif
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    /// Reports how often color blend, depth stencil and MSAA state creation reused an interned state.  When interning
+    /// is enabled with the StateObjectInterning setting, PAL keys each of these state objects by a hash of its create
+    /// info; creating another object with the same create info copies the precomputed hardware state, and binding it
+    /// while an equivalent state is bound costs no command space.  The lookup and hit counts accumulate over the life
+    /// of the device, while the other statistics describe the objects which are alive at the time of the call.  Every
+    /// statistic is zero when interning is disabled or unsupported by the GPU.
+    ///
+    /// @param [out] pStats Receives the current statistics.  Must not be null.
+    virtual void GetStateObjectInterningStats(
+        StateObjectInterningStats* pStats) const = 0;
+#endif
+
     /// Get primary surface MGPU support information based upon primary surface create info and input flags provided
     /// by client.
     ///
@@ -2819,6 +2915,23 @@ public:
         bool                waitAll,
         uint64              timeoutNs) const = 0;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    /// Arranges for a client event to be set once the fence's most recent submission has completed, without blocking
+    /// the calling thread.  All such requests on a device are serviced by one background thread which waits on every
+    /// pending fence with a single kernel wait.  The fence's current payload is captured by this call, so the fence may
+    /// be reset, resubmitted or destroyed before the event is set.
+    ///
+    /// @param [in] fence  Fence to watch.  It must have been submitted at least once.
+    /// @param [in] pEvent Event to set once the fence's current submission completes.  It must stay alive until then.
+    ///
+    /// @returns Success if the request was registered.  Otherwise, one of the following errors may be returned:
+    ///          + ErrorInvalidPointer if pEvent is null.
+    ///          + Unsupported if the platform's fences can't be waited on by a background thread.
+    virtual Result SignalEventOnFenceCompletion(
+        const IFence& fence,
+        Util::Event*  pEvent) = 0;
+#endif
+
     /// Stalls the current thread until one or all of the specified Semaphores have been reached by the device.
     ///
     /// Using a zero timeout value returns immediately and can be used to determine the status of a set of semaphores
@@ -33,6 +33,7 @@
 
 #include "palUtil.h"
 #include "palElf.h"
+#include "palHashLiteralString.h"
 #include <cstring>
 
 namespace Util
@@ -546,14 +547,67 @@ PAL_INLINE PipelineSymbolType GetSymbolForStage(
 /// @returns The corresponding PipelineSymbolType.
 PAL_INLINE PipelineSymbolType GetSymbolTypeFromName(const char* pName)
 {
+    // Pipeline ABI symbols are classified with a single hash of the name and a switch over the compile-time hashes of
+    // the known names, rather than comparing against every entry in PipelineAbiSymbolNameStrings. ELFs with thousands
+    // of generic symbols (e.g., shader libraries) otherwise pay for a full table scan on every symbol.
+    static_assert(static_cast<uint32>(PipelineSymbolType::Count) == 39,
+                  "GetSymbolTypeFromName() must be updated whenever a PipelineSymbolType is added.");
+
     PipelineSymbolType type = PipelineSymbolType::Unknown;
-    for (uint32 i = 0; i < static_cast<uint32>(PipelineSymbolType::Count); i++)
+
+    const size_t length = strlen(pName);
+    if (length > 0)
     {
-        if (strcmp(PipelineAbiSymbolNameStrings[i], pName) == 0)
+        switch (HashString(pName, length))
         {
-            type = static_cast<PipelineSymbolType>(i);
+        case HashLiteralString("_amdgpu_ls_main"):             type = PipelineSymbolType::LsMainEntry; break;
+        case HashLiteralString("_amdgpu_hs_main"):             type = PipelineSymbolType::HsMainEntry; break;
+        case HashLiteralString("_amdgpu_es_main"):             type = PipelineSymbolType::EsMainEntry; break;
+        case HashLiteralString("_amdgpu_gs_main"):             type = PipelineSymbolType::GsMainEntry; break;
+        case HashLiteralString("_amdgpu_vs_main"):             type = PipelineSymbolType::VsMainEntry; break;
+        case HashLiteralString("_amdgpu_ps_main"):             type = PipelineSymbolType::PsMainEntry; break;
+        case HashLiteralString("_amdgpu_cs_main"):             type = PipelineSymbolType::CsMainEntry; break;
+        case HashLiteralString("_amdgpu_fs_main"):             type = PipelineSymbolType::FsMainEntry; break;
+        case HashLiteralString("_amdgpu_ls_shdr_intrl_tbl"):   type = PipelineSymbolType::LsShdrIntrlTblPtr; break;
+        case HashLiteralString("_amdgpu_hs_shdr_intrl_tbl"):   type = PipelineSymbolType::HsShdrIntrlTblPtr; break;
+        case HashLiteralString("_amdgpu_es_shdr_intrl_tbl"):   type = PipelineSymbolType::EsShdrIntrlTblPtr; break;
+        case HashLiteralString("_amdgpu_gs_shdr_intrl_tbl"):   type = PipelineSymbolType::GsShdrIntrlTblPtr; break;
+        case HashLiteralString("_amdgpu_vs_shdr_intrl_tbl"):   type = PipelineSymbolType::VsShdrIntrlTblPtr; break;
+        case HashLiteralString("_amdgpu_ps_shdr_intrl_tbl"):   type = PipelineSymbolType::PsShdrIntrlTblPtr; break;
+        case HashLiteralString("_amdgpu_cs_shdr_intrl_tbl"):   type = PipelineSymbolType::CsShdrIntrlTblPtr; break;
+        case HashLiteralString("_amdgpu_ls_disasm"):           type = PipelineSymbolType::LsDisassembly; break;
+        case HashLiteralString("_amdgpu_hs_disasm"):           type = PipelineSymbolType::HsDisassembly; break;
+        case HashLiteralString("_amdgpu_es_disasm"):           type = PipelineSymbolType::EsDisassembly; break;
+        case HashLiteralString("_amdgpu_gs_disasm"):           type = PipelineSymbolType::GsDisassembly; break;
+        case HashLiteralString("_amdgpu_vs_disasm"):           type = PipelineSymbolType::VsDisassembly; break;
+        case HashLiteralString("_amdgpu_ps_disasm"):           type = PipelineSymbolType::PsDisassembly; break;
+        case HashLiteralString("_amdgpu_cs_disasm"):           type = PipelineSymbolType::CsDisassembly; break;
+        case HashLiteralString("_amdgpu_ls_shdr_intrl_data"):  type = PipelineSymbolType::LsShdrIntrlData; break;
+        case HashLiteralString("_amdgpu_hs_shdr_intrl_data"):  type = PipelineSymbolType::HsShdrIntrlData; break;
+        case HashLiteralString("_amdgpu_es_shdr_intrl_data"):  type = PipelineSymbolType::EsShdrIntrlData; break;
+        case HashLiteralString("_amdgpu_gs_shdr_intrl_data"):  type = PipelineSymbolType::GsShdrIntrlData; break;
+        case HashLiteralString("_amdgpu_vs_shdr_intrl_data"):  type = PipelineSymbolType::VsShdrIntrlData; break;
+        case HashLiteralString("_amdgpu_ps_shdr_intrl_data"):  type = PipelineSymbolType::PsShdrIntrlData; break;
+        case HashLiteralString("_amdgpu_cs_shdr_intrl_data"):  type = PipelineSymbolType::CsShdrIntrlData; break;
+        case HashLiteralString("_amdgpu_pipeline_intrl_data"): type = PipelineSymbolType::PipelineIntrlData; break;
+        case HashLiteralString("_amdgpu_cs_amdil"):            type = PipelineSymbolType::CsAmdIl; break;
+        case HashLiteralString("_amdgpu_task_amdil"):          type = PipelineSymbolType::TaskAmdIl; break;
+        case HashLiteralString("_amdgpu_vs_amdil"):            type = PipelineSymbolType::VsAmdIl; break;
+        case HashLiteralString("_amdgpu_hs_amdil"):            type = PipelineSymbolType::HsAmdIl; break;
+        case HashLiteralString("_amdgpu_ds_amdil"):            type = PipelineSymbolType::DsAmdIl; break;
+        case HashLiteralString("_amdgpu_gs_amdil"):            type = PipelineSymbolType::GsAmdIl; break;
+        case HashLiteralString("_amdgpu_mesh_amdil"):          type = PipelineSymbolType::MeshAmdIl; break;
+        case HashLiteralString("_amdgpu_ps_amdil"):            type = PipelineSymbolType::PsAmdIl; break;
+        default:
             break;
         }
+
+        // A generic symbol may share a hash with one of the pipeline symbols, so confirm the match.
+        if ((type != PipelineSymbolType::Unknown) &&
+            (strcmp(PipelineAbiSymbolNameStrings[static_cast<uint32>(type)], pName) != 0))
+        {
+            type = PipelineSymbolType::Unknown;
+        }
     }
 
     return type;
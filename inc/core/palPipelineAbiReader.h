@@ -53,17 +53,11 @@ struct SymbolEntry
 /// The PipelineAbiReader simplifies loading ELFs compatible with the pipeline ABI.
 class PipelineAbiReader
 {
-typedef HashMap<const char*,
-                SymbolEntry,
-                IndirectAllocator,
-                StringJenkinsHashFunc,
-                StringEqualFunc,
-                HashAllocator<IndirectAllocator>,
-                PAL_CACHE_LINE_BYTES * 2> GenericSymbolMap;
-
 public:
     template <typename Allocator>
     PipelineAbiReader(Allocator* const pAllocator, const void* pData);
+    ~PipelineAbiReader() { PAL_SAFE_FREE(m_pGenericSymbols, &m_allocator); }
+
     Result Init();
 
     ElfReader::Reader& GetElfReader() { return m_elfReader; }
@@ -110,7 +104,22 @@ private:
     /// If the section index of the symbol is 0, it does not exist.
     SymbolEntry m_pipelineSymbols[static_cast<uint32>(PipelineSymbolType::Count)];
 
-    GenericSymbolMap m_genericSymbolsMap;
+    /// A symbol which is not defined by the pipeline ABI, keyed by the FNV-1a hash of its name.
+    struct GenericSymbol
+    {
+        uint32      hash;
+        SymbolEntry entry;
+        const char* pName;
+    };
+
+    /// The generic symbols, sorted by hash. The table lives in a single allocation sized from the ELF's symbol tables
+    /// in Init(), so large shader libraries don't pay for one hash-map insertion per symbol.
+    GenericSymbol* m_pGenericSymbols;
+    uint32         m_numGenericSymbols;
+
+    static int CompareGenericSymbols(const void* pLhs, const void* pRhs);
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(PipelineAbiReader);
 };
 
 // =====================================================================================================================
@@ -119,7 +128,8 @@ PipelineAbiReader::PipelineAbiReader(Allocator* const pAllocator, const void* pD
     :
     m_allocator(pAllocator),
     m_elfReader(pData),
-    m_genericSymbolsMap(16u, &m_allocator)
+    m_pGenericSymbols(nullptr),
+    m_numGenericSymbols(0)
 {
     PAL_ASSERT(pAllocator);
 
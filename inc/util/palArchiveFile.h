@@ -146,6 +146,76 @@ Result CreateArchiveFile(
 Result DeleteArchiveFile(
     const ArchiveFileOpenInfo* pOpenInfo);
 
+/// Callback which decides whether an entry is kept when an archive file is compacted
+///
+/// @param [in] pUserData   ArchiveFileCompactInfo::pUserData
+/// @param [in] header      Header of the entry in the original archive file
+///
+/// @return false if the entry should be dropped
+typedef bool (*ArchiveEntryFilterFunc)(void* pUserData, const ArchiveEntryHeader& header);
+
+/// Callback which orders entries when an archive file is compacted. Entries are written in ascending rank; entries with
+/// an equal rank keep their original order. Ranking recently used entries first keeps them contiguous in the file.
+///
+/// @param [in] pUserData   ArchiveFileCompactInfo::pUserData
+/// @param [in] header      Header of the entry in the original archive file
+///
+/// @return Rank of the entry
+typedef uint64 (*ArchiveEntryRankFunc)(void* pUserData, const ArchiveEntryHeader& header);
+
+/**
+***********************************************************************************************************************
+* @brief Description of an archive file compaction
+***********************************************************************************************************************
+*/
+struct ArchiveFileCompactInfo
+{
+    const ArchiveFileOpenInfo* pOpenInfo;  ///< Archive file to compact. If pOpenInfo->pPlatformKey is given and does
+                                           ///  not match the archive, every entry is dropped and the compacted archive
+                                           ///  is keyed to pPlatformKey. Create and access flags are ignored.
+    ArchiveEntryFilterFunc     pfnFilter;  ///< Optional callback to drop additional entries
+    ArchiveEntryRankFunc       pfnRank;    ///< Optional callback to reorder entries. Original order is kept if nullptr.
+    void*                      pUserData;  ///< Passed to pfnFilter and pfnRank
+};
+
+/**
+***********************************************************************************************************************
+* @brief Results of an archive file compaction
+***********************************************************************************************************************
+*/
+struct ArchiveFileCompactStats
+{
+    uint32 entryCountBefore;    ///< Number of entries in the original archive file
+    uint32 entryCountAfter;     ///< Number of entries in the compacted archive file
+    uint32 duplicateCount;      ///< Entries dropped because an earlier entry has the same key
+    uint32 corruptCount;        ///< Entries dropped because their data failed the checksum
+    uint32 filteredCount;       ///< Entries dropped by a platform key mismatch or pfnFilter
+    uint64 fileSizeBefore;      ///< Size in bytes of the original archive file
+    uint64 fileSizeAfter;       ///< Size in bytes of the compacted archive file
+};
+
+/// Rewrite an archive file so that it only holds live entries, stored contiguously.
+///
+/// Archive files are append-only, so duplicates, corrupt data and entries written for another platform are never
+/// reclaimed. This copies the remaining entries to a new file beside the original and then renames it over the
+/// original, so readers never see a partially compacted archive. The archive must not be open elsewhere for the
+/// duration of the call. For entries with the same key, the first one is kept, matching the archive file cache layer.
+///
+/// This Interface will cause disk access routines to be called by the underlying OS.
+///
+/// @param [in]     pCompactInfo    Archive file and options for the compaction
+/// @param [out]    pStats          Optional results of the compaction
+///
+/// @returns Success if the archive file was compacted. Otherwise, one of the following errors may be returned:
+///          + ErrorUnavailable if the archive file could not be opened or is in use
+///          + ErrorInvalidPointer if pCompactInfo or pCompactInfo->pOpenInfo is nullptr
+///          + ErrorOutOfMemory when there is not enough system memory to compact the file
+///          + ErrorIncompatibleLibrary if the archive file is invalid
+///          + ErrorUnknown if there is an internal error, in which case the original archive file is unchanged
+Result CompactArchiveFile(
+    const ArchiveFileCompactInfo* pCompactInfo,
+    ArchiveFileCompactStats*      pStats);
+
 /**
 ***********************************************************************************************************************
 * @brief Interface for reading and writing to a file adhering to the PAL Archive file format
@@ -32,7 +32,7 @@
 #pragma once
 
 #include "pal.h"
-#include "palList.h"
+#include "palInlineFuncs.h"
 
 namespace Util
 {
@@ -44,6 +44,11 @@ namespace Util
  * Responsible for managing small GPU memory requests by allocating a large base allocation and dividing it into
  * appropriately sized suballocation blocks.
  *
+ * Every block size (k-value) keeps a bitmap of its free blocks and a bitmap of its allocated blocks, and a mask records
+ * which block sizes have any free blocks at all. Finding a block, splitting it and coalescing it with its buddy are
+ * therefore a handful of bit operations per block size, independent of how many blocks are outstanding. A block size's
+ * bitmaps are only allocated once a block of that size is first needed.
+ *
  * @warning The buddy allocator is not thread-safe so thread-safety has to be handled on the caller side.
  ***********************************************************************************************************************
  */
@@ -102,32 +107,38 @@ public:
     Pal::gpusize MaximumAllocationSize() const;
 
 private:
-    struct Block
+    // The blocks of one size. Block i of a level starts at offset (i << kval); bit i of a bitmap describes block i.
+    // Both bitmaps are null until the level is first used.
+    struct Level
     {
-        bool            isFree; // Indicates the in-use status of the block
-        Pal::gpusize    offset; // Byte offset from the base allocation address where this block begins
+        uint64*     pFreeBits;      // Blocks which are free as a whole. Also owns the memory of pAllocatedBits.
+        uint64*     pAllocatedBits; // Blocks which have been handed out as a whole.
+        uint32      firstFreeWord;  // No word of pFreeBits before this one has a bit set.
+        uint32      numFreeBlocks;
     };
 
-    typedef Util::List<Block, Allocator> BlockList;
-
-    Result GetNextFreeBlock(
-        uint32              kval,
-        Pal::gpusize*       pOffset);
+    Result InitLevel(uint32 level);
+    uint32 FindFreeBlock(uint32 level);
+    void   MarkFree(uint32 level, uint32 block);
+    void   MarkNotFree(uint32 level, uint32 block);
 
-    Result FreeBlock(
-        uint32              kval,
-        Pal::gpusize        offset);
+    PAL_INLINE bool IsBitSet(const uint64* pBits, uint32 block) const
+        { return ((pBits[block >> 6] & (1ull << (block & 63))) != 0); }
 
     PAL_INLINE Pal::gpusize KvalToSize(uint32 kVal) const { return (1ull << kVal); }
 
     PAL_INLINE uint32 SizeToKval(Pal::gpusize size) const { return Log2(size); }
 
+    // Number of blocks of the given k-value which fit in the base allocation.
+    PAL_INLINE uint32 NumBlocks(uint32 kVal) const { return (1u << (m_baseAllocKval - kVal)); }
+
     Allocator* const    m_pAllocator;
 
     const uint32        m_baseAllocKval;
     const uint32        m_minKval;
 
-    BlockList*          m_pBlockLists;
+    Level*              m_pLevels;        // One level per k-value in [m_minKval, m_baseAllocKval).
+    uint64              m_freeLevelMask;  // Bit (kval - m_minKval) is set if that level has a free block.
 
     uint32              m_numSuballocations;
 
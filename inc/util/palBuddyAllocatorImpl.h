@@ -33,7 +33,6 @@
 
 #include "palBuddyAllocator.h"
 #include "palInlineFuncs.h"
-#include "palListImpl.h"
 #include "palSysMemory.h"
 
 namespace Util
@@ -49,7 +48,8 @@ BuddyAllocator<Allocator>::BuddyAllocator(
     m_pAllocator(pAllocator),
     m_baseAllocKval(SizeToKval(baseAllocSize)),
     m_minKval(SizeToKval(minAllocSize)),
-    m_pBlockLists(nullptr),
+    m_pLevels(nullptr),
+    m_freeLevelMask(0),
     m_numSuballocations(0)
 {
     // Allocator must be non-null
@@ -60,29 +60,24 @@ BuddyAllocator<Allocator>::BuddyAllocator(
 
     // Minimum allocation size must be POT
     PAL_ASSERT(KvalToSize(m_minKval) == minAllocSize);
+
+    // Block indices are 32-bit, so the base allocation can hold at most 2^31 minimum size blocks.
+    PAL_ASSERT((m_baseAllocKval > m_minKval) && ((m_baseAllocKval - m_minKval) < 32));
 }
 
 // =====================================================================================================================
 template <typename Allocator>
 BuddyAllocator<Allocator>::~BuddyAllocator()
 {
-    if (m_pBlockLists != nullptr)
+    if (m_pLevels != nullptr)
     {
-        const uint32 numKvals = m_baseAllocKval - m_minKval;
-
-        for (uint32 i = 0; i < numKvals; ++i)
+        // Each level's two bitmaps share one allocation.
+        for (uint32 level = 0; level < (m_baseAllocKval - m_minKval); ++level)
         {
-            for (auto it = m_pBlockLists[i].Begin(); it.Get() != nullptr;)
-            {
-                m_pBlockLists[i].Erase(&it);
-            }
-
-            // Call the destructor
-            m_pBlockLists[i].~List();
+            PAL_SAFE_FREE(m_pLevels[level].pFreeBits, m_pAllocator);
         }
 
-        // Free the block list array
-        PAL_SAFE_FREE(m_pBlockLists, m_pAllocator);
+        PAL_SAFE_FREE(m_pLevels, m_pAllocator);
     }
 }
 
@@ -101,43 +96,58 @@ Pal::gpusize BuddyAllocator<Allocator>::MaximumAllocationSize() const
 template <typename Allocator>
 Result BuddyAllocator<Allocator>::Init()
 {
-    PAL_ASSERT(m_pBlockLists == nullptr);
+    PAL_ASSERT(m_pLevels == nullptr);
 
     Result result = Result::ErrorOutOfMemory;
 
     const uint32 numKvals = m_baseAllocKval - m_minKval;
 
-    // Allocate the block lists
-    m_pBlockLists = static_cast<BlockList*>(PAL_MALLOC(sizeof(BlockList) * numKvals,
-                                                       m_pAllocator,
-                                                       AllocInternal));
+    // Only the level array is allocated here; every level starts out without bitmaps.
+    m_pLevels = static_cast<Level*>(PAL_CALLOC(sizeof(Level) * numKvals, m_pAllocator, AllocInternal));
 
-    if (m_pBlockLists != nullptr)
+    if (m_pLevels != nullptr)
     {
-        for (uint32 i = 0; i < numKvals; ++i)
-        {
-            PAL_PLACEMENT_NEW(&m_pBlockLists[i]) BlockList(m_pAllocator);
-        }
+        result = InitLevel(numKvals - 1);
+    }
 
-        // We need to create the first two largest-size blocks and add them to the last block list
-        const uint32        blockKval = (m_baseAllocKval - 1);
-        const Pal::gpusize  blockSize = KvalToSize(blockKval);
+    if (result == Result::Success)
+    {
+        // We need to create the first two largest-size blocks. They are never merged into the base allocation.
+        MarkFree(numKvals - 1, 0);
+        MarkFree(numKvals - 1, 1);
+    }
 
-        BlockList* pBlockList = &m_pBlockLists[blockKval - m_minKval];
+    return result;
+}
 
-        Block block = {};
-        block.isFree = true;
-        block.offset = 0;
+// =====================================================================================================================
+// Allocates the bitmaps of a level if it doesn't have them yet. This is deferred until a block is first split down to
+// the level because the smallest block sizes have by far the largest bitmaps (a 4MB base allocation with a 16 byte
+// minimum needs 64KB for the smallest level alone) and most base allocations never serve blocks that small.
+template <typename Allocator>
+Result BuddyAllocator<Allocator>::InitLevel(
+    uint32 level)
+{
+    Result      result = Result::Success;
+    Level*const pLevel = &m_pLevels[level];
 
-        result = pBlockList->PushBack(block);
-        PAL_ALERT(result != Result::Success);
+    if (pLevel->pFreeBits == nullptr)
+    {
+        // One bit per block in each of the two bitmaps, rounded up to a whole word. Everything starts out as neither
+        // free nor allocated.
+        const uint32 levelWords = Pow2Align(NumBlocks(m_minKval + level), 64) / 64;
 
-        block.offset = blockSize;
+        pLevel->pFreeBits = static_cast<uint64*>(PAL_CALLOC(sizeof(uint64) * levelWords * 2,
+                                                            m_pAllocator,
+                                                            AllocInternal));
 
-        if (result == Result::Success)
+        if (pLevel->pFreeBits != nullptr)
         {
-            result = pBlockList->PushBack(block);
-            PAL_ALERT(result != Result::Success);
+            pLevel->pAllocatedBits = pLevel->pFreeBits + levelWords;
+        }
+        else
+        {
+            result = Result::ErrorOutOfMemory;
         }
     }
 
@@ -153,17 +163,50 @@ Result BuddyAllocator<Allocator>::Allocate(
     Pal::gpusize    alignment,
     Pal::gpusize*   pOffset)
 {
-    PAL_ASSERT(m_pBlockLists != nullptr);
+    PAL_ASSERT(m_pLevels != nullptr);
 
     PAL_ASSERT(size <= MaximumAllocationSize());
 
     // Pad the requested allocation size to the nearest POT of the size and alignment
     const uint32 kval = Max(SizeToKval(Pow2Pad(Max(size, alignment))), m_minKval);
 
-    Result result = GetNextFreeBlock(kval, pOffset);
+    Result result = Result::ErrorOutOfGpuMemory;
+
+    // The smallest level at or above the requested one which has a free block holds the block we'll split down.
+    const uint32 level      = kval - m_minKval;
+    const uint64 candidates = (kval < m_baseAllocKval) ? (m_freeLevelMask & ~((1ull << level) - 1)) : 0;
+    uint32       srcLevel   = 0;
+
+    if (BitMaskScanForward(&srcLevel, candidates))
+    {
+        result = Result::Success;
+
+        // Every level the block is split through needs its bitmaps. Levels above the source level already have them.
+        for (uint32 splitLevel = level; (result == Result::Success) && (splitLevel < srcLevel); ++splitLevel)
+        {
+            result = InitLevel(splitLevel);
+        }
+    }
 
     if (result == Result::Success)
     {
+        uint32 block = FindFreeBlock(srcLevel);
+
+        MarkNotFree(srcLevel, block);
+
+        // Split the block in halves until it is the requested size, keeping the lower half and freeing its buddy.
+        for (; srcLevel > level; --srcLevel)
+        {
+            block <<= 1;
+            MarkFree(srcLevel - 1, block + 1);
+        }
+
+        Level*const pLevel = &m_pLevels[level];
+
+        pLevel->pAllocatedBits[block >> 6] |= (1ull << (block & 63));
+
+        *pOffset = static_cast<Pal::gpusize>(block) << kval;
+
         // Increment the number of suballocations this buddy allocator manages
         m_numSuballocations++;
     }
@@ -172,146 +215,118 @@ Result BuddyAllocator<Allocator>::Allocate(
 }
 
 // =====================================================================================================================
-// Gets the next free block of the provided size and marks it as used.
+// Frees a suballocated block making it available for future re-use.
 template <typename Allocator>
-Result BuddyAllocator<Allocator>::GetNextFreeBlock(
-    uint32          kval,
-    Pal::gpusize*   pOffset)
+void BuddyAllocator<Allocator>::Free(
+    Pal::gpusize    offset,
+    Pal::gpusize    size,
+    Pal::gpusize    alignment)
 {
-    Result result = Result::ErrorOutOfGpuMemory;
+    PAL_ASSERT(m_pLevels != nullptr);
+
+    const uint32 numKvals  = m_baseAllocKval - m_minKval;
+    const uint32 startKval = Max(SizeToKval(Pow2Pad(Max(size, alignment))), m_minKval);
+
+    // If this assert is hit then something went wrong with the allocation patterns
+    PAL_ASSERT((startKval >= m_minKval) && (startKval < m_baseAllocKval));
 
-    if (kval < m_baseAllocKval)
+    // The caller doesn't have to tell us the size, so find the level at which a block starting at this offset was
+    // handed out. A block can only start at offsets aligned to its size, and only at a level which has bitmaps.
+    uint32 level = startKval - m_minKval;
+    uint32 block = 0;
+    bool   found = false;
+
+    for (; (level < numKvals) && ((offset & (KvalToSize(m_minKval + level) - 1)) == 0); ++level)
     {
-        BlockList* pBlockList = &m_pBlockLists[kval - m_minKval];
+        block = static_cast<uint32>(offset >> (m_minKval + level));
 
-        for (auto it = pBlockList->Begin(); it.Get() != nullptr; it.Next())
+        if ((m_pLevels[level].pAllocatedBits != nullptr) && IsBitSet(m_pLevels[level].pAllocatedBits, block))
         {
-            if (it.Get()->isFree)
-            {
-                // Allocate this block and return it
-                it.Get()->isFree = false;
-                *pOffset = it.Get()->offset;
-
-                result = Result::Success;
-                break;
-            }
+            found = true;
+            break;
         }
+    }
 
-        if (result != Result::Success)
+    // Freeing should always succeed unless something went wrong with the allocation scheme
+    PAL_ASSERT(found);
+
+    if (found)
+    {
+        m_pLevels[level].pAllocatedBits[block >> 6] &= ~(1ull << (block & 63));
+
+        // As long as the buddy is free too, merge the two into their parent, unless we're at the largest block size.
+        // Because all offsets are zero relative and aligned to block size, the buddy's index only differs in bit 0.
+        for (; (level < (numKvals - 1)) && IsBitSet(m_pLevels[level].pFreeBits, block ^ 1); ++level)
         {
-            // If we didn't find any free blocks in the list then we need to get a block one size bigger and split it
-            result = GetNextFreeBlock(kval + 1, pOffset); // Determine the offset for the larger block
-            if (result == Result::Success)
-            {
-                // Now we need to create two blocks in that larger block's space. First, the block we'll return
-                Block block = {};
-                block.isFree = false;
-                block.offset = *pOffset;
-                result = pBlockList->PushBack(block);
-
-                if (result == Result::Success)
-                {
-                    // ... and its buddy which starts out as free
-                    block.isFree = true;
-                    block.offset = *pOffset + KvalToSize(kval);
-                    result = pBlockList->PushBack(block);
-                }
-            }
+            MarkNotFree(level, block ^ 1);
+            block >>= 1;
         }
-    }
 
-    return result;
+        MarkFree(level, block);
+
+        // Decrement the number of suballocations this buddy allocator manages
+        m_numSuballocations--;
+    }
 }
 
 // =====================================================================================================================
-// Frees a suballocated block making it available for future re-use.
+// Returns the lowest free block of the given level, which must have one.
 template <typename Allocator>
-void BuddyAllocator<Allocator>::Free(
-    Pal::gpusize    offset,
-    Pal::gpusize    size,
-    Pal::gpusize    alignment)
+uint32 BuddyAllocator<Allocator>::FindFreeBlock(
+    uint32 level)
 {
-    PAL_ASSERT(m_pBlockLists != nullptr);
+    Level*const pLevel = &m_pLevels[level];
 
-    uint32 startKval = Max(SizeToKval(Pow2Pad(Max(size, alignment))), m_minKval);
+    PAL_ASSERT(pLevel->numFreeBlocks > 0);
 
-    Result result = FreeBlock(startKval, offset);
+    // Skip the empty words once so that later searches start at the first word which may have a free block.
+    while (pLevel->pFreeBits[pLevel->firstFreeWord] == 0)
+    {
+        pLevel->firstFreeWord++;
+    }
 
-    // Freeing should always succeed unless something went wrong with the allocation scheme
-    PAL_ASSERT(result == Result::Success);
+    uint32 bit = 0;
+    BitMaskScanForward(&bit, pLevel->pFreeBits[pLevel->firstFreeWord]);
 
-    // Decrement the number of suballocations this buddy allocator manages
-    m_numSuballocations--;
+    return (pLevel->firstFreeWord * 64) + bit;
 }
 
 // =====================================================================================================================
-// Frees a block with the matching offset.
+// Marks a block as free.
 template <typename Allocator>
-Result BuddyAllocator<Allocator>::FreeBlock(
-    uint32          kval,
-    Pal::gpusize    offset)
+void BuddyAllocator<Allocator>::MarkFree(
+    uint32 level,
+    uint32 block)
 {
-    Result result = Result::ErrorInvalidValue;
+    Level*const  pLevel = &m_pLevels[level];
+    const uint32 word   = (block >> 6);
 
-    // If this assert is hit then something went wrong with the allocation patterns
-    PAL_ASSERT((kval >= m_minKval) && (kval < m_baseAllocKval));
+    PAL_ASSERT(IsBitSet(pLevel->pFreeBits, block) == false);
 
-    for (; (kval < m_baseAllocKval) && (result != Result::Success); ++kval)
-    {
-        BlockList* pBlockList = &m_pBlockLists[kval - m_minKval];
+    pLevel->pFreeBits[word] |= (1ull << (block & 63));
+    pLevel->firstFreeWord    = Min(pLevel->firstFreeWord, word);
+    pLevel->numFreeBlocks++;
 
-        for (auto it = pBlockList->Begin(); it.Get() != nullptr; it.Next())
-        {
-            Block* pBlock = it.Get();
-            if (pBlock->offset == offset)
-            {
-                // At this point this block should not be free
-                PAL_ASSERT(pBlock->isFree == false);
-
-                pBlock->isFree = true;
-
-                // Find the buddy block to see if it is free, and if so remove the blocks and free the next size up.
-                // Because all offsets are zero relative and aligned to block size, buddy offset can be simply
-                // calculated by XOR-ing the block offset with its size.
-                Pal::gpusize buddyOffset = (offset ^ KvalToSize(kval));
-
-                // Because buddies are always consecutive in the block list we can find the buddy block next to the
-                // current one.
-                if (buddyOffset > offset)
-                {
-                    it.Next();
-                }
-                else
-                {
-                    it.Prev();
-                }
-                PAL_ASSERT(it.Get() != nullptr && it.Get()->offset == buddyOffset);
-
-                // If the buddy is free then remove both blocks from the list, unless we're at the largest block size
-                if (it.Get()->isFree && (kval < m_baseAllocKval - 1))
-                {
-                    pBlockList->Erase(&it);
-
-                    // Erasing a node advances the iterator, if the next node is not our block, then we need to move
-                    // back one node
-                    if (it.Get() != pBlock)
-                    {
-                        it.Prev();
-                    }
-                    pBlockList->Erase(&it);
-
-                    // Recursively call this method again to free the next block size up
-                    FreeBlock(kval + 1, Min(offset, buddyOffset));
-                }
-
-                // Finished successfully
-                result = Result::Success;
-                break;
-            }
-        }
-    }
+    m_freeLevelMask |= (1ull << level);
+}
 
-    return result;
+// =====================================================================================================================
+// Marks a free block as no longer free because it has been allocated, split or merged.
+template <typename Allocator>
+void BuddyAllocator<Allocator>::MarkNotFree(
+    uint32 level,
+    uint32 block)
+{
+    Level*const pLevel = &m_pLevels[level];
+
+    PAL_ASSERT(IsBitSet(pLevel->pFreeBits, block));
+
+    pLevel->pFreeBits[block >> 6] &= ~(1ull << (block & 63));
+
+    if (--pLevel->numFreeBlocks == 0)
+    {
+        m_freeLevelMask &= ~(1ull << level);
+    }
 }
 
 } // Pal
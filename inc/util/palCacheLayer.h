@@ -51,6 +51,21 @@ class ICacheLayer;
 class IArchiveFile;
 class IPlatformKey;
 
+/**
+***********************************************************************************************************************
+* @brief Description of a cache entry, attached by the layer which produced the value
+*
+* Layers which store data keep the tag alongside the value and hand it back from ICacheLayer::Query without
+* interpreting it; a file archive layer records it in the ArchiveEntryHeader. A tag of all zeros means the value was
+* stored without one.
+***********************************************************************************************************************
+*/
+struct CacheEntryTag
+{
+    uint32 dataType;  ///< Type of the value, see ArchiveEntryHeader::dataType
+    uint32 metaValue; ///< Value defined by the producer of the data, see ArchiveEntryHeader::metaValue
+};
+
 /**
 ***********************************************************************************************************************
 * @brief Lookup result from ICacheLayer::Query, entryId is specific to the cache layer it was queried from
@@ -58,16 +73,45 @@ class IPlatformKey;
 */
 struct QueryResult
 {
-    ICacheLayer*    pLayer;     ///< Pointer to the layer that responded to the query
-    Hash128         hashId;     ///< HashId referenced during query
-    size_t          dataSize;   ///< Size of value stored in cache
+    ICacheLayer*    pLayer;      ///< Pointer to the layer that responded to the query
+    Hash128         hashId;      ///< HashId referenced during query
+    size_t          dataSize;    ///< Size of value stored in cache
+    CacheEntryTag   tag;         ///< Tag the value was stored with, if the responding layer keeps it
     union
     {
-        uint64      entryId;    ///< Unique entry id corresponding to found result
-        void*       pEntryInfo; ///< Private pointer to entry data corresponding to found result
+        uint64      entryId;     ///< Unique entry id corresponding to found result
+        void*       pEntryInfo;  ///< Private pointer to entry data corresponding to found result
     } context;
 };
 
+/**
+***********************************************************************************************************************
+* @brief Counters accumulated by a cache layer since it was created, returned by ICacheLayer::GetStats()
+*
+* Storage layers count the operations serviced by their own storage. Pass-through layers (tracking, compressing) count
+* every call made through them along with the result the rest of the chain returned. Times are in GetPerfCpuTime()
+* ticks, see ticksPerSecond.
+***********************************************************************************************************************
+*/
+struct CacheLayerStats
+{
+    uint64 queryCount;     ///< Number of lookups performed by this layer
+    uint64 hitCount;       ///< Lookups which found an entry (including entries whose data was not ready yet)
+    uint64 missCount;      ///< Lookups which found no entry
+    uint64 storeCount;     ///< Number of entries stored to this layer
+    uint64 bytesStored;    ///< Total size of the data stored to this layer
+    uint64 loadCount;      ///< Number of loads serviced by this layer
+    uint64 bytesLoaded;    ///< Total size of the data loaded from this layer
+    uint64 evictCount;     ///< Number of entries the layer evicted on its own to make room for others
+    uint64 insertCount;    ///< Number of entries added to this layer's own storage
+    uint64 rejectCount;    ///< Number of entries this layer's admission policy declined to keep
+    uint64 queryTicks;     ///< Time spent performing this layer's lookups
+    uint64 storeTicks;     ///< Time spent performing this layer's stores
+    uint64 loadTicks;      ///< Time spent performing this layer's loads
+    uint64 lockWaitTicks;  ///< Time spent blocked on the layer's internal locks
+    uint64 ticksPerSecond; ///< Frequency of the tick counts above
+};
+
 /**
 ***********************************************************************************************************************
 * @brief Common cache layer interface. Allows all cache layers to be interfaced with agnostically
@@ -160,6 +204,23 @@ public:
         const void*     pData,
         size_t          dataSize) = 0;
 
+    /// Store data with corresponding hash key, along with a tag describing it
+    ///
+    /// Layers which keep data record the tag and return it from Query(); the default implementation drops it.
+    ///
+    /// @param [in] pHashId     128-bit precomputed hash used as a reference id for the cache entry
+    /// @param [in] pData       Data to be stored in the cache
+    /// @param [in] dataSize    Size of data to be stored
+    /// @param [in] tag         Description of the data
+    ///
+    /// @return Same as Store()
+    virtual Result StoreTagged(
+        const Hash128*       pHashId,
+        const void*          pData,
+        size_t               dataSize,
+        const CacheEntryTag& tag)
+    { return Store(pHashId, pData, dataSize); }
+
     /// Accquire a long-lived reference to a cache object
     ///
     /// @note The result populated by QueryResult will not be evicted until `ReleaseCacheRef()` is called.
@@ -347,6 +408,40 @@ public:
     /// @return Link policy used during Store().
     virtual uint32 GetStorePolicy() const = 0;
 
+    /// Hint that entries will be needed soon. A layer which holds data of its own fetches the entries it does not have
+    /// from the layers below it on background threads, so that a later Query() is answered without waiting on slower
+    /// storage. The work is queued and this call returns immediately; entries the hierarchy does not have are skipped.
+    /// Layers which hold no data forward the hint to the next layer. Prefetched entries bypass any admission policy
+    /// of the layer, since they have not been queried yet.
+    ///
+    /// @param [in] pHashIds    Array of count hashes to prefetch
+    /// @param [in] count       Number of hashes in pHashIds
+    ///
+    /// @return Success if the prefetch was queued. Otherwise, one of the following may be returned:
+    ///         + ErrorInvalidPointer if pHashIds is nullptr and count is not zero
+    ///         + ErrorOutOfMemory if the request could not be queued
+    ///         + Unsupported if no layer in the hierarchy can prefetch
+    virtual Result Prefetch(
+        const Hash128* pHashIds,
+        uint32         count)
+    {
+        return Result::Unsupported;
+    }
+
+    /// Retrieve the counters this layer has accumulated since it was created. Counters are kept per layer, so the
+    /// statistics of a linked hierarchy are retrieved by walking GetNextLayer().
+    ///
+    /// @param [out] pStats     Counters for this layer
+    ///
+    /// @return Success if the counters were returned. Otherwise, one of the following may be returned:
+    ///         + ErrorInvalidPointer if pStats is nullptr
+    ///         + Unsupported if the layer does not keep statistics
+    virtual Result GetStats(
+        CacheLayerStats* pStats) const
+    {
+        return Result::Unsupported;
+    }
+
     /// Destroy Cache Layer
     virtual void Destroy() = 0;
 
@@ -382,6 +477,15 @@ struct MemoryCacheCreateInfo
     bool                     evictOnFull;     ///< Whether or not the cache should evict entries based on LRU to
                                               ///  make room for new ones
     bool                     evictDuplicates; ///< Whether or not the cache should evict entries with a duplicate hash
+    size_t                   maxBatchedSize;  ///< Maximum total size of stores queued for the next layer when the
+                                              ///  store policy includes LinkPolicy::BatchStore. Stores which don't
+                                              ///  fit are passed to the next layer synchronously. Zero selects a
+                                              ///  default limit.
+    bool                     frequencyAdmission; ///< Only valid with evictOnFull. Track how often each hash is
+                                                 ///  requested and only admit a new entry if it is requested more
+                                                 ///  often than the entry it would evict. Entries which are hit again
+                                                 ///  move to a protected LRU segment so that a burst of one-time
+                                                 ///  stores cannot flush out frequently reused entries.
 };
 
 /// Get the memory size for a in-memory cache layer
@@ -512,4 +616,132 @@ Result CreateTrackingCacheLayer(
     ICacheLayer**                   ppCacheLayer,
     GetTrackedHashes*               ppGetTrackedHashes);
 
+/// Codecs which a compressing cache layer may apply to data before passing it to the next layer
+enum class CacheCompressionCodec : uint32
+{
+    None = 0, ///< Data is passed to the next layer uncompressed
+    Lz   = 1, ///< Byte-oriented LZ77 codec which favours decompression speed over compression ratio
+};
+
+/// CacheEntryTag::dataType a compressing cache layer attaches to the data it passes to the next layer, which an archive
+/// file cache layer records as ArchiveEntryHeader::dataType. The low byte holds the CacheCompressionCodec used for the
+/// entry and CacheEntryTag::metaValue holds the size of the data before compression.
+constexpr uint32 CompressedCacheDataType = 0x435A0000;
+
+/**
+***********************************************************************************************************************
+* @brief Information needed to create a compressing cache layer
+***********************************************************************************************************************
+*/
+struct CompressingCacheCreateInfo
+{
+    AllocCallbacks*       pCallbacks; ///< Memory allocation callbacks to be used by the caching layer for all long
+                                      ///  term storage. Allocation callbacks must be valid for the life of the cache
+                                      ///  layer
+    CacheCompressionCodec codec;      ///< Codec applied to data stored through this layer. Data that is already
+                                      ///  present in the next layer is decompressed according to the codec it was
+                                      ///  stored with.
+};
+
+/// Get the memory size for a compressing cache layer
+///
+/// @param [in]     pCreateInfo     Information about cache being created
+///
+/// @return Minimum size of memory buffer needed to pass to CreateCompressingCacheLayer()
+size_t GetCompressingCacheLayerSize(
+    const CompressingCacheCreateInfo* pCreateInfo);
+
+/// Create a cache layer which compresses data on Store() and decompresses it on Load(). It holds no data itself and
+/// must be linked above the layer which should hold the compressed data.
+///
+/// @param [in]     pCreateInfo     Information about cache being created
+/// @param [in]     pPlacementAddr  Pointer to the location where the interface should be constructed. There must
+///                                 be as much size available here as reported by calling
+///                                 GetCompressingCacheLayerSize().
+/// @param [out]    ppCacheLayer    Cache layer interface. On failure this value will be set to nullptr.
+///
+/// @returns Success if the cache layer was created. Otherwise, one of the following errors may be returned:
+///         + ErrorInvalidValue if the codec is not recognized.
+///         + ErrorUnknown if there is an internal error.
+Result CreateCompressingCacheLayer(
+    const CompressingCacheCreateInfo* pCreateInfo,
+    void*                             pPlacementAddr,
+    ICacheLayer**                     ppCacheLayer);
+
+/// Magic value identifying a cache access trace file written by a trace cache layer
+constexpr uint32 CacheTraceFileMagic   = 0x43415254; // "TRAC"
+/// Version of the cache access trace file format
+constexpr uint32 CacheTraceFileVersion = 1;
+
+/**
+***********************************************************************************************************************
+* @brief Information needed to create a trace cache layer
+***********************************************************************************************************************
+*/
+struct TraceCacheCreateInfo
+{
+    const char* pFilePath; ///< Path of the trace file to write. An existing file is overwritten.
+};
+
+/// Get the memory size for a trace cache layer
+///
+/// @return Minimum size of memory buffer needed to pass to CreateTraceCacheLayer()
+size_t GetTraceCacheLayerSize();
+
+/// Create a cache layer which passes every call to the next layer and records each Query(), Store() and Load() it sees
+/// to a binary access trace. The trace holds hashes, sizes, flags and results but no entry data, so it can be captured
+/// from a production cache hierarchy and replayed against another one with ReplayCacheTrace().
+///
+/// @param [in]     pCreateInfo     Information about cache being created
+/// @param [in]     pPlacementAddr  Pointer to the location where the interface should be constructed. There must
+///                                 be as much size available here as reported by calling GetTraceCacheLayerSize().
+/// @param [out]    ppCacheLayer    Cache layer interface. On failure this value will be set to nullptr.
+///
+/// @returns Success if the cache layer was created. Otherwise, one of the following errors may be returned:
+///         + ErrorInvalidPointer if the file path is nullptr.
+///         + ErrorUnknown if the trace file could not be created.
+Result CreateTraceCacheLayer(
+    const TraceCacheCreateInfo* pCreateInfo,
+    void*                       pPlacementAddr,
+    ICacheLayer**               ppCacheLayer);
+
+/**
+***********************************************************************************************************************
+* @brief Results of replaying a cache access trace with ReplayCacheTrace()
+***********************************************************************************************************************
+*/
+struct CacheTraceReplayStats
+{
+    uint64 recordCount;      ///< Number of records read from the trace
+    uint64 queryCount;       ///< Number of queries replayed
+    uint64 hitCount;         ///< Replayed queries which found an entry
+    uint64 recordedHitCount; ///< Queries which found an entry when the trace was recorded
+    uint64 storeCount;       ///< Number of stores replayed
+    uint64 loadCount;        ///< Number of loads replayed
+    uint64 bytesLoaded;      ///< Total size of the data loaded during replay
+    uint64 elapsedTicks;     ///< Time spent in the replayed calls
+    uint64 ticksPerSecond;   ///< Frequency of elapsedTicks
+};
+
+/// Replay a trace written by a trace cache layer against a cache layer hierarchy. Stores are replayed with generated
+/// data of the recorded size; loads use the result of the latest replayed query for the same hash. Entry references
+/// are never acquired during replay. Combined with ICacheLayer::GetStats() this is the harness used to compare cache
+/// configurations against recorded workloads.
+///
+/// @param [in]     pFilePath   Trace file to replay
+/// @param [in]     pLayer      Top of the cache layer hierarchy to replay against
+/// @param [in]     pCallbacks  Allocation callbacks for temporary replay memory, the default callbacks are used if null
+/// @param [out]    pStats      Optional replay statistics
+///
+/// @returns Success if the whole trace was replayed. Otherwise, one of the following errors may be returned:
+///         + ErrorInvalidPointer if pFilePath or pLayer is nullptr.
+///         + ErrorInvalidFormat if the file is not a supported trace.
+///         + ErrorOutOfMemory if temporary memory could not be allocated.
+///         + ErrorUnknown if the file could not be read.
+Result ReplayCacheTrace(
+    const char*            pFilePath,
+    ICacheLayer*           pLayer,
+    const AllocCallbacks*  pCallbacks,
+    CacheTraceReplayStats* pStats);
+
 } // namespace Util
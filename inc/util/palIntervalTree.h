@@ -155,6 +155,25 @@ public:
         }
     }
 
+    /// In-order traversal of every node which overlaps the specified interval.  Sub-trees which cannot contain an
+    /// overlapping interval are skipped, so this costs O(k + log n) for k overlapping nodes.
+    ///
+    /// @param [in] pInterval Interval to test against; only its low and high bounds are used.
+    /// @param [in] pfnVisit  Function to be called on each overlapping node.
+    /// @param [in] pData     Optional additional data to be passed along on each call to pfnVisit.
+    void OverlappingTraverse(
+        const Interval<T, K>* pInterval,
+        void                (*pfnVisit)(IntervalTreeNode<T, K>*, void*),
+        void*                 pData) const
+    {
+        IntervalTreeNode<T, K>* pRoot = m_pRoot;
+
+        if (pRoot != GetNull())
+        {
+            Overlapping(pRoot, pInterval, pfnVisit, pData);
+        }
+    }
+
     /// Returns the next tree node relative to the specified node.  Returns null if the specified node is the last node
     /// in the tree.
     IntervalTreeNode<T, K>* PrevNode(IntervalTreeNode<T, K>* pNode) const
@@ -190,6 +209,11 @@ private:
     }
 
     void Inorder(IntervalTreeNode<T, K>* pRoot, void (*pfnTraverse)(IntervalTreeNode<T, K>*, void*), void* pData) const;
+    void Overlapping(
+        IntervalTreeNode<T, K>* pRoot,
+        const Interval<T, K>*   pInterval,
+        void                  (*pfnTraverse)(IntervalTreeNode<T, K>*, void*),
+        void*                   pData) const;
     T CalcHighestValue(IntervalTreeNode<T, K>* pNode) const;
 
     IntervalTreeNode<T, K>* Prev(IntervalTreeNode<T, K>* pNode) const;
@@ -384,6 +384,34 @@ PAL_INLINE void IntervalTree<T, K, Allocator>::Inorder(
     }
 }
 
+//======================================================================================================================
+// Overlapping-interval traverse helper.  A left sub-tree is only visited if its highest bound reaches the interval and
+// a right sub-tree only if the current node's low bound doesn't already lie past it (every low bound on the right is at
+// least as large).
+template<typename T, typename K, typename Allocator>
+PAL_INLINE void IntervalTree<T, K, Allocator>::Overlapping(
+    IntervalTreeNode<T, K>* pRoot,
+    const Interval<T, K>*   pInterval,
+    void                  (*pfnTraverse)(IntervalTreeNode<T, K>*, void*),
+    void*                   pData
+    ) const
+{
+    if ((pRoot->pLeftChild != GetNull()) && (pRoot->pLeftChild->highest >= pInterval->low))
+    {
+        Overlapping(pRoot->pLeftChild, pInterval, pfnTraverse, pData);
+    }
+
+    if ((pRoot->interval.low <= pInterval->high) && (pRoot->interval.high >= pInterval->low))
+    {
+        (*pfnTraverse)(pRoot, pData);
+    }
+
+    if ((pRoot->pRightChild != GetNull()) && (pRoot->interval.low <= pInterval->high))
+    {
+        Overlapping(pRoot->pRightChild, pInterval, pfnTraverse, pData);
+    }
+}
+
 //======================================================================================================================
 // Calculates the highest value of sub-tree of pNode.
 template<typename T, typename K, typename Allocator>
@@ -0,0 +1,178 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palTokenStream.h
+ * @brief PAL utility collection TokenChunkPool and TokenStream class declarations.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palAssert.h"
+#include "palMutex.h"
+#include "palSysMemory.h"
+
+namespace Util
+{
+
+/// @internal Header at the start of every chunk of token memory. The token data follows the header.
+struct TokenChunkHeader
+{
+    TokenChunkHeader* pNext;  ///< Next chunk in the owning stream, or in the pool's free list.
+    size_t            size;   ///< Size of the token storage following the header in bytes.
+    size_t            used;   ///< Number of bytes of token storage which have been written.
+    bool              pooled; ///< The chunk belongs to a TokenChunkPool rather than a single oversized token.
+};
+
+/// @internal Offset from a chunk's header to its token storage. Token storage is aligned for any native type.
+constexpr size_t TokenChunkDataOffset =
+    ((sizeof(TokenChunkHeader) + PAL_DEFAULT_MEM_ALIGN - 1) / PAL_DEFAULT_MEM_ALIGN) * PAL_DEFAULT_MEM_ALIGN;
+
+/**
+ ***********************************************************************************************************************
+ * @brief  Thread-safe pool of fixed-size chunks for TokenStream objects.
+ *
+ * One pool is meant to be shared by every token stream of a device. Chunks released by one stream are kept on a free
+ * list and handed to the next stream which needs one, so the memory used for recording reaches a steady state instead
+ * of being reallocated by each command buffer. Free chunks are only returned to the allocator when the pool is
+ * destroyed.
+ ***********************************************************************************************************************
+ */
+template<typename Allocator>
+class TokenChunkPool
+{
+public:
+    /// Constructor.
+    ///
+    /// @param [in] pAllocator The allocator that will allocate chunk memory.
+    /// @param [in] chunkSize  Size of the token storage of each pooled chunk in bytes.
+    TokenChunkPool(Allocator*const pAllocator, size_t chunkSize);
+    ~TokenChunkPool();
+
+    /// Returns the size of the token storage of each pooled chunk in bytes.
+    size_t ChunkSize() const { return m_chunkSize; }
+
+    /// Takes a chunk from the free list, or allocates a new one if the list is empty.
+    ///
+    /// @returns An empty pooled chunk, or null if the allocation failed.
+    TokenChunkHeader* AcquireChunk();
+
+    /// Allocates a chunk for a single token which is larger than ChunkSize(). The chunk is freed when released.
+    ///
+    /// @param [in] size Size of the token storage in bytes.
+    ///
+    /// @returns An empty unpooled chunk, or null if the allocation failed.
+    TokenChunkHeader* AllocateLargeChunk(size_t size);
+
+    /// Returns a chunk to the free list or frees it if it is unpooled.
+    ///
+    /// @param [in] pChunk Chunk previously returned by AcquireChunk() or AllocateLargeChunk().
+    void ReleaseChunk(TokenChunkHeader* pChunk);
+
+private:
+    Allocator*const   m_pAllocator;
+    const size_t      m_chunkSize;
+    Mutex             m_lock;       // Protects the free list.
+    TokenChunkHeader* m_pFreeList;
+
+    PAL_DISALLOW_DEFAULT_CTOR(TokenChunkPool);
+    PAL_DISALLOW_COPY_AND_ASSIGN(TokenChunkPool);
+};
+
+/**
+ ***********************************************************************************************************************
+ * @brief  Append-only stream of variable sized tokens stored in a chain of chunks.
+ *
+ * Tokens are written with Alloc() and read back in the same order with Read(), which must be called with the same size
+ * and alignment that each token was written with. Growing the stream links another chunk from the pool instead of
+ * reallocating, so existing tokens never move and recording never copies the stream. A token which does not fit in the
+ * remainder of the current chunk starts at the beginning of the next one.
+ *
+ * @warning This class is not thread-safe; only the pool is.
+ ***********************************************************************************************************************
+ */
+template<typename Allocator>
+class TokenStream
+{
+public:
+    /// Constructor.
+    ///
+    /// @param [in] pPool The pool which provides this stream's chunks. It must outlive the stream.
+    explicit TokenStream(TokenChunkPool<Allocator>* pPool);
+    ~TokenStream() { Reset(); }
+
+    /// Discards all tokens but keeps the stream's pooled chunks so that recording the same amount again doesn't touch
+    /// the pool.
+    void Rewind();
+
+    /// Discards all tokens and returns every chunk to the pool.
+    void Reset();
+
+    /// Reserves space for a token at the end of the stream.
+    ///
+    /// @param [in] numBytes  Size of the token in bytes; must not be zero.
+    /// @param [in] alignment Required alignment of the token; must be a power of two no larger than
+    ///                       PAL_DEFAULT_MEM_ALIGN.
+    ///
+    /// @returns Pointer to the token's space, or null if a chunk could not be allocated.
+    void* Alloc(size_t numBytes, size_t alignment);
+
+    /// Moves the read position back to the first token.
+    void BeginRead()
+    {
+        m_pReadChunk = (m_pWriteChunk != nullptr) ? m_pFirstChunk : nullptr;
+        m_readOffset = 0;
+    }
+
+    /// Returns the next token and advances the read position past it. Complement of Alloc().
+    ///
+    /// @param [in] numBytes  Size of the token in bytes, as passed to Alloc().
+    /// @param [in] alignment Alignment of the token, as passed to Alloc().
+    ///
+    /// @returns Pointer to the token.
+    void* Read(size_t numBytes, size_t alignment);
+
+    /// Returns true if every token has been read.
+    bool IsReadDone() const
+    {
+        return (m_pReadChunk == nullptr) ||
+               ((m_pReadChunk == m_pWriteChunk) && (m_readOffset == m_pWriteChunk->used));
+    }
+
+private:
+    static void* ChunkData(TokenChunkHeader* pChunk) { return VoidPtrInc(pChunk, TokenChunkDataOffset); }
+
+    TokenChunkPool<Allocator>*const m_pPool;
+    TokenChunkHeader*               m_pFirstChunk; // Head of the chunk chain, including chunks kept by Rewind().
+    TokenChunkHeader*               m_pWriteChunk; // Chunk holding the last token, null if the stream is empty.
+    TokenChunkHeader*               m_pReadChunk;  // Chunk holding the next token to read.
+    size_t                          m_readOffset;  // Offset of the read position within m_pReadChunk.
+
+    PAL_DISALLOW_DEFAULT_CTOR(TokenStream);
+    PAL_DISALLOW_COPY_AND_ASSIGN(TokenStream);
+};
+
+} // Util
@@ -0,0 +1,285 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palTokenStreamImpl.h
+ * @brief PAL utility collection TokenChunkPool and TokenStream class implementations.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palTokenStream.h"
+#include "palInlineFuncs.h"
+
+namespace Util
+{
+
+// =====================================================================================================================
+template<typename Allocator>
+TokenChunkPool<Allocator>::TokenChunkPool(
+    Allocator*const pAllocator,
+    size_t          chunkSize)
+    :
+    m_pAllocator(pAllocator),
+    m_chunkSize(Pow2Align(Max<size_t>(chunkSize, 1), PAL_DEFAULT_MEM_ALIGN)),
+    m_pFreeList(nullptr)
+{
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+TokenChunkPool<Allocator>::~TokenChunkPool()
+{
+    while (m_pFreeList != nullptr)
+    {
+        TokenChunkHeader* pChunk = m_pFreeList;
+        m_pFreeList = pChunk->pNext;
+
+        PAL_FREE(pChunk, m_pAllocator);
+    }
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+TokenChunkHeader* TokenChunkPool<Allocator>::AcquireChunk()
+{
+    TokenChunkHeader* pChunk = nullptr;
+    {
+        MutexAuto lock(&m_lock);
+
+        if (m_pFreeList != nullptr)
+        {
+            pChunk      = m_pFreeList;
+            m_pFreeList = pChunk->pNext;
+        }
+    }
+
+    if (pChunk == nullptr)
+    {
+        pChunk = static_cast<TokenChunkHeader*>(PAL_MALLOC(TokenChunkDataOffset + m_chunkSize,
+                                                           m_pAllocator,
+                                                           AllocInternal));
+
+        if (pChunk != nullptr)
+        {
+            pChunk->size   = m_chunkSize;
+            pChunk->pooled = true;
+        }
+    }
+
+    if (pChunk != nullptr)
+    {
+        pChunk->pNext = nullptr;
+        pChunk->used  = 0;
+    }
+
+    return pChunk;
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+TokenChunkHeader* TokenChunkPool<Allocator>::AllocateLargeChunk(
+    size_t size)
+{
+    TokenChunkHeader* pChunk =
+        static_cast<TokenChunkHeader*>(PAL_MALLOC(TokenChunkDataOffset + size, m_pAllocator, AllocInternal));
+
+    if (pChunk != nullptr)
+    {
+        pChunk->pNext  = nullptr;
+        pChunk->size   = size;
+        pChunk->used   = 0;
+        pChunk->pooled = false;
+    }
+
+    return pChunk;
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+void TokenChunkPool<Allocator>::ReleaseChunk(
+    TokenChunkHeader* pChunk)
+{
+    if (pChunk->pooled)
+    {
+        MutexAuto lock(&m_lock);
+
+        pChunk->pNext = m_pFreeList;
+        m_pFreeList   = pChunk;
+    }
+    else
+    {
+        PAL_FREE(pChunk, m_pAllocator);
+    }
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+TokenStream<Allocator>::TokenStream(
+    TokenChunkPool<Allocator>* pPool)
+    :
+    m_pPool(pPool),
+    m_pFirstChunk(nullptr),
+    m_pWriteChunk(nullptr),
+    m_pReadChunk(nullptr),
+    m_readOffset(0)
+{
+    PAL_ASSERT(m_pPool != nullptr);
+}
+
+// =====================================================================================================================
+// Oversized chunks only fit the token they were made for, so they are freed rather than kept for the next recording.
+template<typename Allocator>
+void TokenStream<Allocator>::Rewind()
+{
+    TokenChunkHeader** ppLink = &m_pFirstChunk;
+
+    while (*ppLink != nullptr)
+    {
+        TokenChunkHeader*const pChunk = *ppLink;
+
+        if (pChunk->pooled)
+        {
+            pChunk->used = 0;
+            ppLink       = &pChunk->pNext;
+        }
+        else
+        {
+            *ppLink = pChunk->pNext;
+            m_pPool->ReleaseChunk(pChunk);
+        }
+    }
+
+    m_pWriteChunk = nullptr;
+    m_pReadChunk  = nullptr;
+    m_readOffset  = 0;
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+void TokenStream<Allocator>::Reset()
+{
+    while (m_pFirstChunk != nullptr)
+    {
+        TokenChunkHeader*const pChunk = m_pFirstChunk;
+        m_pFirstChunk = pChunk->pNext;
+
+        m_pPool->ReleaseChunk(pChunk);
+    }
+
+    m_pWriteChunk = nullptr;
+    m_pReadChunk  = nullptr;
+    m_readOffset  = 0;
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+void* TokenStream<Allocator>::Alloc(
+    size_t numBytes,
+    size_t alignment)
+{
+    PAL_ASSERT(numBytes > 0);
+    PAL_ASSERT(IsPowerOfTwo(alignment) && (alignment <= PAL_DEFAULT_MEM_ALIGN));
+
+    void* pSpace = nullptr;
+
+    if (m_pWriteChunk != nullptr)
+    {
+        const size_t offset = Pow2Align(m_pWriteChunk->used, alignment);
+
+        if ((offset + numBytes) <= m_pWriteChunk->size)
+        {
+            pSpace              = VoidPtrInc(ChunkData(m_pWriteChunk), offset);
+            m_pWriteChunk->used = offset + numBytes;
+        }
+    }
+
+    if (pSpace == nullptr)
+    {
+        // Move on to the next chunk, which may have been kept from an earlier recording. Chunk storage is aligned for
+        // any token, so the token goes at the start of the chunk.
+        TokenChunkHeader* pChunk = (m_pWriteChunk != nullptr) ? m_pWriteChunk->pNext : m_pFirstChunk;
+
+        if ((pChunk == nullptr) || (pChunk->size < numBytes))
+        {
+            TokenChunkHeader*const pNewChunk = (numBytes <= m_pPool->ChunkSize()) ?
+                                               m_pPool->AcquireChunk()            :
+                                               m_pPool->AllocateLargeChunk(numBytes);
+
+            if (pNewChunk != nullptr)
+            {
+                pNewChunk->pNext = pChunk;
+
+                if (m_pWriteChunk != nullptr)
+                {
+                    m_pWriteChunk->pNext = pNewChunk;
+                }
+                else
+                {
+                    m_pFirstChunk = pNewChunk;
+                }
+            }
+
+            pChunk = pNewChunk;
+        }
+
+        if (pChunk != nullptr)
+        {
+            pChunk->used  = numBytes;
+            m_pWriteChunk = pChunk;
+            pSpace        = ChunkData(pChunk);
+        }
+    }
+
+    return pSpace;
+}
+
+// =====================================================================================================================
+template<typename Allocator>
+void* TokenStream<Allocator>::Read(
+    size_t numBytes,
+    size_t alignment)
+{
+    PAL_ASSERT(IsReadDone() == false);
+
+    size_t offset = Pow2Align(m_readOffset, alignment);
+
+    // Alloc() moved to the next chunk whenever a token didn't fit, and a chunk's used size stops short of any token
+    // which didn't fit in it.
+    if ((offset + numBytes) > m_pReadChunk->used)
+    {
+        m_pReadChunk = m_pReadChunk->pNext;
+        offset       = 0;
+    }
+
+    PAL_ASSERT((m_pReadChunk != nullptr) && ((offset + numBytes) <= m_pReadChunk->used));
+
+    m_readOffset = offset + numBytes;
+
+    return VoidPtrInc(ChunkData(m_pReadChunk), offset);
+}
+
+} // Util
@@ -25,8 +25,11 @@
 
 #include "core/device.h"
 #include "core/image.h"
+#include "core/platform.h"
 #include "core/addrMgr/addrMgr2/addrMgr2.h"
 #include "palFormatInfo.h"
+#include "palHashMapImpl.h"
+#include "palMetroHash.h"
 #include "core/settingsLoader.h"
 
 using namespace Util;
@@ -36,8 +39,8 @@ namespace Pal
 namespace AddrMgr2
 {
 
-// Maximum number of mipmap levels we expect to see in an Image.
-constexpr uint32 MaxImageMipLevels = 15;
+// Number of buckets used by each of the surface info cache hash maps.
+constexpr uint32 SurfCacheNumBuckets = 64;
 
 // =====================================================================================================================
 AddrMgr2::AddrMgr2(
@@ -46,10 +49,51 @@ AddrMgr2::AddrMgr2(
     // Note: Each subresource for AddrMgr2 hardware needs the following tiling information: the actual tiling
     // information for itself as computed by the AddrLib.
     AddrMgr(pDevice, sizeof(TileInfo)),
-    m_varBlockSize(pDevice->GetGfxDevice()->GetVarBlockSize())
+    m_varBlockSize(pDevice->GetGfxDevice()->GetVarBlockSize()),
+    m_surfSettingCache(SurfCacheNumBuckets, pDevice->GetPlatform()),
+    m_surfInfoCache(SurfCacheNumBuckets, pDevice->GetPlatform()),
+    m_surfCacheHits(0),
+    m_surfCacheMisses(0)
 {
 }
 
+// =====================================================================================================================
+AddrMgr2::~AddrMgr2()
+{
+    Platform*const pPlatform = m_pDevice->GetPlatform();
+
+    for (auto iter = m_surfSettingCache.Begin(); iter.Get() != nullptr; iter.Next())
+    {
+        PAL_SAFE_DELETE(iter.Get()->value, pPlatform);
+    }
+
+    for (auto iter = m_surfInfoCache.Begin(); iter.Get() != nullptr; iter.Next())
+    {
+        PAL_SAFE_DELETE(iter.Get()->value, pPlatform);
+    }
+
+    PAL_DPINFO("AddrMgr2 surface info cache: %llu hits, %llu misses.", m_surfCacheHits, m_surfCacheMisses);
+}
+
+// =====================================================================================================================
+// Initializes the address library and the surface info cache.
+Result AddrMgr2::Init()
+{
+    Result result = AddrMgr::Init();
+
+    if (result == Result::Success)
+    {
+        result = m_surfSettingCache.Init();
+    }
+
+    if (result == Result::Success)
+    {
+        result = m_surfInfoCache.Init();
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 Result Create(
     const Device*  pDevice,
@@ -783,13 +827,13 @@ Result AddrMgr2::ComputePlaneSwizzleMode(
         surfSettingInput.preferredSwSet.sw_R = 0;
     }
 
-    ADDR_E_RETURNCODE addrRet = Addr2GetPreferredSurfaceSetting(AddrLibHandle(), &surfSettingInput, pOut);
+    ADDR_E_RETURNCODE addrRet = GetPreferredSurfaceSetting(surfSettingInput, pOut);
 
     // It's possible that we can't get what we preferr so retry using the full permitted mask.
     if ((addrRet != ADDR_OK) && (surfSettingInput.preferredSwSet.value != permittedSwSet.value))
     {
         surfSettingInput.preferredSwSet = permittedSwSet;
-        addrRet = Addr2GetPreferredSurfaceSetting(AddrLibHandle(), &surfSettingInput, pOut);
+        addrRet = GetPreferredSurfaceSetting(surfSettingInput, pOut);
     }
 
     if (addrRet == ADDR_OK)
@@ -972,7 +1016,7 @@ Result AddrMgr2::ComputeAlignedPlaneDimensions(
         surfInfoIn.pitchInElement = Util::Pow2Align(surfInfoIn.width, Gfx9LinearAlign * 2);
     }
 
-    ADDR_E_RETURNCODE addrRet = Addr2ComputeSurfaceInfo(AddrLibHandle(), &surfInfoIn, pOut);
+    ADDR_E_RETURNCODE addrRet = ComputeSurfaceInfo(surfInfoIn, pOut);
     if (addrRet == ADDR_OK)
     {
         pBaseTileInfo->ePitch = CalcEpitch(pOut);
@@ -1247,6 +1291,181 @@ Result AddrMgr2::InitSubresourceInfo(
     return result;
 }
 
+// =====================================================================================================================
+// Returns true if AddrLib surface query results may be looked up in or added to the surface info cache.
+bool AddrMgr2::CanCacheSurfaceInfo() const
+{
+    return (m_pDevice->Settings().addr2SurfaceInfoCacheSize > 0);
+}
+
+// =====================================================================================================================
+// Wrapper around Addr2GetPreferredSurfaceSetting which first consults the surface info cache. Only successful results
+// are cached; failed queries always go through AddrLib so that the caller sees the same error code.
+ADDR_E_RETURNCODE AddrMgr2::GetPreferredSurfaceSetting(
+    const ADDR2_GET_PREFERRED_SURF_SETTING_INPUT& input,
+    ADDR2_GET_PREFERRED_SURF_SETTING_OUTPUT*      pOut
+    ) const
+{
+    ADDR_E_RETURNCODE addrRet   = ADDR_ERROR;
+    bool              found     = false;
+    const bool        cacheable = CanCacheSurfaceInfo();
+    uint64            key       = 0;
+
+    if (cacheable)
+    {
+        MetroHash64::Hash(reinterpret_cast<const uint8*>(&input), sizeof(input), reinterpret_cast<uint8*>(&key));
+
+        RWLockAuto<RWLock::ReadOnly> lock(&m_surfCacheLock);
+
+        SurfSettingCacheEntry*const* ppEntry = m_surfSettingCache.FindKey(key);
+
+        // The hash only identifies a candidate; the full input must match to guard against collisions.
+        if ((ppEntry != nullptr) && (memcmp(&(*ppEntry)->input, &input, sizeof(input)) == 0))
+        {
+            *pOut = (*ppEntry)->output;
+            found = true;
+        }
+    }
+
+    if (found)
+    {
+        AtomicIncrement64(&m_surfCacheHits);
+        addrRet = ADDR_OK;
+    }
+    else
+    {
+        addrRet = Addr2GetPreferredSurfaceSetting(AddrLibHandle(), &input, pOut);
+
+        if (cacheable)
+        {
+            AtomicIncrement64(&m_surfCacheMisses);
+        }
+
+        if (cacheable && (addrRet == ADDR_OK))
+        {
+            RWLockAuto<RWLock::ReadWrite> lock(&m_surfCacheLock);
+
+            if ((m_surfSettingCache.GetNumEntries() < m_pDevice->Settings().addr2SurfaceInfoCacheSize) &&
+                (m_surfSettingCache.FindKey(key) == nullptr))
+            {
+                SurfSettingCacheEntry* pEntry = PAL_NEW(SurfSettingCacheEntry,
+                                                        m_pDevice->GetPlatform(),
+                                                        SystemAllocType::AllocInternal);
+                if (pEntry != nullptr)
+                {
+                    pEntry->input  = input;
+                    pEntry->output = *pOut;
+
+                    if (m_surfSettingCache.Insert(key, pEntry) != Result::Success)
+                    {
+                        PAL_SAFE_DELETE(pEntry, m_pDevice->GetPlatform());
+                    }
+                }
+            }
+        }
+    }
+
+    return addrRet;
+}
+
+// =====================================================================================================================
+// Wrapper around Addr2ComputeSurfaceInfo which first consults the surface info cache. The caller must supply the mip
+// info array (and the stereo info structure if the qbStereo flag is set) in the output structure.
+ADDR_E_RETURNCODE AddrMgr2::ComputeSurfaceInfo(
+    const ADDR2_COMPUTE_SURFACE_INFO_INPUT& input,
+    ADDR2_COMPUTE_SURFACE_INFO_OUTPUT*      pOut
+    ) const
+{
+    PAL_ASSERT(pOut->pMipInfo != nullptr);
+
+    ADDR_E_RETURNCODE addrRet   = ADDR_ERROR;
+    bool              found     = false;
+    const bool        cacheable = CanCacheSurfaceInfo() && (input.numMipLevels <= MaxImageMipLevels);
+    uint64            key       = 0;
+
+    // These pointers belong to the caller and must survive the structure copy from a cached result.
+    ADDR2_MIP_INFO*const    pMipInfo    = pOut->pMipInfo;
+    ADDR_QBSTEREOINFO*const pStereoInfo = pOut->pStereoInfo;
+
+    if (cacheable)
+    {
+        MetroHash64::Hash(reinterpret_cast<const uint8*>(&input), sizeof(input), reinterpret_cast<uint8*>(&key));
+
+        RWLockAuto<RWLock::ReadOnly> lock(&m_surfCacheLock);
+
+        SurfInfoCacheEntry*const* ppEntry = m_surfInfoCache.FindKey(key);
+
+        if ((ppEntry != nullptr) && (memcmp(&(*ppEntry)->input, &input, sizeof(input)) == 0))
+        {
+            const SurfInfoCacheEntry& entry = **ppEntry;
+
+            *pOut             = entry.output;
+            pOut->pMipInfo    = pMipInfo;
+            pOut->pStereoInfo = pStereoInfo;
+
+            memcpy(pMipInfo, &entry.mipInfo[0], sizeof(ADDR2_MIP_INFO) * input.numMipLevels);
+
+            if (pStereoInfo != nullptr)
+            {
+                *pStereoInfo = entry.stereoInfo;
+            }
+
+            found = true;
+        }
+    }
+
+    if (found)
+    {
+        AtomicIncrement64(&m_surfCacheHits);
+        addrRet = ADDR_OK;
+    }
+    else
+    {
+        addrRet = Addr2ComputeSurfaceInfo(AddrLibHandle(), &input, pOut);
+
+        if (cacheable)
+        {
+            AtomicIncrement64(&m_surfCacheMisses);
+        }
+
+        if (cacheable && (addrRet == ADDR_OK))
+        {
+            RWLockAuto<RWLock::ReadWrite> lock(&m_surfCacheLock);
+
+            if ((m_surfInfoCache.GetNumEntries() < m_pDevice->Settings().addr2SurfaceInfoCacheSize) &&
+                (m_surfInfoCache.FindKey(key) == nullptr))
+            {
+                SurfInfoCacheEntry* pEntry = PAL_NEW(SurfInfoCacheEntry,
+                                                     m_pDevice->GetPlatform(),
+                                                     SystemAllocType::AllocInternal);
+                if (pEntry != nullptr)
+                {
+                    memset(pEntry, 0, sizeof(*pEntry));
+
+                    pEntry->input              = input;
+                    pEntry->output             = *pOut;
+                    pEntry->output.pMipInfo    = nullptr;
+                    pEntry->output.pStereoInfo = nullptr;
+
+                    memcpy(&pEntry->mipInfo[0], pMipInfo, sizeof(ADDR2_MIP_INFO) * input.numMipLevels);
+
+                    if (pStereoInfo != nullptr)
+                    {
+                        pEntry->stereoInfo = *pStereoInfo;
+                    }
+
+                    if (m_surfInfoCache.Insert(key, pEntry) != Result::Success)
+                    {
+                        PAL_SAFE_DELETE(pEntry, m_pDevice->GetPlatform());
+                    }
+                }
+            }
+        }
+    }
+
+    return addrRet;
+}
+
 // =====================================================================================================================
 // Returns the size of one block (i.e., one tile) in terms of bytes.
 uint32 AddrMgr2::GetBlockSize(
@@ -27,6 +27,8 @@
 
 #include "core/image.h"
 #include "core/addrMgr/addrMgr.h"
+#include "palHashMap.h"
+#include "palMutex.h"
 
 // Need the HW version of the tiling definitions
 #include "core/hw/gfxip/gfx9/chip/gfx9_plus_merged_enum.h"
@@ -34,10 +36,14 @@
 namespace Pal
 {
 class   Device;
+class   Platform;
 
 namespace AddrMgr2
 {
 
+// Maximum number of mipmap levels we expect to see in an Image.
+constexpr uint32 MaxImageMipLevels = 15;
+
 // Unique image tile token.
 union TileToken
 {
@@ -62,6 +68,23 @@ struct TileInfo
     gpusize  mipTailMask;        // mask for mip tail offset
 };
 
+// Memoized result of Addr2GetPreferredSurfaceSetting for one set of inputs.
+struct SurfSettingCacheEntry
+{
+    ADDR2_GET_PREFERRED_SURF_SETTING_INPUT  input;
+    ADDR2_GET_PREFERRED_SURF_SETTING_OUTPUT output;
+};
+
+// Memoized result of Addr2ComputeSurfaceInfo for one set of inputs. The pointers in the cached output structure are
+// never valid; the data they would reference is stored alongside it instead.
+struct SurfInfoCacheEntry
+{
+    ADDR2_COMPUTE_SURFACE_INFO_INPUT  input;
+    ADDR2_COMPUTE_SURFACE_INFO_OUTPUT output;
+    ADDR2_MIP_INFO                    mipInfo[MaxImageMipLevels];
+    ADDR_QBSTEREOINFO                 stereoInfo;
+};
+
 // =====================================================================================================================
 // Returns a pointer to the tiling info for the subresource with the given index.
 PAL_INLINE const TileInfo* GetTileInfo(
@@ -256,7 +279,9 @@ class AddrMgr2 final : public AddrMgr
 {
 public:
     explicit AddrMgr2(const Device*  pDevice);
-    virtual ~AddrMgr2() {}
+    virtual ~AddrMgr2();
+
+    virtual Result Init() override;
 
     Pal::Gfx9::SWIZZLE_MODE_ENUM GetHwSwizzleMode(AddrSwizzleMode  swizzleMode) const;
 
@@ -289,6 +314,10 @@ public:
 
     virtual uint32 GetBlockSize(AddrSwizzleMode swizzleMode) const override;
 
+    // Returns the number of AddrLib surface queries which were satisfied by (or missed) the surface info cache.
+    uint64 SurfaceCacheHits() const   { return m_surfCacheHits; }
+    uint64 SurfaceCacheMisses() const { return m_surfCacheMisses; }
+
 protected:
     virtual void ComputeTilesInMipTail(
         const Image&       image,
@@ -357,10 +386,32 @@ private:
         SubResourceInfo* pSubResInfo,
         AddrSwizzleMode  swizzleMode) const;
 
+    ADDR_E_RETURNCODE GetPreferredSurfaceSetting(
+        const ADDR2_GET_PREFERRED_SURF_SETTING_INPUT& input,
+        ADDR2_GET_PREFERRED_SURF_SETTING_OUTPUT*      pOut) const;
+
+    ADDR_E_RETURNCODE ComputeSurfaceInfo(
+        const ADDR2_COMPUTE_SURFACE_INFO_INPUT& input,
+        ADDR2_COMPUTE_SURFACE_INFO_OUTPUT*      pOut) const;
+
+    bool CanCacheSurfaceInfo() const;
+
     PAL_DISALLOW_DEFAULT_CTOR(AddrMgr2);
     PAL_DISALLOW_COPY_AND_ASSIGN(AddrMgr2);
 
     uint32 m_varBlockSize;
+
+    // AddrLib's surface queries are pure functions of their inputs, so we memoize their results to avoid repeating
+    // the same computations for Images which have identical shapes. Both maps are keyed by a hash of the AddrLib input
+    // structure and own their values; entries are never removed until the AddrMgr is destroyed.
+    typedef Util::HashMap<uint64, SurfSettingCacheEntry*, Platform, Util::JenkinsHashFunc> SurfSettingCache;
+    typedef Util::HashMap<uint64, SurfInfoCacheEntry*, Platform, Util::JenkinsHashFunc>    SurfInfoCache;
+
+    mutable Util::RWLock     m_surfCacheLock;
+    mutable SurfSettingCache m_surfSettingCache;
+    mutable SurfInfoCache    m_surfInfoCache;
+    mutable volatile uint64  m_surfCacheHits;
+    mutable volatile uint64  m_surfCacheMisses;
 };
 
 } // AddrMgr2
@@ -0,0 +1,261 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "core/cmdDumpWriter.h"
+#include "core/platform.h"
+#include "util/lzCodec.h"
+#include "palDequeImpl.h"
+#include "palFile.h"
+
+using namespace Util;
+
+namespace Pal
+{
+
+// =====================================================================================================================
+CmdDumpWriter::CmdDumpWriter(
+    Platform* pPlatform,
+    size_t    maxQueuedBytes,
+    bool      compress)
+    :
+    m_pPlatform(pPlatform),
+    m_maxQueuedBytes(maxQueuedBytes),
+    m_compress(compress),
+    m_pLzHashTable(nullptr),
+    m_queuedBytes(0),
+    m_jobs(pPlatform),
+    m_writerThreadEnd(false)
+{
+}
+
+// =====================================================================================================================
+// Waits for the writer thread to drain all outstanding jobs so that no dump is lost when the owning Queue is destroyed.
+CmdDumpWriter::~CmdDumpWriter()
+{
+    if (m_writerThread.IsCreated())
+    {
+        m_writerThreadEnd = true;
+        m_threadNotify.Post();
+        PAL_ASSERT(m_writerThread.IsNotCurrentThread());
+        m_writerThread.Join();
+    }
+
+    // If the thread was never started (or exited early), write whatever is left on this thread.
+    CmdDumpJob* pJob = nullptr;
+    while (m_jobs.PopFront(&pJob) == Result::Success)
+    {
+        WriteJob(pJob);
+    }
+
+    PAL_SAFE_FREE(m_pLzHashTable, m_pPlatform);
+}
+
+// =====================================================================================================================
+// Callback for executing the writer thread.
+static void WriterThreadCallback(
+    void* pParameter)   // Opaque pointer to a CmdDumpWriter
+{
+    static_cast<CmdDumpWriter*>(pParameter)->RunWriterThread();
+}
+
+// =====================================================================================================================
+Result CmdDumpWriter::Init()
+{
+    Result result = Result::Success;
+
+    if (m_compress)
+    {
+        m_pLzHashTable = static_cast<size_t*>(PAL_MALLOC(sizeof(size_t) * LzHashTableEntries,
+                                                         m_pPlatform,
+                                                         AllocInternal));
+
+        if (m_pLzHashTable == nullptr)
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        result = m_threadNotify.Init(Semaphore::MaximumCountLimit, 0);
+    }
+
+    if (result == Result::Success)
+    {
+        result = m_writerThread.Begin(&WriterThreadCallback, this);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+CmdDumpJob* CmdDumpWriter::CreateJob(
+    const char* pFilename,
+    size_t      dataSize)
+{
+    CmdDumpJob* pJob = static_cast<CmdDumpJob*>(PAL_MALLOC(sizeof(CmdDumpJob) + dataSize,
+                                                           m_pPlatform,
+                                                           AllocInternalTemp));
+    if (pJob != nullptr)
+    {
+        Strncpy(&pJob->filename[0], pFilename, sizeof(pJob->filename));
+        pJob->dataSize = dataSize;
+
+        if (m_compress)
+        {
+            Strncat(&pJob->filename[0], sizeof(pJob->filename), CmdDumpCompressedExt);
+        }
+    }
+
+    return pJob;
+}
+
+// =====================================================================================================================
+void CmdDumpWriter::Enqueue(
+    CmdDumpJob* pJob)
+{
+    bool queued = false;
+    {
+        MutexAuto lock(&m_jobsLock);
+
+        // Always accept a job when nothing is queued so that a single large submission still goes to the thread.
+        if (((m_queuedBytes == 0) || ((m_queuedBytes + pJob->dataSize) <= m_maxQueuedBytes)) &&
+            (m_jobs.PushBack(pJob) == Result::Success))
+        {
+            m_queuedBytes += pJob->dataSize;
+            queued         = true;
+        }
+    }
+
+    if (queued)
+    {
+        m_threadNotify.Post();
+    }
+    else
+    {
+        // The writer thread has fallen too far behind; apply back-pressure by writing this job ourselves.
+        WriteJob(pJob);
+    }
+}
+
+// =====================================================================================================================
+// Executes the background thread which writes queued jobs to disk.
+void CmdDumpWriter::RunWriterThread()
+{
+    while (true)
+    {
+        CmdDumpJob* pJob = nullptr;
+        {
+            MutexAuto lock(&m_jobsLock);
+
+            if (m_jobs.PopFront(&pJob) == Result::Success)
+            {
+                m_queuedBytes -= pJob->dataSize;
+            }
+        }
+
+        if (pJob != nullptr)
+        {
+            WriteJob(pJob);
+        }
+        else if (m_writerThreadEnd)
+        {
+            m_writerThread.End();
+        }
+        else
+        {
+            m_threadNotify.Wait(UINT32_MAX);
+        }
+    }
+
+    PAL_NEVER_CALLED(); // This area should be unreachable.
+}
+
+// =====================================================================================================================
+// Writes the job's contents to its file and frees the job.
+void CmdDumpWriter::WriteJob(
+    CmdDumpJob* pJob)
+{
+    const uint32 fileMode = FileAccessMode::FileAccessWrite | FileAccessMode::FileAccessBinary;
+
+    File   logFile;
+    Result result = logFile.Open(&pJob->filename[0], fileMode);
+
+    PAL_ALERT_MSG(result != Result::Success, "Failed to open CmdBuf dump file '%s'", &pJob->filename[0]);
+
+    if (result == Result::Success)
+    {
+        result = m_compress ? WriteCompressed(&logFile, pJob) : logFile.Write(JobData(pJob), pJob->dataSize);
+
+        // Don't bother returning an error if the command buffer wasn't dumped correctly as we don't want this to
+        // affect operation of the "important" stuff...  but still make it apparent that the dump file isn't accurate.
+        PAL_ALERT(result != Result::Success);
+    }
+
+    PAL_SAFE_FREE(pJob, m_pPlatform);
+}
+
+// =====================================================================================================================
+// Writes the job's contents, compressed, to the given file. The contents are stored as-is behind the same header if
+// compressing them doesn't save any space.
+Result CmdDumpWriter::WriteCompressed(
+    File*       pFile,
+    CmdDumpJob* pJob)
+{
+    const void*const pData = JobData(pJob);
+
+    CmdDumpCompressedHeader header = {};
+    header.magic    = CmdDumpCompressedMagic;
+    header.codec    = static_cast<uint32>(CmdDumpCodec::None);
+    header.dataSize = pJob->dataSize;
+
+    // Compressed data which isn't smaller than the original is of no use, so it's never given more room than that.
+    void*      pCompressed    = PAL_MALLOC(pJob->dataSize, m_pPlatform, AllocInternalTemp);
+    size_t     compressedSize = 0;
+
+    if (pCompressed != nullptr)
+    {
+        MutexAuto lock(&m_compressLock);
+        compressedSize = LzCompress(pData, pJob->dataSize, pCompressed, pJob->dataSize, m_pLzHashTable);
+    }
+
+    if (compressedSize > 0)
+    {
+        header.codec = static_cast<uint32>(CmdDumpCodec::Lz);
+    }
+
+    Result result = pFile->Write(&header, sizeof(header));
+
+    if (result == Result::Success)
+    {
+        result = (compressedSize > 0) ? pFile->Write(pCompressed, compressedSize) : pFile->Write(pData, pJob->dataSize);
+    }
+
+    PAL_SAFE_FREE(pCompressed, m_pPlatform);
+
+    return result;
+}
+
+} // Pal
@@ -0,0 +1,119 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "pal.h"
+#include "palDeque.h"
+#include "palMutex.h"
+#include "palSemaphore.h"
+#include "palThread.h"
+
+namespace Util { class File; }
+
+namespace Pal
+{
+
+// Forward decl's
+class Platform;
+
+// Maximum length of a filename allowed for command buffer dumps.
+constexpr uint32 MaxCmdDumpFilenameLength = 512;
+
+// A complete binary command buffer dump for one submission. The file contents are stored immediately after this
+// structure so that the whole job is a single allocation.
+struct CmdDumpJob
+{
+    char   filename[MaxCmdDumpFilenameLength];  // Path of the dump file to create.
+    size_t dataSize;                            // Number of bytes of file contents following this structure.
+};
+
+// Codecs which may be applied to a compressed command buffer dump.
+enum class CmdDumpCodec : uint32
+{
+    None = 0,   // The dump is stored as-is because compressing it didn't save any space.
+    Lz   = 1,   // The dump is compressed with Util::LzCompress().
+};
+
+// Starts every compressed command buffer dump. The dump's original contents, compressed with the given codec, follow.
+struct CmdDumpCompressedHeader
+{
+    uint32 magic;       // Must be CmdDumpCompressedMagic.
+    uint32 codec;       // CmdDumpCodec applied to the data which follows.
+    uint64 dataSize;    // Size of the dump before compression.
+};
+
+constexpr uint32 CmdDumpCompressedMagic = 0x5A444350; // 'PCDZ'
+
+// File extension appended to the name of compressed command buffer dumps.
+constexpr char CmdDumpCompressedExt[] = ".lz";
+
+// =====================================================================================================================
+// Writes binary command buffer dumps to disk from a background thread. The submitting thread copies the command chunks
+// into a CmdDumpJob and hands it off, so submit-time dumping no longer pays for file I/O. The amount of queued data is
+// bounded; once the bound is reached, jobs are written on the calling thread instead. If requested, each dump is
+// compressed before it is written and its filename gets the CmdDumpCompressedExt extension.
+class CmdDumpWriter
+{
+public:
+    CmdDumpWriter(Platform* pPlatform, size_t maxQueuedBytes, bool compress);
+    ~CmdDumpWriter();
+
+    Result Init();
+
+    // Allocates a job which can hold dataSize bytes of file contents. Returns nullptr if out of memory.
+    CmdDumpJob* CreateJob(const char* pFilename, size_t dataSize);
+
+    // Returns the location of the file contents for the given job.
+    static void* JobData(CmdDumpJob* pJob) { return (pJob + 1); }
+
+    // Transfers ownership of the job to this writer; the job is freed once it has been written.
+    void Enqueue(CmdDumpJob* pJob);
+
+    void RunWriterThread();
+
+private:
+    void WriteJob(CmdDumpJob* pJob);
+    Result WriteCompressed(Util::File* pFile, CmdDumpJob* pJob);
+
+    Platform*const                     m_pPlatform;
+    const size_t                       m_maxQueuedBytes;  // Limit on the file contents which may be queued.
+    const bool                         m_compress;        // Compress each dump before it is written.
+    size_t*                            m_pLzHashTable;    // Scratch state for the LZ compressor.
+    Util::Mutex                        m_compressLock;    // Protects m_pLzHashTable.
+    size_t                             m_queuedBytes;     // File contents currently queued.
+
+    Util::Deque<CmdDumpJob*, Platform> m_jobs;
+    Util::Mutex                        m_jobsLock;        // Protects m_jobs and m_queuedBytes.
+
+    Util::Semaphore                    m_threadNotify;    // Notifies the writer thread of new jobs.
+    Util::Thread                       m_writerThread;
+    volatile bool                      m_writerThreadEnd; // Tells the writer thread to exit once it is idle.
+
+    PAL_DISALLOW_DEFAULT_CTOR(CmdDumpWriter);
+    PAL_DISALLOW_COPY_AND_ASSIGN(CmdDumpWriter);
+};
+
+} // Pal
@@ -42,7 +42,9 @@
 #include "palDequeImpl.h"
 #include "palFormatInfo.h"
 #include "palHashMapImpl.h"
+#include "palIntervalTreeImpl.h"
 #include "palIntrusiveListImpl.h"
+#include "palMetroHash.h"
 #include "palPipeline.h"
 #if defined(__unix__)
 #include "palSettingsFileMgrImpl.h"
@@ -205,6 +207,9 @@ bool Device::DetermineGpuIpLevels(
 // Initial HashMap element size for referenced GPU memory allocations.
 constexpr uint32 ReferencedMemoryMapElements = 2048;
 
+// Initial HashMap element size for shared pipeline code uploads.
+constexpr uint32 SharedPipelineCodeMapElements = 256;
+
 // =====================================================================================================================
 Device::Device(
     Platform*              pPlatform,
@@ -241,6 +246,11 @@ Device::Device(
     m_pDmaUploadRing(nullptr),
     m_referencedGpuMem(ReferencedMemoryMapElements, pPlatform),
     m_referencedGpuMemLock(),
+    m_gpuMemoryVaIndex(pPlatform),
+    m_sharedPipelineCode(SharedPipelineCodeMapElements, pPlatform),
+    m_sharedPipelineCodeLock(),
+    m_sharedPipelineCodeBytesSaved(0),
+    m_sharedPipelineCodeRefs(0),
     m_pAddrMgr(nullptr),
     m_pTrackedCmdAllocator(nullptr),
     m_pUntrackedCmdAllocator(nullptr),
@@ -452,6 +462,11 @@ Result Device::EarlyInit(
 {
     Result result = m_referencedGpuMem.Init();
 
+    if (result == Result::Success)
+    {
+        result = m_sharedPipelineCode.Init();
+    }
+
     if (result == Result::Success)
     {
         result = OsEarlyInit();
@@ -4795,6 +4810,326 @@ void Device::GetReferencedMemoryTotals(
     }
 }
 
+// =====================================================================================================================
+// Records a GPU memory object's virtual address range in the device-wide VA index. Returns the new node, or null if
+// the index couldn't grow; lookups simply won't find the object in that case.
+GpuMemoryVaIndexNode* Device::AddGpuMemoryVaRange(
+    const GpuMemory* pGpuMemory)
+{
+    const GpuMemoryDesc& desc = pGpuMemory->Desc();
+
+    const Interval<gpusize, const GpuMemory*> interval =
+    {
+        desc.gpuVirtAddr,
+        desc.gpuVirtAddr + desc.size - 1,
+        pGpuMemory
+    };
+
+    RWLockAuto<RWLock::ReadWrite> lock(&m_gpuMemoryVaIndexLock);
+
+    return m_gpuMemoryVaIndex.Insert(&interval);
+}
+
+// =====================================================================================================================
+void Device::RemoveGpuMemoryVaRange(
+    GpuMemoryVaIndexNode* pNode)
+{
+    RWLockAuto<RWLock::ReadWrite> lock(&m_gpuMemoryVaIndexLock);
+
+    m_gpuMemoryVaIndex.Delete(pNode);
+}
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+// =====================================================================================================================
+// Translates a GPU VA index node into the range reported to the client.
+static void ConvertVaIndexNode(
+    const GpuMemoryVaIndexNode& node,
+    GpuMemoryVaRange*           pRange)
+{
+    const GpuMemory*const pGpuMemory = node.interval.value;
+
+    // PAL's internal allocations aren't visible to the client, so don't hand them out.
+    pRange->pGpuMemory  = pGpuMemory->IsClient() ? pGpuMemory : nullptr;
+    pRange->gpuVirtAddr = node.interval.low;
+    pRange->size        = node.interval.high - node.interval.low + 1;
+}
+
+// =====================================================================================================================
+// Tracks the smallest GPU memory object which contains an address. Used as the OverlappingTraverse callback of
+// FindGpuMemoryByVa.
+static void FindSmallestVaRange(
+    GpuMemoryVaIndexNode* pNode,
+    void*                 pData)
+{
+    const GpuMemoryVaIndexNode** ppBest = static_cast<const GpuMemoryVaIndexNode**>(pData);
+
+    if ((*ppBest == nullptr) ||
+        ((pNode->interval.high - pNode->interval.low) < ((*ppBest)->interval.high - (*ppBest)->interval.low)))
+    {
+        *ppBest = pNode;
+    }
+}
+
+// =====================================================================================================================
+// Looks up the smallest GPU memory object whose VA range contains the given address.
+Result Device::FindGpuMemoryByVa(
+    gpusize           gpuVirtAddr,
+    GpuMemoryVaRange* pRange
+    ) const
+{
+    Result result = Result::ErrorInvalidPointer;
+
+    if (pRange != nullptr)
+    {
+        const Interval<gpusize, const GpuMemory*> interval = { gpuVirtAddr, gpuVirtAddr, nullptr };
+        const GpuMemoryVaIndexNode*               pBest    = nullptr;
+
+        RWLockAuto<RWLock::ReadOnly> lock(&m_gpuMemoryVaIndexLock);
+
+        m_gpuMemoryVaIndex.OverlappingTraverse(&interval, &FindSmallestVaRange, &pBest);
+
+        if (pBest != nullptr)
+        {
+            ConvertVaIndexNode(*pBest, pRange);
+            result = Result::Success;
+        }
+        else
+        {
+            result = Result::NotFound;
+        }
+    }
+
+    return result;
+}
+
+// Collects the output of FindGpuMemoryInVaRange.
+struct VaRangeQuery
+{
+    GpuMemoryVaRange* pRanges;   // Optional output array.
+    uint32            capacity;  // Size of pRanges.
+    uint32            count;     // Number of overlapping ranges seen so far.
+};
+
+// =====================================================================================================================
+// OverlappingTraverse callback of FindGpuMemoryInVaRange.
+static void CollectVaRange(
+    GpuMemoryVaIndexNode* pNode,
+    void*                 pData)
+{
+    VaRangeQuery*const pQuery = static_cast<VaRangeQuery*>(pData);
+
+    if ((pQuery->pRanges != nullptr) && (pQuery->count < pQuery->capacity))
+    {
+        ConvertVaIndexNode(*pNode, &pQuery->pRanges[pQuery->count]);
+    }
+
+    pQuery->count++;
+}
+
+// =====================================================================================================================
+// Reports every GPU memory object whose VA range overlaps [gpuVirtAddr, gpuVirtAddr + size).
+Result Device::FindGpuMemoryInVaRange(
+    gpusize           gpuVirtAddr,
+    gpusize           size,
+    uint32*           pRangeCount,
+    GpuMemoryVaRange* pRanges
+    ) const
+{
+    Result result = Result::Success;
+
+    if (pRangeCount == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if (size == 0)
+    {
+        result = Result::ErrorInvalidValue;
+    }
+    else
+    {
+        const Interval<gpusize, const GpuMemory*> interval = { gpuVirtAddr, gpuVirtAddr + size - 1, nullptr };
+
+        VaRangeQuery query = {};
+        query.pRanges  = pRanges;
+        query.capacity = *pRangeCount;
+
+        {
+            RWLockAuto<RWLock::ReadOnly> lock(&m_gpuMemoryVaIndexLock);
+            m_gpuMemoryVaIndex.OverlappingTraverse(&interval, &CollectVaRange, &query);
+        }
+
+        if (pRanges == nullptr)
+        {
+            *pRangeCount = query.count;
+        }
+        else if (query.count > query.capacity)
+        {
+            result = Result::ErrorIncompleteResults;
+        }
+        else
+        {
+            *pRangeCount = query.count;
+        }
+    }
+
+    return result;
+}
+#endif
+
+// =====================================================================================================================
+// Looks up a completed pipeline code upload with the given content hash and size. On a hit, a reference is added on
+// the caller's behalf and the upload is returned in pCode.
+bool Device::AcquireSharedPipelineCode(
+    const MetroHash::Hash& hash,
+    gpusize                size,
+    SharedPipelineCode*    pCode)
+{
+    bool found = false;
+
+    MutexAuto lock(&m_sharedPipelineCodeLock);
+
+    SharedPipelineCodeEntry*const pEntry = m_sharedPipelineCode.FindKey(hash.qwords[0]);
+
+    // Uploads which are still being written can't be shared yet, and a matching key with a different upper hash or
+    // size is a collision; the caller simply uploads its own copy in either case.
+    if ((pEntry != nullptr)                   &&
+        (pEntry->complete)                    &&
+        (pEntry->hashHigh  == hash.qwords[1]) &&
+        (pEntry->code.size == size))
+    {
+        pEntry->refCount++;
+        m_sharedPipelineCodeRefs++;
+        m_sharedPipelineCodeBytesSaved += size;
+
+        *pCode = pEntry->code;
+        found  = true;
+    }
+
+    return found;
+}
+
+// =====================================================================================================================
+// Records a new pipeline code upload under the given content hash, holding one reference for the caller. Returns false
+// if the key is already in use (e.g., another thread is uploading the same code), in which case the caller keeps its
+// upload private.
+bool Device::ReserveSharedPipelineCode(
+    const MetroHash::Hash&    hash,
+    const SharedPipelineCode& code)
+{
+    bool reserved = false;
+
+    MutexAuto lock(&m_sharedPipelineCodeLock);
+
+    bool                     existed = false;
+    SharedPipelineCodeEntry* pEntry  = nullptr;
+
+    if ((m_sharedPipelineCode.FindAllocate(hash.qwords[0], &existed, &pEntry) == Result::Success) &&
+        (existed == false))
+    {
+        pEntry->code     = code;
+        pEntry->hashHigh = hash.qwords[1];
+        pEntry->refCount = 1;
+        pEntry->complete = false;
+
+        m_sharedPipelineCodeRefs++;
+        reserved = true;
+    }
+
+    return reserved;
+}
+
+// =====================================================================================================================
+// Marks a reserved pipeline code upload as fully written so that other pipelines may share it.
+void Device::CompleteSharedPipelineCode(
+    const MetroHash::Hash& hash,
+    UploadFenceToken       uploadFence)
+{
+    MutexAuto lock(&m_sharedPipelineCodeLock);
+
+    SharedPipelineCodeEntry*const pEntry = m_sharedPipelineCode.FindKey(hash.qwords[0]);
+    PAL_ASSERT((pEntry != nullptr) && (pEntry->complete == false));
+
+    if (pEntry != nullptr)
+    {
+        pEntry->code.uploadFence = uploadFence;
+        pEntry->complete         = true;
+    }
+}
+
+// =====================================================================================================================
+// Drops one reference to a shared pipeline code upload, freeing its GPU memory once the last pipeline is gone.
+void Device::ReleaseSharedPipelineCode(
+    const MetroHash::Hash& hash)
+{
+    GpuMemory* pGpuMemory = nullptr;
+    gpusize    offset     = 0;
+
+    {
+        MutexAuto lock(&m_sharedPipelineCodeLock);
+
+        SharedPipelineCodeEntry*const pEntry = m_sharedPipelineCode.FindKey(hash.qwords[0]);
+        PAL_ASSERT((pEntry != nullptr) && (pEntry->refCount > 0));
+
+        if (pEntry != nullptr)
+        {
+            m_sharedPipelineCodeRefs--;
+
+            if (--pEntry->refCount == 0)
+            {
+                pGpuMemory = pEntry->code.pGpuMemory;
+                offset     = pEntry->code.offset;
+
+                m_sharedPipelineCode.Erase(hash.qwords[0]);
+            }
+            else
+            {
+                PAL_ASSERT(m_sharedPipelineCodeBytesSaved >= pEntry->code.size);
+                m_sharedPipelineCodeBytesSaved -= pEntry->code.size;
+            }
+        }
+    }
+
+    if (pGpuMemory != nullptr)
+    {
+        MemMgr()->FreeGpuMem(pGpuMemory, offset);
+    }
+}
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+// =====================================================================================================================
+void Device::GetPipelineCodeSharingStats(
+    PipelineCodeSharingStats* pStats
+    ) const
+{
+    PAL_ASSERT(pStats != nullptr);
+
+    MutexAuto lock(&m_sharedPipelineCodeLock);
+
+    pStats->bytesSaved      = m_sharedPipelineCodeBytesSaved;
+    pStats->codeObjectCount = m_sharedPipelineCode.GetNumEntries();
+    pStats->pipelineCount   = m_sharedPipelineCodeRefs;
+}
+#endif
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+// =====================================================================================================================
+void Device::GetStateObjectInterningStats(
+    StateObjectInterningStats* pStats
+    ) const
+{
+    PAL_ASSERT(pStats != nullptr);
+
+    if (m_pGfxDevice != nullptr)
+    {
+        m_pGfxDevice->GetStateObjectInterningStats(pStats);
+    }
+    else
+    {
+        memset(pStats, 0, sizeof(*pStats));
+    }
+}
+#endif
+
 // =====================================================================================================================
 // On a queue's creation, we need to add it to the list of tracked queues for this device.
 Result Device::AddQueue(
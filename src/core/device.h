@@ -1019,6 +1019,16 @@ struct GpuChipProperties
 // Helper function that calculates memory ops per clock for a given memory type.
 uint32 MemoryOpsPerClock(LocalMemoryType memoryType);
 
+// Describes a pipeline code upload which is shared by every pipeline whose uploaded code and data are identical.
+struct SharedPipelineCode
+{
+    GpuMemory*        pGpuMemory;     // Internal GPU memory holding the code upload.
+    gpusize           offset;         // Offset of the upload within pGpuMemory.
+    gpusize           size;           // Size of the upload in bytes.
+    UploadFenceToken  uploadFence;    // DMA upload fence which must be waited on before the code is executed.
+    uint64            pagingFenceVal; // Paging fence returned when pGpuMemory was allocated.
+};
+
 // =====================================================================================================================
 // Represents a client-configurable context for a particular physical GPU. Responsibilities include allocating GDS
 // partitions. Also serves as a factory for other child objects, such as Command Buffers.
@@ -1201,6 +1211,15 @@ public:
         bool                waitAll,
         uint64              timeout) const override;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    // NOTE: Part of the public IDevice interface.  OS layers which can wait on fences from a background thread
+    // override this.
+    virtual Result SignalEventOnFenceCompletion(
+        const IFence& fence,
+        Util::Event*  pEvent) override
+        { return Result::Unsupported; }
+#endif
+
     // Queries the size of a GpuMemory object, in bytes.
     virtual size_t GpuMemoryObjectSize() const = 0;
 
@@ -1650,6 +1669,32 @@ public:
     virtual void GetReferencedMemoryTotals(
         gpusize  referencedGpuMemTotal[GpuHeapCount]) const override;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    // NOTE: Part of the public IDevice interface.
+    virtual Result FindGpuMemoryByVa(
+        gpusize           gpuVirtAddr,
+        GpuMemoryVaRange* pRange) const override;
+
+    // NOTE: Part of the public IDevice interface.
+    virtual Result FindGpuMemoryInVaRange(
+        gpusize           gpuVirtAddr,
+        gpusize           size,
+        uint32*           pRangeCount,
+        GpuMemoryVaRange* pRanges) const override;
+#endif
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    // NOTE: Part of the public IDevice interface.
+    virtual void GetPipelineCodeSharingStats(
+        PipelineCodeSharingStats* pStats) const override;
+#endif
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    // NOTE: Part of the public IDevice interface.
+    virtual void GetStateObjectInterningStats(
+        StateObjectInterningStats* pStats) const override;
+#endif
+
     static Result ValidateBindObjectMemoryInput(
         const IGpuMemory* pMemObject,
         gpusize           offset,
@@ -1903,6 +1948,19 @@ public:
         IGpuMemory*const* ppGpuMemory,
         bool              forceSubtract);
 
+    // Add or remove a GPU memory object's virtual address range from the device-wide VA index used by
+    // FindGpuMemoryByVa. The returned node must be passed back to RemoveGpuMemoryVaRange before the object dies.
+    GpuMemoryVaIndexNode* AddGpuMemoryVaRange(const GpuMemory* pGpuMemory);
+    void RemoveGpuMemoryVaRange(GpuMemoryVaIndexNode* pNode);
+
+    // Device-wide cache of pipeline code uploads, keyed by a hash of the uploaded content and relocations. A pipeline
+    // which misses reserves the key, uploads its code, then completes the entry so that later pipelines can share it.
+    // Every successful Acquire or Reserve must be paired with a call to ReleaseSharedPipelineCode.
+    bool AcquireSharedPipelineCode(const Util::MetroHash::Hash& hash, gpusize size, SharedPipelineCode* pCode);
+    bool ReserveSharedPipelineCode(const Util::MetroHash::Hash& hash, const SharedPipelineCode& code);
+    void CompleteSharedPipelineCode(const Util::MetroHash::Hash& hash, UploadFenceToken uploadFence);
+    void ReleaseSharedPipelineCode(const Util::MetroHash::Hash& hash);
+
     IfhMode GetIfhMode() const;
 
     // Helper for creating DmaUploadRing for PAL internal use.
@@ -2137,6 +2195,26 @@ private:
     Util::Mutex   m_referencedGpuMemLock;
     gpusize       m_referencedGpuMemBytes[GpuHeapCount];
 
+    typedef Util::IntervalTree<gpusize, const GpuMemory*, Platform> GpuMemoryVaIndex;
+
+    GpuMemoryVaIndex      m_gpuMemoryVaIndex;     // Every GPU memory object with a VA, keyed by its VA range.
+    mutable Util::RWLock  m_gpuMemoryVaIndexLock; // Lookups share this lock; only creation and destruction write.
+
+    struct SharedPipelineCodeEntry
+    {
+        SharedPipelineCode  code;
+        uint64              hashHigh; // Upper half of the content hash; the lower half is the map key.
+        uint32              refCount;
+        bool                complete; // The upload has been submitted and may be shared.
+    };
+
+    typedef Util::HashMap<uint64, SharedPipelineCodeEntry, Platform, Util::JenkinsHashFunc> SharedPipelineCodeMap;
+
+    SharedPipelineCodeMap  m_sharedPipelineCode;
+    mutable Util::Mutex    m_sharedPipelineCodeLock;
+    gpusize                m_sharedPipelineCodeBytesSaved;
+    uint32                 m_sharedPipelineCodeRefs;
+
     AddrMgr*               m_pAddrMgr;
     CmdAllocator*          m_pTrackedCmdAllocator;
     CmdAllocator*          m_pUntrackedCmdAllocator;
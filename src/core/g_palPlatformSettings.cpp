@@ -134,6 +134,7 @@ void PlatformSettingsLoader::SetupDefaults()
     m_settings.gpuProfilerConfig.frameCount = 0;
     m_settings.gpuProfilerConfig.recordPipelineStats = false;
     m_settings.gpuProfilerConfig.breakSubmitBatches = false;
+    m_settings.gpuProfilerConfig.replayThreadCount = 0;
     m_settings.gpuProfilerConfig.ignoreNonDrawDispatchCmdBufs = false;
     m_settings.gpuProfilerConfig.useFullPipelineHash = false;
     m_settings.gpuProfilerConfig.traceModeMask = 0x0;
@@ -438,6 +439,11 @@ void PlatformSettingsLoader::ReadSettings(Pal::Device* pDevice)
                            &m_settings.gpuProfilerConfig.breakSubmitBatches,
                            InternalSettingScope::PrivatePalKey);
 
+    pDevice->ReadSetting(pGpuProfilerConfig_ReplayThreadCountStr,
+                           Util::ValueType::Uint,
+                           &m_settings.gpuProfilerConfig.replayThreadCount,
+                           InternalSettingScope::PrivatePalKey);
+
     pDevice->ReadSetting(pGpuProfilerConfig_IgnoreNonDrawDispatchCmdBufsStr,
                            Util::ValueType::Boolean,
                            &m_settings.gpuProfilerConfig.ignoreNonDrawDispatchCmdBufs,
@@ -949,6 +955,11 @@ void PlatformSettingsLoader::InitSettingsInfo()
     info.valueSize = sizeof(m_settings.gpuProfilerConfig.breakSubmitBatches);
     m_settingsInfoMap.Insert(2743656777, info);
 
+    info.type      = SettingType::Uint;
+    info.pValuePtr = &m_settings.gpuProfilerConfig.replayThreadCount;
+    info.valueSize = sizeof(m_settings.gpuProfilerConfig.replayThreadCount);
+    m_settingsInfoMap.Insert(1606231994, info);
+
     info.type      = SettingType::Boolean;
     info.pValuePtr = &m_settings.gpuProfilerConfig.ignoreNonDrawDispatchCmdBufs;
     info.valueSize = sizeof(m_settings.gpuProfilerConfig.ignoreNonDrawDispatchCmdBufs);
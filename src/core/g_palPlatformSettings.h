@@ -182,6 +182,7 @@ struct PalPlatformSettings : public Pal::DriverSettings
         uint32                                      frameCount;
         bool                                        recordPipelineStats;
         bool                                        breakSubmitBatches;
+        uint32                                      replayThreadCount;
         bool                                        ignoreNonDrawDispatchCmdBufs;
         bool                                        useFullPipelineHash;
         uint32                                      traceModeMask;
@@ -317,6 +318,7 @@ static const char* pGpuProfilerConfig_StartFrameStr = "#17496565";
 static const char* pGpuProfilerConfig_FrameCountStr = "#3630548216";
 static const char* pGpuProfilerConfig_RecordPipelineStatsStr = "#1092484338";
 static const char* pGpuProfilerConfig_BreakSubmitBatchesStr = "#2743656777";
+static const char* pGpuProfilerConfig_ReplayThreadCountStr = "#1606231994";
 static const char* pGpuProfilerConfig_IgnoreNonDrawDispatchCmdBufsStr = "#2163321285";
 static const char* pGpuProfilerConfig_UseFullPipelineHashStr = "#3204367348";
 static const char* pGpuProfilerConfig_TraceModeMaskStr = "#2717664970";
@@ -440,6 +442,7 @@ static const SettingNameHash g_palPlatformSettingHashList[] = {
 3630548216,
 1092484338,
 2743656777,
+1606231994,
 2163321285,
 3204367348,
 2717664970,
@@ -81,6 +81,7 @@ void SettingsLoader::SetupDefaults()
     m_settings.addr2DisableXorTileMode = false;
 
     m_settings.addr2DisableSModes8BppColor = false;
+    m_settings.addr2SurfaceInfoCacheSize = 1024;
 #if   (__unix__)
     m_settings.disableOptimizedDisplay = true;
 #else
@@ -88,6 +89,7 @@ void SettingsLoader::SetupDefaults()
 #endif
     m_settings.overlayReportHDR = true;
     m_settings.preferredPipelineUploadHeap = PipelineHeapDeferToClient;
+    m_settings.pipelineCodeSharing = true;
 #if PAL_DEVELOPER_BUILD
     m_settings.insertGuardPageBetweenWddm2VAs = false;
 #endif
@@ -113,6 +115,8 @@ void SettingsLoader::SetupDefaults()
 #endif
     m_settings.submitTimeCmdBufDumpStartFrame = 0;
     m_settings.submitTimeCmdBufDumpEndFrame = 0;
+    m_settings.cmdBufDumpAsyncMaxMemory = 0;
+    m_settings.cmdBufDumpAsyncCompression = true;
     m_settings.logCmdBufCommitSizes = false;
     m_settings.logPipelineElf = false;
     m_settings.pipelineElfLogConfig.logInternal = false;
@@ -148,6 +152,7 @@ void SettingsLoader::SetupDefaults()
     m_settings.maxThreadGroupsPerComputeUnit = 0;
     m_settings.maxScratchRingSizeBaseline = 268435456;
     m_settings.maxScratchRingScalePct = 10;
+    m_settings.scratchRingPresizing = false;
     m_settings.ifhGpuMask = 0xf;
     m_settings.hwCompositingEnabled = true;
     m_settings.mgpuCompatibilityEnabled = true;
@@ -289,6 +294,11 @@ void SettingsLoader::ReadSettings()
                            &m_settings.addr2DisableSModes8BppColor,
                            InternalSettingScope::PrivatePalKey);
 
+    static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pAddr2SurfaceInfoCacheSizeStr,
+                           Util::ValueType::Uint,
+                           &m_settings.addr2SurfaceInfoCacheSize,
+                           InternalSettingScope::PrivatePalKey);
+
     static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pDisableOptimizedDisplayStr,
                            Util::ValueType::Boolean,
                            &m_settings.disableOptimizedDisplay,
@@ -304,6 +314,11 @@ void SettingsLoader::ReadSettings()
                            &m_settings.preferredPipelineUploadHeap,
                            InternalSettingScope::PrivatePalKey);
 
+    static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pPipelineCodeSharingStr,
+                           Util::ValueType::Boolean,
+                           &m_settings.pipelineCodeSharing,
+                           InternalSettingScope::PrivatePalKey);
+
 #if PAL_DEVELOPER_BUILD
     static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pInsertGuardPageBetweenWddm2VAsStr,
                            Util::ValueType::Boolean,
@@ -387,6 +402,16 @@ void SettingsLoader::ReadSettings()
                            &m_settings.submitTimeCmdBufDumpEndFrame,
                            InternalSettingScope::PrivatePalKey);
 
+    static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pCmdBufDumpAsyncMaxMemoryStr,
+                           Util::ValueType::Uint,
+                           &m_settings.cmdBufDumpAsyncMaxMemory,
+                           InternalSettingScope::PrivatePalKey);
+
+    static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pCmdBufDumpAsyncCompressionStr,
+                           Util::ValueType::Boolean,
+                           &m_settings.cmdBufDumpAsyncCompression,
+                           InternalSettingScope::PrivatePalKey);
+
     static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pLogCmdBufCommitSizesStr,
                            Util::ValueType::Boolean,
                            &m_settings.logCmdBufCommitSizes,
@@ -533,6 +558,11 @@ void SettingsLoader::ReadSettings()
                            &m_settings.maxScratchRingScalePct,
                            InternalSettingScope::PrivatePalKey);
 
+    static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pScratchRingPresizingStr,
+                           Util::ValueType::Boolean,
+                           &m_settings.scratchRingPresizing,
+                           InternalSettingScope::PrivatePalKey);
+
     static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pIfhGpuMaskStr,
                            Util::ValueType::Uint,
                            &m_settings.ifhGpuMask,
@@ -744,6 +774,11 @@ void SettingsLoader::InitSettingsInfo()
     info.valueSize = sizeof(m_settings.addr2DisableSModes8BppColor);
     m_settingsInfoMap.Insert(3379142860, info);
 
+    info.type      = SettingType::Uint;
+    info.pValuePtr = &m_settings.addr2SurfaceInfoCacheSize;
+    info.valueSize = sizeof(m_settings.addr2SurfaceInfoCacheSize);
+    m_settingsInfoMap.Insert(3352804898, info);
+
     info.type      = SettingType::Boolean;
     info.pValuePtr = &m_settings.disableOptimizedDisplay;
     info.valueSize = sizeof(m_settings.disableOptimizedDisplay);
@@ -758,6 +793,11 @@ void SettingsLoader::InitSettingsInfo()
     info.pValuePtr = &m_settings.preferredPipelineUploadHeap;
     info.valueSize = sizeof(m_settings.preferredPipelineUploadHeap);
     m_settingsInfoMap.Insert(1170638299, info);
+
+    info.type      = SettingType::Boolean;
+    info.pValuePtr = &m_settings.pipelineCodeSharing;
+    info.valueSize = sizeof(m_settings.pipelineCodeSharing);
+    m_settingsInfoMap.Insert(253559650, info);
 #if PAL_DEVELOPER_BUILD
 
     info.type      = SettingType::Boolean;
@@ -841,6 +881,16 @@ void SettingsLoader::InitSettingsInfo()
     info.valueSize = sizeof(m_settings.submitTimeCmdBufDumpEndFrame);
     m_settingsInfoMap.Insert(4221961293, info);
 
+    info.type      = SettingType::Uint;
+    info.pValuePtr = &m_settings.cmdBufDumpAsyncMaxMemory;
+    info.valueSize = sizeof(m_settings.cmdBufDumpAsyncMaxMemory);
+    m_settingsInfoMap.Insert(3262374427, info);
+
+    info.type      = SettingType::Boolean;
+    info.pValuePtr = &m_settings.cmdBufDumpAsyncCompression;
+    info.valueSize = sizeof(m_settings.cmdBufDumpAsyncCompression);
+    m_settingsInfoMap.Insert(1125192912, info);
+
     info.type      = SettingType::Boolean;
     info.pValuePtr = &m_settings.logCmdBufCommitSizes;
     info.valueSize = sizeof(m_settings.logCmdBufCommitSizes);
@@ -986,6 +1036,11 @@ void SettingsLoader::InitSettingsInfo()
     info.valueSize = sizeof(m_settings.maxScratchRingScalePct);
     m_settingsInfoMap.Insert(3497759531, info);
 
+    info.type      = SettingType::Boolean;
+    info.pValuePtr = &m_settings.scratchRingPresizing;
+    info.valueSize = sizeof(m_settings.scratchRingPresizing);
+    m_settingsInfoMap.Insert(156947942, info);
+
     info.type      = SettingType::Uint;
     info.pValuePtr = &m_settings.ifhGpuMask;
     info.valueSize = sizeof(m_settings.ifhGpuMask);
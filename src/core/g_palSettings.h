@@ -195,9 +195,11 @@ struct PalSettings : public Pal::DriverSettings
     bool                                        addr2DisableXorTileMode;
 
     bool                                        addr2DisableSModes8BppColor;
+    uint32                                      addr2SurfaceInfoCacheSize;
     bool                                        disableOptimizedDisplay;
     bool                                        overlayReportHDR;
     PreferredPipelineUploadHeap                 preferredPipelineUploadHeap;
+    bool                                        pipelineCodeSharing;
 #if PAL_DEVELOPER_BUILD
     bool                                        insertGuardPageBetweenWddm2VAs;
 #endif
@@ -217,6 +219,8 @@ struct PalSettings : public Pal::DriverSettings
     char                                        cmdBufDumpDirectory[MaxPathStrLen];
     uint32                                      submitTimeCmdBufDumpStartFrame;
     uint32                                      submitTimeCmdBufDumpEndFrame;
+    uint32                                      cmdBufDumpAsyncMaxMemory;
+    bool                                        cmdBufDumpAsyncCompression;
     bool                                        logCmdBufCommitSizes;
     bool                                        logPipelineElf;
     struct {
@@ -248,6 +252,7 @@ struct PalSettings : public Pal::DriverSettings
     uint32                                      maxThreadGroupsPerComputeUnit;
     gpusize                                     maxScratchRingSizeBaseline;
     uint32                                      maxScratchRingScalePct;
+    bool                                        scratchRingPresizing;
     uint32                                      ifhGpuMask;
     bool                                        hwCompositingEnabled;
     bool                                        mgpuCompatibilityEnabled;
@@ -289,9 +294,11 @@ static const char* penableIterate256PreAlignmentStr = "#2507710515";
 static const char* pAddr2DisableXorTileModeStr = "#576052426";
 
 static const char* pAddr2DisableSModes8BppColorStr = "#3379142860";
+static const char* pAddr2SurfaceInfoCacheSizeStr = "#3352804898";
 static const char* pDisableOptimizedDisplayStr = "#3371140286";
 static const char* pOverlayReportHDRStr = "#2354711641";
 static const char* pPreferredPipelineUploadHeapStr = "#1170638299";
+static const char* pPipelineCodeSharingStr = "#253559650";
 #if PAL_DEVELOPER_BUILD
 static const char* pInsertGuardPageBetweenWddm2VAsStr = "#3303637006";
 #endif
@@ -311,6 +318,8 @@ static const char* pCmdBufDumpFormatStr = "#1905164977";
 static const char* pCmdBufDumpDirectoryStr = "#3293295025";
 static const char* pSubmitTimeCmdBufDumpStartFrameStr = "#1639305458";
 static const char* pSubmitTimeCmdBufDumpEndFrameStr = "#4221961293";
+static const char* pCmdBufDumpAsyncMaxMemoryStr = "#3262374427";
+static const char* pCmdBufDumpAsyncCompressionStr = "#1125192912";
 static const char* pLogCmdBufCommitSizesStr = "#2222002517";
 static const char* pLogPipelineElfStr = "#2287487712";
 static const char* pPipelineElfLogConfig_LogInternalStr = "#2576934177";
@@ -340,6 +349,7 @@ static const char* pMaxAvailableVgprStr = "#2116546305";
 static const char* pMaxThreadGroupsPerComputeUnitStr = "#1284517999";
 static const char* pMaxScratchRingSizeBaselineStr = "#913921073";
 static const char* pMaxScratchRingSizeScalePctStr = "#3497759531";
+static const char* pScratchRingPresizingStr = "#156947942";
 static const char* pIfhGpuMaskStr = "#3517626664";
 static const char* pHwCompositingEnabledStr = "#1872169717";
 static const char* pMgpuCompatibilityEnabledStr = "#1177937299";
@@ -382,9 +392,11 @@ static const SettingNameHash g_palSettingHashList[] = {
 576052426,
 
 3379142860,
+3352804898,
 3371140286,
 2354711641,
 1170638299,
+253559650,
 #if PAL_DEVELOPER_BUILD
 3303637006,
 #endif
@@ -404,6 +416,7 @@ static const SettingNameHash g_palSettingHashList[] = {
 3293295025,
 1639305458,
 4221961293,
+3262374427,
 2222002517,
 2287487712,
 2576934177,
@@ -433,6 +446,7 @@ static const SettingNameHash g_palSettingHashList[] = {
 1284517999,
 913921073,
 3497759531,
+156947942,
 3517626664,
 1872169717,
 1177937299,
@@ -323,7 +323,8 @@ GpuMemory::GpuMemory(
     m_minPageSize(PAL_PAGE_BYTES),
     m_remoteSdiSurfaceIndex(0),
     m_remoteSdiMarkerIndex(0),
-    m_markerVirtualAddr(0)
+    m_markerVirtualAddr(0),
+    m_pVaIndexNode(nullptr)
     ,m_mallPolicy(GpuMemMallPolicy::Default)
 {
     memset(&m_desc, 0, sizeof(m_desc));
@@ -630,6 +631,7 @@ Result GpuMemory::Init(
         if (IsErrorResult(result) == false)
         {
             DescribeGpuMemory(Developer::GpuMemoryAllocationMethod::Opened);
+            AddToVaIndex();
         }
     }
     else
@@ -799,6 +801,7 @@ Result GpuMemory::Init(
         if (IsErrorResult(result) == false)
         {
             DescribeGpuMemory(Developer::GpuMemoryAllocationMethod::Normal);
+            AddToVaIndex();
         }
     }
 
@@ -887,6 +890,7 @@ Result GpuMemory::Init(
     if (IsErrorResult(result) == false)
     {
         DescribeGpuMemory(Developer::GpuMemoryAllocationMethod::Svm);
+        AddToVaIndex();
     }
 
     return result;
@@ -935,6 +939,7 @@ Result GpuMemory::Init(
     if (IsErrorResult(result) == false)
     {
         DescribeGpuMemory(Developer::GpuMemoryAllocationMethod::Pinned);
+        AddToVaIndex();
     }
 
     return result;
@@ -1003,6 +1008,7 @@ Result GpuMemory::Init(
     if (IsErrorResult(result) == false)
     {
         DescribeGpuMemory(Developer::GpuMemoryAllocationMethod::Opened);
+        AddToVaIndex();
     }
 
     // Verify that if opening the peer memory connection succeeded, we got a GPU virtual address back as expected.
@@ -1081,6 +1087,7 @@ Result GpuMemory::Init(
     if (IsErrorResult(result) == false)
     {
         DescribeGpuMemory(Developer::GpuMemoryAllocationMethod::Peer);
+        AddToVaIndex();
     }
 
     // Verify that if opening the peer memory connection succeeded, we got a GPU virtual address back as expected.
@@ -1089,6 +1096,33 @@ Result GpuMemory::Init(
     return result;
 }
 
+// =====================================================================================================================
+void GpuMemory::Destroy()
+{
+    // Remove this object from the device's GPU VA index before the OS-specific destructor releases its virtual address,
+    // otherwise a lookup could return this object for a range which has already been given to another allocation.
+    if (m_pVaIndexNode != nullptr)
+    {
+        m_pDevice->RemoveGpuMemoryVaRange(m_pVaIndexNode);
+        m_pVaIndexNode = nullptr;
+    }
+
+    this->~GpuMemory();
+}
+
+// =====================================================================================================================
+// Adds this successfully initialized object to the device's GPU VA index.  Objects without a GPU virtual address (e.g.,
+// page directories on some OSes) aren't indexed.
+void GpuMemory::AddToVaIndex()
+{
+    PAL_ASSERT(m_pVaIndexNode == nullptr);
+
+    if ((m_desc.gpuVirtAddr != 0) && (m_desc.size != 0))
+    {
+        m_pVaIndexNode = m_pDevice->AddGpuMemoryVaRange(this);
+    }
+}
+
 // =====================================================================================================================
 // Destroys an internal GPU memory object: invokes the destructor and frees the system memory block it resides in.
 void GpuMemory::DestroyInternal()
@@ -27,14 +27,19 @@
 
 #include "palGpuMemory.h"
 #include "palInlineFuncs.h"
+#include "palIntervalTree.h"
 #include "palDeveloperHooks.h"
 
 namespace Pal
 {
 
 class  Device;
+class  GpuMemory;
 class  Image;
 class  Queue;
+
+// Node of the device-wide index of GPU memory objects by GPU virtual address range.  See Device::FindGpuMemoryByVa().
+typedef Util::IntervalTreeNode<gpusize, const GpuMemory*> GpuMemoryVaIndexNode;
 struct VirtualMemoryRemapRange;
 struct VirtualMemoryCopyPageMappingsRange;
 enum class VaPartition : uint32;
@@ -197,7 +202,7 @@ public:
 
     // NOTE: Part of the public IDestroyable interface. Since clients own the memory allocation this object resides
     // in, this only invokes the object's destructor.
-    virtual void Destroy() override { this->~GpuMemory(); }
+    virtual void Destroy() override;
     void DestroyInternal();
 
     // NOTE: Part of the public IGpuMemory interface.
@@ -401,9 +406,14 @@ private:
     // heap for client-requested local-only allocations on some OSes.
     virtual void OsFinalizeHeaps() { }
 
+    void AddToVaIndex();
+
     // Marker virtual address as returned by KMD
     gpusize m_markerVirtualAddr;
 
+    // This object's node in the device's GPU VA index, or null if it isn't indexed.
+    GpuMemoryVaIndexNode*  m_pVaIndexNode;
+
     GpuMemMallPolicy  m_mallPolicy;
 #if ( (PAL_CLIENT_INTERFACE_MAJOR_VERSION>= 569))
     GpuMemMallRange   m_mallRange;
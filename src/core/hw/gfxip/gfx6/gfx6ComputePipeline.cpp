@@ -315,12 +315,7 @@ Result ComputePipeline::HwlInit(
         data.pObj = this;
         m_pDevice->GetPlatform()->GetEventProvider()->LogGpuMemoryResourceCreateEvent(data);
 
-        GpuMemoryResourceBindEventData bindData = {};
-        bindData.pObj = this;
-        bindData.pGpuMemory = m_gpuMem.Memory();
-        bindData.requiredGpuMemSize = m_gpuMemSize;
-        bindData.offset = m_gpuMem.Offset();
-        m_pDevice->GetPlatform()->GetEventProvider()->LogGpuMemoryResourceBindEvent(bindData);
+        LogGpuMemoryBindEvents();
     }
 
     return result;
@@ -225,6 +225,14 @@ void SettingsLoader::SetupDefaults()
 
     m_settings.gfx103DisableAsymmetricWgpForPs = false;
 
+    m_settings.cpuIndirectCmdExpansionMaxCount = 0;
+
+    m_settings.stateObjectInterning = false;
+
+    m_settings.bakeGraphicsPipelineRegImage = false;
+
+    m_settings.drawIndexedBatchMaxCount = 0;
+
     m_settings.numSettings = g_gfx9PalNumSettings;
 }
 
@@ -993,6 +1001,26 @@ void SettingsLoader::ReadSettings()
                            &m_settings.gfx103DisableAsymmetricWgpForPs,
                            InternalSettingScope::PrivatePalGfx9Key);
 
+    static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pCpuIndirectCmdExpansionMaxCountStr,
+                           Util::ValueType::Uint,
+                           &m_settings.cpuIndirectCmdExpansionMaxCount,
+                           InternalSettingScope::PrivatePalGfx9Key);
+
+    static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pStateObjectInterningStr,
+                           Util::ValueType::Boolean,
+                           &m_settings.stateObjectInterning,
+                           InternalSettingScope::PrivatePalGfx9Key);
+
+    static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pBakeGraphicsPipelineRegImageStr,
+                           Util::ValueType::Boolean,
+                           &m_settings.bakeGraphicsPipelineRegImage,
+                           InternalSettingScope::PrivatePalGfx9Key);
+
+    static_cast<Pal::Device*>(m_pDevice)->ReadSetting(pDrawIndexedBatchMaxCountStr,
+                           Util::ValueType::Uint,
+                           &m_settings.drawIndexedBatchMaxCount,
+                           InternalSettingScope::PrivatePalGfx9Key);
+
 }
 
 // =====================================================================================================================
@@ -2040,6 +2068,26 @@ void SettingsLoader::InitSettingsInfo()
     info.valueSize = sizeof(m_settings.gfx103DisableAsymmetricWgpForPs);
     m_settingsInfoMap.Insert(2671208712, info);
 
+    info.type      = SettingType::Uint;
+    info.pValuePtr = &m_settings.cpuIndirectCmdExpansionMaxCount;
+    info.valueSize = sizeof(m_settings.cpuIndirectCmdExpansionMaxCount);
+    m_settingsInfoMap.Insert(2218622823, info);
+
+    info.type      = SettingType::Boolean;
+    info.pValuePtr = &m_settings.stateObjectInterning;
+    info.valueSize = sizeof(m_settings.stateObjectInterning);
+    m_settingsInfoMap.Insert(1882927019, info);
+
+    info.type      = SettingType::Boolean;
+    info.pValuePtr = &m_settings.bakeGraphicsPipelineRegImage;
+    info.valueSize = sizeof(m_settings.bakeGraphicsPipelineRegImage);
+    m_settingsInfoMap.Insert(2998056204, info);
+
+    info.type      = SettingType::Uint;
+    info.pValuePtr = &m_settings.drawIndexedBatchMaxCount;
+    info.valueSize = sizeof(m_settings.drawIndexedBatchMaxCount);
+    m_settingsInfoMap.Insert(2666695621, info);
+
 }
 
 // =====================================================================================================================
@@ -346,6 +346,10 @@ struct Gfx9PalSettings : public Pal::DriverSettings
     bool                                        nonLocalDestPreferCompute;
 
     bool                                        gfx103DisableAsymmetricWgpForPs;
+    uint32                                      cpuIndirectCmdExpansionMaxCount;
+    bool                                        stateObjectInterning;
+    bool                                        bakeGraphicsPipelineRegImage;
+    uint32                                      drawIndexedBatchMaxCount;
 
 };
 static const char* pEnableLoadIndexForObjectBindsStr = "#2416072074";
@@ -515,6 +519,14 @@ static const char* pGfx102NonLocalDestPreferComputeStr = "#2724905730";
 
 static const char* pGfx103DisableAsymmetricWgpForPsStr = "#2671208712";
 
+static const char* pCpuIndirectCmdExpansionMaxCountStr = "#2218622823";
+
+static const char* pStateObjectInterningStr = "#1882927019";
+
+static const char* pBakeGraphicsPipelineRegImageStr = "#2998056204";
+
+static const char* pDrawIndexedBatchMaxCountStr = "#2666695621";
+
 static const SettingNameHash g_gfx9PalSettingHashList[] = {
 2416072074,
 
@@ -683,6 +695,14 @@ static const SettingNameHash g_gfx9PalSettingHashList[] = {
 
 2671208712,
 
+2218622823,
+
+1882927019,
+
+2998056204,
+
+2666695621,
+
 };
 static const uint32 g_gfx9PalNumSettings = sizeof(g_gfx9PalSettingHashList) / sizeof(SettingNameHash);
 
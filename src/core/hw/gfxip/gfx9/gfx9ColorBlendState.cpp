@@ -42,7 +42,10 @@ ColorBlendState::ColorBlendState(
     const ColorBlendStateCreateInfo& createInfo)
     :
     Pal::ColorBlendState(),
-    m_device(device)
+    m_device(device),
+    m_pCanonical(nullptr),
+    m_internKey(0),
+    m_internHashHigh(0)
 {
     m_flags.u32All = 0;
     m_flags.rbPlus = device.Settings().gfx9RbPlusEnable;
@@ -54,6 +57,37 @@ ColorBlendState::ColorBlendState(
     Init(createInfo);
 }
 
+// =====================================================================================================================
+// Copies the precomputed state of a device-owned interned object, holding one of its references until destruction.
+ColorBlendState::ColorBlendState(
+    const Device&          device,
+    const ColorBlendState& canonical,
+    uint64                 internKey,
+    uint64                 internHashHigh)
+    :
+    Pal::ColorBlendState(),
+    m_flags(canonical.m_flags),
+    m_device(device),
+    m_pCanonical(&canonical),
+    m_internKey(internKey),
+    m_internHashHigh(internHashHigh)
+{
+    memcpy(&m_cbBlendControl[0], &canonical.m_cbBlendControl[0], sizeof(m_cbBlendControl));
+    memcpy(&m_sxMrtBlendOpt[0],  &canonical.m_sxMrtBlendOpt[0],  sizeof(m_sxMrtBlendOpt));
+    memcpy(&m_blendOpts[0],      &canonical.m_blendOpts[0],      sizeof(m_blendOpts));
+}
+
+// =====================================================================================================================
+void ColorBlendState::Destroy()
+{
+    if (m_pCanonical != nullptr)
+    {
+        m_device.ReleaseInternedState(m_internKey);
+    }
+
+    Pal::ColorBlendState::Destroy();
+}
+
 // =====================================================================================================================
 // Converts a Pal::Blend value to a Gfx9 hardware BlendOp
 BlendOp ColorBlendState::HwBlendOp(
@@ -43,9 +43,20 @@ class ColorBlendState final : public Pal::ColorBlendState
 {
 public:
     ColorBlendState(const Device& device, const ColorBlendStateCreateInfo& createInfo);
+    ColorBlendState(const Device& device, const ColorBlendState& canonical, uint64 internKey, uint64 internHashHigh);
+
+    virtual void Destroy() override;
 
     uint32* WriteCommands(CmdStream* pCmdStream, uint32* pCmdSpace) const;
 
+    // Interned copies with the same 128-bit create info hash program identical registers. Object addresses can't be
+    // compared instead because placement memory and freed canonical objects may be reused for different states.
+    bool MatchesInternedState(const ColorBlendState& other) const
+    {
+        return (m_pCanonical != nullptr) && (other.m_pCanonical != nullptr) &&
+               (m_internKey == other.m_internKey) && (m_internHashHigh == other.m_internHashHigh);
+    }
+
     bool IsBlendEnabled(uint32 slot) const { return ((m_flags.blendEnable & (1 << slot)) != 0); }
 
     uint32 BlendEnableMask() const { return m_flags.blendEnable; }
@@ -97,6 +108,10 @@ private:
 
     GfxBlendOptimizer::BlendOpts  m_blendOpts[MaxColorTargets * GfxBlendOptimizer::NumChannelWriteComb];
 
+    const ColorBlendState*  m_pCanonical;     // Interned state this object was copied from, or null.
+    uint64                  m_internKey;      // Key of m_pCanonical in the device's interned state map.
+    uint64                  m_internHashHigh; // Upper half of the create info hash m_internKey was taken from.
+
     PAL_DISALLOW_COPY_AND_ASSIGN(ColorBlendState);
     PAL_DISALLOW_DEFAULT_CTOR(ColorBlendState);
 };
@@ -1502,13 +1502,40 @@ void ComputeCmdBuffer::CmdExecuteIndirectCmds(
     gpusize                      offset,
     uint32                       maximumCount,
     gpusize                      countGpuAddr)
+{
+    const auto& gfx9Generator = static_cast<const IndirectCmdGenerator&>(generator);
+
+    bool expanded = false;
+
+    // Small workloads with CPU-visible arguments can be expanded into direct dispatches while recording, which skips
+    // the generator shader dispatch and the barriers around it.
+    if ((countGpuAddr == 0uLL) &&
+        (m_device.Settings().cpuIndirectCmdExpansionMaxCount > 0) &&
+        (maximumCount <= m_device.Settings().cpuIndirectCmdExpansionMaxCount) &&
+        gfx9Generator.SupportsCpuExpansion())
+    {
+        expanded = gfx9Generator.ExpandOnCpu(this, gpuMemory, offset, maximumCount);
+    }
+
+    if (expanded == false)
+    {
+        ExecuteIndirectCmdsOnGpu(gfx9Generator, gpuMemory, offset, maximumCount, countGpuAddr);
+    }
+}
+
+// =====================================================================================================================
+// Generates the indirect commands with RPM's generator shader and executes the generated command chunks.
+void ComputeCmdBuffer::ExecuteIndirectCmdsOnGpu(
+    const IndirectCmdGenerator& gfx9Generator,
+    const IGpuMemory&           gpuMemory,
+    gpusize                     offset,
+    uint32                      maximumCount,
+    gpusize                     countGpuAddr)
 {
     // It is only safe to generate indirect commands on a one-time-submit or exclusive-submit command buffer because
     // there is a potential race condition on the memory used to receive the generated commands.
     PAL_ASSERT(IsOneTimeSubmit() || IsExclusiveSubmit());
 
-    const auto& gfx9Generator = static_cast<const IndirectCmdGenerator&>(generator);
-
     if (countGpuAddr == 0uLL)
     {
         // If the count GPU address is zero, then we are expected to use the maximumCount value as the actual number
@@ -36,6 +36,7 @@ namespace Gfx9
 {
 
 class Device;
+class IndirectCmdGenerator;
 
 // =====================================================================================================================
 // GFX9 compute command buffer class: implements GFX9 specific functionality for the ComputeCmdBuffer class.
@@ -254,6 +255,13 @@ private:
     virtual void ActivateQueryType(QueryPoolType queryPoolType) override;
     virtual void DeactivateQueryType(QueryPoolType queryPoolType) override;
 
+    void ExecuteIndirectCmdsOnGpu(
+        const IndirectCmdGenerator& gfx9Generator,
+        const IGpuMemory&           gpuMemory,
+        gpusize                     offset,
+        uint32                      maximumCount,
+        gpusize                     countGpuAddr);
+
     uint32* ValidateDispatch(
         gpusize indirectGpuVirtAddr,
         uint32  xDim,
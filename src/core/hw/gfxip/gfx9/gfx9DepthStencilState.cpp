@@ -36,7 +36,11 @@ namespace Gfx9
 DepthStencilState::DepthStencilState(
     const DepthStencilStateCreateInfo& createInfo)
     :
-    Pal::DepthStencilState()
+    Pal::DepthStencilState(),
+    m_pDevice(nullptr),
+    m_pCanonical(nullptr),
+    m_internKey(0),
+    m_internHashHigh(0)
 {
     memset(&m_flags, 0, sizeof(m_flags));
 
@@ -46,6 +50,36 @@ DepthStencilState::DepthStencilState(
     Init(createInfo);
 }
 
+// =====================================================================================================================
+// Copies the precomputed state of a device-owned interned object, holding one of its references until destruction.
+DepthStencilState::DepthStencilState(
+    const Device&            device,
+    const DepthStencilState& canonical,
+    uint64                   internKey,
+    uint64                   internHashHigh)
+    :
+    Pal::DepthStencilState(),
+    m_flags(canonical.m_flags),
+    m_dbDepthControl(canonical.m_dbDepthControl),
+    m_dbStencilControl(canonical.m_dbStencilControl),
+    m_pDevice(&device),
+    m_pCanonical(&canonical),
+    m_internKey(internKey),
+    m_internHashHigh(internHashHigh)
+{
+}
+
+// =====================================================================================================================
+void DepthStencilState::Destroy()
+{
+    if (m_pCanonical != nullptr)
+    {
+        m_pDevice->ReleaseInternedState(m_internKey);
+    }
+
+    Pal::DepthStencilState::Destroy();
+}
+
 // =====================================================================================================================
 // Helper method to determine if a depth/stencil test operation allows out of order rendering
 static bool CanRunOutOfOrder(
@@ -42,6 +42,21 @@ class DepthStencilState final : public Pal::DepthStencilState
 {
 public:
     explicit DepthStencilState(const DepthStencilStateCreateInfo& createInfo);
+    DepthStencilState(
+        const Device&            device,
+        const DepthStencilState& canonical,
+        uint64                   internKey,
+        uint64                   internHashHigh);
+
+    virtual void Destroy() override;
+
+    // Interned copies with the same 128-bit create info hash program identical registers. Object addresses can't be
+    // compared instead because placement memory and freed canonical objects may be reused for different states.
+    bool MatchesInternedState(const DepthStencilState& other) const
+    {
+        return (m_pCanonical != nullptr) && (other.m_pCanonical != nullptr) &&
+               (m_internKey == other.m_internKey) && (m_internHashHigh == other.m_internHashHigh);
+    }
 
     static CompareRef HwStencilCompare(CompareFunc func);
 
@@ -86,6 +101,11 @@ private:
     regDB_DEPTH_CONTROL    m_dbDepthControl;
     regDB_STENCIL_CONTROL  m_dbStencilControl;
 
+    const Device*             m_pDevice;      // Device which interned m_pCanonical.
+    const DepthStencilState*  m_pCanonical;     // Interned state this object was copied from, or null.
+    uint64                    m_internKey;      // Key of m_pCanonical in the device's interned state map.
+    uint64                    m_internHashHigh; // Upper half of the create info hash m_internKey was taken from.
+
     PAL_DISALLOW_COPY_AND_ASSIGN(DepthStencilState);
     PAL_DISALLOW_DEFAULT_CTOR(DepthStencilState);
 };
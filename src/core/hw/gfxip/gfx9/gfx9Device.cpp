@@ -61,6 +61,8 @@
 #include "palAssert.h"
 #include "palAutoBuffer.h"
 #include "palDequeImpl.h"
+#include "palHashMapImpl.h"
+#include "palMetroHash.h"
 
 #include "palFormatInfo.h"
 
@@ -84,6 +86,9 @@ constexpr uint32 UcodeVersionWithDumpOffsetSupport = 30;
 constexpr uint32 Gfx9UcodeVersionSetShRegOffset256B  = 42;
 constexpr uint32 Gfx10UcodeVersionSetShRegOffset256B = 27;
 
+// Initial bucket count of the interned state object map.
+constexpr uint32 InternedStateMapBuckets = 64;
+
 static PAL_INLINE uint32 ComputeImageViewDepth(
     const ImageViewInfo&   viewInfo,
     const ImageInfo&       imageInfo,
@@ -190,7 +195,12 @@ Device::Device(
     m_pVrsDepthView(nullptr),
     m_gbAddrConfig(m_pParent->ChipProperties().gfx9.gbAddrConfig),
     m_gfxIpLevel(pDevice->ChipProperties().gfxLevel),
-    m_varBlockSize(0)
+    m_varBlockSize(0),
+    m_internedStates(InternedStateMapBuckets, pDevice->GetPlatform()),
+    m_internedStatesLock(),
+    m_internedStateLookups(0),
+    m_internedStateHits(0),
+    m_internedStateRefs(0)
 {
     PAL_ASSERT(((GetGbAddrConfig().bits.NUM_PIPES - GetGbAddrConfig().bits.NUM_RB_PER_SE) < 2) ||
                IsGfx10Plus(m_gfxIpLevel));
@@ -219,6 +229,26 @@ Device::Device(
     }
 }
 
+// =====================================================================================================================
+Device::~Device()
+{
+    // Any interned state left here belongs to objects the client never destroyed.
+    PAL_ALERT(m_internedStateRefs != 0);
+
+    for (auto iter = m_internedStates.Begin(); iter.Get() != nullptr; iter.Next())
+    {
+        IDestroyable*const pCanonical = iter.Get()->value.pCanonical;
+
+        pCanonical->Destroy();
+        PAL_FREE(pCanonical, GetPlatform());
+    }
+
+    if (m_internedStateLookups > 0)
+    {
+        PAL_DPINFO("State object interning: %llu hits in %llu lookups.", m_internedStateHits, m_internedStateLookups);
+    }
+}
+
 // =====================================================================================================================
 // This must clean up all internal GPU memory allocations and all objects created after EarlyInit. Note that EarlyInit
 // is called when the platform creates the device objects so the work it does must be preserved if we are to reuse
@@ -290,6 +320,11 @@ Result Device::EarlyInit()
 
     Result result = m_pRsrcProcMgr->EarlyInit();
 
+    if (result == Result::Success)
+    {
+        result = m_internedStates.Init();
+    }
+
     SetupWorkarounds();
 
     return result;
@@ -1192,24 +1227,45 @@ uint32 Device::GetValidFormatFeatureFlags(
 }
 #endif
 
+// Scratch ring pre-sizing adds at most 1/ScratchPresizeMaxHeadroomDivisor of the required item size as headroom.
+constexpr size_t ScratchPresizeMaxHeadroomDivisor = 4;
+
 // =====================================================================================================================
 // Called during pipeline creation to notify that item-size requirements for each shader ring have changed. These
 // 'largest ring sizes' will be validated at Queue submission time.
 //
+// The scratch rings are also given a predicted reserve size here, driven by the pipeline's scratch metadata, so that
+// each new ring generation is allocated with headroom for the next few pipelines rather than just the current one.
+//
 // NOTE: Since this is called at pipeline-create-time, it can be invoked by multiple threads simultaneously.
 void Device::UpdateLargestRingSizes(
     const ShaderRingItemSizes* pRingSizesNeeded)
 {
+    const bool presizeScratch = Parent()->Settings().scratchRingPresizing;
+
     const MutexAuto lock(&m_ringSizesLock);
 
     // Loop over all ring sizes and check if the ring sizes need to grow at all.
     bool ringSizesDirty = false;
     for (size_t ring = 0; ring < static_cast<size_t>(ShaderRingType::NumUniversal); ++ring)
     {
-        if (pRingSizesNeeded->itemSize[ring] > m_largestRingSizes.itemSize[ring])
+        const size_t itemSize = pRingSizesNeeded->itemSize[ring];
+
+        if (itemSize > m_largestRingSizes.itemSize[ring])
         {
-            m_largestRingSizes.itemSize[ring] = pRingSizesNeeded->itemSize[ring];
+            m_largestRingSizes.itemSize[ring] = itemSize;
             ringSizesDirty = true;
+
+            size_t reserveSize = itemSize;
+            if (presizeScratch &&
+                ((ring == static_cast<size_t>(ShaderRingType::ComputeScratch)) ||
+                 (ring == static_cast<size_t>(ShaderRingType::GfxScratch))))
+            {
+                // Rounding up to a power of two can nearly double a large ring, so the headroom is capped.
+                reserveSize = Min(Pow2Pad(itemSize), itemSize + (itemSize / ScratchPresizeMaxHeadroomDivisor));
+            }
+
+            m_largestRingSizes.itemSizeReserve[ring] = Max(m_largestRingSizes.itemSizeReserve[ring], reserveSize);
         }
     }
 
@@ -1234,6 +1290,188 @@ void Device::GetLargestRingSizes(
            sizeof(m_largestRingSizes));
 }
 
+// Identifies the kind of state object behind an interned state hash, so create infos of different types can't alias.
+enum class InternedStateType : uint32
+{
+    ColorBlend,
+    DepthStencil,
+    Msaa,
+};
+
+// =====================================================================================================================
+// Hashes every color blend create info field which affects the resulting state. Fields are hashed one by one so that
+// structure padding never keeps two identical states apart.
+static void HashStateCreateInfo(
+    const ColorBlendStateCreateInfo& createInfo,
+    MetroHash128*                    pHasher)
+{
+    pHasher->Update(InternedStateType::ColorBlend);
+
+    for (uint32 idx = 0; idx < MaxColorTargets; idx++)
+    {
+        const auto& target = createInfo.targets[idx];
+
+        pHasher->Update(target.blendEnable);
+        pHasher->Update(target.srcBlendColor);
+        pHasher->Update(target.dstBlendColor);
+        pHasher->Update(target.blendFuncColor);
+        pHasher->Update(target.srcBlendAlpha);
+        pHasher->Update(target.dstBlendAlpha);
+        pHasher->Update(target.blendFuncAlpha);
+    }
+}
+
+// =====================================================================================================================
+// Hashes every depth stencil create info field which affects the resulting state, ignoring the reserved flag bits.
+static void HashStateCreateInfo(
+    const DepthStencilStateCreateInfo& createInfo,
+    MetroHash128*                      pHasher)
+{
+    pHasher->Update(InternedStateType::DepthStencil);
+
+    const DepthStencilStateCreateInfo::DepthStencilOp* const pOps[] = { &createInfo.front, &createInfo.back };
+
+    for (const auto* pOp : pOps)
+    {
+        pHasher->Update(pOp->stencilFailOp);
+        pHasher->Update(pOp->stencilPassOp);
+        pHasher->Update(pOp->stencilDepthFailOp);
+        pHasher->Update(pOp->stencilFunc);
+    }
+
+    pHasher->Update(createInfo.depthFunc);
+    pHasher->Update(static_cast<uint8>(createInfo.depthEnable));
+    pHasher->Update(static_cast<uint8>(createInfo.depthWriteEnable));
+    pHasher->Update(static_cast<uint8>(createInfo.depthBoundsEnable));
+    pHasher->Update(static_cast<uint8>(createInfo.stencilEnable));
+}
+
+// =====================================================================================================================
+// Hashes every MSAA create info field which affects the resulting state, ignoring the reserved flag bits.
+static void HashStateCreateInfo(
+    const MsaaStateCreateInfo& createInfo,
+    MetroHash128*              pHasher)
+{
+    pHasher->Update(InternedStateType::Msaa);
+    pHasher->Update(createInfo.coverageSamples);
+    pHasher->Update(createInfo.exposedSamples);
+    pHasher->Update(createInfo.pixelShaderSamples);
+    pHasher->Update(createInfo.depthStencilSamples);
+    pHasher->Update(createInfo.shaderExportMaskSamples);
+    pHasher->Update(createInfo.sampleMask);
+    pHasher->Update(createInfo.sampleClusters);
+    pHasher->Update(createInfo.alphaToCoverageSamples);
+    pHasher->Update(createInfo.occlusionQuerySamples);
+    pHasher->Update(createInfo.conservativeRasterizationMode);
+    pHasher->Update(static_cast<uint32>(createInfo.flags.enableConservativeRasterization));
+    pHasher->Update(static_cast<uint32>(createInfo.flags.enable1xMsaaSampleLocations));
+    pHasher->Update(static_cast<uint32>(createInfo.flags.disableAlphaToCoverageDither));
+    pHasher->Update(static_cast<uint32>(createInfo.flags.enableLineStipple));
+}
+
+// =====================================================================================================================
+static ColorBlendState* ConstructStateObject(
+    const Device&                    device,
+    const ColorBlendStateCreateInfo& createInfo,
+    void*                            pPlacementAddr)
+{
+    return PAL_PLACEMENT_NEW(pPlacementAddr) ColorBlendState(device, createInfo);
+}
+
+// =====================================================================================================================
+static DepthStencilState* ConstructStateObject(
+    const Device&                      device,
+    const DepthStencilStateCreateInfo& createInfo,
+    void*                              pPlacementAddr)
+{
+    return PAL_PLACEMENT_NEW(pPlacementAddr) DepthStencilState(createInfo);
+}
+
+// =====================================================================================================================
+static MsaaState* ConstructStateObject(
+    const Device&              device,
+    const MsaaStateCreateInfo& createInfo,
+    void*                      pPlacementAddr)
+{
+    return PAL_PLACEMENT_NEW(pPlacementAddr) MsaaState(device, createInfo);
+}
+
+// =====================================================================================================================
+// Creates a color blend, depth stencil or MSAA state object in the client's memory. When state object interning is
+// enabled, the object is copied from a device-owned canonical object with the same create info hash, which is built
+// first if this is the only live object with that hash. A hash collision falls back to building a private object.
+template <typename StateObject, typename CreateInfo>
+StateObject* Device::CreateStateObject(
+    const CreateInfo& createInfo,
+    void*             pPlacementAddr
+    ) const
+{
+    StateObject* pState = nullptr;
+
+    if (Settings().stateObjectInterning)
+    {
+        MetroHash::Hash hash = {};
+        MetroHash128    hasher;
+        HashStateCreateInfo(createInfo, &hasher);
+        hasher.Finalize(hash.bytes);
+
+        MutexAuto lock(&m_internedStatesLock);
+
+        bool                existed = false;
+        InternedStateEntry* pEntry  = nullptr;
+
+        m_internedStateLookups++;
+
+        if (m_internedStates.FindAllocate(hash.qwords[0], &existed, &pEntry) == Result::Success)
+        {
+            if (existed == false)
+            {
+                void*const pMemory = PAL_MALLOC(sizeof(StateObject), GetPlatform(), AllocInternal);
+
+                if (pMemory != nullptr)
+                {
+                    pEntry->pCanonical = ConstructStateObject(*this, createInfo, pMemory);
+                    pEntry->hashHigh   = hash.qwords[1];
+                    pEntry->refCount   = 0;
+                }
+                else
+                {
+                    m_internedStates.Erase(hash.qwords[0]);
+                    pEntry = nullptr;
+                }
+            }
+            else if (pEntry->hashHigh == hash.qwords[1])
+            {
+                m_internedStateHits++;
+            }
+            else
+            {
+                pEntry = nullptr;
+            }
+
+            if (pEntry != nullptr)
+            {
+                const StateObject& canonical = *static_cast<const StateObject*>(pEntry->pCanonical);
+
+                pState = PAL_PLACEMENT_NEW(pPlacementAddr) StateObject(*this,
+                                                                       canonical,
+                                                                       hash.qwords[0],
+                                                                       hash.qwords[1]);
+
+                pEntry->refCount++;
+                m_internedStateRefs++;
+            }
+        }
+    }
+
+    if (pState == nullptr)
+    {
+        pState = ConstructStateObject(*this, createInfo, pPlacementAddr);
+    }
+
+    return pState;
+}
+
 // =====================================================================================================================
 size_t Device::GetColorBlendStateSize(
     const ColorBlendStateCreateInfo& createInfo,
@@ -1255,7 +1493,7 @@ Result Device::CreateColorBlendState(
     IColorBlendState**               ppColorBlendState
     ) const
 {
-    *ppColorBlendState = PAL_PLACEMENT_NEW(pPlacementAddr) ColorBlendState(*this, createInfo);
+    *ppColorBlendState = CreateStateObject<ColorBlendState>(createInfo, pPlacementAddr);
     PAL_ASSERT(*ppColorBlendState != nullptr);
 
     return Result::Success;
@@ -1282,7 +1520,7 @@ Result Device::CreateDepthStencilState(
     IDepthStencilState**               ppDepthStencilState
     ) const
 {
-    *ppDepthStencilState = PAL_PLACEMENT_NEW(pPlacementAddr) DepthStencilState(createInfo);
+    *ppDepthStencilState = CreateStateObject<DepthStencilState>(createInfo, pPlacementAddr);
     PAL_ASSERT(*ppDepthStencilState != nullptr);
 
     return Result::Success;
@@ -1309,12 +1547,60 @@ Result Device::CreateMsaaState(
     IMsaaState**               ppMsaaState
     ) const
 {
-    *ppMsaaState = PAL_PLACEMENT_NEW(pPlacementAddr) MsaaState(*this, createInfo);
+    *ppMsaaState = CreateStateObject<MsaaState>(createInfo, pPlacementAddr);
     PAL_ASSERT(*ppMsaaState != nullptr);
 
     return Result::Success;
 }
 
+// =====================================================================================================================
+// Drops one client object's reference to an interned state, freeing the canonical object once no copies remain.
+void Device::ReleaseInternedState(
+    uint64 key
+    ) const
+{
+    IDestroyable* pCanonical = nullptr;
+
+    {
+        MutexAuto lock(&m_internedStatesLock);
+
+        InternedStateEntry*const pEntry = m_internedStates.FindKey(key);
+        PAL_ASSERT((pEntry != nullptr) && (pEntry->refCount > 0));
+
+        if (pEntry != nullptr)
+        {
+            m_internedStateRefs--;
+
+            if (--pEntry->refCount == 0)
+            {
+                pCanonical = pEntry->pCanonical;
+                m_internedStates.Erase(key);
+            }
+        }
+    }
+
+    if (pCanonical != nullptr)
+    {
+        pCanonical->Destroy();
+        PAL_FREE(pCanonical, GetPlatform());
+    }
+}
+
+// =====================================================================================================================
+void Device::GetStateObjectInterningStats(
+    StateObjectInterningStats* pStats
+    ) const
+{
+    PAL_ASSERT(pStats != nullptr);
+
+    MutexAuto lock(&m_internedStatesLock);
+
+    pStats->lookups     = m_internedStateLookups;
+    pStats->hits        = m_internedStateHits;
+    pStats->stateCount  = m_internedStates.GetNumEntries();
+    pStats->objectCount = m_internedStateRefs;
+}
+
 // =====================================================================================================================
 size_t Device::GetImageSize(
     const ImageCreateInfo& createInfo) const
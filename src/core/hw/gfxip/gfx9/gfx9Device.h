@@ -162,7 +162,7 @@ class Device final : public GfxDevice
 {
 public:
     explicit Device(Pal::Device* pDevice);
-    virtual ~Device() { }
+    virtual ~Device();
 
     virtual Result EarlyInit() override;
     virtual Result LateInit() override;
@@ -267,6 +267,10 @@ public:
         const MsaaStateCreateInfo& createInfo,
         void*                      pPlacementAddr,
         IMsaaState**               ppMsaaState) const override;
+
+    virtual void GetStateObjectInterningStats(StateObjectInterningStats* pStats) const override;
+    void ReleaseInternedState(uint64 key) const;
+
     virtual size_t GetImageSize(const ImageCreateInfo& createInfo) const override;
     virtual void CreateImage(
         Pal::Image* pParentImage,
@@ -839,6 +843,9 @@ private:
     Result  CreateVrsDepthView();
     void    DestroyVrsDepthImage(Pal::Image*  pDsImage);
 
+    template <typename StateObject, typename CreateInfo>
+    StateObject* CreateStateObject(const CreateInfo& createInfo, void* pPlacementAddr) const;
+
     Gfx10DepthStencilView*  m_pVrsDepthView;
 
     // Local copy of the GB_ADDR_CONFIG register
@@ -848,6 +855,23 @@ private:
 
     uint16         m_firstUserDataReg[HwShaderStage::Last];
 
+    // Color blend, depth stencil and MSAA states interned under the StateObjectInterning setting. Client objects are
+    // copies of a device-owned canonical object which lives until the last copy is destroyed.
+    struct InternedStateEntry
+    {
+        IDestroyable* pCanonical; // Object new states with this key are copied from; it is never bound directly.
+        uint64        hashHigh;   // Upper half of the create info hash; the lower half is the map key.
+        uint32        refCount;   // Number of live client objects copied from pCanonical.
+    };
+
+    typedef Util::HashMap<uint64, InternedStateEntry, Platform, Util::JenkinsHashFunc> InternedStateMap;
+
+    mutable InternedStateMap  m_internedStates;
+    mutable Util::Mutex       m_internedStatesLock;
+    mutable uint64            m_internedStateLookups;
+    mutable uint64            m_internedStateHits;
+    mutable uint32            m_internedStateRefs;
+
     PAL_DISALLOW_DEFAULT_CTOR(Device);
     PAL_DISALLOW_COPY_AND_ASSIGN(Device);
 };
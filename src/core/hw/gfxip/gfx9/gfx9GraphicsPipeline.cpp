@@ -33,6 +33,7 @@
 #include "core/hw/gfxip/gfx9/gfx9Device.h"
 #include "core/hw/gfxip/gfx9/gfx9GraphicsPipeline.h"
 #include "core/hw/gfxip/gfx9/gfx9UniversalCmdBuffer.h"
+#include "palAutoBuffer.h"
 #include "palFormatInfo.h"
 #include "palInlineFuncs.h"
 #include "palMetroHash.h"
@@ -220,10 +221,17 @@ GraphicsPipeline::GraphicsPipeline(
 {
     memset(&m_regs, 0, sizeof(m_regs));
     memset(&m_loadPath, 0, sizeof(m_loadPath));
+    memset(&m_regImage, 0, sizeof(m_regImage));
     memset(&m_prefetch, 0, sizeof(m_prefetch));
     memcpy(&m_signature, &NullGfxSignature, sizeof(m_signature));
 }
 
+// =====================================================================================================================
+GraphicsPipeline::~GraphicsPipeline()
+{
+    PAL_SAFE_FREE(m_regImage.pCmds, m_pDevice->GetPlatform());
+}
+
 // =====================================================================================================================
 // Early HWL initialization for the pipeline.  Responsible for determining the number of SH and context registers to be
 // loaded using LOAD_SH_REG_INDEX and LOAD_CONTEXT_REG_INDEX, as well as determining things like which shader stages are
@@ -255,8 +263,11 @@ void GraphicsPipeline::EarlyInit(
     // Must be called *after* determining active HW stages!
     SetupSignatureFromElf(metadata, registers, &pInfo->esGsLdsSizeRegGs, &pInfo->esGsLdsSizeRegVs);
 
+    // The static registers are counted and listed both for the LOAD_INDEX path and for the baked register image.
     const Gfx9PalSettings& settings = m_pDevice->Settings();
-    if (settings.enableLoadIndexForObjectBinds != false)
+    pInfo->listStaticRegs = (settings.enableLoadIndexForObjectBinds || settings.bakeGraphicsPipelineRegImage);
+
+    if (pInfo->listStaticRegs)
     {
         // Add mmSPI_SHADER_LATE_ALLOC_VS if we don't use NGG
         pInfo->loadedShRegCount  = BaseLoadedShRegCount + (IsNgg() == false);
@@ -285,7 +296,7 @@ void GraphicsPipeline::EarlyInit(
     m_chunkVsPs.EarlyInit(registers, pInfo);
 
 #if PAL_ENABLE_PRINTS_ASSERTS
-    if (settings.enableLoadIndexForObjectBinds != false)
+    if (pInfo->listStaticRegs)
     {
         PAL_ASSERT((pInfo->loadedShRegCount != 0) && (pInfo->loadedCtxRegCount != 0));
     }
@@ -318,19 +329,38 @@ Result GraphicsPipeline::HwlInit(
         GraphicsPipelineLoadInfo loadInfo = { };
         EarlyInit(metadata, registers, &loadInfo);
 
+        // When baking a register image, the static registers are captured on the CPU as (offset, value) pairs instead
+        // of being uploaded to GPU memory for the LOAD_INDEX path.
+        const bool bakeRegImage = m_pDevice->Settings().bakeGraphicsPipelineRegImage;
+        const uint32 capturedCtxDwords = bakeRegImage ? (loadInfo.loadedCtxRegCount * 2) : 0;
+        const uint32 capturedShDwords  = bakeRegImage ? (loadInfo.loadedShRegCount  * 2) : 0;
+
+        AutoBuffer<uint32, 256, Platform> capturedCtxRegs(capturedCtxDwords, m_pDevice->GetPlatform());
+        AutoBuffer<uint32, 128, Platform> capturedShRegs(capturedShDwords, m_pDevice->GetPlatform());
+
+        if ((capturedCtxRegs.Capacity() < capturedCtxDwords) || (capturedShRegs.Capacity() < capturedShDwords))
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+
         // Next, handle relocations and upload the pipeline code & data to GPU memory.
         GraphicsPipelineUploader uploader(m_pDevice,
                                           abiReader,
                                           loadInfo.loadedCtxRegCount,
-                                          loadInfo.loadedShRegCount);
-        result = PerformRelocationsAndUploadToGpuMemory(
-            metadata,
+                                          loadInfo.loadedShRegCount,
+                                          bakeRegImage ? &capturedCtxRegs[0] : nullptr,
+                                          bakeRegImage ? &capturedShRegs[0]  : nullptr);
+        if (result == Result::Success)
+        {
+            result = PerformRelocationsAndUploadToGpuMemory(
+                metadata,
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION < 631
-            (createInfo.flags.overrideGpuHeap == 1) ? createInfo.preferredHeapType : GpuHeapInvisible,
+                (createInfo.flags.overrideGpuHeap == 1) ? createInfo.preferredHeapType : GpuHeapInvisible,
 #else
-            IsInternal() ? GpuHeapLocal : m_pDevice->Parent()->GetPublicSettings()->pipelinePreferredHeap,
+                IsInternal() ? GpuHeapLocal : m_pDevice->Parent()->GetPublicSettings()->pipelinePreferredHeap,
 #endif
-            &uploader);
+                &uploader);
+        }
 
         if (result == Result::Success)
         {
@@ -338,6 +368,17 @@ Result GraphicsPipeline::HwlInit(
             PAL_ASSERT(m_uploadFenceToken == 0);
             result = uploader.End(&m_uploadFenceToken);
         }
+
+        if ((result == Result::Success) && bakeRegImage)
+        {
+            PAL_ASSERT(uploader.CapturedCtxRegCount() == loadInfo.loadedCtxRegCount);
+            PAL_ASSERT(uploader.CapturedShRegCount()  == loadInfo.loadedShRegCount);
+
+            result = BuildRegImage(&capturedCtxRegs[0],
+                                   uploader.CapturedCtxRegCount(),
+                                   &capturedShRegs[0],
+                                   uploader.CapturedShRegCount());
+        }
     }
 
     if (result == Result::Success)
@@ -352,12 +393,7 @@ Result GraphicsPipeline::HwlInit(
         data.pObj = this;
         m_pDevice->GetPlatform()->GetEventProvider()->LogGpuMemoryResourceCreateEvent(data);
 
-        GpuMemoryResourceBindEventData bindData = {};
-        bindData.pObj = this;
-        bindData.pGpuMemory = m_gpuMem.Memory();
-        bindData.requiredGpuMemSize = m_gpuMemSize;
-        bindData.offset = m_gpuMem.Offset();
-        m_pDevice->GetPlatform()->GetEventProvider()->LogGpuMemoryResourceBindEvent(bindData);
+        LogGpuMemoryBindEvents();
     }
 
     return result;
@@ -643,6 +679,116 @@ void GraphicsPipeline::CalcDynamicStageInfos(
     }
 }
 
+// =====================================================================================================================
+// Sorts an array of (offset, value) register pairs by offset.  A stable insertion sort is plenty for the few dozen,
+// mostly ordered, static registers of a pipeline; keeping equal offsets in order lets the last write win below.
+static void SortRegisterPairs(
+    uint32* pPairs,
+    uint32  count)
+{
+    for (uint32 i = 1; i < count; ++i)
+    {
+        const uint32 offset = pPairs[(i * 2)];
+        const uint32 value  = pPairs[(i * 2) + 1];
+
+        uint32 j = i;
+        for (; (j > 0) && (pPairs[((j - 1) * 2)] > offset); --j)
+        {
+            pPairs[(j * 2)]     = pPairs[((j - 1) * 2)];
+            pPairs[(j * 2) + 1] = pPairs[((j - 1) * 2) + 1];
+        }
+
+        pPairs[(j * 2)]     = offset;
+        pPairs[(j * 2) + 1] = value;
+    }
+}
+
+// =====================================================================================================================
+// Writes SET_CONTEXT_REG or SET_SH_REG packets for an array of (offset, value) register pairs sorted by offset, merging
+// each run of consecutive registers into a single packet.  Returns the number of DWORDs written.
+static uint32 BuildRegisterRuns(
+    const CmdUtil& cmdUtil,
+    const uint32*  pPairs,
+    uint32         count,
+    bool           isContext,
+    uint32*        pCmdSpace)
+{
+    const uint32  spaceStart  = isContext ? CONTEXT_SPACE_START : PERSISTENT_SPACE_START;
+    const uint32  headerSize  = isContext ? CmdUtil::ContextRegSizeDwords : CmdUtil::ShRegSizeDwords;
+    uint32*const  pCmdStart   = pCmdSpace;
+
+    for (uint32 i = 0; i < count; )
+    {
+        const uint32 firstOffset = pPairs[(i * 2)];
+        uint32       lastOffset  = firstOffset;
+        uint32*const pValues     = pCmdSpace + headerSize;
+
+        // A repeated offset simply overwrites the earlier value.
+        for (; (i < count) && (pPairs[(i * 2)] <= (lastOffset + 1)); ++i)
+        {
+            lastOffset                          = pPairs[(i * 2)];
+            pValues[(lastOffset - firstOffset)] = pPairs[(i * 2) + 1];
+        }
+
+        if (isContext)
+        {
+            pCmdSpace += cmdUtil.BuildSetSeqContextRegs(spaceStart + firstOffset, spaceStart + lastOffset, pCmdSpace);
+        }
+        else
+        {
+            pCmdSpace += cmdUtil.BuildSetSeqShRegs(spaceStart + firstOffset,
+                                                   spaceStart + lastOffset,
+                                                   ShaderGraphics,
+                                                   pCmdSpace);
+        }
+    }
+
+    return static_cast<uint32>(pCmdSpace - pCmdStart);
+}
+
+// =====================================================================================================================
+// Bakes the captured static context and SH registers into a single packed PM4 image which is copied into the command
+// stream when this pipeline is bound.  The caller's register arrays are sorted in place.
+Result GraphicsPipeline::BuildRegImage(
+    uint32* pCtxRegs,
+    uint32  ctxRegCount,
+    uint32* pShRegs,
+    uint32  shRegCount)
+{
+    Result result = Result::Success;
+
+    SortRegisterPairs(pCtxRegs, ctxRegCount);
+    SortRegisterPairs(pShRegs,  shRegCount);
+
+    // In the worst case no two registers are consecutive and each needs its own packet.
+    const uint32 maxDwords = (ctxRegCount * (CmdUtil::ContextRegSizeDwords + 1)) +
+                             (shRegCount  * (CmdUtil::ShRegSizeDwords + 1));
+
+    if (maxDwords > 0)
+    {
+        m_regImage.pCmds = static_cast<uint32*>(PAL_MALLOC(maxDwords * sizeof(uint32),
+                                                           m_pDevice->GetPlatform(),
+                                                           AllocInternal));
+        if (m_regImage.pCmds == nullptr)
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+        else
+        {
+            const CmdUtil& cmdUtil = m_pDevice->CmdUtil();
+
+            m_regImage.ctxDwords = BuildRegisterRuns(cmdUtil, pCtxRegs, ctxRegCount, true, m_regImage.pCmds);
+            m_regImage.shDwords  = BuildRegisterRuns(cmdUtil,
+                                                     pShRegs,
+                                                     shRegCount,
+                                                     false,
+                                                     m_regImage.pCmds + m_regImage.ctxDwords);
+        }
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Helper function for writing common sh images which are shared by all graphics pipelines.
 // Returns a command buffer pointer incremented to the end of the commands we just wrote.
@@ -660,7 +806,24 @@ uint32* GraphicsPipeline::WriteShCommands(
     // Disable the LOAD_INDEX path if the PM4 optimizer is enabled.  The optimizer cannot optimize these load packets
     // because the register values are in GPU memory.  Additionally, any client requesting PM4 optimization is trading
     // CPU cycles for GPU performance, so the savings of using LOAD_INDEX is not important.
-    if ((m_loadPath.countSh == 0) || pCmdStream->Pm4OptimizerEnabled())
+    if ((m_regImage.shDwords != 0) && (pCmdStream->Pm4OptimizerEnabled() == false))
+    {
+        // The baked image holds the static SH registers for this object and all pipeline chunks.
+        memcpy(pCmdSpace, m_regImage.pCmds + m_regImage.ctxDwords, m_regImage.shDwords * sizeof(uint32));
+        pCmdSpace += m_regImage.shDwords;
+
+        // The below calls will end up only writing SET packets for "dynamic" state.
+        if (IsTessEnabled())
+        {
+            pCmdSpace = m_chunkHs.WriteShCommands<true>(pCmdStream, pCmdSpace, stageInfos.hs);
+        }
+        if (IsGsEnabled() || IsNgg())
+        {
+            pCmdSpace = m_chunkGs.WriteShCommands<true>(pCmdStream, pCmdSpace, stageInfos.gs);
+        }
+        pCmdSpace = m_chunkVsPs.WriteShCommands<true>(pCmdStream, pCmdSpace, IsNgg(), stageInfos.vs, stageInfos.ps);
+    }
+    else if ((m_loadPath.countSh == 0) || pCmdStream->Pm4OptimizerEnabled())
     {
         // If NGG is enabled, there is no hardware-VS, so there is no need to write the late-alloc VS limit.
         if (IsNgg() == false)
@@ -718,7 +881,17 @@ uint32* GraphicsPipeline::WriteContextCommands(
     // Disable the LOAD_INDEX path if the PM4 optimizer is enabled.  The optimizer cannot optimize these load packets
     // because the register values are in GPU memory.  Additionally, any client requesting PM4 optimization is trading
     // CPU cycles for GPU performance, so the savings of using LOAD_INDEX is not important.
-    if ((m_loadPath.countCtx == 0) || pCmdStream->Pm4OptimizerEnabled())
+    if ((m_regImage.ctxDwords != 0) && (pCmdStream->Pm4OptimizerEnabled() == false))
+    {
+        // The baked image holds the static context registers for this object and all pipeline chunks.
+        memcpy(pCmdSpace, m_regImage.pCmds, m_regImage.ctxDwords * sizeof(uint32));
+        pCmdSpace += m_regImage.ctxDwords;
+        pCmdStream->SetContextRollDetected<true>();
+
+        // NOTE: The Hs and Gs chunks don't expect us to call WriteContextCommands() when their static state is loaded.
+        pCmdSpace = m_chunkVsPs.WriteContextCommands<true>(pCmdStream, pCmdSpace);
+    }
+    else if ((m_loadPath.countCtx == 0) || pCmdStream->Pm4OptimizerEnabled())
     {
         pCmdSpace = WriteContextCommandsSetPath(pCmdStream, pCmdSpace);
 
@@ -1056,7 +1229,7 @@ void GraphicsPipeline::SetupCommonRegisters(
         m_regs.context.vgtDrawPayloadCntl.gfx103Plus.EN_VRS_RATE = 1;
     }
 
-    if (pUploader->EnableLoadIndexPath())
+    if (pUploader->ListsStaticRegisters())
     {
         pUploader->AddCtxReg(mmVGT_SHADER_STAGES_EN, m_regs.context.vgtShaderStagesEn);
         pUploader->AddCtxReg(mmVGT_REUSE_OFF,        m_regs.context.vgtReuseOff);
@@ -1120,7 +1293,7 @@ void GraphicsPipeline::SetupCommonRegisters(
                 m_regs.sh.spiShaderLateAllocVs.bits.LIMIT = programmedLimit;
             }
         }
-        if (pUploader->EnableLoadIndexPath())
+        if (pUploader->ListsStaticRegisters())
         {
             pUploader->AddShReg(Gfx09_10::mmSPI_SHADER_LATE_ALLOC_VS, m_regs.sh.spiShaderLateAllocVs);
         }
@@ -1532,7 +1705,7 @@ void GraphicsPipeline::SetupNonShaderRegisters(
         m_regs.context.cbTargetMask.u32All = 0;
     }
 
-    if (pUploader->EnableLoadIndexPath())
+    if (pUploader->ListsStaticRegisters())
     {
         pUploader->AddCtxReg(mmPA_SC_LINE_CNTL,  m_regs.context.paScLineCntl);
         pUploader->AddCtxReg(mmCB_COLOR_CONTROL, m_regs.context.cbColorControl);
@@ -50,6 +50,8 @@ struct GraphicsPipelineLoadInfo
 {
     bool    enableNgg;          // Set if the pipeline is using NGG mode.
     bool    usesOnChipGs;       // Set if the pipeline has a GS and uses on-chip GS.
+    bool    listStaticRegs;     // Set if the static registers are listed through the uploader, either for the
+                                // LOAD_INDEX path or for the baked register image.
     uint16  esGsLdsSizeRegGs;   // User-SGPR where the ES/GS ring size in LDS is passed to the GS stage
     uint16  esGsLdsSizeRegVs;   // User-SGPR where the ES/GS ring size in LDS is passed to the VS stage
     uint32  loadedShRegCount;   // Number of SH registers to load using LOAD_SH_REG_INDEX.  If zero, the LOAD_INDEX
@@ -165,7 +167,7 @@ public:
     bool IsRasterizationKilled() const { return (m_regs.context.paClClipCntl.bits.DX_RASTERIZATION_KILL != 0); }
 
 protected:
-    virtual ~GraphicsPipeline() { }
+    virtual ~GraphicsPipeline();
 
     virtual Result HwlInit(
         const GraphicsPipelineCreateInfo& createInfo,
@@ -219,6 +221,12 @@ private:
 
     uint32* WriteContextCommandsSetPath(CmdStream* pCmdStream, uint32* pCmdSpace) const;
 
+    Result BuildRegImage(
+        uint32* pCtxRegs,
+        uint32  ctxRegCount,
+        uint32* pShRegs,
+        uint32  shRegCount);
+
     void UpdateRingSizes(
         const CodeObjectMetadata& metadata);
     uint32 ComputeScratchMemorySize(
@@ -356,6 +364,15 @@ private:
         uint32   countSh;
     }  m_loadPath;
 
+    // Packed PM4 image of SET packets for every static context and SH register, built at creation time when the
+    // BakeGraphicsPipelineRegImage setting is enabled.  The context packets come first, followed by the SH packets.
+    struct
+    {
+        uint32*  pCmds;
+        uint32   ctxDwords;
+        uint32   shDwords;
+    }  m_regImage;
+
     PipelinePrefetchPm4        m_prefetch;
     GraphicsPipelineSignature  m_signature;
 
@@ -375,37 +392,83 @@ private:
 class GraphicsPipelineUploader final : public Pal::PipelineUploader
 {
 public:
+    // If capture arrays are given, the static registers are listed into them as (offset, value) pairs instead of being
+    // uploaded to GPU memory, and the LOAD_INDEX path is disabled.  Each array must have room for the register count.
     explicit GraphicsPipelineUploader(
         Device*          pDevice,
         const AbiReader& abiReader,
         uint32           ctxRegisterCount,
-        uint32           shRegisterCount)
+        uint32           shRegisterCount,
+        uint32*          pCapturedCtxRegs = nullptr,
+        uint32*          pCapturedShRegs  = nullptr)
         :
-        PipelineUploader(pDevice->Parent(), abiReader, ctxRegisterCount, shRegisterCount)
+        PipelineUploader(pDevice->Parent(),
+                         abiReader,
+                         (pCapturedCtxRegs != nullptr) ? 0 : ctxRegisterCount,
+                         (pCapturedShRegs  != nullptr) ? 0 : shRegisterCount),
+        m_pCapturedCtxRegs(pCapturedCtxRegs),
+        m_pCapturedShRegs(pCapturedShRegs),
+        m_capturedCtxRegCapacity((pCapturedCtxRegs != nullptr) ? ctxRegisterCount : 0),
+        m_capturedShRegCapacity((pCapturedShRegs != nullptr) ? shRegisterCount : 0),
+        m_capturedCtxRegCount(0),
+        m_capturedShRegCount(0)
         { }
     virtual ~GraphicsPipelineUploader() { }
 
-    // Add a context register to GPU memory for use with LOAD_CONTEXT_REG_INDEX.
+    // Returns true if the pipeline should list its static registers through AddCtxReg() and AddShReg().
+    bool ListsStaticRegisters() const { return (EnableLoadIndexPath() || (m_pCapturedCtxRegs != nullptr)); }
+
+    uint32 CapturedCtxRegCount() const { return m_capturedCtxRegCount; }
+    uint32 CapturedShRegCount() const { return m_capturedShRegCount; }
+
+    // Add a context register to GPU memory for use with LOAD_CONTEXT_REG_INDEX, or to the capture array.
     PAL_INLINE void AddCtxReg(uint16 address, uint32 value)
     {
         PAL_ASSERT(Gfx9::CmdUtil::IsContextReg(address));
-        Pal::PipelineUploader::AddCtxRegister(address - CONTEXT_SPACE_START, value);
+        if (m_pCapturedCtxRegs != nullptr)
+        {
+            PAL_ASSERT(m_capturedCtxRegCount < m_capturedCtxRegCapacity);
+            m_pCapturedCtxRegs[(m_capturedCtxRegCount * 2)]     = (address - CONTEXT_SPACE_START);
+            m_pCapturedCtxRegs[(m_capturedCtxRegCount * 2) + 1] = value;
+            m_capturedCtxRegCount++;
+        }
+        else
+        {
+            Pal::PipelineUploader::AddCtxRegister(address - CONTEXT_SPACE_START, value);
+        }
     }
     template <typename Register_t>
     PAL_INLINE void AddCtxReg(uint16 address, Register_t reg)
         { AddCtxReg(address, reg.u32All); }
 
-    // Add a SH register to GPU memory for use with LOAD_SH_REG_INDEX.
+    // Add a SH register to GPU memory for use with LOAD_SH_REG_INDEX, or to the capture array.
     PAL_INLINE void AddShReg(uint16 address, uint32 value)
     {
         PAL_ASSERT(CmdUtil::IsShReg(address));
-        Pal::PipelineUploader::AddShRegister(address - PERSISTENT_SPACE_START, value);
+        if (m_pCapturedShRegs != nullptr)
+        {
+            PAL_ASSERT(m_capturedShRegCount < m_capturedShRegCapacity);
+            m_pCapturedShRegs[(m_capturedShRegCount * 2)]     = (address - PERSISTENT_SPACE_START);
+            m_pCapturedShRegs[(m_capturedShRegCount * 2) + 1] = value;
+            m_capturedShRegCount++;
+        }
+        else
+        {
+            Pal::PipelineUploader::AddShRegister(address - PERSISTENT_SPACE_START, value);
+        }
     }
     template <typename Register_t>
     PAL_INLINE void AddShReg(uint16 address, Register_t reg)
         { AddShReg(address, reg.u32All); }
 
 private:
+    uint32*const  m_pCapturedCtxRegs;
+    uint32*const  m_pCapturedShRegs;
+    const uint32  m_capturedCtxRegCapacity;
+    const uint32  m_capturedShRegCapacity;
+    uint32        m_capturedCtxRegCount;
+    uint32        m_capturedShRegCount;
+
     PAL_DISALLOW_DEFAULT_CTOR(GraphicsPipelineUploader);
     PAL_DISALLOW_COPY_AND_ASSIGN(GraphicsPipelineUploader);
 };
@@ -113,6 +113,7 @@ IndirectCmdGenerator::IndirectCmdGenerator(
     :
     Pal::IndirectCmdGenerator(device, createInfo),
     m_bindsIndexBuffer(false),
+    m_supportsCpuExpansion(true),
     m_pParamData(reinterpret_cast<IndirectParamData*>(this + 1)),
     m_pCreationParam(reinterpret_cast<IndirectParam*>(m_pParamData+PaddedParamCount(createInfo.paramCount))),
     m_cmdSizeNeedPipeline(false)
@@ -370,7 +371,8 @@ void IndirectCmdGenerator::InitParamBuffer(
                 m_pParamData[p].data[0] = argBufOffsetIndices;
                 break;
             case IndirectParamType::DispatchMesh:
-                m_pParamData[p].type = IndirectOpType::DispatchMesh;
+                m_pParamData[p].type   = IndirectOpType::DispatchMesh;
+                m_supportsCpuExpansion = false;
                 break;
             case IndirectParamType::SetUserData:
                 m_pParamData[p].type    = IndirectOpType::SetUserData;
@@ -396,6 +398,9 @@ void IndirectCmdGenerator::InitParamBuffer(
                 // Update the vertex buffer table size to indicate to the command-generation shader that the vertex
                 // buffer is being updated by this generator.
                 m_properties.vertexBufTableSize = (BufferSrdDwords * MaxVertexBuffers);
+                // The generated commands write a private copy of the vertex buffer table, which the direct
+                // CmdSetVertexBuffers() path can't reproduce without changing the bound vertex buffers.
+                m_supportsCpuExpansion = false;
                 break;
             default:
                 PAL_NOT_IMPLEMENTED();
@@ -416,6 +421,169 @@ void IndirectCmdGenerator::InitParamBuffer(
     m_properties.argBufStride = Max(argBufOffset, createInfo.strideInBytes);
 }
 
+// =====================================================================================================================
+// Translates a BindIndexData format token into an index type. Returns false if the token doesn't match any of the
+// tokens given at creation time.
+bool IndirectCmdGenerator::DecodeIndexType(
+    uint32     token,
+    IndexType* pIndexType
+    ) const
+{
+    bool found = false;
+
+    for (uint32 idx = 0; (idx < ArrayLen(m_properties.indexTypeTokens)) && (found == false); ++idx)
+    {
+        if (m_properties.indexTypeTokens[idx] == token)
+        {
+            *pIndexType = static_cast<IndexType>(idx);
+            found       = true;
+        }
+    }
+
+    return found;
+}
+
+// =====================================================================================================================
+// Expands small indirect command workloads on the CPU: each command in the argument buffer is issued as the equivalent
+// sequence of direct command buffer calls, so the commands are built by the normal draw and dispatch paths and no
+// generator shader dispatch or barrier is needed. The argument memory must be CPU-visible and is read at record time.
+// Returns false without recording anything if the commands must be generated on the GPU instead.
+bool IndirectCmdGenerator::ExpandOnCpu(
+    ICmdBuffer*       pCmdBuffer,
+    const IGpuMemory& gpuMemory,
+    gpusize           offset,
+    uint32            cmdCount
+    ) const
+{
+    bool expanded = false;
+
+    // Mapping isn't a const operation, but we only read from the client's memory and unmap it before returning.
+    auto& memory = const_cast<GpuMemory&>(static_cast<const GpuMemory&>(gpuMemory));
+    void* pData  = nullptr;
+
+    if (m_supportsCpuExpansion && memory.IsCpuVisible() && (memory.Map(&pData) == Result::Success))
+    {
+        const void*const pArgs      = VoidPtrInc(pData, static_cast<size_t>(offset));
+        const uint32     argsStride = m_properties.argBufStride;
+
+        // We can't tell how the generator shader would treat an unknown index type token, so let it handle the whole
+        // workload in that case.
+        bool validArgs = true;
+
+        for (uint32 cmdIdx = 0; (cmdIdx < cmdCount) && validArgs; ++cmdIdx)
+        {
+            uint32 argBufOffset = (cmdIdx * argsStride);
+
+            for (uint32 p = 0; (p < ParameterCount()) && validArgs; ++p)
+            {
+                if (m_pCreationParam[p].type == IndirectParamType::BindIndexData)
+                {
+                    BindIndexDataIndirectArgs args;
+                    memcpy(&args, VoidPtrInc(pArgs, argBufOffset), sizeof(args));
+
+                    IndexType indexType;
+                    validArgs = DecodeIndexType(args.format, &indexType);
+                }
+
+                argBufOffset += m_pCreationParam[p].sizeInBytes;
+            }
+        }
+
+        if (validArgs)
+        {
+            for (uint32 cmdIdx = 0; cmdIdx < cmdCount; ++cmdIdx)
+            {
+                ExpandCmdOnCpu(pCmdBuffer, VoidPtrInc(pArgs, (cmdIdx * argsStride)), cmdIdx);
+            }
+
+            expanded = true;
+        }
+
+        memory.Unmap();
+    }
+
+    return expanded;
+}
+
+// =====================================================================================================================
+// Issues the direct command buffer calls equivalent to a single indirect command.  Parameters are processed in order,
+// so any index buffer or user-data updates are made before the draw or dispatch parameter, which must come last.
+void IndirectCmdGenerator::ExpandCmdOnCpu(
+    ICmdBuffer* pCmdBuffer,
+    const void* pCmdArgs,
+    uint32      cmdIdx
+    ) const
+{
+    const PipelineBindPoint bindPoint = (Type() == GeneratorType::Dispatch) ? PipelineBindPoint::Compute
+                                                                            : PipelineBindPoint::Graphics;
+    uint32 argBufOffset = 0;
+
+    for (uint32 p = 0; p < ParameterCount(); ++p)
+    {
+        const IndirectParam& param      = m_pCreationParam[p];
+        const void*const     pParamArgs = VoidPtrInc(pCmdArgs, argBufOffset);
+
+        switch (param.type)
+        {
+        case IndirectParamType::SetUserData:
+            pCmdBuffer->CmdSetUserData(bindPoint,
+                                       param.userData.firstEntry,
+                                       param.userData.entryCount,
+                                       static_cast<const uint32*>(pParamArgs));
+            break;
+        case IndirectParamType::BindIndexData:
+        {
+            BindIndexDataIndirectArgs args;
+            memcpy(&args, pParamArgs, sizeof(args));
+
+            IndexType indexType = IndexType::Idx32;
+            DecodeIndexType(args.format, &indexType);
+
+            // Index element sizes are 1, 2 and 4 bytes for Idx8, Idx16 and Idx32.
+            pCmdBuffer->CmdBindIndexData(args.gpuVirtAddr,
+                                         (args.sizeInBytes >> static_cast<uint32>(indexType)),
+                                         indexType);
+            break;
+        }
+        case IndirectParamType::Draw:
+        {
+            DrawIndirectArgs args;
+            memcpy(&args, pParamArgs, sizeof(args));
+
+            pCmdBuffer->CmdDraw(args.firstVertex, args.vertexCount, args.firstInstance, args.instanceCount, cmdIdx);
+            break;
+        }
+        case IndirectParamType::DrawIndexed:
+        {
+            DrawIndexedIndirectArgs args;
+            memcpy(&args, pParamArgs, sizeof(args));
+
+            pCmdBuffer->CmdDrawIndexed(args.firstIndex,
+                                       args.indexCount,
+                                       args.vertexOffset,
+                                       args.firstInstance,
+                                       args.instanceCount,
+                                       cmdIdx);
+            break;
+        }
+        case IndirectParamType::Dispatch:
+        {
+            DispatchIndirectArgs args;
+            memcpy(&args, pParamArgs, sizeof(args));
+
+            pCmdBuffer->CmdDispatch(args.x, args.y, args.z);
+            break;
+        }
+        default:
+            // SupportsCpuExpansion() should have rejected this generator.
+            PAL_NEVER_CALLED();
+            break;
+        }
+
+        argBufOffset += param.sizeInBytes;
+    }
+}
+
 // =====================================================================================================================
 void IndirectCmdGenerator::PopulateParameterBuffer(
     GfxCmdBuffer*   pCmdBuffer,
@@ -132,6 +132,14 @@ public:
 
     bool ContainsIndexBufferBind() const { return m_bindsIndexBuffer; }
 
+    bool SupportsCpuExpansion() const { return m_supportsCpuExpansion; }
+
+    bool ExpandOnCpu(
+        ICmdBuffer*       pCmdBuffer,
+        const IGpuMemory& gpuMemory,
+        gpusize           offset,
+        uint32            cmdCount) const;
+
 protected:
     virtual ~IndirectCmdGenerator() { }
 
@@ -144,9 +152,22 @@ private:
         IndirectOpType       opType,
         const IndirectParam& param) const;
 
+    bool DecodeIndexType(
+        uint32     token,
+        IndexType* pIndexType) const;
+
+    void ExpandCmdOnCpu(
+        ICmdBuffer* pCmdBuffer,
+        const void* pCmdArgs,
+        uint32      cmdIdx) const;
+
     // Tracks whether or not commands generated by this object include an index-buffer binding.
     bool  m_bindsIndexBuffer;
 
+    // Tracks whether every parameter of this generator maps onto a direct command buffer call, so that the commands
+    // can be expanded on the CPU instead of by RPM's generator shader.
+    bool  m_supportsCpuExpansion;
+
     // Array of IndirectParamData structures. These items are used to communicate how the RPM shader(s) for command
     // generation should interpret the application's indirect-argument buffer contents.
     IndirectParamData*const  m_pParamData;
@@ -63,7 +63,11 @@ MsaaState::MsaaState(
     :
     Pal::MsaaState(),
     m_log2Samples(0),
-    m_log2OcclusionQuerySamples(0)
+    m_log2OcclusionQuerySamples(0),
+    m_pDevice(nullptr),
+    m_pCanonical(nullptr),
+    m_internKey(0),
+    m_internHashHigh(0)
 {
     m_paScAaConfig.u32All = 0;
 
@@ -75,6 +79,38 @@ MsaaState::MsaaState(
     Init(device, createInfo);
 }
 
+// =====================================================================================================================
+// Copies the precomputed state of a device-owned interned object, holding one of its references until destruction.
+MsaaState::MsaaState(
+    const Device&    device,
+    const MsaaState& canonical,
+    uint64           internKey,
+    uint64           internHashHigh)
+    :
+    Pal::MsaaState(),
+    m_log2Samples(canonical.m_log2Samples),
+    m_log2OcclusionQuerySamples(canonical.m_log2OcclusionQuerySamples),
+    m_paScAaConfig(canonical.m_paScAaConfig),
+    m_flags(canonical.m_flags),
+    m_regs(canonical.m_regs),
+    m_pDevice(&device),
+    m_pCanonical(&canonical),
+    m_internKey(internKey),
+    m_internHashHigh(internHashHigh)
+{
+}
+
+// =====================================================================================================================
+void MsaaState::Destroy()
+{
+    if (m_pCanonical != nullptr)
+    {
+        m_pDevice->ReleaseInternedState(m_internKey);
+    }
+
+    Pal::MsaaState::Destroy();
+}
+
 // =====================================================================================================================
 // Copies this MSAA state's PM4 commands into the specified command buffer. Returns the next unused DWORD in pCmdSpace.
 uint32* MsaaState::WriteCommands(
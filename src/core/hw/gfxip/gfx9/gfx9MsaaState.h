@@ -43,6 +43,17 @@ class MsaaState final : public Pal::MsaaState
 {
 public:
     MsaaState(const Device& device, const MsaaStateCreateInfo& msaaState);
+    MsaaState(const Device& device, const MsaaState& canonical, uint64 internKey, uint64 internHashHigh);
+
+    virtual void Destroy() override;
+
+    // Interned copies with the same 128-bit create info hash program identical registers. Object addresses can't be
+    // compared instead because placement memory and freed canonical objects may be reused for different states.
+    bool MatchesInternedState(const MsaaState& other) const
+    {
+        return (m_pCanonical != nullptr) && (other.m_pCanonical != nullptr) &&
+               (m_internKey == other.m_internKey) && (m_internHashHigh == other.m_internHashHigh);
+    }
 
     uint32* WriteCommands(CmdStream* pCmdStream, uint32* pCmdSpace) const;
 
@@ -103,6 +114,11 @@ protected:
 
     }  m_regs;
 
+    const Device*     m_pDevice;      // Device which interned m_pCanonical.
+    const MsaaState*  m_pCanonical;     // Interned state this object was copied from, or null.
+    uint64            m_internKey;      // Key of m_pCanonical in the device's interned state map.
+    uint64            m_internHashHigh; // Upper half of the create info hash m_internKey was taken from.
+
     PAL_DISALLOW_COPY_AND_ASSIGN(MsaaState);
     PAL_DISALLOW_DEFAULT_CTOR(MsaaState);
 };
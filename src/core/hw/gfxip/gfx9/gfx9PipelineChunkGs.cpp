@@ -80,13 +80,12 @@ void PipelineChunkGs::EarlyInit(
 {
     PAL_ASSERT(pInfo != nullptr);
 
-    const Gfx9PalSettings&   settings  = m_device.Settings();
     const GpuChipProperties& chipProps = m_device.Parent()->ChipProperties();
 
     m_regs.sh.ldsEsGsSizeRegAddrGs = pInfo->esGsLdsSizeRegGs;
     m_regs.sh.ldsEsGsSizeRegAddrVs = pInfo->esGsLdsSizeRegVs;
 
-    if (settings.enableLoadIndexForObjectBinds != false)
+    if (pInfo->listStaticRegs)
     {
 
         {
@@ -299,7 +298,7 @@ void PipelineChunkGs::LateInit(
 
     pHasher->Update(m_regs.context);
 
-    if (pUploader->EnableLoadIndexPath())
+    if (pUploader->ListsStaticRegisters())
     {
         pUploader->AddShReg(mmSpiShaderPgmLoEs,        m_regs.sh.spiShaderPgmLoEs);
         pUploader->AddShReg(mmSPI_SHADER_PGM_RSRC1_GS, m_regs.sh.spiShaderPgmRsrc1Gs);
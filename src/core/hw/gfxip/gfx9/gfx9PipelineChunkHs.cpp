@@ -71,10 +71,9 @@ void PipelineChunkHs::EarlyInit(
 {
     PAL_ASSERT(pInfo != nullptr);
 
-    const Gfx9PalSettings&   settings  = m_device.Settings();
     const GpuChipProperties& chipProps = m_device.Parent()->ChipProperties();
 
-    if (settings.enableLoadIndexForObjectBinds != false)
+    if (pInfo->listStaticRegs)
     {
         pInfo->loadedCtxRegCount += BaseLoadedCntxRegCount;
         pInfo->loadedShRegCount  += (BaseLoadedShRegCount + ((chipProps.gfx9.supportSpp == 1) ? 1 : 0));
@@ -145,7 +144,7 @@ void PipelineChunkHs::LateInit(
 
     pHasher->Update(m_regs.context);
 
-    if (pUploader->EnableLoadIndexPath())
+    if (pUploader->ListsStaticRegisters())
     {
         pUploader->AddShReg(mmSpiShaderPgmLoLs,        m_regs.sh.spiShaderPgmLoLs);
         pUploader->AddShReg(mmSPI_SHADER_PGM_RSRC1_HS, m_regs.sh.spiShaderPgmRsrc1Hs);
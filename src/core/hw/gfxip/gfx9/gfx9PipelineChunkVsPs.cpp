@@ -115,7 +115,6 @@ void PipelineChunkVsPs::EarlyInit(
 {
     PAL_ASSERT(pInfo != nullptr);
 
-    const Gfx9PalSettings&   settings        = m_device.Settings();
     const auto&              palDevice       = *(m_device.Parent());
     const bool               hasVgtStreamOut = (IsGfx9(palDevice) || IsGfx10(palDevice));
     const GpuChipProperties& chipProps       = palDevice.ChipProperties();
@@ -139,7 +138,7 @@ void PipelineChunkVsPs::EarlyInit(
         ++m_regs.context.interpolatorCount;
     }
 
-    if (settings.enableLoadIndexForObjectBinds != false)
+    if (pInfo->listStaticRegs)
     {
         pInfo->loadedCtxRegCount += (BaseLoadedCntxRegCount + m_regs.context.interpolatorCount);
         if (hasVgtStreamOut)
@@ -336,7 +335,7 @@ void PipelineChunkVsPs::LateInit(
 
     pHasher->Update(m_regs.context);
 
-    if (pUploader->EnableLoadIndexPath())
+    if (pUploader->ListsStaticRegisters())
     {
         pUploader->AddShReg(mmSPI_SHADER_PGM_LO_PS,    m_regs.sh.spiShaderPgmLoPs);
         pUploader->AddShReg(mmSPI_SHADER_PGM_RSRC1_PS, m_regs.sh.spiShaderPgmRsrc1Ps);
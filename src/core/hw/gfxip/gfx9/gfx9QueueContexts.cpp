@@ -518,12 +518,13 @@ Result ComputeQueueContext::UpdateRingSet(
         SamplePatternPalette samplePatternPalette;
         m_pDevice->GetSamplePatternPalette(&samplePatternPalette);
 
+        // Ring growth does not require the Queue to be idle: the ring set moves to a new generation and retires the
+        // old one with lastTimeStamp. Only wait if the client explicitly asked for it when creating the Queue.
         if (m_needWaitIdleOnRingResize)
         {
             m_pParentQueue->WaitIdle();
         }
 
-        // The queues are idle, so it is safe to validate the rest of the RingSet.
         if (result == Result::Success)
         {
             uint32 reallocatedRings = 0;
@@ -1789,12 +1790,13 @@ Result UniversalQueueContext::UpdateRingSet(
         SamplePatternPalette samplePatternPalette;
         m_pDevice->GetSamplePatternPalette(&samplePatternPalette);
 
+        // Ring growth does not require the Queue to be idle: the ring set moves to a new generation and retires the
+        // old one with lastTimeStamp. Only wait if the client explicitly asked for it when creating the Queue.
         if (m_needWaitIdleOnRingResize)
         {
             m_pParentQueue->WaitIdle();
         }
 
-        // The queues are idle, so it is safe to validate the rest of the RingSet.
         if (result == Result::Success)
         {
             UniversalRingSet* pRingSet = isTmz ? &m_tmzRingSet : &m_ringSet;
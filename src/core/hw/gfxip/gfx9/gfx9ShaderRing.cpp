@@ -85,6 +85,7 @@ ShaderRing::ShaderRing(
     m_allocSize(0),
     m_numMaxWaves(0),
     m_itemSizeMax(0),
+    m_itemSizeReserve(0),
     m_ringType(type),
     m_gfxLevel(pDevice->Parent()->ChipProperties().gfxLevel)
 {
@@ -173,7 +174,8 @@ Result ShaderRing::AllocateVideoMemory(
 // =====================================================================================================================
 // Performs submit-time validation on this shader Ring so that any dirty state can be updated.
 Result ShaderRing::Validate(
-    size_t            itemSize, // Item size of the Ring to validate against (in DWORDs)
+    size_t            itemSize,        // Item size of the Ring to validate against (in DWORDs)
+    size_t            itemSizeReserve, // Predicted item size the Ring's allocation may be pre-sized for
     ShaderRingMemory* pDeferredMem)
 {
     Result result = Result::Success;
@@ -181,16 +183,22 @@ Result ShaderRing::Validate(
     // Only need to validate if the new item size is larger than the largest we've validated thus far.
     if (itemSize > m_itemSizeMax)
     {
-        m_itemSizeMax = itemSize;
+        m_itemSizeMax     = itemSize;
+        m_itemSizeReserve = Max(m_itemSizeReserve, itemSizeReserve);
         const gpusize sizeNeeded = ComputeAllocationSize();
 
-        // Attempt to allocate the video memory for this Ring.
-        result = AllocateVideoMemory(sizeNeeded, pDeferredMem);
-
-        if (result == Result::Success)
+        // A Ring which was pre-sized for a larger item size can keep its current allocation; only its SRD's and
+        // registers need to pick up the new item size.
+        if ((m_ringMem.IsBound() == false) || (sizeNeeded > m_allocSize))
         {
-            // Track our current allocation size.
-            m_allocSize = sizeNeeded;
+            // Attempt to allocate the video memory for this Ring.
+            result = AllocateVideoMemory(sizeNeeded, pDeferredMem);
+
+            if (result == Result::Success)
+            {
+                // Track our current allocation size.
+                m_allocSize = sizeNeeded;
+            }
         }
 
         if (m_ringMem.IsBound())
@@ -309,8 +317,10 @@ gpusize ScratchRing::ComputeAllocationSize() const
     const GpuMemoryProperties& memProps  = m_pDevice->Parent()->MemoryProperties();
     const PalSettings&         settings  = m_pDevice->Parent()->Settings();
 
-    // Compute the adjusted scratch size required by each wave.
-    const size_t waveSize = AdjustScratchWaveSize(m_itemSizeMax * chipProps.gfx9.minWavefrontSize);
+    // Compute the adjusted scratch size required by each wave. The allocation is sized for the reserved item size if
+    // the device predicted one, while CalculateWaveSize() keeps programming the actual largest item size.
+    const size_t itemSize = Max(m_itemSizeMax, m_itemSizeReserve);
+    const size_t waveSize = AdjustScratchWaveSize(itemSize * chipProps.gfx9.minWavefrontSize);
 
     // The ideal size to allocate for this Ring is: threadsPerWavefront * maxWaves * itemSize DWORDs.
     // We clamp this allocation to a maximum size to prevent the driver from using an unreasonable amount of scratch.
@@ -535,10 +545,13 @@ SamplePosBuffer::SamplePosBuffer(
     BufferSrd* pSrdTable, // Pointer to our parent ring-set's SRD table
     bool       isTmz)
     :
-    ShaderRing(pDevice, pSrdTable, isTmz, ShaderRingType::SamplePos)
+    ShaderRing(pDevice, pSrdTable, isTmz, ShaderRingType::SamplePos),
+    m_paletteUploaded(false)
 {
     constexpr uint32 SamplePosBufStride = sizeof(float) * 4;
 
+    memset(&m_palette[0], 0, sizeof(m_palette));
+
     const GpuChipProperties& chipProps = m_pDevice->Parent()->ChipProperties();
 
     BufferSrd*const pGenericSrd = &m_pSrdTable[static_cast<size_t>(ShaderRingSrd::SamplePosBuffer)];
@@ -567,21 +580,48 @@ void SamplePosBuffer::UpdateSrds() const
 }
 
 // =====================================================================================================================
-void SamplePosBuffer::UploadSamplePatternPalette(
-    const SamplePatternPalette& samplePatternPalette)
+// Writes a changed sample pattern palette into the buffer. Once the Queue has submitted (lastTimeStamp is non-zero),
+// in-flight submissions may still read the current palette, so a change moves the buffer to new memory instead of
+// rewriting it in place; the old memory is returned in pDeferredMem and the caller must update the SRD table.
+Result SamplePosBuffer::UploadSamplePatternPalette(
+    const SamplePatternPalette& samplePatternPalette,
+    uint64                      lastTimeStamp,
+    ShaderRingMemory*           pDeferredMem)
 {
+    Result result = Result::Success;
+
     // Update sample pattern palette buffer when m_ringMem has video memory bound, which also means
     // IDevice::SetSamplePatternPalette is called by client, and CPU visible video memory is allocated.
-    if (m_ringMem.IsBound())
+    if (m_ringMem.IsBound() &&
+        ((m_paletteUploaded == false) || (memcmp(&m_palette[0], &samplePatternPalette[0], sizeof(m_palette)) != 0)))
     {
-        void*  pData  = nullptr;
-        Result result = m_ringMem.Map(&pData);
+        if (m_paletteUploaded && (lastTimeStamp != 0))
+        {
+            result = AllocateVideoMemory(m_allocSize, pDeferredMem);
+
+            if (result == Result::Success)
+            {
+                UpdateSrds();
+            }
+        }
+
+        void* pData = nullptr;
+        if (result == Result::Success)
+        {
+            result = m_ringMem.Map(&pData);
+        }
+
         if (result == Result::Success)
         {
             memcpy(pData, samplePatternPalette, sizeof(SamplePatternPalette));
             m_ringMem.Unmap();
+
+            memcpy(&m_palette[0], &samplePatternPalette[0], sizeof(m_palette));
+            m_paletteUploaded = true;
         }
     }
+
+    return result;
 }
 
 // =====================================================================================================================
@@ -43,7 +43,7 @@ class ShaderRing
 public:
     virtual ~ShaderRing();
 
-    Result Validate(size_t itemSize, ShaderRingMemory* pDeferredMem);
+    Result Validate(size_t itemSize, size_t itemSizeReserve, ShaderRingMemory* pDeferredMem);
 
     bool IsMemoryValid() const { return m_ringMem.IsBound(); }
 
@@ -73,6 +73,7 @@ protected:
     gpusize              m_allocSize;   // Current "real" video memory size (in bytes)
     size_t               m_numMaxWaves; // Max. number of waves allowed to execute in parallel
     size_t               m_itemSizeMax; // Highest item size this Ring has needed so far
+    size_t               m_itemSizeReserve; // Predicted item size this Ring's allocation may be pre-sized for
     const ShaderRingType m_ringType;
     const GfxIpLevel     m_gfxLevel;
 
@@ -174,13 +175,19 @@ public:
     SamplePosBuffer(Device* pDevice, BufferSrd* pSrdTable, bool isTmz);
     virtual ~SamplePosBuffer() {}
 
-    void UploadSamplePatternPalette(const SamplePatternPalette& samplePatternPalette);
+    Result UploadSamplePatternPalette(
+        const SamplePatternPalette& samplePatternPalette,
+        uint64                      lastTimeStamp,
+        ShaderRingMemory*           pDeferredMem);
 
 protected:
     virtual gpusize ComputeAllocationSize() const override;
     virtual void UpdateSrds() const override;
 
 private:
+    SamplePatternPalette m_palette;         // Palette held by m_ringMem.
+    bool                 m_paletteUploaded; // Whether m_ringMem holds m_palette yet.
+
     PAL_DISALLOW_DEFAULT_CTOR(SamplePosBuffer);
     PAL_DISALLOW_COPY_AND_ASSIGN(SamplePosBuffer);
 };
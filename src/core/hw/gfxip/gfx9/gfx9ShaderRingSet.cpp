@@ -32,6 +32,7 @@
 #include "core/hw/gfxip/gfx9/gfx9ShaderRing.h"
 #include "core/hw/gfxip/gfx9/gfx9ShaderRingSet.h"
 
+#include "palDequeImpl.h"
 #include "palVectorImpl.h"
 
 using namespace Util;
@@ -55,8 +56,7 @@ ShaderRingSet::ShaderRingSet(
     m_ppRings(nullptr),
     m_pSrdTable(nullptr),
     m_gfxLevel(m_pDevice->Parent()->ChipProperties().gfxLevel),
-    m_deferredFreeMemList(pDevice->GetPlatform()),
-    m_freedItemCount(0)
+    m_deferredFreeMemList(pDevice->GetPlatform())
 {
 }
 
@@ -77,15 +77,30 @@ ShaderRingSet::~ShaderRingSet()
         PAL_SAFE_FREE(m_ppRings, m_pDevice->GetPlatform());
     }
 
+    InternalMemMgr*const pMemMgr = m_pDevice->Parent()->MemMgr();
+
     if (m_srdTableMem.IsBound())
     {
-        m_pDevice->Parent()->MemMgr()->FreeGpuMem(m_srdTableMem.Memory(), m_srdTableMem.Offset());
+        pMemMgr->FreeGpuMem(m_srdTableMem.Memory(), m_srdTableMem.Offset());
+    }
+
+    // The owning Queue is idle by the time it destroys its context, so any retired generations can be released now.
+    while (m_deferredFreeMemList.NumElements() > 0)
+    {
+        ShaderRingMemory ringMem = {};
+        m_deferredFreeMemList.PopFront(&ringMem);
+
+        if (ringMem.pGpuMemory != nullptr)
+        {
+            pMemMgr->FreeGpuMem(ringMem.pGpuMemory, ringMem.offset);
+        }
     }
 }
 
 // =====================================================================================================================
-// Initializes this shader-ring set object.
-Result ShaderRingSet::Init()
+// Allocates a new video memory backing for this ring-set's SRD table. The caller is responsible for retiring the
+// previous table, if any.
+Result ShaderRingSet::AllocateSrdTable()
 {
     GpuMemoryCreateInfo srdMemCreateInfo = { };
     srdMemCreateInfo.size      = TotalMemSize();
@@ -113,19 +128,31 @@ Result ShaderRingSet::Init()
     gpusize    memOffset  = 0;
 
     // Allocate the memory object for each ring-set's SRD table.
-    Result result = m_pDevice->Parent()->MemMgr()->AllocateGpuMem(srdMemCreateInfo,
-                                                                  internalInfo,
-                                                                  0,
-                                                                  &pGpuMemory,
-                                                                  &memOffset);
+    const Result result = m_pDevice->Parent()->MemMgr()->AllocateGpuMem(srdMemCreateInfo,
+                                                                        internalInfo,
+                                                                        0,
+                                                                        &pGpuMemory,
+                                                                        &memOffset);
 
     if (result == Result::Success)
     {
-        // Assume failure.
-        result = Result::ErrorOutOfMemory;
-
         // Update the video memory binding for our internal SRD table.
         m_srdTableMem.Update(pGpuMemory, memOffset);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Initializes this shader-ring set object.
+Result ShaderRingSet::Init()
+{
+    Result result = AllocateSrdTable();
+
+    if (result == Result::Success)
+    {
+        // Assume failure.
+        result = Result::ErrorOutOfMemory;
 
         // Allocate memory for the ring pointer table and SRD table.
         const size_t ringTableSize    = (sizeof(ShaderRing*) * m_numRings);
@@ -218,8 +245,9 @@ Result ShaderRingSet::Init()
 }
 
 // =====================================================================================================================
-// Validates that each ring is large enough to support the specified item-size. This function assumes the associated
-// Queue is not busy using this RingSet (i.e., the Queue is idle), so that it is safe to map the SRD table memory.
+// Validates that each ring is large enough to support the specified item-size. If any ring state changes, a new ring
+// generation is created: replaced ring memory and the previous SRD table are retired with lastTimeStamp and freed by
+// ClearDeferredFreeMemory once that timestamp has passed, so submissions still in flight on the Queue are unaffected.
 Result ShaderRingSet::Validate(
     const ShaderRingItemSizes&  ringSizes,
     const SamplePatternPalette& samplePatternPalette,
@@ -228,8 +256,7 @@ Result ShaderRingSet::Validate(
 {
     Result result = Result::Success;
 
-    bool updateSrdTable    = false;
-    bool deferFreeSrdTable = false;
+    bool updateSrdTable = false;
 
     for (size_t ring = 0; (result == Result::Success) && (ring < NumRings()); ++ring)
     {
@@ -240,88 +267,65 @@ Result ShaderRingSet::Validate(
         {
             if (ringSizes.itemSize[ring] > m_ppRings[ring]->ItemSizeMax())
             {
-                // We're increasing the size of this ring, and it will get a new address - force an updated of the SRD
-                // table.
+                // We're increasing the size of this ring, so its SRD's may change - force an update of the SRD table.
                 updateSrdTable = true;
             }
 
             ShaderRingMemory deferredMem = {nullptr, 0, lastTimeStamp};
             result = m_ppRings[ring]->Validate(ringSizes.itemSize[ring],
+                                               ringSizes.itemSizeReserve[ring],
                                                &deferredMem);
             if (deferredMem.pGpuMemory != nullptr)
             {
-                // If any shaderRing need to defer free ring memory,
-                // the current shadertable map / unmap needs to be deferred also
-                deferFreeSrdTable = true;
-                m_deferredFreeMemList.PushBack(deferredMem);
-                updateSrdTable = true;
-            }
-
-            if (updateSrdTable && deferFreeSrdTable)
-            {
+                // The ring moved to a new allocation. The old one may still be referenced by in-flight submissions.
+                result = m_deferredFreeMemList.PushBack(deferredMem);
                 (*pReallocatedRings) |= (1 << ring);
             }
         }
     }
 
-    if ((result == Result::Success) && updateSrdTable)
+    SamplePosBuffer*const pSamplePosBuf =
+        static_cast<SamplePosBuffer*>(m_ppRings[static_cast<size_t>(ShaderRingType::SamplePos)]);
+
+    if ((result == Result::Success) && (pSamplePosBuf != nullptr))
     {
-        if (deferFreeSrdTable)
+        // A changed palette moves to new memory just like a ring which grows, so its SRD must be updated too.
+        ShaderRingMemory deferredMem = {nullptr, 0, lastTimeStamp};
+        result = pSamplePosBuf->UploadSamplePatternPalette(samplePatternPalette, lastTimeStamp, &deferredMem);
+
+        if (deferredMem.pGpuMemory != nullptr)
         {
-            // save the current shardTable, since it might still be needed
-            ShaderRingMemory ringMem = {m_srdTableMem.Memory(),
-                                        m_srdTableMem.Offset(),
-                                        lastTimeStamp};
-            m_deferredFreeMemList.PushBack(ringMem);
-            m_srdTableMem.Update(nullptr, 0);
-
-            // Allocate a new shaderTable
-            GpuMemoryCreateInfo srdMemCreateInfo = { };
-            srdMemCreateInfo.size      = TotalMemSize();
-            srdMemCreateInfo.priority  = GpuMemPriority::Normal;
-            srdMemCreateInfo.vaRange   = VaRange::DescriptorTable;
-
-            if (m_pDevice->Parent()->LocalInvDropCpuWrites() == false)
-            {
-                srdMemCreateInfo.heaps[0]  = GpuHeapLocal;
-                srdMemCreateInfo.heaps[1]  = GpuHeapGartUswc;
-                srdMemCreateInfo.heaps[2]  = GpuHeapGartCacheable;
-                srdMemCreateInfo.heapCount = 3;
-            }
-            else
-            {
-                srdMemCreateInfo.heaps[0]  = GpuHeapGartUswc;
-                srdMemCreateInfo.heaps[1]  = GpuHeapGartCacheable;
-                srdMemCreateInfo.heapCount = 2;
-            }
+            updateSrdTable = true;
+            (*pReallocatedRings) |= (1 << static_cast<uint32>(ShaderRingType::SamplePos));
 
-            GpuMemoryInternalCreateInfo internalInfo = { };
-            internalInfo.flags.alwaysResident = 1;
+            const Result pushResult = m_deferredFreeMemList.PushBack(deferredMem);
+            result = (result == Result::Success) ? pushResult : result;
+        }
+    }
 
-            GpuMemory* pGpuMemory = nullptr;
-            gpusize    memOffset  = 0;
+    if ((result == Result::Success) && updateSrdTable)
+    {
+        // Previous submissions may still be reading the current SRD table, so it can't be rewritten in place once this
+        // Queue has submitted anything. Retire it along with the replaced ring memory and start a new generation.
+        if (lastTimeStamp != 0)
+        {
+            const ShaderRingMemory srdTableMem = {m_srdTableMem.Memory(), m_srdTableMem.Offset(), lastTimeStamp};
 
-            // Allocate the memory object for each ring-set's SRD table.
-            result = m_pDevice->Parent()->MemMgr()->AllocateGpuMem(srdMemCreateInfo,
-                                                                   internalInfo,
-                                                                   0,
-                                                                   &pGpuMemory,
-                                                                   &memOffset);
+            result = m_deferredFreeMemList.PushBack(srdTableMem);
 
             if (result == Result::Success)
             {
-                // Assume failure.
-                result = Result::ErrorOutOfMemory;
-
-                // Update the video memory binding for our internal SRD table.
-                m_srdTableMem.Update(pGpuMemory, memOffset);
+                m_srdTableMem.Update(nullptr, 0);
+                result = AllocateSrdTable();
             }
         }
 
-        // Need to upload our CPU copy of the SRD table into the SRD table video memory because we validated the TF
-        // Buffer up-front, so its SRD needs to be uploaded now.
+        // Upload our CPU copy of the SRD table into the SRD table video memory.
         void* pData = nullptr;
-        result = m_srdTableMem.Map(&pData);
+        if (result == Result::Success)
+        {
+            result = m_srdTableMem.Map(&pData);
+        }
 
         if (result == Result::Success)
         {
@@ -333,42 +337,30 @@ Result ShaderRingSet::Validate(
         }
     }
 
-    // Upload sample pattern palette
-    SamplePosBuffer* pSamplePosBuf =
-        static_cast<SamplePosBuffer*>(m_ppRings[static_cast<size_t>(ShaderRingType::SamplePos)]);
-    if (pSamplePosBuf != nullptr)
-    {
-        pSamplePosBuf->UploadSamplePatternPalette(samplePatternPalette);
-    }
-
     return result;
 }
 
 // =====================================================================================================================
+// Releases the memory of any retired ring generations whose last submission has completed on the GPU.
 void ShaderRingSet::ClearDeferredFreeMemory(
     SubmissionContext* pSubmissionCtx)
 {
-    if (m_deferredFreeMemList.NumElements() > 0)
-    {
-        InternalMemMgr*const pMemMgr = m_pDevice->Parent()->MemMgr();
+    InternalMemMgr*const pMemMgr = m_pDevice->Parent()->MemMgr();
 
-        for (uint32 i = 0; i < m_deferredFreeMemList.NumElements(); i++)
+    while (m_deferredFreeMemList.NumElements() > 0)
+    {
+        if (pSubmissionCtx->IsTimestampRetired(m_deferredFreeMemList.Front().timestamp) == false)
         {
-            ShaderRingMemory pRingMem = m_deferredFreeMemList.At(i);
-            if (pRingMem.pGpuMemory != nullptr)
-            {
-                if (pSubmissionCtx->IsTimestampRetired(pRingMem.timestamp))
-                {
-                    pMemMgr->FreeGpuMem(pRingMem.pGpuMemory, pRingMem.offset);
-                    m_freedItemCount++;
-                }
-            }
+            // Any timestamp in the list more recent than this must also still be in-flight, so end the search.
+            break;
         }
 
-        if (m_freedItemCount == m_deferredFreeMemList.NumElements())
+        ShaderRingMemory ringMem = {};
+        m_deferredFreeMemList.PopFront(&ringMem);
+
+        if (ringMem.pGpuMemory != nullptr)
         {
-            m_deferredFreeMemList.Clear();
-            m_freedItemCount = 0;
+            pMemMgr->FreeGpuMem(ringMem.pGpuMemory, ringMem.offset);
         }
     }
 }
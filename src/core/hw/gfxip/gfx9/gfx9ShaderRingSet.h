@@ -27,6 +27,7 @@
 
 #include "core/hw/gfxip/gfx9/gfx9Chip.h"
 #include "core/gpuMemory.h"
+#include "palDeque.h"
 
 namespace Pal
 {
@@ -83,6 +84,9 @@ enum class ShaderRingSrd : uint32
 struct ShaderRingItemSizes
 {
     size_t itemSize[static_cast<size_t>(ShaderRingType::NumUniversal)];
+    // Item sizes each ring's allocation should be pre-sized for. These are predicted by the device when pipelines are
+    // created; a ring is sized for the larger of the two values. Pipelines leave these zero.
+    size_t itemSizeReserve[static_cast<size_t>(ShaderRingType::NumUniversal)];
     static_assert(ShaderRingType::NumUniversal >= ShaderRingType::NumCompute,
                   "The compute ring set must be a subset of the universal ring set.");
 };
@@ -94,11 +98,16 @@ struct ShaderRingMemory
     uint64      timestamp;      // last submitted timestamp value
 };
 
-typedef Util::Vector<ShaderRingMemory, 8, Platform> ShaderRingMemList;
+// Retired ring memory is queued in timestamp order, so it can be released front-to-back.
+typedef Util::Deque<ShaderRingMemory, Platform> ShaderRingMemList;
 
 // =====================================================================================================================
 // A ShaderRingSet object contains all of the shader Rings used by command buffers which run on a particular Queue.
 // Additionally, each Ring Set also manages the PM4 image of commands which write the ring state to hardware.
+//
+// Ring state is versioned by generation: any validation which changes a ring's memory or the SRD table produces a new
+// generation with its own SRD table, and the memory of the previous generation is retired with the timestamp of the
+// last submission which could reference it. This lets the queue grow its rings without waiting for the GPU to idle.
 class ShaderRingSet
 {
 public:
@@ -123,6 +132,8 @@ public:
 protected:
     ShaderRingSet(Device* pDevice, size_t numRings, size_t numSrds, bool isTmz);
 
+    Result AllocateSrdTable();
+
     Device*const      m_pDevice;
     const size_t      m_numRings;       // Number of shader rings contained in the set
     const size_t      m_numSrds;        // Number of SRD's in this set's table
@@ -133,7 +144,6 @@ protected:
     BoundGpuMemory    m_srdTableMem;
 
     ShaderRingMemList m_deferredFreeMemList;
-    uint32            m_freedItemCount;
 
 private:
     PAL_DISALLOW_DEFAULT_CTOR(ShaderRingSet);
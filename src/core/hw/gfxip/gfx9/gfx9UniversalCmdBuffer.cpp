@@ -312,6 +312,7 @@ UniversalCmdBuffer::UniversalCmdBuffer(
     memset(&m_state,           0, sizeof(m_state));
     memset(&m_cachedSettings,  0, sizeof(m_cachedSettings));
     memset(&m_drawTimeHwState, 0, sizeof(m_drawTimeHwState));
+    memset(&m_drawBatch,       0, sizeof(m_drawBatch));
     memset(&m_nggState,        0, sizeof(m_nggState));
 
     memset(&m_pipelinePsHash, 0, sizeof(m_pipelinePsHash));
@@ -395,6 +396,8 @@ UniversalCmdBuffer::UniversalCmdBuffer(
     m_minBinSizeX = settings.minBatchBinSize.width;
     m_minBinSizeY = settings.minBatchBinSize.height;
 
+    m_drawBatch.maxCount = settings.drawIndexedBatchMaxCount;
+
     PAL_ASSERT((m_minBinSizeX != 0) && (m_minBinSizeY != 0));
     PAL_ASSERT(IsPowerOfTwo(m_minBinSizeX) && IsPowerOfTwo(m_minBinSizeY));
 
@@ -476,6 +479,7 @@ UniversalCmdBuffer::UniversalCmdBuffer(
 UniversalCmdBuffer::~UniversalCmdBuffer()
 {
     PAL_SAFE_DELETE(m_pAceCmdStream, m_device.GetPlatform());
+    PAL_SAFE_DELETE_ARRAY(m_drawBatch.pArgs, m_device.GetPlatform());
 }
 
 // =====================================================================================================================
@@ -512,6 +516,19 @@ Result UniversalCmdBuffer::Init(
         result = m_ceCmdStream.Init();
     }
 
+    if ((result == Result::Success) && (m_drawBatch.maxCount > 1))
+    {
+        m_drawBatch.pArgs = PAL_NEW_ARRAY(DrawIndexedIndirectArgs,
+                                          m_drawBatch.maxCount,
+                                          m_device.GetPlatform(),
+                                          AllocObject);
+
+        if (m_drawBatch.pArgs == nullptr)
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+    }
+
     return result;
 }
 
@@ -720,6 +737,12 @@ void UniversalCmdBuffer::ResetState()
     // Reset the command buffer's per-draw state objects.
     memset(&m_drawTimeHwState, 0, sizeof(m_drawTimeHwState));
 
+    // The command stream is about to be reset, so the last batched draw packet can no longer be extended.
+    m_drawBatch.pSetBase = nullptr;
+    m_drawBatch.pCount   = nullptr;
+    m_drawBatch.pCmdEnd  = nullptr;
+    m_drawBatch.count    = 0;
+
     // The index buffer state starts out in the dirty state.
     m_drawTimeHwState.dirty.indexType       = 1;
     m_drawTimeHwState.dirty.indexBufferBase = 1;
@@ -1203,33 +1226,39 @@ void UniversalCmdBuffer::CmdBindMsaaState(
     const IMsaaState* pMsaaState)
 {
     const MsaaState*const pNewState = static_cast<const MsaaState*>(pMsaaState);
+    const MsaaState*const pOldState = static_cast<const MsaaState*>(m_graphicsState.pMsaaState);
 
-    if (pNewState != nullptr)
+    // Rebinding an interned state over a copy with the same create info would only rewrite the same registers.
+    if ((pNewState == nullptr) || (pOldState == nullptr) || (pNewState->MatchesInternedState(*pOldState) == false))
     {
-        uint32* pDeCmdSpace = m_deCmdStream.ReserveCommands();
-        pDeCmdSpace = pNewState->WriteCommands(&m_deCmdStream, pDeCmdSpace);
-        m_deCmdStream.CommitCommands(pDeCmdSpace);
+        if (pNewState != nullptr)
+        {
+            uint32* pDeCmdSpace = m_deCmdStream.ReserveCommands();
+            pDeCmdSpace = pNewState->WriteCommands(&m_deCmdStream, pDeCmdSpace);
+            m_deCmdStream.CommitCommands(pDeCmdSpace);
 
-        // MSAA State owns MSAA_EXPOSED_SAMPLES and AA_MASK_CENTROID_DTMN
-        m_paScAaConfigNew.u32All = ((m_paScAaConfigNew.u32All         & (~MsaaState::PcScAaConfigMask)) |
-                                    (pNewState->PaScAaConfig().u32All &   MsaaState::PcScAaConfigMask));
+            // MSAA State owns MSAA_EXPOSED_SAMPLES and AA_MASK_CENTROID_DTMN
+            m_paScAaConfigNew.u32All = ((m_paScAaConfigNew.u32All         & (~MsaaState::PcScAaConfigMask)) |
+                                        (pNewState->PaScAaConfig().u32All &   MsaaState::PcScAaConfigMask));
 
-        // NGG state updates
-        m_nggState.numSamples = pNewState->NumSamples();
-        m_state.primShaderCullingCb.enableConservativeRasterization = pNewState->ConservativeRasterizationEnabled();
-    }
-    else
-    {
-        m_paScAaConfigNew.u32All = (m_paScAaConfigNew.u32All & (~MsaaState::PcScAaConfigMask));
+            // NGG state updates
+            m_nggState.numSamples = pNewState->NumSamples();
+            m_state.primShaderCullingCb.enableConservativeRasterization = pNewState->ConservativeRasterizationEnabled();
+        }
+        else
+        {
+            m_paScAaConfigNew.u32All = (m_paScAaConfigNew.u32All & (~MsaaState::PcScAaConfigMask));
 
-        // NGG state updates
-        m_nggState.numSamples                                       = 1;
-        m_state.primShaderCullingCb.enableConservativeRasterization = 0;
+            // NGG state updates
+            m_nggState.numSamples                                       = 1;
+            m_state.primShaderCullingCb.enableConservativeRasterization = 0;
+        }
+
+        m_graphicsState.dirtyFlags.validationBits.msaaState = 1;
+        m_nggState.flags.dirty                              = 1;
     }
 
-    m_graphicsState.pMsaaState                          = pNewState;
-    m_graphicsState.dirtyFlags.validationBits.msaaState = 1;
-    m_nggState.flags.dirty                              = 1;
+    m_graphicsState.pMsaaState = pNewState;
 }
 
 // =====================================================================================================================
@@ -1237,16 +1266,22 @@ void UniversalCmdBuffer::CmdBindColorBlendState(
     const IColorBlendState* pColorBlendState)
 {
     const ColorBlendState*const pNewState = static_cast<const ColorBlendState*>(pColorBlendState);
+    const ColorBlendState*const pOldState = static_cast<const ColorBlendState*>(m_graphicsState.pColorBlendState);
 
-    if (pNewState != nullptr)
+    // Rebinding an interned state over a copy with the same create info would only rewrite the same registers.
+    if ((pNewState == nullptr) || (pOldState == nullptr) || (pNewState->MatchesInternedState(*pOldState) == false))
     {
-        uint32* pDeCmdSpace = m_deCmdStream.ReserveCommands();
-        pDeCmdSpace = pNewState->WriteCommands(&m_deCmdStream, pDeCmdSpace);
-        m_deCmdStream.CommitCommands(pDeCmdSpace);
+        if (pNewState != nullptr)
+        {
+            uint32* pDeCmdSpace = m_deCmdStream.ReserveCommands();
+            pDeCmdSpace = pNewState->WriteCommands(&m_deCmdStream, pDeCmdSpace);
+            m_deCmdStream.CommitCommands(pDeCmdSpace);
+        }
+
+        m_graphicsState.dirtyFlags.validationBits.colorBlendState = 1;
     }
 
-    m_graphicsState.pColorBlendState                          = pNewState;
-    m_graphicsState.dirtyFlags.validationBits.colorBlendState = 1;
+    m_graphicsState.pColorBlendState = pNewState;
 }
 
 // =====================================================================================================================
@@ -1254,16 +1289,23 @@ void UniversalCmdBuffer::CmdBindDepthStencilState(
     const IDepthStencilState* pDepthStencilState)
 {
     const DepthStencilState*const pNewState = static_cast<const DepthStencilState*>(pDepthStencilState);
+    const DepthStencilState*const pOldState =
+        static_cast<const DepthStencilState*>(m_graphicsState.pDepthStencilState);
 
-    if (pNewState != nullptr)
+    // Rebinding an interned state over a copy with the same create info would only rewrite the same registers.
+    if ((pNewState == nullptr) || (pOldState == nullptr) || (pNewState->MatchesInternedState(*pOldState) == false))
     {
-        uint32* pDeCmdSpace = m_deCmdStream.ReserveCommands();
-        pDeCmdSpace = pNewState->WriteCommands(&m_deCmdStream, pDeCmdSpace);
-        m_deCmdStream.CommitCommands(pDeCmdSpace);
+        if (pNewState != nullptr)
+        {
+            uint32* pDeCmdSpace = m_deCmdStream.ReserveCommands();
+            pDeCmdSpace = pNewState->WriteCommands(&m_deCmdStream, pDeCmdSpace);
+            m_deCmdStream.CommitCommands(pDeCmdSpace);
+        }
+
+        m_graphicsState.dirtyFlags.validationBits.depthStencilState = 1;
     }
 
-    m_graphicsState.pDepthStencilState                          = pNewState;
-    m_graphicsState.dirtyFlags.validationBits.depthStencilState = 1;
+    m_graphicsState.pDepthStencilState = pNewState;
 }
 
 // =====================================================================================================================
@@ -2765,6 +2807,183 @@ void PAL_STDCALL UniversalCmdBuffer::CmdDrawIndexed(
 
 }
 
+// =====================================================================================================================
+// Issues an indexed draw command which may be coalesced with the previous one into a single DRAW_INDEX_INDIRECT_MULTI
+// packet.  Only installed when the DrawIndexedBatchMaxCount setting is enabled and no per-draw markers are needed.
+void PAL_STDCALL UniversalCmdBuffer::CmdDrawIndexedBatched(
+    ICmdBuffer* pCmdBuffer,
+    uint32      firstIndex,
+    uint32      indexCount,
+    int32       vertexOffset,
+    uint32      firstInstance,
+    uint32      instanceCount,
+    uint32      drawId)
+{
+    auto*const pThis = static_cast<UniversalCmdBuffer*>(pCmdBuffer);
+
+    // Batched draws fetch their indices through INDEX_BASE and INDEX_BUFFER_SIZE, so nested command buffers which
+    // inherit the index buffer and draws handled by the zero-sized index buffer workaround use the regular path.  The
+    // PM4 optimizer can't see the user-data written by the multi-draw packet, so it disables batching as well.
+    if ((pThis->m_deCmdStream.Pm4OptimizerEnabled() == false)     &&
+        (pThis->m_graphicsState.iaState.indexAddr != 0)           &&
+        (firstIndex < pThis->m_graphicsState.iaState.indexCount))
+    {
+        ValidateDrawInfo drawInfo;
+        drawInfo.vtxIdxCount   = indexCount;
+        drawInfo.instanceCount = instanceCount;
+        drawInfo.firstVertex   = vertexOffset;
+        drawInfo.firstInstance = firstInstance;
+        drawInfo.firstIndex    = firstIndex;
+        drawInfo.drawIndex     = drawId;
+        drawInfo.useOpaque     = false;
+
+        pThis->BatchDrawIndexed(drawInfo);
+    }
+    else
+    {
+        CmdDrawIndexed<false, false, false, false>(pCmdBuffer,
+                                                   firstIndex,
+                                                   indexCount,
+                                                   vertexOffset,
+                                                   firstInstance,
+                                                   instanceCount,
+                                                   drawId);
+    }
+}
+
+// =====================================================================================================================
+// Validates and issues an indexed draw through the multi-draw batch.  If nothing was written to the DE command stream
+// since the previous batched draw, the draw's arguments are appended to the batch's embedded data and the count of the
+// already recorded DRAW_INDEX_INDIRECT_MULTI packet is patched.  Otherwise a new batch is started.
+void UniversalCmdBuffer::BatchDrawIndexed(
+    const ValidateDrawInfo& drawInfo)
+{
+    constexpr uint32 ArgsDwords  = sizeof(DrawIndexedIndirectArgs) / sizeof(uint32);
+    constexpr uint32 CountOffset = offsetof(PM4_PFP_DRAW_INDEX_INDIRECT_MULTI, ordinal6) / sizeof(uint32);
+
+    // The multi-draw packet writes the vertex offset, instance offset and instance count of every draw itself.  Mark
+    // them as already holding this draw's values so that validation doesn't write them; any other PM4 written by
+    // validation means that state changed and the draw can't join the previous batch.
+    m_drawTimeHwState.vertexOffset         = drawInfo.firstVertex;
+    m_drawTimeHwState.instanceOffset       = drawInfo.firstInstance;
+    m_drawTimeHwState.numInstances         = drawInfo.instanceCount;
+    m_drawTimeHwState.valid.vertexOffset   = 1;
+    m_drawTimeHwState.valid.instanceOffset = 1;
+    m_drawTimeHwState.valid.numInstances   = 1;
+
+    ValidateDraw<true, false>(drawInfo);
+
+    const Pm4Predicate predicate   = PacketPredicate();
+    uint32*            pDeCmdSpace = WaitOnCeCounter(m_deCmdStream.ReserveCommands());
+
+    if ((pDeCmdSpace == m_drawBatch.pCmdEnd)                  &&
+        (m_drawBatch.count < m_drawBatch.limit)               &&
+        (m_drawBatch.predicate == predicate)                  &&
+        (m_drawTimeHwState.dirty.indexBufferBase == 0)        &&
+        (m_drawTimeHwState.dirty.indexBufferSize == 0))
+    {
+        DrawIndexedIndirectArgs*const pArgs = &m_drawBatch.pArgs[m_drawBatch.count];
+        pArgs->indexCount    = drawInfo.vtxIdxCount;
+        pArgs->instanceCount = drawInfo.instanceCount;
+        pArgs->firstIndex    = drawInfo.firstIndex;
+        pArgs->vertexOffset  = drawInfo.firstVertex;
+        pArgs->firstInstance = drawInfo.firstInstance;
+
+        m_drawBatch.count++;
+        *m_drawBatch.pCount = m_drawBatch.count;
+    }
+    else
+    {
+        FlushDrawBatch();
+
+        m_drawBatch.count     = 1;
+        m_drawBatch.limit     = Min(m_drawBatch.maxCount, GetEmbeddedDataLimit() / ArgsDwords);
+        m_drawBatch.predicate = predicate;
+
+        m_drawBatch.pArgs[0].indexCount    = drawInfo.vtxIdxCount;
+        m_drawBatch.pArgs[0].instanceCount = drawInfo.instanceCount;
+        m_drawBatch.pArgs[0].firstIndex    = drawInfo.firstIndex;
+        m_drawBatch.pArgs[0].vertexOffset  = drawInfo.firstVertex;
+        m_drawBatch.pArgs[0].firstInstance = drawInfo.firstInstance;
+
+        // The argument address isn't known until the batch is closed; FlushDrawBatch() patches this packet.
+        m_drawBatch.pSetBase = pDeCmdSpace;
+        pDeCmdSpace += CmdUtil::BuildSetBase(0,
+                                             base_index__pfp_set_base__patch_table_base,
+                                             ShaderGraphics,
+                                             pDeCmdSpace);
+
+        // Direct draws don't program the index buffer base and size, so they may still be dirty.
+        if (m_drawTimeHwState.dirty.indexBufferBase != 0)
+        {
+            m_drawTimeHwState.dirty.indexBufferBase = 0;
+            pDeCmdSpace += CmdUtil::BuildIndexBase(m_graphicsState.iaState.indexAddr, pDeCmdSpace);
+        }
+
+        if (m_drawTimeHwState.dirty.indexBufferSize != 0)
+        {
+            m_drawTimeHwState.dirty.indexBufferSize = 0;
+            pDeCmdSpace += CmdUtil::BuildIndexBufferSize(m_graphicsState.iaState.indexCount, pDeCmdSpace);
+        }
+
+        const uint16 vtxOffsetReg  = GetVertexOffsetRegAddr();
+        const uint16 instOffsetReg = GetInstanceOffsetRegAddr();
+
+        m_deCmdStream.NotifyIndirectShRegWrite(vtxOffsetReg);
+        m_deCmdStream.NotifyIndirectShRegWrite(instOffsetReg);
+
+        // The draw index is left to the regular draw-time validation, so draws only join a batch while it's unchanged.
+        m_drawBatch.pCount = pDeCmdSpace + CountOffset;
+
+        pDeCmdSpace += m_cmdUtil.BuildDrawIndexIndirectMulti(0,
+                                                             vtxOffsetReg,
+                                                             instOffsetReg,
+                                                             UserDataNotMapped,
+                                                             sizeof(DrawIndexedIndirectArgs),
+                                                             1,
+                                                             0,
+                                                             predicate,
+                                                             pDeCmdSpace);
+        m_drawBatch.pCmdEnd = pDeCmdSpace;
+    }
+
+    pDeCmdSpace = IncrementDeCounter(pDeCmdSpace);
+
+    m_deCmdStream.CommitCommands(pDeCmdSpace);
+
+    // The following state is clobbered by the multi-draw packet.
+    m_drawTimeHwState.valid.numInstances   = 0;
+    m_drawTimeHwState.valid.instanceOffset = 0;
+    m_drawTimeHwState.valid.vertexOffset   = 0;
+
+    m_state.flags.containsDrawIndirect = 1;
+}
+
+// =====================================================================================================================
+// Closes the current multi-draw batch: copies its staged arguments into embedded data sized to the number of draws it
+// ended up with and points the batch's SET_BASE packet at them.  Must be called before the command buffer ends.
+void UniversalCmdBuffer::FlushDrawBatch()
+{
+    constexpr uint32 ArgsDwords = sizeof(DrawIndexedIndirectArgs) / sizeof(uint32);
+
+    if (m_drawBatch.count > 0)
+    {
+        gpusize     argsGpuAddr = 0;
+        void*const  pArgs       = CmdAllocateEmbeddedData(m_drawBatch.count * ArgsDwords, 1, &argsGpuAddr);
+
+        memcpy(pArgs, m_drawBatch.pArgs, m_drawBatch.count * sizeof(DrawIndexedIndirectArgs));
+        CmdUtil::BuildSetBase(argsGpuAddr,
+                              base_index__pfp_set_base__patch_table_base,
+                              ShaderGraphics,
+                              m_drawBatch.pSetBase);
+
+        m_drawBatch.pSetBase = nullptr;
+        m_drawBatch.pCount   = nullptr;
+        m_drawBatch.pCmdEnd  = nullptr;
+        m_drawBatch.count    = 0;
+    }
+}
+
 // =====================================================================================================================
 // Issues an indirect non-indexed draw command. We must discard the draw if vertexCount or instanceCount are zero.
 // We will rely on the HW to discard the draw for us.
@@ -4177,6 +4396,7 @@ Result UniversalCmdBuffer::AddPreamble()
 // Adds a postamble to the end of a new command buffer.
 Result UniversalCmdBuffer::AddPostamble()
 {
+    FlushDrawBatch();
 
     uint32* pDeCmdSpace = m_deCmdStream.ReserveCommands();
 
@@ -8337,13 +8557,48 @@ void UniversalCmdBuffer::CmdExecuteIndirectCmds(
     gpusize                      offset,
     uint32                       maximumCount,
     gpusize                      countGpuAddr)
+{
+    const auto& gfx9Generator = static_cast<const IndirectCmdGenerator&>(generator);
+
+    bool expanded = false;
+
+    // Small workloads with CPU-visible arguments can be expanded into direct draws while recording, which skips the
+    // generator shader dispatch and the barriers around it.
+    if ((countGpuAddr == 0uLL) &&
+        (m_device.Settings().cpuIndirectCmdExpansionMaxCount > 0) &&
+        (maximumCount <= m_device.Settings().cpuIndirectCmdExpansionMaxCount) &&
+        gfx9Generator.SupportsCpuExpansion())
+    {
+        // The generated commands bind their index buffer without changing our index buffer state, so preserve it.
+        const auto iaState = m_graphicsState.iaState;
+
+        expanded = gfx9Generator.ExpandOnCpu(this, gpuMemory, offset, maximumCount);
+
+        if (expanded && gfx9Generator.ContainsIndexBufferBind())
+        {
+            CmdBindIndexData(iaState.indexAddr, iaState.indexCount, iaState.indexType);
+        }
+    }
+
+    if (expanded == false)
+    {
+        ExecuteIndirectCmdsOnGpu(gfx9Generator, gpuMemory, offset, maximumCount, countGpuAddr);
+    }
+}
+
+// =====================================================================================================================
+// Generates the indirect commands with RPM's generator shader and executes the generated command chunks.
+void UniversalCmdBuffer::ExecuteIndirectCmdsOnGpu(
+    const IndirectCmdGenerator& gfx9Generator,
+    const IGpuMemory&           gpuMemory,
+    gpusize                     offset,
+    uint32                      maximumCount,
+    gpusize                     countGpuAddr)
 {
     // It is only safe to generate indirect commands on a one-time-submit or exclusive-submit command buffer because
     // there is a potential race condition on the memory used to receive the generated commands.
     PAL_ASSERT(IsOneTimeSubmit() || IsExclusiveSubmit());
 
-    const auto& gfx9Generator = static_cast<const IndirectCmdGenerator&>(generator);
-
     if (countGpuAddr == 0uLL)
     {
         // If the count GPU address is zero, then we are expected to use the maximumCount value as the actual number
@@ -9247,6 +9502,14 @@ void UniversalCmdBuffer::SwitchDrawFunctionsInternal(
         = CmdDrawIndexed<IssueSqtt, HasUavExport, ViewInstancing, DescribeDrawDispatch>;
     m_funcTable.pfnCmdDrawIndexedIndirectMulti
         = CmdDrawIndexedIndirectMulti<IssueSqtt, ViewInstancing, DescribeDrawDispatch>;
+
+    // Only draws which don't need per-draw markers, flushes or view replication can be coalesced into one packet.
+    if ((IssueSqtt == false) && (HasUavExport == false) && (ViewInstancing == false) &&
+        (DescribeDrawDispatch == false) && (m_drawBatch.maxCount > 1))
+    {
+        m_funcTable.pfnCmdDrawIndexed = CmdDrawIndexedBatched;
+    }
+
     if (hasTaskShader)
     {
         // Task + Gfx pipeline.
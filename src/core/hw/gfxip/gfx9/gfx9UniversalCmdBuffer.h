@@ -43,6 +43,7 @@ namespace Gfx9
 
 class GraphicsPipeline;
 class Gfx10DepthStencilView;
+class IndirectCmdGenerator;
 class UniversalCmdBuffer;
 
 // Structure to track the state of internal command buffer operations.
@@ -695,6 +696,15 @@ private:
         uint32      instanceCount,
         uint32      drawId);
 
+    static void PAL_STDCALL CmdDrawIndexedBatched(
+        ICmdBuffer* pCmdBuffer,
+        uint32      firstIndex,
+        uint32      indexCount,
+        int32       vertexOffset,
+        uint32      firstInstance,
+        uint32      instanceCount,
+        uint32      drawId);
+
     template <bool IssueSqttMarkerEvent, bool ViewInstancingEnable, bool DescribeDrawDispatch>
     static void PAL_STDCALL CmdDrawIndirectMulti(
         ICmdBuffer*       pCmdBuffer,
@@ -832,6 +842,9 @@ private:
     uint32* WaitOnCeCounter(uint32* pDeCmdSpace);
     uint32* IncrementDeCounter(uint32* pDeCmdSpace);
 
+    void BatchDrawIndexed(const ValidateDrawInfo& drawInfo);
+    void FlushDrawBatch();
+
     Pm4Predicate PacketPredicate() const { return static_cast<Pm4Predicate>(m_gfxCmdBufState.flags.packetPredicate); }
 
     template <bool IssueSqttMarkerEvent, bool DescribeDrawDispatch>
@@ -841,6 +854,13 @@ private:
     void SetUserDataValidationFunctions();
     void SetUserDataValidationFunctions(bool tessEnabled, bool gsEnabled, bool isNgg);
 
+    void ExecuteIndirectCmdsOnGpu(
+        const IndirectCmdGenerator& gfx9Generator,
+        const IGpuMemory&           gpuMemory,
+        gpusize                     offset,
+        uint32                      maximumCount,
+        gpusize                     countGpuAddr);
+
     void ValidateDispatch(
         ComputeState* pComputeState,
         CmdStream*    pCmdStream,
@@ -1113,6 +1133,22 @@ private:
     CachedSettings   m_cachedSettings;   // Cached settings values referenced at draw-time
 
     DrawTimeHwState  m_drawTimeHwState;  // Tracks certain bits of HW-state that might need to be updated per draw.
+
+    // Tracks the DRAW_INDEX_INDIRECT_MULTI packet which consecutive CmdDrawIndexed() calls are coalesced into when the
+    // DrawIndexedBatchMaxCount setting is enabled.  The arguments are staged on the CPU and copied to embedded data
+    // sized to the final draw count once the batch is closed, at which point its SET_BASE packet is patched.
+    struct
+    {
+        DrawIndexedIndirectArgs* pArgs;     // CPU staging for the arguments of each draw in the batch.
+        uint32*                  pSetBase;  // SET_BASE packet of the batch in the DE command stream.
+        uint32*                  pCount;    // Count field of the batch's draw packet in the DE command stream.
+        const uint32*            pCmdEnd;   // End of the batch's draw packet.  A draw is only added to the batch if
+                                            // nothing else has been written to the DE command stream since.
+        uint32                   count;     // Number of draws in the batch.
+        uint32                   limit;     // Maximum number of draws in the current batch.
+        uint32                   maxCount;  // Maximum number of draws per batch; the capacity of pArgs.
+        Pm4Predicate             predicate; // Packet predication the batch was recorded with.
+    }  m_drawBatch;
     NggState         m_nggState;
 
     uint8 m_leakCbColorInfoRtv;   // Sticky per-MRT dirty mask of CB_COLORx_INFO state written due to RTV
@@ -424,6 +424,11 @@ public:
         Util::SystemAllocType      allocType) const;
     void DestroyMsaaStateInternal(
         MsaaState* pMsaaState) const;
+
+    // Hardware layers which intern state objects override this; by default nothing is interned.
+    virtual void GetStateObjectInterningStats(StateObjectInterningStats* pStats) const
+        { memset(pStats, 0, sizeof(*pStats)); }
+
     virtual size_t GetImageSize(const ImageCreateInfo& createInfo) const = 0;
     virtual void CreateImage(
         Pal::Image* pParentImage,
@@ -43,6 +43,9 @@ namespace Pal
 // GPU memory alignment for shader programs.
 constexpr size_t GpuMemByteAlign = 256;
 
+// Each loaded register is stored as an offset and value pair.
+constexpr uint32 RegisterEntryBytes = (sizeof(uint32) << 1);
+
 constexpr Abi::ApiShaderType PalToAbiShaderType[] =
 {
     Abi::ApiShaderType::Cs, // ShaderType::Cs
@@ -65,6 +68,9 @@ Pipeline::Pipeline(
     m_pDevice(pDevice),
     m_gpuMem(),
     m_gpuMemSize(0),
+    m_regGpuMem(),
+    m_regGpuMemSize(0),
+    m_codeHash(),
     m_pPipelineBinary(nullptr),
     m_pipelineBinaryLen(0),
     m_apiHwMapping(),
@@ -88,10 +94,23 @@ Pipeline::~Pipeline()
 {
     if (m_gpuMem.IsBound())
     {
-        m_pDevice->MemMgr()->FreeGpuMem(m_gpuMem.Memory(), m_gpuMem.Offset());
+        if (m_flags.sharedCode != 0)
+        {
+            m_pDevice->ReleaseSharedPipelineCode(m_codeHash);
+        }
+        else
+        {
+            m_pDevice->MemMgr()->FreeGpuMem(m_gpuMem.Memory(), m_gpuMem.Offset());
+        }
         m_gpuMem.Update(nullptr, 0);
     }
 
+    if (m_regGpuMem.IsBound())
+    {
+        m_pDevice->MemMgr()->FreeGpuMem(m_regGpuMem.Memory(), m_regGpuMem.Offset());
+        m_regGpuMem.Update(nullptr, 0);
+    }
+
     if (m_perfDataMem.IsBound())
     {
         m_pDevice->MemMgr()->FreeGpuMem(m_perfDataMem.Memory(), m_perfDataMem.Offset());
@@ -196,8 +215,21 @@ Result Pipeline::PerformRelocationsAndUploadToGpuMemory(
 
     if (result == Result::Success)
     {
-        result = pUploader->Begin(metadata, clientPreferredHeap);
+        result = pUploader->Begin(metadata, clientPreferredHeap, true);
 
+        // Take ownership of the uploader's GPU memory even if something failed: a shared code upload holds a reference
+        // in the device's cache which must be released along with this pipeline.
+        m_pagingFenceVal = pUploader->PagingFenceVal();
+        m_gpuMemSize     = pUploader->GpuMemSize();
+        m_gpuMem.Update(pUploader->GpuMem(), pUploader->GpuMemOffset());
+        m_regGpuMem.Update(pUploader->RegGpuMem(), pUploader->RegGpuMemOffset());
+        m_regGpuMemSize  = pUploader->RegGpuMemSize();
+
+        if (pUploader->IsCodeShared())
+        {
+            m_flags.sharedCode = 1;
+            m_codeHash         = pUploader->CodeHash();
+        }
     }
 
     if (result == Result::Success)
@@ -205,14 +237,26 @@ Result Pipeline::PerformRelocationsAndUploadToGpuMemory(
         result = pUploader->ApplyRelocations();
     }
 
-    if (result == Result::Success)
+    return result;
+}
+
+// =====================================================================================================================
+void Pipeline::LogGpuMemoryBindEvents() const
+{
+    GpuMemoryResourceBindEventData bindData = {};
+    bindData.pObj                           = this;
+    bindData.pGpuMemory                     = m_gpuMem.Memory();
+    bindData.requiredGpuMemSize             = m_gpuMemSize;
+    bindData.offset                         = m_gpuMem.Offset();
+    m_pDevice->GetPlatform()->GetEventProvider()->LogGpuMemoryResourceBindEvent(bindData);
+
+    if (m_regGpuMem.IsBound())
     {
-        m_pagingFenceVal = pUploader->PagingFenceVal();
-        m_gpuMemSize     = pUploader->GpuMemSize();
-        m_gpuMem.Update(pUploader->GpuMem(), pUploader->GpuMemOffset());
+        bindData.pGpuMemory         = m_regGpuMem.Memory();
+        bindData.requiredGpuMemSize = m_regGpuMemSize;
+        bindData.offset             = m_regGpuMem.Offset();
+        m_pDevice->GetPlatform()->GetEventProvider()->LogGpuMemoryResourceBindEvent(bindData);
     }
-
-    return result;
 }
 
 // =====================================================================================================================
@@ -254,13 +298,20 @@ Result Pipeline::QueryAllocationInfo(
 
     if (pNumEntries != nullptr)
     {
-        (*pNumEntries) = 1;
+        (*pNumEntries) = m_regGpuMem.IsBound() ? 2 : 1;
 
         if (pGpuMemList != nullptr)
         {
             pGpuMemList[0].offset     = m_gpuMem.Offset();
             pGpuMemList[0].pGpuMemory = m_gpuMem.Memory();
             pGpuMemList[0].size       = m_gpuMemSize;
+
+            if (m_regGpuMem.IsBound())
+            {
+                pGpuMemList[1].offset     = m_regGpuMem.Offset();
+                pGpuMemList[1].pGpuMemory = m_regGpuMem.Memory();
+                pGpuMemList[1].size       = m_regGpuMemSize;
+            }
         }
 
         result = Result::Success;
@@ -638,7 +689,14 @@ PipelineUploader::PipelineUploader(
     m_pagingFenceVal(0),
     m_pipelineHeapType(GpuHeap::GpuHeapCount),
     m_slotId(0),
-    m_heapInvisUploadOffset(0)
+    m_heapInvisUploadOffset(0),
+    m_codeShared(false),
+    m_codeReused(false),
+    m_codeHash(),
+    m_codeUploadFence(0),
+    m_pRegGpuMemory(nullptr),
+    m_regGpuMemOffset(0),
+    m_regGpuMemSize(0)
 {
 }
 
@@ -748,13 +806,132 @@ GpuHeap PipelineUploader::SelectUploadHeap(
     return m_pipelineHeapType;
 }
 
+// =====================================================================================================================
+// Hashes everything which determines the final content of the pipeline's code upload: its size and heap, the uploaded
+// sections and their layout, the relocations applied to them and the symbols used to patch the internal SRD table.
+// Two pipelines with the same hash produce byte-identical uploads when placed at the same GPU virtual address, so they
+// can share one.
+void PipelineUploader::ComputeCodeHash(
+    const SectionAddressCalculator& addressCalc,
+    gpusize                         gpuMemSize)
+{
+    const ElfReader::Reader& elfReader = m_abiReader.GetElfReader();
+
+    MetroHash128 hasher;
+    hasher.Update(gpuMemSize);
+    hasher.Update(m_pipelineHeapType);
+
+    for (auto sectionIter = addressCalc.GetSectionsBegin(); sectionIter.IsValid(); sectionIter.Next())
+    {
+        const SectionAddressCalculator::SectionOffset& section = sectionIter.Get();
+        const uint64                                   size    = elfReader.GetSection(section.sectionId).sh_size;
+
+        hasher.Update(section.sectionId);
+        hasher.Update(section.offset);
+        hasher.Update(size);
+        hasher.Update(static_cast<const uint8*>(elfReader.GetSectionData(section.sectionId)), size);
+    }
+
+    for (ElfReader::SectionId i = 0; i < elfReader.GetNumSections(); i++)
+    {
+        const Elf::SectionHeaderType type = elfReader.GetSectionType(i);
+        if ((type == Elf::SectionHeaderType::Rel) || (type == Elf::SectionHeaderType::Rela))
+        {
+            const ElfReader::Relocations relocs(elfReader, i);
+            const ElfReader::Symbols     symbols(elfReader, relocs.GetSymbolSection());
+
+            hasher.Update(relocs.GetDestSection());
+
+            for (uint64 r = 0; r < relocs.GetNumRelocations(); r++)
+            {
+                const Elf::RelTableEntry&    relocation = relocs.GetRel(r);
+                const Elf::SymbolTableEntry& symbol     = symbols.GetSymbol(relocation.r_info.sym);
+                const uint32                 relType    = relocation.r_info.type;
+
+                hasher.Update(relocation.r_offset);
+                hasher.Update(relType);
+                hasher.Update(symbol.st_shndx);
+                hasher.Update(symbol.st_value);
+
+                if (relocs.IsRela())
+                {
+                    hasher.Update(relocs.GetRela(r).r_addend);
+                }
+            }
+        }
+    }
+
+    for (uint32 s = 0; s < static_cast<uint32>(Abi::HardwareStage::Count); ++s)
+    {
+        const Abi::PipelineSymbolType symbolType =
+            Abi::GetSymbolForStage(Abi::PipelineSymbolType::ShaderIntrlTblPtr, static_cast<Abi::HardwareStage>(s));
+
+        const Elf::SymbolTableEntry* pSymbol = m_abiReader.GetPipelineSymbol(symbolType);
+        if (pSymbol != nullptr)
+        {
+            hasher.Update(s);
+            hasher.Update(pSymbol->st_shndx);
+            hasher.Update(pSymbol->st_value);
+            hasher.Update(pSymbol->st_size);
+        }
+    }
+
+    hasher.Finalize(m_codeHash.bytes);
+}
+
+// =====================================================================================================================
+// Allocates and maps a separate block of GPU memory for the loaded registers.  Registers differ between pipelines which
+// otherwise share code, so they can't live in a shareable code upload.
+Result PipelineUploader::AllocateRegisterMemory(
+    uint32 totalRegisters,
+    void** ppMappedPtr)
+{
+    GpuMemoryCreateInfo createInfo = { };
+    createInfo.size      = (RegisterEntryBytes * totalRegisters);
+    createInfo.alignment = sizeof(uint32);
+    createInfo.vaRange   = VaRange::DescriptorTable;
+    createInfo.heaps[0]  = GpuHeapLocal;
+    createInfo.heaps[1]  = GpuHeapGartUswc;
+    createInfo.heapCount = 2;
+    createInfo.priority  = GpuMemPriority::High;
+
+    uint64 pagingFenceVal = 0;
+
+    GpuMemoryInternalCreateInfo internalInfo = { };
+    internalInfo.flags.alwaysResident = 1;
+    internalInfo.pPagingFence = &pagingFenceVal;
+
+    Result result =
+        m_pDevice->MemMgr()->AllocateGpuMem(createInfo, internalInfo, false, &m_pRegGpuMemory, &m_regGpuMemOffset);
+
+    void* pMappedPtr = nullptr;
+    if (result == Result::Success)
+    {
+        m_pagingFenceVal = Max(m_pagingFenceVal, pagingFenceVal);
+        m_regGpuMemSize  = createInfo.size;
+
+        result = m_pRegGpuMemory->Map(&pMappedPtr);
+    }
+
+    if (result == Result::Success)
+    {
+        *ppMappedPtr = VoidPtrInc(pMappedPtr, static_cast<size_t>(m_regGpuMemOffset));
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Allocates GPU memory for the current pipeline.  Also, maps the memory for CPU access and uploads the pipeline code
 // and data.  The GPU virtual addresses for the code, data, and register segments are also computed.  The caller is
 // responsible for calling End() which unmaps the GPU memory.
+//
+// If allowCodeSharing is set, the upload may instead reuse identical code already uploaded by another pipeline, or be
+// offered to later pipelines.  See IsCodeShared().
 Result PipelineUploader::Begin(
     const CodeObjectMetadata& metadata,
-    GpuHeap                   heap)
+    GpuHeap                   heap,
+    bool                      allowCodeSharing)
 {
     const PalSettings& settings = m_pDevice->Settings();
     Result result = Result::Success;
@@ -776,13 +953,13 @@ Result PipelineUploader::Begin(
     }
 
     const uint32 totalRegisters = (m_ctxRegisterCount + m_shRegisterCount);
+    const bool   shareCode      = (allowCodeSharing && settings.pipelineCodeSharing);
     if (result == Result::Success)
     {
         m_prefetchSize = addressCalculator.GetSize();
 
-        if (totalRegisters > 0)
+        if ((totalRegisters > 0) && (shareCode == false))
         {
-            constexpr uint32 RegisterEntryBytes = (sizeof(uint32) << 1);
             m_gpuMemSize = (Pow2Align(m_prefetchSize, sizeof(uint32)) + (RegisterEntryBytes * totalRegisters));
         }
 
@@ -805,17 +982,64 @@ Result PipelineUploader::Begin(
         createInfo.heapCount = 2;
         createInfo.priority  = GpuMemPriority::High;
 
-        GpuMemoryInternalCreateInfo internalInfo = { };
-        internalInfo.flags.alwaysResident = 1;
-        internalInfo.pPagingFence = &m_pagingFenceVal;
+        if (shareCode)
+        {
+            ComputeCodeHash(addressCalculator, m_gpuMemSize);
 
-        result = m_pDevice->MemMgr()->AllocateGpuMem(createInfo, internalInfo, false, &m_pGpuMemory, &m_baseOffset);
+            SharedPipelineCode code = { };
+            if (m_pDevice->AcquireSharedPipelineCode(m_codeHash, m_gpuMemSize, &code))
+            {
+                m_pGpuMemory      = code.pGpuMemory;
+                m_baseOffset      = code.offset;
+                m_pagingFenceVal  = code.pagingFenceVal;
+                m_codeUploadFence = code.uploadFence;
+                m_codeShared      = true;
+                m_codeReused      = true;
+            }
+        }
+
+        if (m_codeReused == false)
+        {
+            GpuMemoryInternalCreateInfo internalInfo = { };
+            internalInfo.flags.alwaysResident = 1;
+            internalInfo.pPagingFence = &m_pagingFenceVal;
+
+            result = m_pDevice->MemMgr()->AllocateGpuMem(createInfo,
+                                                         internalInfo,
+                                                         false,
+                                                         &m_pGpuMemory,
+                                                         &m_baseOffset);
+
+            if ((result == Result::Success) && shareCode)
+            {
+                const SharedPipelineCode code = { m_pGpuMemory, m_baseOffset, m_gpuMemSize, 0, m_pagingFenceVal };
+                m_codeShared = m_pDevice->ReserveSharedPipelineCode(m_codeHash, code);
+            }
+        }
     }
 
     void* pMappedPtr = nullptr;
     if (result == Result::Success)
     {
-        if (ShouldUploadUsingDma())
+        if (m_codeReused)
+        {
+            // The shared copy already holds the relocated code and data, so only record where each section lives.
+            const gpusize gpuVirtAddr = (m_pGpuMemory->Desc().gpuVirtAddr + m_baseOffset);
+
+            for (auto sectionIter = addressCalculator.GetSectionsBegin(); sectionIter.IsValid(); sectionIter.Next())
+            {
+                const SectionAddressCalculator::SectionOffset& section = sectionIter.Get();
+
+                if (m_memoryMap.AddSection(section.sectionId,
+                                           (gpuVirtAddr + section.offset),
+                                           elfReader.GetSectionData(section.sectionId)) == nullptr)
+                {
+                    result = Result::ErrorOutOfMemory;
+                    break;
+                }
+            }
+        }
+        else if (ShouldUploadUsingDma())
         {
             result = UploadUsingDma(addressCalculator, &pMappedPtr);
         }
@@ -825,6 +1049,11 @@ Result PipelineUploader::Begin(
         }
     }
 
+    if ((result == Result::Success) && shareCode && (totalRegisters > 0))
+    {
+        result = AllocateRegisterMemory(totalRegisters, &pMappedPtr);
+    }
+
     if (result == Result::Success)
     {
         m_prefetchGpuVirtAddr = (m_pGpuMemory->Desc().gpuVirtAddr + m_baseOffset);
@@ -833,7 +1062,8 @@ Result PipelineUploader::Begin(
         {
             PAL_ASSERT(pMappedPtr != nullptr);
 
-            gpusize gpuVirtAddr  = (m_prefetchGpuVirtAddr + addressCalculator.GetSize());
+            gpusize gpuVirtAddr  = shareCode ? (m_pRegGpuMemory->Desc().gpuVirtAddr + m_regGpuMemOffset)
+                                             : (m_prefetchGpuVirtAddr + addressCalculator.GetSize());
             uint64 paddingSize   = Pow2Align(gpuVirtAddr, sizeof(uint32)) - gpuVirtAddr;
             gpuVirtAddr          = gpuVirtAddr + paddingSize;
             uint32* pRegWritePtr = static_cast<uint32*>(VoidPtrInc(pMappedPtr, static_cast<size_t>(paddingSize)));
@@ -989,8 +1219,8 @@ Result PipelineUploader::UploadUsingCpu(
 Result PipelineUploader::ApplyRelocations()
 {
     Result result = Result::Success;
-    // Apply relocations: Iterate through all REL sections
-    Util::ElfReader::SectionId numSections = m_abiReader.GetElfReader().GetNumSections();
+    // Apply relocations: Iterate through all REL sections.  A reused code upload was relocated by its first owner.
+    Util::ElfReader::SectionId numSections = m_codeReused ? 0 : m_abiReader.GetElfReader().GetNumSections();
     for (Util::ElfReader::SectionId i = 0; i < numSections; i++)
     {
         auto type = m_abiReader.GetElfReader().GetSectionType(i);
@@ -1151,7 +1381,12 @@ Result PipelineUploader::End(
         m_pCtxRegWritePtr = nullptr;
         m_pShRegWritePtr  = nullptr;
 
-        if (ShouldUploadUsingDma())
+        if (m_codeReused)
+        {
+            // The first owner of the shared code already submitted its upload; wait on the same fence.
+            *pCompletionFence = m_codeUploadFence;
+        }
+        else if (ShouldUploadUsingDma())
         {
             const size_t dataRegisterAndPadding = static_cast<size_t>(m_gpuMemSize - m_heapInvisUploadOffset);
             if (dataRegisterAndPadding > 0)
@@ -1172,6 +1407,16 @@ Result PipelineUploader::End(
             result = m_pGpuMemory->Unmap();
         }
 
+        if ((result == Result::Success) && (m_pRegGpuMemory != nullptr))
+        {
+            result = m_pRegGpuMemory->Unmap();
+        }
+
+        if ((result == Result::Success) && m_codeShared && (m_codeReused == false))
+        {
+            m_pDevice->CompleteSharedPipelineCode(m_codeHash, *pCompletionFence);
+        }
+
         m_pMappedPtr = nullptr;
     }
 
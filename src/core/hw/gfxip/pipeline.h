@@ -170,6 +170,9 @@ protected:
         const GpuHeap&            clientPreferredHeap,
         PipelineUploader*         pUploader);
 
+    // Logs the developer events binding this pipeline's GPU memory, including any separate register allocation.
+    void LogGpuMemoryBindEvents() const;
+
     void ExtractPipelineInfo(
         const CodeObjectMetadata& metadata,
         ShaderType                firstShader,
@@ -201,6 +204,10 @@ protected:
     BoundGpuMemory  m_gpuMem;
     gpusize         m_gpuMemSize;
 
+    BoundGpuMemory         m_regGpuMem;     // Loaded registers, when they are kept apart from a shareable code upload.
+    gpusize                m_regGpuMemSize;
+    Util::MetroHash::Hash  m_codeHash;      // Key of m_gpuMem in the device's shared pipeline code cache.
+
     void*   m_pPipelineBinary;      // Buffer containing the pipeline binary data (Pipeline ELF ABI).
     size_t  m_pipelineBinaryLen;    // Size of the pipeline binary data, in bytes.
 
@@ -217,7 +224,8 @@ private:
         {
             uint32  isInternal        :  1;  // True if this Pipeline object was created internally by PAL.
             uint32  taskShaderEnabled :  1;
-            uint32  reserved          : 30;
+            uint32  sharedCode        :  1;  // m_gpuMem is owned by the device's shared pipeline code cache.
+            uint32  reserved          : 29;
         };
         uint32  value;  // Flags packed as a uint32.
     } m_flags;
@@ -372,7 +380,7 @@ public:
         uint32           shRegisterCount);
     virtual ~PipelineUploader();
 
-    Result Begin(const CodeObjectMetadata& metadata, GpuHeap heap);
+    Result Begin(const CodeObjectMetadata& metadata, GpuHeap heap, bool allowCodeSharing);
 
     Result ApplyRelocations();
 
@@ -387,6 +395,14 @@ public:
     gpusize GpuMemSize() const { return m_gpuMemSize; }
     gpusize GpuMemOffset() const { return m_baseOffset; }
 
+    // When the code upload is shared, GpuMem() is owned by the device's shared pipeline code cache and must be released
+    // through Device::ReleaseSharedPipelineCode using CodeHash().  Any loaded registers then live in RegGpuMem().
+    bool IsCodeShared() const { return m_codeShared; }
+    const Util::MetroHash::Hash& CodeHash() const { return m_codeHash; }
+    GpuMemory* RegGpuMem() const { return m_pRegGpuMemory; }
+    gpusize RegGpuMemOffset() const { return m_regGpuMemOffset; }
+    gpusize RegGpuMemSize() const { return m_regGpuMemSize; }
+
     uint64 PagingFenceVal() const { return m_pagingFenceVal; }
 
     gpusize CtxRegGpuVirtAddr() const { return m_ctxRegGpuVirtAddr; }
@@ -437,6 +453,9 @@ private:
 
     GpuHeap SelectUploadHeap(GpuHeap heap);
 
+    void ComputeCodeHash(const SectionAddressCalculator& addressCalc, gpusize gpuMemSize);
+    Result AllocateRegisterMemory(uint32 totalRegisters, void** ppMappedPtr);
+
     bool ShouldUploadUsingDma() const { return (m_pipelineHeapType == GpuHeap::GpuHeapInvisible); }
 
     Result UploadUsingCpu(const SectionAddressCalculator& addressCalc, void** ppMappedPtr);
@@ -472,6 +491,15 @@ private:
     UploadRingSlot  m_slotId;
     gpusize         m_heapInvisUploadOffset;
 
+    bool                   m_codeShared;     // GpuMem() belongs to the device's shared pipeline code cache.
+    bool                   m_codeReused;     // The code upload was found in the cache, so nothing is uploaded.
+    Util::MetroHash::Hash  m_codeHash;       // Hash of the uploaded sections, their layout and their relocations.
+    UploadFenceToken       m_codeUploadFence; // Upload fence of a reused code upload.
+
+    GpuMemory*  m_pRegGpuMemory;   // Separate allocation for loaded registers when the code upload is shareable.
+    gpusize     m_regGpuMemOffset;
+    gpusize     m_regGpuMemSize;
+
     PAL_DISALLOW_DEFAULT_CTOR(PipelineUploader);
     PAL_DISALLOW_COPY_AND_ASSIGN(PipelineUploader);
 };
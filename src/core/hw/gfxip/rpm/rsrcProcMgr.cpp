@@ -273,6 +273,50 @@ void RsrcProcMgr::CopyMemoryCs(
         }
     }
 
+    // Regions which are contiguous in both the source and destination can be copied by a single dispatch. Sparse
+    // uploads tend to produce long runs of these so merge them up-front. The P2P workaround has already split the
+    // regions along its own chunk boundaries so we must leave its region list alone.
+    AutoBuffer<MemoryCopyRegion, 32, Platform> mergedRegions(p2pBltInfoRequired ? 0 : regionCount,
+                                                             m_pDevice->GetPlatform());
+    if ((p2pBltInfoRequired == false) && (regionCount > 1) && (mergedRegions.Capacity() >= regionCount))
+    {
+        uint32 mergedCount = 0;
+        mergedRegions[0]   = pRegions[0];
+
+        for (uint32 idx = 1; idx < regionCount; ++idx)
+        {
+            MemoryCopyRegion*const pLast = &mergedRegions[mergedCount];
+
+            if (((pLast->srcOffset + pLast->copySize) == pRegions[idx].srcOffset) &&
+                ((pLast->dstOffset + pLast->copySize) == pRegions[idx].dstOffset))
+            {
+                pLast->copySize += pRegions[idx].copySize;
+            }
+            else
+            {
+                mergedRegions[++mergedCount] = pRegions[idx];
+            }
+        }
+
+        regionCount = mergedCount + 1;
+        pRegions    = &mergedRegions[0];
+    }
+
+    // Each dispatch needs a table of two buffer views. Rather than allocating and binding a separate embedded table for
+    // every dispatch, we pack as many tables as we can into each embedded data allocation and only rebind the pointer.
+    uint32 sectionsRemaining = 0;
+    for (uint32 idx = 0; idx < regionCount; ++idx)
+    {
+        sectionsRemaining += static_cast<uint32>(RoundUpQuotient(pRegions[idx].copySize, CopySizeLimit));
+    }
+
+    const uint32 tableDwords      = SrdDwordAlignment() * NumGpuMemory;
+    const uint32 maxTablesPerData = Max(1u, (pCmdBuffer->GetEmbeddedDataLimit() / tableDwords));
+
+    uint32*  pSrdTable       = nullptr;
+    gpusize  tableGpuVa      = 0;
+    uint32   tablesRemaining = 0;
+
     // Save current command buffer state.
     pCmdBuffer->CmdSaveComputeState(ComputeStatePipelineAndUserData);
 
@@ -280,6 +324,9 @@ void RsrcProcMgr::CopyMemoryCs(
     // with wide format may result in worse performance.
     const bool preferWideFormatCopy = (srcGpuMemory.IsLocalPreferred() && dstGpuMemory.IsLocalPreferred());
 
+    // Consecutive dispatches frequently use the same copy pipeline, there's no need to rebind it each time.
+    const ComputePipeline* pBoundPipeline = nullptr;
+
     // Now begin processing the list of copy regions.
     for (uint32 idx = 0; idx < regionCount; ++idx)
     {
@@ -296,13 +343,14 @@ void RsrcProcMgr::CopyMemoryCs(
         {
             const uint32 copySectionSize = static_cast<uint32>(Min(CopySizeLimit, copySize - copyOffset));
 
-            // Create an embedded user-data table and bind it to user data. We need buffer views for the source and
-            // destination.
-            uint32* pSrdTable = RpmUtil::CreateAndBindEmbeddedUserData(pCmdBuffer,
-                                                                       SrdDwordAlignment() * NumGpuMemory,
-                                                                       SrdDwordAlignment(),
-                                                                       PipelineBindPoint::Compute,
-                                                                       0);
+            if (tablesRemaining == 0)
+            {
+                tablesRemaining = Min(sectionsRemaining, maxTablesPerData);
+                pSrdTable       = pCmdBuffer->CmdAllocateEmbeddedData(tablesRemaining * tableDwords,
+                                                                      SrdDwordAlignment(),
+                                                                      &tableGpuVa);
+                PAL_ASSERT(pSrdTable != nullptr);
+            }
 
             // Populate the table with raw buffer views, by convention the destination is placed before the source.
             BufferViewInfo rawBufferView = {};
@@ -311,16 +359,21 @@ void RsrcProcMgr::CopyMemoryCs(
                                             dstOffset + copyOffset,
                                             copySectionSize);
             m_pDevice->Parent()->CreateUntypedBufferViewSrds(1, &rawBufferView, pSrdTable);
-            pSrdTable += SrdDwordAlignment();
 
             RpmUtil::BuildRawBufferViewInfo(&rawBufferView,
                                             srcGpuMemory,
                                             srcOffset + copyOffset,
                                             copySectionSize);
-            m_pDevice->Parent()->CreateUntypedBufferViewSrds(1, &rawBufferView, pSrdTable);
+            m_pDevice->Parent()->CreateUntypedBufferViewSrds(1, &rawBufferView, pSrdTable + SrdDwordAlignment());
+
+            // Bind this dispatch's table along with the region constants in a single user-data update.
+            const uint32 regionUserData[4] = { LowPart(tableGpuVa), 0, 0, copySectionSize };
+            pCmdBuffer->CmdSetUserData(PipelineBindPoint::Compute, 0, 4, regionUserData);
 
-            const uint32 regionUserData[3] = { 0, 0, copySectionSize };
-            pCmdBuffer->CmdSetUserData(PipelineBindPoint::Compute, 1, 3, regionUserData);
+            pSrdTable  += tableDwords;
+            tableGpuVa += (tableDwords * sizeof(uint32));
+            --tablesRemaining;
+            --sectionsRemaining;
 
             // Get the pipeline object and number of thread groups.
             const ComputePipeline* pPipeline = nullptr;
@@ -354,7 +407,12 @@ void RsrcProcMgr::CopyMemoryCs(
             }
 
             // Bind pipeline and dispatch.
-            pCmdBuffer->CmdBindPipeline({ PipelineBindPoint::Compute, pPipeline, InternalApiPsoHash, });
+            if (pPipeline != pBoundPipeline)
+            {
+                pCmdBuffer->CmdBindPipeline({ PipelineBindPoint::Compute, pPipeline, InternalApiPsoHash, });
+                pBoundPipeline = pPipeline;
+            }
+
             pCmdBuffer->CmdDispatch(numThreadGroups, 1, 1);
         }
     }
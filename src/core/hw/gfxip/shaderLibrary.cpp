@@ -215,7 +215,7 @@ Result ShaderLibrary::PerformRelocationsAndUploadToGpuMemory(
     m_perfDataGpuMemSize = performanceDataOffset;
     Result result        = Result::Success;
 
-    result = pUploader->Begin(metadata, clientPreferredHeap);
+    result = pUploader->Begin(metadata, clientPreferredHeap, false);
 
     if (result == Result::Success)
     {
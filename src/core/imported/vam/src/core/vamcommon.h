@@ -51,8 +51,11 @@ struct VamChunk : public VamObject, public VamLink<VamChunk>, public VamTreeNode
         VamLink<VamChunk>(),
         VamTreeNode<VamChunk>()
     {
-        m_addr = 0;
-        m_size = 0;
+        m_addr     = 0;
+        m_size     = 0;
+        m_pBinNext = NULL;
+        m_pBinPrev = NULL;
+        m_bin      = 0;
     }
     ~VamChunk() {}
 
@@ -60,11 +63,145 @@ struct VamChunk : public VamObject, public VamLink<VamChunk>, public VamTreeNode
 
     VAM_VIRTUAL_ADDRESS     m_addr;
     VAM_VA_SIZE             m_size;
+
+    VamChunk*               m_pBinNext; // Next chunk in the same ChunkBins size class
+    VamChunk*               m_pBinPrev; // Previous chunk in the same ChunkBins size class
+    unsigned int            m_bin;      // Size class the chunk is currently filed under
 };
 
 typedef VamList<VamChunk> ChunkList;
 typedef VamTree<VamChunk, VAM_VA_SIZE> ChunkTree;
 
+/// Segregated index of free chunks. Chunks are filed in power-of-two size classes (class N holds sizes in
+/// [2^N, 2^(N+1))), so a fitting chunk can be found without walking the address-ordered chunk list.
+class ChunkBins
+{
+public:
+    static const unsigned int NumBins = 64;
+
+    ChunkBins()
+    {
+        clear();
+    }
+
+    /// Forgets every chunk without touching them.
+    void clear(void)
+    {
+        for (unsigned int i = 0; i < NumBins; i++)
+        {
+            m_pHead[i] = NULL;
+        }
+    }
+
+    /// Files a chunk under its current size.
+    void insert(VamChunk* pChunk)
+    {
+        VAM_ASSERT(pChunk->m_size != 0);
+
+        const unsigned int bin = binIndex(pChunk->m_size);
+
+        pChunk->m_bin      = bin;
+        pChunk->m_pBinPrev = NULL;
+        pChunk->m_pBinNext = m_pHead[bin];
+
+        if (m_pHead[bin] != NULL)
+        {
+            m_pHead[bin]->m_pBinPrev = pChunk;
+        }
+        m_pHead[bin] = pChunk;
+    }
+
+    /// Removes a chunk from the size class it was filed under.
+    void remove(VamChunk* pChunk)
+    {
+        if (pChunk->m_pBinPrev != NULL)
+        {
+            pChunk->m_pBinPrev->m_pBinNext = pChunk->m_pBinNext;
+        }
+        else
+        {
+            VAM_ASSERT(m_pHead[pChunk->m_bin] == pChunk);
+            m_pHead[pChunk->m_bin] = pChunk->m_pBinNext;
+        }
+
+        if (pChunk->m_pBinNext != NULL)
+        {
+            pChunk->m_pBinNext->m_pBinPrev = pChunk->m_pBinPrev;
+        }
+
+        pChunk->m_pBinNext = NULL;
+        pChunk->m_pBinPrev = NULL;
+    }
+
+    /// Must be called after a filed chunk's size changes.
+    void resize(VamChunk* pChunk)
+    {
+        if (binIndex(pChunk->m_size) != pChunk->m_bin)
+        {
+            remove(pChunk);
+            insert(pChunk);
+        }
+    }
+
+    /// Returns a chunk which can hold sizeInBytes at the given alignment, or NULL if there is none. Classes which
+    /// are guaranteed to be large enough are searched smallest first; the request's own class, which may also hold
+    /// smaller chunks, is only searched when none of those fit.
+    VamChunk* findFit(VAM_VA_SIZE sizeInBytes, VAM_VA_SIZE alignment) const
+    {
+        VamChunk*          pFit     = NULL;
+        const unsigned int floorBin = binIndex(sizeInBytes);
+        const unsigned int ceilBin  = (sizeInBytes == (1ULL << floorBin)) ? floorBin : (floorBin + 1);
+
+        for (unsigned int bin = ceilBin; (bin < NumBins) && (pFit == NULL); bin++)
+        {
+            pFit = findFitInBin(bin, sizeInBytes, alignment);
+        }
+
+        if ((pFit == NULL) && (ceilBin != floorBin))
+        {
+            pFit = findFitInBin(floorBin, sizeInBytes, alignment);
+        }
+
+        return pFit;
+    }
+
+    /// Returns how far a chunk's start must be moved to reach the given alignment.
+    static VAM_VA_SIZE alignAdjustment(const VamChunk* pChunk, VAM_VA_SIZE alignment)
+    {
+        const VAM_VA_SIZE remainder = pChunk->m_addr % alignment;
+
+        return (remainder == 0) ? 0 : (alignment - remainder);
+    }
+
+private:
+    static unsigned int binIndex(VAM_VA_SIZE size)
+    {
+        unsigned int bin = 0;
+
+        while (size > 1)
+        {
+            size >>= 1;
+            bin++;
+        }
+
+        return bin;
+    }
+
+    VamChunk* findFitInBin(unsigned int bin, VAM_VA_SIZE sizeInBytes, VAM_VA_SIZE alignment) const
+    {
+        VamChunk* pChunk = m_pHead[bin];
+
+        while ((pChunk != NULL) && ((sizeInBytes + alignAdjustment(pChunk, alignment)) > pChunk->m_size))
+        {
+            pChunk = pChunk->m_pBinNext;
+        }
+
+        return pChunk;
+    }
+
+    VamChunk*   m_pHead[NumBins];   // First chunk of each size class
+};
+
 struct VamExcludedRange : public VamObject, public VamLink<VamExcludedRange>
 {
     VamExcludedRange(VAM_CLIENT_HANDLE hClient)
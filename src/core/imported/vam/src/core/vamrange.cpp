@@ -38,7 +38,8 @@ VAM_RETURNCODE VamVARange::AllocateVASpace(
     VAM_ALLOCATION&     allocation)
 {
     VAM_RETURNCODE  ret = VAM_OUTOFMEMORY;
-    VAM_VA_SIZE     remainder, adjustment;
+    VAM_VA_SIZE     adjustment;
+    VamChunk*       pChunk;
     VamChunk*       pExtraChunk;
 
     if (!sizeInBytes)
@@ -47,85 +48,76 @@ VAM_RETURNCODE VamVARange::AllocateVASpace(
         return VAM_INVALIDPARAMETERS;
     }
 
-    // Iterate through all chunks, looking for first one that's big enough
-    for (ChunkList::Iterator chunk( chunkList() );
-         chunk != NULL;
-         chunk++ )
+    // Look up a chunk that is big enough, including any alignment padding,
+    // in the size-class index rather than walking the whole chunk list.
+    pChunk = chunkBins().findFit(sizeInBytes, alignment);
+    if (pChunk != NULL)
     {
-        if (sizeInBytes <= chunk->m_size)
+        adjustment = ChunkBins::alignAdjustment(pChunk, alignment);
+        if (adjustment == 0)
         {
-            // This chunk is a possible candidate, provided
-            // that the alignment requirement is met.
-            remainder = chunk->m_addr % alignment;
-            if (remainder == 0)
+            // Both size and alignment are OK at the start of the chunk.
+            // Adjust the chunk's parameters and exit with success.
+            allocation.address = pChunk->m_addr;
+            allocation.size    = sizeInBytes;
+            pChunk->m_addr    += sizeInBytes;
+            pChunk->m_size    -= sizeInBytes;
+            if (!pChunk->m_size)
             {
-                // Both size and alignment are OK at the start of the chunk.
-                // Adjust the chunk's parameters and exit with success.
-                allocation.address = chunk->m_addr;
-                allocation.size    = sizeInBytes;
-                chunk->m_addr     += sizeInBytes;
-                chunk->m_size     -= sizeInBytes;
-                if (!chunk->m_size)
-                {
-                    // The allocation has the exact size as the chunk.
-                    chunkList().remove(chunk);
+                // The allocation has the exact size as the chunk.
+                chunkList().remove(pChunk);
+                chunkBins().remove(pChunk);
 
-                    if (m_treeEnabled)
-                    {
-                        chunkTree().remove(chunk);
-                    }
-                    FreeChunk(chunk);
+                if (m_treeEnabled)
+                {
+                    chunkTree().remove(pChunk);
                 }
-                ret = VAM_OK;
-                break;
+                FreeChunk(pChunk);
             }
             else
             {
-                // See if the chunk's size is large enough to achieve the req'd alignment
-                adjustment = alignment - remainder;
-                if ((sizeInBytes + adjustment) <= chunk->m_size)
+                chunkBins().resize(pChunk);
+            }
+            ret = VAM_OK;
+        }
+        else if ((sizeInBytes + adjustment) < pChunk->m_size)
+        {
+            // If the aligned allocation is smaller than the remainder of the chunk,
+            // we'll need to create a new chunk to the right of the allocation.
+            pExtraChunk = AllocChunk();
+            if (pExtraChunk != NULL)
+            {
+                // Reflect the extra chunk's properties and add it to the list
+                pExtraChunk->m_addr = pChunk->m_addr + adjustment + sizeInBytes;
+                pExtraChunk->m_size = pChunk->m_size - (adjustment + sizeInBytes);
+                chunkList().insertAfter(pChunk, pExtraChunk);
+                chunkBins().insert(pExtraChunk);
+
+                if (m_treeEnabled)
                 {
-                    // If the aligned allocation is smaller than the remainder of the chunk,
-                    // we'll need to create a new chunk to the right of the allocation.
-                    if ((sizeInBytes + adjustment) < chunk->m_size)
-                    {
-                        // Split what remains of the chunk. We need to create
-                        // an extra chunk to reflect the remaining free space.
-                        pExtraChunk = AllocChunk();
-                        if (pExtraChunk != NULL)
-                        {
-                            // Reflect the extra chunk's properties and add it to the list
-                            pExtraChunk->m_addr = chunk->m_addr + adjustment + sizeInBytes;
-                            pExtraChunk->m_size = chunk->m_size - (adjustment + sizeInBytes);
-                            chunkList().insertAfter(chunk, pExtraChunk);
-
-                            if (m_treeEnabled)
-                            {
-                                chunkTree().insert(pExtraChunk);
-                            }
-
-                            // Adjust the existing chunk to the left of the allocation.
-                            // Note that its starting address remains unaltered.
-                            chunk->m_size       = adjustment;
-
-                            allocation.address  = chunk->m_addr + adjustment;
-                            allocation.size     = sizeInBytes;
-                            ret = VAM_OK;
-                        }
-                    }
-                    else
-                    {
-                        // Allocation fits completely in the rest of the existing chunk.
-                        // Adjust the chunk's size only, since its address will remain as is.
-                        allocation.address = chunk->m_addr + adjustment;
-                        allocation.size    = sizeInBytes;
-                        chunk->m_size      = adjustment;
-                        ret = VAM_OK;
-                    }
-                    break;
+                    chunkTree().insert(pExtraChunk);
                 }
+
+                // Adjust the existing chunk to the left of the allocation.
+                // Note that its starting address remains unaltered.
+                pChunk->m_size      = adjustment;
+                chunkBins().resize(pChunk);
+
+                allocation.address  = pChunk->m_addr + adjustment;
+                allocation.size     = sizeInBytes;
+                ret = VAM_OK;
             }
         }
+        else
+        {
+            // Allocation fits completely in the rest of the existing chunk.
+            // Adjust the chunk's size only, since its address will remain as is.
+            allocation.address = pChunk->m_addr + adjustment;
+            allocation.size    = sizeInBytes;
+            pChunk->m_size     = adjustment;
+            chunkBins().resize(pChunk);
+            ret = VAM_OK;
+        }
     }
 
     if (ret == VAM_OK)
@@ -145,6 +137,8 @@ VAM_RETURNCODE VamVARange::AllocateVASpaceWithAddress(
     VAM_RETURNCODE      ret = VAM_VIRTUALADDRESSCONFLICT;
     VAM_VIRTUAL_ADDRESS startVA, endVA, offsetVA;
     VAM_VA_SIZE         adjustedSize;
+    VamChunk*           pChunk  = NULL;
+    VamChunk*           pChunkR = NULL;
     VamChunk*           pExtraChunk;
 
     if (!sizeInBytes)
@@ -159,98 +153,123 @@ VAM_RETURNCODE VamVARange::AllocateVASpaceWithAddress(
     endVA        = ROUND_UP(requestedVA + sizeInBytes, (long long) alignmentGranularity()) - 1;
     adjustedSize = endVA - startVA + 1;
 
-    // Iterate through all chunks, looking for the one that's applicable
-    for (ChunkList::Iterator chunk( chunkList() );
-          chunk != NULL;
-          chunk++ )
-    {
-        // Find the following address after requested VA base
-        // note: chunks are located in the range order, if (startVA < chunk->m_addr),
-        // then we passed the original startVA for >= already
-        if (beyondBaseVA &&
-            (startVA < chunk->m_addr) &&
-            (adjustedSize <= chunk->m_size))
+    if (m_treeEnabled && !beyondBaseVA && (chunkTree().numObjects() > 0))
+    {
+        // Only the closest chunk starting at or below startVA can contain the allocation.
+        chunkTree().findContainingNodes(startVA, &pChunk, &pChunkR);
+        if ((pChunk != NULL) &&
+            ((startVA < pChunk->m_addr) || (endVA > (pChunk->m_addr + pChunk->m_size))))
         {
-            // chunk->m_addr should be already aligned to alignmentGranularity()
-            startVA = chunk->m_addr;
-            endVA   = ROUND_UP(startVA + sizeInBytes, (long long) alignmentGranularity()) - 1;
-            adjustedSize = endVA - startVA + 1;
+            pChunk = NULL;
+        }
+    }
+    else
+    {
+        // Iterate through all chunks, looking for the one that's applicable
+        for (ChunkList::Iterator chunk( chunkList() );
+              chunk != NULL;
+              chunk++ )
+        {
+            // Find the following address after requested VA base
+            // note: chunks are located in the range order, if (startVA < chunk->m_addr),
+            // then we passed the original startVA for >= already
+            if (beyondBaseVA &&
+                (startVA < chunk->m_addr) &&
+                (adjustedSize <= chunk->m_size))
+            {
+                // chunk->m_addr should be already aligned to alignmentGranularity()
+                startVA = chunk->m_addr;
+                endVA   = ROUND_UP(startVA + sizeInBytes, (long long) alignmentGranularity()) - 1;
+                adjustedSize = endVA - startVA + 1;
+            }
+
+            // Check if the requested allocation is within this chunk's range
+            if ((startVA >= chunk->m_addr) &&
+                (endVA   <= (chunk->m_addr + chunk->m_size)))
+            {
+                pChunk = chunk;
+                break;
+            }
         }
+    }
 
-        // Check if the requested allocation is within this chunk's range
-        if ((startVA >= chunk->m_addr) &&
-            (endVA   <= (chunk->m_addr + chunk->m_size)))
+    if (pChunk != NULL)
+    {
+        // This chunk is good. Check to see if we need
+        // a chunk on the left side of the allocation.
+        offsetVA = startVA - pChunk->m_addr;
+        if (offsetVA == 0)
         {
-            // This chunk is good. Check to see if we need
-            // a chunk on the left side of the allocation.
-            offsetVA = startVA - chunk->m_addr;
-            if (offsetVA == 0)
+            // There will be no chunk to the left. Adjust the
+            // existing chunk's parameters and exit with success.
+            allocation.address = startVA;
+            allocation.size    = adjustedSize;
+            pChunk->m_addr    += adjustedSize;
+            pChunk->m_size    -= adjustedSize;
+            if (!pChunk->m_size)
             {
-                // There will be no chunk to the left. Adjust the
-                // existing chunk's parameters and exit with success.
-                allocation.address = startVA;
-                allocation.size    = adjustedSize;
-                chunk->m_addr     += adjustedSize;
-                chunk->m_size     -= adjustedSize;
-                if (!chunk->m_size)
-                {
-                    // The allocation has the exact size as the chunk.
-                    // This chunk will not be needed, so get rid of it.
-                    chunkList().remove(chunk);
+                // The allocation has the exact size as the chunk.
+                // This chunk will not be needed, so get rid of it.
+                chunkList().remove(pChunk);
+                chunkBins().remove(pChunk);
 
-                    if (m_treeEnabled)
-                    {
-                        chunkTree().remove(chunk);
-                    }
-                    FreeChunk(chunk);
+                if (m_treeEnabled)
+                {
+                    chunkTree().remove(pChunk);
                 }
-                ret = VAM_OK;
-                break;
+                FreeChunk(pChunk);
             }
             else
             {
-                // If the aligned allocation is smaller than the remainder of the chunk,
-                // we'll need to create a new chunk to the right of the allocation.
-                if ((offsetVA + adjustedSize) < chunk->m_size)
+                chunkBins().resize(pChunk);
+            }
+            ret = VAM_OK;
+        }
+        else
+        {
+            // If the aligned allocation is smaller than the remainder of the chunk,
+            // we'll need to create a new chunk to the right of the allocation.
+            if ((offsetVA + adjustedSize) < pChunk->m_size)
+            {
+                // Split what remains of the chunk. We need to create an extra chunk
+                // to the right of the allocation to reflect the remaining free space.
+                pExtraChunk = AllocChunk();
+                if (pExtraChunk != NULL)
                 {
-                    // Split what remains of the chunk. We need to create an extra chunk
-                    // to the right of the allocation to reflect the remaining free space.
-                    pExtraChunk = AllocChunk();
-                    if (pExtraChunk != NULL)
-                    {
-                        // Reflect the extra chunk's properties and add it to the list
-                        pExtraChunk->m_addr = endVA + 1;
-                        pExtraChunk->m_size = chunk->m_size - (offsetVA + adjustedSize);
-                        chunkList().insertAfter(chunk, pExtraChunk);
-
-                        if (m_treeEnabled)
-                        {
-                            chunkTree().insert(pExtraChunk);
-                        }
-
-                        // Adjust the existing chunk to the left of the allocation.
-                        // Note that its starting address remains unaltered.
-                        chunk->m_size       = offsetVA;
-
-                        allocation.address  = startVA;
-                        allocation.size     = adjustedSize;
-                        ret = VAM_OK;
-                    }
-                    else
+                    // Reflect the extra chunk's properties and add it to the list
+                    pExtraChunk->m_addr = endVA + 1;
+                    pExtraChunk->m_size = pChunk->m_size - (offsetVA + adjustedSize);
+                    chunkList().insertAfter(pChunk, pExtraChunk);
+                    chunkBins().insert(pExtraChunk);
+
+                    if (m_treeEnabled)
                     {
-                        ret = VAM_OUTOFMEMORY;
+                        chunkTree().insert(pExtraChunk);
                     }
+
+                    // Adjust the existing chunk to the left of the allocation.
+                    // Note that its starting address remains unaltered.
+                    pChunk->m_size      = offsetVA;
+                    chunkBins().resize(pChunk);
+
+                    allocation.address  = startVA;
+                    allocation.size     = adjustedSize;
+                    ret = VAM_OK;
                 }
                 else
                 {
-                    // Allocation fits completely in the rest of the existing chunk.
-                    // Adjust the chunk's size only, since its address will remain as is.
-                    allocation.address = startVA;
-                    allocation.size    = adjustedSize;
-                    chunk->m_size      = offsetVA;
-                    ret = VAM_OK;
+                    ret = VAM_OUTOFMEMORY;
                 }
-                break;
+            }
+            else
+            {
+                // Allocation fits completely in the rest of the existing chunk.
+                // Adjust the chunk's size only, since its address will remain as is.
+                allocation.address = startVA;
+                allocation.size    = adjustedSize;
+                pChunk->m_size     = offsetVA;
+                chunkBins().resize(pChunk);
+                ret = VAM_OK;
             }
         }
     }
@@ -421,14 +440,18 @@ VAM_RETURNCODE VamVARange::FreeVASpaceWithTreeDisabled(
             {
                 pChunkL->m_size += pChunkR->m_size;
                 chunkList().remove(pChunkR);
+                chunkBins().remove(pChunkR);
                 FreeChunk(pChunkR);
             }
         }
+
+        chunkBins().resize(pChunkL);
     }
     else if (pChunkR && (adjustedVA + adjustedSize == pChunkR->m_addr))
     {
         pChunkR->m_addr -= adjustedSize;
         pChunkR->m_size += adjustedSize;
+        chunkBins().resize(pChunkR);
     }
     else
     {
@@ -448,6 +471,8 @@ VAM_RETURNCODE VamVARange::FreeVASpaceWithTreeDisabled(
             {
                 chunkList().insertLast(pNewChunk);
             }
+
+            chunkBins().insert(pNewChunk);
         }
         else
         {
@@ -493,7 +518,11 @@ VAM_RETURNCODE VamVARange::FreeVASpaceWithTreeEnabled(
     adjustedVA   = ROUND_DOWN(virtualAddress, (long long) alignmentGranularity());
     adjustedSize = ROUND_UP(actualSize, (long long) alignmentGranularity());
 
-    chunkTree().findContainingNodes(adjustedVA, &pChunkL, &pChunkR);
+    // The tree is empty when the whole range is allocated; the freed range then becomes the only chunk.
+    if (chunkTree().numObjects() > 0)
+    {
+        chunkTree().findContainingNodes(adjustedVA, &pChunkL, &pChunkR);
+    }
 
     if (pChunkL && IsVASpaceInsideChunk(adjustedVA, adjustedSize, pChunkL))
     {
@@ -516,14 +545,18 @@ VAM_RETURNCODE VamVARange::FreeVASpaceWithTreeEnabled(
                 pChunkL->m_size += pChunkR->m_size;
                 chunkList().remove(pChunkR);
                 chunkTree().remove(pChunkR);
+                chunkBins().remove(pChunkR);
                 FreeChunk(pChunkR);
             }
         }
+
+        chunkBins().resize(pChunkL);
     }
     else if (pChunkR && (adjustedVA + adjustedSize == pChunkR->m_addr))
     {
         pChunkR->m_addr -= adjustedSize;
         pChunkR->m_size += adjustedSize;
+        chunkBins().resize(pChunkR);
     }
     else
     {
@@ -545,6 +578,7 @@ VAM_RETURNCODE VamVARange::FreeVASpaceWithTreeEnabled(
             }
 
             chunkTree().insert(pNewChunk);
+            chunkBins().insert(pNewChunk);
         }
         else
         {
@@ -592,6 +626,7 @@ VAM_RETURNCODE VamVARange::Init(
         pChunk->m_addr = addr;
         pChunk->m_size = size;
         chunkList().insertFirst(pChunk);
+        chunkBins().insert(pChunk);
 
         // Initialize the VA space state to specified defaults
         m_addr                  = addr;
@@ -623,6 +658,7 @@ void VamVARange::FreeChunk(VamChunk* pChunk)
 void VamVARange::FreeChunksFromList(void)
 {
     // Free the chunks from the chunk list
+    chunkBins().clear();
     if (!chunkList().isEmpty())
     {
         for (ChunkList::SafeReverseIterator chunk( chunkList() );
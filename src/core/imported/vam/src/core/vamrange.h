@@ -73,6 +73,9 @@ public:
     ChunkTree& chunkTree(void)
     {return m_chunkTree;}
 
+    ChunkBins& chunkBins(void)
+    {return m_chunkBins;}
+
     void incFreeSize(VAM_VA_SIZE size)
     {
         m_totalFreeSize += size;
@@ -150,6 +153,7 @@ private:
     VAM_VA_SIZE             m_totalFreeSize;        // Amount of total free space in this VA range
     ChunkList               m_chunkList;            // Chunk list to record free VA chunks
     ChunkTree               m_chunkTree;            // Chunk tree to record free VA chunks
+    ChunkBins               m_chunkBins;            // Free VA chunks indexed by size class
     bool                    m_treeEnabled;          // If chunk tree is enabled
 };
 
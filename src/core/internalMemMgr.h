@@ -27,6 +27,7 @@
 
 #include "core/gpuMemory.h"
 #include "palBuddyAllocator.h"
+#include "palList.h"
 #include "palMutex.h"
 
 namespace Pal
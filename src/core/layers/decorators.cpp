@@ -359,6 +359,46 @@ Result DeviceDecorator::RemoveGpuMemoryReferences(
     return result;
 }
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+// =====================================================================================================================
+// The next layer reports its own GPU memory objects, which are wrapped by this layer's objects.
+Result DeviceDecorator::FindGpuMemoryByVa(
+    gpusize           gpuVirtAddr,
+    GpuMemoryVaRange* pRange
+    ) const
+{
+    const Result result = m_pNextLayer->FindGpuMemoryByVa(gpuVirtAddr, pRange);
+
+    if (result == Result::Success)
+    {
+        pRange->pGpuMemory = PreviousObject(pRange->pGpuMemory);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result DeviceDecorator::FindGpuMemoryInVaRange(
+    gpusize           gpuVirtAddr,
+    gpusize           size,
+    uint32*           pRangeCount,
+    GpuMemoryVaRange* pRanges
+    ) const
+{
+    const Result result = m_pNextLayer->FindGpuMemoryInVaRange(gpuVirtAddr, size, pRangeCount, pRanges);
+
+    if ((pRanges != nullptr) && ((result == Result::Success) || (result == Result::ErrorIncompleteResults)))
+    {
+        for (uint32 i = 0; i < *pRangeCount; i++)
+        {
+            pRanges[i].pGpuMemory = PreviousObject(pRanges[i].pGpuMemory);
+        }
+    }
+
+    return result;
+}
+#endif
+
 // =====================================================================================================================
 size_t DeviceDecorator::GetQueueSize(
     const QueueCreateInfo& createInfo,
@@ -566,6 +566,30 @@ public:
         m_pNextLayer->GetReferencedMemoryTotals(&referencedGpuMemTotal[0]);
     }
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    virtual Result FindGpuMemoryByVa(
+        gpusize           gpuVirtAddr,
+        GpuMemoryVaRange* pRange) const override;
+
+    virtual Result FindGpuMemoryInVaRange(
+        gpusize           gpuVirtAddr,
+        gpusize           size,
+        uint32*           pRangeCount,
+        GpuMemoryVaRange* pRanges) const override;
+#endif
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    virtual void GetPipelineCodeSharingStats(
+        PipelineCodeSharingStats* pStats) const override
+        { m_pNextLayer->GetPipelineCodeSharingStats(pStats); }
+#endif
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    virtual void GetStateObjectInterningStats(
+        StateObjectInterningStats* pStats) const override
+        { m_pNextLayer->GetStateObjectInterningStats(pStats); }
+#endif
+
     virtual Result SetMaxQueuedFrames(
         uint32 maxFrames) override
         { return m_pNextLayer->SetMaxQueuedFrames(maxFrames); }
@@ -581,6 +605,13 @@ public:
         uint64              timeout
         ) const override;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    virtual Result SignalEventOnFenceCompletion(
+        const IFence& fence,
+        Util::Event*  pEvent) override
+        { return m_pNextLayer->SignalEventOnFenceCompletion(*NextFence(&fence), pEvent); }
+#endif
+
     virtual Result WaitForSemaphores(
         uint32                       semaphoreCount,
         const IQueueSemaphore*const* ppSemaphores,
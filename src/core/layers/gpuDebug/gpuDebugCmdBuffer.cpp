@@ -35,6 +35,7 @@
 #include "core/g_palPlatformSettings.h"
 #include "palAutoBuffer.h"
 #include "palFormatInfo.h"
+#include "palTokenStreamImpl.h"
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 648
 #include "palVectorImpl.h"
 #endif
@@ -71,10 +72,7 @@ CmdBuffer::CmdBuffer(
     m_pBoundPipeline(nullptr),
     m_boundTargets(),
     m_pBoundBlendState(nullptr),
-    m_pTokenStream(nullptr),
-    m_tokenStreamSize(m_pDevice->GetPlatform()->PlatformSettings().gpuDebugConfig.tokenAllocatorSize),
-    m_tokenWriteOffset(0),
-    m_tokenReadOffset(0),
+    m_tokenStream(pDevice->TokenPool()),
     m_tokenStreamResult(Result::Success),
     m_pLastTgtCmdBuffer(nullptr)
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 648
@@ -101,7 +99,6 @@ CmdBuffer::CmdBuffer(
 // =====================================================================================================================
 CmdBuffer::~CmdBuffer()
 {
-    PAL_FREE(m_pTokenStream, m_pDevice->GetPlatform());
 }
 
 // =====================================================================================================================
@@ -109,49 +106,20 @@ void* CmdBuffer::AllocTokenSpace(
     size_t numBytes,
     size_t alignment)
 {
-    void*        pTokenSpace        = nullptr;
-    const size_t alignedWriteOffset = Pow2Align(m_tokenWriteOffset, alignment);
-    const size_t nextWriteOffset    = alignedWriteOffset + numBytes;
+    void* pTokenSpace = nullptr;
 
-    if (nextWriteOffset > m_tokenStreamSize)
+    // Return null if we've previously encountered an error, the stream is invalid until the next Begin().
+    if (m_tokenStreamResult == Result::Success)
     {
-        // Double the size of the token stream until we have enough space.
-        size_t newStreamSize = m_tokenStreamSize * 2;
-
-        while (nextWriteOffset > newStreamSize)
-        {
-            newStreamSize *= 2;
-        }
-
-        // Allocate the new buffer and copy the current tokens over.
-        void* pNewStream = PAL_MALLOC(newStreamSize, m_pDevice->GetPlatform(), AllocInternal);
+        pTokenSpace = m_tokenStream.Alloc(numBytes, alignment);
 
-        if (pNewStream != nullptr)
-        {
-            memcpy(pNewStream, m_pTokenStream, m_tokenWriteOffset);
-            PAL_FREE(m_pTokenStream, m_pDevice->GetPlatform());
-
-            m_pTokenStream    = pNewStream;
-            m_tokenStreamSize = newStreamSize;
-        }
-        else
+        if (pTokenSpace == nullptr)
         {
             // We've run out of memory, this stream is now invalid.
             m_tokenStreamResult = Result::ErrorOutOfMemory;
         }
     }
 
-    // Return null if we've previously encountered an error or just failed to reallocate the token stream. Otherwise,
-    // return a properly aligned write pointer and update the write offset to point at the end of the allocated space.
-    if (m_tokenStreamResult == Result::Success)
-    {
-        // Malloc is required to give us memory that is aligned high enough for any variable, but let's double check.
-        PAL_ASSERT(IsPow2Aligned(reinterpret_cast<uint64>(m_pTokenStream), alignment));
-
-        pTokenSpace        = VoidPtrInc(m_pTokenStream, alignedWriteOffset);
-        m_tokenWriteOffset = nextWriteOffset;
-    }
-
     return pTokenSpace;
 }
 
@@ -304,6 +272,10 @@ Result CmdBuffer::Reset(
     m_releaseTokenList.Clear();
     m_numReleaseTokens = 0;
 #endif
+
+    // Give our token chunks back to the device so that other command buffers can record into them.
+    m_tokenStream.Reset();
+
     return GetNextLayer()->Reset(NextCmdAllocator(pCmdAllocator), returnGpuMemory);
 }
 
@@ -314,23 +286,10 @@ Result CmdBuffer::Begin(
     m_pLastTgtCmdBuffer = nullptr;
     m_counter           = 0;
 
-    // Reset the token stream state so that we can reuse our old token stream buffer.
-    m_tokenWriteOffset = 0;
-    m_tokenReadOffset = 0;
+    // Rewind the token stream so that we can reuse the chunks from our last recording.
+    m_tokenStream.Rewind();
     m_tokenStreamResult = Result::Success;
 
-    // We lazy allocate the first token stream during the first Begin() call to avoid allocating a lot of extra
-    // memory if the client creates a ton of command buffers but doesn't use them.
-    if (m_pTokenStream == nullptr)
-    {
-        m_pTokenStream = PAL_MALLOC(m_tokenStreamSize, m_pDevice->GetPlatform(), AllocInternal);
-
-        if (m_pTokenStream == nullptr)
-        {
-            m_tokenStreamResult = Result::ErrorOutOfMemory;
-        }
-    }
-
     m_buildInfo                 = info;
     m_buildInfo.pInheritedState = {};
 
@@ -3862,7 +3821,7 @@ Result CmdBuffer::Replay(
     if (m_tokenStreamResult == Result::Success)
     {
         // Start reading from the beginning of the token stream.
-        m_tokenReadOffset = 0;
+        m_tokenStream.BeginRead();
 
         CmdBufCallId     callId;
         TargetCmdBuffer* pTgtCmdBuffer = nullptr;
@@ -3881,7 +3840,7 @@ Result CmdBuffer::Replay(
             (this->*ReplayFuncTbl[static_cast<uint32>(callId)])(pQueue, pTgtCmdBuffer);
 
             result = pTgtCmdBuffer->GetLastResult();
-        } while ((m_tokenReadOffset != m_tokenWriteOffset) && (result == Result::Success));
+        } while ((m_tokenStream.IsReadDone() == false) && (result == Result::Success));
     }
 
     return result;
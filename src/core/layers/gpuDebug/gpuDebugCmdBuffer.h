@@ -32,6 +32,7 @@
 #include "core/layers/gpuDebug/gpuDebugPlatform.h"
 #include "palCmdBuffer.h"
 #include "palLinearAllocator.h"
+#include "palTokenStream.h"
 #include "palPipeline.h"
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 648
 #include "palVector.h"
@@ -612,10 +613,7 @@ private:
     template <typename T> const T& ReadTokenVal()
     {
         PAL_ASSERT(m_tokenStreamResult == Result::Success);
-        m_tokenReadOffset = Util::Pow2Align(m_tokenReadOffset, __alignof(T));
-        const T& val = *static_cast<T*>(Util::VoidPtrInc(m_pTokenStream, m_tokenReadOffset));
-        m_tokenReadOffset += sizeof(T);
-        return val;
+        return *static_cast<const T*>(m_tokenStream.Read(sizeof(T), __alignof(T)));
     }
 
     // Retrieves a pointer to the next array of value(s) in the token stream then advances the read pointer.  Returns
@@ -625,9 +623,7 @@ private:
         uint32 count = ReadTokenVal<uint32>();
         if (count != 0)
         {
-            m_tokenReadOffset = Util::Pow2Align(m_tokenReadOffset, __alignof(T));
-            *ppToken = static_cast<T*>(Util::VoidPtrInc(m_pTokenStream, m_tokenReadOffset));
-            m_tokenReadOffset += sizeof(T) * count;
+            *ppToken = static_cast<T*>(m_tokenStream.Read(sizeof(T) * count, __alignof(T)));
         }
         else
         {
@@ -778,12 +774,10 @@ private:
     BindTargetParams             m_boundTargets;
     const IColorBlendState*      m_pBoundBlendState;
 
-    // The token stream is a single block of memory that doubles in size each time it runs out of space.
-    void*            m_pTokenStream;      // Storage for tokenized commands. Rewind here on command buffer reset.
-    size_t           m_tokenStreamSize;   // The size of the token stream buffer in bytes.
-    size_t           m_tokenWriteOffset;  // Write the next token at this offset within the token stream.
-    size_t           m_tokenReadOffset;   // Read the next token at this offset within the token stream.
-    Result           m_tokenStreamResult; // This must be Success unless an error occured during AllocTokenSpace.
+    // Tokenized commands are stored in chunks from the device's token pool. Rewound on Begin().
+    Util::TokenStream<PlatformDecorator> m_tokenStream;
+    Result                               m_tokenStreamResult; // This must be Success unless an error occured during
+                                                              // AllocTokenSpace.
 
     CmdBufferBuildInfo m_buildInfo;
     TargetCmdBuffer*   m_pLastTgtCmdBuffer;
@@ -33,7 +33,9 @@
 #include "core/layers/gpuDebug/gpuDebugPipeline.h"
 #include "core/layers/gpuDebug/gpuDebugPlatform.h"
 #include "core/layers/gpuDebug/gpuDebugQueue.h"
+#include "core/g_palPlatformSettings.h"
 #include "palSysUtil.h"
+#include "palTokenStreamImpl.h"
 
 using namespace Util;
 
@@ -64,7 +66,8 @@ Device::Device(
     IDevice*           pNextDevice)
     :
     DeviceDecorator(pPlatform, pNextDevice),
-    m_pPublicSettings(nullptr)
+    m_pPublicSettings(nullptr),
+    m_tokenChunkPool(pPlatform, pPlatform->PlatformSettings().gpuDebugConfig.tokenAllocatorSize)
 {
     memset(&m_deviceProperties, 0, sizeof(m_deviceProperties));
 }
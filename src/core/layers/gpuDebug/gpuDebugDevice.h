@@ -28,6 +28,7 @@
 #if PAL_BUILD_GPU_DEBUG
 
 #include "core/layers/decorators.h"
+#include "palTokenStream.h"
 
 namespace Pal
 {
@@ -177,12 +178,17 @@ public:
     const PalPublicSettings* PublicSettings() const { return m_pPublicSettings; }
     const DeviceProperties&  DeviceProps() const { return m_deviceProperties; }
 
+    Util::TokenChunkPool<PlatformDecorator>* TokenPool() { return &m_tokenChunkPool; }
+
 private:
     virtual ~Device();
 
     const PalPublicSettings* m_pPublicSettings;
     DeviceProperties         m_deviceProperties;
 
+    // Token memory shared by all of this device's command buffers.
+    Util::TokenChunkPool<PlatformDecorator> m_tokenChunkPool;
+
     PAL_DISALLOW_DEFAULT_CTOR(Device);
     PAL_DISALLOW_COPY_AND_ASSIGN(Device);
 };
@@ -29,9 +29,8 @@
 #include "core/g_palPlatformSettings.h"
 #include "palAutoBuffer.h"
 #include "palGpaSession.h"
-#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 648
+#include "palTokenStreamImpl.h"
 #include "palVectorImpl.h"
-#endif
 
 // This is required because we need the definition of the D3D12DDI_PRESENT_0003 struct in order to make a copy of the
 // data in it for the tokenization.
@@ -55,14 +54,13 @@ CmdBuffer::CmdBuffer(
     m_pDevice(pDevice),
     m_queueType(createInfo.queueType),
     m_engineType(createInfo.engineType),
-    m_pTokenStream(nullptr),
-    m_tokenStreamSize(m_pDevice->GetPlatform()->PlatformSettings().gpuProfilerTokenAllocatorSize),
-    m_tokenWriteOffset(0),
-    m_tokenReadOffset(0),
+    m_tokenStream(pDevice->TokenPool()),
     m_tokenStreamResult(Result::Success),
     m_disableDataGathering(false),
     m_forceDrawGranularityLogging(false),
-    m_curLogFrame(0)
+    m_curLogFrame(0),
+    m_replayLogging(false),
+    m_pReplayAllocator(nullptr)
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 648
     ,
     m_numReleaseTokens(0),
@@ -100,7 +98,6 @@ CmdBuffer::CmdBuffer(
 // =====================================================================================================================
 CmdBuffer::~CmdBuffer()
 {
-    PAL_FREE(m_pTokenStream, m_pDevice->GetPlatform());
 }
 
 // =====================================================================================================================
@@ -108,49 +105,20 @@ void* CmdBuffer::AllocTokenSpace(
     size_t numBytes,
     size_t alignment)
 {
-    void*        pTokenSpace        = nullptr;
-    const size_t alignedWriteOffset = Pow2Align(m_tokenWriteOffset, alignment);
-    const size_t nextWriteOffset    = alignedWriteOffset + numBytes;
+    void* pTokenSpace = nullptr;
 
-    if (nextWriteOffset > m_tokenStreamSize)
+    // Return null if we've previously encountered an error, the stream is invalid until the next Begin().
+    if (m_tokenStreamResult == Result::Success)
     {
-        // Double the size of the token stream until we have enough space.
-        size_t newStreamSize = m_tokenStreamSize * 2;
-
-        while (nextWriteOffset > newStreamSize)
-        {
-            newStreamSize *= 2;
-        }
-
-        // Allocate the new buffer and copy the current tokens over.
-        void* pNewStream = PAL_MALLOC(newStreamSize, m_pDevice->GetPlatform(), AllocInternal);
-
-        if (pNewStream != nullptr)
-        {
-            memcpy(pNewStream, m_pTokenStream, m_tokenWriteOffset);
-            PAL_FREE(m_pTokenStream, m_pDevice->GetPlatform());
+        pTokenSpace = m_tokenStream.Alloc(numBytes, alignment);
 
-            m_pTokenStream    = pNewStream;
-            m_tokenStreamSize = newStreamSize;
-        }
-        else
+        if (pTokenSpace == nullptr)
         {
             // We've run out of memory, this stream is now invalid.
             m_tokenStreamResult = Result::ErrorOutOfMemory;
         }
     }
 
-    // Return null if we've previously encountered an error or just failed to reallocate the token stream. Otherwise,
-    // return a properly aligned write pointer and update the write offset to point at the end of the allocated space.
-    if (m_tokenStreamResult == Result::Success)
-    {
-        // Malloc is required to give us memory that is aligned high enough for any variable, but let's double check.
-        PAL_ASSERT(IsPow2Aligned(reinterpret_cast<uint64>(m_pTokenStream), alignment));
-
-        pTokenSpace        = VoidPtrInc(m_pTokenStream, alignedWriteOffset);
-        m_tokenWriteOffset = nextWriteOffset;
-    }
-
     return pTokenSpace;
 }
 
@@ -159,24 +127,12 @@ Result CmdBuffer::Begin(
     const CmdBufferBuildInfo& info)
 {
     m_flags.containsPresent = 0;
+    m_flags.serialReplay    = 0;
 
-    // Reset the token stream state so that we can reuse our old token stream buffer.
-    m_tokenWriteOffset  = 0;
-    m_tokenReadOffset   = 0;
+    // Rewind the token stream so that we can reuse the chunks from our last recording.
+    m_tokenStream.Rewind();
     m_tokenStreamResult = Result::Success;
 
-    // We lazy allocate the first token stream during the first Begin() call to avoid allocating a lot of extra
-    // memory if the client creates a ton of command buffers but doesn't use them.
-    if (m_pTokenStream == nullptr)
-    {
-        m_pTokenStream = PAL_MALLOC(m_tokenStreamSize, m_pDevice->GetPlatform(), AllocInternal);
-
-        if (m_pTokenStream == nullptr)
-        {
-            m_tokenStreamResult = Result::ErrorOutOfMemory;
-        }
-    }
-
     InsertToken(CmdBufCallId::Begin);
     InsertToken(info);
     if (info.pInheritedState != nullptr)
@@ -221,9 +177,9 @@ void CmdBuffer::ReplayBegin(
     }
     // We must remove the client's external allocator because PAL can only use it during command building from the
     // client's perspective. By batching and replaying command building later on we're breaking that rule. The good news
-    // is that we can replace it with our queue's command buffer replay allocator because replaying is thread-safe with
-    // respect to each queue.
-    info.pMemAllocator = pQueue->ReplayAllocator();
+    // is that we can replace it with a replay allocator owned by our queue: either the queue's own allocator or the
+    // allocator of the queue worker thread replaying this command buffer.
+    info.pMemAllocator = m_pReplayAllocator;
 
     pTgtCmdBuffer->Begin(NextCmdBufferBuildInfo(info));
 
@@ -231,8 +187,8 @@ void CmdBuffer::ReplayBegin(
     memset(&m_cpState,  0, sizeof(m_cpState));
     memset(&m_gfxpState, 0, sizeof(m_gfxpState));
 
-    if (m_pDevice->LoggingEnabled(GpuProfilerGranularityDraw) ||
-        m_pDevice->LoggingEnabled(GpuProfilerGranularityCmdBuf))
+    if (LoggingEnabled(GpuProfilerGranularityDraw) ||
+        LoggingEnabled(GpuProfilerGranularityCmdBuf))
     {
         memset(&m_cmdBufLogItem, 0, sizeof(m_cmdBufLogItem));
         m_cmdBufLogItem.type                   = CmdBufferCall;
@@ -248,7 +204,7 @@ void CmdBuffer::ReplayBegin(
             bool enablePerfExp   = false;
             bool enablePipeStats = false;
 
-            if (m_pDevice->LoggingEnabled(GpuProfilerGranularityCmdBuf))
+            if (LoggingEnabled(GpuProfilerGranularityCmdBuf))
             {
                 enablePerfExp    = (m_pDevice->NumGlobalPerfCounters() > 0)    ||
                                    (m_pDevice->NumStreamingPerfCounters() > 0) ||
@@ -269,7 +225,7 @@ void CmdBuffer::ReplayBegin(
     else
     {
         m_sampleFlags.sqThreadTraceActive =
-            m_pDevice->LoggingEnabled(GpuProfilerGranularity::GpuProfilerGranularityFrame);
+            LoggingEnabled(GpuProfilerGranularity::GpuProfilerGranularityFrame);
     }
 }
 
@@ -298,8 +254,8 @@ void CmdBuffer::ReplayEnd(
 {
     m_sampleFlags.sqThreadTraceActive = false;
 
-    if (m_pDevice->LoggingEnabled(GpuProfilerGranularityDraw) ||
-        m_pDevice->LoggingEnabled(GpuProfilerGranularityCmdBuf))
+    if (LoggingEnabled(GpuProfilerGranularityDraw) ||
+        LoggingEnabled(GpuProfilerGranularityCmdBuf))
     {
         if (m_flags.nested == false)
         {
@@ -332,6 +288,9 @@ Result CmdBuffer::Reset(
     m_numReleaseTokens = 0;
 #endif
 
+    // Give our token chunks back to the device so that other command buffers can record into them.
+    m_tokenStream.Reset();
+
     return NextLayer()->Reset(NextCmdAllocator(pCmdAllocator), returnGpuMemory);
 }
 
@@ -382,7 +341,7 @@ void CmdBuffer::ReplayCmdBindPipeline(
 
     pTgtCmdBuffer->CmdBindPipeline(params);
 
-    if (m_pDevice->LoggingEnabled(GpuProfilerGranularity::GpuProfilerGranularityFrame))
+    if (LoggingEnabled(GpuProfilerGranularity::GpuProfilerGranularityFrame))
     {
         GpuUtil::GpaSession* pGpaSession = pQueue->GetPerFrameGpaSession();
 
@@ -3080,6 +3039,9 @@ void CmdBuffer::CmdExecuteNestedCmdBuffers(
 {
     InsertToken(CmdBufCallId::CmdExecuteNestedCmdBuffers);
     InsertTokenArray(ppCmdBuffers, cmdBufferCount);
+
+    // Nested command buffers are replayed into queue-owned nested command buffers.
+    m_flags.serialReplay = 1;
 }
 
 // =====================================================================================================================
@@ -3090,7 +3052,7 @@ void CmdBuffer::ReplayCmdExecuteNestedCmdBuffers(
     Queue*           pQueue,
     TargetCmdBuffer* pTgtCmdBuffer)
 {
-    if (m_pDevice->LoggingEnabled(GpuProfilerGranularityDraw))
+    if (LoggingEnabled(GpuProfilerGranularityDraw))
     {
         LogItem logItem = { };
         logItem.type              = CmdBufferCall;
@@ -3117,7 +3079,7 @@ void CmdBuffer::ReplayCmdExecuteNestedCmdBuffers(
             auto*const pNestedCmdBuffer    = static_cast<CmdBuffer*>(ppCmdBuffers[i]);
             auto*const pNestedTgtCmdBuffer = pQueue->AcquireNestedCmdBuf(pTgtCmdBuffer->GetSubQueueIdx());
             tgtCmdBuffers[i]               = pNestedTgtCmdBuffer;
-            pNestedCmdBuffer->Replay(pQueue, pNestedTgtCmdBuffer, m_curLogFrame);
+            pNestedCmdBuffer->Replay(pQueue, pNestedTgtCmdBuffer, m_curLogFrame, m_replayLogging, m_pReplayAllocator);
         }
 
         pTgtCmdBuffer->CmdExecuteNestedCmdBuffers(cmdBufferCount, &tgtCmdBuffers[0]);
@@ -3498,7 +3460,7 @@ void CmdBuffer::ReplayCmdCommentString(
     const char* pComment = nullptr;
     uint32 commentLength = ReadTokenArray(&pComment);
 
-    if (m_pDevice->LoggingEnabled(GpuProfilerGranularityDraw))
+    if (LoggingEnabled(GpuProfilerGranularityDraw))
     {
         LogItem logItem = { };
         logItem.type                     = CmdBufferCall;
@@ -3562,6 +3524,7 @@ void CmdBuffer::CmdPostProcessFrame(
     InsertToken(CmdBufCallId::CmdPostProcessFrame);
     InsertToken(postProcessInfo);
     InsertToken((pAddedGpuWork != nullptr) ? *pAddedGpuWork : false);
+    m_flags.serialReplay = 1;
 
     // Pass this command on to the next layer.  Clients depend on the pAddedGpuWork output parameter.
     CmdPostProcessFrameInfo nextPostProcessInfo = {};
@@ -3630,6 +3593,9 @@ void CmdBuffer::ReplayCmdSetClipRects(
 void CmdBuffer::CmdStartGpuProfilerLogging()
 {
     InsertToken(CmdBufCallId::CmdStartGpuProfilerLogging);
+
+    // This enables logging during replay regardless of the current frame.
+    m_flags.serialReplay = 1;
 }
 
 // =====================================================================================================================
@@ -3672,13 +3638,25 @@ void CmdBuffer::ReplayCmdXdmaWaitFlipPending(
     LogPostTimedCall(pQueue, pTgtCmdBuffer, &logItem);
 }
 
+// =====================================================================================================================
+// Determines if the current replay logs at the specified granularity.  The logging state was captured by the queue when
+// the replay started; the device's own state may change at any time and must not be consulted during replay.
+bool CmdBuffer::LoggingEnabled(
+    GpuProfilerGranularity granularity
+    ) const
+{
+    return (m_replayLogging && (m_pDevice->ProfilerGranularity() == granularity));
+}
+
 // =====================================================================================================================
 // Replays the commands that were recorded on this command buffer into a separate, target command buffer while adding
 // additional commands for GPU profiling purposes.
 Result CmdBuffer::Replay(
-    Queue*           pQueue,
-    TargetCmdBuffer* pTgtCmdBuffer,
-    uint32           curFrame)
+    Queue*                        pQueue,
+    TargetCmdBuffer*              pTgtCmdBuffer,
+    uint32                        curFrame,
+    bool                          loggingEnabled,
+    Util::VirtualLinearAllocator* pReplayAllocator)
 {
     typedef void (CmdBuffer::* ReplayFunc)(Queue*, TargetCmdBuffer*);
 
@@ -3813,11 +3791,13 @@ Result CmdBuffer::Replay(
     if (m_tokenStreamResult == Result::Success)
     {
         // Start reading from the beginning of the token stream.
-        m_tokenReadOffset = 0;
+        m_tokenStream.BeginRead();
 
         CmdBufCallId callId;
 
-        m_curLogFrame = curFrame;
+        m_curLogFrame      = curFrame;
+        m_replayLogging    = loggingEnabled;
+        m_pReplayAllocator = pReplayAllocator;
 
         do
         {
@@ -3842,7 +3822,7 @@ void CmdBuffer::LogPreTimedCall(
     LogItem*          pLogItem,
     CmdBufCallId      callId)
 {
-    if (m_pDevice->LoggingEnabled(GpuProfilerGranularityDraw) || m_forceDrawGranularityLogging)
+    if (LoggingEnabled(GpuProfilerGranularityDraw) || m_forceDrawGranularityLogging)
     {
         pLogItem->type                   = CmdBufferCall;
         pLogItem->frameId                = m_curLogFrame;
@@ -3924,7 +3904,7 @@ void CmdBuffer::LogPostTimedCall(
     TargetCmdBuffer* pTgtCmdBuffer,
     LogItem*         pLogItem)
 {
-    if (m_pDevice->LoggingEnabled(GpuProfilerGranularityDraw) || m_forceDrawGranularityLogging)
+    if (LoggingEnabled(GpuProfilerGranularityDraw) || m_forceDrawGranularityLogging)
     {
         pTgtCmdBuffer->EndSample(pQueue, pLogItem);
 
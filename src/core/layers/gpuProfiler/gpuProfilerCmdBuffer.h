@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include "core/g_palPlatformSettings.h"
 #include "core/layers/functionIds.h"
 
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 648
@@ -32,6 +33,7 @@
 #endif
 #include "core/layers/gpuProfiler/gpuProfilerQueue.h"
 #include "palLinearAllocator.h"
+#include "palTokenStream.h"
 
 // Forward declarations.
 namespace GpuUtil
@@ -71,11 +73,22 @@ public:
               bool                       enableSqThreadTrace);
 
     // This function will playback the commands recorded by this command buffer into the specified target command
-    // buffer while instrumenting it with additional commands to gather timing, perf counters, etc.
-    Result Replay(Queue* pQueue, TargetCmdBuffer* pTgtCmdBuf, uint32 curFrame);
+    // buffer while instrumenting it with additional commands to gather timing, perf counters, etc.  The queue reads the
+    // device's logging state once and passes it in as loggingEnabled; the whole replay follows it even if logging is
+    // turned on or off meanwhile.
+    Result Replay(
+        Queue*                        pQueue,
+        TargetCmdBuffer*              pTgtCmdBuf,
+        uint32                        curFrame,
+        bool                          loggingEnabled,
+        Util::VirtualLinearAllocator* pReplayAllocator);
 
     bool ContainsPresent() const { return m_flags.containsPresent; }
 
+    // Returns true if this command buffer can be replayed on a queue worker thread while other command buffers from
+    // the same submit are replayed.  Only valid while no profiling data is being logged.
+    bool SupportsConcurrentReplay() const { return (m_flags.serialReplay == 0); }
+
     ICmdBuffer* NextLayer() { return GetNextLayer(); }
     const ICmdBuffer* NextLayer() const { return GetNextLayer(); }
 
@@ -616,10 +629,7 @@ private:
     template <typename T> const T& ReadTokenVal()
     {
         PAL_ASSERT(m_tokenStreamResult == Result::Success);
-        m_tokenReadOffset = Util::Pow2Align(m_tokenReadOffset, __alignof(T));
-        const T& val = *static_cast<T*>(Util::VoidPtrInc(m_pTokenStream, m_tokenReadOffset));
-        m_tokenReadOffset += sizeof(T);
-        return val;
+        return *static_cast<const T*>(m_tokenStream.Read(sizeof(T), __alignof(T)));
     }
 
     // Retrieves a pointer to the next array of value(s) in the token stream then advances the read pointer.  Returns
@@ -629,9 +639,7 @@ private:
         uint32 count = ReadTokenVal<uint32>();
         if (count != 0)
         {
-            m_tokenReadOffset = Util::Pow2Align(m_tokenReadOffset, __alignof(T));
-            *ppToken = static_cast<T*>(Util::VoidPtrInc(m_pTokenStream, m_tokenReadOffset));
-            m_tokenReadOffset += sizeof(T) * count;
+            *ppToken = static_cast<T*>(m_tokenStream.Read(sizeof(T) * count, __alignof(T)));
         }
         else
         {
@@ -642,6 +650,10 @@ private:
 
     // Helper methods for each ICmdBuffer entry point that replay the recorded tokens into the specified target
     // command buffer.
+    // Returns true if the current replay logs at the specified granularity.  Replay must use this rather than the
+    // device's live logging state.
+    bool LoggingEnabled(GpuProfilerGranularity granularity) const;
+
     void ReplayBegin(Queue* pQueue, TargetCmdBuffer* pTgtCmdBuffer);
     void ReplayEnd(Queue* pQueue, TargetCmdBuffer* pTgtCmdBuffer);
     void ReplayCmdBindPipeline(Queue* pQueue, TargetCmdBuffer* pTgtCmdBuffer);
@@ -773,12 +785,10 @@ private:
     const QueueType  m_queueType;
     const EngineType m_engineType;
 
-    // The token stream is a single block of memory that doubles in size each time it runs out of space.
-    void*            m_pTokenStream;      // Storage for tokenized commands. Rewind here on command buffer reset.
-    size_t           m_tokenStreamSize;   // The size of the token stream buffer in bytes.
-    size_t           m_tokenWriteOffset;  // Write the next token at this offset within the token stream.
-    size_t           m_tokenReadOffset;   // Read the next token at this offset within the token stream.
-    Result           m_tokenStreamResult; // This must be Success unless an error occured during AllocTokenSpace.
+    // Tokenized commands are stored in chunks from the device's token pool. Rewound on Begin().
+    Util::TokenStream<PlatformDecorator> m_tokenStream;
+    Result                               m_tokenStreamResult; // This must be Success unless an error occured during
+                                                              // AllocTokenSpace.
 
     struct
     {
@@ -786,7 +796,9 @@ private:
         uint32 enableSqThreadTrace :  1;  // Thread traces should be collected based on specified data granularity.
         uint32 containsPresent     :  1;  // A CmdPresent() call is made in this command buffer.
         uint32 nested              :  1;  // This is a nested command buffer.
-        uint32 reserved            : 28;
+        uint32 serialReplay        :  1;  // Replay needs queue-owned state (nested command buffers, forced logging,
+                                          // or frame post-processing), so it must run on the submitting thread.
+        uint32 reserved            : 27;
     } m_flags;
 
     union
@@ -818,6 +830,10 @@ private:
     bool m_forceDrawGranularityLogging;
 
     uint32 m_curLogFrame;
+    bool   m_replayLogging; // Logging state the current Replay() was started with.
+
+    // Temporary memory for the target command buffer's Begin().  Only valid during Replay().
+    Util::VirtualLinearAllocator* m_pReplayAllocator;
 
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 648
     // List of release tokens that are used to handle acquire/release interface through this layer's replay mechanism.
@@ -28,6 +28,7 @@
 #include "core/layers/gpuProfiler/gpuProfilerPipeline.h"
 #include "core/layers/gpuProfiler/gpuProfilerQueue.h"
 #include "palSysUtil.h"
+#include "palTokenStreamImpl.h"
 #include <ctype.h>
 
 using namespace Util;
@@ -51,6 +52,7 @@ Device::Device(
     :
     DeviceDecorator(pPlatform, pNextDevice),
     m_id(id),
+    m_tokenChunkPool(pPlatform, pPlatform->PlatformSettings().gpuProfilerTokenAllocatorSize),
     m_fragmentSize(0),
     m_bufferSrdDwords(0),
     m_imageSrdDwords(0),
@@ -83,6 +85,11 @@ Device::Device(
     m_sqttCsHash = ZeroShaderHash;
 }
 
+// =====================================================================================================================
+Device::~Device()
+{
+}
+
 // =====================================================================================================================
 Result Device::Cleanup()
 {
@@ -29,6 +29,7 @@
 #include "core/layers/gpuProfiler/gpuProfilerPlatform.h"
 #include "core/g_palPlatformSettings.h"
 #include "palMutex.h"
+#include "palTokenStream.h"
 
 namespace Util { class File; }
 
@@ -76,6 +77,8 @@ public:
 
     uint32 Id() const { return m_id; }
 
+    Util::TokenChunkPool<PlatformDecorator>* TokenPool() { return &m_tokenChunkPool; }
+
     gpusize FragmentSize() const { return m_fragmentSize; }
     uint32 BufferSrdDwords() const { return m_bufferSrdDwords; }
     uint32 ImageSrdDwords() const { return m_imageSrdDwords; }
@@ -96,6 +99,7 @@ public:
 
     bool LoggingEnabled() const;
     bool LoggingEnabled(GpuProfilerGranularity granularity) const;
+    GpuProfilerGranularity ProfilerGranularity() const { return m_profilerGranularity; }
 
     bool SqttEnabledForPipeline(const PipelineState& state, PipelineBindPoint bindPoint) const;
 
@@ -169,7 +173,7 @@ public:
     }
 
 private:
-    virtual ~Device() {}
+    virtual ~Device();
 
     Result InitGlobalPerfCounterState();
     Result CountPerfCounters(
@@ -188,6 +192,9 @@ private:
     const uint32 m_id;    // Unique ID for this device for reporting purposes.
     Util::Mutex  m_mutex; // A general purpose mutex for any muti-threaded non-const functions.
 
+    // Token memory shared by all of this device's command buffers.
+    Util::TokenChunkPool<PlatformDecorator> m_tokenChunkPool;
+
     // Properties captured from the core's DeviceProperties or PalPublicSettings structure.  These are cached here to
     // avoid calling the overly expensive IDevice::GetProperties() in high frequency code paths.
     gpusize                m_fragmentSize;
@@ -29,6 +29,7 @@
 #include "core/layers/gpuProfiler/gpuProfilerQueue.h"
 #include "palAutoBuffer.h"
 #include "palDequeImpl.h"
+#include "palMutex.h"
 #include "palSysUtil.h"
 
 using namespace Util;
@@ -52,6 +53,13 @@ Queue::Queue(
     m_shaderEngineCount(0),
     m_pCmdAllocator(nullptr),
     m_replayAllocator(64 * 1024),
+    m_replayWorkerCount(0),
+    m_pReplayWorkers(nullptr),
+    m_pReplayJobs(nullptr),
+    m_replayJobCount(0),
+    m_nextReplayJob(0),
+    m_replayFrame(0),
+    m_replayWorkersEnd(false),
     m_availableGpaSessions(static_cast<Platform*>(pDevice->GetPlatform())),
     m_busyGpaSessions(static_cast<Platform*>(pDevice->GetPlatform())),
     m_availPerfExpMem(static_cast<Platform*>(pDevice->GetPlatform())),
@@ -91,6 +99,23 @@ Queue::~Queue()
     m_logFile.Close();
 
     Platform* pPlatform = static_cast<Platform*>(m_pDevice->GetPlatform());
+
+    if (m_pReplayWorkers != nullptr)
+    {
+        m_replayWorkersEnd = true;
+
+        for (uint32 i = 0; i < m_replayWorkerCount; i++)
+        {
+            m_replayStart.Post();
+        }
+
+        for (uint32 i = 0; i < m_replayWorkerCount; i++)
+        {
+            m_pReplayWorkers[i].thread.Join();
+        }
+
+        PAL_SAFE_DELETE_ARRAY(m_pReplayWorkers, pPlatform);
+    }
     if (m_nextSubmitInfo.pCmdBufCount != nullptr)
     {
         PAL_SAFE_DELETE_ARRAY(m_nextSubmitInfo.pCmdBufCount, pPlatform);
@@ -239,10 +264,18 @@ Result Queue::Init(
         result = m_replayAllocator.Init();
     }
 
+    if (result == Result::Success)
+    {
+        result = InitReplayWorkers(
+            Min(pPlatform->PlatformSettings().gpuProfilerConfig.replayThreadCount, MaxReplayWorkers));
+    }
+
     if (result == Result::Success)
     {
         CmdAllocatorCreateInfo createInfo = { };
         createInfo.flags.autoMemoryReuse                      = 1;
+        // Worker threads build target command buffers from this allocator concurrently.
+        createInfo.flags.threadSafe                           = (m_replayWorkerCount > 0);
         createInfo.allocInfo[CommandDataAlloc].allocHeap      = GpuHeapGartUswc;
         createInfo.allocInfo[CommandDataAlloc].allocSize      = 2 * 1024 * 1024;
         createInfo.allocInfo[CommandDataAlloc].suballocSize   = 64 * 1024;
@@ -292,6 +325,187 @@ Result Queue::Init(
     return result;
 }
 
+// =====================================================================================================================
+// Callback for executing a replay worker thread.
+static void ReplayWorkerCallback(
+    void* pParameter)   // Opaque pointer to a ReplayWorker
+{
+    auto*const pWorker = static_cast<ReplayWorker*>(pParameter);
+    pWorker->pQueue->RunReplayWorker(pWorker);
+}
+
+// =====================================================================================================================
+// Creates the worker threads used for concurrent command buffer replay.  A worker count of zero keeps all replay on the
+// submitting thread.
+Result Queue::InitReplayWorkers(
+    uint32 workerCount)
+{
+    Result result = Result::Success;
+
+    if (workerCount > 0)
+    {
+        Platform* pPlatform = static_cast<Platform*>(m_pDevice->GetPlatform());
+
+        result = m_replayStart.Init(MaxReplayWorkers, 0);
+
+        if (result == Result::Success)
+        {
+            result = m_replayDone.Init(MaxReplayWorkers, 0);
+        }
+
+        if (result == Result::Success)
+        {
+            m_pReplayWorkers = PAL_NEW_ARRAY(ReplayWorker, workerCount, pPlatform, AllocInternal);
+
+            if (m_pReplayWorkers == nullptr)
+            {
+                result = Result::ErrorOutOfMemory;
+            }
+        }
+
+        for (uint32 i = 0; ((i < workerCount) && (result == Result::Success)); i++)
+        {
+            ReplayWorker*const pWorker = &m_pReplayWorkers[i];
+
+            pWorker->pQueue = this;
+            result = pWorker->replayAllocator.Init();
+
+            if (result == Result::Success)
+            {
+                result = pWorker->thread.Begin(&ReplayWorkerCallback, pWorker);
+            }
+
+            if (result == Result::Success)
+            {
+                m_replayWorkerCount++;
+            }
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Waits for concurrent replays until the queue is destroyed.
+void Queue::RunReplayWorker(
+    ReplayWorker* pWorker)
+{
+    while (m_replayWorkersEnd == false)
+    {
+        m_replayStart.Wait(UINT32_MAX);
+
+        if (m_replayWorkersEnd == false)
+        {
+            ReplayJobs(&pWorker->replayAllocator);
+            m_replayDone.Post();
+        }
+    }
+}
+
+// =====================================================================================================================
+// Determines if the recorded command buffers in a submit can be replayed concurrently.  Replay only touches state owned
+// by the recorded and target command buffers while nothing is being logged, so we fall back to serial replay if the
+// submit logs any profiling data or if a command buffer needs queue-owned state during replay.
+bool Queue::CanReplayConcurrently(
+    const MultiSubmitInfo& submitInfo,
+    uint32                 cmdBufferCount,
+    bool                   loggingEnabled
+    ) const
+{
+    bool canReplay = (m_replayWorkerCount > 0)  &&
+                     (cmdBufferCount > 1)       &&
+                     (loggingEnabled == false)  &&
+                     (m_pDevice->GetPlatform()->PlatformSettings().gpuProfilerConfig.breakSubmitBatches == false);
+
+    for (uint32 i = 0; (i < submitInfo.perSubQueueInfoCount) && canReplay; i++)
+    {
+        const PerSubQueueSubmitInfo& subQueueInfo = submitInfo.pPerSubQueueInfo[i];
+
+        for (uint32 j = 0; (j < subQueueInfo.cmdBufferCount) && canReplay; j++)
+        {
+            const auto*const pCmdBuffer = static_cast<const CmdBuffer*>(subQueueInfo.ppCmdBuffers[j]);
+
+            canReplay = pCmdBuffer->SupportsConcurrentReplay() && (pCmdBuffer->ContainsPresent() == false);
+
+            // Replay state lives in the recorded command buffer, so it can't be replayed twice at the same time.
+            for (uint32 k = 0; (k < j) && canReplay; k++)
+            {
+                canReplay = (subQueueInfo.ppCmdBuffers[k] != pCmdBuffer);
+            }
+
+            for (uint32 prevIdx = 0; (prevIdx < i) && canReplay; prevIdx++)
+            {
+                const PerSubQueueSubmitInfo& prevInfo = submitInfo.pPerSubQueueInfo[prevIdx];
+
+                for (uint32 k = 0; (k < prevInfo.cmdBufferCount) && canReplay; k++)
+                {
+                    canReplay = (prevInfo.ppCmdBuffers[k] != pCmdBuffer);
+                }
+            }
+        }
+    }
+
+    return canReplay;
+}
+
+// =====================================================================================================================
+// Replays jobs from the current concurrent replay until none are left.  Called by the submitting thread and by each
+// worker woken for the replay.
+void Queue::ReplayJobs(
+    VirtualLinearAllocator* pReplayAllocator)
+{
+    for (uint32 jobIdx = AtomicIncrement(&m_nextReplayJob) - 1;
+         jobIdx < m_replayJobCount;
+         jobIdx = AtomicIncrement(&m_nextReplayJob) - 1)
+    {
+        ReplayJob*const pJob = &m_pReplayJobs[jobIdx];
+
+        // Concurrent replay is only chosen for submits which log nothing.
+        pJob->result = pJob->pCmdBuffer->Replay(this, pJob->pTgtCmdBuffer, m_replayFrame, false, pReplayAllocator);
+    }
+}
+
+// =====================================================================================================================
+// Replays each job's recorded command buffer into its target command buffer using the submitting thread and the replay
+// workers.  Target command buffers were acquired in submission order, so the caller submits them unchanged.
+Result Queue::ReplayConcurrently(
+    ReplayJob* pJobs,
+    uint32     jobCount,
+    uint32     curFrame)
+{
+    m_pReplayJobs    = pJobs;
+    m_replayJobCount = jobCount;
+    m_nextReplayJob  = 0;
+    m_replayFrame    = curFrame;
+
+    // The submitting thread takes one job's worth of the work itself.
+    const uint32 wakeCount = Min(jobCount - 1, m_replayWorkerCount);
+
+    if (wakeCount > 0)
+    {
+        m_replayStart.Post(wakeCount);
+    }
+
+    ReplayJobs(&m_replayAllocator);
+
+    for (uint32 i = 0; i < wakeCount; i++)
+    {
+        m_replayDone.Wait(UINT32_MAX);
+    }
+
+    m_pReplayJobs    = nullptr;
+    m_replayJobCount = 0;
+
+    Result result = Result::Success;
+
+    for (uint32 i = 0; ((i < jobCount) && (result == Result::Success)); i++)
+    {
+        result = pJobs[i].result;
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Submits the specified command buffers to the next layer.  This same implementation is used for both command buffers
 // submitted by the application and any internal command buffers this layer needs to submit.
@@ -473,6 +687,19 @@ Result Queue::Submit(
 
     bool breakBatches = m_pDevice->GetPlatform()->PlatformSettings().gpuProfilerConfig.breakSubmitBatches;
 
+    // Independent command buffers are recorded as replay jobs and replayed concurrently just before the final submit.
+    // Another thread can turn logging on at any time (a new frame or a forced capture), so the decision is based on a
+    // single read which the concurrent replay then sticks to.
+    const uint32 replayFrame        = static_cast<Platform*>(pPlatform)->FrameId();
+    bool         replayConcurrently = CanReplayConcurrently(submitInfo, cmdBufferCount, m_pDevice->LoggingEnabled());
+    AutoBuffer<ReplayJob, 64, PlatformDecorator> replayJobs(replayConcurrently ? cmdBufferCount : 1, pPlatform);
+    uint32 replayJobCount = 0;
+
+    if (replayJobs.Capacity() < cmdBufferCount)
+    {
+        replayConcurrently = false;
+    }
+
     AutoBuffer<GpuMemoryRef, 32, PlatformDecorator> nextGpuMemoryRefs(submitInfo.gpuMemRefCount, pPlatform);
     AutoBuffer<DoppRef,      32, PlatformDecorator> nextDoppRefs(submitInfo.doppRefCount, pPlatform);
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 568
@@ -605,9 +832,23 @@ Result Queue::Submit(
                     localCmdBufIdx++;
 
                     // Replay the client-specified command buffer commands into the queue-owned command buffer.
-                    result = pRecordedCmdBuffer->Replay(this,
-                                                        pTargetCmdBuffer,
-                                                        static_cast<Platform*>(m_pDevice->GetPlatform())->FrameId());
+                    if (replayConcurrently)
+                    {
+                        replayJobs[replayJobCount].pCmdBuffer    = pRecordedCmdBuffer;
+                        replayJobs[replayJobCount].pTgtCmdBuffer = pTargetCmdBuffer;
+                        replayJobs[replayJobCount].result        = Result::Success;
+                        replayJobCount++;
+                    }
+                    else
+                    {
+                        // Serial replays read the logging state right before replaying, as a present earlier in
+                        // this submit may have moved on to the next frame.
+                        result = pRecordedCmdBuffer->Replay(this,
+                                                            pTargetCmdBuffer,
+                                                            static_cast<Platform*>(pPlatform)->FrameId(),
+                                                            m_pDevice->LoggingEnabled(),
+                                                            &m_replayAllocator);
+                    }
 
                     nextPerSubQueueInfosBreakBatch[subQueueIdx].cmdBufferCount = needPresent ? 2 : 1;
                     nextPerSubQueueInfosBreakBatch[subQueueIdx].ppCmdBuffers = &nextCmdBuffers[
@@ -680,6 +921,11 @@ Result Queue::Submit(
             nextPerSubQueueInfosBreakBatch[subQueueIdx].pCmdBufInfoList = nullptr;
         } // end of traversing each perSubQueueInfo
 
+        if ((result == Result::Success) && replayConcurrently)
+        {
+            result = ReplayConcurrently(&replayJobs[0], replayJobCount, replayFrame);
+        }
+
         if ((result == Result::Success) && (breakBatches == false))
         {
             // Make sure we didn't overflow the next arrays.
@@ -31,6 +31,8 @@
 #include "palFile.h"
 #include "palGpaSession.h"
 #include "palLinearAllocator.h"
+#include "palSemaphore.h"
+#include "palThread.h"
 
 namespace Pal
 {
@@ -40,6 +42,7 @@ namespace GpuProfiler
 class CmdBuffer;
 class Device;
 class Platform;
+class Queue;
 class TargetCmdBuffer;
 
 static constexpr size_t MaxCommentLength = 512;
@@ -176,6 +179,29 @@ struct SubQueueInfo
 typedef Util::Deque<TargetCmdBuffer*, Platform> CmdBufDeque;
 typedef Util::Deque<NestedInfo, Platform> NestedCmdBufDeque;
 
+// Upper limit on the number of replay worker threads each queue will create.
+constexpr uint32 MaxReplayWorkers = 16;
+
+// A recorded command buffer which is replayed into its already acquired target command buffer by any thread taking
+// part in a concurrent replay.
+struct ReplayJob
+{
+    CmdBuffer*       pCmdBuffer;
+    TargetCmdBuffer* pTgtCmdBuffer;
+    Result           result;
+};
+
+// A queue-owned worker thread used for concurrent command buffer replay.  Each worker needs its own replay allocator
+// because the queue's allocator is not thread-safe.
+struct ReplayWorker
+{
+    ReplayWorker() : pQueue(nullptr), replayAllocator(64 * 1024) { }
+
+    Queue*                       pQueue;
+    Util::Thread                 thread;
+    Util::VirtualLinearAllocator replayAllocator;
+};
+
 // =====================================================================================================================
 // GpuProfiler implementation of the IQueue interface.  Resposible for generating instrumented versions of the
 // recorded ICmdBuffer objects the client submits and gathering/reporting performance data.
@@ -197,8 +223,6 @@ public:
 
     void AddLogItem(const LogItem& logItem);
 
-    Util::VirtualLinearAllocator* ReplayAllocator() { return &m_replayAllocator; }
-
     // Public IQueue interface methods:
     virtual Result Submit(
         const MultiSubmitInfo& submitInfo) override;
@@ -234,12 +258,19 @@ public:
     // Check if the logItem contains a valid GPA sample.
     bool HasValidGpaSample(const LogItem* pLogItem, GpuUtil::GpaSampleType type) const;
 
+    void RunReplayWorker(ReplayWorker* pWorker);
+
 private:
     virtual ~Queue();
 
     IFence* AcquireFence();
     void ProcessIdleSubmits();
 
+    Result InitReplayWorkers(uint32 workerCount);
+    bool CanReplayConcurrently(const MultiSubmitInfo& submitInfo, uint32 cmdBufferCount, bool loggingEnabled) const;
+    void ReplayJobs(Util::VirtualLinearAllocator* pReplayAllocator);
+    Result ReplayConcurrently(ReplayJob* pJobs, uint32 jobCount, uint32 curFrame);
+
     Result InternalSubmit(
         const MultiSubmitInfo& submitInfo,
         bool                   releaseObjects);
@@ -282,6 +313,19 @@ private:
 
     Util::VirtualLinearAllocator m_replayAllocator; // Used to allocate temporary memory during command buffer replay.
 
+    // Worker threads which replay independent command buffers from a single submit concurrently.  Each concurrent
+    // replay hands out m_pReplayJobs through m_nextReplayJob; the submitting thread takes part and then waits for every
+    // worker it woke to post m_replayDone.
+    uint32            m_replayWorkerCount;
+    ReplayWorker*     m_pReplayWorkers;
+    Util::Semaphore   m_replayStart;
+    Util::Semaphore   m_replayDone;
+    ReplayJob*        m_pReplayJobs;
+    uint32            m_replayJobCount;
+    volatile uint32   m_nextReplayJob;
+    uint32            m_replayFrame;
+    volatile bool     m_replayWorkersEnd;
+
     // Each replayed nested command buffer needs its own allocator which will be created from this create info.
     CmdAllocatorCreateInfo m_nestedAllocatorCreateInfo;
 
@@ -25,6 +25,7 @@
 
 #include "core/g_palSettings.h"
 #include "core/os/amdgpu/amdgpuDevice.h"
+#include "core/os/amdgpu/amdgpuFenceNotifier.h"
 #include "core/os/amdgpu/amdgpuImage.h"
 #include "core/os/amdgpu/amdgpuQueue.h"
 #include "core/os/amdgpu/amdgpuSwapChain.h"
@@ -417,6 +418,7 @@ Device::Device(
     m_useDedicatedVmid(false),
     m_pSettingsPath(constructorParams.pSettingsPath),
     m_pSvmMgr(nullptr),
+    m_pFenceNotifier(nullptr),
     m_mapAllocator(),
     m_reservedVaMap(32, &m_mapAllocator),
     m_globalRefMap(MemoryRefMapElements, constructorParams.pPlatform),
@@ -489,6 +491,9 @@ Result Device::Cleanup()
 {
     Result result = Result::Success;
 
+    // The notifier thread waits on sync objects owned by this device so it must be torn down first.
+    PAL_SAFE_DELETE(m_pFenceNotifier, m_pPlatform);
+
     if (GetSvmMgr() != nullptr)
     {
         result = GetSvmMgr()->Cleanup();
@@ -2841,7 +2846,7 @@ Result Device::QueryFenceStatus(
 }
 
 // =====================================================================================================================
-// Call amdgpu to wait for multiple fences
+// Call amdgpu to wait for multiple fences. When waitAll is false this returns as soon as any fence has retired.
 Result Device::WaitForFences(
     amdgpu_cs_fence* pFences,
     uint32           fenceCount,
@@ -2865,26 +2870,80 @@ Result Device::WaitForFences(
     }
     else
     {
-        for(;index < fenceCount; index++)
+        // Without the multi-fence wait each fence must be queried on its own. Use one absolute deadline for the whole
+        // set so the caller's timeout bounds the entire wait rather than applying to every fence in turn.
+        const int64 absTimeout = ComputeAbsTimeout(timeout);
+
+        if (waitAll)
         {
-             result = CheckResult(m_drmProcs.pfnAmdgpuCsQueryFenceStatus(&(pFences[index]), timeout, 0, &status),
-                                  Result::ErrorInvalidValue);
+            for (; (result == Result::Success) && (index < fenceCount); index++)
+            {
+                result = CheckResult(m_drmProcs.pfnAmdgpuCsQueryFenceStatus(&pFences[index],
+                                                                            absTimeout,
+                                                                            AMDGPU_QUERY_FENCE_TIMEOUT_IS_ABSOLUTE,
+                                                                            &status),
+                                     Result::ErrorInvalidValue);
 
-             if (result != Result::Success)
-             {
-                 break;
-             }
-             else
-             {
-                 PAL_ASSERT((status == 0) || (status == 1));
-                 result = (status == 0) ? Result::Timeout : Result::Success;
-                 if (result != Result::Success)
-                 {
-                     break;
-                 }
-             }
+                if (result == Result::Success)
+                {
+                    PAL_ASSERT((status == 0) || (status == 1));
+                    result = (status == 0) ? Result::Timeout : Result::Success;
+                }
+            }
+        }
+        else
+        {
+            // The set can't be multiplexed in this case, so sweep it without blocking and return as soon as any fence
+            // has retired. Between sweeps, block on the first fence for a short slice until the deadline passes.
+            //
+            // The slices are a deliberate compromise. Without amdgpu_cs_wait_fences() the kernel offers no way to
+            // block on more than one of these fences, so blocking on the first fence until the deadline would miss
+            // any other fence which retires first, and sweeping without blocking would spin a CPU core. The slice
+            // length bounds how late a retirement of fences 1..N is noticed, at the cost of about one wakeup per
+            // millisecond for the duration of the wait. Only kernels and libdrm builds old enough to lack the
+            // multi-fence wait reach this path; sync object fences never do.
+            constexpr int64 SweepSliceNs = 1000000;
+
+            bool expired = false;
+            result = Result::Timeout;
+
+            while ((result == Result::Timeout) && (expired == false))
+            {
+                for (index = 0; (result == Result::Timeout) && (index < fenceCount); index++)
+                {
+                    result = CheckResult(m_drmProcs.pfnAmdgpuCsQueryFenceStatus(&pFences[index], 0, 0, &status),
+                                         Result::ErrorInvalidValue);
+
+                    if ((result == Result::Success) && (status == 0))
+                    {
+                        result = Result::Timeout;
+                    }
+                }
+
+                if (result == Result::Timeout)
+                {
+                    const int64 now = ComputeAbsTimeout(0);
+                    expired = (now >= absTimeout);
+
+                    if (expired == false)
+                    {
+                        result = CheckResult(
+                            m_drmProcs.pfnAmdgpuCsQueryFenceStatus(&pFences[0],
+                                                                   Min(absTimeout, now + SweepSliceNs),
+                                                                   AMDGPU_QUERY_FENCE_TIMEOUT_IS_ABSOLUTE,
+                                                                   &status),
+                            Result::ErrorInvalidValue);
+
+                        if ((result == Result::Success) && (status == 0))
+                        {
+                            result = Result::Timeout;
+                        }
+                    }
+                }
+            }
         }
     }
+
     return result;
 }
 
@@ -2981,6 +3040,59 @@ Result Device::WaitForSyncobjFences(
     return result;
 }
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+// =====================================================================================================================
+// Arranges for pEvent to be set once the given fence's current submission has completed. All such requests on this
+// device share one background thread which multiplexes them into a single kernel wait.
+// NOTE: Part of the public IDevice interface.
+Result Device::SignalEventOnFenceCompletion(
+    const IFence& fence,
+    Util::Event*  pEvent)
+{
+    Result result = Result::Success;
+
+    if (GetFenceType() != FenceType::SyncObj)
+    {
+        result = Result::Unsupported;
+    }
+    else if (pEvent == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else
+    {
+        MutexAuto lock(&m_fenceNotifierLock);
+
+        if (m_pFenceNotifier == nullptr)
+        {
+            m_pFenceNotifier = PAL_NEW(FenceNotifier, GetPlatform(), Util::SystemAllocType::AllocInternal)(this);
+
+            if (m_pFenceNotifier == nullptr)
+            {
+                result = Result::ErrorOutOfMemory;
+            }
+            else
+            {
+                result = m_pFenceNotifier->Init();
+
+                if (result != Result::Success)
+                {
+                    PAL_SAFE_DELETE(m_pFenceNotifier, m_pPlatform);
+                }
+            }
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        const SyncobjFence& syncobjFence = static_cast<const SyncobjFence&>(fence);
+        result = m_pFenceNotifier->SignalEventOnCompletion(syncobjFence.SyncObjHandle(), pEvent);
+    }
+
+    return result;
+}
+#endif
+
 // =====================================================================================================================
 // Call amdgpu to reset syncobj fences
 Result Device::ResetSyncObject(
@@ -3061,6 +3173,45 @@ Result Device::DestroyResourceList(
     return result;
 }
 
+// =====================================================================================================================
+// Replaces the contents of an existing bo list in place, or creates a new list if there is none yet. Updating the list
+// costs a single ioctl and keeps the kernel handle stable, where recreating it costs a destroy and a create.
+Result Device::UpdateResourceList(
+    uint32                 numberOfResources,
+    amdgpu_bo_handle*      pResources,
+    uint8*                 pResourcePriorities,
+    amdgpu_bo_list_handle* pListHandle
+    ) const
+{
+    Result result = Result::Success;
+
+    if ((*pListHandle != nullptr) && m_drmProcs.pfnAmdgpuBoListUpdateisValid())
+    {
+        if (m_drmProcs.pfnAmdgpuBoListUpdate(*pListHandle, numberOfResources, pResources, pResourcePriorities) != 0)
+        {
+            // The old contents are stale now, so don't let the caller submit with them.
+            DestroyResourceList(*pListHandle);
+            *pListHandle = nullptr;
+            result       = Result::ErrorOutOfGpuMemory;
+        }
+    }
+    else
+    {
+        if (*pListHandle != nullptr)
+        {
+            result       = DestroyResourceList(*pListHandle);
+            *pListHandle = nullptr;
+        }
+
+        if (result == Result::Success)
+        {
+            result = CreateResourceList(numberOfResources, pResources, pResourcePriorities, pListHandle);
+        }
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 static uint32 AmdGpuToPalPipeConfigConversion(
     AMDGPU_PIPE_CFG pipeConfig)
@@ -4100,15 +4251,18 @@ Result Device::RemoveGpuMemoryReferences(
 }
 
 // =====================================================================================================================
-// Set dirty for global memory reference list to all its queues
-void Device::DirtyGlobalReferences()
+// Tells all queues that the given allocation must now be added to or left out of their resource lists. Passing a null
+// allocation makes the queues rebuild their lists from scratch.
+void Device::DirtyGlobalReferences(
+    IGpuMemory* pGpuMemory,
+    bool        isResident)
 {
     MutexAuto lock(&m_queueLock);
 
     for (auto iter = m_queues.Begin(); iter.IsValid(); iter.Next())
     {
         Queue*const pLinuxQueue = static_cast<Queue*>(iter.Get());
-        pLinuxQueue->DirtyGlobalReferences();
+        pLinuxQueue->DirtyGlobalReferences(pGpuMemory, isResident);
     }
 }
 
@@ -41,6 +41,7 @@ namespace Pal
 namespace Amdgpu
 {
 class  VamMgr;
+class  FenceNotifier;
 class  Image;
 class  WindowSystem;
 struct HdrOutputMetadata;
@@ -562,6 +563,12 @@ public:
     Result DestroyResourceList(
         amdgpu_bo_list_handle handle) const;
 
+    Result UpdateResourceList(
+        uint32                 numberOfResources,
+        amdgpu_bo_handle*      pResources,
+        uint8*                 pResourcePriorities,
+        amdgpu_bo_list_handle* pListHandle) const;
+
     Result CreateSyncObject(
         uint32                    flags,
         amdgpu_syncobj_handle*    pSyncObject) const;
@@ -586,6 +593,13 @@ public:
         amdgpu_syncobj_handle*   pSyncObject,
         uint32                   numSyncObject) const;
 
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+    // NOTE: Part of the public IDevice interface.  Only supported for sync object based fences.
+    virtual Result SignalEventOnFenceCompletion(
+        const IFence& fence,
+        Util::Event*  pEvent) override;
+#endif
+
     Result CreateSemaphore(
         bool                     isCreatedSignaled,
         bool                     isCreatedTimeline,
@@ -751,7 +765,9 @@ public:
         uint32             connectorId,
         HdrOutputMetadata* pHdrMetaData) const;
 
-    void DirtyGlobalReferences();
+    void DirtyGlobalReferences(
+        IGpuMemory* pGpuMemory,
+        bool        isResident);
 
     // NOTE: There are no API level residency functions on the queue and so references are added/removed by the device.
     //       Only submit-level residency model is supported so we need to populate the device global list to the queue.
@@ -924,6 +940,9 @@ private:
 
     SvmMgr* m_pSvmMgr;
 
+    FenceNotifier* m_pFenceNotifier;     // Lazily created by SignalEventOnFenceCompletion.
+    Util::Mutex    m_fenceNotifierLock;  // Protects creation of m_pFenceNotifier.
+
     struct ReservedVaRangeInfo
     {
         gpusize size;
@@ -0,0 +1,229 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2015-2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "core/os/amdgpu/amdgpuDevice.h"
+#include "core/os/amdgpu/amdgpuFenceNotifier.h"
+#include "palAutoBuffer.h"
+#include "palSysUtil.h"
+#include "palVectorImpl.h"
+
+using namespace Util;
+
+namespace Pal
+{
+namespace Amdgpu
+{
+
+// =====================================================================================================================
+FenceNotifier::FenceNotifier(
+    Device* pDevice)
+    :
+    m_pDevice(pDevice),
+    m_hWakeSyncObj(0),
+    m_pendingWatches(pDevice->GetPlatform()),
+    m_activeWatches(pDevice->GetPlatform()),
+    m_terminate(false)
+{
+}
+
+// =====================================================================================================================
+FenceNotifier::~FenceNotifier()
+{
+    if (m_workerThread.IsCreated())
+    {
+        m_terminate = true;
+
+        const Result result = m_pDevice->SignalSyncObject(&m_hWakeSyncObj, 1);
+        PAL_ASSERT(result == Result::Success);
+
+        m_workerThread.Join();
+    }
+
+    // Any watches left at this point belong to fences which never signaled; their events are simply never set.
+    for (uint32 idx = 0; idx < m_pendingWatches.NumElements(); ++idx)
+    {
+        m_pDevice->DestroySyncObject(m_pendingWatches[idx].hSyncObj);
+    }
+
+    for (uint32 idx = 0; idx < m_activeWatches.NumElements(); ++idx)
+    {
+        m_pDevice->DestroySyncObject(m_activeWatches[idx].hSyncObj);
+    }
+
+    if (m_hWakeSyncObj != 0)
+    {
+        m_pDevice->DestroySyncObject(m_hWakeSyncObj);
+        m_hWakeSyncObj = 0;
+    }
+}
+
+// =====================================================================================================================
+static void FenceNotifierThreadCallback(
+    void* pParameter)   // Opaque pointer to a FenceNotifier object
+{
+    static_cast<FenceNotifier*>(pParameter)->RunWorkerThread();
+}
+
+// =====================================================================================================================
+Result FenceNotifier::Init()
+{
+    Result result = m_pDevice->CreateSyncObject(0, &m_hWakeSyncObj);
+
+    if (result == Result::Success)
+    {
+        result = m_workerThread.Begin(&FenceNotifierThreadCallback, this);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Copies the payload currently held by hSyncObj into a private sync object so the client is free to reset, reuse or
+// destroy its fence while we're still watching, then kicks the worker thread so it starts waiting on the new payload.
+Result FenceNotifier::SignalEventOnCompletion(
+    amdgpu_syncobj_handle hSyncObj,
+    Util::Event*          pEvent)
+{
+    PAL_ASSERT(pEvent != nullptr);
+
+    Watch  watch  = { 0, pEvent };
+    Result result = m_pDevice->CreateSyncObject(0, &watch.hSyncObj);
+
+    if (result == Result::Success)
+    {
+        result = m_pDevice->ConveySyncObjectState(watch.hSyncObj, 0, hSyncObj, 0);
+
+        if (result == Result::Success)
+        {
+            MutexAuto lock(&m_pendingLock);
+            result = m_pendingWatches.PushBack(watch);
+        }
+
+        if (result == Result::Success)
+        {
+            result = m_pDevice->SignalSyncObject(&m_hWakeSyncObj, 1);
+        }
+        else
+        {
+            m_pDevice->DestroySyncObject(watch.hSyncObj);
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Moves every newly registered watch into the worker thread's private list.
+void FenceNotifier::DrainPendingWatches()
+{
+    MutexAuto lock(&m_pendingLock);
+
+    Result result = Result::Success;
+
+    while ((result == Result::Success) && (m_pendingWatches.IsEmpty() == false))
+    {
+        result = m_activeWatches.PushBack(m_pendingWatches.Back());
+
+        if (result == Result::Success)
+        {
+            Watch watch = {};
+            m_pendingWatches.PopBack(&watch);
+        }
+    }
+}
+
+// =====================================================================================================================
+// Sets the events of all watched payloads which have signaled and stops watching them.
+void FenceNotifier::RetireSignaledWatches()
+{
+    for (uint32 idx = m_activeWatches.NumElements(); idx > 0; --idx)
+    {
+        Watch&  watch         = m_activeWatches[idx - 1];
+        uint32  firstSignaled = UINT32_MAX;
+        const Result result   = m_pDevice->WaitForSyncobjFences(&watch.hSyncObj, 1, 0, 0, &firstSignaled);
+
+        if (result == Result::Success)
+        {
+            watch.pEvent->Set();
+            m_pDevice->DestroySyncObject(watch.hSyncObj);
+
+            // Order doesn't matter so fill the hole with the last watch.
+            Watch last = {};
+            m_activeWatches.PopBack(&last);
+
+            if (idx - 1 < m_activeWatches.NumElements())
+            {
+                m_activeWatches[idx - 1] = last;
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+// Executes the background thread which blocks until any watched payload (or the wake sync object) signals.
+void FenceNotifier::RunWorkerThread()
+{
+    while (m_terminate == false)
+    {
+        DrainPendingWatches();
+
+        const uint32 handleCount = m_activeWatches.NumElements() + 1;
+        AutoBuffer<amdgpu_syncobj_handle, 16, Platform> handles(handleCount, m_pDevice->GetPlatform());
+
+        if (handles.Capacity() >= handleCount)
+        {
+            handles[0] = m_hWakeSyncObj;
+
+            for (uint32 idx = 1; idx < handleCount; ++idx)
+            {
+                handles[idx] = m_activeWatches[idx - 1].hSyncObj;
+            }
+
+            // The wake sync object has no payload until someone signals it so we must wait for submit as well.
+            uint32       firstSignaled = UINT32_MAX;
+            const Result result        = m_pDevice->WaitForSyncobjFences(&handles[0],
+                                                                          handleCount,
+                                                                          INT64_MAX,
+                                                                          DRM_SYNCOBJ_WAIT_FLAGS_WAIT_FOR_SUBMIT,
+                                                                          &firstSignaled);
+            PAL_ALERT(IsErrorResult(result));
+        }
+        else
+        {
+            // We're out of memory for the wait list, which is the only way to get here. Back off briefly and try again
+            // rather than spinning; the normal path above never sleeps.
+            SleepMs(1);
+        }
+
+        // Rearm the wake sync object before retiring so a registration which races with us is never lost; it will be
+        // picked up by the drain at the top of the loop.
+        m_pDevice->ResetSyncObject(&m_hWakeSyncObj, 1);
+
+        RetireSignaledWatches();
+    }
+}
+
+} // Amdgpu
+} // Pal
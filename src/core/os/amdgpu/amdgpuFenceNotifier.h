@@ -0,0 +1,87 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2015-2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "core/os/amdgpu/amdgpuHeaders.h"
+#include "palEvent.h"
+#include "palMutex.h"
+#include "palThread.h"
+#include "palVector.h"
+
+namespace Pal
+{
+
+class Platform;
+
+namespace Amdgpu
+{
+
+class Device;
+
+// =====================================================================================================================
+// Watches any number of sync object payloads on a single background thread and sets a client Util::Event once each one
+// has signaled. The thread blocks in one wait-any kernel call over every watched payload plus a private "wake" sync
+// object which is signaled whenever a new watch is registered, so it never polls.
+class FenceNotifier
+{
+public:
+    explicit FenceNotifier(Device* pDevice);
+    ~FenceNotifier();
+
+    Result Init();
+
+    // Snapshots the payload currently held by the given sync object and sets pEvent once that payload signals.
+    Result SignalEventOnCompletion(amdgpu_syncobj_handle hSyncObj, Util::Event* pEvent);
+
+    // Must be declared public but meant for internal use only.
+    void RunWorkerThread();
+
+private:
+    struct Watch
+    {
+        amdgpu_syncobj_handle hSyncObj; // Private copy of the client's payload, owned by the notifier.
+        Util::Event*          pEvent;   // Set once hSyncObj signals.
+    };
+
+    typedef Util::Vector<Watch, 16, Platform> WatchList;
+
+    void DrainPendingWatches();
+    void RetireSignaledWatches();
+
+    Device*const          m_pDevice;
+    amdgpu_syncobj_handle m_hWakeSyncObj;   // Signaled to kick the worker thread out of its kernel wait.
+    WatchList             m_pendingWatches; // Registered by client threads but not yet seen by the worker thread.
+    Util::Mutex           m_pendingLock;    // Protects m_pendingWatches.
+    WatchList             m_activeWatches;  // Only touched by the worker thread.
+    Util::Thread          m_workerThread;
+    volatile bool         m_terminate;      // Tells the worker thread to exit once it wakes up.
+
+    PAL_DISALLOW_DEFAULT_CTOR(FenceNotifier);
+    PAL_DISALLOW_COPY_AND_ASSIGN(FenceNotifier);
+};
+
+} // Amdgpu
+} // Pal
@@ -665,7 +665,8 @@ void Image::SetIdle(
 
         auto*const pAmdgpuDevice = static_cast<Amdgpu::Device*>(m_pDevice);
 
-        pAmdgpuDevice->DirtyGlobalReferences();
+        // Only the resource list entry of our own allocation is affected, so let the queues patch just that one.
+        pAmdgpuDevice->DirtyGlobalReferences(GetBoundGpuMemory().Memory(), idle);
     }
 }
 
@@ -198,7 +198,11 @@ Queue::Queue(
     m_perfCtrWaRequired(false),
     m_numIbs(0),
     m_lastSignaledSyncObject(0),
-    m_waitSemList(pDevice->GetPlatform())
+    m_waitSemList(pDevice->GetPlatform()),
+    m_globalRefIndexMap(static_cast<Device*>(m_pDevice)->IsVmAlwaysValidSupported() ? MemoryRefMapElementsPerVmBo :
+                        MemoryRefMapElements, m_pDevice->GetPlatform()),
+    m_globalRefsInList(pDevice->GetPlatform()),
+    m_globalRefChanges(pDevice->GetPlatform())
 {
     memset(m_ibs, 0, sizeof(m_ibs));
 }
@@ -254,6 +258,11 @@ Result Queue::Init(
         result = m_globalRefMap.Init();
     }
 
+    if (result == Result::Success)
+    {
+        result = m_globalRefIndexMap.Init();
+    }
+
     if (result == Result::Success)
     {
         result = m_globalRefLock.Init();
@@ -353,8 +362,8 @@ Result Queue::AddGpuMemoryReferences(
             else
             {
                 // Initialize the new value with one reference.
-                *pRefCount       = 1;
-                m_globalRefDirty = true;
+                *pRefCount = 1;
+                RecordGlobalRefChange(pGpuMemory, true);
             }
         }
     }
@@ -383,7 +392,7 @@ void Queue::RemoveGpuMemoryReferences(
             if ((*pRefCount == 0) || forceRemove)
             {
                 m_globalRefMap.Erase(ppGpuMemory[idx]);
-                m_globalRefDirty = true;
+                RecordGlobalRefChange(ppGpuMemory[idx], false);
             }
         }
     }
@@ -1126,11 +1135,13 @@ Result Queue::UpdateResourceList(
     // if the allocation is always resident, Pal doesn't need to build up the allocation list.
     if (m_pDevice->Settings().alwaysResident == false)
     {
-        // Serialize access to internalMgr and queue memory list
-        RWLockAuto<RWLock::ReadOnly> lockMgr(pMemMgr->GetRefListLock());
-        RWLockAuto<RWLock::ReadOnly> lock(&m_globalRefLock);
+        // Serialize access to internalMgr and queue memory list. Updating the resource list consumes
+        // m_globalRefChanges and rewrites the index maps, so the queue's lock must be held for writing.
+        RWLockAuto<RWLock::ReadOnly>  lockMgr(pMemMgr->GetRefListLock());
+        RWLockAuto<RWLock::ReadWrite> lock(&m_globalRefLock);
 
         const bool reuseResourceList = (m_globalRefDirty == false)                               &&
+                                       m_globalRefChanges.IsEmpty()                              &&
                                        (memRefCount == 0)                                        &&
                                        (m_appMemRefCount == 0)                                   &&
                                        (m_hResourceList != nullptr)                              &&
@@ -1138,46 +1149,44 @@ Result Queue::UpdateResourceList(
 
         if (reuseResourceList == false)
         {
-            // Reset the list
-            m_numResourcesInList = 0;
-            if (m_hResourceList != nullptr)
+            // First add all of the global memory references.
+            if (m_globalRefDirty == false)
             {
-                result = static_cast<Device*>(m_pDevice)->DestroyResourceList(m_hResourceList);
-                m_hResourceList = nullptr;
-            }
+                // The global memory references in our UMD-side list (m_pResourceList) are still valid up to the
+                // changes made since the last submit, so patch those in rather than re-walking m_globalRefMap.
+                m_numResourcesInList = m_memListResourcesInList;
 
-            // First add all of the global memory references.
-            if (result == Result::Success)
+                result = ApplyGlobalRefChanges();
+            }
+            else
             {
-                // If the global memory references haven't been modified since the last submit,
-                // the resources in our UMD-side list (m_pResourceList) should be up to date.
-                // So, there is no need to re-walk through m_memList.
-                if (m_globalRefDirty == false)
-                {
-                    m_numResourcesInList += m_memListResourcesInList;
-                }
-                else
+                m_numResourcesInList = 0;
+                m_globalRefDirty     = false;
+                m_globalRefIndexMap.Reset();
+                m_globalRefsInList.Clear();
+                m_globalRefChanges.Clear();
+
+                for (auto iter = m_globalRefMap.Begin(); iter.Get() != nullptr; iter.Next())
                 {
-                    m_globalRefDirty = false;
+                    result = AppendGlobalResourceToList(iter.Get()->key);
 
-                    for (auto iter = m_globalRefMap.Begin(); iter.Get() != nullptr; iter.Next())
+                    if (result != Result::_Success)
                     {
-                        const auto*const pGpuMemory = static_cast<const GpuMemory*>(iter.Get()->key);
-
-                        result = AppendResourceToList(pGpuMemory);
-
-                        if (result != Result::_Success)
-                        {
-                            // We didn't rebuild the whole list so keep it marked as dirty.
-                            m_globalRefDirty = true;
-                            break;
-                        }
+                        break;
                     }
-
-                    m_memListResourcesInList = m_numResourcesInList;
                 }
             }
 
+            if (result == Result::Success)
+            {
+                m_memListResourcesInList = m_numResourcesInList;
+            }
+            else
+            {
+                // We didn't bring the whole list up to date so rebuild it from scratch next time.
+                m_globalRefDirty = true;
+            }
+
             // Finally, add all of the application's submission memory references.
             if (result == Result::Success)
             {
@@ -1188,12 +1197,21 @@ Result Queue::UpdateResourceList(
                 }
             }
 
-            if ((result == Result::Success) && (m_numResourcesInList > 0))
+            if (result == Result::Success)
             {
-                result = static_cast<Device*>(m_pDevice)->CreateResourceList(m_numResourcesInList,
-                                                                             m_pResourceList,
-                                                                             m_pResourcePriorityList,
-                                                                             &m_hResourceList);
+                if (m_numResourcesInList > 0)
+                {
+                    // Replace the contents of the kernel list in place when we already have one.
+                    result = static_cast<Device*>(m_pDevice)->UpdateResourceList(m_numResourcesInList,
+                                                                                 m_pResourceList,
+                                                                                 m_pResourcePriorityList,
+                                                                                 &m_hResourceList);
+                }
+                else if (m_hResourceList != nullptr)
+                {
+                    result = static_cast<Device*>(m_pDevice)->DestroyResourceList(m_hResourceList);
+                    m_hResourceList = nullptr;
+                }
             }
         }
     }
@@ -1244,6 +1262,120 @@ Result Queue::AppendResourceToList(
     return result;
 }
 
+// =====================================================================================================================
+// Appends a global memory reference to the resource list and remembers where it went so that it can be removed again
+// without rebuilding the list.
+Result Queue::AppendGlobalResourceToList(
+    IGpuMemory* pGpuMemory)
+{
+    const size_t index  = m_numResourcesInList;
+    Result       result = AppendResourceToList(static_cast<const GpuMemory*>(pGpuMemory));
+
+    // AppendResourceToList skips allocations which don't belong in the list; only track the ones it added.
+    if ((result == Result::Success) && (m_numResourcesInList > index))
+    {
+        PAL_ASSERT(m_globalRefsInList.NumElements() == index);
+
+        result = m_globalRefIndexMap.Insert(pGpuMemory, static_cast<uint32>(index));
+
+        if (result == Result::Success)
+        {
+            result = m_globalRefsInList.PushBack(pGpuMemory);
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Removes the global memory reference at the given index of the resource list by moving the last global memory
+// reference into its slot. The caller must have erased the removed reference from m_globalRefIndexMap already.
+void Queue::RemoveGlobalResourceFromList(
+    uint32 index)
+{
+    PAL_ASSERT(m_numResourcesInList == m_globalRefsInList.NumElements());
+
+    const uint32 lastIndex = static_cast<uint32>(m_numResourcesInList - 1);
+    IGpuMemory*  pLast     = nullptr;
+
+    m_globalRefsInList.PopBack(&pLast);
+
+    if (index != lastIndex)
+    {
+        m_pResourceList[index] = m_pResourceList[lastIndex];
+
+        if (m_pResourcePriorityList != nullptr)
+        {
+            m_pResourcePriorityList[index] = m_pResourcePriorityList[lastIndex];
+        }
+
+        m_globalRefsInList[index]           = pLast;
+        *m_globalRefIndexMap.FindKey(pLast) = index;
+    }
+
+    --m_numResourcesInList;
+}
+
+// =====================================================================================================================
+// Patches the global memory references at the front of the resource list with the changes made to m_globalRefMap since
+// the list was last built. The changes are applied in order because an allocation may be removed and then added again,
+// possibly as a new allocation at the same address.
+Result Queue::ApplyGlobalRefChanges()
+{
+    Result result = Result::Success;
+
+    for (uint32 idx = 0; (idx < m_globalRefChanges.NumElements()) && (result == Result::Success); ++idx)
+    {
+        const GlobalRefChange& change = m_globalRefChanges[idx];
+
+        if (change.isAdd)
+        {
+            // An allocation which was removed again before this submit may have been destroyed already, and one which
+            // is already in the list mustn't be added twice.
+            if ((m_globalRefMap.FindKey(change.pGpuMemory) != nullptr) &&
+                (m_globalRefIndexMap.FindKey(change.pGpuMemory) == nullptr))
+            {
+                result = AppendGlobalResourceToList(change.pGpuMemory);
+            }
+        }
+        else
+        {
+            const uint32*const pIndex = m_globalRefIndexMap.FindKey(change.pGpuMemory);
+
+            if (pIndex != nullptr)
+            {
+                const uint32 index = *pIndex;
+
+                m_globalRefIndexMap.Erase(change.pGpuMemory);
+                RemoveGlobalResourceFromList(index);
+            }
+        }
+    }
+
+    m_globalRefChanges.Clear();
+
+    return result;
+}
+
+// =====================================================================================================================
+// Queues up an addition to or removal from m_globalRefMap to be patched into the resource list at the next submit. The
+// caller must hold m_globalRefLock for writing.
+void Queue::RecordGlobalRefChange(
+    IGpuMemory* pGpuMemory,
+    bool        isAdd)
+{
+    // Nothing to track if the whole list will be rebuilt anyway.
+    if (m_globalRefDirty == false)
+    {
+        const GlobalRefChange change = { pGpuMemory, isAdd };
+
+        if (m_globalRefChanges.PushBack(change) != Result::Success)
+        {
+            m_globalRefDirty = true;
+        }
+    }
+}
+
 // =====================================================================================================================
 // Calls AddIb on the first chunk from the given command stream.
 Result Queue::AddCmdStream(
@@ -1540,12 +1672,22 @@ void Queue::AssociateFenceWithContext(
 }
 
 // =====================================================================================================================
-// Set globalRefDirty true so that the resource list of the queue could be rebuilt.
-void Queue::DirtyGlobalReferences()
+// Queues the given global memory reference to be added to or removed from the resource list at the next submit, e.g.
+// when a presentable image changes hands with the window system. Without an allocation the whole list is rebuilt.
+void Queue::DirtyGlobalReferences(
+    IGpuMemory* pGpuMemory,
+    bool        isResident)
 {
     RWLockAuto<RWLock::ReadWrite> lock(&m_globalRefLock);
 
-    m_globalRefDirty = true;
+    if (pGpuMemory == nullptr)
+    {
+        m_globalRefDirty = true;
+    }
+    else if (m_globalRefMap.FindKey(pGpuMemory) != nullptr)
+    {
+        RecordGlobalRefChange(pGpuMemory, isResident);
+    }
 }
 
 } // Amdgpu
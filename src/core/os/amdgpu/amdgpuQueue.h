@@ -138,7 +138,9 @@ public:
     void  AssociateFenceWithContext(
         IFence* pFence);
 
-    void DirtyGlobalReferences();
+    void DirtyGlobalReferences(
+        IGpuMemory* pGpuMemory,
+        bool        isResident);
 
     Result AddGpuMemoryReferences(
         uint32              gpuMemRefCount,
@@ -183,6 +185,18 @@ private:
     Result AppendResourceToList(
         const GpuMemory* pGpuMemory);
 
+    Result AppendGlobalResourceToList(
+        IGpuMemory* pGpuMemory);
+
+    void RemoveGlobalResourceFromList(
+        uint32 index);
+
+    Result ApplyGlobalRefChanges();
+
+    void RecordGlobalRefChange(
+        IGpuMemory* pGpuMemory,
+        bool        isAdd);
+
     Result AddCmdStream(
         const CmdStream& cmdStream,
         bool             isDummySubmission,
@@ -227,6 +241,16 @@ private:
     // Tracks global memory references for this queue. Each key is a GPU memory object and each value is a refcount.
     typedef Util::HashMap<IGpuMemory*, uint32, Pal::Platform> MemoryRefMap;
 
+    // Maps each global memory reference in m_pResourceList to its index in the list.
+    typedef Util::HashMap<IGpuMemory*, uint32, Pal::Platform> ResourceIndexMap;
+
+    // An addition to or removal from m_globalRefMap which hasn't been applied to m_pResourceList yet.
+    struct GlobalRefChange
+    {
+        IGpuMemory* pGpuMemory;
+        bool        isAdd;
+    };
+
     // Kernel object representing a list of GPU memory allocations referenced by a submit.
     // Stored as a member variable to prevent re-creating the kernel object on every submit
     // in the common case where the set of resident allocations doesn't change.
@@ -234,8 +258,10 @@ private:
     amdgpu_bo_list_handle m_hDummyResourceList;   // The dummy resource list used by dummy submission.
     Pal::CmdStream*       m_pDummyCmdStream;      // The dummy command stream used by dummy submission.
     MemoryRefMap          m_globalRefMap;         // A hashmap acting as a refcounted list of memory references.
-    bool                  m_globalRefDirty;       // Indicates m_globalRefMap has changed since the last submit.
-    Util::RWLock          m_globalRefLock;        // Protect m_globalRefMap from muli-thread access.
+    bool                  m_globalRefDirty;       // Indicates the global references in m_pResourceList must be rebuilt
+                                                  // from m_globalRefMap rather than patched with m_globalRefChanges.
+    Util::RWLock          m_globalRefLock;        // Protect m_globalRefMap and the resource list state patched from
+                                                  // it (m_globalRefChanges and the index maps) from muli-thread access.
     uint32                m_appMemRefCount;       // Store count of application's submission memory references.
     bool                  m_pendingWait;          // Queue needs a dummy submission between wait and signal.
     CmdUploadRing*        m_pCmdUploadRing;       // Uploads gfxip command streams to a large local memory buffer.
@@ -257,6 +283,13 @@ private:
     // The vector to store the pending wait semaphore when sync object is in using.
     Util::Vector<SemaphoreInfo, 16, Platform> m_waitSemList;
 
+    // The global memory references occupy the front of m_pResourceList. Rather than walking m_globalRefMap again
+    // whenever it changes, the changes since the last submit are queued up and patched into the list, so a submit
+    // costs time proportional to the churn instead of the number of resident allocations.
+    ResourceIndexMap                            m_globalRefIndexMap; // Where each global reference sits in the list.
+    Util::Vector<IGpuMemory*, 16, Platform>     m_globalRefsInList;  // Which global reference each index holds.
+    Util::Vector<GlobalRefChange, 16, Platform> m_globalRefChanges;  // Changes in the order they were made.
+
     PAL_DISALLOW_DEFAULT_CTOR(Queue);
     PAL_DISALLOW_COPY_AND_ASSIGN(Queue);
 };
@@ -84,9 +84,8 @@ Result SyncobjFence::Init(
 // SyncobjFence objects to be processed.  Otherwise, this only waits for at least one SyncobjFence object
 // to be processed.
 //
-// NOTE: On Linux, we don't have any KMD-signaled completion Event when command buffers finish, so we have no way to
-// truly multiplex the set of Fences in the non-waitAll case.  This means that the best approximation we can make is
-// to poll until we discover that some SyncobjFence(s) in the set have finished.
+// The whole set is collapsed into a single sync object array wait, which returns as soon as any of them signals in the
+// non-waitAll case.
 Result SyncobjFence::WaitForFences(
     const Pal::Device&      device,
     uint32                  fenceCount,
@@ -129,20 +128,9 @@ Result SyncobjFence::WaitForFences(
 
     if (result == Result::NotReady)
     {
-        struct timespec startTime = {};
-        uint64 currentTimeNs = 0;
-        uint64 absTimeoutNs = 0;
-        uint32 firstSignaledFence = UINT32_MAX;
-        uint32 flags= 0;
-
-        ComputeTimeoutExpiration(&startTime, 0);
-        currentTimeNs = startTime.tv_sec * 1000000000ull + startTime.tv_nsec;
-        timeout = Util::Min(UINT64_MAX - currentTimeNs, timeout);
-        absTimeoutNs = currentTimeNs + timeout;
-
-        // definition of drm_timeout_abs_to_jiffies (int64_t timeout_nsec) require input to be int64_t,
-        // so trim down the max value to be INT64_MAX, otherwise drm_timeout_abs_to_jiffies compute wrong output.
-        absTimeoutNs= Util::Min(absTimeoutNs, (uint64)INT64_MAX);
+        const int64 absTimeoutNs       = ComputeAbsTimeout(timeout);
+        uint32      firstSignaledFence = UINT32_MAX;
+        uint32      flags              = 0;
 
         //fix even if the syncobj's submit is still in m_batchedCmds.
         flags |= DRM_SYNCOBJ_WAIT_FLAGS_WAIT_FOR_SUBMIT;
@@ -159,9 +159,8 @@ Result TimestampFence::Reset()
 // Waits for one or more Fence objects to be processed by the GPU.  If waitAll is set, then this waits for all Fence
 // objects to be processed.  Otherwise, this only waits for at least one Fence object to be processed.
 //
-// NOTE: On Legacy Linux, we don't have any KMD-signaled completion Event when command buffers finish, so we have no
-// way to truly multiplex the set of Fences in the non-waitAll case.  This means that the best approximation we can make
-// is to poll until we discover that some Fence(s) in the set have finished.
+// The whole set is collapsed into a single kernel wait on the submission timestamps, which returns as soon as any of
+// them retires in the non-waitAll case.
 Result TimestampFence::WaitForFences(
     const Pal::Device&      device,
     uint32                  fenceCount,
@@ -235,13 +234,6 @@ Result TimestampFence::WaitForFences(
 
     if (result == Result::NotReady)
     {
-        struct timespec startTime = {};
-        struct timespec stopTime = {};
-        uint64 timeoutLeft = 0;
-
-        ComputeTimeoutExpiration(&startTime, 0);
-        ComputeTimeoutExpiration(&stopTime, timeout);
-
         if (count > 0)
         {
             result = amdgpuDevice.WaitForFences(&fenceList[0], count, waitAll, timeout);
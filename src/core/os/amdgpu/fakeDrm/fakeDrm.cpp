@@ -0,0 +1,1971 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2015-2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "core/os/amdgpu/fakeDrm/fakeDrm.h"
+#include "core/hw/amdgpu_asic.h"
+#include "palConditionVariable.h"
+#include "palInlineFuncs.h"
+#include "palMutex.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+using namespace Util;
+
+// Limits and properties of the simulated device.
+constexpr uint32 FakeMaxRings          = 4;
+constexpr uint32 FakeSeqHistory        = 64;   // Submissions further back on a ring are always considered retired.
+constexpr uint32 FakeMaxSyncobjs       = 4096;
+constexpr uint32 FakeMaxSharedFds      = 256;
+constexpr uint64 FakeVaStart           = 0x800000ull;
+constexpr uint64 Fake32BitVaEnd        = 0x100000000ull;
+constexpr uint64 FakeVaEnd             = 0x800000000000ull;
+constexpr uint64 FakeVramSize          = 8ull * 1024 * 1024 * 1024;
+constexpr uint64 FakeVisibleVramSize   = 256ull * 1024 * 1024;
+constexpr uint64 FakeGttSize           = 16ull * 1024 * 1024 * 1024;
+constexpr uint32 FakeGpuCounterFreqKhz = 27000;
+constexpr uint64 FakeNeverSignaled     = UINT64_MAX; // The completion time of a sync object without a payload.
+
+// The handle types are only forward declared by amdgpu.h so the fake is free to define them.
+struct amdgpu_device
+{
+    int32  fd;
+    uint32 refCount;
+    uint64 nextVa;         // Bump allocator for amdgpu_va_range_alloc above 4GB.
+    uint64 next32BitVa;    // Bump allocator for amdgpu_va_range_alloc below 4GB.
+    uint64 lastCompleteNs; // Simulated completion time of the most recent submission on any ring.
+};
+
+struct amdgpu_bo
+{
+    uint64             size;
+    uint64             alignment;
+    uint32             heap;
+    uint64             flags;
+    void*              pCpuAddr;  // Host backing store, allocated on first CPU map unless created from user memory.
+    bool               isUserMem;
+    uint32             refCount;  // Imports of an exported buffer share the same object.
+    uint32             kmsHandle;
+    amdgpu_bo_metadata metadata;
+};
+
+struct amdgpu_bo_list
+{
+    uint32            count;
+    amdgpu_bo_handle* pBos;  // A copy of the listed buffers, so tests can check what a submission referenced.
+};
+
+struct amdgpu_va
+{
+    uint64 address;
+    uint64 size;
+};
+
+struct FakeRing
+{
+    uint64 lastSeqNo;
+    uint64 lastCompleteNs;
+    uint64 completeNs[FakeSeqHistory];
+};
+
+struct amdgpu_context
+{
+    FakeRing rings[AMDGPU_HW_IP_NUM][FakeMaxRings];
+};
+
+namespace
+{
+
+// A file descriptor handed out by an export call. Exported fds are real descriptors of /dev/null so clients may close()
+// them normally; the fake only uses the number to find what was exported.
+struct FakeSharedFd
+{
+    int32      fd;
+    uint32     payload;    // For sync object fds: the shared payload index + 1, or zero if not a sync object.
+    uint64     completeNs; // For sync files: the completion time captured at export.
+    bool       isSyncFile;
+    amdgpu_bo* pBo;        // For buffer fds: the exported buffer.
+};
+
+// A sync object handle refers to a payload; imports of an exported sync object share the payload.
+struct FakePayload
+{
+    uint32 refCount;
+    uint64 completeNs;
+};
+
+// All simulated kernel state is global, just like a real device node, and protected by a single lock. Any change which
+// can satisfy a waiter broadcasts s_stateChanged; completions which only depend on time are found by timed waits.
+Mutex             s_lock;
+ConditionVariable s_stateChanged;
+uint64            s_submitLatencyNs = 0;
+amdgpu_device     s_device          = {};
+uint32            s_nextKmsHandle   = 1;
+uint32            s_syncobjs[FakeMaxSyncobjs];     // Handle - 1 -> payload index + 1, or zero if the handle is free.
+FakePayload       s_payloads[FakeMaxSyncobjs];
+FakeSharedFd      s_sharedFds[FakeMaxSharedFds];
+amdgpu_bo_list    s_lastSubmitBoList = {}; // The buffer list of the most recent successful submission.
+
+// =====================================================================================================================
+uint64 NowNs()
+{
+    struct timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (static_cast<uint64>(now.tv_sec) * 1000000000ull) + now.tv_nsec;
+}
+
+// =====================================================================================================================
+// Converts a relative timeout to an absolute deadline without overflowing.
+uint64 DeadlineFromTimeout(
+    uint64 timeoutNs)
+{
+    const uint64 now = NowNs();
+    return (timeoutNs > (UINT64_MAX - now)) ? UINT64_MAX : (now + timeoutNs);
+}
+
+// =====================================================================================================================
+// Blocks on s_lock until isDone() returns true or the absolute deadline passes. isDone() reports the earliest simulated
+// completion time which could change its answer so we sleep exactly until something interesting can happen.
+template <typename IsDone>
+bool WaitUntil(
+    uint64 deadlineNs,
+    IsDone isDone)
+{
+    uint64 wakeNs = FakeNeverSignaled;
+    bool   done   = isDone(&wakeNs);
+
+    while (done == false)
+    {
+        const uint64 now = NowNs();
+
+        if (now >= deadlineNs)
+        {
+            break;
+        }
+
+        const uint64 untilNs = Min(deadlineNs, wakeNs);
+        const uint64 sleepNs = (untilNs > now) ? (untilNs - now) : 0;
+
+        if (sleepNs < 1000000)
+        {
+            // The condition variable only has millisecond granularity, which is far coarser than typical simulated
+            // latencies, so sleep out short intervals directly.
+            const struct timespec interval = { 0, static_cast<long>(sleepNs) };
+
+            s_lock.Unlock();
+            nanosleep(&interval, nullptr);
+            s_lock.Lock();
+        }
+        else
+        {
+            s_stateChanged.Wait(&s_lock, static_cast<uint32>(Min<uint64>(sleepNs / 1000000, UINT32_MAX - 1)));
+        }
+
+        wakeNs = FakeNeverSignaled;
+        done   = isDone(&wakeNs);
+    }
+
+    return done;
+}
+
+// =====================================================================================================================
+// Drops one reference on a sync object payload.
+void ReleasePayload(
+    uint32 payload)
+{
+    PAL_ASSERT(s_payloads[payload - 1].refCount > 0);
+    s_payloads[payload - 1].refCount--;
+}
+
+// =====================================================================================================================
+// Drops one reference on a buffer object, freeing it and its backing store with the last one.
+void ReleaseBo(
+    amdgpu_bo* pBo)
+{
+    PAL_ASSERT(pBo->refCount > 0);
+
+    if (--pBo->refCount == 0)
+    {
+        if (pBo->isUserMem == false)
+        {
+            free(pBo->pCpuAddr);
+        }
+
+        free(pBo);
+    }
+}
+
+// =====================================================================================================================
+// Drops the references held by an exported descriptor.
+void ReleaseSharedFd(
+    FakeSharedFd* pEntry)
+{
+    if (pEntry->payload != 0)
+    {
+        ReleasePayload(pEntry->payload);
+    }
+
+    if (pEntry->pBo != nullptr)
+    {
+        ReleaseBo(pEntry->pBo);
+    }
+
+    memset(pEntry, 0, sizeof(*pEntry));
+}
+
+// =====================================================================================================================
+// Opens a fresh descriptor to stand in for an exported object. Returns null if the table is full.
+//
+// The fake is never told when a client closes an exported descriptor, so the references it holds are only released
+// once the OS hands out the same descriptor number again.
+FakeSharedFd* AllocSharedFd()
+{
+    FakeSharedFd* pEntry = nullptr;
+    const int32   fd     = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    if (fd >= 0)
+    {
+        // Reuse the slot of a descriptor which the client has since closed and the OS recycled, or any free slot.
+        for (uint32 idx = 0; idx < FakeMaxSharedFds; ++idx)
+        {
+            if (s_sharedFds[idx].fd == fd)
+            {
+                pEntry = &s_sharedFds[idx];
+                break;
+            }
+            else if ((pEntry == nullptr) && (s_sharedFds[idx].fd <= 0))
+            {
+                pEntry = &s_sharedFds[idx];
+            }
+        }
+
+        if (pEntry == nullptr)
+        {
+            close(fd);
+        }
+        else
+        {
+            ReleaseSharedFd(pEntry);
+            pEntry->fd = fd;
+        }
+    }
+
+    return pEntry;
+}
+
+// =====================================================================================================================
+FakeSharedFd* FindSharedFd(
+    int32 fd)
+{
+    FakeSharedFd* pEntry = nullptr;
+
+    for (uint32 idx = 0; (fd > 0) && (idx < FakeMaxSharedFds); ++idx)
+    {
+        if (s_sharedFds[idx].fd == fd)
+        {
+            pEntry = &s_sharedFds[idx];
+            break;
+        }
+    }
+
+    return pEntry;
+}
+
+// =====================================================================================================================
+// Creates a sync object handle referring to the given payload, or to a new payload if payload is zero.
+int32 AllocSyncobj(
+    uint32  payload,
+    uint64  completeNs,
+    uint32* pHandle)
+{
+    int32 ret = -ENOMEM;
+
+    if (payload == 0)
+    {
+        for (uint32 idx = 0; idx < FakeMaxSyncobjs; ++idx)
+        {
+            if (s_payloads[idx].refCount == 0)
+            {
+                s_payloads[idx].completeNs = completeNs;
+                payload = idx + 1;
+                break;
+            }
+        }
+    }
+
+    for (uint32 idx = 0; (payload != 0) && (idx < FakeMaxSyncobjs); ++idx)
+    {
+        if (s_syncobjs[idx] == 0)
+        {
+            s_syncobjs[idx] = payload;
+            s_payloads[payload - 1].refCount++;
+            *pHandle = idx + 1;
+            ret = 0;
+            break;
+        }
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+// Returns the payload of a sync object handle, or null if the handle is invalid.
+FakePayload* GetPayload(
+    uint32 handle)
+{
+    FakePayload* pPayload = nullptr;
+
+    if ((handle > 0) && (handle <= FakeMaxSyncobjs) && (s_syncobjs[handle - 1] != 0))
+    {
+        pPayload = &s_payloads[s_syncobjs[handle - 1] - 1];
+    }
+
+    return pPayload;
+}
+
+// =====================================================================================================================
+// Returns the simulated completion time of a submission, or zero if it is too old to be tracked.
+int32 GetSeqNoCompleteNs(
+    const amdgpu_cs_fence& fence,
+    uint64*                pCompleteNs)
+{
+    int32 ret = -EINVAL;
+
+    if ((fence.context != nullptr) && (fence.ip_type < AMDGPU_HW_IP_NUM) && (fence.ring < FakeMaxRings))
+    {
+        const FakeRing& ring = fence.context->rings[fence.ip_type][fence.ring];
+
+        if (fence.fence <= ring.lastSeqNo)
+        {
+            *pCompleteNs = ((ring.lastSeqNo - fence.fence) < FakeSeqHistory)
+                           ? ring.completeNs[fence.fence % FakeSeqHistory] : 0;
+            ret = 0;
+        }
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+// Simulates the execution of one submission: it starts once its dependencies and the previous submission on the ring
+// have completed, runs for the simulated latency and then signals its output sync objects.
+int32 Submit(
+    amdgpu_context*                pContext,
+    uint32                         ipType,
+    uint32                         ringIdx,
+    uint64                         depsCompleteNs,
+    const drm_amdgpu_cs_chunk_sem* pSignals,
+    uint32                         signalCount,
+    uint64*                        pSeqNo)
+{
+    int32 ret = -EINVAL;
+
+    if ((pContext != nullptr) && (ipType < AMDGPU_HW_IP_NUM) && (ringIdx < FakeMaxRings))
+    {
+        FakeRing&    ring       = pContext->rings[ipType][ringIdx];
+        const uint64 startNs    = Max(Max(NowNs(), depsCompleteNs), ring.lastCompleteNs);
+        const uint64 completeNs = (startNs > (UINT64_MAX - s_submitLatencyNs)) ? (UINT64_MAX - 1)
+                                                                                : (startNs + s_submitLatencyNs);
+
+        ring.lastSeqNo++;
+        ring.lastCompleteNs = completeNs;
+        ring.completeNs[ring.lastSeqNo % FakeSeqHistory] = completeNs;
+
+        s_device.lastCompleteNs = Max(s_device.lastCompleteNs, completeNs);
+
+        for (uint32 idx = 0; idx < signalCount; ++idx)
+        {
+            FakePayload*const pPayload = GetPayload(pSignals[idx].handle);
+
+            if (pPayload != nullptr)
+            {
+                pPayload->completeNs = completeNs;
+            }
+        }
+
+        *pSeqNo = ring.lastSeqNo;
+        ret     = 0;
+
+        s_stateChanged.WakeAll();
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+// libdrm_amdgpu: device and query entry points.
+// =====================================================================================================================
+
+// =====================================================================================================================
+int32 FakeAmdgpuDeviceInitialize(
+    int                   fd,
+    uint32*               pMajorVersion,
+    uint32*               pMinorVersion,
+    amdgpu_device_handle* pDeviceHandle)
+{
+    MutexAuto lock(&s_lock);
+
+    if (s_device.refCount == 0)
+    {
+        s_device.fd          = fd;
+        s_device.nextVa      = Fake32BitVaEnd;
+        s_device.next32BitVa = FakeVaStart;
+    }
+
+    s_device.refCount++;
+
+    *pMajorVersion = 3;
+    *pMinorVersion = 40;
+    *pDeviceHandle = &s_device;
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuDeviceDeinitialize(
+    amdgpu_device_handle hDevice)
+{
+    MutexAuto lock(&s_lock);
+
+    PAL_ASSERT(hDevice->refCount > 0);
+    hDevice->refCount--;
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuQueryGpuInfo(
+    amdgpu_device_handle    hDevice,
+    struct amdgpu_gpu_info* pInfo)
+{
+    memset(pInfo, 0, sizeof(*pInfo));
+
+    pInfo->asic_id                      = DEVICE_ID_AI_VEGA10_P_6860;
+    pInfo->chip_external_rev            = AI_VEGA10_P_A0;
+    pInfo->family_id                    = AMDGPU_FAMILY_AI;
+    pInfo->max_engine_clk               = 1500000;
+    pInfo->max_memory_clk               = 945000;
+    pInfo->num_shader_engines           = 4;
+    pInfo->num_shader_arrays_per_engine = 1;
+    pInfo->num_hw_gfx_contexts          = 8;
+    pInfo->rb_pipes                     = 16;
+    pInfo->enabled_rb_pipes_mask        = 0xFFFF;
+    pInfo->gpu_counter_freq             = FakeGpuCounterFreqKhz;
+    pInfo->gb_addr_cfg                  = 0x2A114042;
+    pInfo->cu_active_number             = 64;
+    pInfo->cu_ao_mask                   = 0xFFFFFFFF;
+    pInfo->vram_type                    = AMDGPU_VRAM_TYPE_HBM;
+    pInfo->vram_bit_width               = 2048;
+    pInfo->ce_ram_size                  = 32768;
+    pInfo->pci_rev_id                   = 0xC1;
+
+    for (uint32 se = 0; se < pInfo->num_shader_engines; ++se)
+    {
+        pInfo->cu_bitmap[se][0] = 0xFFFF;
+    }
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuQueryInfo(
+    amdgpu_device_handle hDevice,
+    uint32               infoId,
+    uint32               size,
+    void*                pValue)
+{
+    int32 ret = 0;
+
+    memset(pValue, 0, size);
+
+    switch (infoId)
+    {
+    case AMDGPU_INFO_DEV_INFO:
+        if (size >= sizeof(drm_amdgpu_info_device))
+        {
+            amdgpu_gpu_info gpuInfo = {};
+            FakeAmdgpuQueryGpuInfo(hDevice, &gpuInfo);
+
+            drm_amdgpu_info_device*const pDevInfo = static_cast<drm_amdgpu_info_device*>(pValue);
+
+            pDevInfo->device_id                    = gpuInfo.asic_id;
+            pDevInfo->external_rev                 = gpuInfo.chip_external_rev;
+            pDevInfo->pci_rev                      = gpuInfo.pci_rev_id;
+            pDevInfo->family                       = gpuInfo.family_id;
+            pDevInfo->num_shader_engines           = gpuInfo.num_shader_engines;
+            pDevInfo->num_shader_arrays_per_engine = gpuInfo.num_shader_arrays_per_engine;
+            pDevInfo->gpu_counter_freq             = gpuInfo.gpu_counter_freq;
+            pDevInfo->max_engine_clock             = gpuInfo.max_engine_clk;
+            pDevInfo->max_memory_clock             = gpuInfo.max_memory_clk;
+            pDevInfo->cu_active_number             = gpuInfo.cu_active_number;
+            pDevInfo->cu_ao_mask                   = gpuInfo.cu_ao_mask;
+            pDevInfo->enabled_rb_pipes_mask        = gpuInfo.enabled_rb_pipes_mask;
+            pDevInfo->num_rb_pipes                 = gpuInfo.rb_pipes;
+            pDevInfo->num_hw_gfx_contexts          = gpuInfo.num_hw_gfx_contexts;
+            pDevInfo->virtual_address_offset       = FakeVaStart;
+            pDevInfo->virtual_address_max          = FakeVaEnd;
+            pDevInfo->virtual_address_alignment    = 4096;
+            pDevInfo->pte_fragment_size            = 2 * 1024 * 1024;
+            pDevInfo->gart_page_size               = 4096;
+            pDevInfo->ce_ram_size                  = gpuInfo.ce_ram_size;
+            pDevInfo->vram_type                    = gpuInfo.vram_type;
+            pDevInfo->vram_bit_width               = gpuInfo.vram_bit_width;
+            pDevInfo->wave_front_size              = 64;
+            pDevInfo->num_shader_visible_vgprs     = 256;
+            pDevInfo->num_cu_per_sh                = 16;
+            pDevInfo->num_tcc_blocks               = 16;
+
+            memcpy(pDevInfo->cu_bitmap, gpuInfo.cu_bitmap, sizeof(pDevInfo->cu_bitmap));
+            memcpy(pDevInfo->cu_ao_bitmap, gpuInfo.cu_bitmap, sizeof(pDevInfo->cu_ao_bitmap));
+        }
+        else
+        {
+            ret = -EINVAL;
+        }
+        break;
+
+    case AMDGPU_INFO_MEMORY:
+        if (size >= sizeof(drm_amdgpu_memory_info))
+        {
+            drm_amdgpu_memory_info*const pMemInfo = static_cast<drm_amdgpu_memory_info*>(pValue);
+
+            pMemInfo->vram.total_heap_size                 = FakeVramSize;
+            pMemInfo->vram.usable_heap_size                = FakeVramSize;
+            pMemInfo->vram.max_allocation                  = FakeVramSize;
+            pMemInfo->cpu_accessible_vram.total_heap_size  = FakeVisibleVramSize;
+            pMemInfo->cpu_accessible_vram.usable_heap_size = FakeVisibleVramSize;
+            pMemInfo->cpu_accessible_vram.max_allocation   = FakeVisibleVramSize;
+            pMemInfo->gtt.total_heap_size                  = FakeGttSize;
+            pMemInfo->gtt.usable_heap_size                 = FakeGttSize;
+            pMemInfo->gtt.max_allocation                   = FakeGttSize;
+        }
+        else
+        {
+            ret = -EINVAL;
+        }
+        break;
+
+    case AMDGPU_INFO_TIMESTAMP:
+        if (size >= sizeof(uint64))
+        {
+            // The GPU counter ticks at gpu_counter_freq kHz.
+            *static_cast<uint64*>(pValue) = (NowNs() / 1000000ull) * FakeGpuCounterFreqKhz;
+        }
+        else
+        {
+            ret = -EINVAL;
+        }
+        break;
+
+    case AMDGPU_INFO_CAPABILITY:
+        // No optional capabilities; the zeroed structure says so.
+        break;
+
+    default:
+        ret = -EINVAL;
+        break;
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuQueryHwIpInfo(
+    amdgpu_device_handle          hDevice,
+    uint32                        type,
+    uint32                        ipInstance,
+    struct drm_amdgpu_info_hw_ip* pInfo)
+{
+    memset(pInfo, 0, sizeof(*pInfo));
+
+    if ((type == AMDGPU_HW_IP_GFX) || (type == AMDGPU_HW_IP_COMPUTE) || (type == AMDGPU_HW_IP_DMA))
+    {
+        pInfo->hw_ip_version_major = (type == AMDGPU_HW_IP_DMA) ? 4 : 9;
+        pInfo->ib_start_alignment  = 32;
+        pInfo->ib_size_alignment   = 32;
+        pInfo->available_rings     = (type == AMDGPU_HW_IP_COMPUTE) ? 0xF : 0x1;
+    }
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuQueryHwIpCount(
+    amdgpu_device_handle hDevice,
+    uint32               type,
+    uint32*              pCount)
+{
+    *pCount = ((type == AMDGPU_HW_IP_GFX) || (type == AMDGPU_HW_IP_COMPUTE) || (type == AMDGPU_HW_IP_DMA)) ? 1 : 0;
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuQueryFirmwareVersion(
+    amdgpu_device_handle hDevice,
+    uint32               fwType,
+    uint32               ipInstance,
+    uint32               index,
+    uint32*              pVersion,
+    uint32*              pFeature)
+{
+    // Report firmware new enough that no workarounds for old microcode are enabled.
+    *pVersion = 0xFFFF;
+    *pFeature = 0xFFFF;
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuQueryHeapInfo(
+    amdgpu_device_handle    hDevice,
+    uint32                  heap,
+    uint32                  flags,
+    struct amdgpu_heap_info* pInfo)
+{
+    memset(pInfo, 0, sizeof(*pInfo));
+
+    if (heap == AMDGPU_GEM_DOMAIN_VRAM)
+    {
+        pInfo->heap_size = ((flags & AMDGPU_GEM_CREATE_CPU_ACCESS_REQUIRED) != 0) ? FakeVisibleVramSize
+                                                                                   : FakeVramSize;
+    }
+    else
+    {
+        pInfo->heap_size = FakeGttSize;
+    }
+
+    pInfo->max_allocation = pInfo->heap_size;
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuQueryBufferSizeAlignment(
+    amdgpu_device_handle                  hDevice,
+    struct amdgpu_buffer_size_alignments* pInfo)
+{
+    pInfo->size_local  = 4096;
+    pInfo->size_remote = 4096;
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuQuerySensorInfo(
+    amdgpu_device_handle hDevice,
+    uint32               sensorType,
+    uint32               size,
+    void*                pValue)
+{
+    return -EINVAL;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuReadMmRegisters(
+    amdgpu_device_handle hDevice,
+    uint32               dwordOffset,
+    uint32               count,
+    uint32               instance,
+    uint32               flags,
+    uint32*              pValues)
+{
+    // There is no register file behind the fake; every register reads as zero.
+    memset(pValues, 0, count * sizeof(uint32));
+
+    return 0;
+}
+
+// =====================================================================================================================
+const char* FakeAmdgpuGetMarketingName(
+    amdgpu_device_handle hDevice)
+{
+    return "PAL Fake DRM Device (Vega10)";
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsReservedVmid(
+    amdgpu_device_handle hDevice)
+{
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsUnreservedVmid(
+    amdgpu_device_handle hDevice)
+{
+    return 0;
+}
+
+// =====================================================================================================================
+// libdrm_amdgpu: virtual address space and buffer objects.
+// =====================================================================================================================
+
+// =====================================================================================================================
+int32 FakeAmdgpuVaRangeQuery(
+    amdgpu_device_handle     hDevice,
+    enum amdgpu_gpu_va_range type,
+    uint64*                  pStart,
+    uint64*                  pEnd)
+{
+    *pStart = FakeVaStart;
+    *pEnd   = FakeVaEnd;
+
+    return 0;
+}
+
+// =====================================================================================================================
+// VA ranges are handed out by a bump allocator and never reused; the address space is far larger than any offline run
+// can consume.
+int32 FakeAmdgpuVaRangeAlloc(
+    amdgpu_device_handle     hDevice,
+    enum amdgpu_gpu_va_range vaRangeType,
+    uint64                   size,
+    uint64                   vaBaseAlignment,
+    uint64                   vaBaseRequired,
+    uint64*                  pVaAllocated,
+    amdgpu_va_handle*        pVaRange,
+    uint64                   flags)
+{
+    int32             ret    = 0;
+    amdgpu_va*const   pRange = static_cast<amdgpu_va*>(calloc(1, sizeof(amdgpu_va)));
+
+    if (pRange == nullptr)
+    {
+        ret = -ENOMEM;
+    }
+    else
+    {
+        MutexAuto lock(&s_lock);
+
+        const uint64 alignment = Max<uint64>(vaBaseAlignment, 4096);
+
+        if (vaBaseRequired != 0)
+        {
+            pRange->address = vaBaseRequired;
+        }
+        else if ((flags & AMDGPU_VA_RANGE_32_BIT) != 0)
+        {
+            pRange->address      = Pow2Align(hDevice->next32BitVa, alignment);
+            hDevice->next32BitVa = pRange->address + size;
+
+            if (hDevice->next32BitVa > Fake32BitVaEnd)
+            {
+                ret = -ENOMEM;
+            }
+        }
+        else
+        {
+            pRange->address = Pow2Align(hDevice->nextVa, alignment);
+            hDevice->nextVa = pRange->address + size;
+
+            if (hDevice->nextVa > FakeVaEnd)
+            {
+                ret = -ENOMEM;
+            }
+        }
+
+        pRange->size = size;
+    }
+
+    if (ret == 0)
+    {
+        *pVaAllocated = pRange->address;
+        *pVaRange     = pRange;
+    }
+    else
+    {
+        free(pRange);
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuVaRangeFree(
+    amdgpu_va_handle hVaRange)
+{
+    free(hVaRange);
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoVaOp(
+    amdgpu_bo_handle hBuffer,
+    uint64           offset,
+    uint64           size,
+    uint64           address,
+    uint64           flags,
+    uint32           ops)
+{
+    // Nothing ever dereferences a GPU virtual address, so there are no page tables to update.
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoVaOpRaw(
+    amdgpu_device_handle hDevice,
+    amdgpu_bo_handle     hBuffer,
+    uint64               offset,
+    uint64               size,
+    uint64               address,
+    uint64               flags,
+    uint32               ops)
+{
+    return 0;
+}
+
+// =====================================================================================================================
+// Creates a buffer object. The host backing store is allocated on first CPU map so that large, GPU-only allocations
+// don't cost host memory.
+amdgpu_bo* CreateBo(
+    uint64 size,
+    uint64 alignment,
+    uint32 heap,
+    uint64 flags)
+{
+    amdgpu_bo*const pBo = static_cast<amdgpu_bo*>(calloc(1, sizeof(amdgpu_bo)));
+
+    if (pBo != nullptr)
+    {
+        MutexAuto lock(&s_lock);
+
+        pBo->size      = size;
+        pBo->alignment = alignment;
+        pBo->heap      = heap;
+        pBo->flags     = flags;
+        pBo->refCount  = 1;
+        pBo->kmsHandle = s_nextKmsHandle++;
+    }
+
+    return pBo;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoAlloc(
+    amdgpu_device_handle            hDevice,
+    struct amdgpu_bo_alloc_request* pAllocBuffer,
+    amdgpu_bo_handle*               pBufferHandle)
+{
+    *pBufferHandle = CreateBo(pAllocBuffer->alloc_size,
+                              pAllocBuffer->phys_alignment,
+                              pAllocBuffer->preferred_heap,
+                              pAllocBuffer->flags);
+
+    return (*pBufferHandle != nullptr) ? 0 : -ENOMEM;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCreateBoFromUserMem(
+    amdgpu_device_handle hDevice,
+    void*                pCpuAddress,
+    uint64               size,
+    amdgpu_bo_handle*    pBufferHandle)
+{
+    amdgpu_bo*const pBo = CreateBo(size, 4096, AMDGPU_GEM_DOMAIN_GTT, 0);
+
+    if (pBo != nullptr)
+    {
+        pBo->pCpuAddr  = pCpuAddress;
+        pBo->isUserMem = true;
+    }
+
+    *pBufferHandle = pBo;
+
+    return (pBo != nullptr) ? 0 : -ENOMEM;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoFree(
+    amdgpu_bo_handle hBuffer)
+{
+    MutexAuto lock(&s_lock);
+
+    ReleaseBo(hBuffer);
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoSetMetadata(
+    amdgpu_bo_handle           hBuffer,
+    struct amdgpu_bo_metadata* pInfo)
+{
+    MutexAuto lock(&s_lock);
+
+    hBuffer->metadata = *pInfo;
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoQueryInfo(
+    amdgpu_bo_handle       hBuffer,
+    struct amdgpu_bo_info* pInfo)
+{
+    MutexAuto lock(&s_lock);
+
+    pInfo->alloc_size     = hBuffer->size;
+    pInfo->phys_alignment = hBuffer->alignment;
+    pInfo->preferred_heap = hBuffer->heap;
+    pInfo->alloc_flags    = hBuffer->flags;
+    pInfo->metadata       = hBuffer->metadata;
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoExport(
+    amdgpu_bo_handle           hBuffer,
+    enum amdgpu_bo_handle_type type,
+    uint32*                    pFd)
+{
+    MutexAuto lock(&s_lock);
+
+    int32 ret = 0;
+
+    if (type == amdgpu_bo_handle_type_dma_buf_fd)
+    {
+        FakeSharedFd*const pEntry = AllocSharedFd();
+
+        if (pEntry != nullptr)
+        {
+            hBuffer->refCount++;
+            pEntry->pBo = hBuffer;
+            *pFd        = pEntry->fd;
+        }
+        else
+        {
+            ret = -EMFILE;
+        }
+    }
+    else
+    {
+        // GEM names and KMS handles are both just the buffer's handle number.
+        *pFd = hBuffer->kmsHandle;
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoImport(
+    amdgpu_device_handle            hDevice,
+    enum amdgpu_bo_handle_type      type,
+    uint32                          fd,
+    struct amdgpu_bo_import_result* pOutput)
+{
+    MutexAuto lock(&s_lock);
+
+    int32                    ret    = -EINVAL;
+    const FakeSharedFd*const pEntry = (type == amdgpu_bo_handle_type_dma_buf_fd) ? FindSharedFd(fd) : nullptr;
+
+    // Only dma-buf descriptors can be resolved; the fake keeps no table of GEM names.
+    if ((pEntry != nullptr) && (pEntry->pBo != nullptr))
+    {
+        pEntry->pBo->refCount++;
+        pOutput->buf_handle = pEntry->pBo;
+        pOutput->alloc_size = pEntry->pBo->size;
+        ret = 0;
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoCpuMap(
+    amdgpu_bo_handle hBuffer,
+    void**           ppCpuAddress)
+{
+    MutexAuto lock(&s_lock);
+
+    int32 ret = 0;
+
+    if ((hBuffer->pCpuAddr == nullptr) &&
+        (posix_memalign(&hBuffer->pCpuAddr, Max<size_t>(static_cast<size_t>(hBuffer->alignment), 4096),
+                        static_cast<size_t>(hBuffer->size)) != 0))
+    {
+        hBuffer->pCpuAddr = nullptr;
+        ret               = -ENOMEM;
+    }
+
+    *ppCpuAddress = hBuffer->pCpuAddr;
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoCpuUnmap(
+    amdgpu_bo_handle hBuffer)
+{
+    // The backing store lives as long as the buffer so that remapping preserves its contents.
+    return 0;
+}
+
+// =====================================================================================================================
+// The fake doesn't track which submissions reference a buffer, so a buffer is busy until all submitted work completes.
+int32 FakeAmdgpuBoWaitForIdle(
+    amdgpu_bo_handle hBuffer,
+    uint64           timeoutInNs,
+    bool*            pBufferBusy)
+{
+    MutexAuto lock(&s_lock);
+
+    const bool idle = WaitUntil(DeadlineFromTimeout(timeoutInNs),
+                                [](uint64* pWakeNs)
+                                {
+                                    *pWakeNs = s_device.lastCompleteNs;
+                                    return (s_device.lastCompleteNs <= NowNs());
+                                });
+
+    *pBufferBusy = (idle == false);
+
+    return 0;
+}
+
+// =====================================================================================================================
+// Replaces the contents of a buffer list with a copy of the given buffers.
+int32 SetBoListContents(
+    amdgpu_bo_list*         pList,
+    uint32                  count,
+    const amdgpu_bo_handle* pBos)
+{
+    int32 ret = 0;
+
+    if (count > 0)
+    {
+        void*const pNewBos = realloc(pList->pBos, count * sizeof(amdgpu_bo_handle));
+
+        if (pNewBos == nullptr)
+        {
+            ret = -ENOMEM;
+        }
+        else
+        {
+            pList->pBos = static_cast<amdgpu_bo_handle*>(pNewBos);
+            memcpy(pList->pBos, pBos, count * sizeof(amdgpu_bo_handle));
+        }
+    }
+
+    if (ret == 0)
+    {
+        pList->count = count;
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoListCreate(
+    amdgpu_device_handle   hDevice,
+    uint32                 numberOfResources,
+    amdgpu_bo_handle*      pResources,
+    uint8*                 pResourcePriorities,
+    amdgpu_bo_list_handle* pBoListHandle)
+{
+    amdgpu_bo_list* pList = static_cast<amdgpu_bo_list*>(calloc(1, sizeof(amdgpu_bo_list)));
+    int32           ret   = (pList != nullptr) ? 0 : -ENOMEM;
+
+    if (ret == 0)
+    {
+        ret = SetBoListContents(pList, numberOfResources, pResources);
+
+        if (ret != 0)
+        {
+            free(pList);
+            pList = nullptr;
+        }
+    }
+
+    *pBoListHandle = pList;
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoListDestroy(
+    amdgpu_bo_list_handle hBoList)
+{
+    free(hBoList->pBos);
+    free(hBoList);
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuBoListUpdate(
+    amdgpu_bo_list_handle hBoList,
+    uint32                numberOfResources,
+    amdgpu_bo_handle*     pResources,
+    uint8*                pResourcePriorities)
+{
+    return SetBoListContents(hBoList, numberOfResources, pResources);
+}
+
+// =====================================================================================================================
+// libdrm_amdgpu: contexts and command submission.
+// =====================================================================================================================
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsCtxCreate(
+    amdgpu_device_handle   hDevice,
+    amdgpu_context_handle* pContextHandle)
+{
+    *pContextHandle = static_cast<amdgpu_context*>(calloc(1, sizeof(amdgpu_context)));
+
+    return (*pContextHandle != nullptr) ? 0 : -ENOMEM;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsCtxCreate2(
+    amdgpu_device_handle   hDevice,
+    uint32                 priority,
+    amdgpu_context_handle* pContextHandle)
+{
+    return FakeAmdgpuCsCtxCreate(hDevice, pContextHandle);
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsCtxCreate3(
+    amdgpu_device_handle   hDevice,
+    uint32                 priority,
+    uint32_t               flags,
+    amdgpu_context_handle* pContextHandle)
+{
+    return FakeAmdgpuCsCtxCreate(hDevice, pContextHandle);
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsCtxFree(
+    amdgpu_context_handle hContext)
+{
+    free(hContext);
+
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsSubmit(
+    amdgpu_context_handle     hContext,
+    uint64                    flags,
+    struct amdgpu_cs_request* pIbsRequest,
+    uint32                    numberOfRequests)
+{
+    MutexAuto lock(&s_lock);
+
+    int32 ret = 0;
+
+    for (uint32 req = 0; (ret == 0) && (req < numberOfRequests); ++req)
+    {
+        amdgpu_cs_request*const pRequest       = &pIbsRequest[req];
+        uint64                  depsCompleteNs = 0;
+
+        for (uint32 dep = 0; (ret == 0) && (dep < pRequest->number_of_dependencies); ++dep)
+        {
+            uint64 completeNs = 0;
+            ret = GetSeqNoCompleteNs(pRequest->dependencies[dep], &completeNs);
+
+            depsCompleteNs = Max(depsCompleteNs, completeNs);
+        }
+
+        if (ret == 0)
+        {
+            ret = Submit(hContext, pRequest->ip_type, pRequest->ring, depsCompleteNs, nullptr, 0, &pRequest->seq_no);
+        }
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+// Walks the raw submission chunks for the target ring and the binary sync objects it waits on and signals. The command
+// buffers themselves are never parsed.
+int32 FakeAmdgpuCsSubmitRaw(
+    amdgpu_device_handle        hDevice,
+    amdgpu_context_handle       hContext,
+    amdgpu_bo_list_handle       hBuffer,
+    int32                       numChunks,
+    struct drm_amdgpu_cs_chunk* pChunks,
+    uint64*                     pSeqNo)
+{
+    MutexAuto lock(&s_lock);
+
+    int32                          ret            = 0;
+    uint32                         ipType         = AMDGPU_HW_IP_NUM;
+    uint32                         ring           = 0;
+    uint64                         depsCompleteNs = 0;
+    const drm_amdgpu_cs_chunk_sem* pSignals       = nullptr;
+    uint32                         signalCount    = 0;
+
+    for (int32 idx = 0; (ret == 0) && (idx < numChunks); ++idx)
+    {
+        const drm_amdgpu_cs_chunk& chunk = pChunks[idx];
+        const void*const           pData = reinterpret_cast<const void*>(static_cast<uintptr_t>(chunk.chunk_data));
+
+        if (chunk.chunk_id == AMDGPU_CHUNK_ID_IB)
+        {
+            const drm_amdgpu_cs_chunk_ib*const pIb = static_cast<const drm_amdgpu_cs_chunk_ib*>(pData);
+
+            ipType = pIb->ip_type;
+            ring   = pIb->ring;
+        }
+        else if (chunk.chunk_id == AMDGPU_CHUNK_ID_SYNCOBJ_IN)
+        {
+            const drm_amdgpu_cs_chunk_sem*const pWaits = static_cast<const drm_amdgpu_cs_chunk_sem*>(pData);
+            const uint32 waitCount = chunk.length_dw * sizeof(uint32) / sizeof(drm_amdgpu_cs_chunk_sem);
+
+            for (uint32 wait = 0; (ret == 0) && (wait < waitCount); ++wait)
+            {
+                const FakePayload*const pPayload = GetPayload(pWaits[wait].handle);
+
+                // Like the kernel, reject waits on sync objects which have no fence attached.
+                if ((pPayload == nullptr) || (pPayload->completeNs == FakeNeverSignaled))
+                {
+                    ret = -EINVAL;
+                }
+                else
+                {
+                    depsCompleteNs = Max(depsCompleteNs, pPayload->completeNs);
+                }
+            }
+        }
+        else if (chunk.chunk_id == AMDGPU_CHUNK_ID_SYNCOBJ_OUT)
+        {
+            pSignals    = static_cast<const drm_amdgpu_cs_chunk_sem*>(pData);
+            signalCount = chunk.length_dw * sizeof(uint32) / sizeof(drm_amdgpu_cs_chunk_sem);
+        }
+        else if ((chunk.chunk_id == AMDGPU_CHUNK_ID_SYNCOBJ_TIMELINE_WAIT) ||
+                 (chunk.chunk_id == AMDGPU_CHUNK_ID_SYNCOBJ_TIMELINE_SIGNAL))
+        {
+            // The fake reports no timeline support through DRM_CAP_SYNCOBJ_TIMELINE.
+            ret = -EINVAL;
+        }
+    }
+
+    if (ret == 0)
+    {
+        ret = Submit(hContext, ipType, ring, depsCompleteNs, pSignals, signalCount, pSeqNo);
+    }
+
+    if (ret == 0)
+    {
+        ret = (hBuffer != nullptr) ? SetBoListContents(&s_lastSubmitBoList, hBuffer->count, hBuffer->pBos)
+                                   : SetBoListContents(&s_lastSubmitBoList, 0, nullptr);
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsSubmitRaw2(
+    amdgpu_device_handle        dev,
+    amdgpu_context_handle       context,
+    uint32_t                    bo_list_handle,
+    int                         num_chunks,
+    struct drm_amdgpu_cs_chunk* chunks,
+    uint64_t*                   seq_no)
+{
+    return FakeAmdgpuCsSubmitRaw(dev, context, nullptr, num_chunks, chunks, seq_no);
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsQueryFenceStatus(
+    struct amdgpu_cs_fence* pFence,
+    uint64                  timeoutInNs,
+    uint64                  flags,
+    uint32*                 pExpired)
+{
+    MutexAuto lock(&s_lock);
+
+    uint64 completeNs = 0;
+    int32  ret        = GetSeqNoCompleteNs(*pFence, &completeNs);
+
+    if (ret == 0)
+    {
+        const uint64 deadlineNs = ((flags & AMDGPU_QUERY_FENCE_TIMEOUT_IS_ABSOLUTE) != 0)
+                                  ? timeoutInNs : DeadlineFromTimeout(timeoutInNs);
+
+        *pExpired = WaitUntil(deadlineNs,
+                              [completeNs](uint64* pWakeNs)
+                              {
+                                  *pWakeNs = completeNs;
+                                  return (completeNs <= NowNs());
+                              }) ? 1 : 0;
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsWaitFences(
+    struct amdgpu_cs_fence* pFences,
+    uint32                  fenceCount,
+    bool                    waitAll,
+    uint64                  timeoutInNs,
+    uint32*                 pStatus,
+    uint32*                 pFirst)
+{
+    MutexAuto lock(&s_lock);
+
+    int32  ret       = 0;
+    uint64 firstNs   = UINT64_MAX;
+    uint64 lastNs    = 0;
+    uint32 firstIdx  = 0;
+
+    // Submissions never complete earlier than simulated, so the wait reduces to one deadline.
+    for (uint32 idx = 0; (ret == 0) && (idx < fenceCount); ++idx)
+    {
+        uint64 completeNs = 0;
+        ret = GetSeqNoCompleteNs(pFences[idx], &completeNs);
+
+        if (completeNs < firstNs)
+        {
+            firstNs  = completeNs;
+            firstIdx = idx;
+        }
+
+        lastNs = Max(lastNs, completeNs);
+    }
+
+    if (ret == 0)
+    {
+        const uint64 targetNs = waitAll ? lastNs : firstNs;
+
+        *pStatus = WaitUntil(DeadlineFromTimeout(timeoutInNs),
+                             [targetNs](uint64* pWakeNs)
+                             {
+                                 *pWakeNs = targetNs;
+                                 return (targetNs <= NowNs());
+                             }) ? 1 : 0;
+
+        if (pFirst != nullptr)
+        {
+            *pFirst = firstIdx;
+        }
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+// libdrm_amdgpu: sync objects.
+// =====================================================================================================================
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsCreateSyncobj2(
+    amdgpu_device_handle hDevice,
+    uint32               flags,
+    uint32*              pSyncObj)
+{
+    MutexAuto lock(&s_lock);
+
+    return AllocSyncobj(0, ((flags & DRM_SYNCOBJ_CREATE_SIGNALED) != 0) ? 0 : FakeNeverSignaled, pSyncObj);
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsCreateSyncobj(
+    amdgpu_device_handle hDevice,
+    uint32*              pSyncObj)
+{
+    return FakeAmdgpuCsCreateSyncobj2(hDevice, 0, pSyncObj);
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsDestroySyncobj(
+    amdgpu_device_handle hDevice,
+    uint32               syncObj)
+{
+    MutexAuto lock(&s_lock);
+
+    int32 ret = -EINVAL;
+
+    if (GetPayload(syncObj) != nullptr)
+    {
+        ReleasePayload(s_syncobjs[syncObj - 1]);
+        s_syncobjs[syncObj - 1] = 0;
+        ret = 0;
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsExportSyncobj(
+    amdgpu_device_handle hDevice,
+    uint32               syncObj,
+    int32*               pSharedFd)
+{
+    MutexAuto lock(&s_lock);
+
+    int32 ret = -EINVAL;
+
+    if (GetPayload(syncObj) != nullptr)
+    {
+        FakeSharedFd*const pEntry = AllocSharedFd();
+
+        if (pEntry != nullptr)
+        {
+            pEntry->payload = s_syncobjs[syncObj - 1];
+            s_payloads[pEntry->payload - 1].refCount++;
+            *pSharedFd      = pEntry->fd;
+            ret             = 0;
+        }
+        else
+        {
+            ret = -EMFILE;
+        }
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsImportSyncobj(
+    amdgpu_device_handle hDevice,
+    int32                sharedFd,
+    uint32*              pSyncObj)
+{
+    MutexAuto lock(&s_lock);
+
+    const FakeSharedFd*const pEntry = FindSharedFd(sharedFd);
+
+    return ((pEntry != nullptr) && (pEntry->payload != 0)) ? AllocSyncobj(pEntry->payload, 0, pSyncObj) : -EINVAL;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsSyncobjExportSyncFile(
+    amdgpu_device_handle hDevice,
+    uint32               syncObj,
+    int32*               pSyncFileFd)
+{
+    MutexAuto lock(&s_lock);
+
+    int32                   ret      = -EINVAL;
+    const FakePayload*const pPayload = GetPayload(syncObj);
+
+    if ((pPayload != nullptr) && (pPayload->completeNs != FakeNeverSignaled))
+    {
+        FakeSharedFd*const pEntry = AllocSharedFd();
+
+        if (pEntry != nullptr)
+        {
+            pEntry->isSyncFile = true;
+            pEntry->completeNs = pPayload->completeNs;
+            *pSyncFileFd       = pEntry->fd;
+            ret                = 0;
+        }
+        else
+        {
+            ret = -EMFILE;
+        }
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsSyncobjImportSyncFile(
+    amdgpu_device_handle hDevice,
+    uint32               syncObj,
+    int32                syncFileFd)
+{
+    MutexAuto lock(&s_lock);
+
+    int32                    ret      = -EINVAL;
+    FakePayload*const        pPayload = GetPayload(syncObj);
+    const FakeSharedFd*const pEntry   = FindSharedFd(syncFileFd);
+
+    if ((pPayload != nullptr) && (pEntry != nullptr) && pEntry->isSyncFile)
+    {
+        pPayload->completeNs = pEntry->completeNs;
+        ret                  = 0;
+
+        s_stateChanged.WakeAll();
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+// Waits on binary sync objects. The timeout is an absolute CLOCK_MONOTONIC deadline, as with the kernel ioctl.
+int32 FakeAmdgpuCsSyncobjWait(
+    amdgpu_device_handle hDevice,
+    uint32*              pHandles,
+    uint32               numHandles,
+    int64                timeoutInNs,
+    uint32               flags,
+    uint32*              pFirstSignaled)
+{
+    MutexAuto lock(&s_lock);
+
+    int32 ret = 0;
+
+    for (uint32 idx = 0; (ret == 0) && (idx < numHandles); ++idx)
+    {
+        const FakePayload*const pPayload = GetPayload(pHandles[idx]);
+
+        if ((pPayload == nullptr) ||
+            ((pPayload->completeNs == FakeNeverSignaled) && ((flags & DRM_SYNCOBJ_WAIT_FLAGS_WAIT_FOR_SUBMIT) == 0)))
+        {
+            ret = -EINVAL;
+        }
+    }
+
+    if (ret == 0)
+    {
+        const bool waitAll = ((flags & DRM_SYNCOBJ_WAIT_FLAGS_WAIT_ALL) != 0);
+        uint32     first   = 0;
+
+        // Sync objects without a fence report FakeNeverSignaled, so they wake us only through s_stateChanged.
+        const bool signaled = WaitUntil((timeoutInNs < 0) ? 0 : static_cast<uint64>(timeoutInNs),
+                                        [=, &first](uint64* pWakeNs)
+                                        {
+                                            const uint64 now        = NowNs();
+                                            uint64       earliestNs = FakeNeverSignaled;
+                                            uint64       latestNs   = 0;
+                                            uint32       pending    = 0;
+
+                                            for (uint32 idx = numHandles; idx > 0; --idx)
+                                            {
+                                                // A handle destroyed while we wait no longer holds anything back.
+                                                const FakePayload*const pPayload = GetPayload(pHandles[idx - 1]);
+                                                const uint64 completeNs = (pPayload != nullptr) ? pPayload->completeNs
+                                                                                                : 0;
+
+                                                if (completeNs <= now)
+                                                {
+                                                    first = idx - 1;
+                                                }
+                                                else
+                                                {
+                                                    pending++;
+                                                    earliestNs = Min(earliestNs, completeNs);
+                                                    latestNs   = Max(latestNs, completeNs);
+                                                }
+                                            }
+
+                                            *pWakeNs = waitAll ? latestNs : earliestNs;
+
+                                            return waitAll ? (pending == 0) : (pending < numHandles);
+                                        });
+
+        if (signaled == false)
+        {
+            ret = -ETIME;
+        }
+        else if (pFirstSignaled != nullptr)
+        {
+            *pFirstSignaled = first;
+        }
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsSyncobjReset(
+    amdgpu_device_handle hDevice,
+    const uint32*        pHandles,
+    uint32               numHandles)
+{
+    MutexAuto lock(&s_lock);
+
+    int32 ret = 0;
+
+    for (uint32 idx = 0; idx < numHandles; ++idx)
+    {
+        FakePayload*const pPayload = GetPayload(pHandles[idx]);
+
+        if (pPayload != nullptr)
+        {
+            pPayload->completeNs = FakeNeverSignaled;
+        }
+        else
+        {
+            ret = -EINVAL;
+        }
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeAmdgpuCsSyncobjSignal(
+    amdgpu_device_handle hDevice,
+    const uint32*        pHandles,
+    uint32               numHandles)
+{
+    MutexAuto lock(&s_lock);
+
+    int32 ret = 0;
+
+    for (uint32 idx = 0; idx < numHandles; ++idx)
+    {
+        FakePayload*const pPayload = GetPayload(pHandles[idx]);
+
+        if (pPayload != nullptr)
+        {
+            pPayload->completeNs = 0;
+        }
+        else
+        {
+            ret = -EINVAL;
+        }
+    }
+
+    s_stateChanged.WakeAll();
+
+    return ret;
+}
+
+// =====================================================================================================================
+// libdrm: device nodes and capabilities.
+// =====================================================================================================================
+
+// =====================================================================================================================
+drmVersionPtr FakeDrmGetVersion(
+    int fd)
+{
+    static const char KmdName[] = "amdgpu";
+
+    drmVersionPtr pVersion = static_cast<drmVersionPtr>(calloc(1, sizeof(drmVersion)));
+
+    if (pVersion != nullptr)
+    {
+        pVersion->version_major = 3;
+        pVersion->version_minor = 40;
+        pVersion->name_len      = sizeof(KmdName) - 1;
+        pVersion->name          = strdup(KmdName);
+        pVersion->date          = strdup("");
+        pVersion->desc          = strdup("");
+    }
+
+    return pVersion;
+}
+
+// =====================================================================================================================
+void FakeDrmFreeVersion(
+    drmVersionPtr v)
+{
+    if (v != nullptr)
+    {
+        free(v->name);
+        free(v->date);
+        free(v->desc);
+        free(v);
+    }
+}
+
+// =====================================================================================================================
+// Builds the description of the single fake device. All of its nodes are /dev/null, which any process can open.
+drmDevicePtr CreateFakeDrmDevice()
+{
+    // The device, its node table and bus/device info are carved out of one allocation, as libdrm does.
+    const size_t size = sizeof(drmDevice) + (DRM_NODE_MAX * sizeof(char*)) + sizeof(drmPciBusInfo) +
+                        sizeof(drmPciDeviceInfo);
+
+    drmDevicePtr pDevice = static_cast<drmDevicePtr>(calloc(1, size));
+
+    if (pDevice != nullptr)
+    {
+        char**const             ppNodes  = reinterpret_cast<char**>(pDevice + 1);
+        drmPciBusInfoPtr const  pBusInfo = reinterpret_cast<drmPciBusInfoPtr>(ppNodes + DRM_NODE_MAX);
+        drmPciDeviceInfoPtr const pDevInfo = reinterpret_cast<drmPciDeviceInfoPtr>(pBusInfo + 1);
+
+        ppNodes[DRM_NODE_PRIMARY] = const_cast<char*>("/dev/null");
+        ppNodes[DRM_NODE_RENDER]  = const_cast<char*>("/dev/null");
+
+        pBusInfo->bus = 3;
+
+        pDevInfo->vendor_id   = 0x1002;
+        pDevInfo->device_id   = DEVICE_ID_AI_VEGA10_P_6860;
+        pDevInfo->revision_id = 0xC1;
+
+        pDevice->nodes               = ppNodes;
+        pDevice->available_nodes     = (1 << DRM_NODE_PRIMARY) | (1 << DRM_NODE_RENDER);
+        pDevice->bustype             = DRM_BUS_PCI;
+        pDevice->businfo.pci         = pBusInfo;
+        pDevice->deviceinfo.pci      = pDevInfo;
+    }
+
+    return pDevice;
+}
+
+// =====================================================================================================================
+int32 FakeDrmGetDevices(
+    drmDevicePtr* pDevices,
+    int32         maxDevices)
+{
+    int32 count = 1;
+
+    if ((pDevices != nullptr) && (maxDevices > 0))
+    {
+        pDevices[0] = CreateFakeDrmDevice();
+        count       = (pDevices[0] != nullptr) ? 1 : -ENOMEM;
+    }
+
+    return count;
+}
+
+// =====================================================================================================================
+void FakeDrmFreeDevices(
+    drmDevicePtr* pDevices,
+    int32         count)
+{
+    for (int32 idx = 0; idx < count; ++idx)
+    {
+        free(pDevices[idx]);
+    }
+}
+
+// =====================================================================================================================
+int32 FakeDrmGetDevice2(
+    int           fd,
+    uint32_t      flags,
+    drmDevicePtr* pDevice)
+{
+    *pDevice = CreateFakeDrmDevice();
+
+    return (*pDevice != nullptr) ? 0 : -ENOMEM;
+}
+
+// =====================================================================================================================
+void FakeDrmFreeDevice(
+    drmDevicePtr* pDevice)
+{
+    free(*pDevice);
+    *pDevice = nullptr;
+}
+
+// =====================================================================================================================
+char* FakeDrmGetBusid(
+    int fd)
+{
+    return strdup("pci:0000:03:00.0");
+}
+
+// =====================================================================================================================
+void FakeDrmFreeBusid(
+    const char* pBusId)
+{
+    free(const_cast<char*>(pBusId));
+}
+
+// =====================================================================================================================
+int32 FakeDrmGetNodeTypeFromFd(
+    int fd)
+{
+    return DRM_NODE_RENDER;
+}
+
+// =====================================================================================================================
+char* FakeDrmGetRenderDeviceNameFromFd(
+    int fd)
+{
+    return strdup("/dev/null");
+}
+
+// =====================================================================================================================
+int32 FakeDrmGetCap(
+    int     fd,
+    uint64  capability,
+    uint64* pValue)
+{
+    int32 ret = 0;
+
+    if (capability == DRM_CAP_SYNCOBJ)
+    {
+        *pValue = 1;
+    }
+    else if (capability == DRM_CAP_SYNCOBJ_TIMELINE)
+    {
+        *pValue = 0;
+    }
+    else
+    {
+        ret = -EINVAL;
+    }
+
+    return ret;
+}
+
+// =====================================================================================================================
+int32 FakeDrmSetClientCap(
+    int    fd,
+    uint64 capability,
+    uint64 value)
+{
+    return 0;
+}
+
+// =====================================================================================================================
+int32 FakeDrmSyncobjCreate(
+    int     fd,
+    uint32  flags,
+    uint32* pHandle)
+{
+    return FakeAmdgpuCsCreateSyncobj2(&s_device, flags, pHandle);
+}
+
+// =====================================================================================================================
+drmModeResPtr FakeDrmModeGetResources(
+    int fd)
+{
+    // The fake device drives no displays.
+    return nullptr;
+}
+
+// =====================================================================================================================
+void FakeDrmModeFreeResources(
+    drmModeResPtr ptr)
+{
+}
+
+// =====================================================================================================================
+int32 FakeDrmDropMaster(
+    int32 fd)
+{
+    return 0;
+}
+
+} // anonymous namespace
+
+namespace Pal
+{
+namespace Amdgpu
+{
+
+// =====================================================================================================================
+// Fills the loader's function table with the fake entry points. Entry points the fake doesn't implement are left null
+// so that the corresponding features are reported as unsupported.
+void InitFakeDrmProcs(
+    DrmLoaderFuncs* pFuncs)
+{
+    const char*const pLatency = getenv("PAL_FAKE_DRM_SUBMIT_LATENCY_NS");
+
+    if (pLatency != nullptr)
+    {
+        SetFakeDrmSubmitLatency(strtoull(pLatency, nullptr, 10));
+    }
+
+    memset(pFuncs, 0, sizeof(*pFuncs));
+
+    pFuncs->pfnAmdgpuQueryHwIpInfo            = FakeAmdgpuQueryHwIpInfo;
+    pFuncs->pfnAmdgpuBoVaOp                   = FakeAmdgpuBoVaOp;
+    pFuncs->pfnAmdgpuBoVaOpRaw                = FakeAmdgpuBoVaOpRaw;
+    pFuncs->pfnAmdgpuGetMarketingName         = FakeAmdgpuGetMarketingName;
+    pFuncs->pfnAmdgpuVaRangeFree              = FakeAmdgpuVaRangeFree;
+    pFuncs->pfnAmdgpuVaRangeQuery             = FakeAmdgpuVaRangeQuery;
+    pFuncs->pfnAmdgpuVaRangeAlloc             = FakeAmdgpuVaRangeAlloc;
+    pFuncs->pfnAmdgpuReadMmRegisters          = FakeAmdgpuReadMmRegisters;
+    pFuncs->pfnAmdgpuDeviceInitialize         = FakeAmdgpuDeviceInitialize;
+    pFuncs->pfnAmdgpuDeviceDeinitialize       = FakeAmdgpuDeviceDeinitialize;
+    pFuncs->pfnAmdgpuBoAlloc                  = FakeAmdgpuBoAlloc;
+    pFuncs->pfnAmdgpuBoSetMetadata            = FakeAmdgpuBoSetMetadata;
+    pFuncs->pfnAmdgpuBoQueryInfo              = FakeAmdgpuBoQueryInfo;
+    pFuncs->pfnAmdgpuBoExport                 = FakeAmdgpuBoExport;
+    pFuncs->pfnAmdgpuBoImport                 = FakeAmdgpuBoImport;
+    pFuncs->pfnAmdgpuCreateBoFromUserMem      = FakeAmdgpuCreateBoFromUserMem;
+    pFuncs->pfnAmdgpuBoFree                   = FakeAmdgpuBoFree;
+    pFuncs->pfnAmdgpuBoCpuMap                 = FakeAmdgpuBoCpuMap;
+    pFuncs->pfnAmdgpuBoCpuUnmap               = FakeAmdgpuBoCpuUnmap;
+    pFuncs->pfnAmdgpuBoWaitForIdle            = FakeAmdgpuBoWaitForIdle;
+    pFuncs->pfnAmdgpuBoListCreate             = FakeAmdgpuBoListCreate;
+    pFuncs->pfnAmdgpuBoListDestroy            = FakeAmdgpuBoListDestroy;
+    pFuncs->pfnAmdgpuBoListUpdate             = FakeAmdgpuBoListUpdate;
+    pFuncs->pfnAmdgpuCsCtxCreate              = FakeAmdgpuCsCtxCreate;
+    pFuncs->pfnAmdgpuCsCtxFree                = FakeAmdgpuCsCtxFree;
+    pFuncs->pfnAmdgpuCsSubmit                 = FakeAmdgpuCsSubmit;
+    pFuncs->pfnAmdgpuCsQueryFenceStatus       = FakeAmdgpuCsQueryFenceStatus;
+    pFuncs->pfnAmdgpuCsWaitFences             = FakeAmdgpuCsWaitFences;
+    pFuncs->pfnAmdgpuQueryBufferSizeAlignment = FakeAmdgpuQueryBufferSizeAlignment;
+    pFuncs->pfnAmdgpuQueryFirmwareVersion     = FakeAmdgpuQueryFirmwareVersion;
+    pFuncs->pfnAmdgpuQueryHwIpCount           = FakeAmdgpuQueryHwIpCount;
+    pFuncs->pfnAmdgpuQueryHeapInfo            = FakeAmdgpuQueryHeapInfo;
+    pFuncs->pfnAmdgpuQueryGpuInfo             = FakeAmdgpuQueryGpuInfo;
+    pFuncs->pfnAmdgpuQuerySensorInfo          = FakeAmdgpuQuerySensorInfo;
+    pFuncs->pfnAmdgpuQueryInfo                = FakeAmdgpuQueryInfo;
+    pFuncs->pfnAmdgpuCsReservedVmid           = FakeAmdgpuCsReservedVmid;
+    pFuncs->pfnAmdgpuCsUnreservedVmid         = FakeAmdgpuCsUnreservedVmid;
+    pFuncs->pfnAmdgpuCsCreateSyncobj          = FakeAmdgpuCsCreateSyncobj;
+    pFuncs->pfnAmdgpuCsCreateSyncobj2         = FakeAmdgpuCsCreateSyncobj2;
+    pFuncs->pfnAmdgpuCsDestroySyncobj         = FakeAmdgpuCsDestroySyncobj;
+    pFuncs->pfnAmdgpuCsExportSyncobj          = FakeAmdgpuCsExportSyncobj;
+    pFuncs->pfnAmdgpuCsImportSyncobj          = FakeAmdgpuCsImportSyncobj;
+    pFuncs->pfnAmdgpuCsSubmitRaw              = FakeAmdgpuCsSubmitRaw;
+    pFuncs->pfnAmdgpuCsSubmitRaw2             = FakeAmdgpuCsSubmitRaw2;
+    pFuncs->pfnAmdgpuCsSyncobjImportSyncFile  = FakeAmdgpuCsSyncobjImportSyncFile;
+    pFuncs->pfnAmdgpuCsSyncobjExportSyncFile  = FakeAmdgpuCsSyncobjExportSyncFile;
+    pFuncs->pfnAmdgpuCsSyncobjWait            = FakeAmdgpuCsSyncobjWait;
+    pFuncs->pfnAmdgpuCsSyncobjReset           = FakeAmdgpuCsSyncobjReset;
+    pFuncs->pfnAmdgpuCsSyncobjSignal          = FakeAmdgpuCsSyncobjSignal;
+    pFuncs->pfnAmdgpuCsCtxCreate2             = FakeAmdgpuCsCtxCreate2;
+    pFuncs->pfnAmdgpuCsCtxCreate3             = FakeAmdgpuCsCtxCreate3;
+    pFuncs->pfnDrmGetVersion                  = FakeDrmGetVersion;
+    pFuncs->pfnDrmFreeVersion                 = FakeDrmFreeVersion;
+    pFuncs->pfnDrmGetNodeTypeFromFd           = FakeDrmGetNodeTypeFromFd;
+    pFuncs->pfnDrmGetRenderDeviceNameFromFd   = FakeDrmGetRenderDeviceNameFromFd;
+    pFuncs->pfnDrmGetDevices                  = FakeDrmGetDevices;
+    pFuncs->pfnDrmFreeDevices                 = FakeDrmFreeDevices;
+    pFuncs->pfnDrmGetDevice2                  = FakeDrmGetDevice2;
+    pFuncs->pfnDrmFreeDevice                  = FakeDrmFreeDevice;
+    pFuncs->pfnDrmGetBusid                    = FakeDrmGetBusid;
+    pFuncs->pfnDrmFreeBusid                   = FakeDrmFreeBusid;
+    pFuncs->pfnDrmModeGetResources            = FakeDrmModeGetResources;
+    pFuncs->pfnDrmModeFreeResources           = FakeDrmModeFreeResources;
+    pFuncs->pfnDrmGetCap                      = FakeDrmGetCap;
+    pFuncs->pfnDrmSetClientCap                = FakeDrmSetClientCap;
+    pFuncs->pfnDrmSyncobjCreate               = FakeDrmSyncobjCreate;
+    pFuncs->pfnDrmDropMaster                  = FakeDrmDropMaster;
+}
+
+// =====================================================================================================================
+// Sets the simulated execution time of every subsequent submission.
+void SetFakeDrmSubmitLatency(
+    uint64 nanoseconds)
+{
+    MutexAuto lock(&s_lock);
+
+    s_submitLatencyNs = nanoseconds;
+}
+
+// =====================================================================================================================
+// Copies up to maxBos of the buffers referenced by the most recent successful submission into pBos, in list order.
+uint32 GetFakeDrmLastSubmitBos(
+    amdgpu_bo_handle* pBos,
+    uint32            maxBos)
+{
+    MutexAuto lock(&s_lock);
+
+    memcpy(pBos, s_lastSubmitBoList.pBos, Min(maxBos, s_lastSubmitBoList.count) * sizeof(amdgpu_bo_handle));
+
+    return s_lastSubmitBoList.count;
+}
+
+} // Amdgpu
+} // Pal
@@ -0,0 +1,59 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2015-2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "pal.h"
+#include "core/os/amdgpu/g_drmLoader.h"
+
+namespace Pal
+{
+namespace Amdgpu
+{
+
+// =====================================================================================================================
+// An in-process stand-in for libdrm and libdrm_amdgpu which lets the amdgpu back-end run on machines without an AMD
+// GPU. It is only compiled when PAL is built with PAL_BUILD_FAKE_DRM, in which case the DrmLoader fills its function table
+// from here instead of loading the real libraries.
+//
+// The fake reports a single Vega10 device whose render and primary nodes are /dev/null. Buffer objects are backed by
+// host memory, contexts keep a sequence number timeline per ring, and sync objects carry the simulated completion time
+// of the submission which last signaled them. Every submission "executes" for a fixed simulated latency after its
+// dependencies and the previous submission on its ring have completed, so fence and sync object waits block for as long
+// as the simulated GPU would keep them busy. Display and legacy semaphore entry points are left unresolved.
+
+// Points every simulated entry of the given function table at the fake implementation.
+extern void InitFakeDrmProcs(DrmLoaderFuncs* pFuncs);
+
+// Sets the simulated GPU execution time of each subsequent submission. Defaults to the value of the
+// PAL_FAKE_DRM_SUBMIT_LATENCY_NS environment variable, or zero, meaning work completes as soon as it is submitted.
+extern void SetFakeDrmSubmitLatency(uint64 nanoseconds);
+
+// Copies up to maxBos of the buffers in the resource list of the most recent successful submission into pBos. Returns
+// the number of buffers in that list, which may be larger than maxBos.
+extern uint32 GetFakeDrmLastSubmitBos(amdgpu_bo_handle* pBos, uint32 maxBos);
+
+} // Amdgpu
+} // Pal
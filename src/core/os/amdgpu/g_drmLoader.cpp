@@ -37,6 +37,9 @@
 #include "core/os/amdgpu/g_drmLoader.h"
 #include "palAssert.h"
 #include "palSysUtil.h"
+#if PAL_HAVE_FAKE_DRM
+#include "core/os/amdgpu/fakeDrm/fakeDrm.h"
+#endif
 
 #include <dlfcn.h>
 #include <time.h>
@@ -1008,6 +1011,35 @@ int32 DrmLoaderFuncsProxy::pfnAmdgpuBoListDestroy(
     return ret;
 }
 
+// =====================================================================================================================
+int32 DrmLoaderFuncsProxy::pfnAmdgpuBoListUpdate(
+    amdgpu_bo_list_handle  hBoList,
+    uint32                 numberOfResources,
+    amdgpu_bo_handle*      pResources,
+    uint8*                 pResourcePriorities
+    ) const
+{
+    const int64 begin = Util::GetPerfCpuTime();
+    int32 ret = m_pFuncs->pfnAmdgpuBoListUpdate(hBoList,
+                                                numberOfResources,
+                                                pResources,
+                                                pResourcePriorities);
+    const int64 end = Util::GetPerfCpuTime();
+    const int64 elapse = end - begin;
+    m_timeLogger.Printf("AmdgpuBoListUpdate,%ld,%ld,%ld\n", begin, end, elapse);
+    m_timeLogger.Flush();
+
+    m_paramLogger.Printf(
+        "AmdgpuBoListUpdate(%p, %x, %p, %p)\n",
+        hBoList,
+        numberOfResources,
+        pResources,
+        pResourcePriorities);
+    m_paramLogger.Flush();
+
+    return ret;
+}
+
 // =====================================================================================================================
 int32 DrmLoaderFuncsProxy::pfnAmdgpuCsCtxCreate(
     amdgpu_device_handle    hDevice,
@@ -3266,6 +3298,7 @@ Result DrmLoader::Init(
             m_library[LibDrmAmdgpu].GetFunction("amdgpu_bo_wait_for_idle", &m_funcs.pfnAmdgpuBoWaitForIdle);
             m_library[LibDrmAmdgpu].GetFunction("amdgpu_bo_list_create", &m_funcs.pfnAmdgpuBoListCreate);
             m_library[LibDrmAmdgpu].GetFunction("amdgpu_bo_list_destroy", &m_funcs.pfnAmdgpuBoListDestroy);
+            m_library[LibDrmAmdgpu].GetFunction("amdgpu_bo_list_update", &m_funcs.pfnAmdgpuBoListUpdate);
             m_library[LibDrmAmdgpu].GetFunction("amdgpu_cs_ctx_create", &m_funcs.pfnAmdgpuCsCtxCreate);
             m_library[LibDrmAmdgpu].GetFunction("amdgpu_cs_ctx_free", &m_funcs.pfnAmdgpuCsCtxFree);
             m_library[LibDrmAmdgpu].GetFunction("amdgpu_cs_submit", &m_funcs.pfnAmdgpuCsSubmit);
@@ -3377,6 +3410,14 @@ void DrmLoader::SpecializedInit(
     Platform* pPlatform,
     char*     pDtifLibName)
 {
+#if PAL_HAVE_FAKE_DRM
+    // Offline builds resolve every entry point to the in-process fake instead of loading libdrm.
+    InitFakeDrmProcs(&m_funcs);
+    m_initialized = true;
+#if defined(PAL_DEBUG_PRINTS)
+    m_proxy.SetFuncCalls(&m_funcs);
+#endif
+#endif
 }
 
 } // Linux
@@ -232,6 +232,12 @@ typedef int32 (*AmdgpuBoListCreate)(
 typedef int32 (*AmdgpuBoListDestroy)(
             amdgpu_bo_list_handle     hBoList);
 
+typedef int32 (*AmdgpuBoListUpdate)(
+            amdgpu_bo_list_handle     hBoList,
+            uint32                    numberOfResources,
+            amdgpu_bo_handle*         pResources,
+            uint8*                    pResourcePriorities);
+
 typedef int32 (*AmdgpuCsCtxCreate)(
             amdgpu_device_handle      hDevice,
             amdgpu_context_handle*    pContextHandle);
@@ -874,6 +880,12 @@ struct DrmLoaderFuncs
         return (pfnAmdgpuBoListDestroy != nullptr);
     }
 
+    AmdgpuBoListUpdate                pfnAmdgpuBoListUpdate;
+    bool pfnAmdgpuBoListUpdateisValid() const
+    {
+        return (pfnAmdgpuBoListUpdate != nullptr);
+    }
+
     AmdgpuCsCtxCreate                 pfnAmdgpuCsCtxCreate;
     bool pfnAmdgpuCsCtxCreateisValid() const
     {
@@ -1774,6 +1786,17 @@ public:
         return (m_pFuncs->pfnAmdgpuBoListDestroy != nullptr);
     }
 
+    int32 pfnAmdgpuBoListUpdate(
+            amdgpu_bo_list_handle     hBoList,
+            uint32                    numberOfResources,
+            amdgpu_bo_handle*         pResources,
+            uint8*                    pResourcePriorities) const;
+
+    bool pfnAmdgpuBoListUpdateisValid() const
+    {
+        return (m_pFuncs->pfnAmdgpuBoListUpdate != nullptr);
+    }
+
     int32 pfnAmdgpuCsCtxCreate(
             amdgpu_device_handle      hDevice,
             amdgpu_context_handle*    pContextHandle) const;
@@ -27,7 +27,7 @@
 #include "core/presentScheduler.h"
 #include "core/queue.h"
 #include "core/swapChain.h"
-#include "palIntrusiveListImpl.h"
+#include "palSysUtil.h"
 using namespace Util;
 
 namespace Pal
@@ -88,7 +88,6 @@ void PresentSchedulerJob::DestroyInternal(
 // =====================================================================================================================
 PresentSchedulerJob::PresentSchedulerJob()
     :
-    m_node(this),
 #if !defined(__unix__)
     m_pPriorWorkFence(nullptr),
 #endif
@@ -109,12 +108,118 @@ PresentSchedulerJob::~PresentSchedulerJob()
 #endif
 }
 
+// =====================================================================================================================
+PresentJobQueue::PresentJobQueue()
+    :
+    m_pushPos(0),
+    m_popPos(0)
+{
+    static_assert(Util::IsPowerOfTwo(Capacity), "The ring indexing assumes a power of two capacity.");
+
+    for (uint32 idx = 0; idx < Capacity; ++idx)
+    {
+        m_slots[idx].sequence = idx;
+        m_slots[idx].pJob     = nullptr;
+    }
+}
+
+// =====================================================================================================================
+// Claims the slot at the push position and publishes the job into it. The sequence is written with a full barrier after
+// the job pointer so a consumer which observes the new sequence is guaranteed to also observe the job.
+bool PresentJobQueue::Push(
+    PresentSchedulerJob* pJob)
+{
+    bool   pushed = false;
+    bool   full   = false;
+    uint32 pos    = m_pushPos;
+
+    while ((pushed == false) && (full == false))
+    {
+        Slot*const  pSlot = &m_slots[pos & (Capacity - 1)];
+        const int32 diff  = static_cast<int32>(pSlot->sequence - pos);
+
+        if (diff == 0)
+        {
+            // The slot is free for this position; try to claim it.
+            const uint32 prevPos = AtomicCompareAndSwap(&m_pushPos, pos, pos + 1);
+
+            if (prevPos == pos)
+            {
+                pSlot->pJob = pJob;
+                AtomicExchange(&pSlot->sequence, pos + 1);
+                pushed = true;
+            }
+            else
+            {
+                pos = prevPos;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The consumer hasn't released this slot from the previous lap yet.
+            full = true;
+        }
+        else
+        {
+            // Another producer claimed this position first.
+            pos = m_pushPos;
+        }
+    }
+
+    return pushed;
+}
+
+// =====================================================================================================================
+// Claims the slot at the pop position and returns its job, releasing the slot for the producer one lap ahead.
+PresentSchedulerJob* PresentJobQueue::Pop()
+{
+    PresentSchedulerJob* pJob  = nullptr;
+    bool                 empty = false;
+    uint32               pos   = m_popPos;
+
+    while ((pJob == nullptr) && (empty == false))
+    {
+        Slot*const  pSlot = &m_slots[pos & (Capacity - 1)];
+        const int32 diff  = static_cast<int32>(pSlot->sequence - (pos + 1));
+
+        if (diff == 0)
+        {
+            // The slot was published for this position; try to claim it.
+            const uint32 prevPos = AtomicCompareAndSwap(&m_popPos, pos, pos + 1);
+
+            if (prevPos == pos)
+            {
+                pJob = pSlot->pJob;
+                AtomicExchange(&pSlot->sequence, pos + Capacity);
+            }
+            else
+            {
+                pos = prevPos;
+            }
+        }
+        else if (diff < 0)
+        {
+            // No producer has published this position yet.
+            empty = true;
+        }
+        else
+        {
+            // Another consumer claimed this position first.
+            pos = m_popPos;
+        }
+    }
+
+    return pJob;
+}
+
 // =====================================================================================================================
 PresentScheduler::PresentScheduler(
     Device* pDevice)
     :
     m_pDevice(pDevice),
     m_pSignalQueue(nullptr),
+    m_workerSleeping(0),
+    m_enqueueWaiters(0),
     m_workerActive(false)
 {
     for (uint32 deviceIndex = 0; deviceIndex < XdmaMaxDevices; deviceIndex++)
@@ -161,17 +266,13 @@ PresentScheduler::~PresentScheduler()
         }
     }
 
-    for (auto iter = m_idleJobList.Begin(); iter.IsValid(); )
+    for (PresentSchedulerJob* pJob = m_idleJobs.Pop(); pJob != nullptr; pJob = m_idleJobs.Pop())
     {
-        PresentSchedulerJob*const pJob = iter.Get();
-        m_idleJobList.Erase(&iter);
         pJob->DestroyInternal(m_pDevice);
     }
 
-    for (auto iter = m_activeJobList.Begin(); iter.IsValid(); )
+    for (PresentSchedulerJob* pJob = m_activeJobs.Pop(); pJob != nullptr; pJob = m_activeJobs.Pop())
     {
-        PresentSchedulerJob*const pJob = iter.Get();
-        m_activeJobList.Erase(&iter);
         pJob->DestroyInternal(m_pDevice);
     }
 }
@@ -193,6 +294,11 @@ Result PresentScheduler::Init(
         result = m_workerThreadNotify.Init(Semaphore::MaximumCountLimit, 0);
     }
 
+    if (result == Result::Success)
+    {
+        result = m_jobSlotSemaphore.Init(Semaphore::MaximumCountLimit, 0);
+    }
+
     return result;
 }
 
@@ -416,33 +522,64 @@ Result PresentScheduler::WaitIdle()
 Result PresentScheduler::GetIdleJob(
     PresentSchedulerJob** ppJob)
 {
-    Result    result = Result::Success;
-    MutexAuto lock(&m_idleJobMutex);
+    Result                     result = Result::Success;
+    PresentSchedulerJob*const  pJob   = m_idleJobs.Pop();
 
-    if (m_idleJobList.IsEmpty())
+    if (pJob == nullptr)
     {
         result = PresentSchedulerJob::CreateInternal(m_pDevice, ppJob);
     }
     else
     {
-        *ppJob = m_idleJobList.Front();
-        m_idleJobList.Erase((*ppJob)->ListNode());
+        *ppJob = pJob;
     }
 
     return result;
 }
 
 // =====================================================================================================================
-// A thread-safe helper function to add the given job to the job queue and signal the job semaphore.
+// A thread-safe helper function to return a finished job to the idle pool. Jobs beyond what the pool can hold are only
+// created when the application outpaces the worker thread by a wide margin, so they're simply destroyed.
+void PresentScheduler::RecycleJob(
+    PresentSchedulerJob* pJob)
+{
+    if (m_idleJobs.Push(pJob) == false)
+    {
+        pJob->DestroyInternal(m_pDevice);
+    }
+}
+
+// =====================================================================================================================
+// A thread-safe helper function to add the given job to the job queue and wake the worker thread if it's asleep.
 void PresentScheduler::EnqueueJob(
     PresentSchedulerJob* pJob)
 {
-    m_activeJobMutex.Lock();
-    m_activeJobList.PushBack(pJob->ListNode());
-    m_activeJobMutex.Unlock();
+    bool pushed = m_activeJobs.Push(pJob);
 
-    // Post after we unlock the mutex to prevent the worker thread from blocking if it wakes up too quickly.
-    m_activeJobSemaphore.Post();
+    while (pushed == false)
+    {
+        // The queue is full. Announce that we're waiting for a free slot and then try one more time before blocking.
+        // The increment is a full barrier so either our retry observes the worker's pop or the worker observes our
+        // announcement and posts the semaphore; a stale post only costs us one extra loop.
+        AtomicIncrement(&m_enqueueWaiters);
+
+        pushed = m_activeJobs.Push(pJob);
+
+        if (pushed == false)
+        {
+            const Result result = m_jobSlotSemaphore.Wait(UINT32_MAX);
+            PAL_ASSERT(IsErrorResult(result) == false);
+        }
+
+        AtomicDecrement(&m_enqueueWaiters);
+    }
+
+    // Only pay for a semaphore post if the worker thread announced that it's going to sleep. The exchange is a full
+    // barrier so either we observe the worker's announcement or the worker's final check of the queue observes our job.
+    if (AtomicExchange(&m_workerSleeping, 0) != 0)
+    {
+        m_activeJobSemaphore.Post();
+    }
 }
 
 // =====================================================================================================================
@@ -451,24 +588,40 @@ void PresentScheduler::RunWorkerThread()
 {
     while (true)
     {
-        // Sleep until we have a job to process.
-        const Result result = m_activeJobSemaphore.Wait(UINT32_MAX);
-        PAL_ASSERT(IsErrorResult(result) == false);
+        PresentSchedulerJob* pJob = m_activeJobs.Pop();
 
-        if (result == Result::Success)
+        if (pJob == nullptr)
         {
-            m_activeJobMutex.Lock();
-            PresentSchedulerJob*const pJob = m_activeJobList.Front();
-            m_activeJobList.Erase(pJob->ListNode());
+            // Announce that we're about to sleep and then check the queue one more time. Any job pushed after this
+            // check will see the announcement and post the semaphore; a stale post only costs us one extra loop.
+            AtomicExchange(&m_workerSleeping, 1);
 
-            m_activeJobMutex.Unlock();
+            pJob = m_activeJobs.Pop();
 
+            if (pJob == nullptr)
+            {
+                // Sleep until we have a job to process.
+                const Result result = m_activeJobSemaphore.Wait(UINT32_MAX);
+                PAL_ASSERT(IsErrorResult(result) == false);
+            }
+            else
+            {
+                AtomicExchange(&m_workerSleeping, 0);
+            }
+        }
+
+        // Every pop frees a slot, so wake one application thread which is blocked on a full queue.
+        if ((pJob != nullptr) && (m_enqueueWaiters != 0))
+        {
+            m_jobSlotSemaphore.Post();
+        }
+
+        if (pJob != nullptr)
+        {
             switch (pJob->GetType())
             {
             case PresentJobType::Terminate:
-                m_idleJobMutex.Lock();
-                m_idleJobList.PushBack(pJob->ListNode());
-                m_idleJobMutex.Unlock();
+                RecycleJob(pJob);
 
                 // We've been asked to kill this thread.
                 m_workerActive = false;
@@ -476,9 +629,7 @@ void PresentScheduler::RunWorkerThread()
                 break;
 
             case PresentJobType::Notify:
-                m_idleJobMutex.Lock();
-                m_idleJobList.PushBack(pJob->ListNode());
-                m_idleJobMutex.Unlock();
+                RecycleJob(pJob);
 
                 m_workerThreadNotify.Post();
                 break;
@@ -499,9 +650,7 @@ void PresentScheduler::RunWorkerThread()
                     PAL_ALERT(IsErrorResult(presentResult));
                 }
 
-                m_idleJobMutex.Lock();
-                m_idleJobList.PushBack(pJob->ListNode());
-                m_idleJobMutex.Unlock();
+                RecycleJob(pJob);
                 break;
 
             default:
@@ -25,7 +25,6 @@
 
 #pragma once
 
-#include "palIntrusiveList.h"
 #include "palMutex.h"
 #include "palQueue.h"
 #include "palSemaphore.h"
@@ -51,13 +50,10 @@ enum class PresentJobType : uint32
 // the opportunity to place an instance of this class into preallocated memory.
 class PresentSchedulerJob
 {
-    typedef Util::IntrusiveListNode<PresentSchedulerJob> Node;
-
 public:
     static Result CreateInternal(Device* pDevice, PresentSchedulerJob** ppPresentSchedulerJob);
     void DestroyInternal(Device* pDevice);
 
-    Node* ListNode() { return &m_node; }
 #if !defined(__unix__)
     IFence* PriorWorkFence() { return m_pPriorWorkFence; }
 #endif
@@ -74,7 +70,6 @@ private:
     PresentSchedulerJob();
     ~PresentSchedulerJob();
 
-    Node                 m_node;            // The present scheduler maintains intrusive lists of jobs.
 #if !defined(__unix__)
     IFence*              m_pPriorWorkFence; // Signaled when the application's work prior to this present has completed.
 #endif
@@ -83,6 +78,37 @@ private:
     IQueue*              m_pQueue;          // Internal queue of the same device as the original presentation queue.
 };
 
+// =====================================================================================================================
+// A bounded, lock-free ring of job pointers which any number of threads may push to and pop from concurrently. Each
+// slot carries a sequence number which tells producers and consumers whose turn it is to touch the slot, so a thread
+// only ever contends on a single compare-and-swap of the push or pop position and never blocks another thread.
+class PresentJobQueue
+{
+public:
+    PresentJobQueue();
+
+    // Returns false if the ring is full.
+    bool Push(PresentSchedulerJob* pJob);
+
+    // Returns null if the ring is empty.
+    PresentSchedulerJob* Pop();
+
+    static constexpr uint32 Capacity = 64; // Must be a power of two.
+
+private:
+    struct Slot
+    {
+        volatile uint32      sequence; // Equal to the push position when free, or the push position + 1 when full.
+        PresentSchedulerJob* pJob;
+    };
+
+    Slot            m_slots[Capacity];
+    volatile uint32 m_pushPos; // Total number of pushes which have claimed a slot.
+    volatile uint32 m_popPos;  // Total number of pops which have claimed a slot.
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(PresentJobQueue);
+};
+
 // =====================================================================================================================
 // A present scheduler consumes a stream of swap chain presentation requests, ensuring that each present is processed
 // in order and executed to spec. Depending on the features and limitations of the HW and OS, the present scheduler may
@@ -90,8 +116,6 @@ private:
 // swap chain present modes require CPU-side synchronization so an internal thread may be used to hide the stalls.
 class PresentScheduler
 {
-    typedef Util::IntrusiveList<PresentSchedulerJob> JobList;
-
 public:
     // Present schedulers use the Create/Destroy pattern. The Create functions are in the OS-specific classes.
     void Destroy() { this->~PresentScheduler(); }
@@ -131,16 +155,18 @@ protected:
 
 private:
     Result GetIdleJob(PresentSchedulerJob** ppJob);
+    void RecycleJob(PresentSchedulerJob* pJob);
     void EnqueueJob(PresentSchedulerJob* pJob);
 
     // All of this state is used to store and process asynchronous presentation requests. If all presents can be inlined
     // none of it will be used and the worker thread will never be started.
 
-    JobList         m_idleJobList;        // Idle job objects which are waiting to be reused.
-    Util::Mutex     m_idleJobMutex;       // Protects access to m_idleJobList.
-    JobList         m_activeJobList;      // Passes jobs from application threads to the worker thread.
-    Util::Mutex     m_activeJobMutex;     // Protects access to m_activeJobList.
-    Util::Semaphore m_activeJobSemaphore; // Signaled when a job is added to m_activeJobList.
+    PresentJobQueue m_idleJobs;           // Idle job objects which are waiting to be reused.
+    PresentJobQueue m_activeJobs;         // Passes jobs from application threads to the worker thread.
+    volatile uint32 m_workerSleeping;     // Non-zero if the worker thread may be blocked on m_activeJobSemaphore.
+    Util::Semaphore m_activeJobSemaphore; // Signaled when a job is added to m_activeJobs while the worker sleeps.
+    volatile uint32 m_enqueueWaiters;     // Number of application threads which may be blocked on m_jobSlotSemaphore.
+    Util::Semaphore m_jobSlotSemaphore;   // Signaled when the worker pops a job while m_enqueueWaiters is non-zero.
     Util::Semaphore m_workerThreadNotify; // Signaled when the worker thread completes a Notify job.
     Util::Thread    m_workerThread;       // The driver thread that executes presents later on.
     volatile bool   m_workerActive;       // If the driver thread has been created.
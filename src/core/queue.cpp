@@ -24,6 +24,7 @@
  **********************************************************************************************************************/
 
 #include "core/cmdBuffer.h"
+#include "core/cmdDumpWriter.h"
 #include "core/fence.h"
 #include "core/cmdStream.h"
 #include "core/device.h"
@@ -57,6 +58,63 @@ struct CmdDumpToFilePayload
     const PalSettings*  pSettings;
 };
 
+// Struct for passing the destination buffer and pal setting pointers to the command buffer dump callback used for
+// asynchronous dumps.
+struct CmdDumpToBufferPayload
+{
+    uint8*              pBuffer;    // Destination for the chunks, or null to only measure them.
+    size_t              offset;     // Number of bytes written (or measured) so far.
+    uint32              numChunks;  // Number of chunks written (or measured) so far.
+    const PalSettings*  pSettings;
+};
+
+// =====================================================================================================================
+// Helper function which returns the subengine ID recorded in the headers of a binary dump of a command buffer.
+static uint32 GetCmdDumpSubEngineId(
+    const CmdBufferDumpDesc& cmdBufferDesc)
+{
+    uint32 subEngineId = 0; // DE subengine ID
+
+    if (cmdBufferDesc.subEngineType == SubEngineType::ConstantEngine)
+    {
+        if (cmdBufferDesc.flags.isPreamble == true)
+        {
+            subEngineId = 2; // CE preamble subengine ID
+        }
+        else
+        {
+            subEngineId = 1; // CE subengine ID
+        }
+    }
+    else if (cmdBufferDesc.engineType == EngineType::EngineTypeCompute)
+    {
+        subEngineId = 3; // Compute subengine ID
+    }
+    else if (cmdBufferDesc.engineType == EngineType::EngineTypeDma)
+    {
+        subEngineId = 4; // SDMA engine ID
+    }
+
+    return subEngineId;
+}
+
+// =====================================================================================================================
+// Helper function which builds the file header of a binary dump of command buffers with PM4 headers.
+static CmdBufferDumpFileHeader GetCmdDumpFileHeader(
+    const Device& device)
+{
+    const CmdBufferDumpFileHeader fileHeader =
+    {
+        static_cast<uint32>(sizeof(CmdBufferDumpFileHeader)), // Structure size
+        1,                                                    // Header version
+        device.ChipProperties().familyId,                     // ASIC family
+        device.ChipProperties().eRevId,                       // ASIC revision
+        0                                                     // Reserved
+    };
+
+    return fileHeader;
+}
+
 // =====================================================================================================================
 // Helper fuction for writing out the header of a text dump of a command buffer.
 static Result WriteCmdBufferDumpHeaderToFile(
@@ -146,27 +204,7 @@ static void PAL_STDCALL WriteCmdDumpToFile(
         result = WriteCmdBufferDumpHeaderToFile(cmdBufferDesc, pLogFile, sizeOfBufferInDwords);
     }
 
-    uint32 subEngineId = 0; // DE subengine ID
-
-    if (cmdBufferDesc.subEngineType == SubEngineType::ConstantEngine)
-    {
-        if (cmdBufferDesc.flags.isPreamble == true)
-        {
-            subEngineId = 2; // CE preamble subengine ID
-        }
-        else
-        {
-            subEngineId = 1; // CE subengine ID
-        }
-    }
-    else if (cmdBufferDesc.engineType == EngineType::EngineTypeCompute)
-    {
-        subEngineId = 3; // Compute subengine ID
-    }
-    else if (cmdBufferDesc.engineType == EngineType::EngineTypeDma)
-    {
-        subEngineId = 4; // SDMA engine ID
-    }
+    const uint32 subEngineId = GetCmdDumpSubEngineId(cmdBufferDesc);
 
     // Next, walk through all the chunks that make up this command stream and write their command to the file.
     for (uint32 index = 0; index < numChunks; ++index)
@@ -209,6 +247,52 @@ static void PAL_STDCALL WriteCmdDumpToFile(
     // operation of the "important" stuff...  but still make it apparent that the dump file isn't accurate.
     PAL_ALERT(result != Result::Success);
 }
+
+// =====================================================================================================================
+// Callback function for copying command buffers into the memory of an asynchronous binary dump. If the payload has no
+// buffer, this only measures how much memory the dump needs.
+static void PAL_STDCALL WriteCmdDumpToBuffer(
+    const CmdBufferDumpDesc&        cmdBufferDesc,
+    const CmdBufferChunkDumpDesc*   pChunks,
+    uint32                          numChunks,
+    void*                           pUserData)
+{
+    CmdDumpToBufferPayload* pPayload = reinterpret_cast<CmdDumpToBufferPayload*>(pUserData);
+
+    const CmdBufDumpFormat dumpFormat = pPayload->pSettings->cmdBufDumpFormat;
+    const uint32           subEngineId = GetCmdDumpSubEngineId(cmdBufferDesc);
+
+    PAL_ASSERT((dumpFormat == CmdBufDumpFormat::CmdBufDumpFormatBinary) ||
+               (dumpFormat == CmdBufDumpFormat::CmdBufDumpFormatBinaryHeaders));
+
+    for (uint32 index = 0; index < numChunks; ++index)
+    {
+        const CmdBufferChunkDumpDesc& chunkDesc = pChunks[index];
+
+        if (dumpFormat == CmdBufDumpFormat::CmdBufDumpFormatBinaryHeaders)
+        {
+            if (pPayload->pBuffer != nullptr)
+            {
+                const CmdBufferDumpHeader chunkheader =
+                {
+                    static_cast<uint32>(sizeof(CmdBufferDumpHeader)),
+                    static_cast<uint32>(chunkDesc.size),
+                    subEngineId
+                };
+                memcpy(pPayload->pBuffer + pPayload->offset, &chunkheader, sizeof(chunkheader));
+            }
+            pPayload->offset += sizeof(CmdBufferDumpHeader);
+        }
+
+        if (pPayload->pBuffer != nullptr)
+        {
+            memcpy(pPayload->pBuffer + pPayload->offset, chunkDesc.pCommands, chunkDesc.size);
+        }
+        pPayload->offset += chunkDesc.size;
+    }
+
+    pPayload->numChunks += numChunks;
+}
 #endif
 
 // =====================================================================================================================
@@ -247,7 +331,8 @@ Queue::Queue(
     m_batchedCmds(pDevice->GetPlatform()),
     m_deviceMembershipNode(this),
     m_lastFrameCnt(0),
-    m_submitIdPerFrame(0)
+    m_submitIdPerFrame(0),
+    m_pCmdDumpWriter(nullptr)
 {
     if (m_pDevice->Settings().ifhGpuMask & (0x1 << m_pDevice->ChipProperties().gpuIndex))
     {
@@ -262,6 +347,9 @@ Queue::~Queue()
     {
         PAL_SAFE_DELETE_ARRAY(m_pQueueInfos, m_pDevice->GetPlatform());
     }
+
+    // Deleting the writer flushes any command buffer dumps which are still queued.
+    PAL_SAFE_DELETE(m_pCmdDumpWriter, m_pDevice->GetPlatform());
 }
 
 // =====================================================================================================================
@@ -621,7 +709,17 @@ Result Queue::SubmitInternal(
         if (result == Result::Success)
         {
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 555
-            if (IsCmdDumpEnabled())
+            const auto& settings = m_pDevice->Settings();
+
+            if (IsCmdDumpEnabled() &&
+                (settings.cmdBufDumpAsyncMaxMemory > 0) &&
+                (settings.cmdBufDumpFormat != CmdBufDumpFormat::CmdBufDumpFormatText))
+            {
+                // Copy the command chunks and let a background thread write them to disk. Errors are ignored here
+                // for the same reason they are for the synchronous path below.
+                QueueCommandDump(submitInfo, internalSubmitInfos[0]);
+            }
+            else if (IsCmdDumpEnabled())
             {
                 Util::File logFile;
                 // Open file for write depending on the settings
@@ -835,45 +933,8 @@ Result Queue::OpenCommandDumpFile(
         const auto& settings = m_pDevice->Settings();
         const CmdBufDumpFormat dumpFormat = settings.cmdBufDumpFormat;
 
-        static const char* const pSuffix[] =
-        {
-            ".txt",     // CmdBufDumpFormat::CmdBufDumpFormatText
-            ".bin",     // CmdBufDumpFormat::CmdBufDumpFormatBinary
-            ".pm4"      // CmdBufDumpFormat::CmdBufDumpFormatBinaryHeaders
-        };
-
-        const uint32 frameCnt = m_pDevice->GetFrameCount();
-        const char* pLogDir = &settings.cmdBufDumpDirectory[0];
-
-        // Create the directory. We don't care if it fails (existing is fine, failure is caught when opening the file).
-        MkDir(pLogDir);
-
-        // Maximum length of a filename allowed for command buffer dumps, seems more reasonable than 32
-        constexpr uint32 MaxFilenameLength = 512;
-        char filename[MaxFilenameLength] = {};
-
-        // Multiple submissions of one frame
-        if (m_lastFrameCnt == frameCnt)
-        {
-            m_submitIdPerFrame++;
-        }
-        else
-        {
-            // First submission of one frame
-            m_submitIdPerFrame = 0;
-        }
-
-        // Add queue type and this pointer to file name to make name unique since there could be multiple queues/engines
-        // and/or multiple vitual queues (on the same engine on) which command buffers are submitted
-        Snprintf(filename, MaxFilenameLength, "%s/Frame_%u_%p_%u_%04u%s",
-            pLogDir,
-            Type(),
-            this,
-            frameCnt,
-            m_submitIdPerFrame,
-            pSuffix[dumpFormat]);
-
-        m_lastFrameCnt = frameCnt;
+        char filename[MaxCmdDumpFilenameLength] = {};
+        BuildCommandDumpFilename(&filename[0], sizeof(filename));
 
         if (dumpFormat == CmdBufDumpFormat::CmdBufDumpFormatText)
         {
@@ -889,14 +950,7 @@ Result Queue::OpenCommandDumpFile(
 
             if (dumpFormat == CmdBufDumpFormat::CmdBufDumpFormatBinaryHeaders)
             {
-                const CmdBufferDumpFileHeader fileHeader =
-                {
-                    static_cast<uint32>(sizeof(CmdBufferDumpFileHeader)), // Structure size
-                    1,                                                    // Header version
-                    m_pDevice->ChipProperties().familyId,                 // ASIC family
-                    m_pDevice->ChipProperties().eRevId,                   // ASIC revision
-                    0                                                     // Reserved
-                };
+                const CmdBufferDumpFileHeader fileHeader = GetCmdDumpFileHeader(*m_pDevice);
                 pLogFile->Write(&fileHeader, sizeof(fileHeader));
             }
 
@@ -953,6 +1007,152 @@ Result Queue::OpenCommandDumpFile(
     }
 }
 
+// =====================================================================================================================
+// Generates a unique name for the next command buffer dump file of this Queue and creates the dump directory.
+void Queue::BuildCommandDumpFilename(
+    char*  pFilename,
+    size_t bufferLength)
+{
+    const auto& settings = m_pDevice->Settings();
+
+    static const char* const pSuffix[] =
+    {
+        ".txt",     // CmdBufDumpFormat::CmdBufDumpFormatText
+        ".bin",     // CmdBufDumpFormat::CmdBufDumpFormatBinary
+        ".pm4"      // CmdBufDumpFormat::CmdBufDumpFormatBinaryHeaders
+    };
+
+    const uint32 frameCnt = m_pDevice->GetFrameCount();
+    const char* pLogDir = &settings.cmdBufDumpDirectory[0];
+
+    // Create the directory. We don't care if it fails (existing is fine, failure is caught when opening the file).
+    MkDir(pLogDir);
+
+    // Multiple submissions of one frame
+    if (m_lastFrameCnt == frameCnt)
+    {
+        m_submitIdPerFrame++;
+    }
+    else
+    {
+        // First submission of one frame
+        m_submitIdPerFrame = 0;
+    }
+
+    // Add queue type and this pointer to file name to make name unique since there could be multiple queues/engines
+    // and/or multiple vitual queues (on the same engine on) which command buffers are submitted
+    Snprintf(pFilename, bufferLength, "%s/Frame_%u_%p_%u_%04u%s",
+        pLogDir,
+        Type(),
+        this,
+        frameCnt,
+        m_submitIdPerFrame,
+        pSuffix[settings.cmdBufDumpFormat]);
+
+    m_lastFrameCnt = frameCnt;
+}
+
+// =====================================================================================================================
+// Copies the command buffers of a submission into a binary dump which is written to disk by a background thread. Unless
+// the writer compresses it, the resulting file is identical to the one the synchronous path would have written.
+Result Queue::QueueCommandDump(
+    const MultiSubmitInfo&      submitInfo,
+    const InternalSubmitInfo&   internalSubmitInfo)
+{
+    Result result = Result::ErrorInitializationFailed;
+
+    if (submitInfo.perSubQueueInfoCount > 0)
+    {
+        const auto&     settings  = m_pDevice->Settings();
+        Platform*const  pPlatform = m_pDevice->GetPlatform();
+
+        result = Result::Success;
+
+        if (m_pCmdDumpWriter == nullptr)
+        {
+            const size_t maxQueuedBytes = static_cast<size_t>(settings.cmdBufDumpAsyncMaxMemory) * 1024 * 1024;
+
+            m_pCmdDumpWriter = PAL_NEW(CmdDumpWriter, pPlatform, AllocInternal)(pPlatform,
+                                                                                maxQueuedBytes,
+                                                                                settings.cmdBufDumpAsyncCompression);
+
+            if (m_pCmdDumpWriter == nullptr)
+            {
+                result = Result::ErrorOutOfMemory;
+            }
+            else
+            {
+                result = m_pCmdDumpWriter->Init();
+
+                if (result != Result::Success)
+                {
+                    PAL_SAFE_DELETE(m_pCmdDumpWriter, pPlatform);
+                }
+            }
+        }
+
+        if (result == Result::Success)
+        {
+            char filename[MaxCmdDumpFilenameLength] = {};
+            BuildCommandDumpFilename(&filename[0], sizeof(filename));
+
+            MultiSubmitInfo submitInfoCopy = submitInfo;
+
+            CmdDumpToBufferPayload payload = {};
+            payload.pSettings = &settings;
+
+            submitInfoCopy.pfnCmdDumpCb = WriteCmdDumpToBuffer;
+            submitInfoCopy.pUserData    = &payload;
+
+            // The first pass only measures the chunks so that the whole dump fits in a single allocation.
+            DumpCmdBuffers(submitInfoCopy, internalSubmitInfo);
+
+            const bool   hasFileHeader = (settings.cmdBufDumpFormat == CmdBufDumpFormat::CmdBufDumpFormatBinaryHeaders);
+            const size_t headerSize    = (hasFileHeader ? sizeof(CmdBufferDumpFileHeader) : 0) +
+                                         sizeof(CmdBufferListHeader);
+
+            CmdDumpJob*const pJob = m_pCmdDumpWriter->CreateJob(&filename[0], headerSize + payload.offset);
+
+            if (pJob == nullptr)
+            {
+                result = Result::ErrorOutOfMemory;
+            }
+            else
+            {
+                uint8* pData = static_cast<uint8*>(CmdDumpWriter::JobData(pJob));
+
+                if (hasFileHeader)
+                {
+                    const CmdBufferDumpFileHeader fileHeader = GetCmdDumpFileHeader(*m_pDevice);
+                    memcpy(pData, &fileHeader, sizeof(fileHeader));
+                    pData += sizeof(fileHeader);
+                }
+
+                const CmdBufferListHeader listHeader =
+                {
+                    static_cast<uint32>(sizeof(CmdBufferListHeader)),   // Structure size
+                    EngineId(),                                         // Engine index
+                    payload.numChunks                                   // Number of command buffer chunks
+                };
+                memcpy(pData, &listHeader, sizeof(listHeader));
+                pData += sizeof(listHeader);
+
+                // The second pass copies the chunks; this is the only work left on the submitting thread.
+                payload.pBuffer   = pData;
+                payload.offset    = 0;
+                payload.numChunks = 0;
+
+                DumpCmdBuffers(submitInfoCopy, internalSubmitInfo);
+                PAL_ASSERT((headerSize + payload.offset) == pJob->dataSize);
+
+                m_pCmdDumpWriter->Enqueue(pJob);
+            }
+        }
+    }
+
+    return result;
+}
+
 #endif
 #endif
 
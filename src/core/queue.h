@@ -35,6 +35,7 @@ namespace Pal
 {
 
 class CmdBuffer;
+class CmdDumpWriter;
 class CmdStream;
 class Device;
 class Fence;
@@ -417,6 +418,12 @@ private:
         const MultiSubmitInfo&      submitInfo,
         const InternalSubmitInfo&   internalSubmitInfo,
         Util::File*                 logFile);
+    void BuildCommandDumpFilename(
+        char*                       pFilename,
+        size_t                      bufferLength);
+    Result QueueCommandDump(
+        const MultiSubmitInfo&      submitInfo,
+        const InternalSubmitInfo&   internalSubmitInfo);
 #endif
 
     void DumpCmdBuffers(
@@ -444,6 +451,7 @@ private:
 
     uint32           m_lastFrameCnt;       // Most recent frame in which the queue submission occurs
     uint32           m_submitIdPerFrame;   // The Nth queue submission of the frame
+    CmdDumpWriter*   m_pCmdDumpWriter;     // Background writer for asynchronous submit-time command buffer dumps
 
     PAL_DISALLOW_DEFAULT_CTOR(Queue);
     PAL_DISALLOW_COPY_AND_ASSIGN(Queue);
@@ -28,6 +28,70 @@
 namespace Util
 {
 
+// =====================================================================================================================
+// Picks the counter stripe for the calling thread. Each thread is dealt the next stripe, round-robin, the first time it
+// updates any tracker and keeps it for its lifetime, so consecutively started threads always use different stripes.
+uint32 CacheLayerStatsTracker::StripeIndex()
+{
+    static volatile uint32 threadCount = 0;
+    thread_local const uint32 stripe   = (AtomicIncrement(&threadCount) % NumStripes);
+
+    return stripe;
+}
+
+// =====================================================================================================================
+void CacheLayerStatsTracker::AddQuery(
+    Result result,
+    uint64 ticks)
+{
+    Stripe*const pStripe = &m_stripes[StripeIndex()];
+
+    AtomicIncrement64(&pStripe->counters[QueryCount]);
+    AtomicAdd64(&pStripe->counters[QueryTicks], ticks);
+
+    if ((result == Result::Success) || (result == Result::NotReady))
+    {
+        AtomicIncrement64(&pStripe->counters[HitCount]);
+    }
+    else if (result == Result::NotFound)
+    {
+        AtomicIncrement64(&pStripe->counters[MissCount]);
+    }
+}
+
+// =====================================================================================================================
+// Sums the counter stripes. Counters updated concurrently with this call may or may not be included.
+void CacheLayerStatsTracker::GetStats(
+    CacheLayerStats* pStats
+    ) const
+{
+    uint64 totals[CounterCount] = {};
+
+    for (uint32 stripe = 0; stripe < NumStripes; ++stripe)
+    {
+        for (uint32 counter = 0; counter < CounterCount; ++counter)
+        {
+            totals[counter] += AtomicReadRelaxed64(&m_stripes[stripe].counters[counter]);
+        }
+    }
+
+    pStats->queryCount     = totals[QueryCount];
+    pStats->hitCount       = totals[HitCount];
+    pStats->missCount      = totals[MissCount];
+    pStats->storeCount     = totals[StoreCount];
+    pStats->bytesStored    = totals[BytesStored];
+    pStats->loadCount      = totals[LoadCount];
+    pStats->bytesLoaded    = totals[BytesLoaded];
+    pStats->evictCount     = totals[EvictCount];
+    pStats->insertCount    = totals[InsertCount];
+    pStats->rejectCount    = totals[RejectCount];
+    pStats->queryTicks     = totals[QueryTicks];
+    pStats->storeTicks     = totals[StoreTicks];
+    pStats->loadTicks      = totals[LoadTicks];
+    pStats->lockWaitTicks  = totals[LockWaitTicks];
+    pStats->ticksPerSecond = static_cast<uint64>(GetPerfFrequency());
+}
+
 // =====================================================================================================================
 CacheLayerBase::CacheLayerBase(
     const AllocCallbacks& callbacks)
@@ -69,7 +133,11 @@ Result CacheLayerBase::Query(
     {
         if (TestAnyFlagSet(m_loadPolicy, LinkPolicy::Skip) == false)
         {
+            const int64 start = GetPerfCpuTime();
+
             result = QueryInternal(pHashId, pQuery);
+
+            m_stats.AddQuery(result, static_cast<uint64>(GetPerfCpuTime() - start));
         }
 
         if ((result == Result::NotFound) &&
@@ -118,11 +186,24 @@ Result CacheLayerBase::Query(
 }
 
 // =====================================================================================================================
-// Validate inputs, then store data to our layer. Propagate data down to children if needed.
+// Store untagged data
 Result CacheLayerBase::Store(
     const Hash128* pHashId,
     const void*    pData,
     size_t         dataSize)
+{
+    const CacheEntryTag tag = {};
+
+    return StoreTagged(pHashId, pData, dataSize, tag);
+}
+
+// =====================================================================================================================
+// Validate inputs, then store data to our layer. Propagate data and its tag down to children if needed.
+Result CacheLayerBase::StoreTagged(
+    const Hash128*       pHashId,
+    const void*          pData,
+    size_t               dataSize,
+    const CacheEntryTag& tag)
 {
     Result result = Result::Success;
 
@@ -139,7 +220,17 @@ Result CacheLayerBase::Store(
     {
         if (TestAnyFlagSet(m_storePolicy, LinkPolicy::Skip) == false)
         {
-            result = StoreInternal(pHashId, pData, dataSize);
+            const int64 start = GetPerfCpuTime();
+
+            result = StoreInternal(pHashId, pData, dataSize, tag);
+
+            m_stats.Add(CacheLayerStatsTracker::StoreTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+
+            if (result == Result::Success)
+            {
+                m_stats.Increment(CacheLayerStatsTracker::StoreCount);
+                m_stats.Add(CacheLayerStatsTracker::BytesStored, dataSize);
+            }
         }
 
         // Pass data to children on success
@@ -152,12 +243,12 @@ Result CacheLayerBase::Store(
 
             if (TestAnyFlagSet(m_storePolicy, LinkPolicy::BatchStore))
             {
-                batchResult = BatchData(m_storePolicy, m_pNextLayer, pHashId, pData, dataSize);
+                batchResult = BatchData(m_storePolicy, m_pNextLayer, pHashId, pData, dataSize, tag);
             }
 
             if (batchResult == Result::Unsupported)
             {
-                Result childResult = m_pNextLayer->Store(pHashId, pData, dataSize);
+                Result childResult = m_pNextLayer->StoreTagged(pHashId, pData, dataSize, tag);
                 PAL_ALERT(IsErrorResult(childResult));
             }
         }
@@ -183,7 +274,17 @@ Result CacheLayerBase::Load(
     {
         if (pQuery->pLayer == this)
         {
+            const int64 start = GetPerfCpuTime();
+
             result = LoadInternal(pQuery, pBuffer);
+
+            m_stats.Add(CacheLayerStatsTracker::LoadTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+
+            if (result == Result::Success)
+            {
+                m_stats.Increment(CacheLayerStatsTracker::LoadCount);
+                m_stats.Add(CacheLayerStatsTracker::BytesLoaded, pQuery->dataSize);
+            }
         }
         else
         {
@@ -208,6 +309,26 @@ Result CacheLayerBase::Load(
     return result;
 }
 
+// =====================================================================================================================
+// Report the counters accumulated by this layer
+Result CacheLayerBase::GetStats(
+    CacheLayerStats* pStats
+    ) const
+{
+    Result result = Result::Success;
+
+    if (pStats == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else
+    {
+        m_stats.GetStats(pStats);
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Link another cache layer to ourselves.
 Result CacheLayerBase::Link(
@@ -29,11 +29,146 @@
 #include "palSysMemory.h"
 #include "palLinearAllocator.h"
 #include "palMutex.h"
+#include "palSysUtil.h"
 #include "palVector.h"
 
 namespace Util
 {
 
+// =====================================================================================================================
+// Accumulates the counters reported through ICacheLayer::GetStats(). Counters are striped over several cache lines and
+// each thread adds to the stripe it was assigned on first use, so threads working through the same layer don't all
+// contend on one line. The stripes are only summed when the statistics are queried.
+class CacheLayerStatsTracker
+{
+public:
+    enum Counter : uint32
+    {
+        QueryCount = 0,
+        HitCount,
+        MissCount,
+        StoreCount,
+        BytesStored,
+        LoadCount,
+        BytesLoaded,
+        EvictCount,
+        InsertCount,
+        RejectCount,
+        QueryTicks,
+        StoreTicks,
+        LoadTicks,
+        LockWaitTicks,
+        CounterCount
+    };
+
+    CacheLayerStatsTracker() : m_stripes {} { }
+
+    void Add(Counter counter, uint64 value) { AtomicAdd64(&m_stripes[StripeIndex()].counters[counter], value); }
+    void Increment(Counter counter) { Add(counter, 1); }
+
+    // Records a lookup result from a layer's own storage.
+    void AddQuery(Result result, uint64 ticks);
+
+    void GetStats(CacheLayerStats* pStats) const;
+
+private:
+    static constexpr uint32 NumStripes = 8;
+
+    static uint32 StripeIndex();
+
+    static constexpr size_t CounterBytes = sizeof(uint64) * CounterCount;
+    static constexpr size_t StripeBytes  =
+        ((CounterBytes + PAL_CACHE_LINE_BYTES - 1) / PAL_CACHE_LINE_BYTES) * PAL_CACHE_LINE_BYTES;
+    static_assert(StripeBytes > CounterBytes, "Stripe padding must not be empty.");
+
+    struct Stripe
+    {
+        volatile uint64 counters[CounterCount];
+        uint8           padding[StripeBytes - CounterBytes];
+    };
+
+    Stripe m_stripes[NumStripes];
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(CacheLayerStatsTracker);
+};
+
+// =====================================================================================================================
+// RAII wrapper like RWLockAuto which also records the time spent waiting for the lock when it is contended. The
+// uncontended case only costs a try-lock.
+template <RWLock::LockType type>
+class TimedRWLockAuto
+{
+public:
+    TimedRWLockAuto(RWLock* pRWLock, CacheLayerStatsTracker* pStats)
+        :
+        m_pRWLock(pRWLock)
+    {
+        const bool acquired = (type == RWLock::ReadOnly) ? m_pRWLock->TryLockForRead() : m_pRWLock->TryLockForWrite();
+
+        if (acquired == false)
+        {
+            const int64 start = GetPerfCpuTime();
+
+            if (type == RWLock::ReadOnly)
+            {
+                m_pRWLock->LockForRead();
+            }
+            else
+            {
+                m_pRWLock->LockForWrite();
+            }
+
+            pStats->Add(CacheLayerStatsTracker::LockWaitTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+        }
+    }
+
+    ~TimedRWLockAuto()
+    {
+        if (type == RWLock::ReadOnly)
+        {
+            m_pRWLock->UnlockForRead();
+        }
+        else
+        {
+            m_pRWLock->UnlockForWrite();
+        }
+    }
+
+private:
+    RWLock*const m_pRWLock;
+
+    PAL_DISALLOW_DEFAULT_CTOR(TimedRWLockAuto);
+    PAL_DISALLOW_COPY_AND_ASSIGN(TimedRWLockAuto);
+};
+
+// =====================================================================================================================
+// RAII wrapper like MutexAuto which also records the time spent waiting for the mutex when it is contended.
+class TimedMutexAuto
+{
+public:
+    TimedMutexAuto(Mutex* pMutex, CacheLayerStatsTracker* pStats)
+        :
+        m_pMutex(pMutex)
+    {
+        if (m_pMutex->TryLock() == false)
+        {
+            const int64 start = GetPerfCpuTime();
+
+            m_pMutex->Lock();
+
+            pStats->Add(CacheLayerStatsTracker::LockWaitTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+        }
+    }
+
+    ~TimedMutexAuto() { m_pMutex->Unlock(); }
+
+private:
+    Mutex*const m_pMutex;
+
+    PAL_DISALLOW_DEFAULT_CTOR(TimedMutexAuto);
+    PAL_DISALLOW_COPY_AND_ASSIGN(TimedMutexAuto);
+};
+
 // =====================================================================================================================
 // Common functionality of most cache layers including thread-safety and layering
 class CacheLayerBase : public ICacheLayer
@@ -52,6 +187,12 @@ public:
         const void*     pData,
         size_t          dataSize) final;
 
+    virtual Result StoreTagged(
+        const Hash128*       pHashId,
+        const void*          pData,
+        size_t               dataSize,
+        const CacheEntryTag& tag) final;
+
     virtual Result Load(
         const QueryResult* pQuery,
         void*              pBuffer) final;
@@ -71,6 +212,9 @@ public:
 
     virtual uint32 GetStorePolicy() const final { return m_storePolicy; }
 
+    virtual Result GetStats(
+        CacheLayerStats* pStats) const final;
+
     virtual void Destroy() final { this->~CacheLayerBase(); }
 
 protected:
@@ -83,14 +227,19 @@ protected:
     // Access to a generic allocator suitable for long-term storage
     ForwardAllocator* Allocator() { return &m_allocator; }
 
+    // Counters reported by GetStats(). Query, store and load counts are tracked by this class; derived layers add
+    // evictions and lock waits.
+    CacheLayerStatsTracker* Stats() { return &m_stats; }
+
     // Internal, single layer operation functions
     virtual Result QueryInternal(
         const Hash128*  pHashId,
         QueryResult*    pQuery) = 0;
     virtual Result StoreInternal(
-        const Hash128*  pHashId,
-        const void*     pData,
-        size_t          dataSize) = 0;
+        const Hash128*       pHashId,
+        const void*          pData,
+        size_t               dataSize,
+        const CacheEntryTag& tag) = 0;
     virtual Result LoadInternal(
         const QueryResult* pQuery,
         void*              pBuffer) = 0;
@@ -107,11 +256,12 @@ protected:
 
     // Batch data to be submitted to the next cache layer at a later time
     virtual Result BatchData(
-        uint32         storePolicy,
-        ICacheLayer*   pNextLayer,
-        const Hash128* pHashId,
-        const void*    pData,
-        size_t         dataSize) { return Result::Unsupported; }
+        uint32               storePolicy,
+        ICacheLayer*         pNextLayer,
+        const Hash128*       pHashId,
+        const void*          pData,
+        size_t               dataSize,
+        const CacheEntryTag& tag) { return Result::Unsupported; }
 
 private:
 
@@ -119,6 +269,8 @@ private:
     ICacheLayer*     m_pNextLayer;
     uint32           m_loadPolicy;
     uint32           m_storePolicy;
+
+    CacheLayerStatsTracker m_stats;
 };
 
 } //namespace Util
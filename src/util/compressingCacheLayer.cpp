@@ -0,0 +1,724 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2018-2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+#include "compressingCacheLayer.h"
+#include "lzCodec.h"
+
+#include "palHashMapImpl.h"
+#include "palAssert.h"
+#include "palInlineFuncs.h"
+#include "palSysUtil.h"
+
+#include "core/platform.h"
+
+namespace Util
+{
+
+// The low byte of a compressed entry's CacheEntryTag::dataType holds the codec.
+static constexpr uint32 CodecTypeMask = 0xFF;
+
+// =====================================================================================================================
+// Reads the entry header from data passed to the next layer. Returns false if the data doesn't start with one.
+static bool ReadEntryHeader(
+    const void*                         pData,
+    size_t                              dataSize,
+    CompressingCacheLayer::EntryHeader* pHeader)
+{
+    bool hasHeader = (dataSize >= sizeof(CompressingCacheLayer::EntryHeader));
+
+    if (hasHeader)
+    {
+        memcpy(pHeader, pData, sizeof(CompressingCacheLayer::EntryHeader));
+
+        hasHeader = (pHeader->magic == CompressingCacheLayer::EntryMagic);
+    }
+
+    return hasHeader;
+}
+
+// =====================================================================================================================
+// Reverses the encoding applied by Store() and writes the original data to pBuffer. Data which isn't encoded was stored
+// to the next layer without passing through a compressing cache layer and is copied as-is.
+static Result DecodeData(
+    const void* pData,
+    size_t      dataSize,
+    bool        encoded,
+    void*       pBuffer,
+    size_t      bufferSize)
+{
+    Result                             result = Result::Success;
+    CompressingCacheLayer::EntryHeader header;
+
+    if (encoded && (ReadEntryHeader(pData, dataSize, &header) == false))
+    {
+        result = Result::ErrorInvalidValue;
+    }
+    else if (encoded)
+    {
+        const uint8* pPayload    = static_cast<const uint8*>(VoidPtrInc(pData, sizeof(header)));
+        const size_t payloadSize = dataSize - sizeof(header);
+
+        if (header.dataSize != bufferSize)
+        {
+            result = Result::ErrorInvalidValue;
+        }
+        else if (header.codec == static_cast<uint32>(CacheCompressionCodec::None))
+        {
+            if (payloadSize == bufferSize)
+            {
+                memcpy(pBuffer, pPayload, bufferSize);
+            }
+            else
+            {
+                result = Result::ErrorInvalidValue;
+            }
+        }
+        else if (header.codec == static_cast<uint32>(CacheCompressionCodec::Lz))
+        {
+            if (LzDecompress(pPayload, payloadSize, pBuffer, bufferSize) == false)
+            {
+                result = Result::ErrorInvalidValue;
+            }
+        }
+        else
+        {
+            result = Result::ErrorInvalidValue;
+        }
+    }
+    else if (dataSize == bufferSize)
+    {
+        memcpy(pBuffer, pData, bufferSize);
+    }
+    else
+    {
+        result = Result::ErrorInvalidValue;
+    }
+
+    PAL_ALERT(IsErrorResult(result));
+
+    return result;
+}
+
+// =====================================================================================================================
+CompressingCacheLayer::CompressingCacheLayer(
+    const AllocCallbacks& callbacks,
+    CacheCompressionCodec codec)
+    :
+    m_allocator   { callbacks },
+    m_pNextLayer  { nullptr },
+    m_loadPolicy  { LinkPolicy::PassData | LinkPolicy::PassCalls },
+    m_storePolicy { LinkPolicy::PassData },
+    m_codec       { codec },
+    m_entryLock     {},
+    m_entries       { HashTableBucketCount, Allocator() },
+    m_scratchLock   {},
+    m_pLzHashTable  { nullptr }
+{
+    // Alloc and Free MUST NOT be nullptr
+    PAL_ASSERT(callbacks.pfnAlloc != nullptr);
+    PAL_ASSERT(callbacks.pfnFree != nullptr);
+}
+
+// =====================================================================================================================
+CompressingCacheLayer::~CompressingCacheLayer()
+{
+    PAL_SAFE_FREE(m_pLzHashTable, Allocator());
+}
+
+// =====================================================================================================================
+Result CompressingCacheLayer::Init()
+{
+    Result result = m_entries.Init();
+
+    if ((result == Result::Success) && (m_codec == CacheCompressionCodec::Lz))
+    {
+        m_pLzHashTable = static_cast<size_t*>(PAL_MALLOC(sizeof(size_t) * LzHashTableEntries,
+                                                         Allocator(),
+                                                         AllocInternal));
+
+        if (m_pLzHashTable == nullptr)
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Compresses the data with the layer's codec. Returns the compressed size, or zero if the codec can't fit the data in
+// dstCapacity bytes.
+size_t CompressingCacheLayer::Compress(
+    const void* pData,
+    size_t      dataSize,
+    void*       pDst,
+    size_t      dstCapacity)
+{
+    size_t compressedSize = 0;
+
+    if (m_codec == CacheCompressionCodec::Lz)
+    {
+        MutexAuto lock { &m_scratchLock };
+
+        compressedSize = LzCompress(pData, dataSize, pDst, dstCapacity, m_pLzHashTable);
+    }
+
+    return compressedSize;
+}
+
+// =====================================================================================================================
+// Loads the data held by the next layer into a temporary allocation which the caller must free.
+Result CompressingCacheLayer::LoadFromNextLayer(
+    const QueryResult* pNextQuery,
+    void**             ppData)
+{
+    Result result = Result::ErrorOutOfMemory;
+    void*  pMem   = PAL_MALLOC(pNextQuery->dataSize, Allocator(), AllocInternalTemp);
+
+    if (pMem != nullptr)
+    {
+        result = m_pNextLayer->Load(pNextQuery, pMem);
+
+        if (result == Result::Success)
+        {
+            *ppData = pMem;
+        }
+        else
+        {
+            PAL_FREE(pMem, Allocator());
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result CompressingCacheLayer::FindNextQuery(
+    const Hash128* pHashId,
+    QueryResult*   pNextQuery,
+    bool*          pEncoded
+    ) const
+{
+    Result result = Result::NotFound;
+
+    RWLockAuto<RWLock::ReadOnly> lock { &m_entryLock };
+
+    const Entry* pEntry = m_entries.FindKey(*pHashId);
+
+    if ((pEntry != nullptr) && (pEntry->nextQuery.pLayer != nullptr))
+    {
+        *pNextQuery = pEntry->nextQuery;
+        *pEncoded   = pEntry->encoded;
+        result      = Result::Success;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Data stored through a compressing cache layer is tagged with its codec and original size, which every in-tree storage
+// layer keeps. Untagged data went through a layer which drops tags, so the header embedded in the data is used instead;
+// it only counts if the whole entry decodes to the size it records, which keeps raw data that happens to start with
+// EntryMagic from being mistaken for ours. Any other tag means the data was stored without compression.
+Result CompressingCacheLayer::DescribeNextEntry(
+    const QueryResult* pNextQuery,
+    size_t*            pDataSize,
+    bool*              pEncoded)
+{
+    const CacheEntryTag& tag = pNextQuery->tag;
+
+    Result result = Result::Success;
+
+    *pDataSize = pNextQuery->dataSize;
+    *pEncoded  = false;
+
+    if ((tag.dataType & ~CodecTypeMask) == CompressedCacheDataType)
+    {
+        *pDataSize = tag.metaValue;
+        *pEncoded  = true;
+    }
+    else if (tag.dataType == 0)
+    {
+        void* pData = nullptr;
+        result      = LoadFromNextLayer(pNextQuery, &pData);
+
+        EntryHeader header = {};
+
+        if ((result == Result::Success) &&
+            ReadEntryHeader(pData, pNextQuery->dataSize, &header) &&
+            (header.dataSize <= ((pNextQuery->dataSize - sizeof(header)) * LzMaxRatio)))
+        {
+            const size_t decodedSize = static_cast<size_t>(header.dataSize);
+            void* const  pDecoded    = PAL_MALLOC(decodedSize, Allocator(), AllocInternalTemp);
+
+            if (pDecoded == nullptr)
+            {
+                result = Result::ErrorOutOfMemory;
+            }
+            else
+            {
+                if (DecodeData(pData, pNextQuery->dataSize, true, pDecoded, decodedSize) == Result::Success)
+                {
+                    *pDataSize = decodedSize;
+                    *pEncoded  = true;
+                }
+
+                PAL_FREE(pDecoded, Allocator());
+            }
+        }
+
+        if (pData != nullptr)
+        {
+            PAL_FREE(pData, Allocator());
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Query the next layer and translate its result into one which describes the decompressed data.
+Result CompressingCacheLayer::Query(
+    const Hash128* pHashId,
+    uint32         policy,
+    uint32         flags,
+    QueryResult*   pQuery)
+{
+    const int64 start = GetPerfCpuTime();
+
+    Result result = Result::ErrorUnknown;
+
+    PAL_ASSERT(m_pNextLayer != nullptr);
+
+    if (m_pNextLayer == nullptr)
+    {
+        result = Result::ErrorUnavailable;
+    }
+    else if ((pHashId == nullptr) ||
+             (pQuery == nullptr))
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else
+    {
+        // Layers which don't keep tags leave this alone.
+        pQuery->tag = {};
+
+        result = m_pNextLayer->Query(pHashId, policy, flags, pQuery);
+    }
+
+    if ((result == Result::Success) && (pQuery->dataSize > 0))
+    {
+        size_t dataSize  = 0;
+        bool   encoded   = false;
+        bool   knownSize = false;
+
+        {
+            RWLockAuto<RWLock::ReadOnly> lock { &m_entryLock };
+
+            const Entry* pEntry = m_entries.FindKey(*pHashId);
+
+            if (pEntry != nullptr)
+            {
+                dataSize  = pEntry->dataSize;
+                encoded   = pEntry->encoded;
+                knownSize = true;
+            }
+        }
+
+        if (knownSize == false)
+        {
+            result = DescribeNextEntry(pQuery, &dataSize, &encoded);
+        }
+
+        if (result == Result::Success)
+        {
+            RWLockAuto<RWLock::ReadWrite> lock { &m_entryLock };
+
+            bool   existed = false;
+            Entry* pEntry  = nullptr;
+
+            result = m_entries.FindAllocate(*pHashId, &existed, &pEntry);
+
+            if (result == Result::Success)
+            {
+                pEntry->nextQuery = *pQuery;
+                pEntry->dataSize  = dataSize;
+                pEntry->encoded   = encoded;
+            }
+        }
+
+        if (result == Result::Success)
+        {
+            // The tag described the encoded data; what this layer returns is the data as it was stored.
+            pQuery->pLayer   = this;
+            pQuery->dataSize = dataSize;
+            pQuery->tag      = {};
+        }
+
+        PAL_ALERT(IsErrorResult(result));
+    }
+
+    m_stats.AddQuery(result, static_cast<uint64>(GetPerfCpuTime() - start));
+
+    return result;
+}
+
+// =====================================================================================================================
+// Compress the data and store it to the next layer.
+Result CompressingCacheLayer::Store(
+    const Hash128* pHashId,
+    const void*    pData,
+    size_t         dataSize)
+{
+    const int64 start = GetPerfCpuTime();
+
+    Result result = Result::ErrorUnknown;
+
+    PAL_ASSERT(m_pNextLayer != nullptr);
+
+    if (m_pNextLayer == nullptr)
+    {
+        result = Result::ErrorUnavailable;
+    }
+    else if ((pHashId == nullptr) ||
+             (pData == nullptr))
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if (dataSize == 0)
+    {
+        result = Result::ErrorInvalidValue;
+    }
+    else
+    {
+        void* const pMem = PAL_MALLOC(sizeof(EntryHeader) + dataSize, Allocator(), AllocInternalTemp);
+
+        if (pMem == nullptr)
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+        else
+        {
+            uint8* const pPayload    = static_cast<uint8*>(VoidPtrInc(pMem, sizeof(EntryHeader)));
+            size_t       payloadSize = 0;
+            EntryHeader  header      = {};
+
+            header.magic    = EntryMagic;
+            header.codec    = static_cast<uint32>(m_codec);
+            header.dataSize = dataSize;
+
+            payloadSize = Compress(pData, dataSize, pPayload, dataSize - 1);
+
+            // Store the data as-is if the codec can't make it any smaller.
+            if (payloadSize == 0)
+            {
+                header.codec = static_cast<uint32>(CacheCompressionCodec::None);
+                payloadSize  = dataSize;
+
+                memcpy(pPayload, pData, dataSize);
+            }
+
+            memcpy(pMem, &header, sizeof(header));
+
+            // The tag lets the layer which keeps the data describe it on later queries without loading it, and lets an
+            // archive file layer record the codec in its entry header. Sizes the tag can't hold are left untagged.
+            CacheEntryTag tag = {};
+
+            if (dataSize <= UINT32_MAX)
+            {
+                tag.dataType  = CompressedCacheDataType | header.codec;
+                tag.metaValue = static_cast<uint32>(dataSize);
+            }
+
+            result = m_pNextLayer->StoreTagged(pHashId, pMem, sizeof(header) + payloadSize, tag);
+
+            PAL_FREE(pMem, Allocator());
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        RWLockAuto<RWLock::ReadWrite> lock { &m_entryLock };
+
+        bool   existed = false;
+        Entry* pEntry  = nullptr;
+
+        if (m_entries.FindAllocate(*pHashId, &existed, &pEntry) == Result::Success)
+        {
+            if (existed == false)
+            {
+                pEntry->nextQuery = {};
+            }
+
+            pEntry->dataSize = dataSize;
+            pEntry->encoded  = true;
+        }
+    }
+
+    m_stats.Add(CacheLayerStatsTracker::StoreTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+
+    if (result == Result::Success)
+    {
+        m_stats.Increment(CacheLayerStatsTracker::StoreCount);
+        m_stats.Add(CacheLayerStatsTracker::BytesStored, dataSize);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Load the data from the next layer and decompress it into the client's buffer.
+Result CompressingCacheLayer::Load(
+    const QueryResult* pQuery,
+    void*              pBuffer)
+{
+    const int64 start = GetPerfCpuTime();
+
+    Result result = Result::ErrorUnknown;
+
+    PAL_ASSERT(m_pNextLayer != nullptr);
+
+    if (m_pNextLayer == nullptr)
+    {
+        result = Result::ErrorUnavailable;
+    }
+    else if ((pQuery == nullptr) ||
+             (pBuffer == nullptr))
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if (pQuery->pLayer != this)
+    {
+        result = m_pNextLayer->Load(pQuery, pBuffer);
+    }
+    else
+    {
+        QueryResult nextQuery = {};
+        bool        encoded   = false;
+        void*       pData     = nullptr;
+
+        result = FindNextQuery(&pQuery->hashId, &nextQuery, &encoded);
+
+        if (result == Result::Success)
+        {
+            result = LoadFromNextLayer(&nextQuery, &pData);
+        }
+
+        if (result == Result::Success)
+        {
+            result = DecodeData(pData, nextQuery.dataSize, encoded, pBuffer, pQuery->dataSize);
+
+            PAL_FREE(pData, Allocator());
+        }
+    }
+
+    m_stats.Add(CacheLayerStatsTracker::LoadTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+
+    if (result == Result::Success)
+    {
+        m_stats.Increment(CacheLayerStatsTracker::LoadCount);
+        m_stats.Add(CacheLayerStatsTracker::BytesLoaded, pQuery->dataSize);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Report the calls made through this layer.
+Result CompressingCacheLayer::GetStats(
+    CacheLayerStats* pStats
+    ) const
+{
+    Result result = Result::Success;
+
+    if (pStats == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else
+    {
+        m_stats.GetStats(pStats);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// References are held on the entry of the layer which answered our query of the next layer.
+Result CompressingCacheLayer::AcquireCacheRef(
+    const QueryResult* pQuery)
+{
+    Result      result    = Result::ErrorInvalidPointer;
+    QueryResult nextQuery = {};
+    bool        encoded   = false;
+
+    if (pQuery != nullptr)
+    {
+        PAL_ASSERT(this == pQuery->pLayer);
+
+        result = FindNextQuery(&pQuery->hashId, &nextQuery, &encoded);
+    }
+
+    if (result == Result::Success)
+    {
+        result = nextQuery.pLayer->AcquireCacheRef(&nextQuery);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result CompressingCacheLayer::ReleaseCacheRef(
+    const QueryResult* pQuery)
+{
+    Result      result    = Result::ErrorInvalidPointer;
+    QueryResult nextQuery = {};
+    bool        encoded   = false;
+
+    if (pQuery != nullptr)
+    {
+        PAL_ASSERT(this == pQuery->pLayer);
+
+        result = FindNextQuery(&pQuery->hashId, &nextQuery, &encoded);
+    }
+
+    if (result == Result::Success)
+    {
+        result = nextQuery.pLayer->ReleaseCacheRef(&nextQuery);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result CompressingCacheLayer::WaitForEntry(
+    const Hash128* pHashId)
+{
+    return (m_pNextLayer != nullptr) ? m_pNextLayer->WaitForEntry(pHashId) : Result::ErrorUnavailable;
+}
+
+// =====================================================================================================================
+Result CompressingCacheLayer::Evict(
+    const Hash128* pHashId)
+{
+    Result result = Result::ErrorUnavailable;
+
+    if (pHashId == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if (m_pNextLayer != nullptr)
+    {
+        result = m_pNextLayer->Evict(pHashId);
+
+        RWLockAuto<RWLock::ReadWrite> lock { &m_entryLock };
+
+        m_entries.Erase(*pHashId);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result CompressingCacheLayer::MarkEntryBad(
+    const Hash128* pHashId)
+{
+    return (m_pNextLayer != nullptr) ? m_pNextLayer->MarkEntryBad(pHashId) : Result::ErrorUnavailable;
+}
+
+// =====================================================================================================================
+// Link another cache layer to ourselves.
+Result CompressingCacheLayer::Link(
+    ICacheLayer* pNextLayer)
+{
+    m_pNextLayer = pNextLayer;
+
+    return Result::Success;
+}
+
+// =====================================================================================================================
+// Get the memory size for a compressing cache layer
+size_t GetCompressingCacheLayerSize(
+    const CompressingCacheCreateInfo* pCreateInfo)
+{
+    return sizeof(CompressingCacheLayer);
+}
+
+// =====================================================================================================================
+// Create a compressing cache layer
+Result CreateCompressingCacheLayer(
+    const CompressingCacheCreateInfo* pCreateInfo,
+    void*                             pPlacementAddr,
+    ICacheLayer**                     ppCacheLayer)
+{
+    PAL_ASSERT(pCreateInfo != nullptr);
+    PAL_ASSERT(pPlacementAddr != nullptr);
+    PAL_ASSERT(ppCacheLayer != nullptr);
+
+    Result                 result = Result::Success;
+    CompressingCacheLayer* pLayer = nullptr;
+
+    if ((pCreateInfo == nullptr) ||
+        (pPlacementAddr == nullptr) ||
+        (ppCacheLayer == nullptr))
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if ((pCreateInfo->codec != CacheCompressionCodec::None) &&
+             (pCreateInfo->codec != CacheCompressionCodec::Lz))
+    {
+        result = Result::ErrorInvalidValue;
+    }
+
+    if (result == Result::Success)
+    {
+        AllocCallbacks  callbacks = {};
+
+        if (pCreateInfo->pCallbacks == nullptr)
+        {
+            Pal::GetDefaultAllocCb(&callbacks);
+        }
+
+        pLayer = PAL_PLACEMENT_NEW(pPlacementAddr) CompressingCacheLayer(
+            (pCreateInfo->pCallbacks == nullptr) ? callbacks : *pCreateInfo->pCallbacks,
+            pCreateInfo->codec);
+
+        result = pLayer->Init();
+
+        if (result == Result::Success)
+        {
+            *ppCacheLayer = pLayer;
+        }
+        else
+        {
+            pLayer->Destroy();
+            *ppCacheLayer = nullptr;
+        }
+    }
+
+    return result;
+}
+
+} //namespace Util
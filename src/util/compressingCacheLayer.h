@@ -0,0 +1,163 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2018-2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+#pragma once
+
+#include "palCacheLayer.h"
+#include "cacheLayerBase.h"
+
+#include "palHashMap.h"
+#include "palMutex.h"
+#include "palSysMemory.h"
+
+namespace Util
+{
+
+// =====================================================================================================================
+// The ICacheLayer implementation that compresses data before passing it to the next layer and decompresses it when it
+// is loaded back. This layer holds no data of its own.
+class CompressingCacheLayer : public ICacheLayer
+{
+public:
+    // Prefixes each piece of data passed to the next layer so that it can still be decoded if the next layer can't keep
+    // the CacheEntryTag it was stored with.
+    struct EntryHeader
+    {
+        uint32 magic;    // Must be EntryMagic
+        uint32 codec;    // CacheCompressionCodec applied to the data which follows
+        uint64 dataSize; // Size of the data before compression
+    };
+
+    static constexpr uint32 EntryMagic = 0x5A43414C; // 'LACZ'
+
+    CompressingCacheLayer(
+        const AllocCallbacks& callbacks,
+        CacheCompressionCodec codec);
+
+    virtual ~CompressingCacheLayer();
+
+    virtual Result Init();
+
+    virtual Result Query(
+        const Hash128*  pHashId,
+        uint32          policy,
+        uint32          flags,
+        QueryResult*    pQuery) final;
+
+    virtual Result Store(
+        const Hash128*  pHashId,
+        const void*     pData,
+        size_t          dataSize) final;
+
+    virtual Result Load(
+        const QueryResult* pQuery,
+        void*              pBuffer) final;
+
+    virtual Result AcquireCacheRef(
+        const QueryResult* pQuery) final;
+
+    virtual Result ReleaseCacheRef(
+        const QueryResult* pQuery) final;
+
+    virtual Result WaitForEntry(
+        const Hash128* pHashId) final;
+
+    virtual Result Evict(
+        const Hash128* pHashId) final;
+
+    virtual Result MarkEntryBad(
+        const Hash128* pHashId) final;
+
+    virtual Result Link(
+        ICacheLayer* pNextLayer) final;
+
+    virtual Result SetLoadPolicy(
+        uint32 loadPolicy) final { return Result::Unsupported; }
+
+    virtual Result SetStorePolicy(
+        uint32 storePolicy) final { return Result::Unsupported; }
+
+    virtual ICacheLayer* GetNextLayer() const final { return m_pNextLayer; }
+
+    virtual uint32 GetLoadPolicy() const final { return m_loadPolicy; }
+
+    virtual uint32 GetStorePolicy() const final { return m_storePolicy; }
+
+    virtual Result Prefetch(
+        const Hash128* pHashIds,
+        uint32         count) final
+    {
+        return (m_pNextLayer != nullptr) ? m_pNextLayer->Prefetch(pHashIds, count) : Result::Unsupported;
+    }
+
+    virtual Result GetStats(
+        CacheLayerStats* pStats) const final;
+
+    virtual void Destroy() final { this->~CompressingCacheLayer(); }
+
+private:
+    PAL_DISALLOW_DEFAULT_CTOR(CompressingCacheLayer);
+    PAL_DISALLOW_COPY_AND_ASSIGN(CompressingCacheLayer);
+
+    // Access to a generic allocator suitable for long-term storage
+    ForwardAllocator* Allocator() { return &m_allocator; }
+
+    // Looks up the query result the next layer returned for a query answered through this layer
+    Result FindNextQuery(const Hash128* pHashId, QueryResult* pNextQuery, bool* pEncoded) const;
+
+    Result LoadFromNextLayer(const QueryResult* pNextQuery, void** ppData);
+
+    // Works out the decompressed size of an entry the next layer holds which this layer hasn't seen yet
+    Result DescribeNextEntry(const QueryResult* pNextQuery, size_t* pDataSize, bool* pEncoded);
+
+    size_t Compress(const void* pData, size_t dataSize, void* pDst, size_t dstCapacity);
+
+    // Constants
+    static constexpr size_t HashTableBucketCount = 2048;
+
+    // Tracks what the next layer holds for each entry this layer has seen
+    struct Entry
+    {
+        QueryResult nextQuery; // Last query result returned by the next layer, pLayer is null if never queried
+        size_t      dataSize;  // Size of the data after decompression
+        bool        encoded;   // The next layer holds the data with an EntryHeader, rather than as it was stored
+    };
+    using EntryMap = HashMap<Hash128, Entry, ForwardAllocator, JenkinsHashFunc>;
+
+    ForwardAllocator            m_allocator;
+    ICacheLayer*                m_pNextLayer;
+    const uint32                m_loadPolicy;
+    const uint32                m_storePolicy;
+    const CacheCompressionCodec m_codec;
+
+    mutable RWLock              m_entryLock;
+    EntryMap                    m_entries;
+
+    Mutex                       m_scratchLock;
+    size_t*                     m_pLzHashTable; // Scratch state for the LZ compressor, protected by m_scratchLock
+
+    CacheLayerStatsTracker m_stats;
+};
+
+} //namespace Util
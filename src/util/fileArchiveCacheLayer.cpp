@@ -41,12 +41,14 @@ FileArchiveCacheLayer::FileArchiveCacheLayer(
     const AllocCallbacks& callbacks,
     IArchiveFile*         pArchiveFile,
     IHashContext*         pBaseContext,
-    void*                 pTempContextMem)
+    void*                 pTempContextMem,
+    uint32                dataTypeId)
     :
     CacheLayerBase     { callbacks },
     m_pArchivefile     { pArchiveFile },
     m_pBaseContext     { pBaseContext },
     m_pTempContextMem  { pTempContextMem },
+    m_dataTypeId       { dataTypeId },
     m_archiveFileMutex {},
     m_hashContextMutex {},
     m_entryMapLock     {},
@@ -108,15 +110,15 @@ Result FileArchiveCacheLayer::QueryInternal(
         ConvertToEntryKey(pHashId, &key);
 
         {
-            RWLockAuto<RWLock::ReadOnly> entryMapLock { &m_entryMapLock };
+            TimedRWLockAuto<RWLock::ReadOnly> entryMapLock { &m_entryMapLock, Stats() };
 
             pEntry = m_entries.FindKey(key);
         }
 
         if (pEntry == nullptr)
         {
-            MutexAuto                     archiveFileLock { &m_archiveFileMutex };
-            RWLockAuto<RWLock::ReadWrite> entryMapLock { &m_entryMapLock };
+            TimedMutexAuto                    archiveFileLock { &m_archiveFileMutex, Stats() };
+            TimedRWLockAuto<RWLock::ReadWrite> entryMapLock { &m_entryMapLock, Stats() };
 
             const size_t oldEntryCount = m_entries.GetNumEntries();
             Result       refreshResult = RefreshHeaders();
@@ -135,6 +137,7 @@ Result FileArchiveCacheLayer::QueryInternal(
             pQuery->pLayer          = this;
             pQuery->hashId          = *pHashId;
             pQuery->dataSize        = pEntry->dataSize;
+            pQuery->tag             = pEntry->tag;
             pQuery->context.entryId = pEntry->ordinalId;
 
             result = Result::Success;
@@ -151,9 +154,10 @@ Result FileArchiveCacheLayer::QueryInternal(
 // =====================================================================================================================
 // Add data passed in to the cache
 Result FileArchiveCacheLayer::StoreInternal(
-    const Hash128* pHashId,
-    const void*    pData,
-    size_t         dataSize)
+    const Hash128*       pHashId,
+    const void*          pData,
+    size_t               dataSize,
+    const CacheEntryTag& tag)
 {
     PAL_ASSERT(pHashId != nullptr);
     PAL_ASSERT(pData != nullptr);
@@ -172,7 +176,7 @@ Result FileArchiveCacheLayer::StoreInternal(
         ConvertToEntryKey(pHashId, &key);
 
         {
-            RWLockAuto<RWLock::ReadOnly> entryMapLock { &m_entryMapLock };
+            TimedRWLockAuto<RWLock::ReadOnly> entryMapLock { &m_entryMapLock, Stats() };
 
             if (m_entries.FindKey(key) != nullptr)
             {
@@ -201,11 +205,22 @@ Result FileArchiveCacheLayer::StoreInternal(
         // Write the scratch buffer to the file
         if (result == Result::Success)
         {
-            MutexAuto archiveFileLock { &m_archiveFileMutex };
+            TimedMutexAuto archiveFileLock { &m_archiveFileMutex, Stats() };
 
             void* const pDataMem = pMem;
             header.dataSize      = static_cast<uint32>(writeDataSize);
-            header.metaValue     = static_cast<uint32>(dataSize);
+
+            // Untagged data is recorded the way it always has been.
+            if (tag.dataType != 0)
+            {
+                header.dataType  = tag.dataType;
+                header.metaValue = tag.metaValue;
+            }
+            else
+            {
+                header.dataType  = m_dataTypeId;
+                header.metaValue = static_cast<uint32>(writeDataSize);
+            }
 
             memcpy(pDataMem, pData, dataSize);
             memcpy(header.entryKey, key.value, sizeof(EntryKey));
@@ -216,7 +231,7 @@ Result FileArchiveCacheLayer::StoreInternal(
         // Only insert this entry into our lookup table if everything succeeded
         if (result == Result::Success)
         {
-            RWLockAuto<RWLock::ReadWrite> entryMapLock { &m_entryMapLock };
+            TimedRWLockAuto<RWLock::ReadWrite> entryMapLock { &m_entryMapLock, Stats() };
 
             result = AddHeaderToTable(header);
         }
@@ -259,7 +274,7 @@ Result FileArchiveCacheLayer::LoadInternal(
 #if DEBUG
     if (result == Result::Success)
     {
-        RWLockAuto<RWLock::ReadOnly> entryMapLock { &m_entryMapLock };
+        TimedRWLockAuto<RWLock::ReadOnly> entryMapLock { &m_entryMapLock, Stats() };
 
         EntryKey key;
         ConvertToEntryKey(&pQuery->hashId, &key);
@@ -277,7 +292,7 @@ Result FileArchiveCacheLayer::LoadInternal(
 
     if (result == Result::Success)
     {
-        MutexAuto archiveFileLock { &m_archiveFileMutex };
+        TimedMutexAuto archiveFileLock { &m_archiveFileMutex, Stats() };
 
         size_t entryId = static_cast<size_t>(pQuery->context.entryId);
         result         = m_pArchivefile->GetEntryByIndex(entryId, &header);
@@ -286,10 +301,10 @@ Result FileArchiveCacheLayer::LoadInternal(
     if (result == Result::Success)
     {
         PAL_ALERT(header.ordinalId != pQuery->context.entryId);
-        PAL_ALERT(header.metaValue > pQuery->dataSize);
+        PAL_ALERT(header.dataSize > pQuery->dataSize);
 
         const size_t readSize      = header.dataSize;
-        const size_t dataSize      = header.metaValue;
+        const size_t dataSize      = header.dataSize;
 
         void* const pReadMem = PAL_MALLOC(readSize, Allocator(), AllocInternalTemp);
         void* const pDataMem = pReadMem;
@@ -301,7 +316,7 @@ Result FileArchiveCacheLayer::LoadInternal(
 
         if (result == Result::Success)
         {
-            MutexAuto archiveFileLock { &m_archiveFileMutex };
+            TimedMutexAuto archiveFileLock { &m_archiveFileMutex, Stats() };
 
             result = m_pArchivefile->Read(&header, pReadMem);
 
@@ -413,7 +428,8 @@ Result CreateArchiveFileCacheLayer(
             (pCreateInfo->baseInfo.pCallbacks == nullptr) ? callbacks : *pCreateInfo->baseInfo.pCallbacks,
             pCreateInfo->pFile,
             pBaseContext,
-            pTempContextMem);
+            pTempContextMem,
+            pCreateInfo->dataTypeId);
 
         result = pLayer->Init();
 
@@ -446,7 +462,9 @@ Result FileArchiveCacheLayer::AddHeaderToTable(
 
     memcpy(key.value, header.entryKey, sizeof(header.entryKey));
 
-    return m_entries.Insert(key, {header.ordinalId, header.metaValue});
+    const CacheEntryTag tag = { header.dataType, header.metaValue };
+
+    return m_entries.Insert(key, {header.ordinalId, header.dataSize, tag});
 }
 
 // =====================================================================================================================
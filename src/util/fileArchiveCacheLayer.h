@@ -45,7 +45,8 @@ public:
         const AllocCallbacks& callbacks,
         IArchiveFile*         pArchiveFile,
         IHashContext*         pBaseContext,
-        void*                 pTemContextMem);
+        void*                 pTemContextMem,
+        uint32                dataTypeId);
     virtual ~FileArchiveCacheLayer();
 
     virtual Result Init() override;
@@ -57,9 +58,10 @@ protected:
         QueryResult*    pQuery) override;
 
     virtual Result StoreInternal(
-        const Hash128*  pHashId,
-        const void*     pData,
-        size_t          dataSize) override;
+        const Hash128*       pHashId,
+        const void*          pData,
+        size_t               dataSize,
+        const CacheEntryTag& tag) override;
 
     virtual Result LoadInternal(
         const QueryResult* pQuery,
@@ -82,8 +84,9 @@ private:
     // Container types
     struct Entry
     {
-        uint64 ordinalId;
-        size_t dataSize;
+        uint64        ordinalId;
+        size_t        dataSize;
+        CacheEntryTag tag;       // ArchiveEntryHeader::dataType and metaValue
     };
     using EntryMap = HashMap<EntryKey, Entry, ForwardAllocator, JenkinsHashFunc>;
 
@@ -98,6 +101,7 @@ private:
     IArchiveFile* const  m_pArchivefile;
     IHashContext* const  m_pBaseContext;
     void* const          m_pTempContextMem;
+    const uint32         m_dataTypeId;
 
     Mutex                m_archiveFileMutex;
     Mutex                m_hashContextMutex;
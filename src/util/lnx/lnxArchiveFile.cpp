@@ -26,6 +26,7 @@
 #include "util/lnx/lnxArchiveFile.h"
 
 #include "palAssert.h"
+#include "palHashSetImpl.h"
 #include "palInlineFuncs.h"
 #include "palIntrusiveListImpl.h"
 #include "palMetroHash.h"
@@ -246,27 +247,41 @@ static Result CreateDir(
 }
 
 // =====================================================================================================================
-// Initialize a newly created file
-static Result CreateFileInternal(
-    const char*                pFileName,
-    const ArchiveFileOpenInfo* pOpenInfo)
+// Fill out the header of a new archive file described by pOpenInfo
+static void InitFileHeader(
+    const ArchiveFileOpenInfo* pOpenInfo,
+    ArchiveFileHeader*         pHeader)
+{
+    memcpy(pHeader->archiveMarker, MagicArchiveMarker, sizeof(pHeader->archiveMarker));
+    pHeader->majorVersion = CurrentMajorVersion;
+    pHeader->minorVersion = CurrentMinorVersion;
+    pHeader->archiveType  = pOpenInfo->archiveType;
+
+    memset(pHeader->platformKey, 0, sizeof(pHeader->platformKey));
+    if (pOpenInfo->pPlatformKey)
+    {
+        memcpy(
+            pHeader->platformKey,
+            pOpenInfo->pPlatformKey->GetKey(),
+            Min(sizeof(pHeader->platformKey), pOpenInfo->pPlatformKey->GetKeySize()));
+    }
+}
+
+// =====================================================================================================================
+// Write an empty archive with the given header to a file which must not already exist
+static Result WriteNewFile(
+    const char*              pFileName,
+    const ArchiveFileHeader& header)
 {
     PAL_ASSERT(pFileName != nullptr);
-    PAL_ASSERT(pOpenInfo != nullptr);
 
-#if PAL_CLIENT_INTERFACE_MAJOR_VERSION < 641
-    Result result = CreateDir(pOpenInfo->filePath);
-#else
-    Result result = CreateDir(pOpenInfo->pFilePath);
-#endif
+    Result result = Result::Success;
 
-    if (result == Result::Success)
+    if (access(pFileName, F_OK) == 0)
     {
-        if (access(pFileName, F_OK) == 0)
-        {
-            result = Result::AlreadyExists;
-        }
+        result = Result::AlreadyExists;
     }
+
     if (result == Result::Success)
     {
         int32 fd = open(pFileName, O_RDWR | O_CREAT | O_TRUNC, S_IRWXU);
@@ -285,20 +300,8 @@ static Result CreateFileInternal(
                 ArchiveFileFooter footer;
             } data;
 
-            memcpy(data.header.archiveMarker, MagicArchiveMarker, sizeof(data.header.archiveMarker));
-            data.header.majorVersion = CurrentMajorVersion;
-            data.header.minorVersion = CurrentMinorVersion;
-            data.header.firstBlock   = static_cast<uint32>(VoidPtrDiff(&data.footer, &data));
-            data.header.archiveType  = pOpenInfo->archiveType;
-
-            memset(data.header.platformKey, 0, sizeof(data.header.platformKey));
-            if (pOpenInfo->pPlatformKey)
-            {
-                memcpy(
-                    data.header.platformKey,
-                    pOpenInfo->pPlatformKey->GetKey(),
-                    Min(sizeof(data.header.platformKey), pOpenInfo->pPlatformKey->GetKeySize()));
-            }
+            data.header            = header;
+            data.header.firstBlock = static_cast<uint32>(VoidPtrDiff(&data.footer, &data));
 
             memcpy(data.footer.footerMarker, MagicFooterMarker, sizeof(data.footer.footerMarker));
             data.footer.entryCount         = 0;
@@ -324,6 +327,32 @@ static Result CreateFileInternal(
     return result;
 }
 
+// =====================================================================================================================
+// Initialize a newly created file
+static Result CreateFileInternal(
+    const char*                pFileName,
+    const ArchiveFileOpenInfo* pOpenInfo)
+{
+    PAL_ASSERT(pFileName != nullptr);
+    PAL_ASSERT(pOpenInfo != nullptr);
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION < 641
+    Result result = CreateDir(pOpenInfo->filePath);
+#else
+    Result result = CreateDir(pOpenInfo->pFilePath);
+#endif
+
+    if (result == Result::Success)
+    {
+        ArchiveFileHeader header = {};
+        InitFileHeader(pOpenInfo, &header);
+
+        result = WriteNewFile(pFileName, header);
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Convert ArchiveFileOpenInfo flags and make OS calls to open the file
 static Result OpenFileInternal(
@@ -369,6 +398,26 @@ static Result OpenFileInternal(
     return result;
 }
 
+// =====================================================================================================================
+// Check that an archive was written for the given platform
+static bool PlatformKeyMatches(
+    const IPlatformKey*      pPlatformKey,
+    const ArchiveFileHeader* pHeader)
+{
+    const size_t headerKeySize   = sizeof(pHeader->platformKey);
+    const size_t platformKeySize = pPlatformKey->GetKeySize();
+
+    uint8 tmpKey[headerKeySize];
+    memset(tmpKey, 0, headerKeySize);
+
+    memcpy(
+        tmpKey,
+        pPlatformKey->GetKey(),
+        Min(headerKeySize, platformKeySize));
+
+    return (memcmp(pHeader->platformKey, tmpKey, headerKeySize) == 0);
+}
+
 // =====================================================================================================================
 // Verify if the opened file satisfies the open request
 static Result ValidateFile(
@@ -395,21 +444,7 @@ static Result ValidateFile(
     }
     else if (pOpenInfo->pPlatformKey != nullptr)
     {
-        const size_t headerKeySize   = sizeof(pHeader->platformKey);
-        const size_t platformKeySize = pOpenInfo->pPlatformKey->GetKeySize();
-
-        uint8 tmpKey[headerKeySize];
-        memset(tmpKey, 0, headerKeySize);
-
-        memcpy(
-            tmpKey,
-            pOpenInfo->pPlatformKey->GetKey(),
-            Min(headerKeySize, platformKeySize));
-
-        if (memcmp(pHeader->platformKey, tmpKey, headerKeySize) != 0)
-        {
-            valid = false;
-        }
+        valid = PlatformKeyMatches(pOpenInfo->pPlatformKey, pHeader);
     }
     else if ((pOpenInfo->archiveType != 0) &&
              (pOpenInfo->archiveType != pHeader->archiveType))
@@ -1301,4 +1336,369 @@ Result DeleteArchiveFile(
     return result;
 }
 
+// =====================================================================================================================
+// Suffix of the file a compacted archive is written to before it replaces the original
+static constexpr char CompactFileSuffix[] = ".compact";
+
+// Key and set types used to find duplicate entries during compaction
+struct CompactEntryKey
+{
+    uint8 value[sizeof(ArchiveEntryHeader::entryKey)];
+};
+using CompactEntryKeySet = HashSet<CompactEntryKey, ForwardAllocator, JenkinsHashFunc>;
+
+// An entry which will be copied to the compacted archive
+struct CompactEntry
+{
+    uint64 rank;
+    uint32 index;   // Index of the entry in the original archive
+};
+
+// =====================================================================================================================
+// qsort comparator which orders entries by rank and then by their position in the original archive
+static int CompareCompactEntries(
+    const void* pLhs,
+    const void* pRhs)
+{
+    const CompactEntry& lhs = *static_cast<const CompactEntry*>(pLhs);
+    const CompactEntry& rhs = *static_cast<const CompactEntry*>(pRhs);
+
+    int order = 0;
+
+    if (lhs.rank != rhs.rank)
+    {
+        order = (lhs.rank < rhs.rank) ? -1 : 1;
+    }
+    else if (lhs.index != rhs.index)
+    {
+        order = (lhs.index < rhs.index) ? -1 : 1;
+    }
+
+    return order;
+}
+
+// =====================================================================================================================
+// Helper to get the size of a file on disc, or zero if it does not exist
+static uint64 GetFileSize(
+    const char* pFileName)
+{
+    struct stat statBuf;
+
+    return (stat(pFileName, &statBuf) == 0) ? static_cast<uint64>(statBuf.st_size) : 0;
+}
+
+// =====================================================================================================================
+// Choose which entries of the original archive are copied, and in which order. Fills pOrder and returns the count.
+static Result SelectCompactEntries(
+    const ArchiveFileCompactInfo* pCompactInfo,
+    const ArchiveEntryHeader*     pHeaders,
+    uint32                        entryCount,
+    bool                          keyMatches,
+    ForwardAllocator*             pAllocator,
+    CompactEntry*                 pOrder,
+    uint32*                       pOrderCount,
+    ArchiveFileCompactStats*      pStats)
+{
+    CompactEntryKeySet keys(2048, pAllocator);
+    Result             result = keys.Init();
+
+    for (uint32 i = 0; (i < entryCount) && (result == Result::Success); ++i)
+    {
+        const ArchiveEntryHeader& header = pHeaders[i];
+
+        CompactEntryKey key;
+        memcpy(key.value, header.entryKey, sizeof(key.value));
+
+        if ((keyMatches == false) ||
+            ((pCompactInfo->pfnFilter != nullptr) && (pCompactInfo->pfnFilter(pCompactInfo->pUserData, header) == false)))
+        {
+            pStats->filteredCount++;
+        }
+        else if (keys.Contains(key))
+        {
+            pStats->duplicateCount++;
+        }
+        else
+        {
+            result = keys.Insert(key);
+
+            CompactEntry* pEntry = &pOrder[(*pOrderCount)++];
+            pEntry->index = i;
+            pEntry->rank  = (pCompactInfo->pfnRank != nullptr) ? pCompactInfo->pfnRank(pCompactInfo->pUserData, header)
+                                                               : 0;
+        }
+    }
+
+    if ((result == Result::Success) && (pCompactInfo->pfnRank != nullptr))
+    {
+        qsort(pOrder, *pOrderCount, sizeof(CompactEntry), &CompareCompactEntries);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Copy the selected entries from one archive to another.
+static Result CopyCompactEntries(
+    IArchiveFile*             pSrcFile,
+    IArchiveFile*             pDstFile,
+    const ArchiveEntryHeader* pHeaders,
+    const CompactEntry*       pOrder,
+    uint32                    orderCount,
+    ForwardAllocator*         pAllocator,
+    ArchiveFileCompactStats*  pStats)
+{
+    Result result       = Result::Success;
+    void*  pData        = nullptr;
+    size_t dataCapacity = 0;
+
+    for (uint32 i = 0; (i < orderCount) && (result == Result::Success); ++i)
+    {
+        const ArchiveEntryHeader& srcHeader = pHeaders[pOrder[i].index];
+
+        if ((srcHeader.dataSize > dataCapacity) || (pData == nullptr))
+        {
+            PAL_SAFE_FREE(pData, pAllocator);
+
+            dataCapacity = Max<size_t>(srcHeader.dataSize, 1);
+            pData        = PAL_MALLOC(dataCapacity, pAllocator, AllocInternalTemp);
+
+            if (pData == nullptr)
+            {
+                result = Result::ErrorOutOfMemory;
+                break;
+            }
+        }
+
+        const Result readResult = pSrcFile->Read(&srcHeader, pData);
+
+        if ((readResult == Result::ErrorIncompatibleLibrary) || (readResult == Result::ErrorInvalidValue))
+        {
+            // The data failed its checksum or lies outside of the file.
+            pStats->corruptCount++;
+        }
+        else if (readResult != Result::Success)
+        {
+            result = readResult;
+        }
+        else
+        {
+            ArchiveEntryHeader dstHeader = {};
+
+            dstHeader.dataSize  = srcHeader.dataSize;
+            dstHeader.dataType  = srcHeader.dataType;
+            dstHeader.metaValue = srcHeader.metaValue;
+            memcpy(dstHeader.entryKey, srcHeader.entryKey, sizeof(dstHeader.entryKey));
+
+            result = pDstFile->Write(&dstHeader, pData);
+
+            if (result == Result::Success)
+            {
+                pStats->entryCountAfter++;
+            }
+        }
+    }
+
+    PAL_SAFE_FREE(pData, pAllocator);
+
+    return result;
+}
+
+// =====================================================================================================================
+// Rewrite an archive with only its live entries and swap it in place of the original
+static Result CompactArchiveFileInternal(
+    const ArchiveFileCompactInfo* pCompactInfo,
+    ForwardAllocator*             pAllocator,
+    ArchiveFileCompactStats*      pStats)
+{
+    const ArchiveFileOpenInfo* pOpenInfo = pCompactInfo->pOpenInfo;
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION < 641
+    char srcPath[MaxPathLength + MaxFilenameLength + 1] = {};
+    char dstPath[MaxPathLength + MaxFilenameLength + 1] = {};
+#else
+    char srcPath[PathBufferLen]     = {};
+    char dstPath[PathBufferLen]     = {};
+    char dstName[FilenameBufferLen] = {};
+#endif
+
+    GenerateFullPath(srcPath, sizeof(srcPath), pOpenInfo);
+    Strncpy(dstPath, srcPath, sizeof(dstPath));
+    Strncat(dstPath, sizeof(dstPath), CompactFileSuffix);
+
+    // The platform key is checked here rather than by OpenArchiveFile so that a mismatch drops the entries instead of
+    // failing the open.
+    ArchiveFileOpenInfo srcInfo   = *pOpenInfo;
+    srcInfo.pPlatformKey          = nullptr;
+    srcInfo.allowCreateFile       = false;
+    srcInfo.allowWriteAccess      = false;
+    srcInfo.allowAsyncFileIo      = false;
+    srcInfo.useBufferedReadMemory = false;
+
+    ArchiveFileOpenInfo dstInfo = srcInfo;
+    dstInfo.allowWriteAccess    = true;
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION < 641
+    Strncat(dstInfo.fileName, sizeof(dstInfo.fileName), CompactFileSuffix);
+#else
+    Strncpy(dstName, pOpenInfo->pFileName, sizeof(dstName));
+    Strncat(dstName, sizeof(dstName), CompactFileSuffix);
+    dstInfo.pFileName = dstName;
+#endif
+
+    IArchiveFile*       pSrcFile = nullptr;
+    IArchiveFile*       pDstFile = nullptr;
+    ArchiveEntryHeader* pHeaders = nullptr;
+    CompactEntry*       pOrder   = nullptr;
+    uint32              count    = 0;
+
+    void* pSrcMem = PAL_MALLOC(GetArchiveFileObjectSize(&srcInfo), pAllocator, AllocInternalTemp);
+    void* pDstMem = PAL_MALLOC(GetArchiveFileObjectSize(&dstInfo), pAllocator, AllocInternalTemp);
+
+    Result result = ((pSrcMem != nullptr) && (pDstMem != nullptr)) ? Result::Success : Result::ErrorOutOfMemory;
+
+    if (result == Result::Success)
+    {
+        result = OpenArchiveFile(&srcInfo, pSrcMem, &pSrcFile);
+    }
+
+    if (result == Result::Success)
+    {
+        pStats->fileSizeBefore   = GetFileSize(srcPath);
+        pStats->entryCountBefore = static_cast<uint32>(pSrcFile->GetEntryCount());
+
+        if (pStats->entryCountBefore > 0)
+        {
+            pHeaders = static_cast<ArchiveEntryHeader*>(
+                PAL_MALLOC(sizeof(ArchiveEntryHeader) * pStats->entryCountBefore, pAllocator, AllocInternalTemp));
+            pOrder   = static_cast<CompactEntry*>(
+                PAL_MALLOC(sizeof(CompactEntry) * pStats->entryCountBefore, pAllocator, AllocInternalTemp));
+
+            if ((pHeaders == nullptr) || (pOrder == nullptr))
+            {
+                result = Result::ErrorOutOfMemory;
+            }
+            else
+            {
+                size_t filled = 0;
+                result = pSrcFile->FillEntryHeaderTable(pHeaders, 0, pStats->entryCountBefore, &filled);
+                PAL_ASSERT((result != Result::Success) || (filled == pStats->entryCountBefore));
+            }
+        }
+    }
+
+    ArchiveFileHeader dstHeader = {};
+
+    if (result == Result::Success)
+    {
+        const ArchiveFileHeader& srcHeader  = static_cast<ArchiveFile*>(pSrcFile)->GetHeader();
+        const bool               keyMatches = (pOpenInfo->pPlatformKey == nullptr) ||
+                                              PlatformKeyMatches(pOpenInfo->pPlatformKey, &srcHeader);
+
+        dstHeader = srcHeader;
+
+        if (keyMatches == false)
+        {
+            ArchiveFileHeader keyHeader = {};
+            InitFileHeader(pOpenInfo, &keyHeader);
+            memcpy(dstHeader.platformKey, keyHeader.platformKey, sizeof(dstHeader.platformKey));
+        }
+
+        result = SelectCompactEntries(pCompactInfo,
+                                      pHeaders,
+                                      pStats->entryCountBefore,
+                                      keyMatches,
+                                      pAllocator,
+                                      pOrder,
+                                      &count,
+                                      pStats);
+    }
+
+    if (result == Result::Success)
+    {
+        // Clear out anything left behind by an earlier compaction which did not finish.
+        remove(dstPath);
+
+        result = WriteNewFile(dstPath, dstHeader);
+    }
+
+    if (result == Result::Success)
+    {
+        result = OpenArchiveFile(&dstInfo, pDstMem, &pDstFile);
+
+        if (result != Result::Success)
+        {
+            remove(dstPath);
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        result = CopyCompactEntries(pSrcFile, pDstFile, pHeaders, pOrder, count, pAllocator, pStats);
+
+        pDstFile->Destroy();
+
+        // Replace the original while we still hold its lock, so nobody can open it in between.
+        if ((result == Result::Success) && (rename(dstPath, srcPath) == InvalidSysCall))
+        {
+            result = Result::ErrorUnknown;
+        }
+
+        if (result == Result::Success)
+        {
+            pStats->fileSizeAfter = GetFileSize(srcPath);
+        }
+        else
+        {
+            remove(dstPath);
+        }
+    }
+
+    if (pSrcFile != nullptr)
+    {
+        pSrcFile->Destroy();
+    }
+
+    PAL_SAFE_FREE(pOrder, pAllocator);
+    PAL_SAFE_FREE(pHeaders, pAllocator);
+    PAL_SAFE_FREE(pDstMem, pAllocator);
+    PAL_SAFE_FREE(pSrcMem, pAllocator);
+
+    return result;
+}
+
+// =====================================================================================================================
+// Rewrite an archive file with only its live entries
+Result CompactArchiveFile(
+    const ArchiveFileCompactInfo* pCompactInfo,
+    ArchiveFileCompactStats*      pStats)
+{
+    PAL_ASSERT(pCompactInfo != nullptr);
+
+    Result                  result = Result::ErrorInvalidPointer;
+    ArchiveFileCompactStats stats  = {};
+
+    if ((pCompactInfo != nullptr) &&
+        (pCompactInfo->pOpenInfo != nullptr))
+    {
+        const ArchiveFileOpenInfo* pOpenInfo = pCompactInfo->pOpenInfo;
+        AllocCallbacks             callbacks = {};
+
+        if (pOpenInfo->pMemoryCallbacks == nullptr)
+        {
+            Pal::GetDefaultAllocCb(&callbacks);
+        }
+
+        ForwardAllocator allocator((pOpenInfo->pMemoryCallbacks == nullptr) ? callbacks : *pOpenInfo->pMemoryCallbacks);
+
+        result = CompactArchiveFileInternal(pCompactInfo, &allocator, &stats);
+    }
+
+    if (pStats != nullptr)
+    {
+        *pStats = stats;
+    }
+
+    return result;
+}
+
 } //namespace Util
@@ -73,6 +73,8 @@ public:
 
     virtual void   Destroy() override { this->~ArchiveFile(); }
 
+    const ArchiveFileHeader& GetHeader() const { return m_archiveHeader; }
+
 private:
     PAL_DISALLOW_DEFAULT_CTOR(ArchiveFile);
     PAL_DISALLOW_COPY_AND_ASSIGN(ArchiveFile);
@@ -0,0 +1,284 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "lzCodec.h"
+#include "palInlineFuncs.h"
+
+#include <cstring>
+
+namespace Util
+{
+
+// =====================================================================================================================
+// The LZ codec uses a byte-oriented LZ77 format. The data is a series of sequences, each consisting of:
+//  - A token byte. The high nibble is the literal count and the low nibble is the match length minus LzMinMatch. A
+//    nibble of 15 means the count continues in the following bytes, each adding up to 255 until a byte below 255.
+//  - The literal bytes.
+//  - A 16-bit little-endian match offset, counted back from the current output position.
+// The final sequence holds only literals and ends the data.
+
+static constexpr size_t LzMinMatch  = 4;
+static constexpr size_t LzMaxOffset = UINT16_MAX;
+static constexpr uint32 LzHashBits  = 12;
+
+static_assert(LzHashTableEntries == (1 << LzHashBits), "The hash table size doesn't match the hash width.");
+
+// =====================================================================================================================
+static uint32 LzHash(
+    const uint8* pSrc)
+{
+    uint32 sequence;
+    memcpy(&sequence, pSrc, sizeof(sequence));
+
+    return (sequence * 2654435761u) >> (32 - LzHashBits);
+}
+
+// =====================================================================================================================
+// Returns the number of bytes needed to encode the part of a count which does not fit in a token nibble.
+static size_t LzCountExtraBytes(
+    size_t count)
+{
+    return (count >= 15) ? (((count - 15) / 255) + 1) : 0;
+}
+
+// =====================================================================================================================
+static uint8* LzWriteCountExtraBytes(
+    uint8* pDst,
+    size_t count)
+{
+    if (count >= 15)
+    {
+        count -= 15;
+
+        while (count >= 255)
+        {
+            *(pDst++) = 255;
+            count    -= 255;
+        }
+
+        *(pDst++) = static_cast<uint8>(count);
+    }
+
+    return pDst;
+}
+
+// =====================================================================================================================
+// Appends one sequence to the compressed data. A matchLength of zero writes the final, literal-only sequence. Returns
+// false if the sequence does not fit in the destination.
+static bool LzWriteSequence(
+    uint8**      ppDst,
+    const uint8* pDstEnd,
+    const uint8* pLiterals,
+    size_t       literalCount,
+    size_t       matchOffset,
+    size_t       matchLength)
+{
+    const size_t matchCount = (matchLength > 0) ? (matchLength - LzMinMatch) : 0;
+    const size_t seqSize    = 1 + LzCountExtraBytes(literalCount) + literalCount +
+                              ((matchLength > 0) ? (sizeof(uint16) + LzCountExtraBytes(matchCount)) : 0);
+
+    const bool fits = (seqSize <= static_cast<size_t>(pDstEnd - *ppDst));
+
+    if (fits)
+    {
+        uint8* pDst = *ppDst;
+
+        *(pDst++) = static_cast<uint8>((Min<size_t>(literalCount, 15) << 4) | Min<size_t>(matchCount, 15));
+        pDst      = LzWriteCountExtraBytes(pDst, literalCount);
+
+        memcpy(pDst, pLiterals, literalCount);
+        pDst += literalCount;
+
+        if (matchLength > 0)
+        {
+            *(pDst++) = static_cast<uint8>(matchOffset & 0xFF);
+            *(pDst++) = static_cast<uint8>(matchOffset >> 8);
+            pDst      = LzWriteCountExtraBytes(pDst, matchCount);
+        }
+
+        *ppDst = pDst;
+    }
+
+    return fits;
+}
+
+// =====================================================================================================================
+size_t LzCompress(
+    const void* pSrcData,
+    size_t      srcSize,
+    void*       pDstData,
+    size_t      dstCapacity,
+    size_t*     pHashTable)
+{
+    const uint8*const pSrc = static_cast<const uint8*>(pSrcData);
+    uint8*const       pDst = static_cast<uint8*>(pDstData);
+
+    // Each slot holds one plus the most recent source position with that hash, or zero if there is none.
+    memset(pHashTable, 0, sizeof(size_t) * LzHashTableEntries);
+
+    const uint8* const pDstEnd = pDst + dstCapacity;
+    uint8*             pOut    = pDst;
+    size_t             anchor  = 0;
+    size_t             pos     = 0;
+    bool               fits    = true;
+
+    while (fits && ((pos + LzMinMatch) <= srcSize))
+    {
+        const uint32 hash      = LzHash(pSrc + pos);
+        const size_t candidate = pHashTable[hash];
+
+        pHashTable[hash] = pos + 1;
+
+        if ((candidate != 0) &&
+            ((pos - (candidate - 1)) <= LzMaxOffset) &&
+            (memcmp(pSrc + candidate - 1, pSrc + pos, LzMinMatch) == 0))
+        {
+            const size_t matchPos    = candidate - 1;
+            size_t       matchLength = LzMinMatch;
+
+            while (((pos + matchLength) < srcSize) && (pSrc[matchPos + matchLength] == pSrc[pos + matchLength]))
+            {
+                matchLength++;
+            }
+
+            fits = LzWriteSequence(&pOut, pDstEnd, pSrc + anchor, pos - anchor, pos - matchPos, matchLength);
+
+            pos   += matchLength;
+            anchor = pos;
+        }
+        else
+        {
+            pos++;
+        }
+    }
+
+    if (fits)
+    {
+        fits = LzWriteSequence(&pOut, pDstEnd, pSrc + anchor, srcSize - anchor, 0, 0);
+    }
+
+    return fits ? static_cast<size_t>(pOut - pDst) : 0;
+}
+
+// =====================================================================================================================
+static bool LzReadCount(
+    const uint8* pSrc,
+    size_t       srcSize,
+    size_t*      pIn,
+    size_t*      pCount)
+{
+    bool valid = true;
+
+    if (*pCount == 15)
+    {
+        uint8 value = 255;
+
+        while (valid && (value == 255))
+        {
+            valid = (*pIn < srcSize);
+
+            if (valid)
+            {
+                value    = pSrc[(*pIn)++];
+                *pCount += value;
+            }
+        }
+    }
+
+    return valid;
+}
+
+// =====================================================================================================================
+bool LzDecompress(
+    const void* pSrcData,
+    size_t      srcSize,
+    void*       pDstData,
+    size_t      dstSize)
+{
+    const uint8*const pSrc = static_cast<const uint8*>(pSrcData);
+    uint8*const       pDst = static_cast<uint8*>(pDstData);
+
+    size_t in    = 0;
+    size_t out   = 0;
+    bool   valid = true;
+
+    while (valid && (in < srcSize))
+    {
+        const uint8 token        = pSrc[in++];
+        size_t      literalCount = token >> 4;
+
+        valid = LzReadCount(pSrc, srcSize, &in, &literalCount) &&
+                (literalCount <= (srcSize - in))               &&
+                (literalCount <= (dstSize - out));
+
+        if (valid)
+        {
+            memcpy(pDst + out, pSrc + in, literalCount);
+            in  += literalCount;
+            out += literalCount;
+
+            // The final sequence has no match.
+            if (in < srcSize)
+            {
+                valid = ((srcSize - in) >= sizeof(uint16));
+
+                size_t matchOffset = 0;
+                size_t matchLength = token & 0xF;
+
+                if (valid)
+                {
+                    matchOffset = pSrc[in] | (pSrc[in + 1] << 8);
+                    in         += sizeof(uint16);
+
+                    valid = LzReadCount(pSrc, srcSize, &in, &matchLength);
+                }
+
+                matchLength += LzMinMatch;
+
+                if (valid)
+                {
+                    valid = (matchOffset != 0) && (matchOffset <= out) && (matchLength <= (dstSize - out));
+                }
+
+                if (valid)
+                {
+                    // Matches may overlap the bytes they produce, so this must be copied a byte at a time.
+                    const uint8* pMatch = pDst + out - matchOffset;
+
+                    for (size_t i = 0; i < matchLength; ++i)
+                    {
+                        pDst[out + i] = pMatch[i];
+                    }
+
+                    out += matchLength;
+                }
+            }
+        }
+    }
+
+    return valid && (out == dstSize);
+}
+
+} // Util
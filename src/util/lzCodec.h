@@ -0,0 +1,50 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "palUtil.h"
+
+namespace Util
+{
+
+// The LZ codec is a byte-oriented LZ77 format which favours decompression speed over compression ratio. It is shared
+// by the compressing cache layer and the asynchronous command buffer dump writer. See lzCodec.cpp for the format.
+
+// Number of entries in the scratch hash table LzCompress() needs.
+constexpr size_t LzHashTableEntries = 4096;
+
+// The worst case expansion of LZ data is a run of 255 bytes of match length per input byte.
+constexpr size_t LzMaxRatio = 255;
+
+// Compresses srcSize bytes into pDst. Returns the compressed size, or zero if it would not fit in dstCapacity bytes.
+// pHashTable must hold LzHashTableEntries entries; its contents on entry don't matter.
+extern size_t LzCompress(const void* pSrc, size_t srcSize, void* pDst, size_t dstCapacity, size_t* pHashTable);
+
+// Decompresses pSrc into exactly dstSize bytes. Returns false if the compressed data is malformed or does not produce
+// dstSize bytes.
+extern bool LzDecompress(const void* pSrc, size_t srcSize, void* pDst, size_t dstSize);
+
+} // Util
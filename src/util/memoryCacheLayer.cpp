@@ -29,33 +29,94 @@
 #include "palAssert.h"
 #include "core/platform.h"
 
+#include <cstdlib>
+
 namespace Util
 {
 
+// Limit on the data queued for the flush thread when the client doesn't provide one.
+static constexpr size_t DefaultMaxBatchedSize = 16 * 1024 * 1024;
+
+// Prefetch requests are split into batches of this many hashes so that the prefetch threads can share a large request
+// while each batch is still big enough to order its reads from the next layer.
+static constexpr uint32 PrefetchBatchSize = 64;
+
 // =====================================================================================================================
 MemoryCacheLayer::MemoryCacheLayer(
     const AllocCallbacks& callbacks,
     size_t                maxMemorySize,
     size_t                maxObjectCount,
     bool                  evictOnFull,
-    bool                  evictDuplicates)
+    bool                  evictDuplicates,
+    size_t                maxBatchedSize,
+    bool                  frequencyAdmission)
     :
-    CacheLayerBase    { callbacks },
-    m_maxSize         { maxMemorySize },
-    m_maxCount        { maxObjectCount },
-    m_evictOnFull     { evictOnFull },
-    m_evictDuplicates { evictDuplicates },
-    m_lock            {},
-    m_curSize         { 0 },
-    m_curCount        { 0 },
-    m_recentEntryList {},
-    m_entryLookup     { 2048, Allocator() }
+    CacheLayerBase       { callbacks },
+    m_maxSize            { maxMemorySize },
+    m_maxCount           { maxObjectCount },
+    m_evictOnFull        { evictOnFull },
+    m_evictDuplicates    { evictDuplicates },
+    m_lock               {},
+    m_curSize            { 0 },
+    m_curCount           { 0 },
+    m_recentEntryList    {},
+    m_protectedEntryList {},
+    m_entryLookup        { 2048, Allocator() },
+    m_frequencyAdmission { frequencyAdmission && evictOnFull },
+    m_maxProtectedSize   { (maxMemorySize / 5) * 4 },
+    m_protectedSize      { 0 },
+    m_frequencySketch    {},
+    m_maxBatchedSize     { (maxBatchedSize != 0) ? maxBatchedSize : DefaultMaxBatchedSize },
+    m_batchedSize        { 0 },
+    m_batchedStores      {},
+    m_flushThreadEnd     { false },
+    m_prefetchBatches    {},
+    m_prefetchThreadEnd  { false }
 {
 }
 
 // =====================================================================================================================
 MemoryCacheLayer::~MemoryCacheLayer()
 {
+    // Prefetches are only hints, so stop the prefetch threads without waiting for the queue to drain.
+    m_prefetchThreadEnd = true;
+
+    for (uint32 i = 0; i < PrefetchThreadCount; ++i)
+    {
+        if (m_prefetchThreads[i].IsCreated())
+        {
+            m_prefetchNotify.Post();
+        }
+    }
+
+    for (uint32 i = 0; i < PrefetchThreadCount; ++i)
+    {
+        if (m_prefetchThreads[i].IsCreated())
+        {
+            PAL_ASSERT(m_prefetchThreads[i].IsNotCurrentThread());
+            m_prefetchThreads[i].Join();
+        }
+    }
+
+    while (m_prefetchBatches.IsEmpty() == false)
+    {
+        PrefetchBatch* pBatch = m_prefetchBatches.Front();
+        m_prefetchBatches.Erase(pBatch->ListNode());
+        pBatch->Destroy(Allocator());
+    }
+
+    // Every batched store must reach the next layer before we go away, so let the flush thread drain the queue.
+    if (m_flushThread.IsCreated())
+    {
+        m_flushThreadEnd = true;
+        m_flushNotify.Post();
+        PAL_ASSERT(m_flushThread.IsNotCurrentThread());
+        m_flushThread.Join();
+    }
+
+    // If the thread was never started (or exited early), pass whatever is left on this thread.
+    FlushBatchedStores();
+
     while (m_recentEntryList.IsEmpty() == false)
     {
         Entry* pEntry = m_recentEntryList.Front();
@@ -63,6 +124,16 @@ MemoryCacheLayer::~MemoryCacheLayer()
         m_recentEntryList.Erase(pEntry->ListNode());
         pEntry->Destroy();
     }
+
+    while (m_protectedEntryList.IsEmpty() == false)
+    {
+        Entry* pEntry = m_protectedEntryList.Front();
+        m_entryLookup.Erase(*pEntry->HashId());
+        m_protectedEntryList.Erase(pEntry->ListNode());
+        pEntry->Destroy();
+    }
+
+    m_frequencySketch.Destroy(Allocator());
 }
 
 // =====================================================================================================================
@@ -76,9 +147,339 @@ Result MemoryCacheLayer::Init()
         result = m_entryLookup.Init();
     }
 
+    if (result == Result::Success)
+    {
+        result = m_flushNotify.Init(Semaphore::MaximumCountLimit, 0);
+    }
+
+    if (result == Result::Success)
+    {
+        result = m_prefetchNotify.Init(Semaphore::MaximumCountLimit, 0);
+    }
+
+    if ((result == Result::Success) && m_frequencyAdmission)
+    {
+        result = m_frequencySketch.Init(Allocator(), m_maxCount);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Callback for executing the flush thread.
+static void FlushThreadCallback(
+    void* pParameter)   // Opaque pointer to a MemoryCacheLayer
+{
+    static_cast<MemoryCacheLayer*>(pParameter)->RunFlushThread();
+}
+
+// =====================================================================================================================
+// Starts the flush thread. Must be called with m_batchLock held.
+Result MemoryCacheLayer::StartFlushThread()
+{
+    Result result = Result::Success;
+
+    if (m_flushThread.IsCreated() == false)
+    {
+        result = m_flushThread.Begin(&FlushThreadCallback, this);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Queue a copy of the data for the flush thread to pass to the next layer. Returns Unsupported if the data cannot be
+// queued, in which case the caller passes it to the next layer directly.
+Result MemoryCacheLayer::BatchData(
+    uint32               storePolicy,
+    ICacheLayer*         pNextLayer,
+    const Hash128*       pHashId,
+    const void*          pData,
+    size_t               dataSize,
+    const CacheEntryTag& tag)
+{
+    PAL_ASSERT(pNextLayer != nullptr);
+
+    Result result = Result::Unsupported;
+
+    BatchedStore* pStore = BatchedStore::Create(Allocator(), pNextLayer, pHashId, pData, dataSize, tag);
+
+    if (pStore != nullptr)
+    {
+        MutexAuto lock { &m_batchLock };
+
+        // Always accept a store when nothing is queued so that a single large store still goes to the thread. Past
+        // that, a full queue means the next layer has fallen behind and the caller should wait on it directly.
+        if ((m_batchedSize == 0) || ((m_batchedSize + dataSize) <= m_maxBatchedSize))
+        {
+            result = StartFlushThread();
+        }
+
+        if (result == Result::Success)
+        {
+            m_batchedStores.PushBack(pStore->ListNode());
+            m_batchedSize += dataSize;
+        }
+        else
+        {
+            result = Result::Unsupported;
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        m_flushNotify.Post();
+    }
+    else if (pStore != nullptr)
+    {
+        pStore->Destroy(Allocator());
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Passes every queued store to its next layer. Stores are taken from the queue in one batch so that the next layer
+// sees a run of back-to-back appends instead of stores interleaved with the client's work.
+void MemoryCacheLayer::FlushBatchedStores()
+{
+    BatchedStore::List batch;
+    {
+        MutexAuto lock { &m_batchLock };
+
+        while (m_batchedStores.IsEmpty() == false)
+        {
+            BatchedStore* pStore = m_batchedStores.Front();
+            m_batchedStores.Erase(pStore->ListNode());
+            batch.PushBack(pStore->ListNode());
+        }
+    }
+
+    while (batch.IsEmpty() == false)
+    {
+        BatchedStore* pStore = batch.Front();
+        batch.Erase(pStore->ListNode());
+
+        Result result = pStore->NextLayer()->StoreTagged(pStore->HashId(),
+                                                         pStore->Data(),
+                                                         pStore->DataSize(),
+                                                         pStore->Tag());
+        PAL_ALERT(IsErrorResult(result));
+
+        {
+            MutexAuto lock { &m_batchLock };
+            m_batchedSize -= pStore->DataSize();
+        }
+
+        pStore->Destroy(Allocator());
+    }
+}
+
+// =====================================================================================================================
+// Executes the background thread which passes batched stores to the next layer.
+void MemoryCacheLayer::RunFlushThread()
+{
+    while (true)
+    {
+        bool isEmpty = false;
+        {
+            MutexAuto lock { &m_batchLock };
+            isEmpty = m_batchedStores.IsEmpty();
+        }
+
+        if (isEmpty == false)
+        {
+            FlushBatchedStores();
+        }
+        else if (m_flushThreadEnd)
+        {
+            m_flushThread.End();
+        }
+        else
+        {
+            m_flushNotify.Wait(UINT32_MAX);
+        }
+    }
+
+    PAL_NEVER_CALLED(); // This area should be unreachable.
+}
+
+// =====================================================================================================================
+// Callback for executing a prefetch thread.
+static void PrefetchThreadCallback(
+    void* pParameter)   // Opaque pointer to a MemoryCacheLayer
+{
+    static_cast<MemoryCacheLayer*>(pParameter)->RunPrefetchThread();
+}
+
+// =====================================================================================================================
+// Starts any prefetch threads which are not running yet. Must be called with m_prefetchLock held.
+Result MemoryCacheLayer::StartPrefetchThreads()
+{
+    Result result = Result::Success;
+
+    for (uint32 i = 0; (i < PrefetchThreadCount) && (result == Result::Success); ++i)
+    {
+        if (m_prefetchThreads[i].IsCreated() == false)
+        {
+            result = m_prefetchThreads[i].Begin(&PrefetchThreadCallback, this);
+        }
+    }
+
+    // One running thread is enough to make progress.
+    if (m_prefetchThreads[0].IsCreated())
+    {
+        result = Result::Success;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Queue entries to be promoted from the next layer by the prefetch threads. Returns once the hashes are queued.
+Result MemoryCacheLayer::Prefetch(
+    const Hash128* pHashIds,
+    uint32         count)
+{
+    Result result = Result::Success;
+
+    if ((pHashIds == nullptr) && (count > 0))
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if ((GetNextLayer() == nullptr) ||
+             (TestAnyFlagSet(GetLoadPolicy(), LinkPolicy::PassData) == false))
+    {
+        // There is nowhere to promote entries from.
+        result = Result::Unsupported;
+    }
+
+    uint32 queuedBatches = 0;
+
+    for (uint32 first = 0; (first < count) && (result == Result::Success); first += PrefetchBatchSize)
+    {
+        const uint32   batchCount = Min(count - first, PrefetchBatchSize);
+        PrefetchBatch* pBatch     = PrefetchBatch::Create(Allocator(), pHashIds + first, batchCount);
+
+        if (pBatch == nullptr)
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+        else
+        {
+            MutexAuto lock { &m_prefetchLock };
+
+            result = StartPrefetchThreads();
+
+            if (result == Result::Success)
+            {
+                m_prefetchBatches.PushBack(pBatch->ListNode());
+                ++queuedBatches;
+            }
+            else
+            {
+                pBatch->Destroy(Allocator());
+            }
+        }
+    }
+
+    for (uint32 i = 0; i < queuedBatches; ++i)
+    {
+        m_prefetchNotify.Post();
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Compares queries by the layer that answered them, then by that layer's entry id. The archive layer numbers its
+// entries in file order, so this turns a batch of random lookups into one forward pass over the file.
+static int ComparePrefetchQueries(
+    const void* pLhs,
+    const void* pRhs)
+{
+    const QueryResult& lhs = *static_cast<const QueryResult*>(pLhs);
+    const QueryResult& rhs = *static_cast<const QueryResult*>(pRhs);
+
+    int result = 0;
+
+    if (lhs.pLayer != rhs.pLayer)
+    {
+        result = (reinterpret_cast<uintptr_t>(lhs.pLayer) < reinterpret_cast<uintptr_t>(rhs.pLayer)) ? -1 : 1;
+    }
+    else if (lhs.context.entryId != rhs.context.entryId)
+    {
+        result = (lhs.context.entryId < rhs.context.entryId) ? -1 : 1;
+    }
+
     return result;
 }
 
+// =====================================================================================================================
+// Promotes every entry of a batch which is not already in memory. All lookups are made before any data is read so the
+// reads can be issued in storage order.
+void MemoryCacheLayer::ProcessPrefetchBatch(
+    PrefetchBatch* pBatch)
+{
+    ICacheLayer*const pNextLayer = GetNextLayer();
+    QueryResult*const pQueries   = pBatch->Queries();
+    uint32            found      = 0;
+
+    for (uint32 i = 0; (i < pBatch->Count()) && (m_prefetchThreadEnd == false); ++i)
+    {
+        const Hash128& hashId  = pBatch->HashIds()[i];
+        bool           present = false;
+        {
+            TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
+            present = (m_entryLookup.FindKey(hashId) != nullptr);
+        }
+
+        if ((present == false) &&
+            (pNextLayer->Query(&hashId, 0, 0, &pQueries[found]) == Result::Success))
+        {
+            ++found;
+        }
+    }
+
+    qsort(pQueries, found, sizeof(QueryResult), &ComparePrefetchQueries);
+
+    for (uint32 i = 0; (i < found) && (m_prefetchThreadEnd == false); ++i)
+    {
+        // AlreadyExists means a client query promoted the entry first, which is as good as prefetching it.
+        const Result result = PromoteEntry(pNextLayer, &pQueries[i], true);
+        PAL_ALERT(IsErrorResult(result));
+    }
+}
+
+// =====================================================================================================================
+// Executes a background thread which promotes prefetched entries from the next layer.
+void MemoryCacheLayer::RunPrefetchThread()
+{
+    while (m_prefetchThreadEnd == false)
+    {
+        PrefetchBatch* pBatch = nullptr;
+        {
+            MutexAuto lock { &m_prefetchLock };
+
+            if (m_prefetchBatches.IsEmpty() == false)
+            {
+                pBatch = m_prefetchBatches.Front();
+                m_prefetchBatches.Erase(pBatch->ListNode());
+            }
+        }
+
+        if (pBatch != nullptr)
+        {
+            ProcessPrefetchBatch(pBatch);
+            pBatch->Destroy(Allocator());
+        }
+        else
+        {
+            m_prefetchNotify.Wait(UINT32_MAX);
+        }
+    }
+}
+
 // =====================================================================================================================
 // Check if a requested id is present
 Result MemoryCacheLayer::QueryInternal(
@@ -89,23 +490,27 @@ Result MemoryCacheLayer::QueryInternal(
 
     Entry** ppFound = nullptr;
 
-    RWLockAuto<RWLock::ReadWrite> lock { &m_lock };
+    TimedRWLockAuto<RWLock::ReadWrite> lock { &m_lock, Stats() };
 
     ppFound = m_entryLookup.FindKey(*pHashId);
 
+    if (m_frequencySketch.IsEnabled())
+    {
+        m_frequencySketch.Increment(*pHashId);
+    }
+
     if (ppFound == nullptr)
     {
         result = Result::NotFound;
     }
     else if (*ppFound != nullptr)
     {
-        Entry::Node* pNode = (*ppFound)->ListNode();
-        m_recentEntryList.Erase(pNode);
-        m_recentEntryList.PushBack(pNode);
+        TouchEntry(*ppFound);
 
         pQuery->hashId             = *pHashId;
         pQuery->pLayer             = this;
         pQuery->dataSize           = (*ppFound)->DataSize();
+        pQuery->tag                = (*ppFound)->Tag();
         pQuery->context.pEntryInfo = (*ppFound)->Data();
         if (pQuery->dataSize == 0)
         {
@@ -123,9 +528,10 @@ Result MemoryCacheLayer::QueryInternal(
 // =====================================================================================================================
 // Add data passed in to the cache
 Result MemoryCacheLayer::StoreInternal(
-    const Hash128*  pHashId,
-    const void*     pData,
-    size_t          dataSize)
+    const Hash128*       pHashId,
+    const void*          pData,
+    size_t               dataSize,
+    const CacheEntryTag& tag)
 {
     Result result = Result::Success;
 
@@ -145,7 +551,7 @@ Result MemoryCacheLayer::StoreInternal(
     {
         Entry** ppFound = nullptr;
 
-        RWLockAuto<RWLock::ReadWrite> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadWrite> lock { &m_lock, Stats() };
 
         ppFound = m_entryLookup.FindKey(*pHashId);
 
@@ -155,7 +561,7 @@ Result MemoryCacheLayer::StoreInternal(
             {
                 if ((*ppFound)->Data() == nullptr)
                 {
-                    result = SetDataToEntry(*ppFound, pData, dataSize);
+                    result = SetDataToEntry(*ppFound, pData, dataSize, tag);
                     if (result == Result::Success)
                     {
                         setData = true;
@@ -178,20 +584,29 @@ Result MemoryCacheLayer::StoreInternal(
         }
     }
 
+    bool admitted = true;
     if ((result == Result::Success) && (setData == false))
     {
-        RWLockAuto<RWLock::ReadWrite> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadWrite> lock { &m_lock, Stats() };
+
+        // A rejected entry is not an error, the data is still passed to the next layer.
+        admitted = AdmitEntry(pHashId, dataSize);
 
-        result = EnsureAvailableSpace(dataSize, 1);
+        if (admitted)
+        {
+            result = EnsureAvailableSpace(dataSize, 1);
+        }
     }
 
-    if ((result == Result::Success) && (setData == false))
+    if ((result == Result::Success) && (setData == false) && admitted)
     {
         Entry* pEntry = Entry::Create(Allocator(), pHashId, pData, dataSize);
 
         if (pEntry != nullptr)
         {
-            RWLockAuto<RWLock::ReadWrite> lock { &m_lock };
+            pEntry->SetTag(tag);
+
+            TimedRWLockAuto<RWLock::ReadWrite> lock { &m_lock, Stats() };
 
             result = AddEntryToCache(pEntry);
 
@@ -227,7 +642,7 @@ Result MemoryCacheLayer::LoadInternal(
     {
         Entry** ppFound = nullptr;
 
-        RWLockAuto<RWLock::ReadOnly> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
 
         ppFound = m_entryLookup.FindKey(pQuery->hashId);
         if (ppFound != nullptr)
@@ -265,7 +680,7 @@ Result MemoryCacheLayer::AcquireCacheRef(
     {
         Entry** ppFound = nullptr;
 
-        RWLockAuto<RWLock::ReadOnly> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
 
         ppFound = m_entryLookup.FindKey(pQuery->hashId);
         if (ppFound != nullptr)
@@ -295,7 +710,7 @@ Result MemoryCacheLayer::ReleaseCacheRef(
     {
         Entry** ppFound = nullptr;
 
-        RWLockAuto<RWLock::ReadOnly> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
 
         ppFound = m_entryLookup.FindKey(pQuery->hashId);
         if (ppFound != nullptr)
@@ -332,7 +747,7 @@ Result MemoryCacheLayer::GetCacheData(
     {
         Entry** ppFound = nullptr;
 
-        RWLockAuto<RWLock::ReadOnly> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
 
         ppFound = m_entryLookup.FindKey(pQuery->hashId);
         if (ppFound != nullptr)
@@ -376,7 +791,7 @@ Result MemoryCacheLayer::WaitForEntry(
         for (;;)
         {
             {
-                RWLockAuto<RWLock::ReadOnly> lock{ &m_lock };
+                TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
                 ppFound = m_entryLookup.FindKey(*pHashId);
                 if (ppFound == nullptr)
                 {
@@ -417,7 +832,7 @@ Result MemoryCacheLayer::Evict(
     {
         Entry** ppFound = nullptr;
 
-        RWLockAuto<RWLock::ReadOnly> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
         ppFound = m_entryLookup.FindKey(*pHashId);
         if (ppFound != nullptr)
         {
@@ -447,7 +862,7 @@ Result MemoryCacheLayer::MarkEntryBad(
     {
         Entry** ppFound = nullptr;
 
-        RWLockAuto<RWLock::ReadOnly> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
         ppFound = m_entryLookup.FindKey(*pHashId);
         if (ppFound != nullptr)
         {
@@ -476,7 +891,7 @@ Result MemoryCacheLayer::EvictEntryByCount(
     while ((result == Result::Success) &&
            (numEvicted < numToEvict))
     {
-        Entry* const pEntry = m_recentEntryList.Front();
+        Entry* const pEntry = NextVictim();
 
         if (pEntry != nullptr)
         {
@@ -485,6 +900,7 @@ Result MemoryCacheLayer::EvictEntryByCount(
             if (result == Result::Success)
             {
                 ++numEvicted;
+                Stats()->Increment(CacheLayerStatsTracker::EvictCount);
             }
         }
         else
@@ -508,7 +924,7 @@ Result MemoryCacheLayer::EvictEntryBySize(
     while ((result == Result::Success) &&
            (evictedSize < minSizeToEvict))
     {
-        Entry* const pEntry = m_recentEntryList.Front();
+        Entry* const pEntry = NextVictim();
 
         if (pEntry != nullptr)
         {
@@ -519,6 +935,7 @@ Result MemoryCacheLayer::EvictEntryBySize(
             if (result == Result::Success)
             {
                 evictedSize += dataSize;
+                Stats()->Increment(CacheLayerStatsTracker::EvictCount);
             }
         }
         else
@@ -545,7 +962,15 @@ Result MemoryCacheLayer::EvictEntryFromCache(
         {
             result = Result::Success;
 
-            m_recentEntryList.Erase(pEntry->ListNode());
+            if (pEntry->IsProtected())
+            {
+                m_protectedEntryList.Erase(pEntry->ListNode());
+                m_protectedSize -= pEntry->DataSize();
+            }
+            else
+            {
+                m_recentEntryList.Erase(pEntry->ListNode());
+            }
             m_curSize -= pEntry->DataSize();
             m_curCount -= 1;
             pEntry->Destroy();
@@ -569,17 +994,93 @@ Result MemoryCacheLayer::AddEntryToCache(
         m_recentEntryList.PushBack(pEntry->ListNode());
         m_curSize += pEntry->DataSize();
         m_curCount++;
+        Stats()->Increment(CacheLayerStatsTracker::InsertCount);
     }
 
     return result;
 }
 
+// =====================================================================================================================
+// Move an entry which was just hit to the most recently used end of its list. With frequency admission enabled, a hit
+// on a probation entry promotes it to the protected segment, which pushes the least recently used protected entries
+// back to probation once the segment is over budget.
+void MemoryCacheLayer::TouchEntry(
+    Entry* pEntry)
+{
+    Entry::Node* pNode = pEntry->ListNode();
+
+    if (pEntry->IsProtected())
+    {
+        m_protectedEntryList.Erase(pNode);
+        m_protectedEntryList.PushBack(pNode);
+    }
+    else if (m_frequencyAdmission && (pEntry->DataSize() > 0))
+    {
+        m_recentEntryList.Erase(pNode);
+        m_protectedEntryList.PushBack(pNode);
+        m_protectedSize += pEntry->DataSize();
+        pEntry->SetIsProtected(true);
+
+        while (m_protectedSize > m_maxProtectedSize)
+        {
+            Entry* const pDemoted = m_protectedEntryList.Front();
+
+            m_protectedEntryList.Erase(pDemoted->ListNode());
+            m_protectedSize -= pDemoted->DataSize();
+            pDemoted->SetIsProtected(false);
+            m_recentEntryList.PushBack(pDemoted->ListNode());
+        }
+    }
+    else
+    {
+        m_recentEntryList.Erase(pNode);
+        m_recentEntryList.PushBack(pNode);
+    }
+}
+
+// =====================================================================================================================
+// Returns the entry which should be evicted next: the least recently used probation entry, falling back to the least
+// recently used protected entry.
+MemoryCacheLayer::Entry* MemoryCacheLayer::NextVictim() const
+{
+    return m_recentEntryList.IsEmpty() ? m_protectedEntryList.Front() : m_recentEntryList.Front();
+}
+
+// =====================================================================================================================
+// Decide whether a new entry may be added when frequency admission is enabled. Adding it is only worth evicting an
+// existing entry if the new one has been requested more often than the entry it would replace.
+bool MemoryCacheLayer::AdmitEntry(
+    const Hash128* pHashId,
+    size_t         entrySize)
+{
+    bool admit = true;
+
+    if (m_frequencySketch.IsEnabled())
+    {
+        const bool   needsSpace = ((m_curCount + 1) > m_maxCount) || ((m_curSize + entrySize) > m_maxSize);
+        const Entry* pVictim    = NextVictim();
+
+        if (needsSpace && (pVictim != nullptr))
+        {
+            admit = (m_frequencySketch.Estimate(*pHashId) > m_frequencySketch.Estimate(*pVictim->HashId()));
+        }
+
+        if (admit == false)
+        {
+            Stats()->Increment(CacheLayerStatsTracker::RejectCount);
+        }
+    }
+
+    return admit;
+}
+
 // =====================================================================================================================
 // Set data to Entry
 Result MemoryCacheLayer::SetDataToEntry(
-    Entry*      pEntry,
-    const void* pData,
-    size_t      dataSize)
+    Entry*               pEntry,
+    const void*          pData,
+    size_t               dataSize,
+    const CacheEntryTag& tag)
 {
     PAL_ASSERT(pEntry != nullptr);
     Result result = Result::Success;
@@ -590,6 +1091,7 @@ Result MemoryCacheLayer::SetDataToEntry(
 
         if (result == Result::Success)
         {
+            pEntry->SetTag(tag);
             m_curSize += pEntry->DataSize();
         }
     }
@@ -641,6 +1143,17 @@ Result MemoryCacheLayer::EnsureAvailableSpace(
 Result MemoryCacheLayer::PromoteData(
     ICacheLayer* pNextLayer,
     QueryResult* pQuery)
+{
+    return PromoteEntry(pNextLayer, pQuery, false);
+}
+
+// =====================================================================================================================
+// Copies an entry from the next layer into this one. Prefetched entries skip frequency admission: the client asked for
+// them explicitly and they have never been queried, so the sketch would reject them whenever the cache is full.
+Result MemoryCacheLayer::PromoteEntry(
+    ICacheLayer* pNextLayer,
+    QueryResult* pQuery,
+    bool         isPrefetch)
 {
     PAL_ASSERT(pNextLayer != nullptr);
     PAL_ASSERT(pQuery != nullptr);
@@ -661,7 +1174,7 @@ Result MemoryCacheLayer::PromoteData(
     Entry** ppFound = nullptr;
 
     {
-        RWLockAuto<RWLock::ReadOnly> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
 
         ppFound = m_entryLookup.FindKey(pQuery->hashId);
     }
@@ -673,9 +1186,17 @@ Result MemoryCacheLayer::PromoteData(
 
     if (result == Result::Success)
     {
-        RWLockAuto<RWLock::ReadWrite> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadWrite> lock { &m_lock, Stats() };
 
-        result = EnsureAvailableSpace(pQuery->dataSize, 1);
+        if (isPrefetch || AdmitEntry(&pQuery->hashId, pQuery->dataSize))
+        {
+            result = EnsureAvailableSpace(pQuery->dataSize, 1);
+        }
+        else
+        {
+            // Leave the query pointing at the next layer.
+            result = Result::Unsupported;
+        }
     }
 
     if (result == Result::Success)
@@ -684,11 +1205,13 @@ Result MemoryCacheLayer::PromoteData(
 
         if (pEntry != nullptr)
         {
+            pEntry->SetTag(pQuery->tag);
+
             result = pNextLayer->Load(pQuery, pEntry->Data());
 
             if (result == Result::Success)
             {
-                RWLockAuto<RWLock::ReadWrite> lock { &m_lock };
+                TimedRWLockAuto<RWLock::ReadWrite> lock { &m_lock, Stats() };
 
                 result = AddEntryToCache(pEntry);
                 m_entryLookup.Insert(pQuery->hashId, pEntry);
@@ -732,7 +1255,7 @@ Result MemoryCacheLayer::Reserve(
     {
         Entry** ppFound = nullptr;
 
-        RWLockAuto<RWLock::ReadWrite> lock { &m_lock };
+        TimedRWLockAuto<RWLock::ReadWrite> lock { &m_lock, Stats() };
 
         ppFound = m_entryLookup.FindKey(*pHashId);
         if (ppFound != nullptr)
@@ -753,7 +1276,7 @@ Result MemoryCacheLayer::Reserve(
         Entry* pEntry = Entry::Create(Allocator(), pHashId, nullptr, 0);
         if (pEntry != nullptr)
         {
-            RWLockAuto<RWLock::ReadWrite> lock { &m_lock };
+            TimedRWLockAuto<RWLock::ReadWrite> lock { &m_lock, Stats() };
             result = AddEntryToCache(pEntry);
             if (result != Result::Success)
             {
@@ -812,7 +1335,9 @@ Result CreateMemoryCacheLayer(
             pCreateInfo->maxMemorySize,
             pCreateInfo->maxObjectCount,
             pCreateInfo->evictOnFull,
-            pCreateInfo->evictDuplicates);
+            pCreateInfo->evictDuplicates,
+            pCreateInfo->maxBatchedSize,
+            pCreateInfo->frequencyAdmission);
 
         result = pLayer->Init();
 
@@ -847,7 +1372,7 @@ Result MemoryCacheLayer::GetMemoryCacheHashIds(
 {
     Result result = Result::Success;
 
-    RWLockAuto<RWLock::ReadOnly> lock { &m_lock };
+    TimedRWLockAuto<RWLock::ReadOnly> lock { &m_lock, Stats() };
     // Iterate through all Entries and copy their hash ID to pHashIds array.
     if (curCount == m_curCount)
     {
@@ -859,6 +1384,13 @@ Result MemoryCacheLayer::GetMemoryCacheHashIds(
 
             pHashIds[i++] = *pEntry->HashId();
         }
+
+        for (auto iter = m_protectedEntryList.Begin(); iter.IsValid(); iter.Next())
+        {
+            Entry* pEntry = iter.Get();
+
+            pHashIds[i++] = *pEntry->HashId();
+        }
     }
     else
     {
@@ -962,4 +1494,134 @@ void MemoryCacheLayer::Entry::Destroy()
     PAL_FREE(this, pAllocator);
 }
 
+// =====================================================================================================================
+Result MemoryCacheLayer::FrequencySketch::Init(
+    ForwardAllocator* pAllocator,
+    size_t            maxEntryCount)
+{
+    Result result = Result::ErrorOutOfMemory;
+
+    m_width     = Pow2Pad(Clamp(maxEntryCount, MinWidth, MaxWidth));
+    m_pCounters = static_cast<uint8*>(PAL_CALLOC(Depth * m_width, pAllocator, AllocInternal));
+
+    if (m_pCounters != nullptr)
+    {
+        result = Result::Success;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+void MemoryCacheLayer::FrequencySketch::Destroy(
+    ForwardAllocator* pAllocator)
+{
+    PAL_SAFE_FREE(m_pCounters, pAllocator);
+}
+
+// =====================================================================================================================
+void MemoryCacheLayer::FrequencySketch::Increment(
+    const Hash128& hashId)
+{
+    for (uint32 row = 0; row < Depth; ++row)
+    {
+        uint8* pCounter = Counter(hashId, row);
+
+        if (*pCounter < MaxCount)
+        {
+            (*pCounter)++;
+        }
+    }
+
+    m_additions++;
+
+    if (m_additions >= (SampleSizeScale * m_width))
+    {
+        for (size_t i = 0; i < (Depth * m_width); ++i)
+        {
+            m_pCounters[i] >>= 1;
+        }
+
+        m_additions = 0;
+    }
+}
+
+// =====================================================================================================================
+uint32 MemoryCacheLayer::FrequencySketch::Estimate(
+    const Hash128& hashId
+    ) const
+{
+    uint32 estimate = MaxCount;
+
+    for (uint32 row = 0; row < Depth; ++row)
+    {
+        estimate = Min<uint32>(estimate, *Counter(hashId, row));
+    }
+
+    return estimate;
+}
+
+// =====================================================================================================================
+MemoryCacheLayer::BatchedStore* MemoryCacheLayer::BatchedStore::Create(
+    ForwardAllocator*    pAllocator,
+    ICacheLayer*         pNextLayer,
+    const Hash128*       pHashId,
+    const void*          pData,
+    size_t               dataSize,
+    const CacheEntryTag& tag)
+{
+    PAL_ASSERT(pAllocator != nullptr);
+    PAL_ASSERT(pHashId != nullptr);
+
+    BatchedStore* pStore = nullptr;
+    void*         pMem   = PAL_MALLOC(sizeof(BatchedStore) + dataSize, pAllocator, AllocInternal);
+
+    if (pMem != nullptr)
+    {
+        pStore = PAL_PLACEMENT_NEW(pMem) BatchedStore(pNextLayer, pHashId, dataSize, tag);
+        memcpy(VoidPtrInc(pStore, sizeof(BatchedStore)), pData, dataSize);
+    }
+
+    return pStore;
+}
+
+// =====================================================================================================================
+void MemoryCacheLayer::BatchedStore::Destroy(
+    ForwardAllocator* pAllocator)
+{
+    this->~BatchedStore();
+    PAL_FREE(this, pAllocator);
+}
+
+// =====================================================================================================================
+MemoryCacheLayer::PrefetchBatch* MemoryCacheLayer::PrefetchBatch::Create(
+    ForwardAllocator* pAllocator,
+    const Hash128*    pHashIds,
+    uint32            count)
+{
+    PAL_ASSERT(pAllocator != nullptr);
+    PAL_ASSERT(pHashIds != nullptr);
+
+    PrefetchBatch* pBatch = nullptr;
+    void*          pMem   = PAL_MALLOC(sizeof(PrefetchBatch) + (count * (sizeof(Hash128) + sizeof(QueryResult))),
+                                       pAllocator,
+                                       AllocInternal);
+
+    if (pMem != nullptr)
+    {
+        pBatch = PAL_PLACEMENT_NEW(pMem) PrefetchBatch(count);
+        memcpy(VoidPtrInc(pBatch, sizeof(PrefetchBatch)), pHashIds, count * sizeof(Hash128));
+    }
+
+    return pBatch;
+}
+
+// =====================================================================================================================
+void MemoryCacheLayer::PrefetchBatch::Destroy(
+    ForwardAllocator* pAllocator)
+{
+    this->~PrefetchBatch();
+    PAL_FREE(this, pAllocator);
+}
+
 } //namespace Util
@@ -28,6 +28,8 @@
 #include "palConditionVariable.h"
 #include "palHashMap.h"
 #include "palIntrusiveList.h"
+#include "palSemaphore.h"
+#include "palThread.h"
 #include "palVector.h"
 
 namespace Util
@@ -43,7 +45,9 @@ public:
         size_t                maxMemorySize,
         size_t                maxObjectCount,
         bool                  evictOnFull,
-        bool                  evictDuplicates);
+        bool                  evictDuplicates,
+        size_t                maxBatchedSize,
+        bool                  frequencyAdmission);
     virtual ~MemoryCacheLayer();
 
     virtual Result Init() override;
@@ -64,6 +68,11 @@ public:
     virtual Result WaitForEntry(const Hash128* pHashId) override;
     virtual Result Evict(const Hash128* pHashId) override;
     virtual Result MarkEntryBad(const Hash128* pHashId) override;
+    virtual Result Prefetch(const Hash128* pHashIds, uint32 count) override;
+
+    // Must be declared public but meant for internal use only.
+    void RunFlushThread();
+    void RunPrefetchThread();
 
 protected:
     virtual Result QueryInternal(
@@ -71,9 +80,10 @@ protected:
         QueryResult*    pQuery) override;
 
     virtual Result StoreInternal(
-        const Hash128*  pHashId,
-        const void*     pData,
-        size_t          dataSize) override;
+        const Hash128*       pHashId,
+        const void*          pData,
+        size_t               dataSize,
+        const CacheEntryTag& tag) override;
 
     virtual Result LoadInternal(
         const QueryResult* pQuery,
@@ -85,12 +95,22 @@ protected:
 
     virtual Result Reserve(
         const Hash128* pHashId) override;
+
+    virtual Result BatchData(
+        uint32               storePolicy,
+        ICacheLayer*         pNextLayer,
+        const Hash128*       pHashId,
+        const void*          pData,
+        size_t               dataSize,
+        const CacheEntryTag& tag) override;
+
 private:
     PAL_DISALLOW_COPY_AND_ASSIGN(MemoryCacheLayer);
     PAL_DISALLOW_DEFAULT_CTOR(MemoryCacheLayer);
     class Entry;
+    class PrefetchBatch;
 
-    Result SetDataToEntry(Entry* pEntry, const void* pData, size_t dataSize);
+    Result SetDataToEntry(Entry* pEntry, const void* pData, size_t dataSize, const CacheEntryTag& tag);
     Result AddEntryToCache(Entry* pEntry);
     Result EvictEntryFromCache(Entry* pEntry);
 
@@ -98,6 +118,129 @@ private:
     Result EvictEntryByCount(size_t numToEvict = 1);
     Result EvictEntryBySize(size_t minSizeToEvict);
 
+    void TouchEntry(Entry* pEntry);
+    Entry* NextVictim() const;
+    bool AdmitEntry(const Hash128* pHashId, size_t entrySize);
+
+    Result StartFlushThread();
+    void FlushBatchedStores();
+
+    Result StartPrefetchThreads();
+    void ProcessPrefetchBatch(PrefetchBatch* pBatch);
+    Result PromoteEntry(ICacheLayer* pNextLayer, QueryResult* pQuery, bool isPrefetch);
+
+    // A copy of stored data which is waiting to be passed to the next layer by the flush thread.
+    class BatchedStore
+    {
+    public:
+        using List = IntrusiveList<BatchedStore>;
+        using Node = IntrusiveListNode<BatchedStore>;
+
+        static BatchedStore* Create(
+            ForwardAllocator*    pAllocator,
+            ICacheLayer*         pNextLayer,
+            const Hash128*       pHashId,
+            const void*          pData,
+            size_t               dataSize,
+            const CacheEntryTag& tag);
+
+        ICacheLayer* NextLayer() const { return m_pNextLayer; }
+        const Hash128* HashId() const { return &m_hashId; }
+        const void* Data() const { return (this + 1); }
+        size_t DataSize() const { return m_dataSize; }
+        const CacheEntryTag& Tag() const { return m_tag; }
+
+        Node* ListNode() { return &m_node; }
+
+        void Destroy(ForwardAllocator* pAllocator);
+
+    private:
+        PAL_DISALLOW_COPY_AND_ASSIGN(BatchedStore);
+        PAL_DISALLOW_DEFAULT_CTOR(BatchedStore);
+
+        BatchedStore(ICacheLayer* pNextLayer, const Hash128* pHashId, size_t dataSize, const CacheEntryTag& tag)
+            :
+            m_node       { this },
+            m_pNextLayer { pNextLayer },
+            m_hashId     { *pHashId },
+            m_dataSize   { dataSize },
+            m_tag        (tag)
+        {
+        }
+
+        ~BatchedStore() { PAL_ASSERT(m_node.InList() == false); }
+
+        Node           m_node;
+        ICacheLayer*   m_pNextLayer;
+        Hash128        m_hashId;
+        size_t         m_dataSize;
+        CacheEntryTag  m_tag;
+    };
+
+    // A group of hashes queued by Prefetch(). The hashes and a query result slot for each follow the object in memory.
+    class PrefetchBatch
+    {
+    public:
+        using List = IntrusiveList<PrefetchBatch>;
+        using Node = IntrusiveListNode<PrefetchBatch>;
+
+        static PrefetchBatch* Create(
+            ForwardAllocator* pAllocator,
+            const Hash128*    pHashIds,
+            uint32            count);
+
+        const Hash128* HashIds() const { return reinterpret_cast<const Hash128*>(this + 1); }
+        QueryResult* Queries() { return reinterpret_cast<QueryResult*>(const_cast<Hash128*>(HashIds()) + m_count); }
+        uint32 Count() const { return m_count; }
+
+        Node* ListNode() { return &m_node; }
+
+        void Destroy(ForwardAllocator* pAllocator);
+
+    private:
+        PAL_DISALLOW_COPY_AND_ASSIGN(PrefetchBatch);
+        PAL_DISALLOW_DEFAULT_CTOR(PrefetchBatch);
+
+        PrefetchBatch(uint32 count) : m_node { this }, m_count { count } { }
+
+        ~PrefetchBatch() { PAL_ASSERT(m_node.InList() == false); }
+
+        Node   m_node;
+        uint32 m_count;
+    };
+
+    // Count-min sketch which estimates how often each hash has been requested recently. Counters saturate at 15 and
+    // are all halved after every SampleSizeScale * width increments so that old popularity fades.
+    class FrequencySketch
+    {
+    public:
+        FrequencySketch() : m_pCounters { nullptr }, m_width { 0 }, m_additions { 0 } {}
+
+        Result Init(ForwardAllocator* pAllocator, size_t maxEntryCount);
+        void Destroy(ForwardAllocator* pAllocator);
+
+        bool IsEnabled() const { return (m_pCounters != nullptr); }
+
+        void Increment(const Hash128& hashId);
+        uint32 Estimate(const Hash128& hashId) const;
+
+    private:
+        PAL_DISALLOW_COPY_AND_ASSIGN(FrequencySketch);
+
+        static constexpr uint32 Depth           = 4;  // One row per dword of the hash
+        static constexpr uint8  MaxCount        = 15;
+        static constexpr size_t SampleSizeScale = 10;
+        static constexpr size_t MinWidth        = 1024;
+        static constexpr size_t MaxWidth        = 1024 * 1024;
+
+        uint8* Counter(const Hash128& hashId, uint32 row) const
+            { return &m_pCounters[(row * m_width) + (hashId.dwords[row] & (m_width - 1))]; }
+
+        uint8* m_pCounters;
+        size_t m_width;
+        size_t m_additions;
+    };
+
     // IntrusiveList capable cache entry data structure
     class Entry
     {
@@ -117,6 +260,8 @@ private:
         const Hash128* HashId() const { return &m_hashId; }
         void* Data() const { return m_pData; }
         size_t DataSize() const { return m_dataSize; }
+        const CacheEntryTag& Tag() const { return m_tag; }
+        void SetTag(const CacheEntryTag& tag) { m_tag = tag; }
         void IncreaseRef() { AtomicIncrement(&m_zeroCopyCount); }
         void DecreaseRef()
         {
@@ -126,6 +271,8 @@ private:
         bool CanEvict() { return m_zeroCopyCount == 0; }
         void SetIsBad(bool isBad) { m_isBad = isBad; }
         bool IsBad() { return m_isBad; }
+        void SetIsProtected(bool isProtected) { m_isProtected = isProtected; }
+        bool IsProtected() const { return m_isProtected; }
 
         Node* ListNode() { return &m_node; }
 
@@ -142,7 +289,9 @@ private:
             m_hashId     {},
             m_pData      { nullptr },
             m_dataSize   { 0 },
-            m_isBad      { false }
+            m_tag        {},
+            m_isBad      { false },
+            m_isProtected { false }
         {
             PAL_ASSERT(m_pAllocator != nullptr);
         }
@@ -154,8 +303,10 @@ private:
         Hash128                 m_hashId;
         void*                   m_pData;
         size_t                  m_dataSize;
+        CacheEntryTag           m_tag;          // Opaque to this layer, returned from Query
         volatile uint32         m_zeroCopyCount;
         bool                    m_isBad;
+        bool                    m_isProtected;  // Entry is in the protected segment rather than the probation one
     };
 
     const size_t m_maxSize;
@@ -168,11 +319,37 @@ private:
     size_t       m_curSize;
     size_t       m_curCount;
 
-    Entry::List  m_recentEntryList;
+    Entry::List  m_recentEntryList;      // LRU order; the probation segment when frequency admission is enabled
+    Entry::List  m_protectedEntryList;   // LRU order of entries hit since entering the probation segment
     Entry::Map   m_entryLookup;
 
+    const bool       m_frequencyAdmission;
+    const size_t     m_maxProtectedSize;
+    size_t           m_protectedSize;
+    FrequencySketch  m_frequencySketch;
+
     Mutex              m_conditionMutex;      // Mutex that will be used with the condition variable
     ConditionVariable  m_conditionVariable;   // used for waiting on Entry::ready
+
+    // Write-behind state for the BatchStore link policy. Stores are queued here and passed to the next layer by a
+    // background thread, so the storing thread never waits on the next layer (e.g. an archive file on disk).
+    const size_t        m_maxBatchedSize;     // Limit on the data which may be queued for the flush thread
+    size_t              m_batchedSize;        // Data currently queued for the flush thread
+    BatchedStore::List  m_batchedStores;
+    Mutex               m_batchLock;          // Protects m_batchedStores and m_batchedSize
+    Semaphore           m_flushNotify;        // Wakes the flush thread when stores are queued
+    Thread              m_flushThread;
+    volatile bool       m_flushThreadEnd;     // Tells the flush thread to exit once the queue is empty
+
+    // Read-ahead state for Prefetch(). Batches of hashes are queued here and promoted from the next layer by a small
+    // pool of worker threads, so the threads which later query the entries find them already in memory.
+    static constexpr uint32 PrefetchThreadCount = 2;
+
+    PrefetchBatch::List m_prefetchBatches;
+    Mutex               m_prefetchLock;       // Protects m_prefetchBatches
+    Semaphore           m_prefetchNotify;     // Wakes a prefetch thread for each queued batch
+    Thread              m_prefetchThreads[PrefetchThreadCount];
+    volatile bool       m_prefetchThreadEnd;  // Tells the prefetch threads to exit, abandoning queued batches
 };
 
 } //namespace Util
@@ -28,11 +28,11 @@
 #include "palMsgPackImpl.h"
 #include "palPipelineAbiReader.h"
 #include "palPipelineAbiUtils.h"
-#include "palHashMapImpl.h"
 
 #include <climits>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 namespace Util
@@ -40,6 +40,34 @@ namespace Util
 namespace Abi
 {
 
+// =====================================================================================================================
+// qsort comparator which orders generic symbols by name hash. Ties are broken by their position in the ELF, so that a
+// lookup returns the first definition of a duplicated name.
+int PipelineAbiReader::CompareGenericSymbols(
+    const void* pLhs,
+    const void* pRhs)
+{
+    const GenericSymbol& lhs = *static_cast<const GenericSymbol*>(pLhs);
+    const GenericSymbol& rhs = *static_cast<const GenericSymbol*>(pRhs);
+
+    int order = 0;
+
+    if (lhs.hash != rhs.hash)
+    {
+        order = (lhs.hash < rhs.hash) ? -1 : 1;
+    }
+    else if (lhs.entry.m_section != rhs.entry.m_section)
+    {
+        order = (lhs.entry.m_section < rhs.entry.m_section) ? -1 : 1;
+    }
+    else if (lhs.entry.m_index != rhs.entry.m_index)
+    {
+        order = (lhs.entry.m_index < rhs.entry.m_index) ? -1 : 1;
+    }
+
+    return order;
+}
+
 // =====================================================================================================================
 Result PipelineAbiReader::Init()
 {
@@ -55,7 +83,30 @@ Result PipelineAbiReader::Init()
     if (result == Result::Success)
     {
         memset(&m_pipelineSymbols, 0, sizeof(m_pipelineSymbols));
-        result = m_genericSymbolsMap.Init();
+
+        PAL_SAFE_FREE(m_pGenericSymbols, &m_allocator);
+        m_numGenericSymbols = 0;
+
+        // Size the generic symbol table for the worst case, where every symbol is generic.
+        uint32 maxGenericSymbols = 0;
+        for (ElfReader::SectionId sectionIndex = 0; sectionIndex < m_elfReader.GetNumSections(); sectionIndex++)
+        {
+            if (m_elfReader.GetSectionType(sectionIndex) == ElfReader::SectionHeaderType::SymTab)
+            {
+                maxGenericSymbols += ElfReader::Symbols(m_elfReader, sectionIndex).GetNumSymbols();
+            }
+        }
+
+        if (maxGenericSymbols > 0)
+        {
+            m_pGenericSymbols = static_cast<GenericSymbol*>(PAL_MALLOC(sizeof(GenericSymbol) * maxGenericSymbols,
+                                                                      &m_allocator,
+                                                                      AllocInternal));
+            if (m_pGenericSymbols == nullptr)
+            {
+                result = Result::ErrorOutOfMemory;
+            }
+        }
     }
 
     if (result == Result::Success)
@@ -85,17 +136,19 @@ Result PipelineAbiReader::Init()
                 }
                 else
                 {
-                    result = m_genericSymbolsMap.Insert(pName, {sectionIndex, symbolIndex});
-                    if (result != Result::Success)
-                    {
-                        break;
-                    }
+                    const size_t nameLength = strlen(pName);
+
+                    GenericSymbol*const pSymbol = &m_pGenericSymbols[m_numGenericSymbols++];
+                    pSymbol->hash  = (nameLength > 0) ? HashString(pName, nameLength) : 0;
+                    pSymbol->entry = {sectionIndex, symbolIndex};
+                    pSymbol->pName = pName;
                 }
             }
-            if (result != Result::Success)
-            {
-                break;
-            }
+        }
+
+        if (m_numGenericSymbols > 1)
+        {
+            qsort(m_pGenericSymbols, m_numGenericSymbols, sizeof(GenericSymbol), &CompareGenericSymbols);
         }
     }
 
@@ -208,7 +261,34 @@ const Elf::SymbolTableEntry* PipelineAbiReader::GetGenericSymbol(
 {
     PAL_ASSERT(pName != nullptr);
 
-    const SymbolEntry*const pSymbolEntry = m_genericSymbolsMap.FindKey(pName);
+    const size_t nameLength = strlen(pName);
+    const uint32 hash       = (nameLength > 0) ? HashString(pName, nameLength) : 0;
+
+    // Binary search for the first symbol with a matching hash, then check each of the (usually one) candidates.
+    uint32 low  = 0;
+    uint32 high = m_numGenericSymbols;
+    while (low < high)
+    {
+        const uint32 mid = low + ((high - low) / 2);
+        if (m_pGenericSymbols[mid].hash < hash)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    const SymbolEntry* pSymbolEntry = nullptr;
+    for (uint32 idx = low; (idx < m_numGenericSymbols) && (m_pGenericSymbols[idx].hash == hash); idx++)
+    {
+        if (strcmp(m_pGenericSymbols[idx].pName, pName) == 0)
+        {
+            pSymbolEntry = &m_pGenericSymbols[idx].entry;
+            break;
+        }
+    }
 
     const Elf::SymbolTableEntry* pSymbol = nullptr;
     if (pSymbolEntry != nullptr)
@@ -0,0 +1,495 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "traceCacheLayer.h"
+
+#include "palHashMapImpl.h"
+#include "palAssert.h"
+#include "palSysUtil.h"
+
+#include "core/platform.h"
+
+namespace Util
+{
+
+// =====================================================================================================================
+TraceCacheLayer::TraceCacheLayer()
+    :
+    m_pNextLayer  { nullptr },
+    m_loadPolicy  { LinkPolicy::PassData | LinkPolicy::PassCalls },
+    m_storePolicy { LinkPolicy::PassData },
+    m_startTime   { 0 }
+{
+}
+
+// =====================================================================================================================
+TraceCacheLayer::~TraceCacheLayer()
+{
+    if (m_file.IsOpen())
+    {
+        m_file.Flush();
+        m_file.Close();
+    }
+}
+
+// =====================================================================================================================
+// Creates the trace file and writes its header
+Result TraceCacheLayer::Init(
+    const char* pFilePath)
+{
+    Result result = m_file.Open(pFilePath, FileAccessWrite | FileAccessBinary);
+
+    if (result == Result::Success)
+    {
+        CacheTraceFileHeader header = {};
+        header.magic          = CacheTraceFileMagic;
+        header.version        = CacheTraceFileVersion;
+        header.ticksPerSecond = static_cast<uint64>(GetPerfFrequency());
+
+        result = m_file.Write(&header, sizeof(header));
+    }
+
+    m_startTime = GetPerfCpuTime();
+
+    return result;
+}
+
+// =====================================================================================================================
+// Appends one record to the trace. Records are written in the order the calls complete.
+void TraceCacheLayer::Record(
+    CacheTraceOp   op,
+    int64          start,
+    const Hash128& hashId,
+    uint64         dataSize,
+    uint32         flags,
+    Result         result)
+{
+    CacheTraceRecord record = {};
+    record.timestamp = static_cast<uint64>(start - m_startTime);
+    record.hashId    = hashId;
+    record.dataSize  = dataSize;
+    record.op        = static_cast<uint32>(op);
+    record.flags     = flags;
+    record.result    = static_cast<int32>(result);
+
+    TimedMutexAuto lock { &m_fileLock, &m_stats };
+
+    const Result writeResult = m_file.Write(&record, sizeof(record));
+    PAL_ALERT(writeResult != Result::Success);
+}
+
+// =====================================================================================================================
+// Pass the query to the next layer and record it
+Result TraceCacheLayer::Query(
+    const Hash128* pHashId,
+    uint32         policy,
+    uint32         flags,
+    QueryResult*   pQuery)
+{
+    Result result = Result::ErrorUnknown;
+
+    PAL_ASSERT(m_pNextLayer != nullptr);
+    PAL_ASSERT(pHashId != nullptr);
+    PAL_ASSERT(pQuery != nullptr);
+
+    const int64 start = GetPerfCpuTime();
+
+    result = m_pNextLayer->Query(pHashId, policy, flags, pQuery);
+
+    m_stats.AddQuery(result, static_cast<uint64>(GetPerfCpuTime() - start));
+
+    Record(CacheTraceOp::Query,
+           start,
+           *pHashId,
+           ((result == Result::Success) || (result == Result::NotReady)) ? pQuery->dataSize : 0,
+           (policy & 0xFFFF) | (flags << 16),
+           result);
+
+    return result;
+}
+
+// =====================================================================================================================
+// Store untagged data
+Result TraceCacheLayer::Store(
+    const Hash128* pHashId,
+    const void*    pData,
+    size_t         dataSize)
+{
+    const CacheEntryTag tag = {};
+
+    return StoreTagged(pHashId, pData, dataSize, tag);
+}
+
+// =====================================================================================================================
+// Pass the store to the next layer and record it, along with its tag
+Result TraceCacheLayer::StoreTagged(
+    const Hash128*       pHashId,
+    const void*          pData,
+    size_t               dataSize,
+    const CacheEntryTag& tag)
+{
+    Result result = Result::ErrorUnknown;
+
+    PAL_ASSERT(m_pNextLayer != nullptr);
+    PAL_ASSERT(pHashId != nullptr);
+
+    const int64 start = GetPerfCpuTime();
+
+    result = m_pNextLayer->StoreTagged(pHashId, pData, dataSize, tag);
+
+    m_stats.Add(CacheLayerStatsTracker::StoreTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+
+    if (result == Result::Success)
+    {
+        m_stats.Increment(CacheLayerStatsTracker::StoreCount);
+        m_stats.Add(CacheLayerStatsTracker::BytesStored, dataSize);
+    }
+
+    Record(CacheTraceOp::Store, start, *pHashId, dataSize, 0, result);
+
+    return result;
+}
+
+// =====================================================================================================================
+// Pass the load to the next layer and record it
+Result TraceCacheLayer::Load(
+    const QueryResult* pQuery,
+    void*              pBuffer)
+{
+    Result result = Result::ErrorUnknown;
+
+    PAL_ASSERT(m_pNextLayer != nullptr);
+    PAL_ASSERT(pQuery != nullptr);
+
+    const int64 start = GetPerfCpuTime();
+
+    result = m_pNextLayer->Load(pQuery, pBuffer);
+
+    m_stats.Add(CacheLayerStatsTracker::LoadTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+
+    if (result == Result::Success)
+    {
+        m_stats.Increment(CacheLayerStatsTracker::LoadCount);
+        m_stats.Add(CacheLayerStatsTracker::BytesLoaded, pQuery->dataSize);
+    }
+
+    Record(CacheTraceOp::Load, start, pQuery->hashId, pQuery->dataSize, 0, result);
+
+    return result;
+}
+
+// =====================================================================================================================
+// Report the calls made through this layer.
+Result TraceCacheLayer::GetStats(
+    CacheLayerStats* pStats
+    ) const
+{
+    Result result = Result::Success;
+
+    if (pStats == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else
+    {
+        m_stats.GetStats(pStats);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Link another cache layer to ourselves.
+Result TraceCacheLayer::Link(
+    ICacheLayer* pNextLayer)
+{
+    m_pNextLayer = pNextLayer;
+
+    return Result::Success;
+}
+
+// =====================================================================================================================
+// Get the memory size for a trace cache layer
+size_t GetTraceCacheLayerSize()
+{
+    return sizeof(TraceCacheLayer);
+}
+
+// =====================================================================================================================
+// Create a trace cache layer
+Result CreateTraceCacheLayer(
+    const TraceCacheCreateInfo* pCreateInfo,
+    void*                       pPlacementAddr,
+    ICacheLayer**               ppCacheLayer)
+{
+    PAL_ASSERT(pCreateInfo    != nullptr);
+    PAL_ASSERT(pPlacementAddr != nullptr);
+    PAL_ASSERT(ppCacheLayer   != nullptr);
+
+    Result result = Result::Success;
+
+    if ((pCreateInfo            == nullptr) ||
+        (pCreateInfo->pFilePath == nullptr) ||
+        (pPlacementAddr         == nullptr) ||
+        (ppCacheLayer           == nullptr))
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+
+    if (result == Result::Success)
+    {
+        TraceCacheLayer* pLayer = PAL_PLACEMENT_NEW(pPlacementAddr) TraceCacheLayer();
+
+        result = pLayer->Init(pCreateInfo->pFilePath);
+
+        if (result == Result::Success)
+        {
+            *ppCacheLayer = pLayer;
+        }
+        else
+        {
+            pLayer->Destroy();
+            *ppCacheLayer = nullptr;
+            result        = Result::ErrorUnknown;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Fills a store buffer with data derived from the entry hash so replayed stores are reproducible and don't compress to
+// nothing.
+static void FillReplayData(
+    const Hash128& hashId,
+    void*          pData,
+    size_t         dataSize)
+{
+    uint64 state = (hashId.qwords[0] ^ hashId.qwords[1]) | 1;
+    uint8* pDst  = static_cast<uint8*>(pData);
+
+    for (size_t offset = 0; offset < dataSize; offset += sizeof(uint64))
+    {
+        // xorshift64
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        memcpy(pDst + offset, &state, Min(sizeof(uint64), dataSize - offset));
+    }
+}
+
+// =====================================================================================================================
+// Replay a cache access trace against a cache layer hierarchy
+Result ReplayCacheTrace(
+    const char*            pFilePath,
+    ICacheLayer*           pLayer,
+    const AllocCallbacks*  pCallbacks,
+    CacheTraceReplayStats* pStats)
+{
+    using QueryMap = HashMap<Hash128, QueryResult, ForwardAllocator, JenkinsHashFunc>;
+
+    Result result = Result::Success;
+
+    if ((pFilePath == nullptr) || (pLayer == nullptr))
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+
+    AllocCallbacks callbacks = {};
+
+    if (pCallbacks == nullptr)
+    {
+        Pal::GetDefaultAllocCb(&callbacks);
+    }
+    else
+    {
+        callbacks = *pCallbacks;
+    }
+
+    ForwardAllocator      allocator { callbacks };
+    QueryMap              queries   { 2048, &allocator };
+    CacheTraceReplayStats stats     = {};
+    File                  file;
+
+    stats.ticksPerSecond = static_cast<uint64>(GetPerfFrequency());
+
+    if (result == Result::Success)
+    {
+        result = queries.Init();
+    }
+
+    if (result == Result::Success)
+    {
+        result = (file.Open(pFilePath, FileAccessRead | FileAccessBinary) == Result::Success) ? Result::Success
+                                                                                              : Result::ErrorUnknown;
+    }
+
+    if (result == Result::Success)
+    {
+        CacheTraceFileHeader header    = {};
+        size_t               bytesRead = 0;
+
+        if ((file.Read(&header, sizeof(header), &bytesRead) != Result::Success) ||
+            (bytesRead                                      != sizeof(header))  ||
+            (header.magic                                   != CacheTraceFileMagic) ||
+            (header.version                                 != CacheTraceFileVersion))
+        {
+            result = Result::ErrorInvalidFormat;
+        }
+    }
+
+    // One scratch buffer is grown to the largest entry seen and shared by stores and loads.
+    void*  pBuffer    = nullptr;
+    size_t bufferSize = 0;
+
+    while (result == Result::Success)
+    {
+        CacheTraceRecord record    = {};
+        size_t           bytesRead = 0;
+
+        if ((file.Read(&record, sizeof(record), &bytesRead) != Result::Success) || (bytesRead != sizeof(record)))
+        {
+            // A partial record can only be the tail of a trace whose writer did not shut down cleanly.
+            break;
+        }
+
+        stats.recordCount++;
+
+        const CacheTraceOp op = static_cast<CacheTraceOp>(record.op);
+
+        if ((op == CacheTraceOp::Store) || (op == CacheTraceOp::Load))
+        {
+            const size_t dataSize = static_cast<size_t>(record.dataSize);
+
+            if (dataSize > bufferSize)
+            {
+                PAL_SAFE_FREE(pBuffer, &allocator);
+
+                pBuffer    = PAL_MALLOC(dataSize, &allocator, AllocInternalTemp);
+                bufferSize = (pBuffer != nullptr) ? dataSize : 0;
+
+                if (pBuffer == nullptr)
+                {
+                    result = Result::ErrorOutOfMemory;
+                    break;
+                }
+            }
+        }
+
+        switch (op)
+        {
+        case CacheTraceOp::Query:
+        {
+            const uint32 policy = record.flags & 0xFFFF;
+            const uint32 flags  = (record.flags >> 16) & ~ICacheLayer::QueryFlags::AcquireEntryRef;
+
+            QueryResult  query  = {};
+            const int64  start  = GetPerfCpuTime();
+            const Result found  = pLayer->Query(&record.hashId, policy, flags, &query);
+            stats.elapsedTicks += static_cast<uint64>(GetPerfCpuTime() - start);
+
+            stats.queryCount++;
+
+            if ((found == Result::Success) || (found == Result::NotReady))
+            {
+                stats.hitCount++;
+
+                bool         existed = false;
+                QueryResult* pLatest = nullptr;
+
+                result = queries.FindAllocate(record.hashId, &existed, &pLatest);
+
+                if (result == Result::Success)
+                {
+                    *pLatest = query;
+                }
+            }
+
+            const Result recorded = static_cast<Result>(record.result);
+            if ((recorded == Result::Success) || (recorded == Result::NotReady))
+            {
+                stats.recordedHitCount++;
+            }
+            break;
+        }
+        case CacheTraceOp::Store:
+        {
+            FillReplayData(record.hashId, pBuffer, static_cast<size_t>(record.dataSize));
+
+            const int64 start = GetPerfCpuTime();
+            pLayer->Store(&record.hashId, pBuffer, static_cast<size_t>(record.dataSize));
+            stats.elapsedTicks += static_cast<uint64>(GetPerfCpuTime() - start);
+
+            stats.storeCount++;
+            break;
+        }
+        case CacheTraceOp::Load:
+        {
+            const int64 start = GetPerfCpuTime();
+
+            QueryResult* pQuery = queries.FindKey(record.hashId);
+            QueryResult  query  = {};
+
+            if ((pQuery == nullptr) &&
+                (pLayer->Query(&record.hashId, 0, 0, &query) == Result::Success))
+            {
+                pQuery = &query;
+            }
+
+            // Entries replayed with different data may differ in size from the recorded load; skip those rather than
+            // overrun the scratch buffer.
+            if ((pQuery != nullptr) && (pQuery->dataSize <= bufferSize) &&
+                (pLayer->Load(pQuery, pBuffer) == Result::Success))
+            {
+                stats.loadCount++;
+                stats.bytesLoaded += pQuery->dataSize;
+            }
+
+            stats.elapsedTicks += static_cast<uint64>(GetPerfCpuTime() - start);
+            break;
+        }
+        default:
+            result = Result::ErrorInvalidFormat;
+            break;
+        }
+    }
+
+    PAL_SAFE_FREE(pBuffer, &allocator);
+
+    if (file.IsOpen())
+    {
+        file.Close();
+    }
+
+    if (pStats != nullptr)
+    {
+        *pStats = stats;
+    }
+
+    return result;
+}
+
+} //namespace Util
@@ -0,0 +1,149 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "palCacheLayer.h"
+#include "cacheLayerBase.h"
+
+#include "palFile.h"
+#include "palMutex.h"
+
+namespace Util
+{
+
+// Operations recorded in a cache access trace
+enum class CacheTraceOp : uint32
+{
+    Query = 0,
+    Store = 1,
+    Load  = 2,
+};
+
+// Header at the start of a cache access trace file
+struct CacheTraceFileHeader
+{
+    uint32 magic;          // CacheTraceFileMagic
+    uint32 version;        // CacheTraceFileVersion
+    uint64 ticksPerSecond; // Frequency of CacheTraceRecord::timestamp
+};
+
+// One traced call, the header is followed by a packed array of these
+struct CacheTraceRecord
+{
+    uint64  timestamp; // Time of the call relative to the creation of the trace layer
+    Hash128 hashId;    // Entry hash passed to or returned by the call
+    uint64  dataSize;  // Size of the stored data, or of the entry for queries and loads
+    uint32  op;        // CacheTraceOp
+    uint32  flags;     // Query policy in the low 16 bits and query flags in the high 16 bits
+    int32   result;    // Result returned by the rest of the hierarchy
+    uint32  reserved;
+};
+
+static_assert(sizeof(CacheTraceRecord) == 48, "Cache trace records must keep a fixed layout.");
+
+// =====================================================================================================================
+// The ICacheLayer implementation that passes every call to the next layer and records it to an access trace file
+class TraceCacheLayer : public ICacheLayer
+{
+public:
+    TraceCacheLayer();
+
+    virtual ~TraceCacheLayer();
+
+    Result Init(
+        const char* pFilePath);
+
+    virtual Result Query(
+        const Hash128*  pHashId,
+        uint32          policy,
+        uint32          flags,
+        QueryResult*    pQuery) final;
+
+    virtual Result Store(
+        const Hash128*  pHashId,
+        const void*     pData,
+        size_t          dataSize) final;
+
+    virtual Result StoreTagged(
+        const Hash128*       pHashId,
+        const void*          pData,
+        size_t               dataSize,
+        const CacheEntryTag& tag) final;
+
+    virtual Result Load(
+        const QueryResult* pQuery,
+        void*              pBuffer) final;
+
+    virtual Result Link(
+        ICacheLayer* pNextLayer) final;
+
+    virtual Result SetLoadPolicy(
+        uint32 loadPolicy) final { return Result::Unsupported; }
+
+    virtual Result SetStorePolicy(
+        uint32 storePolicy) final { return Result::Unsupported; }
+
+    virtual ICacheLayer* GetNextLayer() const final { return m_pNextLayer; }
+
+    virtual uint32 GetLoadPolicy() const final { return m_loadPolicy; }
+
+    virtual uint32 GetStorePolicy() const final { return m_storePolicy; }
+
+    virtual Result Prefetch(
+        const Hash128* pHashIds,
+        uint32         count) final
+    {
+        return (m_pNextLayer != nullptr) ? m_pNextLayer->Prefetch(pHashIds, count) : Result::Unsupported;
+    }
+
+    virtual Result GetStats(
+        CacheLayerStats* pStats) const final;
+
+    virtual void Destroy() final { this->~TraceCacheLayer(); }
+
+private:
+    PAL_DISALLOW_COPY_AND_ASSIGN(TraceCacheLayer);
+
+    void Record(
+        CacheTraceOp   op,
+        int64          start,
+        const Hash128& hashId,
+        uint64         dataSize,
+        uint32         flags,
+        Result         result);
+
+    ICacheLayer*   m_pNextLayer;
+    const uint32   m_loadPolicy;
+    const uint32   m_storePolicy;
+    int64          m_startTime;
+
+    Mutex          m_fileLock;
+    File           m_file;
+
+    CacheLayerStatsTracker m_stats;
+};
+
+} //namespace Util
@@ -70,6 +70,8 @@ Result TrackingCacheLayer::Query(
     uint32         flags,
     QueryResult*   pQuery)
 {
+    const int64 start = GetPerfCpuTime();
+
     Result result = Result::ErrorUnknown;
 
     PAL_ASSERT(m_pNextLayer != nullptr);
@@ -92,16 +94,33 @@ Result TrackingCacheLayer::Query(
         m_entries.Erase(*pHashId);
     }
 
+    m_stats.AddQuery(result, static_cast<uint64>(GetPerfCpuTime() - start));
+
     return result;
 }
 
 // =====================================================================================================================
-// Validate inputs, then store data to our layer. Propagate data down to children if needed.
+// Store untagged data
 Result TrackingCacheLayer::Store(
     const Hash128* pHashId,
     const void*    pData,
     size_t         dataSize)
 {
+    const CacheEntryTag tag = {};
+
+    return StoreTagged(pHashId, pData, dataSize, tag);
+}
+
+// =====================================================================================================================
+// Validate inputs, then store data to our layer. Propagate data down to children if needed., along with its tag
+Result TrackingCacheLayer::StoreTagged(
+    const Hash128*       pHashId,
+    const void*          pData,
+    size_t               dataSize,
+    const CacheEntryTag& tag)
+{
+    const int64 start = GetPerfCpuTime();
+
     Result result = Result::ErrorUnknown;
 
     PAL_ASSERT(m_pNextLayer != nullptr);
@@ -112,7 +131,7 @@ Result TrackingCacheLayer::Store(
     }
     else
     {
-        result = m_pNextLayer->Store(pHashId, pData, dataSize);
+        result = m_pNextLayer->StoreTagged(pHashId, pData, dataSize, tag);
     }
 
     if (pHashId != nullptr)
@@ -127,6 +146,14 @@ Result TrackingCacheLayer::Store(
         }
     }
 
+    m_stats.Add(CacheLayerStatsTracker::StoreTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+
+    if (result == Result::Success)
+    {
+        m_stats.Increment(CacheLayerStatsTracker::StoreCount);
+        m_stats.Add(CacheLayerStatsTracker::BytesStored, dataSize);
+    }
+
     return result;
 }
 
@@ -136,6 +163,8 @@ Result TrackingCacheLayer::Load(
     const QueryResult* pQuery,
     void*              pBuffer)
 {
+    const int64 start = GetPerfCpuTime();
+
     Result result = Result::ErrorUnknown;
 
     PAL_ASSERT(m_pNextLayer != nullptr);
@@ -154,6 +183,34 @@ Result TrackingCacheLayer::Load(
         m_entries.Erase(pQuery->hashId);
     }
 
+    m_stats.Add(CacheLayerStatsTracker::LoadTicks, static_cast<uint64>(GetPerfCpuTime() - start));
+
+    if (result == Result::Success)
+    {
+        m_stats.Increment(CacheLayerStatsTracker::LoadCount);
+        m_stats.Add(CacheLayerStatsTracker::BytesLoaded, pQuery->dataSize);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Report the calls made through this layer.
+Result TrackingCacheLayer::GetStats(
+    CacheLayerStats* pStats
+    ) const
+{
+    Result result = Result::Success;
+
+    if (pStats == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else
+    {
+        m_stats.GetStats(pStats);
+    }
+
     return result;
 }
 
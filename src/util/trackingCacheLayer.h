@@ -25,6 +25,7 @@
 #pragma once
 
 #include "palCacheLayer.h"
+#include "cacheLayerBase.h"
 
 #include "palSysMemory.h"
 #include "palLinearAllocator.h"
@@ -57,6 +58,12 @@ public:
         const void*     pData,
         size_t          dataSize) final;
 
+    virtual Result StoreTagged(
+        const Hash128*       pHashId,
+        const void*          pData,
+        size_t               dataSize,
+        const CacheEntryTag& tag) final;
+
     virtual Result Load(
         const QueryResult* pQuery,
         void*              pBuffer) final;
@@ -76,6 +83,16 @@ public:
 
     virtual uint32 GetStorePolicy() const final { return m_storePolicy; }
 
+    virtual Result Prefetch(
+        const Hash128* pHashIds,
+        uint32         count) final
+    {
+        return (m_pNextLayer != nullptr) ? m_pNextLayer->Prefetch(pHashIds, count) : Result::Unsupported;
+    }
+
+    virtual Result GetStats(
+        CacheLayerStats* pStats) const final;
+
     virtual void Destroy() final { this->~TrackingCacheLayer(); }
 
     static TrackedHashIter GetEntriesBegin(
@@ -97,6 +114,8 @@ private:
     const uint32     m_storePolicy;
 
     TrackedHashSet   m_entries;
+
+    CacheLayerStatsTracker m_stats;
 };
 
 } //namespace Util
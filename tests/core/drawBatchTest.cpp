@@ -0,0 +1,407 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+// Checks which gfx9 indexed draws the DrawIndexedBatchMaxCount setting coalesces into one DRAW_INDEX_INDIRECT_MULTI
+// packet, by decoding the PM4 recorded on a null Vega10. A draw may only join a batch when nothing was written to the
+// DE command stream since the previous draw, so any state change in between must start a new batch.
+
+#include "palTestDevice.h"
+#include "core/hw/gfxip/gfxDevice.h"
+#include "core/hw/gfxip/graphicsPipeline.h"
+#include "core/hw/gfxip/gfx9/gfx9CmdUtil.h"
+#include "core/hw/gfxip/gfx9/gfx9Device.h"
+#include "core/hw/gfxip/rpm/rsrcProcMgr.h"
+#include "palCmdBuffer.h"
+#include "palGpuMemory.h"
+
+#include <cstdlib>
+
+using namespace Pal;
+using namespace Util;
+
+namespace DrawBatchTest
+{
+
+constexpr uint32 MaxDwords      = 16 * 1024;
+constexpr uint32 MaxPackets     = 4 * 1024;
+
+// Every draw reads the first few indices of a buffer holding IndexCount of them.
+constexpr uint32 IndexCount     = 64;
+constexpr uint32 DrawIndexCount = 3;
+
+// The batch size used unless a test checks the limit itself.
+constexpr uint32 BatchMaxCount  = 16;
+
+// The count field of DRAW_INDEX_INDIRECT_MULTI, which is patched as draws join the batch.
+constexpr uint32 MultiDrawCountDword = offsetof(PM4_PFP_DRAW_INDEX_INDIRECT_MULTI, ordinal6) / sizeof(uint32);
+
+// =====================================================================================================================
+// RsrcProcMgr only hands its pipelines out to subclasses. Any of its graphics pipelines will do since nothing executes.
+struct RpmPipelineAccess : public RsrcProcMgr
+{
+    static const GraphicsPipeline* Get(const RsrcProcMgr& rsrcProcMgr, RpmGfxPipeline pipeline)
+        { return (rsrcProcMgr.*(&RpmPipelineAccess::GetGfxPipeline))(pipeline); }
+};
+
+// =====================================================================================================================
+// A type-3 packet found in a recorded command stream.
+struct Packet
+{
+    uint32        opcode;
+    const uint32* pDwords; // Points at the packet header.
+};
+
+// =====================================================================================================================
+// Splits a command stream into its type-3 packets. Returns false if the stream can't be decoded.
+static bool DecodePackets(
+    const uint32* pDwords,
+    uint32        numDwords,
+    Packet*       pPackets,
+    uint32*       pNumPackets)
+{
+    bool   ok         = true;
+    uint32 numPackets = 0;
+
+    for (uint32 offset = 0; ok && (offset < numDwords); )
+    {
+        PM4_PFP_TYPE_3_HEADER header;
+        header.u32All = pDwords[offset];
+
+        if (header.type == 2)
+        {
+            // Type-2 packets are single-dword filler.
+            offset++;
+        }
+        else if ((header.type == 3) && (numPackets < MaxPackets))
+        {
+            pPackets[numPackets].opcode  = header.opcode;
+            pPackets[numPackets].pDwords = pDwords + offset;
+            numPackets++;
+
+            offset += header.count + 2;
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+
+    *pNumPackets = numPackets;
+
+    return PAL_EXPECT(ok);
+}
+
+// =====================================================================================================================
+// Records indexed draws on a universal command buffer with draw batching enabled.
+class DrawBatchFixture
+{
+public:
+    explicit DrawBatchFixture(PalTest::TestDevice* pDevice)
+        :
+        m_pDevice(pDevice),
+        m_pIndexMem(nullptr),
+        m_pCmdBuffer(nullptr),
+        m_pDwords(nullptr),
+        m_numDwords(0),
+        m_pPackets(nullptr),
+        m_numPackets(0)
+    {
+    }
+
+    ~DrawBatchFixture()
+    {
+        if (m_pCmdBuffer != nullptr)
+        {
+            m_pDevice->DestroyObject(m_pCmdBuffer);
+        }
+
+        if (m_pIndexMem != nullptr)
+        {
+            m_pDevice->DestroyObject(m_pIndexMem);
+        }
+
+        free(m_pPackets);
+        free(m_pDwords);
+    }
+
+    // The batch size is fixed when the command buffer is created.
+    bool Init(uint32 batchMaxCount);
+
+    void Begin();
+    void Draw(uint32 firstIndex) { m_pCmdBuffer->CmdDrawIndexed(firstIndex, DrawIndexCount, 0, 0, 1, 0); }
+    bool End();
+
+    ICmdBuffer* CmdBuffer() const { return m_pCmdBuffer; }
+    gpusize     IndexAddr() const { return m_pIndexMem->Desc().gpuVirtAddr; }
+
+    // Returns the draw count of every multi-draw packet recorded, in order.
+    uint32 BatchCounts(uint32* pCounts, uint32 maxCounts) const;
+
+    // Returns true if a SET_CONTEXT_REG packet writing regAddr sits between the first two multi-draw packets.
+    bool ContextRegBetweenBatches(uint32 regAddr) const;
+
+private:
+    PalTest::TestDevice*const m_pDevice;
+    IGpuMemory*               m_pIndexMem;
+    ICmdBuffer*               m_pCmdBuffer;
+    uint32*                   m_pDwords;
+    uint32                    m_numDwords;
+    Packet*                   m_pPackets;
+    uint32                    m_numPackets;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(DrawBatchFixture);
+};
+
+// =====================================================================================================================
+bool DrawBatchFixture::Init(
+    uint32 batchMaxCount)
+{
+    // The command buffer picks up the setting when it's created.
+    const auto& settings = Gfx9::GetGfx9Settings(*m_pDevice->GetDevice());
+    const_cast<Gfx9::Gfx9PalSettings&>(settings).drawIndexedBatchMaxCount = batchMaxCount;
+
+    m_pDwords  = static_cast<uint32*>(malloc(sizeof(uint32) * MaxDwords));
+    m_pPackets = static_cast<Packet*>(malloc(sizeof(Packet) * MaxPackets));
+
+    return PAL_EXPECT((m_pDwords != nullptr) && (m_pPackets != nullptr))                                           &&
+           PAL_EXPECT_RESULT(m_pDevice->CreateGpuMemory(sizeof(uint32) * IndexCount, GpuHeapGartUswc, &m_pIndexMem)) &&
+           PAL_EXPECT_RESULT(m_pDevice->CreateCmdBuffer(QueueTypeUniversal, EngineTypeUniversal, &m_pCmdBuffer));
+}
+
+// =====================================================================================================================
+void DrawBatchFixture::Begin()
+{
+    const GraphicsPipeline*const pPipeline =
+        RpmPipelineAccess::Get(m_pDevice->GetDevice()->GetGfxDevice()->RsrcProcMgr(), RpmGfxPipeline::Copy_32ABGR);
+    PAL_EXPECT(pPipeline != nullptr);
+
+    ViewportParams viewport = {};
+    viewport.count                  = 1;
+    viewport.viewports[0].width     = 64.0f;
+    viewport.viewports[0].height    = 64.0f;
+    viewport.viewports[0].maxDepth  = 1.0f;
+    viewport.viewports[0].origin    = PointOrigin::UpperLeft;
+
+    ScissorRectParams scissor = {};
+    scissor.count                     = 1;
+    scissor.scissors[0].extent.width  = 64;
+    scissor.scissors[0].extent.height = 64;
+
+    CmdBufferBuildInfo buildInfo = {};
+
+    PAL_EXPECT_RESULT(m_pCmdBuffer->Reset(nullptr, true));
+    PAL_EXPECT_RESULT(m_pCmdBuffer->Begin(buildInfo));
+
+    m_pCmdBuffer->CmdBindPipeline({ PipelineBindPoint::Graphics, pPipeline, 0, });
+    m_pCmdBuffer->CmdSetViewports(viewport);
+    m_pCmdBuffer->CmdSetScissorRects(scissor);
+    m_pCmdBuffer->CmdBindIndexData(IndexAddr(), IndexCount, IndexType::Idx32);
+}
+
+// =====================================================================================================================
+bool DrawBatchFixture::End()
+{
+    PAL_EXPECT_RESULT(m_pCmdBuffer->End());
+
+    m_numDwords = PalTest::TestDevice::ReadCmdStream(*m_pCmdBuffer, 0, m_pDwords, MaxDwords);
+
+    return PAL_EXPECT(m_numDwords <= MaxDwords) && DecodePackets(m_pDwords, m_numDwords, m_pPackets, &m_numPackets);
+}
+
+// =====================================================================================================================
+uint32 DrawBatchFixture::BatchCounts(
+    uint32* pCounts,
+    uint32  maxCounts
+    ) const
+{
+    uint32 numBatches = 0;
+
+    for (uint32 idx = 0; idx < m_numPackets; idx++)
+    {
+        if (m_pPackets[idx].opcode == Gfx9::IT_DRAW_INDEX_INDIRECT_MULTI)
+        {
+            if (numBatches < maxCounts)
+            {
+                pCounts[numBatches] = m_pPackets[idx].pDwords[MultiDrawCountDword];
+            }
+
+            numBatches++;
+        }
+    }
+
+    return numBatches;
+}
+
+// =====================================================================================================================
+bool DrawBatchFixture::ContextRegBetweenBatches(
+    uint32 regAddr
+    ) const
+{
+    uint32 numBatchesSeen = 0;
+    bool   found          = false;
+
+    for (uint32 idx = 0; (idx < m_numPackets) && (numBatchesSeen < 2); idx++)
+    {
+        if (m_pPackets[idx].opcode == Gfx9::IT_DRAW_INDEX_INDIRECT_MULTI)
+        {
+            numBatchesSeen++;
+        }
+        else if ((numBatchesSeen == 1)                                  &&
+                 (m_pPackets[idx].opcode == Gfx9::IT_SET_CONTEXT_REG)    &&
+                 ((m_pPackets[idx].pDwords[1] & 0xFFFF) == (regAddr - Gfx9::CONTEXT_SPACE_START)))
+        {
+            found = true;
+        }
+    }
+
+    return found && (numBatchesSeen == 2);
+}
+
+// =====================================================================================================================
+// Back-to-back draws with nothing in between share one packet; with batching disabled none is recorded.
+PAL_TEST(DrawBatchMergesConsecutiveDraws)
+{
+    constexpr uint32 NumDraws = 4;
+
+    for (uint32 batchMaxCount = 0; batchMaxCount <= BatchMaxCount; batchMaxCount += BatchMaxCount)
+    {
+        PalTest::TestDevice device;
+        DrawBatchFixture    fixture(&device);
+
+        if (PAL_EXPECT_RESULT(device.Init(NullGpuId::Vega10)) &&
+            PAL_EXPECT_RESULT(device.Finalize())               &&
+            fixture.Init(batchMaxCount))
+        {
+            fixture.Begin();
+
+            for (uint32 idx = 0; idx < NumDraws; idx++)
+            {
+                fixture.Draw(idx * DrawIndexCount);
+            }
+
+            uint32 counts[2] = {};
+
+            if (fixture.End() && PAL_EXPECT_EQ(fixture.BatchCounts(counts, 2), (batchMaxCount > 0) ? 1u : 0u))
+            {
+                PAL_EXPECT_EQ(counts[0], (batchMaxCount > 0) ? NumDraws : 0u);
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+// A state change between two draws writes PM4 which the second draw depends on, so the second draw must not be folded
+// into the packet recorded before it.
+PAL_TEST(DrawBatchSplitsAtStateChange)
+{
+    PalTest::TestDevice device;
+    DrawBatchFixture    fixture(&device);
+
+    if (PAL_EXPECT_RESULT(device.Init(NullGpuId::Vega10)) &&
+        PAL_EXPECT_RESULT(device.Finalize())               &&
+        fixture.Init(BatchMaxCount))
+    {
+        BlendConstParams blendConst = {};
+        blendConst.blendConst[0] = 0.5f;
+
+        fixture.Begin();
+        fixture.Draw(0);
+        fixture.Draw(DrawIndexCount);
+        fixture.CmdBuffer()->CmdSetBlendConst(blendConst);
+        fixture.Draw(0);
+
+        uint32 counts[3] = {};
+
+        if (fixture.End() && PAL_EXPECT_EQ(fixture.BatchCounts(counts, 3), 2u))
+        {
+            PAL_EXPECT_EQ(counts[0], 2u);
+            PAL_EXPECT_EQ(counts[1], 1u);
+            PAL_EXPECT(fixture.ContextRegBetweenBatches(Gfx9::mmCB_BLEND_RED));
+        }
+    }
+}
+
+// =====================================================================================================================
+// The multi-draw packet fetches indices through the INDEX_BASE it was recorded after, so a new index buffer needs a new
+// batch even though binding it writes no PM4 by itself.
+PAL_TEST(DrawBatchSplitsAtIndexBufferChange)
+{
+    PalTest::TestDevice device;
+    DrawBatchFixture    fixture(&device);
+
+    if (PAL_EXPECT_RESULT(device.Init(NullGpuId::Vega10)) &&
+        PAL_EXPECT_RESULT(device.Finalize())               &&
+        fixture.Init(BatchMaxCount))
+    {
+        fixture.Begin();
+        fixture.Draw(0);
+        fixture.CmdBuffer()->CmdBindIndexData(fixture.IndexAddr() + sizeof(uint32) * DrawIndexCount,
+                                              IndexCount - DrawIndexCount,
+                                              IndexType::Idx32);
+        fixture.Draw(0);
+
+        uint32 counts[3] = {};
+
+        if (fixture.End() && PAL_EXPECT_EQ(fixture.BatchCounts(counts, 3), 2u))
+        {
+            PAL_EXPECT_EQ(counts[0], 1u);
+            PAL_EXPECT_EQ(counts[1], 1u);
+        }
+    }
+}
+
+// =====================================================================================================================
+// A batch never grows past the setting; the next draw starts a new one.
+PAL_TEST(DrawBatchHonorsMaxCount)
+{
+    constexpr uint32 MaxCount = 2;
+    constexpr uint32 NumDraws = 5;
+
+    PalTest::TestDevice device;
+    DrawBatchFixture    fixture(&device);
+
+    if (PAL_EXPECT_RESULT(device.Init(NullGpuId::Vega10)) &&
+        PAL_EXPECT_RESULT(device.Finalize())               &&
+        fixture.Init(MaxCount))
+    {
+        fixture.Begin();
+
+        for (uint32 idx = 0; idx < NumDraws; idx++)
+        {
+            fixture.Draw(0);
+        }
+
+        uint32 counts[4] = {};
+
+        if (fixture.End() && PAL_EXPECT_EQ(fixture.BatchCounts(counts, 4), 3u))
+        {
+            PAL_EXPECT_EQ(counts[0], MaxCount);
+            PAL_EXPECT_EQ(counts[1], MaxCount);
+            PAL_EXPECT_EQ(counts[2], 1u);
+        }
+    }
+}
+
+} // DrawBatchTest
@@ -0,0 +1,105 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+// These tests drive the amdgpu back-end end to end against the in-process fake DRM, so they are only built with
+// PAL_BUILD_FAKE_DRM.
+
+#include "palTestDevice.h"
+#include "core/os/amdgpu/fakeDrm/fakeDrm.h"
+#include "palCmdBuffer.h"
+#include "palFence.h"
+
+using namespace Pal;
+using namespace Util;
+
+namespace FakeDrmSmokeTest
+{
+
+// Simulated GPU time of each submission. Long enough that a fence wait which doesn't block is easy to tell apart from
+// one which does.
+constexpr uint64 SubmitLatencyNs = 2000000;
+
+// Generous upper bound for every wait, so a broken fake fails the test instead of hanging CI.
+constexpr uint64 WaitTimeoutNs   = 5000000000ull;
+
+// =====================================================================================================================
+// Creates the platform and device, submits an empty command buffer and waits on its fence.
+PAL_TEST(FakeDrmSubmitEmptyCmdBuffer)
+{
+    PalTest::TestDevice device;
+
+    if (PAL_EXPECT_RESULT(device.Init(PalTest::FirstRealGpu)) && PAL_EXPECT_RESULT(device.Finalize()))
+    {
+        DeviceProperties properties = {};
+        PAL_EXPECT_RESULT(device.GetDevice()->GetProperties(&properties));
+
+        // The fake reports a single Vega10.
+        PAL_EXPECT_EQ(properties.gfxLevel, GfxIpLevel::GfxIp9);
+        PAL_EXPECT(device.GetQueue() != nullptr);
+
+        ICmdBuffer* pCmdBuffer = nullptr;
+        IFence*     pFence     = nullptr;
+
+        if (PAL_EXPECT_RESULT(device.CreateCmdBuffer(QueueTypeUniversal, EngineTypeUniversal, &pCmdBuffer)) &&
+            PAL_EXPECT_RESULT(device.CreateFence(false, &pFence)))
+        {
+            PAL_EXPECT_EQ(pFence->GetStatus(), Result::ErrorFenceNeverSubmitted);
+
+            CmdBufferBuildInfo buildInfo = {};
+            PAL_EXPECT_RESULT(pCmdBuffer->Begin(buildInfo));
+            PAL_EXPECT_RESULT(pCmdBuffer->End());
+
+            Amdgpu::SetFakeDrmSubmitLatency(SubmitLatencyNs);
+
+            const uint64 submitNs = PalTest::NowNs();
+            PAL_EXPECT_RESULT(device.Submit(pCmdBuffer, pFence));
+
+            const IFence*const pWaitFence = pFence;
+            PAL_EXPECT_RESULT(device.GetDevice()->WaitForFences(1, &pWaitFence, true, WaitTimeoutNs));
+
+            // The wait must have blocked until the simulated work was done, and the fence must now read as signaled.
+            PAL_EXPECT((PalTest::NowNs() - submitNs) >= SubmitLatencyNs);
+            PAL_EXPECT_RESULT(pFence->GetStatus());
+
+            // A second, immediate submission of the same command buffer must also retire.
+            Amdgpu::SetFakeDrmSubmitLatency(0);
+            PAL_EXPECT_RESULT(device.GetDevice()->ResetFences(1, &pFence));
+            PAL_EXPECT_RESULT(device.Submit(pCmdBuffer, pFence));
+            PAL_EXPECT_RESULT(device.GetDevice()->WaitForFences(1, &pWaitFence, true, WaitTimeoutNs));
+        }
+
+        if (pFence != nullptr)
+        {
+            device.DestroyObject(pFence);
+        }
+
+        if (pCmdBuffer != nullptr)
+        {
+            device.DestroyObject(pCmdBuffer);
+        }
+    }
+}
+
+} // FakeDrmSmokeTest
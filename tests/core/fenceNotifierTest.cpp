@@ -0,0 +1,130 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+// Tests IDevice::SignalEventOnFenceCompletion() on the amdgpu back-end, using the fake DRM so the GPU work has a known
+// duration. Only built with PAL_BUILD_FAKE_DRM.
+
+#include "palTestDevice.h"
+#include "core/os/amdgpu/fakeDrm/fakeDrm.h"
+#include "palCmdBuffer.h"
+#include "palEvent.h"
+#include "palFence.h"
+
+using namespace Pal;
+using namespace Util;
+
+namespace FenceNotifierTest
+{
+
+// Simulated GPU time of each submission. Long enough to reliably observe an event which isn't set yet.
+constexpr uint64 SubmitLatencyNs = 50000000;
+
+// Upper bound for every event wait, in seconds, so a lost notification fails the test instead of hanging CI.
+constexpr float  WaitTimeoutSec  = 5.0f;
+
+constexpr uint32 NumFences       = 2;
+
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 657
+// =====================================================================================================================
+PAL_TEST(FakeDrmFenceCompletionSetsEvent)
+{
+    PalTest::TestDevice device;
+
+    if (PAL_EXPECT_RESULT(device.Init(PalTest::FirstRealGpu)) && PAL_EXPECT_RESULT(device.Finalize()))
+    {
+        ICmdBuffer* pCmdBuffer         = nullptr;
+        IFence*     pFences[NumFences] = {};
+        Util::Event events[NumFences];
+
+        EventCreateFlags eventFlags = {};
+        eventFlags.manualReset = 1;
+
+        bool ready = PAL_EXPECT_RESULT(device.CreateCmdBuffer(QueueTypeUniversal, EngineTypeUniversal, &pCmdBuffer));
+
+        for (uint32 idx = 0; ready && (idx < NumFences); idx++)
+        {
+            ready = PAL_EXPECT_RESULT(device.CreateFence(false, &pFences[idx])) &&
+                    PAL_EXPECT_RESULT(events[idx].Init(eventFlags));
+        }
+
+        if (ready)
+        {
+            IDevice*const pDevice = device.GetDevice();
+
+            CmdBufferBuildInfo buildInfo = {};
+            PAL_EXPECT_RESULT(pCmdBuffer->Begin(buildInfo));
+            PAL_EXPECT_RESULT(pCmdBuffer->End());
+
+            // Bad arguments are rejected before anything is registered.
+            PAL_EXPECT_EQ(pDevice->SignalEventOnFenceCompletion(*pFences[0], nullptr), Result::ErrorInvalidPointer);
+
+            Amdgpu::SetFakeDrmSubmitLatency(SubmitLatencyNs);
+
+            const uint64 submitNs = PalTest::NowNs();
+
+            // The second submission can only start once the first is done, so its fence retires one latency later.
+            for (uint32 idx = 0; idx < NumFences; idx++)
+            {
+                PAL_EXPECT_RESULT(device.Submit(pCmdBuffer, pFences[idx]));
+                PAL_EXPECT_RESULT(pDevice->SignalEventOnFenceCompletion(*pFences[idx], &events[idx]));
+            }
+
+            // The request captures the payload, so resetting the client's fence must not lose the notification.
+            PAL_EXPECT_RESULT(pDevice->ResetFences(1, &pFences[0]));
+
+            // Neither event may be set before the simulated GPU work finishes.
+            PAL_EXPECT_EQ(events[0].Wait(0.0f), Result::Timeout);
+            PAL_EXPECT_EQ(events[1].Wait(0.0f), Result::Timeout);
+
+            PAL_EXPECT_RESULT(events[0].Wait(WaitTimeoutSec));
+            PAL_EXPECT((PalTest::NowNs() - submitNs) >= SubmitLatencyNs);
+
+            PAL_EXPECT_RESULT(events[1].Wait(WaitTimeoutSec));
+            PAL_EXPECT((PalTest::NowNs() - submitNs) >= (NumFences * SubmitLatencyNs));
+
+            // A fence which has already retired sets its event right away.
+            Amdgpu::SetFakeDrmSubmitLatency(0);
+            PAL_EXPECT_RESULT(events[1].Reset());
+            PAL_EXPECT_RESULT(pDevice->SignalEventOnFenceCompletion(*pFences[1], &events[1]));
+            PAL_EXPECT_RESULT(events[1].Wait(WaitTimeoutSec));
+        }
+
+        for (uint32 idx = 0; idx < NumFences; idx++)
+        {
+            if (pFences[idx] != nullptr)
+            {
+                device.DestroyObject(pFences[idx]);
+            }
+        }
+
+        if (pCmdBuffer != nullptr)
+        {
+            device.DestroyObject(pCmdBuffer);
+        }
+    }
+}
+#endif
+
+} // FenceNotifierTest
@@ -0,0 +1,400 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+// Measures how long the GpuProfiler layer takes to replay a submit's command buffers, depending on the number of replay
+// threads. The fake DRM provides a device with a queue and no GPU time, so the wall time of a submit is the layer's
+// replay plus a little PAL submit overhead. Only built with PAL_BUILD_FAKE_DRM and PAL_BUILD_GPU_PROFILER.
+
+#include "palTest.h"
+#include "core/platform.h"
+#include "core/layers/gpuProfiler/gpuProfilerPlatform.h"
+#include "palCmdAllocator.h"
+#include "palCmdBuffer.h"
+#include "palQueue.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Pal;
+using namespace Util;
+
+namespace GpuProfilerReplayTest
+{
+
+// Every submit replays this many independent command buffers of CallsPerCmdBuffer calls each.
+constexpr uint32 NumCmdBuffers     = 8;
+constexpr uint32 CallsPerCmdBuffer = 20000;
+
+constexpr gpusize CmdAllocSize     = 2 * 1024 * 1024;
+constexpr gpusize CmdSuballocSize  = 64 * 1024;
+
+// =====================================================================================================================
+// A fake DRM device behind the GpuProfiler layer, with a universal queue and a set of recorded command buffers.
+//
+// The layer is enabled in its counter and timing mode but its capture range is empty, so nothing is ever logged and
+// independent command buffers may be replayed concurrently.
+class ProfiledDevice
+{
+public:
+    ProfiledDevice();
+    ~ProfiledDevice();
+
+    // The number of replay threads is fixed when the queue is created.
+    Result Init(uint32 replayThreadCount);
+
+    // Records every command buffer; each call is a small state change which the layer tokenizes and replays.
+    Result Record();
+
+    // Submits all command buffers at once and waits for the queue to go idle.
+    Result SubmitAndWait();
+
+private:
+    template <typename CreateInfo, typename GetSizeFunc, typename CreateFunc, typename Object>
+    Result CreateObject(const CreateInfo& createInfo, GetSizeFunc getSize, CreateFunc create, Object** ppObject);
+
+    void DestroyObject(IDestroyable* pObject);
+
+    void*          m_pPlatformMem;
+    Pal::Platform* m_pCorePlatform;
+    IPlatform*     m_pPlatform;
+    IDevice*       m_pDevice;
+    bool           m_deviceInitialized;
+    ICmdAllocator* m_pCmdAllocator;
+    IQueue*        m_pQueue;
+    ICmdBuffer*    m_pCmdBuffers[NumCmdBuffers];
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(ProfiledDevice);
+};
+
+// =====================================================================================================================
+ProfiledDevice::ProfiledDevice()
+    :
+    m_pPlatformMem(nullptr),
+    m_pCorePlatform(nullptr),
+    m_pPlatform(nullptr),
+    m_pDevice(nullptr),
+    m_deviceInitialized(false),
+    m_pCmdAllocator(nullptr),
+    m_pQueue(nullptr)
+{
+    memset(m_pCmdBuffers, 0, sizeof(m_pCmdBuffers));
+}
+
+// =====================================================================================================================
+ProfiledDevice::~ProfiledDevice()
+{
+    for (uint32 idx = 0; idx < NumCmdBuffers; idx++)
+    {
+        if (m_pCmdBuffers[idx] != nullptr)
+        {
+            DestroyObject(m_pCmdBuffers[idx]);
+        }
+    }
+
+    if (m_pQueue != nullptr)
+    {
+        m_pQueue->WaitIdle();
+        DestroyObject(m_pQueue);
+    }
+
+    if (m_pCmdAllocator != nullptr)
+    {
+        DestroyObject(m_pCmdAllocator);
+    }
+
+    if (m_deviceInitialized)
+    {
+        m_pDevice->Cleanup();
+    }
+
+    // Destroying the layer's platform destroys the core platform beneath it.
+    if (m_pPlatform != nullptr)
+    {
+        m_pPlatform->Destroy();
+    }
+    else if (m_pCorePlatform != nullptr)
+    {
+        m_pCorePlatform->Destroy();
+    }
+
+    free(m_pPlatformMem);
+}
+
+// =====================================================================================================================
+// Creates an object the way clients do: query its size, allocate, then construct it in place.
+template <typename CreateInfo, typename GetSizeFunc, typename CreateFunc, typename Object>
+Result ProfiledDevice::CreateObject(
+    const CreateInfo& createInfo,
+    GetSizeFunc       getSize,
+    CreateFunc        create,
+    Object**          ppObject)
+{
+    Result     result  = Result::Success;
+    void*const pMemory = PAL_MALLOC((m_pDevice->*getSize)(createInfo, &result), m_pCorePlatform, AllocInternal);
+
+    if (result != Result::Success)
+    {
+        PAL_FREE(pMemory, m_pCorePlatform);
+    }
+    else if (pMemory == nullptr)
+    {
+        result = Result::ErrorOutOfMemory;
+    }
+    else
+    {
+        result = (m_pDevice->*create)(createInfo, pMemory, ppObject);
+
+        if (result != Result::Success)
+        {
+            PAL_FREE(pMemory, m_pCorePlatform);
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+void ProfiledDevice::DestroyObject(
+    IDestroyable* pObject)
+{
+    // Layer objects are constructed at the start of the memory which was given to them, like core objects.
+    pObject->Destroy();
+    PAL_FREE(pObject, m_pCorePlatform);
+}
+
+// =====================================================================================================================
+Result ProfiledDevice::Init(
+    uint32 replayThreadCount)
+{
+    PlatformCreateInfo createInfo = {};
+    createInfo.pSettingsPath = "/etc/amd";
+
+    AllocCallbacks allocCb = {};
+    GetDefaultAllocCb(&allocCb);
+
+    Result result = Result::ErrorOutOfMemory;
+
+    // Same layout as Pal::CreatePlatform(): the layer's platform first, the core platform after it.
+    m_pPlatformMem = malloc(GetPlatformSize());
+    if (m_pPlatformMem != nullptr)
+    {
+        result = Pal::Platform::Create(createInfo,
+                                       allocCb,
+                                       VoidPtrInc(m_pPlatformMem, sizeof(GpuProfiler::Platform)),
+                                       &m_pCorePlatform);
+    }
+
+    if (result == Result::Success)
+    {
+        // The layer reads its settings from the core platform, which loaded them from the settings file. Override the
+        // ones that matter here; the empty frame range (a frame count of 0) keeps logging off.
+        auto*const pSettings = const_cast<PalPlatformSettings*>(&m_pCorePlatform->PlatformSettings());
+        pSettings->gpuProfilerMode                      = GpuProfilerCounterAndTimingOnly;
+        pSettings->gpuProfilerConfig.frameCount         = 0;
+        pSettings->gpuProfilerConfig.breakSubmitBatches = false;
+        pSettings->gpuProfilerConfig.replayThreadCount  = replayThreadCount;
+
+        m_pCorePlatform->SetClientData(m_pPlatformMem);
+
+        result = GpuProfiler::Platform::Create(createInfo,
+                                               allocCb,
+                                               m_pCorePlatform,
+                                               pSettings->gpuProfilerMode,
+                                               m_pPlatformMem,
+                                               &m_pPlatform);
+    }
+
+    if (result == Result::Success)
+    {
+        uint32   deviceCount           = 0;
+        IDevice* pDevices[MaxDevices] = {};
+
+        result = m_pPlatform->EnumerateDevices(&deviceCount, pDevices);
+
+        if ((result == Result::Success) && (deviceCount == 0))
+        {
+            result = Result::ErrorUnavailable;
+        }
+
+        if (result == Result::Success)
+        {
+            m_pDevice = pDevices[0];
+            result    = m_pDevice->CommitSettingsAndInit();
+        }
+    }
+
+    m_deviceInitialized = (result == Result::Success);
+
+    if (result == Result::Success)
+    {
+        DeviceFinalizeInfo finalizeInfo = {};
+        finalizeInfo.requestedEngineCounts[EngineTypeUniversal].engines = 1;
+
+        result = m_pDevice->Finalize(finalizeInfo);
+    }
+
+    if (result == Result::Success)
+    {
+        CmdAllocatorCreateInfo allocatorInfo = {};
+        allocatorInfo.flags.threadSafe      = 1;
+        allocatorInfo.flags.autoMemoryReuse = 1;
+
+        for (uint32 allocType = 0; allocType < CmdAllocatorTypeCount; allocType++)
+        {
+            allocatorInfo.allocInfo[allocType].allocHeap    = (allocType == GpuScratchMemAlloc) ? GpuHeapInvisible
+                                                                                                  : GpuHeapGartUswc;
+            allocatorInfo.allocInfo[allocType].allocSize    = CmdAllocSize;
+            allocatorInfo.allocInfo[allocType].suballocSize = CmdSuballocSize;
+        }
+
+        result = CreateObject(allocatorInfo,
+                              &IDevice::GetCmdAllocatorSize,
+                              &IDevice::CreateCmdAllocator,
+                              &m_pCmdAllocator);
+    }
+
+    if (result == Result::Success)
+    {
+        QueueCreateInfo queueInfo = {};
+        queueInfo.queueType  = QueueTypeUniversal;
+        queueInfo.engineType = EngineTypeUniversal;
+
+        result = CreateObject(queueInfo, &IDevice::GetQueueSize, &IDevice::CreateQueue, &m_pQueue);
+    }
+
+    for (uint32 idx = 0; (idx < NumCmdBuffers) && (result == Result::Success); idx++)
+    {
+        CmdBufferCreateInfo cmdBufferInfo = {};
+        cmdBufferInfo.pCmdAllocator = m_pCmdAllocator;
+        cmdBufferInfo.queueType     = QueueTypeUniversal;
+        cmdBufferInfo.engineType    = EngineTypeUniversal;
+
+        result = CreateObject(cmdBufferInfo,
+                              &IDevice::GetCmdBufferSize,
+                              &IDevice::CreateCmdBuffer,
+                              &m_pCmdBuffers[idx]);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result ProfiledDevice::Record()
+{
+    Result result = Result::Success;
+
+    for (uint32 idx = 0; (idx < NumCmdBuffers) && (result == Result::Success); idx++)
+    {
+        ICmdBuffer*const pCmdBuffer = m_pCmdBuffers[idx];
+
+        CmdBufferBuildInfo buildInfo = {};
+        result = pCmdBuffer->Begin(buildInfo);
+
+        for (uint32 call = 0; (call < CallsPerCmdBuffer) && (result == Result::Success); call++)
+        {
+            BlendConstParams blendConst = {};
+            blendConst.blendConst[0] = static_cast<float>(call);
+            blendConst.blendConst[3] = static_cast<float>(idx);
+
+            pCmdBuffer->CmdSetBlendConst(blendConst);
+        }
+
+        if (result == Result::Success)
+        {
+            result = pCmdBuffer->End();
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result ProfiledDevice::SubmitAndWait()
+{
+    PerSubQueueSubmitInfo perSubQueueInfo = {};
+    perSubQueueInfo.cmdBufferCount = NumCmdBuffers;
+    perSubQueueInfo.ppCmdBuffers   = m_pCmdBuffers;
+
+    MultiSubmitInfo submitInfo = {};
+    submitInfo.pPerSubQueueInfo     = &perSubQueueInfo;
+    submitInfo.perSubQueueInfoCount = 1;
+
+    Result result = m_pQueue->Submit(submitInfo);
+
+    if (result == Result::Success)
+    {
+        result = m_pQueue->WaitIdle();
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Reports the wall time of one submit for serial replay and for a growing number of replay threads. The submitting
+// thread replays alongside the workers, so n threads replay on up to n + 1 threads.
+PAL_BENCHMARK(GpuProfilerReplayThreads)
+{
+    constexpr uint32 ThreadCounts[] = { 0, 1, 3, 7 };
+
+    const uint32 numSubmits = PalTest::Iterations(20);
+    double       serialMs   = 0.0;
+
+    for (uint32 countIdx = 0; countIdx < ArrayLen(ThreadCounts); countIdx++)
+    {
+        ProfiledDevice device;
+
+        if (PAL_EXPECT_RESULT(device.Init(ThreadCounts[countIdx])) &&
+            PAL_EXPECT_RESULT(device.Record())                     &&
+            PAL_EXPECT_RESULT(device.SubmitAndWait()))
+        {
+            // The first submit above warmed up the queue's target command buffers and their memory.
+            const uint64 startNs = PalTest::NowNs();
+            bool         ok      = true;
+
+            for (uint32 submit = 0; ok && (submit < numSubmits); submit++)
+            {
+                ok = PAL_EXPECT_RESULT(device.SubmitAndWait());
+            }
+
+            const double submitMs = (PalTest::NowNs() - startNs) / (1000000.0 * numSubmits);
+
+            if (countIdx == 0)
+            {
+                serialMs = submitMs;
+            }
+
+            const uint32 threadCount = ThreadCounts[countIdx];
+            char         metricName[64];
+
+            Snprintf(metricName, sizeof(metricName), "GpuProfilerReplayThreads %u threads submit", threadCount);
+            PalTest::ReportMetric(metricName, submitMs, "ms");
+
+            Snprintf(metricName, sizeof(metricName), "GpuProfilerReplayThreads %u threads speedup", threadCount);
+            PalTest::ReportMetric(metricName, serialMs / submitMs, "x");
+        }
+    }
+}
+
+} // GpuProfilerReplayTest
@@ -0,0 +1,434 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+// Checks the gfx9 CPU expansion of CmdExecuteIndirectCmds() on a null Vega10. The generator shader's output only exists
+// once a GPU runs it, so the reference is what that output stands for: the PM4 recorded by issuing each command's
+// direct calls by hand.
+
+#include "palTestDevice.h"
+#include "core/hw/gfxip/computePipeline.h"
+#include "core/hw/gfxip/gfxDevice.h"
+#include "core/hw/gfxip/gfx9/gfx9Device.h"
+#include "core/hw/gfxip/rpm/rsrcProcMgr.h"
+#include "palCmdBuffer.h"
+#include "palGpuMemory.h"
+#include "palIndirectCmdGenerator.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Pal;
+using namespace Util;
+
+namespace IndirectCmdExpansionTest
+{
+
+// Large enough for a handful of dispatches plus the command buffer preamble and postamble.
+constexpr uint32 MaxDwords         = 16 * 1024;
+
+// cpuIndirectCmdExpansionMaxCount while the CPU path is enabled.
+constexpr uint32 ExpansionMaxCount = 8;
+
+// =====================================================================================================================
+// RsrcProcMgr only hands its pipelines out to subclasses. Borrowing one of its compute pipelines saves the test from
+// building a pipeline ELF with complete hardware metadata; the pipeline is never executed.
+struct RpmPipelineAccess : public RsrcProcMgr
+{
+    static const ComputePipeline* Get(const RsrcProcMgr& rsrcProcMgr, RpmComputePipeline pipeline)
+        { return (rsrcProcMgr.*(&RpmPipelineAccess::GetPipeline))(pipeline); }
+};
+
+// =====================================================================================================================
+// Owns a dispatch generator, its argument buffer and a universal command buffer to record it into.
+class ExpansionFixture
+{
+public:
+    explicit ExpansionFixture(PalTest::TestDevice* pDevice)
+        :
+        m_pDevice(pDevice),
+        m_pParams(nullptr),
+        m_paramCount(0),
+        m_argStride(0),
+        m_pArgs(nullptr),
+        m_pGenerator(nullptr),
+        m_pGeneratorMem(nullptr),
+        m_pArgMem(nullptr),
+        m_pCmdBuffer(nullptr),
+        m_pPipeline(nullptr)
+    {
+    }
+
+    ~ExpansionFixture()
+    {
+        IDestroyable* pObjects[] = { m_pCmdBuffer, m_pGenerator, m_pGeneratorMem, m_pArgMem };
+
+        for (uint32 idx = 0; idx < ArrayLen(pObjects); idx++)
+        {
+            if (pObjects[idx] != nullptr)
+            {
+                m_pDevice->DestroyObject(pObjects[idx]);
+            }
+        }
+    }
+
+    bool Init(const IndirectParam* pParams, uint32 paramCount, const void* pArgs, size_t argsSize);
+
+    // Records CmdExecuteIndirectCmds() with the CPU path limited to expansionMaxCount commands (0 disables it).
+    uint32 RecordExecuteIndirect(uint32 expansionMaxCount, uint32 maximumCount, uint32* pDwords);
+
+    // Records the direct calls the first numCmds commands stand for, decoding the arguments independently of PAL.
+    uint32 RecordDirectCalls(uint32 numCmds, uint32* pDwords);
+
+    // Records nothing but the pipeline bind which every recording starts with.
+    uint32 RecordEmpty(uint32* pDwords);
+
+private:
+    void   Begin();
+    uint32 End(uint32* pDwords);
+
+    PalTest::TestDevice*const m_pDevice;
+    const IndirectParam*      m_pParams;
+    uint32                    m_paramCount;
+    uint32                    m_argStride;
+    const void*               m_pArgs;
+    IIndirectCmdGenerator*    m_pGenerator;
+    IGpuMemory*               m_pGeneratorMem;
+    IGpuMemory*               m_pArgMem;
+    ICmdBuffer*               m_pCmdBuffer;
+    const IPipeline*          m_pPipeline;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(ExpansionFixture);
+};
+
+// =====================================================================================================================
+bool ExpansionFixture::Init(
+    const IndirectParam* pParams,
+    uint32               paramCount,
+    const void*          pArgs,
+    size_t               argsSize)
+{
+    Device*const pDevice = m_pDevice->GetDevice();
+
+    m_pParams    = pParams;
+    m_paramCount = paramCount;
+    m_pArgs      = pArgs;
+    m_argStride  = 0;
+    m_pPipeline  = RpmPipelineAccess::Get(pDevice->GetGfxDevice()->RsrcProcMgr(), RpmComputePipeline::FillMemDword);
+
+    for (uint32 p = 0; p < paramCount; p++)
+    {
+        m_argStride += pParams[p].sizeInBytes;
+    }
+
+    IndirectCmdGeneratorCreateInfo createInfo = {};
+    createInfo.pParams       = pParams;
+    createInfo.paramCount    = paramCount;
+    createInfo.strideInBytes = m_argStride;
+
+    Result     result = Result::Success;
+    void*const pMem   = PAL_MALLOC(pDevice->GetIndirectCmdGeneratorSize(createInfo, &result),
+                                   m_pDevice->GetPlatform(),
+                                   AllocInternal);
+
+    bool ok = PAL_EXPECT_RESULT(result) && PAL_EXPECT(pMem != nullptr) && PAL_EXPECT(m_pPipeline != nullptr);
+
+    if (ok)
+    {
+        ok = PAL_EXPECT_RESULT(pDevice->CreateIndirectCmdGenerator(createInfo, pMem, &m_pGenerator));
+    }
+
+    if (m_pGenerator == nullptr)
+    {
+        PAL_FREE(pMem, m_pDevice->GetPlatform());
+    }
+
+    if (ok)
+    {
+        // The GPU path needs the generator's memory bound; the CPU path never touches it.
+        GpuMemoryRequirements memReqs = {};
+        m_pGenerator->GetGpuMemoryRequirements(&memReqs);
+
+        ok = (memReqs.size == 0) ||
+             (PAL_EXPECT_RESULT(m_pDevice->CreateGpuMemory(memReqs.size, memReqs.heaps[0], &m_pGeneratorMem)) &&
+              PAL_EXPECT_RESULT(m_pGenerator->BindGpuMemory(m_pGeneratorMem, 0)));
+    }
+
+    void* pData = nullptr;
+
+    ok = ok &&
+         PAL_EXPECT_RESULT(m_pDevice->CreateGpuMemory(argsSize, GpuHeapGartUswc, &m_pArgMem)) &&
+         PAL_EXPECT_RESULT(m_pArgMem->Map(&pData));
+
+    if (ok)
+    {
+        memcpy(pData, pArgs, argsSize);
+        m_pArgMem->Unmap();
+    }
+
+    return ok &&
+           PAL_EXPECT_RESULT(m_pDevice->CreateCmdBuffer(QueueTypeUniversal, EngineTypeUniversal, &m_pCmdBuffer));
+}
+
+// =====================================================================================================================
+void ExpansionFixture::Begin()
+{
+    // The GPU path requires a one-time-submit command buffer.
+    CmdBufferBuildInfo buildInfo = {};
+    buildInfo.flags.optimizeOneTimeSubmit = 1;
+
+    PAL_EXPECT_RESULT(m_pCmdBuffer->Reset(nullptr, true));
+    PAL_EXPECT_RESULT(m_pCmdBuffer->Begin(buildInfo));
+
+    m_pCmdBuffer->CmdBindPipeline({ PipelineBindPoint::Compute, m_pPipeline, 0, });
+}
+
+// =====================================================================================================================
+uint32 ExpansionFixture::End(
+    uint32* pDwords)
+{
+    PAL_EXPECT_RESULT(m_pCmdBuffer->End());
+
+    const uint32 numDwords = PalTest::TestDevice::ReadCmdStream(*m_pCmdBuffer, 0, pDwords, MaxDwords);
+    PAL_EXPECT(numDwords <= MaxDwords);
+
+    return numDwords;
+}
+
+// =====================================================================================================================
+uint32 ExpansionFixture::RecordExecuteIndirect(
+    uint32  expansionMaxCount,
+    uint32  maximumCount,
+    uint32* pDwords)
+{
+    // The setting is read every time CmdExecuteIndirectCmds() is recorded, so flipping it between recordings picks the
+    // path without needing a second device.
+    const auto& settings = Gfx9::GetGfx9Settings(*m_pDevice->GetDevice());
+    const_cast<Gfx9::Gfx9PalSettings&>(settings).cpuIndirectCmdExpansionMaxCount = expansionMaxCount;
+
+    Begin();
+    m_pCmdBuffer->CmdExecuteIndirectCmds(*m_pGenerator, *m_pArgMem, 0, maximumCount, 0);
+
+    return End(pDwords);
+}
+
+// =====================================================================================================================
+uint32 ExpansionFixture::RecordDirectCalls(
+    uint32  numCmds,
+    uint32* pDwords)
+{
+    Begin();
+
+    for (uint32 cmdIdx = 0; cmdIdx < numCmds; cmdIdx++)
+    {
+        const void* pParamArgs = VoidPtrInc(m_pArgs, cmdIdx * m_argStride);
+
+        for (uint32 p = 0; p < m_paramCount; p++)
+        {
+            if (m_pParams[p].type == IndirectParamType::SetUserData)
+            {
+                m_pCmdBuffer->CmdSetUserData(PipelineBindPoint::Compute,
+                                             m_pParams[p].userData.firstEntry,
+                                             m_pParams[p].userData.entryCount,
+                                             static_cast<const uint32*>(pParamArgs));
+            }
+            else if (m_pParams[p].type == IndirectParamType::Dispatch)
+            {
+                const auto*const pDispatch = static_cast<const DispatchIndirectArgs*>(pParamArgs);
+                m_pCmdBuffer->CmdDispatch(pDispatch->x, pDispatch->y, pDispatch->z);
+            }
+
+            pParamArgs = VoidPtrInc(pParamArgs, m_pParams[p].sizeInBytes);
+        }
+    }
+
+    return End(pDwords);
+}
+
+// =====================================================================================================================
+uint32 ExpansionFixture::RecordEmpty(
+    uint32* pDwords)
+{
+    Begin();
+
+    return End(pDwords);
+}
+
+// =====================================================================================================================
+static bool StreamsMatch(
+    const uint32* pLhs,
+    uint32        lhsDwords,
+    const uint32* pRhs,
+    uint32        rhsDwords)
+{
+    return (lhsDwords == rhsDwords) && (memcmp(pLhs, pRhs, sizeof(uint32) * Min(lhsDwords, MaxDwords)) == 0);
+}
+
+// The argument layout of a generator with one SetUserData parameter of NumEntries entries followed by a dispatch.
+template <uint32 NumEntries>
+struct UserDataDispatchArgs
+{
+    uint32               userData[NumEntries];
+    DispatchIndirectArgs dispatch;
+};
+
+// =====================================================================================================================
+// Expands numCmds commands (at most ExpansionMaxCount) and checks the PM4 matches the direct calls.
+static void ExpectCpuExpansionMatchesDirectCalls(
+    const IndirectParam* pParams,
+    uint32               paramCount,
+    const void*          pArgs,
+    size_t               argsSize,
+    uint32               numCmds)
+{
+    PalTest::TestDevice device;
+
+    uint32*const pExpanded = static_cast<uint32*>(malloc(sizeof(uint32) * MaxDwords));
+    uint32*const pDirect   = static_cast<uint32*>(malloc(sizeof(uint32) * MaxDwords));
+
+    if (PAL_EXPECT((pExpanded != nullptr) && (pDirect != nullptr)) &&
+        PAL_EXPECT_RESULT(device.Init(NullGpuId::Vega10))                &&
+        PAL_EXPECT_RESULT(device.Finalize()))
+    {
+        ExpansionFixture fixture(&device);
+
+        if (fixture.Init(pParams, paramCount, pArgs, argsSize))
+        {
+            const uint32 expandedDwords = fixture.RecordExecuteIndirect(ExpansionMaxCount, numCmds, pExpanded);
+            const uint32 directDwords   = fixture.RecordDirectCalls(numCmds, pDirect);
+
+            PAL_EXPECT(StreamsMatch(pExpanded, expandedDwords, pDirect, directDwords));
+
+            // With the CPU path disabled the same call must take the generator path instead, which looks nothing like
+            // the direct calls. Otherwise the comparison above proves nothing.
+            const uint32 gpuDwords = fixture.RecordExecuteIndirect(0, numCmds, pExpanded);
+            PAL_EXPECT(StreamsMatch(pExpanded, gpuDwords, pDirect, directDwords) == false);
+        }
+    }
+
+    free(pDirect);
+    free(pExpanded);
+}
+
+// =====================================================================================================================
+// Each command sets a different pair of user-data entries before dispatching.
+PAL_TEST(IndirectCpuExpansionUserDataDispatch)
+{
+    constexpr uint32 NumCmds = 3;
+
+    IndirectParam params[2] = {};
+    params[0].type                = IndirectParamType::SetUserData;
+    params[0].sizeInBytes         = sizeof(uint32) * 2;
+    params[0].userDataShaderUsage = ApiShaderStageCompute;
+    params[0].userData.firstEntry = 0;
+    params[0].userData.entryCount = 2;
+    params[1].type                = IndirectParamType::Dispatch;
+    params[1].sizeInBytes         = sizeof(DispatchIndirectArgs);
+    params[1].userDataShaderUsage = ApiShaderStageCompute;
+
+    const UserDataDispatchArgs<2> args[NumCmds] =
+    {
+        { { 0x11111111, 0x22222222 }, { 1, 1, 1 } },
+        { { 0x33333333, 0x44444444 }, { 4, 2, 1 } },
+        { { 0x55555555, 0x66666666 }, { 8, 8, 8 } },
+    };
+
+    ExpectCpuExpansionMatchesDirectCalls(params, ArrayLen32(params), args, sizeof(args), NumCmds);
+}
+
+// =====================================================================================================================
+// Two overlapping SetUserData parameters: the second must win for the shared entry, exactly as it would with two
+// CmdSetUserData() calls. The entries start past zero so the offset is exercised too.
+PAL_TEST(IndirectCpuExpansionOverlappingUserData)
+{
+    constexpr uint32 NumCmds = 2;
+
+    struct Args
+    {
+        uint32               first[2];
+        uint32               second[2];
+        DispatchIndirectArgs dispatch;
+    };
+
+    IndirectParam params[3] = {};
+    params[0].type                = IndirectParamType::SetUserData;
+    params[0].sizeInBytes         = sizeof(uint32) * 2;
+    params[0].userDataShaderUsage = ApiShaderStageCompute;
+    params[0].userData.firstEntry = 1;
+    params[0].userData.entryCount = 2;
+    params[1]                     = params[0];
+    params[1].userData.firstEntry = 2;
+    params[2].type                = IndirectParamType::Dispatch;
+    params[2].sizeInBytes         = sizeof(DispatchIndirectArgs);
+    params[2].userDataShaderUsage = ApiShaderStageCompute;
+
+    const Args args[NumCmds] =
+    {
+        { { 0xaaaa0001, 0xaaaa0002 }, { 0xbbbb0002, 0xbbbb0003 }, { 2, 1, 1 } },
+        { { 0xcccc0001, 0xcccc0002 }, { 0xdddd0002, 0xdddd0003 }, { 3, 3, 1 } },
+    };
+
+    ExpectCpuExpansionMatchesDirectCalls(params, ArrayLen32(params), args, sizeof(args), NumCmds);
+}
+
+// =====================================================================================================================
+// A maximum count of 0 executes nothing. With the CPU path enabled that means recording nothing at all; with it at its
+// default of 0 the generator path must be used, as it is for every other count.
+PAL_TEST(IndirectCpuExpansionZeroMaxCount)
+{
+    PalTest::TestDevice device;
+
+    uint32*const pRecorded = static_cast<uint32*>(malloc(sizeof(uint32) * MaxDwords));
+    uint32*const pEmpty    = static_cast<uint32*>(malloc(sizeof(uint32) * MaxDwords));
+
+    if (PAL_EXPECT((pRecorded != nullptr) && (pEmpty != nullptr)) &&
+        PAL_EXPECT_RESULT(device.Init(NullGpuId::Vega10))                &&
+        PAL_EXPECT_RESULT(device.Finalize()))
+    {
+        IndirectParam params[1] = {};
+        params[0].type                = IndirectParamType::Dispatch;
+        params[0].sizeInBytes         = sizeof(DispatchIndirectArgs);
+        params[0].userDataShaderUsage = ApiShaderStageCompute;
+
+        const DispatchIndirectArgs args = { 1, 1, 1 };
+
+        ExpansionFixture fixture(&device);
+
+        if (fixture.Init(params, ArrayLen32(params), &args, sizeof(args)))
+        {
+            const uint32 emptyDwords = fixture.RecordEmpty(pEmpty);
+
+            uint32 numDwords = fixture.RecordExecuteIndirect(ExpansionMaxCount, 0, pRecorded);
+            PAL_EXPECT(StreamsMatch(pRecorded, numDwords, pEmpty, emptyDwords));
+
+            numDwords = fixture.RecordExecuteIndirect(0, 0, pRecorded);
+            PAL_EXPECT(StreamsMatch(pRecorded, numDwords, pEmpty, emptyDwords) == false);
+        }
+    }
+
+    free(pEmpty);
+    free(pRecorded);
+}
+
+} // IndirectCmdExpansionTest
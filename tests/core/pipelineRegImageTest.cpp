@@ -0,0 +1,400 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+// Compares the baked graphics pipeline register image (the BakeGraphicsPipelineRegImage setting) against the SET path
+// it replaces on a null Vega10. Binding a pipeline through the image must leave every context and SH register with the
+// value the SET path would have written; the benchmark measures the cost of a pipeline switch on each bind path.
+
+#include "palTestDevice.h"
+#include "core/hw/gfxip/gfxDevice.h"
+#include "core/hw/gfxip/graphicsPipeline.h"
+#include "core/hw/gfxip/gfx9/gfx9CmdUtil.h"
+#include "core/hw/gfxip/gfx9/gfx9Device.h"
+#include "core/hw/gfxip/rpm/rsrcProcMgr.h"
+#include "palCmdBuffer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Pal;
+using namespace Util;
+
+namespace PipelineRegImageTest
+{
+
+constexpr uint32 MaxDwords    = 256 * 1024;
+
+// Register offsets are relative to the start of their space, as in the SET packets.
+constexpr uint32 NumCtxRegs   = Gfx9::Gfx09_10::CONTEXT_SPACE_END - Gfx9::CONTEXT_SPACE_START + 1;
+constexpr uint32 NumShRegs    = Gfx9::PERSISTENT_SPACE_END - Gfx9::PERSISTENT_SPACE_START + 1;
+
+// Two pipelines which differ in both shaders and context state, so switching between them rewrites both.
+constexpr RpmGfxPipeline PipelineA = RpmGfxPipeline::Copy_32ABGR;
+constexpr RpmGfxPipeline PipelineB = RpmGfxPipeline::Copy_32GR;
+
+// =====================================================================================================================
+// The ways a graphics pipeline can write its static registers when it's bound.
+enum class BindPath : uint32
+{
+    Set,       // SET_CONTEXT_REG / SET_SH_REG packets written per chunk.
+    LoadIndex, // LOAD_CONTEXT_REG_INDEX / LOAD_SH_REG_INDEX from the pipeline's GPU memory (the default).
+    Baked,     // The packed register image built at pipeline creation.
+    Count
+};
+
+constexpr const char* BindPathNames[] = { "set", "load index", "baked" };
+static_assert(ArrayLen(BindPathNames) == static_cast<uint32>(BindPath::Count), "Missing bind path names");
+
+// =====================================================================================================================
+// RsrcProcMgr only hands its pipelines out to subclasses.
+struct RpmPipelineAccess : public RsrcProcMgr
+{
+    static const GraphicsPipeline* Get(const RsrcProcMgr& rsrcProcMgr, RpmGfxPipeline pipeline)
+        { return (rsrcProcMgr.*(&RpmPipelineAccess::GetGfxPipeline))(pipeline); }
+};
+
+// =====================================================================================================================
+// The last value written to each context and SH register by a command stream.
+struct RegState
+{
+    uint32 ctx[NumCtxRegs];
+    uint32 sh[NumShRegs];
+    bool   ctxWritten[NumCtxRegs];
+    bool   shWritten[NumShRegs];
+};
+
+// =====================================================================================================================
+// Replays the SET packets of a command stream into pState. Returns false if the stream can't be decoded or writes a
+// register outside of its space.
+static bool DecodeRegState(
+    const uint32* pDwords,
+    uint32        numDwords,
+    RegState*     pState)
+{
+    memset(pState, 0, sizeof(*pState));
+
+    bool ok = true;
+
+    for (uint32 offset = 0; ok && (offset < numDwords); )
+    {
+        PM4_PFP_TYPE_3_HEADER header;
+        header.u32All = pDwords[offset];
+
+        if (header.type == 2)
+        {
+            // Type-2 packets are single-dword filler.
+            offset++;
+        }
+        else if ((header.type == 3) && ((offset + header.count + 2) <= numDwords))
+        {
+            const uint32 opcode    = header.opcode;
+            const bool   isContext = (opcode == Gfx9::IT_SET_CONTEXT_REG) || (opcode == Gfx9::IT_SET_CONTEXT_REG_INDEX);
+            const bool   isSh      = (opcode == Gfx9::IT_SET_SH_REG)      || (opcode == Gfx9::IT_SET_SH_REG_INDEX);
+
+            if (isContext || isSh)
+            {
+                // The register offset is in the low bits of the first body dword and the values follow it.
+                const uint32 firstReg  = pDwords[offset + 1] & 0xFFFF;
+                const uint32 numValues = header.count;
+                const uint32 numRegs   = isContext ? NumCtxRegs : NumShRegs;
+
+                ok = ((firstReg + numValues) <= numRegs);
+
+                for (uint32 idx = 0; ok && (idx < numValues); idx++)
+                {
+                    if (isContext)
+                    {
+                        pState->ctx[firstReg + idx]        = pDwords[offset + 2 + idx];
+                        pState->ctxWritten[firstReg + idx] = true;
+                    }
+                    else
+                    {
+                        pState->sh[firstReg + idx]        = pDwords[offset + 2 + idx];
+                        pState->shWritten[firstReg + idx] = true;
+                    }
+                }
+            }
+
+            offset += header.count + 2;
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+
+    return PAL_EXPECT(ok);
+}
+
+// =====================================================================================================================
+// A null Vega10 whose graphics pipelines, including the RPM ones used here, are created for one bind path.
+class RegImageFixture
+{
+public:
+    RegImageFixture() : m_pCmdBuffer(nullptr), m_pDwords(nullptr), m_numDwords(0) { }
+
+    ~RegImageFixture()
+    {
+        if (m_pCmdBuffer != nullptr)
+        {
+            m_device.DestroyObject(m_pCmdBuffer);
+        }
+
+        free(m_pDwords);
+    }
+
+    bool Init(BindPath bindPath);
+
+    // Records a pipeline bind and draw for each pipeline in the list.
+    void Record(const RpmGfxPipeline* pPipelines, uint32 numPipelines);
+
+    // Copies the last recording out of the command buffer.
+    bool Read();
+
+    const uint32* Dwords()    const { return m_pDwords; }
+    uint32        NumDwords() const { return m_numDwords; }
+
+private:
+    PalTest::TestDevice m_device;
+    ICmdBuffer*         m_pCmdBuffer;
+    uint32*             m_pDwords;
+    uint32              m_numDwords;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(RegImageFixture);
+};
+
+// =====================================================================================================================
+bool RegImageFixture::Init(
+    BindPath bindPath)
+{
+    bool ok = PAL_EXPECT_RESULT(m_device.Init(NullGpuId::Vega10));
+
+    if (ok)
+    {
+        // The RPM pipelines are created when the device is finalized, so the settings must be changed before that.
+        auto& settings = const_cast<Gfx9::Gfx9PalSettings&>(Gfx9::GetGfx9Settings(*m_device.GetDevice()));
+        settings.enableLoadIndexForObjectBinds = (bindPath == BindPath::LoadIndex);
+        settings.bakeGraphicsPipelineRegImage  = (bindPath == BindPath::Baked);
+
+        m_pDwords = static_cast<uint32*>(malloc(sizeof(uint32) * MaxDwords));
+
+        ok = PAL_EXPECT(m_pDwords != nullptr)   &&
+             PAL_EXPECT_RESULT(m_device.Finalize()) &&
+             PAL_EXPECT_RESULT(m_device.CreateCmdBuffer(QueueTypeUniversal, EngineTypeUniversal, &m_pCmdBuffer));
+    }
+
+    return ok;
+}
+
+// =====================================================================================================================
+void RegImageFixture::Record(
+    const RpmGfxPipeline* pPipelines,
+    uint32                numPipelines)
+{
+    const RsrcProcMgr& rsrcProcMgr = m_device.GetDevice()->GetGfxDevice()->RsrcProcMgr();
+
+    ViewportParams viewport = {};
+    viewport.count                  = 1;
+    viewport.viewports[0].width     = 64.0f;
+    viewport.viewports[0].height    = 64.0f;
+    viewport.viewports[0].maxDepth  = 1.0f;
+    viewport.viewports[0].origin    = PointOrigin::UpperLeft;
+
+    ScissorRectParams scissor = {};
+    scissor.count                     = 1;
+    scissor.scissors[0].extent.width  = 64;
+    scissor.scissors[0].extent.height = 64;
+
+    CmdBufferBuildInfo buildInfo = {};
+
+    PAL_EXPECT_RESULT(m_pCmdBuffer->Reset(nullptr, true));
+    PAL_EXPECT_RESULT(m_pCmdBuffer->Begin(buildInfo));
+
+    m_pCmdBuffer->CmdSetViewports(viewport);
+    m_pCmdBuffer->CmdSetScissorRects(scissor);
+
+    // Pipelines are only written out when a draw is validated, so each bind needs a draw to be measured.
+    for (uint32 idx = 0; idx < numPipelines; idx++)
+    {
+        const GraphicsPipeline*const pPipeline = RpmPipelineAccess::Get(rsrcProcMgr, pPipelines[idx]);
+
+        m_pCmdBuffer->CmdBindPipeline({ PipelineBindPoint::Graphics, pPipeline, 0, });
+        m_pCmdBuffer->CmdDraw(0, 3, 0, 1, 0);
+    }
+
+    PAL_EXPECT_RESULT(m_pCmdBuffer->End());
+}
+
+// =====================================================================================================================
+bool RegImageFixture::Read()
+{
+    m_numDwords = PalTest::TestDevice::ReadCmdStream(*m_pCmdBuffer, 0, m_pDwords, MaxDwords);
+
+    return PAL_EXPECT(m_numDwords <= MaxDwords);
+}
+
+// =====================================================================================================================
+// Prints a register which was written differently by the two paths.
+static void ReportMismatch(
+    uint32 regAddr,
+    bool   expectedWritten,
+    uint32 expectedValue,
+    bool   actualWritten,
+    uint32 actualValue)
+{
+    printf("    register 0x%04X: expected %s0x%08X, got %s0x%08X\n",
+           regAddr,
+           expectedWritten ? "" : "unwritten ",
+           expectedValue,
+           actualWritten ? "" : "unwritten ",
+           actualValue);
+}
+
+// =====================================================================================================================
+// Returns true if both states wrote the same registers with the same values, printing every register which differs.
+static bool RegStatesMatch(
+    const RegState& expected,
+    const RegState& actual)
+{
+    uint32 numMismatches = 0;
+
+    for (uint32 reg = 0; reg < NumCtxRegs; reg++)
+    {
+        if ((expected.ctxWritten[reg] != actual.ctxWritten[reg]) ||
+            (expected.ctxWritten[reg] && (expected.ctx[reg] != actual.ctx[reg])))
+        {
+            ReportMismatch(Gfx9::CONTEXT_SPACE_START + reg,
+                           expected.ctxWritten[reg],
+                           expected.ctx[reg],
+                           actual.ctxWritten[reg],
+                           actual.ctx[reg]);
+            numMismatches++;
+        }
+    }
+
+    for (uint32 reg = 0; reg < NumShRegs; reg++)
+    {
+        if ((expected.shWritten[reg] != actual.shWritten[reg]) ||
+            (expected.shWritten[reg] && (expected.sh[reg] != actual.sh[reg])))
+        {
+            ReportMismatch(Gfx9::PERSISTENT_SPACE_START + reg,
+                           expected.shWritten[reg],
+                           expected.sh[reg],
+                           actual.shWritten[reg],
+                           actual.sh[reg]);
+            numMismatches++;
+        }
+    }
+
+    return (numMismatches == 0);
+}
+
+// =====================================================================================================================
+// A single bind through the baked image sets the same registers to the same values as the SET path.
+PAL_TEST(PipelineRegImageMatchesSetPath)
+{
+    const RpmGfxPipeline pipelines[] = { PipelineA, PipelineB, PipelineA };
+
+    RegImageFixture setPath;
+    RegImageFixture baked;
+    RegState*const  pSetState   = static_cast<RegState*>(malloc(sizeof(RegState)));
+    RegState*const  pBakedState = static_cast<RegState*>(malloc(sizeof(RegState)));
+
+    if (PAL_EXPECT((pSetState != nullptr) && (pBakedState != nullptr)) &&
+        setPath.Init(BindPath::Set)                                     &&
+        baked.Init(BindPath::Baked))
+    {
+        // Check the state after every prefix of the bind sequence, so a register which the image leaves stale when
+        // switching pipelines is caught as well as one it gets wrong.
+        for (uint32 numBinds = 1; numBinds <= ArrayLen(pipelines); numBinds++)
+        {
+            setPath.Record(pipelines, numBinds);
+            baked.Record(pipelines, numBinds);
+
+            if (setPath.Read()                                                   &&
+                baked.Read()                                                     &&
+                DecodeRegState(setPath.Dwords(), setPath.NumDwords(), pSetState) &&
+                DecodeRegState(baked.Dwords(), baked.NumDwords(), pBakedState))
+            {
+                PAL_EXPECT(RegStatesMatch(*pSetState, *pBakedState));
+            }
+        }
+    }
+
+    free(pBakedState);
+    free(pSetState);
+}
+
+// =====================================================================================================================
+// Records command buffers which switch between two pipelines before every draw and reports the CPU time and command
+// space of a switch on each bind path.
+PAL_BENCHMARK(PipelineRegImageSwitch)
+{
+    constexpr uint32 SwitchesPerCmdBuffer = 512;
+
+    const uint32 numCmdBuffers = PalTest::Iterations(400);
+
+    RpmGfxPipeline pipelines[SwitchesPerCmdBuffer];
+
+    for (uint32 idx = 0; idx < SwitchesPerCmdBuffer; idx++)
+    {
+        pipelines[idx] = ((idx % 2) == 0) ? PipelineA : PipelineB;
+    }
+
+    for (uint32 path = 0; path < static_cast<uint32>(BindPath::Count); path++)
+    {
+        RegImageFixture fixture;
+
+        if (fixture.Init(static_cast<BindPath>(path)))
+        {
+            // Warm up the command allocator so every timed command buffer reuses its chunks.
+            fixture.Record(pipelines, SwitchesPerCmdBuffer);
+
+            const uint64 startNs = PalTest::NowNs();
+
+            for (uint32 cmdBufIdx = 0; cmdBufIdx < numCmdBuffers; cmdBufIdx++)
+            {
+                fixture.Record(pipelines, SwitchesPerCmdBuffer);
+            }
+
+            const uint64 elapsedNs   = Max<uint64>(PalTest::NowNs() - startNs, 1);
+            const double numSwitches = static_cast<double>(numCmdBuffers) * SwitchesPerCmdBuffer;
+
+            char name[64] = {};
+            Snprintf(name, sizeof(name), "PipelineRegImageSwitch %s switch", BindPathNames[path]);
+            PalTest::ReportMetric(name, elapsedNs / numSwitches, "ns");
+
+            fixture.Read();
+
+            Snprintf(name, sizeof(name), "PipelineRegImageSwitch %s switch size", BindPathNames[path]);
+            PalTest::ReportMetric(name,
+                                  static_cast<double>(fixture.NumDwords()) / SwitchesPerCmdBuffer,
+                                  "dwords");
+        }
+    }
+}
+
+} // PipelineRegImageTest
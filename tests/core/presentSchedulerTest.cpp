@@ -0,0 +1,301 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+// Drives the present scheduler's worker thread with a stubbed OS presenter which only timestamps each present. Presents
+// need a queue, so this uses the fake DRM device and is only built with PAL_BUILD_FAKE_DRM.
+
+#include "palTestDevice.h"
+#include "core/presentScheduler.h"
+#include "palSysUtil.h"
+
+#include <cstdlib>
+
+using namespace Pal;
+using namespace Util;
+
+namespace PresentSchedulerTest
+{
+
+// How often the benchmark's application thread presents when it isn't deliberately overrunning the worker.
+constexpr uint64 PresentIntervalNs = 50000;
+
+// Upper bound on every wait for the worker, so a lost wake-up fails the test instead of hanging CI.
+constexpr uint64 WaitTimeoutNs     = 5000000000ull;
+
+// =====================================================================================================================
+// A present scheduler which never presents inline and whose asynchronous presents only record when they were executed.
+// The imageIndex of each present is its sequence number.
+class StubPresentScheduler : public PresentScheduler
+{
+public:
+    StubPresentScheduler(PalTest::TestDevice* pDevice, uint64* pProcessedNs, uint32 maxPresents)
+        :
+        PresentScheduler(pDevice->GetDevice()),
+        m_pProcessedNs(pProcessedNs),
+        m_maxPresents(maxPresents),
+        m_numProcessed(0),
+        m_numFailed(0),
+        m_inOrder(true)
+    {
+        // The worker presents on the test device's queue, so a present from that queue is accepted.
+        m_pSignalQueue      = pDevice->GetQueue();
+        m_pPresentQueues[0] = pDevice->GetQueue();
+    }
+
+    virtual ~StubPresentScheduler()
+    {
+        // The queue belongs to the test device.
+        m_pSignalQueue      = nullptr;
+        m_pPresentQueues[0] = nullptr;
+    }
+
+    Result InitScheduler() { return Init(nullptr, nullptr); }
+
+    uint32 NumProcessed() const { return m_numProcessed; }
+    uint32 NumFailed()    const { return m_numFailed; }
+    bool   InOrder()      const { return m_inOrder; }
+
+protected:
+    virtual Result ProcessPresent(const PresentSwapChainInfo& presentInfo, IQueue* pQueue, bool isInline) override
+    {
+        // Only the worker thread executes presents, so none of this needs to be atomic.
+        const uint32 sequence = presentInfo.imageIndex;
+
+        m_inOrder = m_inOrder && (sequence == m_numProcessed);
+
+        if (sequence < m_maxPresents)
+        {
+            m_pProcessedNs[sequence] = PalTest::NowNs();
+        }
+
+        m_numProcessed++;
+
+        return Result::Success;
+    }
+
+    virtual Result FailedToQueuePresentJob(const PresentSwapChainInfo& presentInfo, IQueue* pQueue) override
+    {
+        m_numFailed++;
+
+        return Result::Success;
+    }
+
+private:
+    uint64*const    m_pProcessedNs;
+    const uint32    m_maxPresents;
+    volatile uint32 m_numProcessed;
+    uint32          m_numFailed;
+    bool            m_inOrder;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(StubPresentScheduler);
+};
+
+// =====================================================================================================================
+static Result QueuePresent(
+    StubPresentScheduler* pScheduler,
+    IQueue*               pQueue,
+    uint32                sequence)
+{
+    PresentSwapChainInfo presentInfo = {};
+    presentInfo.presentMode = PresentMode::Fullscreen;
+    presentInfo.imageIndex  = sequence;
+
+    return pScheduler->Present(presentInfo, pQueue);
+}
+
+// =====================================================================================================================
+static int CompareUint64(
+    const void* pLhs,
+    const void* pRhs)
+{
+    const uint64 lhs = *static_cast<const uint64*>(pLhs);
+    const uint64 rhs = *static_cast<const uint64*>(pRhs);
+
+    return (lhs < rhs) ? -1 : ((lhs > rhs) ? 1 : 0);
+}
+
+// =====================================================================================================================
+// Sorts the samples and reports their median, tail and maximum, plus a histogram with power-of-two microsecond buckets.
+static void ReportLatencies(
+    const char* pName,
+    uint64*     pSamplesNs,
+    uint32      numSamples)
+{
+    constexpr uint32 NumBuckets = 12;
+
+    qsort(pSamplesNs, numSamples, sizeof(uint64), &CompareUint64);
+
+    char name[96] = {};
+
+    Snprintf(name, sizeof(name), "%s p50", pName);
+    PalTest::ReportMetric(name, pSamplesNs[numSamples / 2] / 1000.0, "us");
+    Snprintf(name, sizeof(name), "%s p99", pName);
+    PalTest::ReportMetric(name, pSamplesNs[(numSamples * 99ull) / 100] / 1000.0, "us");
+    Snprintf(name, sizeof(name), "%s p99.9", pName);
+    PalTest::ReportMetric(name, pSamplesNs[(numSamples * 999ull) / 1000] / 1000.0, "us");
+    Snprintf(name, sizeof(name), "%s max", pName);
+    PalTest::ReportMetric(name, pSamplesNs[numSamples - 1] / 1000.0, "us");
+
+    // The last bucket also takes everything slower than its bound.
+    uint32 buckets[NumBuckets] = {};
+
+    for (uint32 idx = 0; idx < numSamples; idx++)
+    {
+        uint32 bucket = 0;
+
+        while (((bucket + 1) < NumBuckets) && (pSamplesNs[idx] > (1000ull << bucket)))
+        {
+            bucket++;
+        }
+
+        buckets[bucket]++;
+    }
+
+    for (uint32 bucket = 0; bucket < NumBuckets; bucket++)
+    {
+        Snprintf(name, sizeof(name), "%s <= %u us", pName, 1u << bucket);
+        PalTest::ReportMetric(name, buckets[bucket], "presents");
+    }
+}
+
+// =====================================================================================================================
+// Waits until the worker has executed numPresents presents. Returns false on timeout.
+static bool WaitForPresents(
+    const StubPresentScheduler& scheduler,
+    uint32                      numPresents)
+{
+    const uint64 startNs = PalTest::NowNs();
+
+    while ((scheduler.NumProcessed() < numPresents) && ((PalTest::NowNs() - startNs) < WaitTimeoutNs))
+    {
+        SleepMs(1);
+    }
+
+    return PAL_EXPECT_EQ(scheduler.NumProcessed(), numPresents);
+}
+
+// =====================================================================================================================
+// Queueing far more presents than the job queue holds, without waiting, must block the application thread until the
+// worker frees a slot; every present must still execute, in order.
+PAL_TEST(PresentSchedulerOverrunsJobQueue)
+{
+    constexpr uint32 NumPresents = 4 * PresentJobQueue::Capacity;
+
+    PalTest::TestDevice device;
+
+    if (PAL_EXPECT_RESULT(device.Init(PalTest::FirstRealGpu)) && PAL_EXPECT_RESULT(device.Finalize()))
+    {
+        uint64               processedNs[NumPresents] = {};
+        StubPresentScheduler scheduler(&device, processedNs, NumPresents);
+
+        if (PAL_EXPECT_RESULT(scheduler.InitScheduler()))
+        {
+            for (uint32 idx = 0; idx < NumPresents; idx++)
+            {
+                PAL_EXPECT_RESULT(QueuePresent(&scheduler, device.GetQueue(), idx));
+            }
+
+            if (WaitForPresents(scheduler, NumPresents))
+            {
+                PAL_EXPECT(scheduler.InOrder());
+                PAL_EXPECT_EQ(scheduler.NumFailed(), 0u);
+            }
+
+            PAL_EXPECT_RESULT(scheduler.WaitIdle());
+        }
+    }
+}
+
+// =====================================================================================================================
+// Reports how long the application thread spends in Present() and how long each present waits before the worker thread
+// executes it. Paced presents let the worker go to sleep between jobs, which measures the wake-up path; a burst keeps
+// the job queue full, which measures the application thread blocking on it.
+PAL_BENCHMARK(PresentSchedulerLatency)
+{
+    const uint32 numPresents = PalTest::Iterations(20000);
+
+    PalTest::TestDevice device;
+
+    uint64*const pQueuedNs    = static_cast<uint64*>(malloc(sizeof(uint64) * numPresents));
+    uint64*const pProcessedNs = static_cast<uint64*>(malloc(sizeof(uint64) * numPresents));
+    uint64*const pCallNs      = static_cast<uint64*>(malloc(sizeof(uint64) * numPresents));
+
+    if (PAL_EXPECT((pQueuedNs != nullptr) && (pProcessedNs != nullptr) && (pCallNs != nullptr)) &&
+        PAL_EXPECT_RESULT(device.Init(PalTest::FirstRealGpu))                                  &&
+        PAL_EXPECT_RESULT(device.Finalize()))
+    {
+        for (uint32 pass = 0; pass < 2; pass++)
+        {
+            const bool           paced = (pass == 0);
+            StubPresentScheduler scheduler(&device, pProcessedNs, numPresents);
+
+            if (PAL_EXPECT_RESULT(scheduler.InitScheduler()))
+            {
+                uint64 nextNs = PalTest::NowNs();
+
+                for (uint32 idx = 0; idx < numPresents; idx++)
+                {
+                    if (paced)
+                    {
+                        while (PalTest::NowNs() < nextNs)
+                        {
+                        }
+
+                        nextNs += PresentIntervalNs;
+                    }
+
+                    pQueuedNs[idx] = PalTest::NowNs();
+                    QueuePresent(&scheduler, device.GetQueue(), idx);
+                    pCallNs[idx]   = PalTest::NowNs() - pQueuedNs[idx];
+                }
+
+                if (WaitForPresents(scheduler, numPresents))
+                {
+                    for (uint32 idx = 0; idx < numPresents; idx++)
+                    {
+                        pProcessedNs[idx] -= pQueuedNs[idx];
+                    }
+
+                    const char*const pMode    = paced ? "paced" : "burst";
+                    char             name[64] = {};
+
+                    Snprintf(name, sizeof(name), "PresentSchedulerLatency %s Present() call", pMode);
+                    ReportLatencies(name, pCallNs, numPresents);
+
+                    Snprintf(name, sizeof(name), "PresentSchedulerLatency %s queue to execute", pMode);
+                    ReportLatencies(name, pProcessedNs, numPresents);
+                }
+
+                PAL_EXPECT_RESULT(scheduler.WaitIdle());
+            }
+        }
+    }
+
+    free(pCallNs);
+    free(pProcessedNs);
+    free(pQueuedNs);
+}
+
+} // PresentSchedulerTest
@@ -0,0 +1,420 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+// Checks that the amdgpu queue's incrementally patched resource list matches a full rebuild while resident memory
+// churns, and measures the per-submit cost of both against the size of the resident set. Resource lists are only built
+// by the amdgpu back-end, so these use the fake DRM device and are only built with PAL_BUILD_FAKE_DRM.
+
+#include "palTestDevice.h"
+#include "core/os/amdgpu/amdgpuGpuMemory.h"
+#include "core/os/amdgpu/amdgpuQueue.h"
+#include "core/os/amdgpu/fakeDrm/fakeDrm.h"
+#include "palCmdBuffer.h"
+#include "palFence.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Pal;
+using namespace Util;
+
+namespace ResidencyChurnTest
+{
+
+// The most buffers any submit in this file lists, including the device's internal allocations.
+constexpr uint32 MaxListedBos  = Pal::Device::CmdBufMemReferenceLimit;
+
+// Generous upper bound for every fence wait, so a broken fake fails the test instead of hanging CI.
+constexpr uint64 WaitTimeoutNs = 5000000000ull;
+
+// =====================================================================================================================
+// A fake DRM device with a pool of allocations which are made resident on, and evicted from, its queue.
+class ResidencyFixture
+{
+public:
+    ResidencyFixture()
+        :
+        m_pCmdBuffer(nullptr),
+        m_pFence(nullptr),
+        m_ppGpuMemory(nullptr),
+        m_pResident(nullptr),
+        m_numAllocations(0),
+        m_pListedBos(nullptr),
+        m_numListedBos(0)
+    {
+    }
+
+    ~ResidencyFixture();
+
+    bool Init(uint32 numAllocations);
+
+    // Makes an allocation resident on the queue, or evicts it.
+    Result SetResident(uint32 idx, bool resident);
+
+    // Forces the queue to rebuild its whole resource list at the next submit.
+    void DirtyAll() { AmdgpuQueue()->DirtyGlobalReferences(nullptr, true); }
+
+    // Submits an empty command buffer.
+    bool Submit();
+
+    // Waits for the last submission, then reads back the buffers it listed.
+    bool WaitAndReadList();
+
+    bool SubmitAndWait() { return Submit() && WaitAndReadList(); }
+
+    // Returns true if the last submission listed exactly the resident allocations, each of them once. Internal
+    // allocations may also be listed.
+    bool ListMatchesResidentSet() const;
+
+    // The buffers listed by the last submission, sorted so two lists can be compared.
+    const amdgpu_bo_handle* ListedBos()    const { return m_pListedBos; }
+    uint32                  NumListedBos() const { return m_numListedBos; }
+
+private:
+    Amdgpu::Queue* AmdgpuQueue() const
+        { return static_cast<Amdgpu::Queue*>(static_cast<Pal::Queue*>(m_device.GetQueue())); }
+
+    PalTest::TestDevice m_device;
+    ICmdBuffer*         m_pCmdBuffer;
+    IFence*             m_pFence;
+    IGpuMemory**        m_ppGpuMemory;
+    bool*               m_pResident;
+    uint32              m_numAllocations;
+    amdgpu_bo_handle*   m_pListedBos;
+    uint32              m_numListedBos;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(ResidencyFixture);
+};
+
+// =====================================================================================================================
+ResidencyFixture::~ResidencyFixture()
+{
+    if (m_ppGpuMemory != nullptr)
+    {
+        for (uint32 idx = 0; idx < m_numAllocations; idx++)
+        {
+            if (m_ppGpuMemory[idx] != nullptr)
+            {
+                SetResident(idx, false);
+                m_device.DestroyObject(m_ppGpuMemory[idx]);
+            }
+        }
+    }
+
+    if (m_pFence != nullptr)
+    {
+        m_device.DestroyObject(m_pFence);
+    }
+
+    if (m_pCmdBuffer != nullptr)
+    {
+        m_device.DestroyObject(m_pCmdBuffer);
+    }
+
+    free(m_pListedBos);
+    free(m_pResident);
+    free(m_ppGpuMemory);
+}
+
+// =====================================================================================================================
+bool ResidencyFixture::Init(
+    uint32 numAllocations)
+{
+    m_ppGpuMemory = static_cast<IGpuMemory**>(calloc(numAllocations, sizeof(IGpuMemory*)));
+    m_pResident   = static_cast<bool*>(calloc(numAllocations, sizeof(bool)));
+    m_pListedBos  = static_cast<amdgpu_bo_handle*>(malloc(MaxListedBos * sizeof(amdgpu_bo_handle)));
+
+    bool ok = PAL_EXPECT((m_ppGpuMemory != nullptr) && (m_pResident != nullptr) && (m_pListedBos != nullptr)) &&
+              PAL_EXPECT_RESULT(m_device.Init(PalTest::FirstRealGpu))                                        &&
+              PAL_EXPECT_RESULT(m_device.Finalize());
+
+    ok = ok && PAL_EXPECT_RESULT(m_device.CreateCmdBuffer(QueueTypeUniversal, EngineTypeUniversal, &m_pCmdBuffer)) &&
+               PAL_EXPECT_RESULT(m_device.CreateFence(false, &m_pFence));
+
+    if (ok)
+    {
+        CmdBufferBuildInfo buildInfo = {};
+        ok = PAL_EXPECT_RESULT(m_pCmdBuffer->Begin(buildInfo)) && PAL_EXPECT_RESULT(m_pCmdBuffer->End());
+    }
+
+    // Interprocess allocations are never VM-always-valid, so the kernel needs them in the list of every submission.
+    GpuMemoryCreateInfo createInfo = {};
+    createInfo.size               = 4096;
+    createInfo.vaRange            = VaRange::Default;
+    createInfo.priority           = GpuMemPriority::Normal;
+    createInfo.heapCount          = 1;
+    createInfo.heaps[0]           = GpuHeapGartUswc;
+    createInfo.flags.interprocess = 1;
+
+    IDevice*const  pDevice   = m_device.GetDevice();
+    Platform*const pPlatform = m_device.GetPlatform();
+
+    for (; ok && (m_numAllocations < numAllocations); m_numAllocations++)
+    {
+        Result     result  = Result::Success;
+        void*const pMemory = PAL_MALLOC(pDevice->GetGpuMemorySize(createInfo, &result), pPlatform, AllocInternal);
+
+        ok = PAL_EXPECT_RESULT(result) && PAL_EXPECT(pMemory != nullptr);
+
+        if (ok)
+        {
+            ok = PAL_EXPECT_RESULT(pDevice->CreateGpuMemory(createInfo, pMemory, &m_ppGpuMemory[m_numAllocations]));
+
+            if (ok == false)
+            {
+                m_ppGpuMemory[m_numAllocations] = nullptr;
+                PAL_FREE(pMemory, pPlatform);
+            }
+        }
+    }
+
+    return ok;
+}
+
+// =====================================================================================================================
+Result ResidencyFixture::SetResident(
+    uint32 idx,
+    bool   resident)
+{
+    Result result = Result::Success;
+
+    if (m_pResident[idx] != resident)
+    {
+        if (resident)
+        {
+            GpuMemoryRef memRef = {};
+            memRef.pGpuMemory = m_ppGpuMemory[idx];
+
+            result = m_device.GetDevice()->AddGpuMemoryReferences(1, &memRef, m_device.GetQueue(), 0);
+        }
+        else
+        {
+            result = m_device.GetDevice()->RemoveGpuMemoryReferences(1, &m_ppGpuMemory[idx], m_device.GetQueue());
+        }
+
+        if (result == Result::Success)
+        {
+            m_pResident[idx] = resident;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+static int CompareBos(
+    const void* pLhs,
+    const void* pRhs)
+{
+    const uintptr_t lhs = reinterpret_cast<uintptr_t>(*static_cast<const amdgpu_bo_handle*>(pLhs));
+    const uintptr_t rhs = reinterpret_cast<uintptr_t>(*static_cast<const amdgpu_bo_handle*>(pRhs));
+
+    return (lhs < rhs) ? -1 : ((lhs > rhs) ? 1 : 0);
+}
+
+// =====================================================================================================================
+bool ResidencyFixture::Submit()
+{
+    return PAL_EXPECT_RESULT(m_device.GetDevice()->ResetFences(1, &m_pFence)) &&
+           PAL_EXPECT_RESULT(m_device.Submit(m_pCmdBuffer, m_pFence));
+}
+
+// =====================================================================================================================
+bool ResidencyFixture::WaitAndReadList()
+{
+    const IFence*const pWaitFence = m_pFence;
+
+    bool ok = PAL_EXPECT_RESULT(m_device.GetDevice()->WaitForFences(1, &pWaitFence, true, WaitTimeoutNs));
+
+    if (ok)
+    {
+        m_numListedBos = Amdgpu::GetFakeDrmLastSubmitBos(m_pListedBos, MaxListedBos);
+        ok             = PAL_EXPECT(m_numListedBos <= MaxListedBos);
+
+        qsort(m_pListedBos, Min(m_numListedBos, MaxListedBos), sizeof(amdgpu_bo_handle), &CompareBos);
+    }
+
+    return ok;
+}
+
+// =====================================================================================================================
+bool ResidencyFixture::ListMatchesResidentSet() const
+{
+    bool matches = true;
+
+    for (uint32 idx = 1; idx < m_numListedBos; idx++)
+    {
+        matches &= PAL_EXPECT(m_pListedBos[idx - 1] != m_pListedBos[idx]);
+    }
+
+    for (uint32 idx = 0; idx < m_numAllocations; idx++)
+    {
+        const amdgpu_bo_handle hBo    = static_cast<Amdgpu::GpuMemory*>(m_ppGpuMemory[idx])->SurfaceHandle();
+        const void*const       pFound = bsearch(&hBo, m_pListedBos, m_numListedBos, sizeof(hBo), &CompareBos);
+
+        matches &= PAL_EXPECT_EQ((pFound != nullptr), m_pResident[idx]);
+    }
+
+    return matches;
+}
+
+// =====================================================================================================================
+// Makes a pseudo-random choice of allocations resident or evicted between submits, including evicting and re-adding
+// the same allocation before one submit. Every submit must list exactly the resident allocations, and the patched list
+// must hold the same buffers as a full rebuild.
+PAL_TEST(ResidencyChurnMatchesRebuild)
+{
+    constexpr uint32 NumAllocations = 256;
+    constexpr uint32 NumRounds      = 16;
+    constexpr uint32 ChurnPerRound  = 24;
+
+    ResidencyFixture fixture;
+
+    if (fixture.Init(NumAllocations))
+    {
+        bool   ok  = true;
+        uint32 rng = 0x5eed;
+
+        for (uint32 idx = 0; ok && (idx < NumAllocations); idx += 2)
+        {
+            ok = PAL_EXPECT_RESULT(fixture.SetResident(idx, true));
+        }
+
+        ok = ok && fixture.SubmitAndWait() && fixture.ListMatchesResidentSet();
+
+        amdgpu_bo_handle*const pPatchedBos =
+            static_cast<amdgpu_bo_handle*>(malloc(MaxListedBos * sizeof(amdgpu_bo_handle)));
+        ok = ok && PAL_EXPECT(pPatchedBos != nullptr);
+
+        for (uint32 round = 0; ok && (round < NumRounds); round++)
+        {
+            for (uint32 churn = 0; ok && (churn < ChurnPerRound); churn++)
+            {
+                rng = (rng * 1103515245) + 12345;
+
+                const uint32 idx      = (rng >> 8) % NumAllocations;
+                const bool   resident = ((rng >> 4) & 1) != 0;
+
+                ok = PAL_EXPECT_RESULT(fixture.SetResident(idx, resident));
+
+                // Sometimes take an allocation away and give it back before the same submit.
+                if (ok && ((rng & 0xF) == 0))
+                {
+                    ok = PAL_EXPECT_RESULT(fixture.SetResident(idx, (resident == false))) &&
+                         PAL_EXPECT_RESULT(fixture.SetResident(idx, resident));
+                }
+            }
+
+            ok = ok && fixture.SubmitAndWait() && fixture.ListMatchesResidentSet();
+
+            if (ok)
+            {
+                const size_t patchedSize = fixture.NumListedBos() * sizeof(amdgpu_bo_handle);
+                memcpy(pPatchedBos, fixture.ListedBos(), patchedSize);
+
+                // Both lists are sorted, so a rebuilt list with the same buffers compares equal.
+                fixture.DirtyAll();
+
+                ok = fixture.SubmitAndWait()                                                       &&
+                     PAL_EXPECT_EQ(fixture.NumListedBos() * sizeof(amdgpu_bo_handle), patchedSize) &&
+                     PAL_EXPECT(memcmp(fixture.ListedBos(), pPatchedBos, patchedSize) == 0);
+            }
+        }
+
+        free(pPatchedBos);
+    }
+}
+
+// =====================================================================================================================
+// Reports the CPU cost of a submit against the number of resident allocations, for the patched resource list and for a
+// full rebuild, with a few allocations made resident or evicted before every submit.
+PAL_BENCHMARK(ResidencyChurnSubmit)
+{
+    constexpr uint32 ResidentSetSizes[] = { 1024, 4096, 12288 };
+    constexpr uint32 ChurnPerSubmit     = 8;
+
+    const uint32 numSubmits = PalTest::Iterations(500);
+
+    for (uint32 sizeIdx = 0; sizeIdx < ArrayLen(ResidentSetSizes); sizeIdx++)
+    {
+        const uint32 numResident = ResidentSetSizes[sizeIdx];
+
+        // A few spare allocations rotate through the resident set so every submit has the same churn.
+        ResidencyFixture fixture;
+
+        if (fixture.Init(numResident + ChurnPerSubmit))
+        {
+            bool ok = true;
+
+            for (uint32 idx = 0; ok && (idx < numResident); idx++)
+            {
+                ok = PAL_EXPECT_RESULT(fixture.SetResident(idx, true));
+            }
+
+            ok = ok && fixture.SubmitAndWait();
+
+            for (uint32 rebuild = 0; ok && (rebuild < 2); rebuild++)
+            {
+                uint64 totalNs  = 0;
+                uint32 evictIdx = 0;
+
+                for (uint32 submit = 0; ok && (submit < numSubmits); submit++)
+                {
+                    // Evict the oldest resident allocations and bring back the ones evicted before.
+                    for (uint32 churn = 0; ok && (churn < ChurnPerSubmit); churn++)
+                    {
+                        const uint32 total = numResident + ChurnPerSubmit;
+
+                        ok = PAL_EXPECT_RESULT(fixture.SetResident(evictIdx, false)) &&
+                             PAL_EXPECT_RESULT(fixture.SetResident((evictIdx + numResident) % total, true));
+
+                        evictIdx = (evictIdx + 1) % total;
+                    }
+
+                    if (rebuild != 0)
+                    {
+                        fixture.DirtyAll();
+                    }
+
+                    // Only the submit itself is timed, not the wait or reading back the list.
+                    const uint64 startNs = PalTest::NowNs();
+                    ok       = ok && fixture.Submit();
+                    totalNs += PalTest::NowNs() - startNs;
+                    ok       = ok && fixture.WaitAndReadList();
+                }
+
+                char name[64] = {};
+                Snprintf(name,
+                         sizeof(name),
+                         "ResidencyChurnSubmit %u resident %s",
+                         numResident,
+                         (rebuild != 0) ? "rebuilt" : "patched");
+                PalTest::ReportMetric(name, totalNs / (1000.0 * numSubmits), "us");
+            }
+        }
+    }
+}
+
+} // ResidencyChurnTest
@@ -0,0 +1,459 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+// Exercises the VAM library's global VA space directly, with no device behind it: a correctness check of placement
+// against a page bitmap, and a benchmark of allocation throughput once the space is badly fragmented.
+
+#include "palTest.h"
+#include "palInlineFuncs.h"
+#include "vaminterface.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Util;
+
+namespace VamFragmentationTest
+{
+
+constexpr uint64 PageSize = 4096;
+
+// The VAM manager needs a non-null client handle but these tests have no client object to give it.
+static uint32 g_client;
+
+// =====================================================================================================================
+static void* VAM_STDCALL AllocSysMemCb(
+    VAM_CLIENT_HANDLE hClient,
+    uint32            sizeInBytes)
+{
+    return malloc(sizeInBytes);
+}
+
+// =====================================================================================================================
+static VAM_RETURNCODE VAM_STDCALL FreeSysMemCb(
+    VAM_CLIENT_HANDLE hClient,
+    void*             pAddress)
+{
+    free(pAddress);
+    return VAM_OK;
+}
+
+// =====================================================================================================================
+static VAM_RETURNCODE VAM_STDCALL AcquireSyncObjCb(
+    VAM_CLIENT_HANDLE     hClient,
+    VAM_ACQSYNCOBJ_INPUT* pAcqSyncObjIn)
+{
+    return VAM_OK;
+}
+
+// =====================================================================================================================
+static void VAM_STDCALL ReleaseSyncObjCb(
+    VAM_CLIENT_HANDLE     hClient,
+    VAM_SYNCOBJECT_HANDLE hSyncObj)
+{
+}
+
+// =====================================================================================================================
+static VAM_PTB_HANDLE VAM_STDCALL AllocPtbCb(
+    VAM_CLIENT_HANDLE    hClient,
+    VAM_VIRTUAL_ADDRESS  ptbBaseVirtAddr,
+    VAM_RETURNCODE*const pResult)
+{
+    *pResult = VAM_ERROR;
+    return nullptr;
+}
+
+// =====================================================================================================================
+static VAM_RETURNCODE VAM_STDCALL FreePtbCb(
+    VAM_CLIENT_HANDLE hClient,
+    VAM_PTB_HANDLE    hPtbAlloc)
+{
+    return VAM_ERROR;
+}
+
+// =====================================================================================================================
+static VAM_VIDMEM_HANDLE VAM_STDCALL AllocVidMemCb(
+    VAM_CLIENT_HANDLE      hClient,
+    VAM_ALLOCVIDMEM_INPUT* pAllocVidMemIn)
+{
+    return nullptr;
+}
+
+// =====================================================================================================================
+static VAM_RETURNCODE VAM_STDCALL VidMemCb(
+    VAM_CLIENT_HANDLE hClient,
+    VAM_VIDMEM_HANDLE hVidMem)
+{
+    return VAM_ERROR;
+}
+
+// =====================================================================================================================
+// Only VA placement is under test, so PTB management is turned off and the PTB callbacks above are never called.
+static VAM_RETURNCODE VAM_STDCALL NeedPtbCb()
+{
+    return VAM_ERROR;
+}
+
+// =====================================================================================================================
+// Creates a VAM instance which manages [vaStart, vaStart + vaSize).
+static VAM_HANDLE CreateVam(
+    uint64 vaStart,
+    uint64 vaSize)
+{
+    VAM_CREATE_INPUT createIn = { };
+    createIn.size          = sizeof(VAM_CREATE_INPUT);
+    createIn.version.major = VAM_VERSION_MAJOR;
+    createIn.version.minor = VAM_VERSION_MINOR;
+
+    createIn.callbacks.allocSysMem    = AllocSysMemCb;
+    createIn.callbacks.freeSysMem     = FreeSysMemCb;
+    createIn.callbacks.acquireSyncObj = AcquireSyncObjCb;
+    createIn.callbacks.releaseSyncObj = ReleaseSyncObjCb;
+    createIn.callbacks.allocPTB       = AllocPtbCb;
+    createIn.callbacks.freePTB        = FreePtbCb;
+    createIn.callbacks.allocVidMem    = AllocVidMemCb;
+    createIn.callbacks.freeVidMem     = VidMemCb;
+    createIn.callbacks.offerVidMem    = VidMemCb;
+    createIn.callbacks.reclaimVidMem  = VidMemCb;
+    createIn.callbacks.needPTB        = NeedPtbCb;
+
+    createIn.VARangeStart = vaStart;
+    createIn.VARangeEnd   = vaStart + vaSize - 1;
+    createIn.bigKSize     = 64 * 1024;
+    createIn.PTBSize      = 64 * 1024;
+
+    return VAMCreate(&g_client, &createIn);
+}
+
+// =====================================================================================================================
+// Allocates sizeInBytes from the global VA space. A nonzero va requests that exact address.
+static VAM_RETURNCODE Alloc(
+    VAM_HANDLE hVam,
+    uint64     sizeInBytes,
+    uint32     alignment,
+    uint64     va,
+    uint64*    pVa)
+{
+    VAM_ALLOC_INPUT allocIn = { };
+    allocIn.sizeInBytes    = sizeInBytes;
+    allocIn.alignment      = alignment;
+    allocIn.virtualAddress = va;
+
+    VAM_ALLOC_OUTPUT     allocOut = { };
+    const VAM_RETURNCODE ret      = VAMAlloc(hVam, &allocIn, &allocOut);
+
+    PAL_EXPECT((ret != VAM_OK) || (allocOut.actualSize == sizeInBytes));
+    *pVa = allocOut.virtualAddress;
+
+    return ret;
+}
+
+// =====================================================================================================================
+static VAM_RETURNCODE Free(
+    VAM_HANDLE hVam,
+    uint64     va,
+    uint64     sizeInBytes)
+{
+    VAM_FREE_INPUT freeIn = { };
+    freeIn.virtualAddress = va;
+    freeIn.actualSize     = sizeInBytes;
+
+    return VAMFree(hVam, &freeIn);
+}
+
+// =====================================================================================================================
+static uint64 FreeBytes(
+    VAM_HANDLE hVam)
+{
+    VAM_GLOBALALLOCSTATUS_OUTPUT status = { };
+    VAMQueryGlobalAllocStatus(hVam, &status);
+
+    return status.freeSizeInBytes;
+}
+
+// =====================================================================================================================
+// xorshift32; the tests only need a cheap, repeatable sequence.
+static uint32 NextRandom(
+    uint32* pState)
+{
+    uint32 x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+
+    return x;
+}
+
+struct LiveAlloc
+{
+    uint64 va;
+    uint64 size;
+};
+
+// Removes entry idx from a list whose order doesn't matter.
+static LiveAlloc TakeLive(
+    LiveAlloc* pLive,
+    uint32*    pNumLive,
+    uint32     idx)
+{
+    const LiveAlloc alloc = pLive[idx];
+    pLive[idx] = pLive[--(*pNumLive)];
+
+    return alloc;
+}
+
+// =====================================================================================================================
+// Tracks which pages of a small VA range are allocated.
+class PageMap
+{
+public:
+    explicit PageMap(uint64 vaStart) : m_vaStart(vaStart) { memset(m_bits, 0, sizeof(m_bits)); }
+
+    static constexpr uint32 NumPages = 16384;
+
+    bool IsClear(uint64 va, uint64 size) const
+    {
+        bool clear = true;
+        for (uint64 page = FirstPage(va); clear && (page < FirstPage(va + size)); page++)
+        {
+            clear = ((m_bits[page / 64] & (1ull << (page % 64))) == 0);
+        }
+        return clear;
+    }
+
+    void Update(uint64 va, uint64 size, bool set)
+    {
+        for (uint64 page = FirstPage(va); page < FirstPage(va + size); page++)
+        {
+            if (set)
+            {
+                m_bits[page / 64] |= (1ull << (page % 64));
+            }
+            else
+            {
+                m_bits[page / 64] &= ~(1ull << (page % 64));
+            }
+        }
+    }
+
+private:
+    uint64 FirstPage(uint64 va) const { return (va - m_vaStart) / PageSize; }
+
+    const uint64 m_vaStart;
+    uint64       m_bits[NumPages / 64];
+};
+
+// =====================================================================================================================
+// Random alloc/free churn over a 64 MiB range, checking every placement against a page bitmap: allocations must be
+// aligned, in range and disjoint, an address-specific request must succeed exactly when its pages are free, and once
+// everything is freed again the range must coalesce back into a single chunk.
+PAL_TEST(VamAllocationsNeverOverlap)
+{
+    constexpr uint64 VaStart  = 4ull << 30;
+    constexpr uint64 VaSize   = PageMap::NumPages * PageSize;
+    constexpr uint32 MaxLive  = 1024;
+    constexpr uint32 NumOps   = 20000;
+
+    const VAM_HANDLE hVam = CreateVam(VaStart, VaSize);
+
+    if (PAL_EXPECT(hVam != nullptr))
+    {
+        PageMap    pageMap(VaStart);
+        LiveAlloc  live[MaxLive];
+        uint32     numLive   = 0;
+        uint64     liveBytes = 0;
+        uint32     rng       = 0x5eed;
+        bool       ok        = PAL_EXPECT_EQ(FreeBytes(hVam), VaSize);
+
+        for (uint32 op = 0; ok && (op < NumOps); op++)
+        {
+            const uint32 roll = NextRandom(&rng) % 100;
+
+            if ((numLive < MaxLive) && (roll < 3))
+            {
+                // Ask for a specific address, which only works if nothing there is allocated yet.
+                const uint64 size   = (1 + NextRandom(&rng) % 16) * PageSize;
+                const uint64 want   = VaStart + (NextRandom(&rng) % (PageMap::NumPages - 16)) * PageSize;
+                const bool   isFree = pageMap.IsClear(want, size);
+                uint64       va     = 0;
+
+                const VAM_RETURNCODE ret = Alloc(hVam, size, PageSize, want, &va);
+                ok = PAL_EXPECT_EQ((ret == VAM_OK), isFree) && PAL_EXPECT((ret != VAM_OK) || (va == want));
+
+                if (ok && (ret == VAM_OK))
+                {
+                    pageMap.Update(va, size, true);
+                    live[numLive++] = { va, size };
+                    liveBytes      += size;
+                }
+            }
+            else if ((numLive < MaxLive) && ((numLive == 0) || (roll < 55)))
+            {
+                // Mostly small allocations with the odd large one, at a mix of alignments.
+                const uint64 pages     = ((NextRandom(&rng) % 10) == 0) ? (256 + NextRandom(&rng) % 768)
+                                                                       : (1 + NextRandom(&rng) % 64);
+                const uint64 size      = pages * PageSize;
+                const uint32 alignment = static_cast<uint32>(PageSize << (NextRandom(&rng) % 5));
+                uint64       va        = 0;
+
+                // Failing is fine once the range is fragmented; a bad placement isn't.
+                if (Alloc(hVam, size, alignment, 0, &va) == VAM_OK)
+                {
+                    ok = PAL_EXPECT(IsPow2Aligned(va, alignment))                         &&
+                         PAL_EXPECT((va >= VaStart) && ((va + size) <= (VaStart + VaSize))) &&
+                         PAL_EXPECT(pageMap.IsClear(va, size));
+
+                    if (ok)
+                    {
+                        pageMap.Update(va, size, true);
+                        live[numLive++] = { va, size };
+                        liveBytes      += size;
+                    }
+                }
+            }
+            else
+            {
+                const LiveAlloc alloc = TakeLive(live, &numLive, NextRandom(&rng) % numLive);
+
+                ok = PAL_EXPECT_EQ(Free(hVam, alloc.va, alloc.size), VAM_OK);
+                pageMap.Update(alloc.va, alloc.size, false);
+                liveBytes -= alloc.size;
+            }
+
+            ok = ok && PAL_EXPECT_EQ(FreeBytes(hVam), VaSize - liveBytes);
+        }
+
+        while (numLive > 0)
+        {
+            const LiveAlloc alloc = TakeLive(live, &numLive, numLive - 1);
+            PAL_EXPECT_EQ(Free(hVam, alloc.va, alloc.size), VAM_OK);
+        }
+
+        // Only a fully coalesced range can satisfy an allocation of all of it.
+        uint64 va = 0;
+        if (PAL_EXPECT_EQ(Alloc(hVam, VaSize, static_cast<uint32>(PageSize), 0, &va), VAM_OK))
+        {
+            PAL_EXPECT_EQ(va, VaStart);
+            PAL_EXPECT_EQ(Free(hVam, va, VaSize), VAM_OK);
+        }
+
+        PAL_EXPECT_EQ(VAMDestroy(hVam), VAM_OK);
+    }
+}
+
+// =====================================================================================================================
+// Fragments a 1 TiB range the way heavy sparse-resource use does (many small live allocations with holes between
+// them), then measures the rate of a steady alloc/free churn at mixed sizes and alignments on top of it.
+PAL_BENCHMARK(VamFragmentedChurn)
+{
+    constexpr uint64 VaStart = 1ull << 32;
+    constexpr uint64 VaSize  = 1ull << 40;
+    constexpr uint32 MaxLive = 32768;
+
+    const VAM_HANDLE hVam  = CreateVam(VaStart, VaSize);
+    LiveAlloc*const  pLive = static_cast<LiveAlloc*>(malloc(sizeof(LiveAlloc) * MaxLive));
+
+    if (PAL_EXPECT(hVam != nullptr) && PAL_EXPECT(pLive != nullptr))
+    {
+        const uint32 numOps  = PalTest::Iterations(400000);
+        uint32       numLive = 0;
+        uint32       rng     = 0x5eed;
+        bool         ok      = true;
+
+        // Fill with small allocations then free every other one, leaving MaxLive / 2 holes.
+        for (uint32 idx = 0; ok && (idx < MaxLive); idx++)
+        {
+            const uint64 size = (1 + NextRandom(&rng) % 16) * PageSize;
+            uint64       va   = 0;
+
+            ok = PAL_EXPECT_EQ(Alloc(hVam, size, static_cast<uint32>(PageSize), 0, &va), VAM_OK);
+            pLive[numLive++] = { va, size };
+        }
+
+        uint32 numKept = 0;
+        for (uint32 idx = 0; ok && (idx < numLive); idx++)
+        {
+            if ((idx % 2) == 0)
+            {
+                pLive[numKept++] = pLive[idx];
+            }
+            else
+            {
+                ok = PAL_EXPECT_EQ(Free(hVam, pLive[idx].va, pLive[idx].size), VAM_OK);
+            }
+        }
+        numLive = numKept;
+
+        uint32       numFailed = 0;
+        const uint64 startNs   = PalTest::NowNs();
+
+        for (uint32 op = 0; ok && (op < numOps); op++)
+        {
+            if ((numLive < MaxLive) && ((numLive == 0) || ((NextRandom(&rng) % 100) < 50)))
+            {
+                const uint64 size      = ((NextRandom(&rng) % 10) == 0) ? ((1 + NextRandom(&rng) % 64) << 20)
+                                                                        : ((1 + NextRandom(&rng) % 512) * PageSize);
+                const uint32 alignment = static_cast<uint32>(PageSize << (NextRandom(&rng) % 5));
+                uint64       va        = 0;
+
+                if (Alloc(hVam, size, alignment, 0, &va) == VAM_OK)
+                {
+                    pLive[numLive++] = { va, size };
+                }
+                else
+                {
+                    numFailed++;
+                }
+            }
+            else
+            {
+                const LiveAlloc alloc = TakeLive(pLive, &numLive, NextRandom(&rng) % numLive);
+                ok = PAL_EXPECT_EQ(Free(hVam, alloc.va, alloc.size), VAM_OK);
+            }
+        }
+
+        const uint64 elapsedNs = Max<uint64>(PalTest::NowNs() - startNs, 1);
+
+        PAL_EXPECT_EQ(numFailed, 0u);
+        PalTest::ReportMetric("VamFragmentedChurn ops", static_cast<double>(numOps) / (elapsedNs * 1e-9), "ops/s");
+        PalTest::ReportMetric("VamFragmentedChurn op", static_cast<double>(elapsedNs) / numOps, "ns");
+
+        while (numLive > 0)
+        {
+            const LiveAlloc alloc = TakeLive(pLive, &numLive, numLive - 1);
+            Free(hVam, alloc.va, alloc.size);
+        }
+    }
+
+    if (hVam != nullptr)
+    {
+        VAMDestroy(hVam);
+    }
+
+    free(pLive);
+}
+
+} // VamFragmentationTest
@@ -0,0 +1,162 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palTest.h"
+#include "palInlineFuncs.h"
+#include "palSysUtil.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace PalTest
+{
+
+// Tests are linked into a list as their registrars run, so the runner needs no central table.
+static TestInfo*    g_pFirstTest = nullptr;
+static TestInfo*    g_pLastTest  = nullptr;
+static bool         g_quickRun   = false;
+static Util::uint32 g_failCount  = 0;
+
+// =====================================================================================================================
+TestRegistrar::TestRegistrar(
+    TestInfo* pInfo)
+{
+    // Keep the list in registration order, which is the order the tests appear in each file.
+    if (g_pLastTest == nullptr)
+    {
+        g_pFirstTest = pInfo;
+    }
+    else
+    {
+        g_pLastTest->pNext = pInfo;
+    }
+
+    g_pLastTest = pInfo;
+}
+
+// =====================================================================================================================
+bool Expect(
+    bool        condition,
+    const char* pCondition,
+    const char* pFile,
+    int         line)
+{
+    if (condition == false)
+    {
+        printf("    %s:%d: expected %s\n", pFile, line, pCondition);
+        g_failCount++;
+    }
+
+    return condition;
+}
+
+// =====================================================================================================================
+bool IsQuickRun()
+{
+    return g_quickRun;
+}
+
+// =====================================================================================================================
+Util::uint32 Iterations(
+    Util::uint32 count)
+{
+    return g_quickRun ? Util::Max(count / 1000u, 1u) : count;
+}
+
+// =====================================================================================================================
+void ReportMetric(
+    const char* pName,
+    double      value,
+    const char* pUnit)
+{
+    printf("    %-48s %14.2f %s\n", pName, value, pUnit);
+}
+
+// =====================================================================================================================
+Util::uint64 NowNs()
+{
+    static const double NsPerTick = 1000000000.0 / static_cast<double>(Util::GetPerfFrequency());
+
+    return static_cast<Util::uint64>(static_cast<double>(Util::GetPerfCpuTime()) * NsPerTick);
+}
+
+} // PalTest
+
+// =====================================================================================================================
+// Usage: palTests [--benchmark] [--quick] [name filter]
+//
+// Runs every test whose name contains the filter (or every test if there is none). With --benchmark, the benchmarks
+// are run instead of the tests. Returns nonzero if any expectation failed.
+int main(
+    int   argc,
+    char* argv[])
+{
+    bool        runBenchmarks = false;
+    const char* pFilter       = nullptr;
+
+    for (int arg = 1; arg < argc; arg++)
+    {
+        if (strcmp(argv[arg], "--benchmark") == 0)
+        {
+            runBenchmarks = true;
+        }
+        else if (strcmp(argv[arg], "--quick") == 0)
+        {
+            PalTest::g_quickRun = true;
+        }
+        else
+        {
+            pFilter = argv[arg];
+        }
+    }
+
+    Util::uint32 runCount    = 0;
+    Util::uint32 failedCount = 0;
+
+    for (PalTest::TestInfo* pTest = PalTest::g_pFirstTest; pTest != nullptr; pTest = pTest->pNext)
+    {
+        if ((pTest->isBenchmark == runBenchmarks) &&
+            ((pFilter == nullptr) || (strstr(pTest->pName, pFilter) != nullptr)))
+        {
+            const Util::uint32 failsBefore = PalTest::g_failCount;
+
+            printf("[ RUN    ] %s\n", pTest->pName);
+            fflush(stdout);
+
+            pTest->pfnRun();
+
+            const bool passed = (PalTest::g_failCount == failsBefore);
+            printf("[ %s ] %s\n", passed ? "    OK" : "FAILED", pTest->pName);
+            fflush(stdout);
+
+            runCount++;
+            failedCount += passed ? 0 : 1;
+        }
+    }
+
+    printf("%u run, %u failed\n", runCount, failedCount);
+
+    return (failedCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  palTest.h
+ * @brief Minimal test and benchmark runner used by the palTests executable (built with PAL_BUILD_TESTS).
+ *
+ * Each test or benchmark is a function registered with PAL_TEST() or PAL_BENCHMARK(). The runner executes every test
+ * by default; benchmarks run when "--benchmark" is passed, and "--quick" cuts their iteration counts so CI can run them
+ * as smoke tests. A test fails if any PAL_EXPECT() in it fails.
+ ***********************************************************************************************************************
+ */
+
+#pragma once
+
+#include "palUtil.h"
+
+namespace PalTest
+{
+
+// A test or benchmark known to the runner.
+struct TestInfo
+{
+    const char* pName;
+    void      (*pfnRun)();
+    bool        isBenchmark;
+    TestInfo*   pNext;
+};
+
+// Adds a test to the runner's list. Only meant to be used through PAL_TEST() and PAL_BENCHMARK().
+struct TestRegistrar
+{
+    explicit TestRegistrar(TestInfo* pInfo);
+};
+
+// Records the result of an expectation, printing the failed condition. Returns the condition so a test can stop early.
+extern bool Expect(bool condition, const char* pCondition, const char* pFile, int line);
+
+// Returns true if the runner was started with "--quick".
+extern bool IsQuickRun();
+
+// Returns the number of iterations a benchmark should run: "count" normally, or a small fraction of it for quick runs.
+extern Util::uint32 Iterations(Util::uint32 count);
+
+// Prints a benchmark measurement in a "name: value unit" form which is easy to diff between runs.
+extern void ReportMetric(const char* pName, double value, const char* pUnit);
+
+// Returns a timestamp in nanoseconds from the performance counter.
+extern Util::uint64 NowNs();
+
+} // PalTest
+
+#define PAL_TEST_REGISTER(_name, _isBenchmark)                                              \
+    static void _name();                                                                    \
+    static PalTest::TestInfo      _name##Info = { #_name, &_name, _isBenchmark, nullptr };  \
+    static PalTest::TestRegistrar _name##Registrar(&_name##Info);                           \
+    static void _name()
+
+// Defines a test. The body runs with no arguments and reports failures through PAL_EXPECT().
+#define PAL_TEST(_name)      PAL_TEST_REGISTER(_name, false)
+
+// Defines a benchmark. The body reports its measurements through PalTest::ReportMetric().
+#define PAL_BENCHMARK(_name) PAL_TEST_REGISTER(_name, true)
+
+#define PAL_EXPECT(_cond)        PalTest::Expect((_cond), #_cond, __FILE__, __LINE__)
+#define PAL_EXPECT_EQ(_a, _b)    PalTest::Expect(((_a) == (_b)), #_a " == " #_b, __FILE__, __LINE__)
+#define PAL_EXPECT_RESULT(_expr) PalTest::Expect(((_expr) == Util::Result::Success), #_expr, __FILE__, __LINE__)
@@ -0,0 +1,375 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palTestDevice.h"
+#include "core/cmdStream.h"
+#include "palCmdAllocator.h"
+#include "palFence.h"
+#include "palGpuMemory.h"
+#include "palQueue.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Pal;
+using namespace Util;
+
+namespace PalTest
+{
+
+// Command allocator sizes used by every test device; tests record small command buffers so these can stay modest.
+constexpr gpusize CmdAllocSize    = 2 * 1024 * 1024;
+constexpr gpusize CmdSuballocSize = 64 * 1024;
+
+// =====================================================================================================================
+TestDevice::TestDevice()
+    :
+    m_pPlatformMem(nullptr),
+    m_pPlatform(nullptr),
+    m_pDevice(nullptr),
+    m_deviceInitialized(false),
+    m_pQueue(nullptr),
+    m_pCmdAllocator(nullptr)
+{
+}
+
+// =====================================================================================================================
+TestDevice::~TestDevice()
+{
+    if (m_pQueue != nullptr)
+    {
+        m_pQueue->WaitIdle();
+        DestroyObject(m_pQueue);
+    }
+
+    if (m_pCmdAllocator != nullptr)
+    {
+        DestroyObject(m_pCmdAllocator);
+    }
+
+    if (m_deviceInitialized)
+    {
+        m_pDevice->Cleanup();
+    }
+
+    if (m_pPlatform != nullptr)
+    {
+        m_pPlatform->Destroy();
+    }
+
+    free(m_pPlatformMem);
+}
+
+// =====================================================================================================================
+Result TestDevice::Init(
+    NullGpuId nullGpuId)
+{
+    PlatformCreateInfo createInfo = {};
+    createInfo.pSettingsPath = "/etc/amd";
+
+    if (nullGpuId != FirstRealGpu)
+    {
+        createInfo.flags.createNullDevice = 1;
+        createInfo.nullGpuId              = nullGpuId;
+    }
+
+    // The core platform uses the same default allocation callbacks as Pal::CreatePlatform() would.
+    AllocCallbacks allocCb = {};
+    GetDefaultAllocCb(&allocCb);
+
+    Result result = Result::ErrorOutOfMemory;
+
+    m_pPlatformMem = malloc(GetPlatformSize());
+    if (m_pPlatformMem != nullptr)
+    {
+        result = Platform::Create(createInfo, allocCb, m_pPlatformMem, &m_pPlatform);
+    }
+
+    if (result == Result::Success)
+    {
+        uint32   deviceCount           = 0;
+        IDevice* pDevices[MaxDevices] = {};
+
+        result = m_pPlatform->EnumerateDevices(&deviceCount, pDevices);
+
+        if ((result == Result::Success) && (deviceCount == 0))
+        {
+            result = Result::ErrorUnavailable;
+        }
+
+        if (result == Result::Success)
+        {
+            m_pDevice = static_cast<Device*>(pDevices[0]);
+            result    = m_pDevice->CommitSettingsAndInit();
+        }
+    }
+
+    m_deviceInitialized = (result == Result::Success);
+
+    return result;
+}
+
+// =====================================================================================================================
+Result TestDevice::Finalize()
+{
+    DeviceProperties properties = {};
+    Result           result     = m_pDevice->GetProperties(&properties);
+
+    const bool hasUniversalEngine = (properties.engineProperties[EngineTypeUniversal].engineCount > 0);
+
+    if (result == Result::Success)
+    {
+        DeviceFinalizeInfo finalizeInfo = {};
+        if (hasUniversalEngine)
+        {
+            finalizeInfo.requestedEngineCounts[EngineTypeUniversal].engines = 1;
+        }
+
+        result = m_pDevice->Finalize(finalizeInfo);
+    }
+
+    if (result == Result::Success)
+    {
+        CmdAllocatorCreateInfo createInfo = {};
+        createInfo.flags.threadSafe      = 1;
+        createInfo.flags.autoMemoryReuse = 1;
+
+        for (uint32 allocType = 0; allocType < CmdAllocatorTypeCount; allocType++)
+        {
+            createInfo.allocInfo[allocType].allocHeap    = (allocType == GpuScratchMemAlloc) ? GpuHeapInvisible
+                                                                                               : GpuHeapGartUswc;
+            createInfo.allocInfo[allocType].allocSize    = CmdAllocSize;
+            createInfo.allocInfo[allocType].suballocSize = CmdSuballocSize;
+        }
+
+        void* pMemory = PAL_MALLOC(m_pDevice->GetCmdAllocatorSize(createInfo, &result), m_pPlatform, AllocInternal);
+
+        if (result != Result::Success)
+        {
+            PAL_SAFE_FREE(pMemory, m_pPlatform);
+        }
+        else if (pMemory == nullptr)
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+        else
+        {
+            result = m_pDevice->CreateCmdAllocator(createInfo, pMemory, &m_pCmdAllocator);
+
+            if (result != Result::Success)
+            {
+                PAL_FREE(pMemory, m_pPlatform);
+            }
+        }
+    }
+
+    if ((result == Result::Success) && hasUniversalEngine)
+    {
+        QueueCreateInfo createInfo = {};
+        createInfo.queueType  = QueueTypeUniversal;
+        createInfo.engineType = EngineTypeUniversal;
+
+        void* pMemory = PAL_MALLOC(m_pDevice->GetQueueSize(createInfo, &result), m_pPlatform, AllocInternal);
+
+        if (result != Result::Success)
+        {
+            PAL_SAFE_FREE(pMemory, m_pPlatform);
+        }
+        else if (pMemory == nullptr)
+        {
+            result = Result::ErrorOutOfMemory;
+        }
+        else
+        {
+            result = m_pDevice->CreateQueue(createInfo, pMemory, &m_pQueue);
+
+            if (result != Result::Success)
+            {
+                PAL_FREE(pMemory, m_pPlatform);
+            }
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result TestDevice::CreateCmdBuffer(
+    QueueType    queueType,
+    EngineType   engineType,
+    ICmdBuffer** ppCmdBuffer)
+{
+    CmdBufferCreateInfo createInfo = {};
+    createInfo.pCmdAllocator = m_pCmdAllocator;
+    createInfo.queueType     = queueType;
+    createInfo.engineType    = engineType;
+
+    Result     result  = Result::Success;
+    void*      pMemory = PAL_MALLOC(m_pDevice->GetCmdBufferSize(createInfo, &result), m_pPlatform, AllocInternal);
+
+    if (result != Result::Success)
+    {
+        PAL_SAFE_FREE(pMemory, m_pPlatform);
+    }
+    else if (pMemory == nullptr)
+    {
+        result = Result::ErrorOutOfMemory;
+    }
+    else
+    {
+        result = m_pDevice->CreateCmdBuffer(createInfo, pMemory, ppCmdBuffer);
+
+        if (result != Result::Success)
+        {
+            PAL_FREE(pMemory, m_pPlatform);
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result TestDevice::CreateFence(
+    bool     signaled,
+    IFence** ppFence)
+{
+    FenceCreateInfo createInfo = {};
+    createInfo.flags.signaled = signaled;
+
+    Result     result  = Result::ErrorOutOfMemory;
+    void*const pMemory = PAL_MALLOC(m_pDevice->GetFenceSize(nullptr), m_pPlatform, AllocInternal);
+
+    if (pMemory != nullptr)
+    {
+        result = m_pDevice->CreateFence(createInfo, pMemory, ppFence);
+
+        if (result != Result::Success)
+        {
+            PAL_FREE(pMemory, m_pPlatform);
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+Result TestDevice::CreateGpuMemory(
+    gpusize      size,
+    GpuHeap      heap,
+    IGpuMemory** ppGpuMemory)
+{
+    GpuMemoryCreateInfo createInfo = {};
+    createInfo.size      = size;
+    createInfo.vaRange   = VaRange::Default;
+    createInfo.priority  = GpuMemPriority::Normal;
+    createInfo.heapCount = 1;
+    createInfo.heaps[0]  = heap;
+
+    Result     result  = Result::Success;
+    void*      pMemory = PAL_MALLOC(m_pDevice->GetGpuMemorySize(createInfo, &result), m_pPlatform, AllocInternal);
+
+    if (result != Result::Success)
+    {
+        PAL_SAFE_FREE(pMemory, m_pPlatform);
+    }
+    else if (pMemory == nullptr)
+    {
+        result = Result::ErrorOutOfMemory;
+    }
+    else
+    {
+        result = m_pDevice->CreateGpuMemory(createInfo, pMemory, ppGpuMemory);
+
+        if (result != Result::Success)
+        {
+            PAL_FREE(pMemory, m_pPlatform);
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+void TestDevice::DestroyObject(
+    IDestroyable* pObject)
+{
+    // Core objects are constructed at the start of the memory which was given to them, so the object pointer is also
+    // the allocation.
+    pObject->Destroy();
+    PAL_FREE(pObject, m_pPlatform);
+}
+
+// =====================================================================================================================
+Result TestDevice::Submit(
+    ICmdBuffer* pCmdBuffer,
+    IFence*     pFence)
+{
+    PerSubQueueSubmitInfo perSubQueueInfo = {};
+    perSubQueueInfo.cmdBufferCount = 1;
+    perSubQueueInfo.ppCmdBuffers   = &pCmdBuffer;
+
+    MultiSubmitInfo submitInfo = {};
+    submitInfo.pPerSubQueueInfo     = &perSubQueueInfo;
+    submitInfo.perSubQueueInfoCount = 1;
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 568
+    submitInfo.fenceCount           = (pFence != nullptr) ? 1 : 0;
+    submitInfo.ppFences             = &pFence;
+#else
+    submitInfo.pFence               = pFence;
+#endif
+
+    return m_pQueue->Submit(submitInfo);
+}
+
+// =====================================================================================================================
+uint32 TestDevice::ReadCmdStream(
+    const ICmdBuffer& cmdBuffer,
+    uint32            streamIdx,
+    uint32*           pDwords,
+    uint32            maxDwords)
+{
+    const CmdStream*const pCmdStream = static_cast<const CmdBuffer&>(cmdBuffer).GetCmdStream(streamIdx);
+
+    uint32 numDwords = 0;
+
+    for (auto iter = pCmdStream->GetFwdIterator(); iter.IsValid(); iter.Next())
+    {
+        const CmdStreamChunk*const pChunk      = iter.Get();
+        const uint32               chunkDwords = pChunk->DwordsAllocated();
+
+        if (numDwords < maxDwords)
+        {
+            memcpy(pDwords + numDwords,
+                   pChunk->WriteAddr(),
+                   sizeof(uint32) * Min(chunkDwords, maxDwords - numDwords));
+        }
+
+        numDwords += chunkDwords;
+    }
+
+    return numDwords;
+}
+
+} // PalTest
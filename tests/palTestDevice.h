@@ -0,0 +1,95 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "palTest.h"
+#include "core/cmdBuffer.h"
+#include "core/device.h"
+#include "core/platform.h"
+
+namespace PalTest
+{
+
+// Pass to TestDevice::Init() to open the first device reported by the OS instead of a null device. In builds with
+// PAL_BUILD_FAKE_DRM this is the fake DRM device.
+constexpr Pal::NullGpuId FirstRealGpu = Pal::NullGpuId::Max;
+
+// =====================================================================================================================
+// Owns a core PAL platform and its first device, plus the queue, command allocator and objects a test creates on it.
+//
+// The platform is created without any of the layers, so every object handed out is a core object which tests may cast
+// to its internal type (e.g., to read back the PM4 a command buffer recorded). Null devices have no engines, so they
+// get no queue; command buffers can still be recorded on them.
+class TestDevice
+{
+public:
+    TestDevice();
+    ~TestDevice();
+
+    // Creates the platform and commits the device's settings. Tests may override settings before calling Finalize().
+    Util::Result Init(Pal::NullGpuId nullGpuId);
+
+    // Finalizes the device and creates the command allocator, plus a universal queue on real devices.
+    Util::Result Finalize();
+
+    Pal::Platform*      GetPlatform()     const { return m_pPlatform; }
+    Pal::Device*        GetDevice()       const { return m_pDevice; }
+    Pal::IQueue*        GetQueue()        const { return m_pQueue; }
+    Pal::ICmdAllocator* GetCmdAllocator() const { return m_pCmdAllocator; }
+
+    Util::Result CreateCmdBuffer(Pal::QueueType queueType, Pal::EngineType engineType, Pal::ICmdBuffer** ppCmdBuffer);
+    Util::Result CreateFence(bool signaled, Pal::IFence** ppFence);
+
+    // Creates GPU memory in a single heap. Null devices back all GPU memory with system memory, so it can always be
+    // mapped there.
+    Util::Result CreateGpuMemory(Pal::gpusize size, Pal::GpuHeap heap, Pal::IGpuMemory** ppGpuMemory);
+
+    // Destroys an object created by this TestDevice and frees its memory.
+    void DestroyObject(Pal::IDestroyable* pObject);
+
+    // Submits one command buffer to the queue, signaling the fence (if any) when it completes.
+    Util::Result Submit(Pal::ICmdBuffer* pCmdBuffer, Pal::IFence* pFence);
+
+    // Copies the DWORDs recorded in one of a command buffer's streams into pDwords, stopping at maxDwords. Returns the
+    // number of DWORDs the stream holds, which may be larger than maxDwords.
+    static Util::uint32 ReadCmdStream(
+        const Pal::ICmdBuffer& cmdBuffer,
+        Util::uint32           streamIdx,
+        Util::uint32*          pDwords,
+        Util::uint32           maxDwords);
+
+private:
+    void*               m_pPlatformMem;
+    Pal::Platform*      m_pPlatform;
+    Pal::Device*        m_pDevice;
+    bool                m_deviceInitialized;
+    Pal::IQueue*        m_pQueue;
+    Pal::ICmdAllocator* m_pCmdAllocator;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(TestDevice);
+};
+
+} // PalTest
@@ -0,0 +1,161 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palTestPipeline.h"
+#include "palDbgPrint.h"
+#include "palInlineFuncs.h"
+#include "palPipelineAbiProcessorImpl.h"
+
+using namespace Util;
+using namespace Util::Abi;
+
+namespace PalTest
+{
+
+// Symbol names are generated as "<prefix><index>".
+static constexpr uint32 MaxSymbolNameLength = 64;
+
+// =====================================================================================================================
+void* BuildPipelineElf(
+    GenericAllocator* pAllocator,
+    const void*       pCode,
+    size_t            codeSize,
+    uint32            numGenericSymbols,
+    size_t*           pElfSize)
+{
+    void*                                  pElf = nullptr;
+    PipelineAbiProcessor<GenericAllocator> processor(pAllocator);
+
+    Result result = processor.Init();
+
+    if (result == Result::Success)
+    {
+        processor.SetGfxIpVersion(9, 0, 0);
+        result = processor.SetPipelineCode(pCode, codeSize);
+    }
+
+    if (result == Result::Success)
+    {
+        result = processor.AddPipelineSymbolEntry({ PipelineSymbolType::CsMainEntry,
+                                                    Elf::SymbolTableEntryType::Func,
+                                                    AbiSectionType::Code,
+                                                    0,
+                                                    codeSize });
+    }
+
+    for (uint32 i = 0; (result == Result::Success) && (i < numGenericSymbols); i++)
+    {
+        char name[MaxSymbolNameLength];
+        Snprintf(name, sizeof(name), "_amdgpu_cs_library_func_%u", i);
+
+        result = processor.AddGenericSymbolEntry({ name,
+                                                   Elf::SymbolTableEntryType::Func,
+                                                   AbiSectionType::Code,
+                                                   i,
+                                                   4 });
+    }
+
+    MsgPackWriter metadataWriter(pAllocator);
+    if (result == Result::Success)
+    {
+        result = processor.Finalize(metadataWriter);
+    }
+
+    if (result == Result::Success)
+    {
+        *pElfSize = processor.GetRequiredBufferSizeBytes();
+        pElf      = PAL_MALLOC(*pElfSize, pAllocator, AllocInternal);
+
+        if (pElf != nullptr)
+        {
+            processor.SaveToBuffer(pElf);
+        }
+    }
+
+    return pElf;
+}
+
+// =====================================================================================================================
+void GenerateShaderCode(
+    uint32  seed,
+    uint32* pCode,
+    uint32  numDwords)
+{
+    // Real shaders use a handful of opcodes far more often than the rest, work on a small window of registers at a
+    // time and repeat short instruction sequences (unrolled loops, the same math on each channel). That is most of
+    // what makes them compressible, so the generated code does the same.
+    constexpr uint32 NumCommonOpcodes = 8;
+    constexpr uint32 NumOpcodes       = 48;
+    constexpr uint32 RegWindow        = 8;
+    constexpr uint32 MaxRepeatLength  = 8;
+    constexpr uint32 MaxRepeatOffset  = 64;
+
+    uint32 state   = (seed * 2654435761u) | 1;
+    uint32 regBase = 0;
+    uint32 i       = 0;
+
+    while (i < numDwords)
+    {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        if (((state & 0x3) == 0) && (i >= MaxRepeatOffset))
+        {
+            // Repeat a recent run of instructions.
+            const uint32 offset = 1 + ((state >> 2) % MaxRepeatOffset);
+            const uint32 length = Min(1 + ((state >> 8) % MaxRepeatLength), numDwords - i);
+
+            for (uint32 j = 0; j < length; j++, i++)
+            {
+                pCode[i] = pCode[i - offset];
+            }
+        }
+        else
+        {
+            const uint32 opcode = ((state & 0x30) != 0) ? ((state >> 8) % NumCommonOpcodes)
+                                                        : ((state >> 8) % NumOpcodes);
+            const uint32 vdst   = regBase + ((state >> 16) % RegWindow);
+            const uint32 src0   = regBase + ((state >> 20) % RegWindow);
+
+            pCode[i++] = 0xD0000000 | (opcode << 17) | ((vdst & 0xFF) << 8) | (src0 & 0xFF);
+
+            // Every so often an instruction carries a literal constant.
+            if (((state & 0x1F0) == 0) && (i < numDwords))
+            {
+                pCode[i++] = state & 0xFFFF;
+            }
+        }
+
+        // Move the register window now and then.
+        if ((state & 0x3F00000) == 0)
+        {
+            regBase = (regBase + RegWindow) % 128;
+        }
+    }
+}
+
+} // PalTest
@@ -0,0 +1,51 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#pragma once
+
+#include "palTest.h"
+#include "palSysMemory.h"
+
+namespace PalTest
+{
+
+// Builds a pipeline ELF holding pCode as its code section, with a compute entry point covering all of it, plus
+// numGenericSymbols generic symbols named "_amdgpu_cs_library_func_<index>" whose value is their index. On success the
+// caller owns the returned buffer and must free it with PAL_FREE.
+extern void* BuildPipelineElf(
+    Util::GenericAllocator* pAllocator,
+    const void*             pCode,
+    size_t                  codeSize,
+    Util::uint32            numGenericSymbols,
+    size_t*                 pElfSize);
+
+// Fills pCode with a deterministic stream of instruction-like DWORDs which resembles compiled shader code: a few dozen
+// opcodes with varying register fields, plus the occasional literal constant. Different seeds give different streams.
+extern void GenerateShaderCode(
+    Util::uint32  seed,
+    Util::uint32* pCode,
+    Util::uint32  numDwords);
+
+} // PalTest
@@ -0,0 +1,262 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palTest.h"
+#include "palBuddyAllocatorImpl.h"
+#include "palSysMemory.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Util;
+
+namespace BuddyAllocatorTest
+{
+
+// Matches the internal memory manager's pools.
+constexpr gpusize PoolSize     = 1ull << 22;
+constexpr gpusize MinAllocSize = 1ull << 4;
+
+// =====================================================================================================================
+// Forwards to the generic allocator, keeping a running total of the system memory requested.
+class CountingAllocator
+{
+public:
+    CountingAllocator() : m_bytesAllocated(0) { }
+
+    void* Alloc(const AllocInfo& allocInfo)
+    {
+        m_bytesAllocated += allocInfo.bytes;
+        return m_allocator.Alloc(allocInfo);
+    }
+
+    void Free(const FreeInfo& freeInfo) { m_allocator.Free(freeInfo); }
+
+    size_t BytesAllocated() const { return m_bytesAllocated; }
+
+private:
+    GenericAllocator m_allocator;
+    size_t           m_bytesAllocated;
+};
+
+typedef BuddyAllocator<CountingAllocator> TestBuddyAllocator;
+
+// =====================================================================================================================
+// xorshift32; the tests only need a cheap, repeatable sequence.
+static uint32 NextRandom(
+    uint32* pState)
+{
+    uint32 x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+
+    return x;
+}
+
+// Picks a request size the way internal allocations are spread: mostly small, occasionally up to half a pool.
+static gpusize RandomSize(
+    uint32* pRng)
+{
+    const gpusize base = 1ull << (NextRandom(pRng) % 16);
+    return Min(base + (NextRandom(pRng) % base), PoolSize / 2);
+}
+
+struct LiveBlock
+{
+    gpusize offset;
+    gpusize size;   // Padded to the block size the allocator hands out.
+};
+
+// =====================================================================================================================
+// Random allocate/free churn on one pool. Every block must be aligned to its padded size and must not overlap any other
+// live block; once everything is freed the pool must be empty and able to hand out both halves again.
+PAL_TEST(BuddyAllocatorNeverOverlaps)
+{
+    constexpr uint32 MaxLive      = 4096;
+    constexpr uint32 NumOps       = 100000;
+    constexpr uint32 NumMinBlocks = static_cast<uint32>(PoolSize / MinAllocSize);
+
+    CountingAllocator  allocator;
+    TestBuddyAllocator buddy(&allocator, PoolSize, MinAllocSize);
+
+    uint8*const     pOwned = static_cast<uint8*>(calloc(NumMinBlocks, 1));
+    LiveBlock*const pLive  = static_cast<LiveBlock*>(malloc(sizeof(LiveBlock) * MaxLive));
+
+    if (PAL_EXPECT(pOwned != nullptr) && PAL_EXPECT(pLive != nullptr) && PAL_EXPECT_RESULT(buddy.Init()))
+    {
+        uint32 numLive = 0;
+        uint32 rng     = 0x5eed;
+        bool   ok      = true;
+
+        for (uint32 op = 0; ok && (op < NumOps); op++)
+        {
+            if ((numLive < MaxLive) && ((numLive == 0) || ((NextRandom(&rng) % 100) < 52)))
+            {
+                const gpusize size   = RandomSize(&rng);
+                gpusize       offset = 0;
+
+                // Running out of space is fine; the pool is meant to fill up under this load.
+                if (buddy.Allocate(size, 0, &offset) == Result::Success)
+                {
+                    const gpusize padded = Pow2Pad(Max(size, MinAllocSize));
+
+                    ok = PAL_EXPECT(IsPow2Aligned(offset, padded)) && PAL_EXPECT((offset + padded) <= PoolSize);
+
+                    for (gpusize idx = offset / MinAllocSize; ok && (idx < (offset + padded) / MinAllocSize); idx++)
+                    {
+                        ok = PAL_EXPECT_EQ(pOwned[idx], 0);
+                        pOwned[idx] = 1;
+                    }
+
+                    pLive[numLive++] = { offset, padded };
+                }
+            }
+            else
+            {
+                const uint32    idx   = NextRandom(&rng) % numLive;
+                const LiveBlock block = pLive[idx];
+                pLive[idx] = pLive[--numLive];
+
+                memset(pOwned + (block.offset / MinAllocSize), 0, static_cast<size_t>(block.size / MinAllocSize));
+
+                // Alternate between letting the allocator find the block size and telling it.
+                buddy.Free(block.offset, ((op % 2) == 0) ? 0 : block.size);
+            }
+        }
+
+        while (numLive > 0)
+        {
+            buddy.Free(pLive[--numLive].offset);
+        }
+
+        PAL_EXPECT(buddy.IsEmpty());
+
+        // Only a fully coalesced pool can hand out both halves, after which it has nothing left.
+        gpusize offsets[3] = {};
+        PAL_EXPECT_RESULT(buddy.Allocate(PoolSize / 2, 0, &offsets[0]));
+        PAL_EXPECT_RESULT(buddy.Allocate(PoolSize / 2, 0, &offsets[1]));
+        PAL_EXPECT_EQ(buddy.Allocate(MinAllocSize, 0, &offsets[2]), Result::ErrorOutOfGpuMemory);
+    }
+
+    free(pLive);
+    free(pOwned);
+}
+
+// =====================================================================================================================
+// The bitmaps of the smallest block sizes dominate the allocator's footprint, so they must only be allocated once a
+// block that small is actually requested.
+PAL_TEST(BuddyAllocatorBitmapsAreLazy)
+{
+    CountingAllocator  allocator;
+    TestBuddyAllocator buddy(&allocator, PoolSize, MinAllocSize);
+
+    if (PAL_EXPECT_RESULT(buddy.Init()))
+    {
+        PAL_EXPECT(allocator.BytesAllocated() < 1024);
+
+        // Splitting down to 256 bytes needs the bitmaps of the 256 byte to 1MB levels, which is 8KB in total.
+        gpusize offset = 0;
+        PAL_EXPECT_RESULT(buddy.Allocate(256, 0, &offset));
+        PAL_EXPECT(allocator.BytesAllocated() < (16 * 1024));
+
+        // A 16 byte block has 2^18 buddies, so its level alone needs 64KB.
+        PAL_EXPECT_RESULT(buddy.Allocate(MinAllocSize, 0, &offset));
+        PAL_EXPECT(allocator.BytesAllocated() >= (64 * 1024));
+    }
+}
+
+// =====================================================================================================================
+// Measures allocate/free throughput on a pool kept about half full, and reports how much system memory one pool uses
+// for its bitmaps depending on the smallest block actually requested.
+PAL_BENCHMARK(BuddyAllocatorChurn)
+{
+    constexpr uint32 MaxLive = 4096;
+
+    CountingAllocator  allocator;
+    TestBuddyAllocator buddy(&allocator, PoolSize, MinAllocSize);
+
+    LiveBlock*const pLive = static_cast<LiveBlock*>(malloc(sizeof(LiveBlock) * MaxLive));
+
+    if (PAL_EXPECT(pLive != nullptr) && PAL_EXPECT_RESULT(buddy.Init()))
+    {
+        const uint32 numOps  = PalTest::Iterations(2000000);
+        uint32       numLive = 0;
+        uint32       rng     = 0x5eed;
+        const uint64 startNs = PalTest::NowNs();
+
+        for (uint32 op = 0; op < numOps; op++)
+        {
+            if ((numLive < MaxLive) && ((numLive == 0) || ((NextRandom(&rng) % 100) < 52)))
+            {
+                const gpusize size   = RandomSize(&rng);
+                gpusize       offset = 0;
+
+                if (buddy.Allocate(size, 0, &offset) == Result::Success)
+                {
+                    pLive[numLive++] = { offset, size };
+                }
+            }
+            else
+            {
+                const uint32 idx = NextRandom(&rng) % numLive;
+                buddy.Free(pLive[idx].offset);
+                pLive[idx] = pLive[--numLive];
+            }
+        }
+
+        const uint64 elapsedNs = Max<uint64>(PalTest::NowNs() - startNs, 1);
+
+        PalTest::ReportMetric("BuddyAllocatorChurn op", static_cast<double>(elapsedNs) / numOps, "ns");
+
+        while (numLive > 0)
+        {
+            buddy.Free(pLive[--numLive].offset);
+        }
+    }
+
+    free(pLive);
+
+    // A pool which only ever serves 256 byte or larger blocks, then one which has served a 16 byte block.
+    for (gpusize smallest = 256; smallest >= MinAllocSize; smallest /= 16)
+    {
+        CountingAllocator  poolAllocator;
+        TestBuddyAllocator pool(&poolAllocator, PoolSize, MinAllocSize);
+        gpusize            offset = 0;
+
+        if (PAL_EXPECT_RESULT(pool.Init()) && PAL_EXPECT_RESULT(pool.Allocate(smallest, 0, &offset)))
+        {
+            char metricName[64];
+            Snprintf(metricName,
+                     sizeof(metricName),
+                     "BuddyAllocatorChurn bitmaps (%u B min)",
+                     static_cast<uint32>(smallest));
+            PalTest::ReportMetric(metricName, poolAllocator.BytesAllocated() / 1024.0, "KiB");
+        }
+    }
+}
+
+} // BuddyAllocatorTest
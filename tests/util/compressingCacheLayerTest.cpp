@@ -0,0 +1,436 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palTestPipeline.h"
+#include "palCacheLayer.h"
+#include "palDbgPrint.h"
+#include "palInlineFuncs.h"
+#include "util/compressingCacheLayer.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Util;
+
+namespace CompressingCacheLayerTest
+{
+
+// =====================================================================================================================
+// Owns a memory cache layer and any compressing cache layers linked above it.
+class CacheChain
+{
+public:
+    CacheChain() : m_pMemoryLayer(nullptr), m_numCompressingLayers(0) { }
+
+    ~CacheChain()
+    {
+        for (uint32 i = 0; i < m_numCompressingLayers; i++)
+        {
+            DestroyLayer(m_pCompressingLayers[i]);
+        }
+
+        if (m_pMemoryLayer != nullptr)
+        {
+            DestroyLayer(m_pMemoryLayer);
+        }
+    }
+
+    Result Init()
+    {
+        MemoryCacheCreateInfo createInfo = {};
+        createInfo.maxObjectCount = 64 * 1024;
+        createInfo.maxMemorySize  = 1024 * 1024 * 1024;
+
+        Result     result = Result::ErrorOutOfMemory;
+        void*const pMem   = malloc(GetMemoryCacheLayerSize(&createInfo));
+
+        if (pMem != nullptr)
+        {
+            result = CreateMemoryCacheLayer(&createInfo, pMem, &m_pMemoryLayer);
+
+            if (result != Result::Success)
+            {
+                free(pMem);
+            }
+        }
+
+        return result;
+    }
+
+    // Links a new compressing cache layer above the memory layer. Every compressing layer shares the memory layer, so a
+    // second one sees the data the way a later process would see data in a shared cache.
+    Result AddCompressingLayer(CacheCompressionCodec codec, ICacheLayer** ppLayer)
+    {
+        CompressingCacheCreateInfo createInfo = {};
+        createInfo.codec = codec;
+
+        Result     result = Result::ErrorOutOfMemory;
+        void*const pMem   = (m_numCompressingLayers < MaxCompressingLayers)
+                            ? malloc(GetCompressingCacheLayerSize(&createInfo))
+                            : nullptr;
+
+        if (pMem != nullptr)
+        {
+            result = CreateCompressingCacheLayer(&createInfo, pMem, ppLayer);
+
+            if (result == Result::Success)
+            {
+                result = (*ppLayer)->Link(m_pMemoryLayer);
+                m_pCompressingLayers[m_numCompressingLayers++] = *ppLayer;
+            }
+            else
+            {
+                free(pMem);
+            }
+        }
+
+        return result;
+    }
+
+    ICacheLayer* MemoryLayer() const { return m_pMemoryLayer; }
+
+private:
+    static constexpr uint32 MaxCompressingLayers = 2;
+
+    // Cache layers are constructed at the start of the memory they were given.
+    static void DestroyLayer(ICacheLayer* pLayer)
+    {
+        pLayer->Destroy();
+        free(pLayer);
+    }
+
+    ICacheLayer* m_pMemoryLayer;
+    ICacheLayer* m_pCompressingLayers[MaxCompressingLayers];
+    uint32       m_numCompressingLayers;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(CacheChain);
+};
+
+// =====================================================================================================================
+static Hash128 EntryHash(
+    uint32 index)
+{
+    Hash128 hash = {};
+    hash.dwords[0] = index + 1;
+    hash.dwords[3] = 0xC0DEC0DE;
+
+    return hash;
+}
+
+// =====================================================================================================================
+// Queries and loads an entry through pLayer and checks it matches the data originally stored.
+static void ExpectEntry(
+    ICacheLayer*   pLayer,
+    const Hash128& hash,
+    const void*    pExpected,
+    size_t         expectedSize)
+{
+    QueryResult query = {};
+
+    if (PAL_EXPECT_RESULT(pLayer->Query(&hash, 0, 0, &query)) && PAL_EXPECT_EQ(query.dataSize, expectedSize))
+    {
+        void*const pBuffer = malloc(expectedSize);
+
+        if (PAL_EXPECT(pBuffer != nullptr))
+        {
+            PAL_EXPECT_RESULT(pLayer->Load(&query, pBuffer));
+            PAL_EXPECT(memcmp(pBuffer, pExpected, expectedSize) == 0);
+
+            free(pBuffer);
+        }
+    }
+}
+
+// =====================================================================================================================
+// A corpus entry: a pipeline ELF with seed-dependent code and symbol counts, so entries vary in size and content.
+struct CorpusEntry
+{
+    void*  pData;
+    size_t dataSize;
+};
+
+// =====================================================================================================================
+static bool BuildCorpus(
+    GenericAllocator* pAllocator,
+    CorpusEntry*      pEntries,
+    uint32            numEntries)
+{
+    constexpr uint32 MaxCodeDwords = 16 * 1024;
+
+    uint32*const pCode = static_cast<uint32*>(malloc(sizeof(uint32) * MaxCodeDwords));
+    bool         built = (pCode != nullptr);
+
+    for (uint32 i = 0; built && (i < numEntries); i++)
+    {
+        const uint32 numDwords = 256 << (i % 7);
+
+        PalTest::GenerateShaderCode(i, pCode, numDwords);
+
+        pEntries[i].pData = PalTest::BuildPipelineElf(pAllocator,
+                                                      pCode,
+                                                      sizeof(uint32) * numDwords,
+                                                      (i * 7) % 64,
+                                                      &pEntries[i].dataSize);
+        built = (pEntries[i].pData != nullptr);
+    }
+
+    free(pCode);
+
+    return built;
+}
+
+// =====================================================================================================================
+static void DestroyCorpus(
+    GenericAllocator* pAllocator,
+    CorpusEntry*      pEntries,
+    uint32            numEntries)
+{
+    for (uint32 i = 0; i < numEntries; i++)
+    {
+        PAL_SAFE_FREE(pEntries[i].pData, pAllocator);
+    }
+}
+
+// =====================================================================================================================
+// Data stored through a compressing layer comes back unchanged, including through a second layer which has never seen
+// it, and the storage layer describes it with a tag instead of the compressing layer having to load it.
+PAL_TEST(CompressingCacheRoundTrip)
+{
+    constexpr uint32 NumEntries = 8;
+
+    GenericAllocator allocator;
+    CorpusEntry      corpus[NumEntries] = {};
+    CacheChain       chain;
+    ICacheLayer*     pWriter = nullptr;
+    ICacheLayer*     pReader = nullptr;
+
+    if (PAL_EXPECT(BuildCorpus(&allocator, corpus, NumEntries))                         &&
+        PAL_EXPECT_RESULT(chain.Init())                                                 &&
+        PAL_EXPECT_RESULT(chain.AddCompressingLayer(CacheCompressionCodec::Lz, &pWriter)))
+    {
+        size_t rawBytes = 0;
+
+        for (uint32 i = 0; i < NumEntries; i++)
+        {
+            const Hash128 hash = EntryHash(i);
+
+            PAL_EXPECT_RESULT(pWriter->Store(&hash, corpus[i].pData, corpus[i].dataSize));
+            ExpectEntry(pWriter, hash, corpus[i].pData, corpus[i].dataSize);
+
+            rawBytes += corpus[i].dataSize;
+        }
+
+        // Incompressible data is stored as-is, and a one byte value can't shrink at all.
+        uint8 noise[512];
+        PalTest::GenerateShaderCode(NumEntries, reinterpret_cast<uint32*>(noise), sizeof(noise) / sizeof(uint32));
+        for (uint32 i = 0; i < sizeof(noise); i++)
+        {
+            noise[i] ^= static_cast<uint8>((i * 2654435761u) >> 24);
+        }
+
+        const uint8   oneByte   = 0x5A;
+        const Hash128 noiseHash = EntryHash(NumEntries);
+        const Hash128 byteHash  = EntryHash(NumEntries + 1);
+
+        PAL_EXPECT_RESULT(pWriter->Store(&noiseHash, noise, sizeof(noise)));
+        PAL_EXPECT_RESULT(pWriter->Store(&byteHash, &oneByte, sizeof(oneByte)));
+
+        rawBytes += sizeof(noise) + sizeof(oneByte);
+
+        // The storage layer keeps the tag the compressing layer attached, which records the codec and original size.
+        QueryResult storedQuery = {};
+        const Hash128 firstHash = EntryHash(0);
+        if (PAL_EXPECT_RESULT(chain.MemoryLayer()->Query(&firstHash, 0, 0, &storedQuery)))
+        {
+            PAL_EXPECT(storedQuery.dataSize < corpus[0].dataSize);
+            PAL_EXPECT_EQ(storedQuery.tag.dataType, CompressedCacheDataType | uint32(CacheCompressionCodec::Lz));
+            PAL_EXPECT_EQ(storedQuery.tag.metaValue, corpus[0].dataSize);
+        }
+
+        CacheLayerStats memoryStats = {};
+        PAL_EXPECT_RESULT(chain.MemoryLayer()->GetStats(&memoryStats));
+        PAL_EXPECT(memoryStats.bytesStored < rawBytes);
+
+        // A fresh compressing layer learns each entry's size from its tag, without loading any data on query.
+        if (PAL_EXPECT_RESULT(chain.AddCompressingLayer(CacheCompressionCodec::None, &pReader)))
+        {
+            for (uint32 i = 0; i < NumEntries; i++)
+            {
+                const Hash128 hash       = EntryHash(i);
+                QueryResult   query      = {};
+                const uint64  loadsStart = memoryStats.loadCount;
+
+                PAL_EXPECT_RESULT(pReader->Query(&hash, 0, 0, &query));
+                PAL_EXPECT_EQ(query.dataSize, corpus[i].dataSize);
+
+                PAL_EXPECT_RESULT(chain.MemoryLayer()->GetStats(&memoryStats));
+                PAL_EXPECT_EQ(memoryStats.loadCount, loadsStart);
+
+                ExpectEntry(pReader, hash, corpus[i].pData, corpus[i].dataSize);
+                PAL_EXPECT_RESULT(chain.MemoryLayer()->GetStats(&memoryStats));
+            }
+
+            ExpectEntry(pReader, noiseHash, noise, sizeof(noise));
+            ExpectEntry(pReader, byteHash, &oneByte, sizeof(oneByte));
+        }
+    }
+
+    DestroyCorpus(&allocator, corpus, NumEntries);
+}
+
+// =====================================================================================================================
+// Data which was not stored through a compressing layer is returned as it is, even if it looks like an encoded entry.
+PAL_TEST(CompressingCacheLeavesRawDataAlone)
+{
+    CacheChain   chain;
+    ICacheLayer* pLayer = nullptr;
+
+    if (PAL_EXPECT_RESULT(chain.Init()) &&
+        PAL_EXPECT_RESULT(chain.AddCompressingLayer(CacheCompressionCodec::Lz, &pLayer)))
+    {
+        ICacheLayer*const pStorage = chain.MemoryLayer();
+
+        // Starts with the magic, but the rest isn't a valid entry.
+        uint8 magicOnly[64] = {};
+        const uint32 magic = CompressingCacheLayer::EntryMagic;
+        memcpy(magicOnly, &magic, sizeof(magic));
+        memset(magicOnly + sizeof(magic), 0x77, sizeof(magicOnly) - sizeof(magic));
+
+        // A complete, valid looking uncompressed entry, stored with a tag that says what it really is.
+        struct
+        {
+            CompressingCacheLayer::EntryHeader header;
+            uint8                              payload[48];
+        } lookalike = {};
+
+        lookalike.header.magic    = CompressingCacheLayer::EntryMagic;
+        lookalike.header.codec    = uint32(CacheCompressionCodec::None);
+        lookalike.header.dataSize = sizeof(lookalike.payload);
+        memset(lookalike.payload, 0x42, sizeof(lookalike.payload));
+
+        const CacheEntryTag rawTag = { 0x12345678, 0 };
+
+        const Hash128 magicHash     = EntryHash(0);
+        const Hash128 lookalikeHash = EntryHash(1);
+
+        PAL_EXPECT_RESULT(pStorage->Store(&magicHash, magicOnly, sizeof(magicOnly)));
+        PAL_EXPECT_RESULT(pStorage->StoreTagged(&lookalikeHash, &lookalike, sizeof(lookalike), rawTag));
+
+        ExpectEntry(pLayer, magicHash, magicOnly, sizeof(magicOnly));
+        ExpectEntry(pLayer, lookalikeHash, &lookalike, sizeof(lookalike));
+    }
+}
+
+// =====================================================================================================================
+// Measures the compression ratio on a corpus of pipeline ELFs, and how long storing and loading the corpus takes with
+// and without compression.
+PAL_BENCHMARK(CompressingCacheCorpus)
+{
+    constexpr uint32 NumEntries = 64;
+
+    const CacheCompressionCodec Codecs[]     = { CacheCompressionCodec::None, CacheCompressionCodec::Lz };
+    const char* const           CodecNames[] = { "none", "lz" };
+
+    GenericAllocator allocator;
+    CorpusEntry      corpus[NumEntries] = {};
+
+    size_t rawBytes    = 0;
+    size_t maxDataSize = 0;
+
+    if (PAL_EXPECT(BuildCorpus(&allocator, corpus, NumEntries)))
+    {
+        for (uint32 i = 0; i < NumEntries; i++)
+        {
+            rawBytes   += corpus[i].dataSize;
+            maxDataSize = Max(maxDataSize, corpus[i].dataSize);
+        }
+
+        PalTest::ReportMetric("corpus size", static_cast<double>(rawBytes) / 1024.0, "KiB");
+    }
+
+    void*const pBuffer = malloc(maxDataSize);
+
+    for (uint32 codecIdx = 0; (pBuffer != nullptr) && (codecIdx < sizeof(Codecs) / sizeof(Codecs[0])); codecIdx++)
+    {
+        CacheChain   chain;
+        ICacheLayer* pLayer = nullptr;
+
+        if (PAL_EXPECT_RESULT(chain.Init()) && PAL_EXPECT_RESULT(chain.AddCompressingLayer(Codecs[codecIdx], &pLayer)))
+        {
+            const uint64 storeStartNs = PalTest::NowNs();
+
+            for (uint32 i = 0; i < NumEntries; i++)
+            {
+                const Hash128 hash = EntryHash(i);
+                PAL_EXPECT_RESULT(pLayer->Store(&hash, corpus[i].pData, corpus[i].dataSize));
+            }
+
+            const uint64 storeNs = PalTest::NowNs() - storeStartNs;
+
+            CacheLayerStats memoryStats = {};
+            PAL_EXPECT_RESULT(chain.MemoryLayer()->GetStats(&memoryStats));
+
+            const uint32 iterations  = PalTest::Iterations(500);
+            uint32       loaded      = 0;
+            const uint64 loadStartNs = PalTest::NowNs();
+
+            for (uint32 iter = 0; iter < iterations; iter++)
+            {
+                for (uint32 i = 0; i < NumEntries; i++)
+                {
+                    const Hash128 hash  = EntryHash(i);
+                    QueryResult   query = {};
+
+                    if ((pLayer->Query(&hash, 0, 0, &query) == Result::Success) &&
+                        (pLayer->Load(&query, pBuffer) == Result::Success))
+                    {
+                        loaded++;
+                    }
+                }
+            }
+
+            const uint64 loadNs = PalTest::NowNs() - loadStartNs;
+
+            PAL_EXPECT_EQ(loaded, iterations * NumEntries);
+
+            char metricName[64];
+
+            Snprintf(metricName, sizeof(metricName), "%s: compression ratio", CodecNames[codecIdx]);
+            PalTest::ReportMetric(metricName, static_cast<double>(rawBytes) / memoryStats.bytesStored, ":1");
+
+            Snprintf(metricName, sizeof(metricName), "%s: store throughput", CodecNames[codecIdx]);
+            PalTest::ReportMetric(metricName, (rawBytes / (1024.0 * 1024.0)) / (storeNs * 1e-9), "MiB/s");
+
+            Snprintf(metricName, sizeof(metricName), "%s: query + load latency", CodecNames[codecIdx]);
+            PalTest::ReportMetric(metricName, static_cast<double>(loadNs) / (iterations * NumEntries * 1000.0), "us");
+        }
+    }
+
+    free(pBuffer);
+
+    DestroyCorpus(&allocator, corpus, NumEntries);
+}
+
+} // CompressingCacheLayerTest
@@ -0,0 +1,188 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palTestPipeline.h"
+#include "palDbgPrint.h"
+#include "palPipelineAbiReader.h"
+
+#include <cstdio>
+
+using namespace Util;
+using namespace Util::Abi;
+
+namespace PipelineAbiReaderTest
+{
+
+// Symbol names are generated as "<prefix><index>", which also gives the symbol its value so lookups can be checked.
+static constexpr uint32 MaxSymbolNameLength = 64;
+
+// The code section of every ELF built by these tests. Its contents don't matter to the reader.
+static const uint32 ShaderCode[64] = { };
+
+// =====================================================================================================================
+// The classifier in GetSymbolTypeFromName() must agree with a plain scan of PipelineAbiSymbolNameStrings.
+static PipelineSymbolType ScanSymbolTypeFromName(
+    const char* pName)
+{
+    PipelineSymbolType type = PipelineSymbolType::Unknown;
+
+    for (uint32 i = 1; i < static_cast<uint32>(PipelineSymbolType::Count); i++)
+    {
+        if (strcmp(PipelineAbiSymbolNameStrings[i], pName) == 0)
+        {
+            type = static_cast<PipelineSymbolType>(i);
+            break;
+        }
+    }
+
+    return type;
+}
+
+// =====================================================================================================================
+PAL_TEST(SymbolTypeFromNameMatchesNameTable)
+{
+    for (uint32 i = 1; i < static_cast<uint32>(PipelineSymbolType::Count); i++)
+    {
+        PAL_EXPECT_EQ(GetSymbolTypeFromName(PipelineAbiSymbolNameStrings[i]), static_cast<PipelineSymbolType>(i));
+    }
+
+    // Prefixes, suffixes, case changes and names from other ABIs must not be mistaken for pipeline symbols.
+    const char* const NearMisses[] =
+    {
+        "",
+        "unknown",
+        "_amdgpu_cs_mai",
+        "_amdgpu_cs_main_",
+        "_AMDGPU_CS_MAIN",
+        "_amdgpu_xs_main",
+        "_amdgpu_cs_shdr_intrl_tb",
+        "_amdgpu_pipeline_intrl_data0",
+        "amdgpu_ps_amdil",
+        "_amdgpu_cs_library_func_0",
+    };
+
+    for (uint32 i = 0; i < sizeof(NearMisses) / sizeof(NearMisses[0]); i++)
+    {
+        PAL_EXPECT_EQ(GetSymbolTypeFromName(NearMisses[i]), PipelineSymbolType::Unknown);
+        PAL_EXPECT_EQ(GetSymbolTypeFromName(NearMisses[i]), ScanSymbolTypeFromName(NearMisses[i]));
+    }
+}
+
+// =====================================================================================================================
+PAL_TEST(ReaderFindsEveryGenericSymbol)
+{
+    constexpr uint32 NumGenericSymbols = 1000;
+
+    GenericAllocator allocator;
+    size_t           elfSize = 0;
+    void*const       pElf    = PalTest::BuildPipelineElf(&allocator,
+                                                         ShaderCode,
+                                                         sizeof(ShaderCode),
+                                                         NumGenericSymbols,
+                                                         &elfSize);
+
+    if (PAL_EXPECT(pElf != nullptr))
+    {
+        PipelineAbiReader reader(&allocator, pElf);
+        PAL_EXPECT_RESULT(reader.Init());
+
+        PAL_EXPECT(reader.GetPipelineSymbol(PipelineSymbolType::CsMainEntry) != nullptr);
+        PAL_EXPECT(reader.GetPipelineSymbol(PipelineSymbolType::PsMainEntry) == nullptr);
+
+        // Pipeline symbols are classified out of the generic table.
+        PAL_EXPECT(reader.GetGenericSymbol("_amdgpu_cs_main") == nullptr);
+
+        for (uint32 i = 0; i < NumGenericSymbols; i++)
+        {
+            char name[MaxSymbolNameLength];
+            Snprintf(name, sizeof(name), "_amdgpu_cs_library_func_%u", i);
+
+            const Elf::SymbolTableEntry*const pSymbol = reader.GetGenericSymbol(name);
+            if (PAL_EXPECT(pSymbol != nullptr))
+            {
+                PAL_EXPECT_EQ(pSymbol->st_value, i);
+            }
+        }
+
+        PAL_EXPECT(reader.GetGenericSymbol("_amdgpu_cs_library_func_") == nullptr);
+        PAL_EXPECT(reader.GetGenericSymbol("_amdgpu_cs_library_func_1000") == nullptr);
+
+        PAL_FREE(pElf, &allocator);
+    }
+}
+
+// =====================================================================================================================
+// Measures how long it takes to open an ELF and look up every symbol in it, for several library sizes.
+PAL_BENCHMARK(PipelineElfLoad)
+{
+    const uint32 SymbolCounts[] = { 16, 256, 4096 };
+
+    GenericAllocator allocator;
+
+    for (uint32 countIdx = 0; countIdx < sizeof(SymbolCounts) / sizeof(SymbolCounts[0]); countIdx++)
+    {
+        const uint32 numSymbols = SymbolCounts[countIdx];
+        size_t       elfSize    = 0;
+        void*const   pElf       = PalTest::BuildPipelineElf(&allocator,
+                                                            ShaderCode,
+                                                            sizeof(ShaderCode),
+                                                            numSymbols,
+                                                            &elfSize);
+
+        if (PAL_EXPECT(pElf != nullptr))
+        {
+            const uint32 iterations = PalTest::Iterations(256000 / numSymbols);
+            uint32       found      = 0;
+            const uint64 startNs    = PalTest::NowNs();
+
+            for (uint32 iter = 0; iter < iterations; iter++)
+            {
+                PipelineAbiReader reader(&allocator, pElf);
+                if (reader.Init() == Result::Success)
+                {
+                    for (uint32 i = 0; i < numSymbols; i++)
+                    {
+                        char name[MaxSymbolNameLength];
+                        Snprintf(name, sizeof(name), "_amdgpu_cs_library_func_%u", i);
+
+                        found += (reader.GetGenericSymbol(name) != nullptr) ? 1 : 0;
+                    }
+                }
+            }
+
+            const uint64 elapsedNs = PalTest::NowNs() - startNs;
+
+            PAL_EXPECT_EQ(found, iterations * numSymbols);
+
+            char metricName[64];
+            Snprintf(metricName, sizeof(metricName), "load + lookup all, %u symbols", numSymbols);
+            PalTest::ReportMetric(metricName, static_cast<double>(elapsedNs) / (iterations * 1000.0), "us/elf");
+
+            PAL_FREE(pElf, &allocator);
+        }
+    }
+}
+
+} // PipelineAbiReaderTest
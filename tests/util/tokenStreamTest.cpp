@@ -0,0 +1,405 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "palTest.h"
+#include "palTokenStreamImpl.h"
+#include "palSysMemory.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Util;
+
+namespace TokenStreamTest
+{
+
+// The default GpuProfilerTokenAllocatorSize and TokenAllocatorSize.
+constexpr size_t ChunkSize = 64 * 1024;
+
+// =====================================================================================================================
+// Forwards to the generic allocator, keeping track of how many allocations were made and how many bytes were live at
+// the worst point. Each allocation carries its size in a header so that frees can be accounted for.
+class CountingAllocator
+{
+public:
+    CountingAllocator() : m_numAllocs(0), m_liveBytes(0), m_peakBytes(0) { }
+
+    void* Alloc(const AllocInfo& allocInfo)
+    {
+        PAL_ASSERT(allocInfo.alignment <= HeaderSize);
+
+        AllocInfo headerInfo = allocInfo;
+        headerInfo.bytes += HeaderSize;
+
+        void* pMem = m_allocator.Alloc(headerInfo);
+
+        if (pMem != nullptr)
+        {
+            *static_cast<size_t*>(pMem) = allocInfo.bytes;
+            pMem = VoidPtrInc(pMem, HeaderSize);
+
+            m_numAllocs++;
+            m_liveBytes += allocInfo.bytes;
+            m_peakBytes  = Max(m_peakBytes, m_liveBytes);
+        }
+
+        return pMem;
+    }
+
+    void Free(const FreeInfo& freeInfo)
+    {
+        if (freeInfo.pClientMem != nullptr)
+        {
+            FreeInfo headerInfo = freeInfo;
+            headerInfo.pClientMem = VoidPtrDec(freeInfo.pClientMem, HeaderSize);
+
+            m_liveBytes -= *static_cast<const size_t*>(headerInfo.pClientMem);
+            m_allocator.Free(headerInfo);
+        }
+    }
+
+    uint32 NumAllocs() const { return m_numAllocs; }
+    size_t PeakBytes() const { return m_peakBytes; }
+
+private:
+    static constexpr size_t HeaderSize = PAL_DEFAULT_MEM_ALIGN;
+
+    GenericAllocator m_allocator;
+    uint32           m_numAllocs;
+    size_t           m_liveBytes;
+    size_t           m_peakBytes;
+};
+
+typedef TokenChunkPool<CountingAllocator> TestTokenChunkPool;
+typedef TokenStream<CountingAllocator>    TestTokenStream;
+
+// =====================================================================================================================
+// The single buffer the GpuProfiler and GpuDebug layers recorded into before token streams: it doubles and copies
+// everything recorded so far whenever it fills up. Kept as the baseline for the recording benchmark.
+class DoublingTokenBuffer
+{
+public:
+    explicit DoublingTokenBuffer(CountingAllocator* pAllocator)
+        :
+        m_pAllocator(pAllocator),
+        m_pBuffer(PAL_MALLOC(ChunkSize, pAllocator, AllocInternal)),
+        m_size(ChunkSize),
+        m_writeOffset(0),
+        m_bytesCopied(0)
+    {
+    }
+
+    ~DoublingTokenBuffer() { PAL_FREE(m_pBuffer, m_pAllocator); }
+
+    void* Alloc(size_t numBytes, size_t alignment)
+    {
+        const size_t offset = Pow2Align(m_writeOffset, alignment);
+        void*        pSpace = nullptr;
+
+        if ((offset + numBytes) > m_size)
+        {
+            size_t newSize = m_size * 2;
+
+            while ((offset + numBytes) > newSize)
+            {
+                newSize *= 2;
+            }
+
+            void*const pNewBuffer = PAL_MALLOC(newSize, m_pAllocator, AllocInternal);
+
+            if (pNewBuffer != nullptr)
+            {
+                memcpy(pNewBuffer, m_pBuffer, m_writeOffset);
+                PAL_FREE(m_pBuffer, m_pAllocator);
+
+                m_pBuffer      = pNewBuffer;
+                m_size         = newSize;
+                m_bytesCopied += m_writeOffset;
+            }
+        }
+
+        if ((offset + numBytes) <= m_size)
+        {
+            pSpace        = VoidPtrInc(m_pBuffer, offset);
+            m_writeOffset = offset + numBytes;
+        }
+
+        return pSpace;
+    }
+
+    size_t BytesCopied() const { return m_bytesCopied; }
+
+private:
+    CountingAllocator*const m_pAllocator;
+    void*                   m_pBuffer;
+    size_t                  m_size;
+    size_t                  m_writeOffset;
+    size_t                  m_bytesCopied;
+
+    PAL_DISALLOW_COPY_AND_ASSIGN(DoublingTokenBuffer);
+};
+
+// =====================================================================================================================
+// xorshift32; the tests only need a cheap, repeatable sequence.
+static uint32 NextRandom(
+    uint32* pState)
+{
+    uint32 x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+
+    return x;
+}
+
+// Describes one token of a recording: a call's arguments, sized and aligned like the layers' tokens.
+struct TokenDesc
+{
+    size_t size;
+    size_t alignment;
+};
+
+// =====================================================================================================================
+// Mostly small argument structs and the odd array, like an interface call stream.
+static TokenDesc RandomToken(
+    uint32* pRng)
+{
+    const uint32 roll = NextRandom(pRng);
+
+    TokenDesc token = {};
+    token.alignment = size_t(1) << (roll % 4);
+    token.size      = ((roll % 16) == 0) ? (16 * (1 + ((roll >> 8) % 64))) : (4 + ((roll >> 8) % 96));
+
+    return token;
+}
+
+// =====================================================================================================================
+// Fills a token with bytes derived from its index so that a read-back can tell tokens apart.
+static void FillToken(
+    void*  pToken,
+    size_t size,
+    uint32 index)
+{
+    uint8*const pBytes = static_cast<uint8*>(pToken);
+
+    for (size_t idx = 0; idx < size; idx++)
+    {
+        pBytes[idx] = static_cast<uint8>(index + idx);
+    }
+}
+
+// =====================================================================================================================
+static bool TokenMatches(
+    const void* pToken,
+    size_t      size,
+    uint32      index)
+{
+    const uint8*const pBytes = static_cast<const uint8*>(pToken);
+    bool              match  = true;
+
+    for (size_t idx = 0; match && (idx < size); idx++)
+    {
+        match = (pBytes[idx] == static_cast<uint8>(index + idx));
+    }
+
+    return match;
+}
+
+// =====================================================================================================================
+// Records numTokens random tokens from the given seed, then reads them back and checks each one.
+static bool RecordAndVerify(
+    TestTokenStream* pStream,
+    uint32           numTokens,
+    uint32           seed)
+{
+    bool   ok  = true;
+    uint32 rng = seed;
+
+    for (uint32 idx = 0; ok && (idx < numTokens); idx++)
+    {
+        const TokenDesc token  = RandomToken(&rng);
+        void*const      pSpace = pStream->Alloc(token.size, token.alignment);
+
+        ok = PAL_EXPECT(pSpace != nullptr) &&
+             PAL_EXPECT(IsPow2Aligned(reinterpret_cast<uint64>(pSpace), token.alignment));
+
+        if (ok)
+        {
+            FillToken(pSpace, token.size, idx);
+        }
+    }
+
+    rng = seed;
+    pStream->BeginRead();
+
+    for (uint32 idx = 0; ok && (idx < numTokens); idx++)
+    {
+        const TokenDesc token = RandomToken(&rng);
+
+        ok = PAL_EXPECT(pStream->IsReadDone() == false) &&
+             PAL_EXPECT(TokenMatches(pStream->Read(token.size, token.alignment), token.size, idx));
+    }
+
+    return ok && PAL_EXPECT(pStream->IsReadDone());
+}
+
+// =====================================================================================================================
+// Tokens read back in order across chunk boundaries, and re-recording the same amount reuses the stream's chunks, or
+// another stream's once they went back to the pool, without allocating anything.
+PAL_TEST(TokenStreamReusesChunks)
+{
+    constexpr uint32 NumTokens = 100000;
+    constexpr uint32 Seed      = 0x5eed;
+
+    CountingAllocator  allocator;
+    TestTokenChunkPool pool(&allocator, ChunkSize);
+    TestTokenStream    stream(&pool);
+
+    if (RecordAndVerify(&stream, NumTokens, Seed))
+    {
+        const uint32 numAllocs = allocator.NumAllocs();
+        PAL_EXPECT(numAllocs > 1);
+
+        stream.Rewind();
+        RecordAndVerify(&stream, NumTokens, Seed);
+        PAL_EXPECT_EQ(allocator.NumAllocs(), numAllocs);
+
+        stream.Reset();
+
+        TestTokenStream otherStream(&pool);
+        RecordAndVerify(&otherStream, NumTokens, Seed);
+        PAL_EXPECT_EQ(allocator.NumAllocs(), numAllocs);
+    }
+}
+
+// =====================================================================================================================
+// A token larger than a chunk gets a chunk of its own, and the stream carries on in pooled chunks after it.
+PAL_TEST(TokenStreamOversizedToken)
+{
+    constexpr size_t LargeSize = 3 * ChunkSize;
+
+    CountingAllocator  allocator;
+    TestTokenChunkPool pool(&allocator, ChunkSize);
+    TestTokenStream    stream(&pool);
+
+    for (uint32 pass = 0; pass < 2; pass++)
+    {
+        void*const pFirst = stream.Alloc(sizeof(uint32), sizeof(uint32));
+        void*const pLarge = stream.Alloc(LargeSize, PAL_DEFAULT_MEM_ALIGN);
+        void*const pLast  = stream.Alloc(sizeof(uint32), sizeof(uint32));
+
+        if (PAL_EXPECT((pFirst != nullptr) && (pLarge != nullptr) && (pLast != nullptr)))
+        {
+            FillToken(pFirst, sizeof(uint32), 1);
+            FillToken(pLarge, LargeSize,      2);
+            FillToken(pLast,  sizeof(uint32), 3);
+
+            stream.BeginRead();
+            PAL_EXPECT(TokenMatches(stream.Read(sizeof(uint32), sizeof(uint32)),     sizeof(uint32), 1));
+            PAL_EXPECT(TokenMatches(stream.Read(LargeSize, PAL_DEFAULT_MEM_ALIGN), LargeSize,      2));
+            PAL_EXPECT(TokenMatches(stream.Read(sizeof(uint32), sizeof(uint32)),     sizeof(uint32), 3));
+            PAL_EXPECT(stream.IsReadDone());
+        }
+
+        // The oversized chunk is freed by the rewind and the second pass allocates another one.
+        stream.Rewind();
+    }
+}
+
+// =====================================================================================================================
+// Records a series of large command buffers, each into a new token store as the layers do for freshly created command
+// buffers, once into the old doubling buffer and once into token streams sharing one pool. Reports the recording time
+// per call, the bytes the doubling buffer copies per command buffer and the peak memory of each.
+PAL_BENCHMARK(TokenStreamRecording)
+{
+    constexpr uint32 NumCmdBuffers = 8;
+
+    const uint32 numCalls = PalTest::Iterations(200000);
+
+    CountingAllocator doublingAllocator;
+    size_t            bytesCopied = 0;
+    uint64            startNs     = PalTest::NowNs();
+
+    for (uint32 cmdBufIdx = 0; cmdBufIdx < NumCmdBuffers; cmdBufIdx++)
+    {
+        DoublingTokenBuffer buffer(&doublingAllocator);
+        uint32              rng = 0x5eed;
+
+        for (uint32 call = 0; call < numCalls; call++)
+        {
+            const TokenDesc token = RandomToken(&rng);
+            void*const      pArgs = buffer.Alloc(token.size, token.alignment);
+
+            if (pArgs != nullptr)
+            {
+                memset(pArgs, 0, token.size);
+            }
+        }
+
+        bytesCopied += buffer.BytesCopied();
+    }
+
+    const uint64 doublingNs = Max<uint64>(PalTest::NowNs() - startNs, 1);
+
+    CountingAllocator  pooledAllocator;
+    TestTokenChunkPool pool(&pooledAllocator, ChunkSize);
+
+    startNs = PalTest::NowNs();
+
+    for (uint32 cmdBufIdx = 0; cmdBufIdx < NumCmdBuffers; cmdBufIdx++)
+    {
+        TestTokenStream stream(&pool);
+        uint32          rng = 0x5eed;
+
+        for (uint32 call = 0; call < numCalls; call++)
+        {
+            const TokenDesc token = RandomToken(&rng);
+            void*const      pArgs = stream.Alloc(token.size, token.alignment);
+
+            if (pArgs != nullptr)
+            {
+                memset(pArgs, 0, token.size);
+            }
+        }
+    }
+
+    const uint64 pooledNs = Max<uint64>(PalTest::NowNs() - startNs, 1);
+    const double numTotal = static_cast<double>(numCalls) * NumCmdBuffers;
+
+    PalTest::ReportMetric("TokenStreamRecording doubling call", doublingNs / numTotal, "ns");
+    PalTest::ReportMetric("TokenStreamRecording pooled call",   pooledNs / numTotal,   "ns");
+    PalTest::ReportMetric("TokenStreamRecording doubling copied per cmd buffer",
+                          bytesCopied / (NumCmdBuffers * 1024.0 * 1024.0),
+                          "MiB");
+    PalTest::ReportMetric("TokenStreamRecording doubling peak",
+                          doublingAllocator.PeakBytes() / (1024.0 * 1024.0),
+                          "MiB");
+    PalTest::ReportMetric("TokenStreamRecording pooled peak",
+                          pooledAllocator.PeakBytes() / (1024.0 * 1024.0),
+                          "MiB");
+}
+
+} // TokenStreamTest
@@ -0,0 +1,200 @@
+##
+ #######################################################################################################################
+ #
+ #  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ #
+ #  Permission is hereby granted, free of charge, to any person obtaining a copy
+ #  of this software and associated documentation files (the "Software"), to deal
+ #  in the Software without restriction, including without limitation the rights
+ #  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ #  copies of the Software, and to permit persons to whom the Software is
+ #  furnished to do so, subject to the following conditions:
+ #
+ #  The above copyright notice and this permission notice shall be included in all
+ #  copies or substantial portions of the Software.
+ #
+ #  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ #  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ #  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ #  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ #  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ #  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ #  SOFTWARE.
+ #
+ #######################################################################################################################
+
+# Offline compaction of PAL archive files (see inc/util/palArchiveFileFmt.h), the command line counterpart of
+# Util::CompactArchiveFile(). Live entries are rewritten contiguously to "<archive>.compact", which then replaces the
+# original archive. The archive is locked for the duration, so it must not be in use by a driver.
+#
+# An entry is dropped when:
+#  - An earlier entry has the same key (the archive file cache layer only ever reads the first one).
+#  - Its data lies outside of the file.
+#  - --platform-key is given and does not match the key the archive was written with.
+#
+# Entry data is copied verbatim along with its checksum, which PAL verifies when the entry is read.
+#
+# Usage: compactArchive.py <archive> [--order <key list>] [--platform-key <hex>] [--dry-run]
+#
+#   --order         Text file of entry keys (40 hex digits, one per line), most recently used first. Listed entries are
+#                   written first and in that order so that they share file pages; the rest keep their original order.
+#   --platform-key  Expected platform key in hex. On a mismatch every entry is dropped and the new archive uses this key.
+#   --dry-run       Only report what compaction would do.
+
+import argparse
+import fcntl
+import os
+import struct
+import sys
+import time
+
+# Must match ArchiveFileHeader, ArchiveFileFooter and ArchiveEntryHeader in inc/util/palArchiveFileFmt.h.
+FileHeaderFmt  = "<16s4I20s"
+FileFooterFmt  = "<4sIQ16s"
+EntryHeaderFmt = "<4s4IQI20sI"
+
+FileHeaderSize  = struct.calcsize(FileHeaderFmt)
+FileFooterSize  = struct.calcsize(FileFooterFmt)
+EntryHeaderSize = struct.calcsize(EntryHeaderFmt)
+
+MagicArchiveMarker = bytes([0x23, 0xd8, 0xfa, 0xe7, 0x0f, 0x5f, 0x47, 0xbe,
+                            0x8b, 0xd1, 0x48, 0xf5, 0xd8, 0xf0, 0xb4, 0xa7])
+MagicFooterMarker  = b"FOTR"
+MagicEntryMarker   = b"NTRY"
+
+CompactFileSuffix = ".compact"
+
+# FILETIME counts 100ns intervals from 1601-01-01, which is what PAL stores in the footer.
+def CurrentFileTime():
+    return int(time.time()) * 10000000 + 116444736000000000
+
+class Entry:
+    def __init__(self, fields):
+        (self.marker, self.ordinalId, self.nextBlock, self.dataSize, self.dataPosition, self.dataCrc64, self.dataType,
+         self.entryKey, self.metaValue) = fields
+
+def ReadArchive(f):
+    f.seek(0, os.SEEK_END)
+    fileSize = f.tell()
+
+    if fileSize < (FileHeaderSize + FileFooterSize):
+        sys.exit("File is too small to be an archive")
+
+    f.seek(0)
+    header = list(struct.unpack(FileHeaderFmt, f.read(FileHeaderSize)))
+
+    footerOffset = fileSize - FileFooterSize
+    f.seek(footerOffset)
+    footer = struct.unpack(FileFooterFmt, f.read(FileFooterSize))
+
+    if (header[0] != MagicArchiveMarker) or (footer[0] != MagicFooterMarker) or (footer[3] != MagicArchiveMarker):
+        sys.exit("File is not a valid archive")
+
+    entries = []
+    offset  = header[3]
+
+    while (len(entries) < footer[1]) and ((offset + EntryHeaderSize) <= footerOffset):
+        f.seek(offset)
+        entry = Entry(struct.unpack(EntryHeaderFmt, f.read(EntryHeaderSize)))
+
+        if entry.marker != MagicEntryMarker:
+            print("Entry %d has a bad marker, ignoring the rest of the archive" % len(entries))
+            break
+
+        entries.append(entry)
+        offset = entry.nextBlock
+
+    return header, footerOffset, entries
+
+def Main():
+    parser = argparse.ArgumentParser(description="Compact a PAL archive file.")
+    parser.add_argument("archive")
+    parser.add_argument("--order")
+    parser.add_argument("--platform-key")
+    parser.add_argument("--dry-run", action="store_true")
+    args = parser.parse_args()
+
+    with open(args.archive, "rb") as src:
+        # Matches the lock PAL takes when it opens an archive.
+        try:
+            fcntl.flock(src, fcntl.LOCK_EX | fcntl.LOCK_NB)
+        except OSError:
+            sys.exit("Archive is in use")
+
+        header, footerOffset, entries = ReadArchive(src)
+
+        keyMatches = True
+        if args.platform_key is not None:
+            platformKey = bytes.fromhex(args.platform_key)[:20].ljust(20, b"\0")
+            keyMatches  = (platformKey == header[5])
+            header[5]   = platformKey
+
+        seen      = set()
+        live      = []
+        dropped   = { "duplicate" : 0, "corrupt" : 0, "filtered" : 0 }
+
+        for entry in entries:
+            if keyMatches == False:
+                dropped["filtered"] += 1
+            elif entry.entryKey in seen:
+                dropped["duplicate"] += 1
+            elif (entry.dataPosition + entry.dataSize) > footerOffset:
+                dropped["corrupt"] += 1
+            else:
+                seen.add(entry.entryKey)
+                live.append(entry)
+
+        if args.order is not None:
+            with open(args.order) as orderFile:
+                rank = {}
+                for line in orderFile:
+                    key = line.strip()
+                    if key:
+                        rank.setdefault(bytes.fromhex(key)[:20].ljust(20, b"\0"), len(rank))
+
+            # sorted() is stable, so unlisted entries keep their original order after the listed ones.
+            live = sorted(live, key=lambda entry: rank.get(entry.entryKey, len(rank)))
+
+        newSize = FileHeaderSize + sum(EntryHeaderSize + entry.dataSize for entry in live) + FileFooterSize
+
+        print("Entries: %d -> %d (%d duplicate, %d corrupt, %d platform key mismatch)" %
+              (len(entries), len(live), dropped["duplicate"], dropped["corrupt"], dropped["filtered"]))
+        print("Size:    %d -> %d bytes" % (footerOffset + FileFooterSize, newSize))
+
+        if args.dry_run:
+            return
+
+        dstPath = args.archive + CompactFileSuffix
+
+        try:
+            with open(dstPath, "wb") as dst:
+                header[3] = FileHeaderSize
+                dst.write(struct.pack(FileHeaderFmt, *header))
+
+                offset = FileHeaderSize
+                for ordinalId, entry in enumerate(live):
+                    dataPosition = offset + EntryHeaderSize
+                    nextBlock    = dataPosition + entry.dataSize
+
+                    dst.write(struct.pack(EntryHeaderFmt, MagicEntryMarker, ordinalId, nextBlock, entry.dataSize,
+                                          dataPosition, entry.dataCrc64, entry.dataType, entry.entryKey,
+                                          entry.metaValue))
+                    src.seek(entry.dataPosition)
+                    dst.write(src.read(entry.dataSize))
+
+                    offset = nextBlock
+
+                dst.write(struct.pack(FileFooterFmt, MagicFooterMarker, len(live), CurrentFileTime(),
+                                      MagicArchiveMarker))
+                dst.flush()
+                os.fsync(dst.fileno())
+
+            # Replace the original while we still hold its lock, so nobody can open it in between.
+            os.replace(dstPath, args.archive)
+        except:
+            if os.path.exists(dstPath):
+                os.remove(dstPath)
+            raise
+
+if __name__ == "__main__":
+    Main()
@@ -0,0 +1,188 @@
+##
+ #######################################################################################################################
+ #
+ #  Copyright (c) 2021 Advanced Micro Devices, Inc. All Rights Reserved.
+ #
+ #  Permission is hereby granted, free of charge, to any person obtaining a copy
+ #  of this software and associated documentation files (the "Software"), to deal
+ #  in the Software without restriction, including without limitation the rights
+ #  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ #  copies of the Software, and to permit persons to whom the Software is
+ #  furnished to do so, subject to the following conditions:
+ #
+ #  The above copyright notice and this permission notice shall be included in all
+ #  copies or substantial portions of the Software.
+ #
+ #  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ #  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ #  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ #  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ #  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ #  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ #  SOFTWARE.
+ #
+ #######################################################################################################################
+
+# Decodes binary command buffer dumps (CmdBufDumpFormat set to CmdBufDumpFormatBinary or
+# CmdBufDumpFormatBinaryHeaders, optionally written by the background thread when CmdBufDumpAsyncMaxMemory is nonzero)
+# into the text layout PAL writes for CmdBufDumpFormatText: a "# <queue> - <sub-engine> Command length = N" line
+# followed by one dword per line for each command stream. Binary dumps don't record where one command stream ends and
+# the next begins, so consecutive chunks for the same sub-engine are written as one stream, and DE preambles and
+# postambles are labelled as DE streams. Dumps without headers carry no sub-engine so they are written as a single
+# unlabelled stream. Dumps compressed by the background thread (CmdBufDumpAsyncCompression, .lz extension) are
+# decompressed first.
+#
+# Usage: cmdBufDumpToText.py <dump file or directory> [output directory]
+
+import os
+import struct
+import sys
+
+# Must match CmdBufferDumpFileHeader, CmdBufferListHeader and CmdBufferDumpHeader in src/core/cmdBuffer.h.
+FileHeaderFmt  = "<5I"
+ListHeaderFmt  = "<3I"
+ChunkHeaderFmt = "<3I"
+
+# Must match CmdDumpCompressedHeader, CmdDumpCompressedMagic and CmdDumpCodec in src/core/cmdDumpWriter.h.
+CompressedHeaderFmt = "<2IQ"
+CompressedMagic     = 0x5A444350
+CompressedExt       = ".lz"
+CodecNone           = 0
+CodecLz             = 1
+
+# Must match the LZ format in src/util/lzCodec.cpp.
+LzMinMatch = 4
+
+# Stream headers written by WriteCmdBufferDumpHeaderToFile() in src/core/queue.cpp, indexed by sub-engine ID.
+StreamHeaders = {
+    0: "# Universal Queue - DE",
+    1: "# Universal Queue - CE",
+    2: "# Universal Queue - QueueContext",
+    3: "# Compute Queue -",
+    4: "# DMA Queue -",
+}
+
+def ReadStruct(fmt, data, offset):
+    size = struct.calcsize(fmt)
+    if offset + size > len(data):
+        raise ValueError("Unexpected end of file at offset %d" % offset)
+    return struct.unpack_from(fmt, data, offset), offset + size
+
+def LzReadCount(data, offset, count):
+    if count == 15:
+        value = 255
+        while value == 255:
+            value   = data[offset]
+            offset += 1
+            count  += value
+    return count, offset
+
+def LzDecompress(data, size):
+    out    = bytearray()
+    offset = 0
+    while offset < len(data):
+        token   = data[offset]
+        offset += 1
+
+        literalCount, offset = LzReadCount(data, offset, token >> 4)
+        out    += data[offset:offset + literalCount]
+        offset += literalCount
+
+        # The final sequence has no match.
+        if offset < len(data):
+            matchOffset = data[offset] | (data[offset + 1] << 8)
+            matchLength, offset = LzReadCount(data, offset + 2, token & 0xF)
+            matchLength += LzMinMatch
+            if (matchOffset == 0) or (matchOffset > len(out)):
+                raise ValueError("Malformed LZ data at offset %d" % offset)
+            # Matches may overlap the bytes they produce, so this must be copied a byte at a time.
+            start = len(out) - matchOffset
+            for i in range(matchLength):
+                out.append(out[start + i])
+
+    if len(out) != size:
+        raise ValueError("LZ data decoded to %d bytes instead of %d" % (len(out), size))
+    return bytes(out)
+
+def Decompress(data):
+    (magic, codec, size), offset = ReadStruct(CompressedHeaderFmt, data, 0)
+    if magic != CompressedMagic:
+        raise ValueError("Not a compressed command buffer dump")
+    if codec == CodecNone:
+        data = data[offset:]
+    elif codec == CodecLz:
+        data = LzDecompress(data[offset:], size)
+    else:
+        raise ValueError("Unknown codec %u" % codec)
+    return data
+
+def WriteDwords(out, data, offset, size):
+    for dword in struct.unpack_from("<%dI" % (size // 4), data, offset):
+        out.write("0x%08x\n" % dword)
+
+def DecodeFile(inPath, outPath):
+    with open(inPath, "rb") as f:
+        data = f.read()
+
+    dumpPath = inPath
+    if inPath.endswith(CompressedExt):
+        data     = Decompress(data)
+        dumpPath = inPath[:-len(CompressedExt)]
+
+    offset     = 0
+    hasHeaders = dumpPath.endswith(".pm4")
+
+    with open(outPath, "w") as out:
+        if hasHeaders:
+            (size, _, _, _, _), offset = ReadStruct(FileHeaderFmt, data, offset)
+            offset += size - struct.calcsize(FileHeaderFmt)
+
+        (size, _, count), offset = ReadStruct(ListHeaderFmt, data, offset)
+        offset += size - struct.calcsize(ListHeaderFmt)
+
+        if hasHeaders:
+            # Gather the chunks first so each stream's header can report its total length.
+            streams = []
+            for chunk in range(count):
+                (size, chunkSize, subEngineId), offset = ReadStruct(ChunkHeaderFmt, data, offset)
+                offset += size - struct.calcsize(ChunkHeaderFmt)
+                if (len(streams) == 0) or (streams[-1][0] != subEngineId):
+                    streams.append((subEngineId, []))
+                streams[-1][1].append((offset, chunkSize))
+                offset += chunkSize
+
+            for subEngineId, chunks in streams:
+                header = StreamHeaders.get(subEngineId, "# Sub-engine %u" % subEngineId)
+                out.write("%s Command length = %u\n" % (header, sum(chunkSize // 4 for _, chunkSize in chunks)))
+                for chunkOffset, chunkSize in chunks:
+                    WriteDwords(out, data, chunkOffset, chunkSize)
+        else:
+            out.write("# Command length = %u\n" % ((len(data) - offset) // 4))
+            WriteDwords(out, data, offset, len(data) - offset)
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: cmdBufDumpToText.py <dump file or directory> [output directory]")
+        return 1
+
+    inPath = sys.argv[1]
+    outDir = sys.argv[2] if len(sys.argv) > 2 else None
+
+    if os.path.isdir(inPath):
+        extensions = (".bin", ".pm4", ".bin" + CompressedExt, ".pm4" + CompressedExt)
+        files = [os.path.join(inPath, f) for f in sorted(os.listdir(inPath)) if f.endswith(extensions)]
+    else:
+        files = [inPath]
+
+    for path in files:
+        dumpPath = path[:-len(CompressedExt)] if path.endswith(CompressedExt) else path
+        outPath  = os.path.splitext(dumpPath)[0] + ".txt"
+        if outDir is not None:
+            outPath = os.path.join(outDir, os.path.basename(outPath))
+        DecodeFile(path, outPath)
+        print("%s -> %s" % (path, outPath))
+
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -60,7 +60,10 @@ def main(fileName, outputDir="./"):
     fp.write("#include \"core/os/amdgpu/amdgpuPlatform.h\"\n")
     fp.write("#include \"core/os/amdgpu/g_drmLoader.h\"\n")
     fp.write("#include \"palAssert.h\"\n")
-    fp.write("#include \"palSysUtil.h\"\n\n")
+    fp.write("#include \"palSysUtil.h\"\n")
+    fp.write("#if PAL_HAVE_FAKE_DRM\n")
+    fp.write("#include \"core/os/amdgpu/fakeDrm/fakeDrm.h\"\n")
+    fp.write("#endif\n\n")
     fp.write("#include <dlfcn.h>\n")
     fp.write("#include <time.h>\n")
     fp.write("#include <string.h>\n\n")
@@ -72,6 +75,14 @@ def main(fileName, outputDir="./"):
     procMgr.GenerateCppFile(fp, "DrmLoader")
     fp.write("void DrmLoader::SpecializedInit(\n    Platform* pPlatform,\n    char*     pDtifLibName)\n")
     fp.write("{\n")
+    fp.write("#if PAL_HAVE_FAKE_DRM\n")
+    fp.write("    // Offline builds resolve every entry point to the in-process fake instead of loading libdrm.\n")
+    fp.write("    InitFakeDrmProcs(&m_funcs);\n")
+    fp.write("    m_initialized = true;\n")
+    fp.write("#if defined(PAL_DEBUG_PRINTS)\n")
+    fp.write("    m_proxy.SetFuncCalls(&m_funcs);\n")
+    fp.write("#endif\n")
+    fp.write("#endif\n")
     fp.write("}\n\n")
     fp.write("} // Linux\n")
     fp.write("} // Pal\n")